@@ -28,6 +28,7 @@
 #include "bacnet/basic/tsm/tsm.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/mstimer.h"
 #include "bacnet/datalink/datalink.h"
 #include "bacnet/datalink/dlenv.h"
 /* include the device object */
@@ -49,6 +50,8 @@
 
 /** Buffer used for receiving */
 static uint8_t Rx_Buf[MAX_MPDU] = { 0 };
+/* task timer for the I-Am that answer Who-Is */
+static struct mstimer BACnet_Who_Is_Timer;
 
 /** The list of DNETs that our router can reach.
  *  Only one entry since we don't support downstream routers.
@@ -248,6 +251,7 @@ int main(int argc, char *argv[])
 #endif
     /* configure the timeout values */
     last_seconds = time(NULL);
+    mstimer_set(&BACnet_Who_Is_Timer, 10UL);
 
     /* broadcast an I-am-router-to-network on startup */
     printf("Remote Network DNET Number %d \n", DNET_list[0]);
@@ -258,6 +262,12 @@ int main(int argc, char *argv[])
         /* input */
         current_seconds = time(NULL);
 
+        /* wake up for any I-Am scheduled for the routed devices */
+        if (handler_who_is_pending()) {
+            timeout = 10;
+        } else {
+            timeout = 1000;
+        }
         /* returns 0 bytes on timeout */
         pdu_len = datalink_receive(&src, &Rx_Buf[0], MAX_MPDU, timeout);
 
@@ -276,6 +286,12 @@ int main(int argc, char *argv[])
             tsm_timer_milliseconds(elapsed_milliseconds);
             Device_Timer(elapsed_milliseconds);
         }
+        if (mstimer_expired(&BACnet_Who_Is_Timer)) {
+            /* the receive may have waited longer than the interval */
+            elapsed_milliseconds = mstimer_elapsed(&BACnet_Who_Is_Timer);
+            mstimer_restart(&BACnet_Who_Is_Timer);
+            handler_who_is_timer((uint16_t)elapsed_milliseconds);
+        }
         handler_cov_task();
         if (Routed_Device_Index < MAX_NUM_DEVICES) {
             Routed_Device_Index++;
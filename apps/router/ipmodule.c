@@ -62,7 +62,7 @@ void *dl_ip_thread(void *pArgs)
 
     while (!shutdown) {
         /* check for incoming messages */
-        bacmsg = recv_from_msgbox(port->port_id, &msg_storage, IPC_NOWAIT);
+        bacmsg = recv_from_msgbox(port->port_id, &msg_storage, MSGBOX_NOWAIT);
 
         if (bacmsg) {
             switch (bacmsg->type) {
@@ -324,11 +324,15 @@ int dl_ip_recv(
                 (void)decode_unsigned16(&data->buff[2], &buff_len);
                 /* subtract off the BVLC header */
                 buff_len -= 4;
-                if (buff_len < data->max_buff) {
-                    /* allocate data message stucture */
-                    (*msg_data) = (MSG_DATA *)malloc(sizeof(MSG_DATA));
+                if ((buff_len < data->max_buff) &&
+                    (buff_len <= MSG_DATA_PDU_MAX)) {
+                    /* get data message stucture from the pool */
+                    (*msg_data) = alloc_data();
+                    if ((*msg_data) == NULL) {
+                        PRINT(ERROR, "BIP: No message data. Discarded!\n");
+                        return 0;
+                    }
                     (*msg_data)->pdu_len = buff_len;
-                    (*msg_data)->pdu = (uint8_t *)malloc((*msg_data)->pdu_len);
                     /* fill up data message structure */
                     memmove(
                         &(*msg_data)->pdu[0], &data->buff[4],
@@ -358,11 +362,15 @@ int dl_ip_recv(
                 (void)decode_unsigned16(&data->buff[2], &buff_len);
                 /* subtract off the BVLC header */
                 buff_len -= 10;
-                if (buff_len < data->max_buff) {
-                    /* allocate data message stucture */
-                    (*msg_data) = (MSG_DATA *)malloc(sizeof(MSG_DATA));
+                if ((buff_len < data->max_buff) &&
+                    (buff_len <= MSG_DATA_PDU_MAX)) {
+                    /* get data message stucture from the pool */
+                    (*msg_data) = alloc_data();
+                    if ((*msg_data) == NULL) {
+                        PRINT(ERROR, "BIP: No message data. Discarded!\n");
+                        return 0;
+                    }
                     (*msg_data)->pdu_len = buff_len;
-                    (*msg_data)->pdu = (uint8_t *)malloc((*msg_data)->pdu_len);
                     /* fill up data message structure */
                     memmove(
                         &(*msg_data)->pdu[0], &data->buff[4 + 6],
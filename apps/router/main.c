@@ -100,26 +100,27 @@ int main(int argc, char *argv[])
             switch (bacmsg->type) {
                 case DATA: {
                     MSGBOX_ID msg_src = bacmsg->origin;
+                    MSG_DATA *recv_data = (MSG_DATA *)bacmsg->data;
+                    bool network_msg = is_network_msg(bacmsg);
 
-                    /* allocate message structure */
-                    msg_data = malloc(sizeof(MSG_DATA));
+                    /* get message structure for the routed message */
+                    msg_data = alloc_data();
                     if (!msg_data) {
-                        PRINT(ERROR, "Error: Could not allocate memory\n");
+                        PRINT(ERROR, "Error: No message data available\n");
+                        free_data(recv_data);
                         break;
                     }
 
                     /* print_msg(bacmsg); */
 
-                    if (is_network_msg(bacmsg)) {
+                    if (network_msg) {
                         buff_len =
                             process_network_message(bacmsg, msg_data, &buff);
-                        if (buff_len == 0) {
-                            free_data(bacmsg->data);
-                            break;
-                        }
                     } else {
                         buff_len = process_msg(bacmsg, msg_data, &buff);
                     }
+                    /* the received message is no longer needed */
+                    free_data(recv_data);
 
                     /* if buff_len */
                     /* >0 - form new message and send */
@@ -136,28 +137,39 @@ int main(int argc, char *argv[])
 
                         /* print_msg(bacmsg); */
 
-                        if (is_network_msg(bacmsg)) {
-                            msg_data->ref_count = 1;
-                            send_to_msgbox(msg_src, &msg_storage);
+                        /* each router port holds a reference until it
+                           has sent the message */
+                        if (network_msg) {
+                            hold_data(msg_data);
+                            if (!send_to_msgbox(msg_src, &msg_storage)) {
+                                check_data(msg_data);
+                            }
                         } else if (
                             msg_data->dest.net != BACNET_BROADCAST_NETWORK) {
-                            msg_data->ref_count = 1;
                             port =
                                 find_dnet(msg_data->dest.net, &msg_data->dest);
-                            send_to_msgbox(port->port_id, &msg_storage);
+                            hold_data(msg_data);
+                            if (!port ||
+                                !send_to_msgbox(port->port_id, &msg_storage)) {
+                                check_data(msg_data);
+                            }
                         } else {
                             port = head;
-                            msg_data->ref_count = port_count - 1;
                             while (port != NULL) {
                                 if (port->port_id == msg_src ||
                                     port->state == FINISHED) {
                                     port = port->next;
                                     continue;
                                 }
-                                send_to_msgbox(port->port_id, &msg_storage);
+                                hold_data(msg_data);
+                                if (!send_to_msgbox(
+                                        port->port_id, &msg_storage)) {
+                                    check_data(msg_data);
+                                }
                                 port = port->next;
                             }
                         }
+                        check_data(msg_data);
                     } else if (buff_len == -1) {
                         uint16_t net = msg_data->dest.net; /* NET to find */
                         PRINT(INFO, "Searching NET...\n");
@@ -166,7 +178,9 @@ int main(int argc, char *argv[])
                             &buff, &net);
                     } else {
                         /* if invalid message send Reject-Message-To-Network */
-                        PRINT(ERROR, "Error: Invalid message\n");
+                        if (buff_len != 0) {
+                            PRINT(ERROR, "Error: Invalid message\n");
+                        }
                         free_data(msg_data);
                     }
                 } break;
@@ -659,6 +673,7 @@ bool init_router(void)
     MSGBOX_ID msgboxid;
     ROUTER_PORT *port;
 
+    msg_data_pool_init();
     msgboxid = create_msgbox();
     if (msgboxid == INVALID_MSGBOX_ID) {
         return false;
@@ -688,6 +703,7 @@ bool init_router(void)
             continue;
         }
     }
+    init_routing_table(head);
 
     return true;
 }
@@ -726,8 +742,6 @@ void cleanup(void)
             head = port;
         }
     }
-
-    pthread_mutex_destroy(&msg_lock);
 }
 
 void print_msg(const BACMSG *msg)
@@ -748,21 +762,23 @@ void print_msg(const BACMSG *msg)
 
 uint16_t process_msg(BACMSG *msg, MSG_DATA *data, uint8_t **buff)
 {
+    const MSG_DATA *msg_data = (const MSG_DATA *)msg->data;
     BACNET_ADDRESS addr;
     BACNET_NPDU_DATA npdu_data;
     ROUTER_PORT *srcport;
     ROUTER_PORT *destport;
-    uint8_t npdu[MAX_NPDU];
     int16_t buff_len = 0;
     int apdu_offset;
     int apdu_len;
     int npdu_len;
 
-    memmove(data, msg->data, sizeof(MSG_DATA));
-
+    memmove(&data->src, &msg_data->src, sizeof(BACNET_ADDRESS));
     apdu_offset = bacnet_npdu_decode(
-        data->pdu, data->pdu_len, &data->dest, &addr, &npdu_data);
-    apdu_len = data->pdu_len - apdu_offset;
+        msg_data->pdu, msg_data->pdu_len, &data->dest, &addr, &npdu_data);
+    if (apdu_offset <= 0) {
+        return 0;
+    }
+    apdu_len = msg_data->pdu_len - apdu_offset;
 
     srcport = find_snet(msg->origin);
     destport = find_dnet(data->dest.net, NULL);
@@ -779,21 +795,22 @@ uint16_t process_msg(BACMSG *msg, MSG_DATA *data, uint8_t **buff)
         }
 
         /* encode both source and destination for broadcast and router-to-router
-         * communication */
+         * communication, directly into the buffer of the message data */
+        *buff = data->buffer;
         if (data->dest.net == BACNET_BROADCAST_NETWORK ||
             destport->route_info.net != data->dest.net) {
             npdu_len =
-                npdu_encode_pdu(npdu, &data->dest, &data->src, &npdu_data);
+                npdu_encode_pdu(*buff, &data->dest, &data->src, &npdu_data);
         } else {
-            npdu_len = npdu_encode_pdu(npdu, NULL, &data->src, &npdu_data);
+            npdu_len = npdu_encode_pdu(*buff, NULL, &data->src, &npdu_data);
         }
 
-        buff_len = npdu_len + data->pdu_len - apdu_offset;
-
-        *buff = (uint8_t *)malloc(buff_len);
-        memmove(*buff, npdu, npdu_len); /* copy newly formed NPDU */
+        buff_len = npdu_len + apdu_len;
+        if ((npdu_len + apdu_len) > (int)sizeof(data->buffer)) {
+            return 0;
+        }
         memmove(
-            *buff + npdu_len, &data->pdu[apdu_offset],
+            *buff + npdu_len, &msg_data->pdu[apdu_offset],
             apdu_len); /* copy APDU */
 
     } else {
@@ -801,9 +818,6 @@ uint16_t process_msg(BACMSG *msg, MSG_DATA *data, uint8_t **buff)
         return -1;
     }
 
-    /* delete received message */
-    free_data((MSG_DATA *)msg->data);
-
     return buff_len;
 }
 
@@ -4,6 +4,16 @@
  * @date 2012
  * @brief Message queue module
  *
+ * Each message box has one lock-free single-producer, single-consumer
+ * ring for each sender, found by the origin of the message, so a sender
+ * must only send from one thread. A counting semaphore tracks the
+ * messages waiting in all of the rings of a message box, so a receiver
+ * can sleep until a message arrives.
+ *
+ * Message data comes from a preallocated pool with atomic reference
+ * counts, so a message sent to several router ports is not copied and
+ * no lock or allocation is needed to route a message.
+ *
  * @section LICENSE
  *
  * SPDX-License-Identifier: MIT
@@ -11,73 +21,229 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
 #include <pthread.h>
+#include <semaphore.h>
 #include "msgqueue.h"
 
-pthread_mutex_t msg_lock = PTHREAD_MUTEX_INITIALIZER;
+#define MSGBOX_MASK (MSGBOX_SIZE - 1)
+#define MSG_DATA_NONE UINT32_MAX
+
+/* messages from one sender */
+struct msgbox_ring {
+    /* index of the next message to receive, written by the receiver */
+    unsigned head;
+    /* index of the next message to send, written by the sender */
+    unsigned tail;
+    BACMSG msg[MSGBOX_SIZE];
+};
+
+struct msgbox {
+    bool used;
+    /* the semaphore and rings are kept after the message box is deleted,
+       in case a sender has not yet seen that it was deleted */
+    bool initialized;
+    /* number of messages waiting in all rings */
+    sem_t count;
+    /* ring for each sender, allocated by the sender when first used */
+    struct msgbox_ring *ring[MSGBOX_MAX];
+    /* ring to check first on the next receive, for fairness */
+    unsigned next_ring;
+};
+
+static struct msgbox Msgbox[MSGBOX_MAX];
+/* protects creating and deleting message boxes */
+static pthread_mutex_t Msgbox_Lock = PTHREAD_MUTEX_INITIALIZER;
+
+static MSG_DATA Msg_Data_Pool[MSG_DATA_POOL_SIZE];
+/* head of the free list, with the index in the low 32 bits, and a count
+   of changes in the high 32 bits so that a stale head fails to swap */
+static uint64_t Msg_Data_Free;
 
 MSGBOX_ID create_msgbox(void)
 {
-    MSGBOX_ID msgboxid;
+    MSGBOX_ID msgboxid = INVALID_MSGBOX_ID;
+    MSGBOX_ID i;
+    unsigned r;
 
-    msgboxid = msgget(IPC_PRIVATE, 0666 | IPC_CREAT);
-    if (msgboxid == INVALID_MSGBOX_ID) {
-        return INVALID_MSGBOX_ID;
+    pthread_mutex_lock(&Msgbox_Lock);
+    for (i = 0; i < MSGBOX_MAX; i++) {
+        if (!Msgbox[i].used) {
+            if (Msgbox[i].initialized) {
+                sem_destroy(&Msgbox[i].count);
+                for (r = 0; r < MSGBOX_MAX; r++) {
+                    free(Msgbox[i].ring[r]);
+                    Msgbox[i].ring[r] = NULL;
+                }
+                Msgbox[i].initialized = false;
+            }
+            if (sem_init(&Msgbox[i].count, 0, 0) == 0) {
+                Msgbox[i].initialized = true;
+                Msgbox[i].next_ring = 0;
+                __atomic_store_n(&Msgbox[i].used, true, __ATOMIC_RELEASE);
+                msgboxid = i;
+            }
+            break;
+        }
     }
+    pthread_mutex_unlock(&Msgbox_Lock);
 
     return msgboxid;
 }
 
 bool send_to_msgbox(MSGBOX_ID dest, BACMSG *msg)
 {
-    int err;
+    struct msgbox *box;
+    struct msgbox_ring *ring;
+    unsigned head, tail;
 
-    err = msgsnd(dest, msg, sizeof(BACMSG) - sizeof(MSGTYPE), 0);
-    if (err) {
+    if ((dest < 0) || (dest >= MSGBOX_MAX) || (msg->origin < 0) ||
+        (msg->origin >= MSGBOX_MAX)) {
+        return false;
+    }
+    box = &Msgbox[dest];
+    if (!__atomic_load_n(&box->used, __ATOMIC_ACQUIRE)) {
         return false;
     }
+    ring = __atomic_load_n(&box->ring[msg->origin], __ATOMIC_ACQUIRE);
+    if (!ring) {
+        ring = calloc(1, sizeof(struct msgbox_ring));
+        if (!ring) {
+            return false;
+        }
+        __atomic_store_n(&box->ring[msg->origin], ring, __ATOMIC_RELEASE);
+    }
+    tail = ring->tail;
+    head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if ((tail - head) >= MSGBOX_SIZE) {
+        /* full */
+        return false;
+    }
+    ring->msg[tail & MSGBOX_MASK] = *msg;
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    sem_post(&box->count);
+
     return true;
 }
 
 BACMSG *recv_from_msgbox(MSGBOX_ID src, BACMSG *msg, int flags)
 {
-    int recv_bytes;
+    struct msgbox *box;
+    struct msgbox_ring *ring;
+    unsigned head, tail;
+    unsigned i, index;
 
-    recv_bytes = msgrcv(src, msg, sizeof(BACMSG) - sizeof(MSGTYPE), 0, flags);
-    if (recv_bytes > 0) {
-        return msg;
-    } else {
+    if ((src < 0) || (src >= MSGBOX_MAX) || !Msgbox[src].used) {
         return NULL;
     }
+    box = &Msgbox[src];
+    if (flags & MSGBOX_NOWAIT) {
+        if (sem_trywait(&box->count) != 0) {
+            return NULL;
+        }
+    } else {
+        while (sem_wait(&box->count) != 0) {
+            if (errno != EINTR) {
+                return NULL;
+            }
+        }
+    }
+    /* a message is waiting in one of the rings */
+    for (;;) {
+        for (i = 0; i < MSGBOX_MAX; i++) {
+            index = (box->next_ring + i) % MSGBOX_MAX;
+            ring = __atomic_load_n(&box->ring[index], __ATOMIC_ACQUIRE);
+            if (!ring) {
+                continue;
+            }
+            head = ring->head;
+            tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+            if (head != tail) {
+                *msg = ring->msg[head & MSGBOX_MASK];
+                __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+                box->next_ring = (index + 1) % MSGBOX_MAX;
+                return msg;
+            }
+        }
+    }
 }
 
 void del_msgbox(MSGBOX_ID msgboxid)
 {
-    if (msgboxid == INVALID_MSGBOX_ID) {
+    if ((msgboxid < 0) || (msgboxid >= MSGBOX_MAX)) {
         return;
-    } else {
-        msgctl(msgboxid, IPC_RMID, NULL);
     }
+    pthread_mutex_lock(&Msgbox_Lock);
+    __atomic_store_n(&Msgbox[msgboxid].used, false, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&Msgbox_Lock);
+}
+
+void msg_data_pool_init(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < MSG_DATA_POOL_SIZE; i++) {
+        Msg_Data_Pool[i].next = i + 1;
+    }
+    Msg_Data_Pool[MSG_DATA_POOL_SIZE - 1].next = MSG_DATA_NONE;
+    __atomic_store_n(&Msg_Data_Free, 0, __ATOMIC_RELEASE);
+}
+
+MSG_DATA *alloc_data(void)
+{
+    uint64_t head, next;
+    uint32_t index;
+    MSG_DATA *data;
+
+    head = __atomic_load_n(&Msg_Data_Free, __ATOMIC_ACQUIRE);
+    do {
+        index = (uint32_t)head;
+        if (index == MSG_DATA_NONE) {
+            return NULL;
+        }
+        next = (head & 0xFFFFFFFF00000000ULL) + 0x100000000ULL;
+        next |= __atomic_load_n(&Msg_Data_Pool[index].next, __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(
+        &Msg_Data_Free, &head, next, true, __ATOMIC_ACQUIRE,
+        __ATOMIC_ACQUIRE));
+    data = &Msg_Data_Pool[index];
+    data->pdu = data->buffer;
+    data->pdu_len = 0;
+    __atomic_store_n(&data->ref_count, 1, __ATOMIC_RELAXED);
+
+    return data;
 }
 
 void free_data(MSG_DATA *data)
 {
-    if (data->pdu) {
-        free(data->pdu);
-        data->pdu = NULL;
+    uint64_t head, next;
+    uint32_t index;
+
+    if (!data) {
+        return;
     }
-    if (data) {
-        free(data);
-        data = NULL;
+    index = (uint32_t)(data - Msg_Data_Pool);
+    if (index >= MSG_DATA_POOL_SIZE) {
+        return;
     }
+    head = __atomic_load_n(&Msg_Data_Free, __ATOMIC_RELAXED);
+    do {
+        __atomic_store_n(&data->next, (uint32_t)head, __ATOMIC_RELAXED);
+        next = ((head & 0xFFFFFFFF00000000ULL) + 0x100000000ULL) | index;
+    } while (!__atomic_compare_exchange_n(
+        &Msg_Data_Free, &head, next, true, __ATOMIC_RELEASE,
+        __ATOMIC_RELAXED));
+}
+
+void hold_data(MSG_DATA *data)
+{
+    __atomic_add_fetch(&data->ref_count, 1, __ATOMIC_RELAXED);
 }
 
 void check_data(MSG_DATA *data)
 {
-    /* lock and decrement messages reference count */
-    pthread_mutex_lock(&msg_lock);
-    if (--data->ref_count == 0) {
+    /* decrement messages reference count */
+    if (__atomic_sub_fetch(&data->ref_count, 1, __ATOMIC_ACQ_REL) == 0) {
         free_data(data);
     }
-    pthread_mutex_unlock(&msg_lock);
 }
@@ -14,17 +14,33 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <sys/types.h>
-#include <sys/ipc.h>
-#include <sys/msg.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
 #include "bacnet/npdu.h"
 
-extern pthread_mutex_t msg_lock;
+/* number of message boxes, which is one per router port plus the router */
+#ifndef MSGBOX_MAX
+#define MSGBOX_MAX 32
+#endif
+/* number of messages waiting from each sender, as a power of two */
+#ifndef MSGBOX_SIZE
+#define MSGBOX_SIZE 256
+#endif
+/* number of message data buffers shared by all router ports */
+#ifndef MSG_DATA_POOL_SIZE
+#define MSG_DATA_POOL_SIZE 256
+#endif
+/* largest PDU that is routed - the NPDU and the largest APDU of any port */
+#ifndef MSG_DATA_PDU_MAX
+#define MSG_DATA_PDU_MAX (MAX_NPDU + 1476)
+#endif
 
 #define INVALID_MSGBOX_ID -1
 
+/* flag for recv_from_msgbox() to return when no message is waiting */
+#define MSGBOX_NOWAIT 1
+
 typedef int MSGBOX_ID;
 
 typedef enum { DATA = 1, SERVICE } MSGTYPE;
@@ -45,12 +61,17 @@ typedef struct _msg_data {
     BACNET_ADDRESS src;
     uint8_t *pdu;
     uint16_t pdu_len;
-    uint8_t ref_count;
+    /* number of holders, changed atomically */
+    unsigned ref_count;
+    /* index of the next free buffer in the pool */
+    uint32_t next;
+    /* storage for the PDU */
+    uint8_t buffer[MSG_DATA_PDU_MAX];
 } MSG_DATA;
 
 MSGBOX_ID create_msgbox(void);
 
-/* returns sent byte count */
+/* returns true if the message was queued */
 bool send_to_msgbox(MSGBOX_ID dest, BACMSG *msg);
 
 /* returns received message */
@@ -58,9 +79,18 @@ BACMSG *recv_from_msgbox(MSGBOX_ID src, BACMSG *msg, int flags);
 
 void del_msgbox(MSGBOX_ID msgboxid);
 
+/* prepare the pool of message data buffers */
+void msg_data_pool_init(void);
+
+/* get message data from the pool, with one reference */
+MSG_DATA *alloc_data(void);
+
 /* free message data structure */
 void free_data(MSG_DATA *data);
 
+/* add a reference to the message data */
+void hold_data(MSG_DATA *data);
+
 /* check message reference counter and delete data if needed */
 void check_data(MSG_DATA *data);
 
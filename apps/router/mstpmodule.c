@@ -21,12 +21,17 @@ void *dl_mstp_thread(void *pArgs)
 {
     ROUTER_PORT *port = (ROUTER_PORT *)pArgs;
     struct mstp_port_struct_t mstp_port = { 0 };
-    volatile SHARED_MSTP_DATA shared_port_data = { 0 };
+    SHARED_MSTP_DATA shared_port_data;
+    BACNET_ADDRESS src = { 0 };
+    uint8_t pdu[MSG_DATA_PDU_MAX];
     uint16_t pdu_len;
     uint8_t shutdown = 0;
+    struct dlmstp_port_statistics statistics;
 
+    memset(&shared_port_data, 0, sizeof(shared_port_data));
     shared_port_data.MSTP_Packets = 0;
     shared_port_data.RS485_Handle = -1;
+    shared_port_data.Thread_Priority = DLMSTP_THREAD_PRIORITY;
     shared_port_data.RS485_Baud = B38400;
     shared_port_data.RS485MOD = 0;
 
@@ -84,7 +89,7 @@ void *dl_mstp_thread(void *pArgs)
         BACMSG msg_storage, *bacmsg;
         MSG_DATA *msg_data;
 
-        bacmsg = recv_from_msgbox(port->port_id, &msg_storage, IPC_NOWAIT);
+        bacmsg = recv_from_msgbox(port->port_id, &msg_storage, MSGBOX_NOWAIT);
 
         if (bacmsg) {
             switch (bacmsg->type) {
@@ -119,21 +124,19 @@ void *dl_mstp_thread(void *pArgs)
                     break;
             }
         } else {
-            pdu_len = dlmstp_receive(&mstp_port, NULL, NULL, 0, 5);
-
-            if (pdu_len > 0) {
-                msg_data = (MSG_DATA *)malloc(sizeof(MSG_DATA));
-                memmove(
-                    &(msg_data->src),
-                    (const void *)&(shared_port_data.Receive_Packet.address),
-                    sizeof(shared_port_data.Receive_Packet.address));
+            pdu_len = dlmstp_receive(&mstp_port, &src, pdu, sizeof(pdu), 5);
+
+            if ((pdu_len > 0) && (pdu_len <= MSG_DATA_PDU_MAX)) {
+                /* get data message stucture from the pool */
+                msg_data = alloc_data();
+                if (msg_data == NULL) {
+                    PRINT(ERROR, "MSTP: No message data. Discarded!\n");
+                    continue;
+                }
+                memmove(&(msg_data->src), &src, sizeof(src));
                 msg_data->src.adr[0] = msg_data->src.mac[0];
                 msg_data->src.len = 1;
-                msg_data->pdu = (uint8_t *)malloc(pdu_len);
-                memmove(
-                    msg_data->pdu,
-                    (const void *)&(shared_port_data.Receive_Packet.pdu),
-                    pdu_len);
+                memmove(msg_data->pdu, pdu, pdu_len);
                 msg_data->pdu_len = pdu_len;
 
                 msg_storage.type = DATA;
@@ -148,6 +151,13 @@ void *dl_mstp_thread(void *pArgs)
         }
     }
 
+    if (dlmstp_port_fill_statistics(&mstp_port, &statistics)) {
+        PRINT(
+            INFO, "MSTP %s: %u dropped, reply latency %u us, most %u us\n",
+            port->iface, (unsigned)statistics.receive_dropped,
+            (unsigned)statistics.reply_latency,
+            (unsigned)statistics.reply_latency_max);
+    }
     dlmstp_cleanup(&mstp_port);
     port->state = FINISHED;
 
@@ -17,6 +17,7 @@
 uint16_t
 process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
 {
+    const MSG_DATA *msg_data = (const MSG_DATA *)msg->data;
     BACNET_NPDU_DATA npdu_data;
     ROUTER_PORT *srcport;
     ROUTER_PORT *destport;
@@ -28,13 +29,20 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
     int net_count;
     int i;
 
-    memmove(data, msg->data, sizeof(MSG_DATA));
+    /* copy the addresses, and refer to the received PDU */
+    memmove(&data->dest, &msg_data->dest, sizeof(BACNET_ADDRESS));
+    memmove(&data->src, &msg_data->src, sizeof(BACNET_ADDRESS));
+    data->pdu = msg_data->pdu;
+    data->pdu_len = msg_data->pdu_len;
 
     apdu_offset = bacnet_npdu_decode(
         data->pdu, data->pdu_len, &data->dest, NULL, &npdu_data);
     apdu_len = data->pdu_len - apdu_offset;
 
     srcport = find_snet(msg->origin);
+    if (!srcport) {
+        return 0;
+    }
     data->src.net = srcport->route_info.net;
 
     switch (npdu_data.network_message_type) {
@@ -76,8 +84,7 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
                     &data->pdu[apdu_offset + 2 * i],
                     &net); /* decode received NET values */
                 add_dnet(
-                    &srcport->route_info, net,
-                    data->src); /* and update routing table */
+                    srcport, net, data->src); /* and update routing table */
             }
             break;
         }
@@ -117,7 +124,7 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
                         &data->pdu[apdu_offset + i],
                         &net); /* decode received NET values */
                     add_dnet(
-                        &srcport->route_info, net,
+                        srcport, net,
                         data->src); /* and update routing table */
                     if (data->pdu[apdu_offset + i + 3] >
                         0) { /* find next NET value */
@@ -144,7 +151,7 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
                         &data->pdu[apdu_offset + i],
                         &net); /* decode received NET values */
                     add_dnet(
-                        &srcport->route_info, net,
+                        srcport, net,
                         data->src); /* and update routing table */
                     if (data->pdu[apdu_offset + i + 3] >
                         0) { /* find next NET value */
@@ -203,7 +210,8 @@ uint16_t create_network_message(
     }
     init_npdu(&npdu_data, network_message_type, data_expecting_reply);
 
-    *buff = (uint8_t *)malloc(128); /* resolve different length */
+    /* encode into the buffer of the message data */
+    *buff = data->buffer;
 
     /* manual destination setup for Init-RT-Table-Ack message */
     data->dest.net = BACNET_BROADCAST_NETWORK;
@@ -317,7 +325,12 @@ void send_network_message(
     int16_t buff_len;
 
     if (!data) {
-        data = (MSG_DATA *)malloc(sizeof(MSG_DATA));
+        data = alloc_data();
+        if (!data) {
+            PRINT(ERROR, "Error: No message data available\n");
+            return;
+        }
+        memset(&data->src, 0, sizeof(BACNET_ADDRESS));
         data->dest.net = BACNET_BROADCAST_NETWORK;
         data->dest.len = 0;
     }
@@ -331,15 +344,19 @@ void send_network_message(
     msg.type = DATA;
     msg.data = data;
 
-    data->ref_count = port_count;
+    /* each router port holds a reference until it has sent the message */
     while (port != NULL) {
         if (port->state == FINISHED) {
             port = port->next;
             continue;
         }
-        send_to_msgbox(port->port_id, &msg);
+        hold_data(data);
+        if (!send_to_msgbox(port->port_id, &msg)) {
+            check_data(data);
+        }
         port = port->next;
     }
+    check_data(data);
 }
 
 void init_npdu(
@@ -13,83 +13,93 @@
 #include <string.h>
 #include "portthread.h"
 
-ROUTER_PORT *find_snet(MSGBOX_ID id)
+/* route to each NET, indexed by NET number */
+typedef struct _dnet_route {
+    ROUTER_PORT *port;
+    /* the next router on the way, or NULL if directly connected */
+    DNET *dnet;
+} DNET_ROUTE;
+
+static DNET_ROUTE Dnet_Table[BACNET_BROADCAST_NETWORK + 1];
+/* router port of each message box */
+static ROUTER_PORT *Snet_Table[MSGBOX_MAX];
+
+void init_routing_table(ROUTER_PORT *port_list)
 {
-    ROUTER_PORT *port = head;
+    ROUTER_PORT *port = port_list;
+    uint16_t net;
 
+    memset(Dnet_Table, 0, sizeof(Dnet_Table));
+    memset(Snet_Table, 0, sizeof(Snet_Table));
     while (port != NULL) {
-        if (port->port_id == id) {
-            return port;
+        if ((port->port_id >= 0) && (port->port_id < MSGBOX_MAX)) {
+            Snet_Table[port->port_id] = port;
+        }
+        net = port->route_info.net;
+        if ((net != BACNET_BROADCAST_NETWORK) && !Dnet_Table[net].port) {
+            Dnet_Table[net].port = port;
         }
         port = port->next;
     }
+}
+
+ROUTER_PORT *find_snet(MSGBOX_ID id)
+{
+    if ((id < 0) || (id >= MSGBOX_MAX)) {
+        return NULL;
+    }
 
-    return NULL;
+    return Snet_Table[id];
 }
 
 ROUTER_PORT *find_dnet(uint16_t net, BACNET_ADDRESS *addr)
 {
-    ROUTER_PORT *port = head;
-    DNET *dnet;
+    const DNET_ROUTE *route;
 
     /* for broadcast messages no search is needed */
     if (net == BACNET_BROADCAST_NETWORK) {
-        return port;
+        return head;
     }
-
-    while (port != NULL) {
-        /* check if DNET is directly connected to the router */
-        if (net == port->route_info.net) {
-            return port;
-
-            /* else search router ports DNET list */
-        } else if (port->route_info.dnets) {
-            dnet = port->route_info.dnets;
-            while (dnet != NULL) {
-                if (net == dnet->net) {
-                    if (addr) {
-                        memmove(&addr->len, &dnet->mac_len, 1);
-                        memmove(&addr->adr[0], &dnet->mac[0], MAX_MAC_LEN);
-                    }
-                    return port;
-                }
-                dnet = dnet->next;
-            }
-        }
-        port = port->next;
+    route = &Dnet_Table[net];
+    if (route->dnet && addr) {
+        memmove(&addr->len, &route->dnet->mac_len, 1);
+        memmove(&addr->adr[0], &route->dnet->mac[0], MAX_MAC_LEN);
     }
 
-    return NULL;
+    return route->port;
 }
 
-void add_dnet(RT_ENTRY *route_info, uint16_t net, BACNET_ADDRESS addr)
+void add_dnet(ROUTER_PORT *port, uint16_t net, BACNET_ADDRESS addr)
 {
+    RT_ENTRY *route_info = &port->route_info;
     DNET *dnet = route_info->dnets;
-    DNET *tmp;
+    DNET *tmp = NULL;
 
-    if (dnet == NULL) {
-        route_info->dnets = (DNET *)malloc(sizeof(DNET));
-        memmove(&route_info->dnets->mac_len, &addr.len, 1);
-        memmove(&route_info->dnets->mac[0], &addr.adr[0], MAX_MAC_LEN);
-        route_info->dnets->net = net;
-        route_info->dnets->state = true;
-        route_info->dnets->next = NULL;
-    } else {
-        while (dnet != NULL) {
-            if (dnet->net == net) { /* make sure NETs are not repeated */
-                return;
-            }
-            tmp = dnet;
-            dnet = dnet->next;
+    while (dnet != NULL) {
+        if (dnet->net == net) { /* make sure NETs are not repeated */
+            return;
         }
-
-        dnet = (DNET *)malloc(sizeof(DNET));
-        memmove(&dnet->mac_len, &addr.len, 1);
-        memmove(&dnet->mac[0], &addr.adr[0], MAX_MAC_LEN);
-        dnet->net = net;
-        dnet->state = true;
-        dnet->next = NULL;
+        tmp = dnet;
+        dnet = dnet->next;
+    }
+    dnet = (DNET *)malloc(sizeof(DNET));
+    if (dnet == NULL) {
+        return;
+    }
+    memmove(&dnet->mac_len, &addr.len, 1);
+    memmove(&dnet->mac[0], &addr.adr[0], MAX_MAC_LEN);
+    dnet->net = net;
+    dnet->state = true;
+    dnet->next = NULL;
+    if (tmp) {
         tmp->next = dnet;
+    } else {
+        route_info->dnets = dnet;
+    }
+    /* the first route found to a NET is kept */
+    if ((net != BACNET_BROADCAST_NETWORK) && !Dnet_Table[net].port) {
+        Dnet_Table[net].port = port;
+        Dnet_Table[net].dnet = dnet;
     }
 }
 
@@ -97,6 +107,10 @@ void cleanup_dnets(DNET *dnets)
 {
     DNET *dnet = dnets;
     while (dnet != NULL) {
+        if (Dnet_Table[dnet->net].dnet == dnet) {
+            Dnet_Table[dnet->net].port = NULL;
+            Dnet_Table[dnet->net].dnet = NULL;
+        }
         dnet = dnet->next;
         free(dnets);
         dnets = dnet;
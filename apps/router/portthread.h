@@ -90,6 +90,9 @@ typedef struct _port {
 extern ROUTER_PORT *head;
 extern int port_count;
 
+/* index the router ports by message box and by directly connected NET */
+void init_routing_table(ROUTER_PORT *port_list);
+
 /* get recieving router port */
 ROUTER_PORT *find_snet(MSGBOX_ID id);
 
@@ -97,7 +100,7 @@ ROUTER_PORT *find_snet(MSGBOX_ID id);
 ROUTER_PORT *find_dnet(uint16_t net, BACNET_ADDRESS *addr);
 
 /* add reacheble network for specified router port */
-void add_dnet(RT_ENTRY *route_info, uint16_t net, BACNET_ADDRESS addr);
+void add_dnet(ROUTER_PORT *port, uint16_t net, BACNET_ADDRESS addr);
 
 void cleanup_dnets(DNET *dnets);
 
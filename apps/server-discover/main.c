@@ -71,6 +71,7 @@ static void print_discovered_devices(void)
     size_t heap_ram = 0;
     char model_name[MAX_CHARACTER_STRING_BYTES] = { 0 };
     char object_name[MAX_CHARACTER_STRING_BYTES] = { 0 };
+    BACNET_DISCOVER_STATISTICS stats = { 0 };
 
     device_count = bacnet_discover_device_count();
     printf("----list of %u devices ----\n", device_count);
@@ -105,6 +106,13 @@ static void print_discovered_devices(void)
             }
         }
     }
+    bacnet_discover_statistics(&stats);
+    printf(
+        "discovered %lu devices, %lu objects, %lu requests, %lu bytes "
+        "in %lums (%lu objects/s, %lu bytes/s)\n",
+        stats.devices, stats.objects, stats.requests, stats.bytes,
+        stats.elapsed_milliseconds, stats.objects_per_second,
+        stats.bytes_per_second);
 }
 
 /**
@@ -176,6 +184,7 @@ static void print_usage(const char *filename)
 {
     printf("Usage: %s [--dnet]\n", filename);
     printf("       [--discover-seconds][--print-seconds][--print-summary]\n");
+    printf("       [--transactions N][--device-transactions N]\n");
     printf("       [--version][--help]\n");
 }
 
@@ -191,6 +200,10 @@ static void print_help(const char *filename)
            "Number of seconds to wait before printing list of devices.\n");
     printf("--print-summary:\n"
            "Print only the list of devices.\n");
+    printf("--transactions N\n"
+           "Number of requests outstanding at once to all devices.\n");
+    printf("--device-transactions N\n"
+           "Number of requests outstanding at once to each device.\n");
     printf("--dnet N\n"
            "Optional BACnet network number N for directed requests.\n"
            "Valid range is from 0 to 65535 where 0 is the local connection\n"
@@ -242,6 +255,16 @@ int main(int argc, char *argv[])
             }
         } else if (strcmp(argv[argi], "--print-summary") == 0) {
             Print_Summary = true;
+        } else if (strcmp(argv[argi], "--transactions") == 0) {
+            if (++argi < argc) {
+                bacnet_discover_transactions_set(
+                    strtoul(argv[argi], NULL, 0));
+            }
+        } else if (strcmp(argv[argi], "--device-transactions") == 0) {
+            if (++argi < argc) {
+                bacnet_discover_device_transactions_set(
+                    strtoul(argv[argi], NULL, 0));
+            }
         } else if (strcmp(argv[argi], "--dnet") == 0) {
             if (++argi < argc) {
                 long_value = strtol(argv[argi], NULL, 0);
@@ -75,8 +75,10 @@ static struct mstimer BACnet_Notification_Timer;
 #endif
 /* task timer for objects */
 static struct mstimer BACnet_Object_Timer;
+#if !defined(BACDL_ETHERNET) && !defined(BACDL_ARCNET)
 /** Buffer used for receiving */
 static uint8_t Rx_Buf[MAX_MPDU] = { 0 };
+#endif
 
 /* configure an example structured view object subordinate list */
 #if (BACNET_PROTOCOL_REVISION >= 4)
@@ -276,7 +278,7 @@ static void print_help(const char *filename)
 /** Main function of server demo.
  *
  * @see Device_Set_Object_Instance_Number, dlenv_init, Send_I_Am,
- *      datalink_receive, npdu_handler,
+ *      datalink_receive, datalink_receive_handler, npdu_handler,
  *      dcc_timer_seconds, datalink_maintenance_timer,
  *      handler_cov_task, tsm_timer_milliseconds
  *
@@ -286,8 +288,10 @@ static void print_help(const char *filename)
  */
 int main(int argc, char *argv[])
 {
+#if !defined(BACDL_ETHERNET) && !defined(BACDL_ARCNET)
     BACNET_ADDRESS src = { 0 }; /* address where message came from */
     uint16_t pdu_len = 0;
+#endif
     unsigned timeout = 1; /* milliseconds */
     uint32_t elapsed_milliseconds = 0;
     uint32_t elapsed_seconds = 0;
@@ -379,6 +383,10 @@ int main(int argc, char *argv[])
     Send_I_Am(&Handler_Transmit_Buffer[0]);
     /* loop forever */
     for (;;) {
+#if defined(BACDL_ETHERNET) || defined(BACDL_ARCNET)
+        /* input and process, without copying the NPDU */
+        datalink_receive_handler(npdu_handler, timeout);
+#else
         /* input */
         pdu_len = datalink_receive(&src, &Rx_Buf[0], MAX_MPDU, timeout);
 
@@ -386,6 +394,7 @@ int main(int argc, char *argv[])
         if (pdu_len) {
             npdu_handler(&src, &Rx_Buf[0], pdu_len);
         }
+#endif
         if (mstimer_expired(&BACnet_Task_Timer)) {
             mstimer_reset(&BACnet_Task_Timer);
             elapsed_milliseconds = mstimer_interval(&BACnet_Task_Timer);
@@ -408,6 +417,7 @@ int main(int argc, char *argv[])
             mstimer_reset(&BACnet_TSM_Timer);
             elapsed_milliseconds = mstimer_interval(&BACnet_TSM_Timer);
             tsm_timer_milliseconds(elapsed_milliseconds);
+            handler_who_is_timer(elapsed_milliseconds);
         }
         if (mstimer_expired(&BACnet_Address_Timer)) {
             mstimer_reset(&BACnet_Address_Timer);
@@ -421,6 +431,7 @@ int main(int argc, char *argv[])
             mstimer_reset(&BACnet_Notification_Timer);
             Notification_Class_find_recipient();
         }
+        Notification_Class_Notify_Task();
 #endif
         /* output */
         if (mstimer_expired(&BACnet_Object_Timer)) {
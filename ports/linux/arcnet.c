@@ -11,6 +11,14 @@
 #include "bacnet/datalink/arcnet.h"
 #include "bacport.h"
 
+/* receive from a memory-mapped TPACKET_V3 ring instead of read() */
+#ifndef ARCNET_RECEIVE_MMAP
+#define ARCNET_RECEIVE_MMAP 1
+#endif
+#if ARCNET_RECEIVE_MMAP
+#include "packet-mmap.h"
+#endif
+
 /** @file linux/arcnet.c  Provides Linux-specific functions for Arcnet. */
 
 /* my local device data - MAC address */
@@ -21,6 +29,12 @@ static int ARCNET_Sock_FD = -1;
 static struct sockaddr ARCNET_Socket_Address;
 /* Broadcast address */
 #define ARCNET_BROADCAST 0
+#if ARCNET_RECEIVE_MMAP
+/* packet socket and receive ring, used instead when it opens */
+static struct packet_mmap ARCNET_Ring = { -1, NULL, 0, 0, false, NULL, 0 };
+/* SC, DSAP, SSAP and LLC Control of BACnet, after the ARCNET header */
+static const uint8_t ARCNET_Signature[4] = { 0xCD, 0x82, 0x82, 0x03 };
+#endif
 
 /*
 Hints:
@@ -62,9 +76,17 @@ bool arcnet_valid(void)
 
 void arcnet_cleanup(void)
 {
+#if ARCNET_RECEIVE_MMAP
+    if (packet_mmap_valid(&ARCNET_Ring)) {
+        packet_mmap_close(&ARCNET_Ring);
+    } else if (arcnet_valid()) {
+        close(ARCNET_Sock_FD);
+    }
+#else
     if (arcnet_valid()) {
         close(ARCNET_Sock_FD);
     }
+#endif
     ARCNET_Sock_FD = -1;
 
     return;
@@ -167,11 +189,31 @@ static int arcnet_bind(const char *interface_name)
 
 bool arcnet_init(char *interface_name)
 {
+    const char *name = "arc0";
+#if ARCNET_RECEIVE_MMAP
+    struct ifreq ifr;
+#endif
+
     if (interface_name) {
-        ARCNET_Sock_FD = arcnet_bind(interface_name);
-    } else {
-        ARCNET_Sock_FD = arcnet_bind("arc0");
+        name = interface_name;
+    }
+#if ARCNET_RECEIVE_MMAP
+    if (packet_mmap_open(
+            &ARCNET_Ring, name, ETH_P_ALL, ARC_HDR_SIZE, ARCNET_Signature,
+            sizeof(ARCNET_Signature))) {
+        snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", name);
+        if (ioctl(ARCNET_Ring.fd, SIOCGIFHWADDR, &ifr) != -1) {
+            ARCNET_MAC_Address = ifr.ifr_hwaddr.sa_data[0];
+        }
+        fprintf(
+            stderr, "arcnet: MAC=%02Xh iface=\"%s\" TPACKET_V3 ring\n",
+            ARCNET_MAC_Address, name);
+        ARCNET_Sock_FD = ARCNET_Ring.fd;
+        atexit(arcnet_cleanup);
+        return arcnet_valid();
     }
+#endif
+    ARCNET_Sock_FD = arcnet_bind(name);
 
     return arcnet_valid();
 }
@@ -225,10 +267,21 @@ int arcnet_send_pdu(
     }
     memcpy(&pkt->soft.raw[4], pdu, pdu_len);
     /* Send the packet */
+#if ARCNET_RECEIVE_MMAP
+    if (packet_mmap_valid(&ARCNET_Ring)) {
+        bytes = packet_mmap_send(&ARCNET_Ring, mtu, (uint16_t)mtu_len);
+    } else {
+        bytes = sendto(
+            ARCNET_Sock_FD, &mtu, mtu_len, 0,
+            (struct sockaddr *)&ARCNET_Socket_Address,
+            sizeof(ARCNET_Socket_Address));
+    }
+#else
     bytes = sendto(
         ARCNET_Sock_FD, &mtu, mtu_len, 0,
         (struct sockaddr *)&ARCNET_Socket_Address,
         sizeof(ARCNET_Socket_Address));
+#endif
     /* did it get sent? */
     if (bytes < 0) {
         fprintf(stderr, "arcnet: Error sending packet: %s\n", strerror(errno));
@@ -237,6 +290,65 @@ int arcnet_send_pdu(
     return bytes;
 }
 
+/**
+ * @brief Find the NPDU in a received ARCNET frame
+ * @param src - returns the source address
+ * @param buf - received frame, starting with the ARCNET header
+ * @param received_bytes - number of octets received
+ * @param npdu - returns the start of the NPDU in the frame
+ * @return number of octets in the NPDU, or zero if it is not for us
+ */
+static uint16_t arcnet_frame_npdu(
+    BACNET_ADDRESS *src, uint8_t *buf, int received_bytes, uint8_t **npdu)
+{
+    uint16_t pdu_len = 0;
+    struct archdr *pkt = (struct archdr *)buf;
+
+    if (received_bytes < (ARC_HDR_SIZE + 4)) {
+        return 0;
+    }
+    /* printf("arcnet: received %u bytes (offset=%02Xh %02Xh) "
+       "from %02Xh (proto==%02Xh)\n",
+       received_bytes, pkt->offset[0], pkt->offset[1],
+       pkt->hard.source, pkt->soft.raw[0]);
+     */
+
+    if (pkt->hard.source == ARCNET_MAC_Address) {
+        fprintf(stderr, "arcnet: self sent packet?\n");
+        return 0;
+    }
+    if (pkt->soft.raw[0] != 0xCD) {
+        /* fprintf(stderr,"arcnet: Non-BACnet packet.\n"); */
+        return 0;
+    }
+    if ((pkt->hard.dest != ARCNET_MAC_Address) &&
+        (pkt->hard.dest != ARCNET_BROADCAST)) {
+        fprintf(stderr, "arcnet: This packet is not for us.\n");
+        return 0;
+    }
+    if ((pkt->soft.raw[1] != 0x82) || /* DSAP */
+        (pkt->soft.raw[2] != 0x82) || /* LSAP */
+        (pkt->soft.raw[3] != 0x03)) { /* LLC Control */
+        fprintf(stderr, "arcnet: BACnet packet has invalid LLC.\n");
+        return 0;
+    }
+    /* It must be addressed to us or be a Broadcast */
+    if ((pkt->hard.dest != ARCNET_MAC_Address) &&
+        (pkt->hard.dest != ARCNET_BROADCAST)) {
+        fprintf(stderr, "arcnet: This packet is not for us.\n");
+        return 0;
+    }
+    /* copy the source address */
+    src->mac_len = 1;
+    src->mac[0] = pkt->hard.source;
+    /* compute the PDU length */
+    pdu_len = received_bytes - ARC_HDR_SIZE;
+    pdu_len -= 4 /* SC, DSAP, SSAP, LLC Control */;
+    *npdu = &pkt->soft.raw[4];
+
+    return pdu_len;
+}
+
 /* receives an framed packet */
 /* returns the number of octets in the PDU, or zero on failure */
 uint16_t arcnet_receive(
@@ -247,11 +359,35 @@ uint16_t arcnet_receive(
 { /* milliseconds to wait for a packet */
     int received_bytes;
     uint8_t buf[512] = { 0 }; /* data */
+    uint8_t *npdu = NULL;
     uint16_t pdu_len = 0; /* return value */
     fd_set read_fds;
     int max;
     struct timeval select_timeout;
-    struct archdr *pkt = (struct archdr *)buf;
+#if ARCNET_RECEIVE_MMAP
+    uint8_t *frame;
+    uint16_t frame_len = 0;
+
+    if (packet_mmap_valid(&ARCNET_Ring)) {
+        /* the kernel has already dropped frames that are not BACnet */
+        do {
+            frame = packet_mmap_receive(&ARCNET_Ring, timeout, &frame_len);
+            if (!frame) {
+                break;
+            }
+            pdu_len = arcnet_frame_npdu(src, frame, frame_len, &npdu);
+            /* skip frames that are not for us, without waiting */
+            timeout = 0;
+        } while ((pdu_len == 0) && (packet_mmap_pending(&ARCNET_Ring) > 0));
+        if (pdu_len >= max_pdu) {
+            /* silently ignore packets that are too large */
+            pdu_len = 0;
+        } else if (pdu_len > 0) {
+            memcpy(&pdu[0], npdu, pdu_len);
+        }
+        return pdu_len;
+    }
+#endif
 
     /* Make sure the socket is open */
     if (ARCNET_Sock_FD <= 0) {
@@ -296,46 +432,10 @@ uint16_t arcnet_receive(
         return 0;
     }
 
-    /* printf("arcnet: received %u bytes (offset=%02Xh %02Xh) "
-       "from %02Xh (proto==%02Xh)\n",
-       received_bytes, pkt->offset[0], pkt->offset[1],
-       pkt->hard.source, pkt->soft.raw[0]);
-     */
-
-    if (pkt->hard.source == ARCNET_MAC_Address) {
-        fprintf(stderr, "arcnet: self sent packet?\n");
-        return 0;
-    }
-    if (pkt->soft.raw[0] != 0xCD) {
-        /* fprintf(stderr,"arcnet: Non-BACnet packet.\n"); */
-        return 0;
-    }
-    if ((pkt->hard.dest != ARCNET_MAC_Address) &&
-        (pkt->hard.dest != ARCNET_BROADCAST)) {
-        fprintf(stderr, "arcnet: This packet is not for us.\n");
-        return 0;
-    }
-    if ((pkt->soft.raw[1] != 0x82) || /* DSAP */
-        (pkt->soft.raw[2] != 0x82) || /* LSAP */
-        (pkt->soft.raw[3] != 0x03)) { /* LLC Control */
-        fprintf(stderr, "arcnet: BACnet packet has invalid LLC.\n");
-        return 0;
-    }
-    /* It must be addressed to us or be a Broadcast */
-    if ((pkt->hard.dest != ARCNET_MAC_Address) &&
-        (pkt->hard.dest != ARCNET_BROADCAST)) {
-        fprintf(stderr, "arcnet: This packet is not for us.\n");
-        return 0;
-    }
-    /* copy the source address */
-    src->mac_len = 1;
-    src->mac[0] = pkt->hard.source;
-    /* compute the PDU length */
-    pdu_len = received_bytes - ARC_HDR_SIZE;
-    pdu_len -= 4 /* SC, DSAP, SSAP, LLC Control */;
+    pdu_len = arcnet_frame_npdu(src, buf, received_bytes, &npdu);
     /* copy the buffer into the PDU */
     if (pdu_len < max_pdu) {
-        memmove(&pdu[0], &pkt->soft.raw[4], pdu_len);
+        memmove(&pdu[0], npdu, pdu_len);
     }
     /* silently ignore packets that are too large */
     else {
@@ -345,6 +445,58 @@ uint16_t arcnet_receive(
     return pdu_len;
 }
 
+/**
+ * @brief Receive ARCNET frames and give each NPDU to a handler, such as
+ *  npdu_handler(). With the receive ring, the NPDU is not copied, and
+ *  every frame of the block that is ready is handled in one call.
+ * @param handler - function that is given the source address and NPDU
+ * @param timeout - number of milliseconds to wait for a frame
+ * @return number of NPDUs given to the handler
+ */
+unsigned arcnet_receive_handler(
+    void (*handler)(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len),
+    unsigned timeout)
+{
+    BACNET_ADDRESS src = { 0 };
+    uint8_t pdu[MAX_PDU];
+    uint16_t pdu_len = 0;
+    unsigned count = 0;
+#if ARCNET_RECEIVE_MMAP
+    uint8_t *frame;
+    uint8_t *npdu = NULL;
+    uint16_t frame_len = 0;
+#endif
+
+    if (!handler) {
+        return 0;
+    }
+#if ARCNET_RECEIVE_MMAP
+    if (packet_mmap_valid(&ARCNET_Ring)) {
+        do {
+            frame = packet_mmap_receive(&ARCNET_Ring, timeout, &frame_len);
+            if (!frame) {
+                break;
+            }
+            pdu_len = arcnet_frame_npdu(&src, frame, frame_len, &npdu);
+            if ((pdu_len > 0) && (pdu_len <= MAX_PDU)) {
+                handler(&src, npdu, pdu_len);
+                count++;
+            }
+            /* only wait for the first frame */
+            timeout = 0;
+        } while (packet_mmap_pending(&ARCNET_Ring) > 0);
+        return count;
+    }
+#endif
+    pdu_len = arcnet_receive(&src, pdu, sizeof(pdu), timeout);
+    if (pdu_len > 0) {
+        handler(&src, pdu, pdu_len);
+        count++;
+    }
+
+    return count;
+}
+
 void arcnet_get_my_address(BACNET_ADDRESS *my_address)
 {
     int i = 0;
@@ -5,12 +5,14 @@
  * @date 2005
  * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
  */
+#define _GNU_SOURCE /* for sendmmsg and recvmmsg */
 #include <asm/types.h>
 #include <netinet/ether.h>
 #include <netinet/in.h>
 #include <net/if.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <sys/epoll.h>
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
 #include <sys/types.h>
@@ -31,9 +33,36 @@
 #include "bacnet/basic/bbmd/h_bbmd.h"
 #include "bacport.h"
 
+/* number of messages sent with each sendmmsg() system call */
+#ifndef BIP_SEND_BATCH_MAX
+#define BIP_SEND_BATCH_MAX 64
+#endif
+
+/* receive with epoll and recvmmsg() instead of select and recvfrom() */
+#ifndef BIP_RECEIVE_EPOLL
+#define BIP_RECEIVE_EPOLL 1
+#endif
+/* number of datagrams received with each recvmmsg() system call */
+#ifndef BIP_RECEIVE_BATCH_MAX
+#define BIP_RECEIVE_BATCH_MAX 16
+#endif
+
 /* unix sockets */
 static int BIP_Socket = -1;
 static int BIP_Broadcast_Socket = -1;
+#if BIP_RECEIVE_EPOLL
+static int BIP_Epoll_Fd = -1;
+/* datagrams received and not yet returned by bip_receive() */
+struct bip_receive_packet {
+    struct sockaddr_in sin;
+    int socket;
+    uint16_t length;
+    uint8_t mpdu[BIP_MPDU_MAX];
+};
+static struct bip_receive_packet BIP_Receive_Packet[BIP_RECEIVE_BATCH_MAX];
+static unsigned BIP_Receive_Head;
+static unsigned BIP_Receive_Count;
+#endif
 
 /* NOTE: we store address and port in network byte order
    since BACnet/IP uses network byte order for all address byte arrays
@@ -299,61 +328,108 @@ int bip_send_mpdu(
 }
 
 /**
- * BACnet/IP Datalink Receive handler.
+ * The send function for BACnet/IP driver layer that sends the same
+ * MPDU to many destinations, such as a BBMD forwarding a broadcast.
+ * The destinations are sent with as few system calls as possible,
+ * and every message refers to the one MPDU buffer.
  *
- * @param src - returns the source address
- * @param npdu - returns the NPDU buffer
- * @param max_npdu -maximum size of the NPDU buffer
- * @param timeout - number of milliseconds to wait for a packet
+ * @param dest - array of #BACNET_IP_ADDRESS destination addresses
+ * @param dest_count - number of destination addresses
+ * @param mtu - the bytes of data to send
+ * @param mtu_len - the number of bytes of data to send
  *
- * @return Number of bytes received, or 0 if none or timeout.
+ * @return Upon successful completion, returns the number of destinations
+ *  that the MPDU was sent to. Otherwise, -1 shall be returned to indicate
+ *  the error.
  */
-uint16_t bip_receive(
-    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t max_npdu, unsigned timeout)
+int bip_send_mpdu_batch(
+    const BACNET_IP_ADDRESS *dest,
+    unsigned dest_count,
+    const uint8_t *mtu,
+    uint16_t mtu_len)
 {
-    uint16_t npdu_len = 0; /* return value */
-    fd_set read_fds;
-    int max = 0;
-    struct timeval select_timeout;
-    struct sockaddr_in sin = { 0 };
-    BACNET_IP_ADDRESS addr = { 0 };
-    socklen_t sin_len = sizeof(sin);
-    int received_bytes = 0;
-    int offset = 0;
-    uint16_t i = 0;
-    int socket;
+    struct sockaddr_in bip_dest[BIP_SEND_BATCH_MAX];
+    struct mmsghdr msg[BIP_SEND_BATCH_MAX];
+    struct iovec iov = { 0 };
+    unsigned count = 0;
+    unsigned i = 0;
+    int sent_count = 0;
+    int rv = 0;
 
-    /* Make sure the socket is open */
+    /* assumes that the driver has already been initialized */
     if (BIP_Socket < 0) {
-        return 0;
+        if (BIP_Debug) {
+            fprintf(stderr, "BIP: driver not initialized!\n");
+            fflush(stderr);
+        }
+        return BIP_Socket;
     }
-    /* we could just use a non-blocking socket, but that consumes all
-       the CPU time.  We can use a timeout; it is only supported as
-       a select. */
-    if (timeout >= 1000) {
-        select_timeout.tv_sec = timeout / 1000;
-        select_timeout.tv_usec =
-            1000 * (timeout - select_timeout.tv_sec * 1000);
-    } else {
-        select_timeout.tv_sec = 0;
-        select_timeout.tv_usec = 1000 * timeout;
+    iov.iov_base = (void *)mtu;
+    iov.iov_len = mtu_len;
+    while (dest_count > 0) {
+        count = dest_count;
+        if (count > BIP_SEND_BATCH_MAX) {
+            count = BIP_SEND_BATCH_MAX;
+        }
+        for (i = 0; i < count; i++) {
+            /* load destination IP address */
+            memset(&bip_dest[i], 0, sizeof(bip_dest[i]));
+            bip_dest[i].sin_family = AF_INET;
+            memcpy(&bip_dest[i].sin_addr.s_addr, &dest[i].address[0], 4);
+            bip_dest[i].sin_port = htons(dest[i].port);
+            debug_print_ipv4(
+                "Sending MPDU->", &bip_dest[i].sin_addr,
+                bip_dest[i].sin_port, mtu_len);
+            memset(&msg[i], 0, sizeof(msg[i]));
+            msg[i].msg_hdr.msg_name = &bip_dest[i];
+            msg[i].msg_hdr.msg_namelen = sizeof(bip_dest[i]);
+            msg[i].msg_hdr.msg_iov = &iov;
+            msg[i].msg_hdr.msg_iovlen = 1;
+        }
+        rv = sendmmsg(BIP_Socket, msg, count, 0);
+        if (rv > 0) {
+            sent_count += rv;
+        } else if ((rv < 0) && (errno == EINTR)) {
+            continue;
+        } else {
+            /* the first message failed, so skip its destination */
+            if (BIP_Debug) {
+                perror("BIP: sendmmsg");
+            }
+            rv = 1;
+        }
+        /* the rest of a partial batch is sent with the next call */
+        dest += rv;
+        dest_count -= (unsigned)rv;
     }
-    FD_ZERO(&read_fds);
-    FD_SET(BIP_Socket, &read_fds);
-    FD_SET(BIP_Broadcast_Socket, &read_fds);
 
-    max = BIP_Socket > BIP_Broadcast_Socket ? BIP_Socket : BIP_Broadcast_Socket;
+    return sent_count;
+}
+
+/**
+ * @brief Handle a received BACnet/IP MPDU, and return its NPDU
+ * @param src - returns the source address
+ * @param npdu - the MPDU received, which returns the NPDU
+ * @param max_npdu - maximum size of the NPDU buffer
+ * @param received_bytes - number of bytes received
+ * @param sin - source IP address and port of the MPDU
+ * @param socket - socket that received the MPDU
+ * @return Number of bytes in the NPDU, or 0 if none.
+ */
+static uint16_t bip_receive_handler(
+    BACNET_ADDRESS *src,
+    uint8_t *npdu,
+    uint16_t max_npdu,
+    int received_bytes,
+    const struct sockaddr_in *sin,
+    int socket)
+{
+    uint16_t npdu_len = 0; /* return value */
+    BACNET_IP_ADDRESS addr = { 0 };
+    int max = 0;
+    int offset = 0;
+    uint16_t i = 0;
 
-    /* see if there is a packet for us */
-    if (select(max + 1, &read_fds, NULL, NULL, &select_timeout) > 0) {
-        socket =
-            FD_ISSET(BIP_Socket, &read_fds) ? BIP_Socket : BIP_Broadcast_Socket;
-        received_bytes = recvfrom(
-            socket, (char *)&npdu[0], max_npdu, 0, (struct sockaddr *)&sin,
-            &sin_len);
-    } else {
-        return 0;
-    }
     /* See if there is a problem */
     if (received_bytes < 0) {
         return 0;
@@ -382,10 +458,10 @@ uint16_t bip_receive(
        shall be transmitted with the most significant octet first). This
        address shall be referred to as a B/IPv4 address.
     */
-    memcpy(&addr.address[0], &sin.sin_addr.s_addr, 4);
-    addr.port = ntohs(sin.sin_port);
+    memcpy(&addr.address[0], &sin->sin_addr.s_addr, 4);
+    addr.port = ntohs(sin->sin_port);
     debug_print_ipv4(
-        "Received MPDU->", &sin.sin_addr, sin.sin_port, received_bytes);
+        "Received MPDU->", &sin->sin_addr, sin->sin_port, received_bytes);
     /* pass the packet into the BBMD handler */
     if (socket == BIP_Socket) {
         offset = bvlc_handler(&addr, src, npdu, received_bytes);
@@ -395,7 +471,7 @@ uint16_t bip_receive(
     if (offset > 0) {
         npdu_len = received_bytes - offset;
         debug_print_ipv4(
-            "Received NPDU->", &sin.sin_addr, sin.sin_port, npdu_len);
+            "Received NPDU->", &sin->sin_addr, sin->sin_port, npdu_len);
         if (npdu_len <= max_npdu) {
             /* shift the buffer to return a valid NPDU */
             for (i = 0; i < npdu_len; i++) {
@@ -413,6 +489,160 @@ uint16_t bip_receive(
     return npdu_len;
 }
 
+#if BIP_RECEIVE_EPOLL
+/**
+ * @brief Wait for datagrams on the unicast and broadcast sockets, and
+ *  receive as many as are waiting, up to BIP_RECEIVE_BATCH_MAX, with one
+ *  recvmmsg() system call per socket.
+ * @param timeout - number of milliseconds to wait for a datagram
+ */
+static void bip_receive_batch(unsigned timeout)
+{
+    struct epoll_event events[2];
+    struct mmsghdr msg[BIP_RECEIVE_BATCH_MAX];
+    struct iovec iov[BIP_RECEIVE_BATCH_MAX];
+    struct bip_receive_packet *packet;
+    unsigned count = 0;
+    unsigned limit = 0;
+    unsigned j = 0;
+    int nfds = 0;
+    int i = 0;
+    int rv = 0;
+
+    if (timeout > INT32_MAX) {
+        timeout = INT32_MAX;
+    }
+    nfds = epoll_wait(BIP_Epoll_Fd, events, 2, (int)timeout);
+    for (i = 0; i < nfds; i++) {
+        /* share the free packets between the sockets that are ready */
+        limit = (BIP_RECEIVE_BATCH_MAX - count) / (unsigned)(nfds - i);
+        if (limit == 0) {
+            break;
+        }
+        for (j = 0; j < limit; j++) {
+            packet = &BIP_Receive_Packet[count + j];
+            iov[j].iov_base = packet->mpdu;
+            iov[j].iov_len = sizeof(packet->mpdu);
+            memset(&msg[j], 0, sizeof(msg[j]));
+            msg[j].msg_hdr.msg_name = &packet->sin;
+            msg[j].msg_hdr.msg_namelen = sizeof(packet->sin);
+            msg[j].msg_hdr.msg_iov = &iov[j];
+            msg[j].msg_hdr.msg_iovlen = 1;
+        }
+        rv = recvmmsg(events[i].data.fd, msg, limit, MSG_DONTWAIT, NULL);
+        for (j = 0; (rv > 0) && (j < (unsigned)rv); j++) {
+            packet = &BIP_Receive_Packet[count + j];
+            packet->socket = events[i].data.fd;
+            packet->length = (uint16_t)msg[j].msg_len;
+        }
+        if (rv > 0) {
+            count += (unsigned)rv;
+        }
+    }
+    BIP_Receive_Head = 0;
+    BIP_Receive_Count = count;
+}
+
+/**
+ * BACnet/IP Datalink Receive handler.
+ * Datagrams are received in batches, and returned one at a time
+ * without another system call until the batch is empty.
+ *
+ * @param src - returns the source address
+ * @param npdu - returns the NPDU buffer
+ * @param max_npdu -maximum size of the NPDU buffer
+ * @param timeout - number of milliseconds to wait for a packet
+ *
+ * @return Number of bytes received, or 0 if none or timeout.
+ */
+uint16_t bip_receive(
+    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t max_npdu, unsigned timeout)
+{
+    struct bip_receive_packet *packet;
+    int received_bytes = 0;
+
+    /* Make sure the socket is open */
+    if ((BIP_Socket < 0) || (BIP_Epoll_Fd < 0)) {
+        return 0;
+    }
+    if (BIP_Receive_Count == 0) {
+        bip_receive_batch(timeout);
+        if (BIP_Receive_Count == 0) {
+            return 0;
+        }
+    }
+    packet = &BIP_Receive_Packet[BIP_Receive_Head];
+    BIP_Receive_Head++;
+    BIP_Receive_Count--;
+    /* a datagram larger than the buffer is truncated, as with recvfrom() */
+    received_bytes = packet->length;
+    if (received_bytes > max_npdu) {
+        received_bytes = max_npdu;
+    }
+    memcpy(npdu, packet->mpdu, received_bytes);
+
+    return bip_receive_handler(
+        src, npdu, max_npdu, received_bytes, &packet->sin, packet->socket);
+}
+#else
+/**
+ * BACnet/IP Datalink Receive handler.
+ *
+ * @param src - returns the source address
+ * @param npdu - returns the NPDU buffer
+ * @param max_npdu -maximum size of the NPDU buffer
+ * @param timeout - number of milliseconds to wait for a packet
+ *
+ * @return Number of bytes received, or 0 if none or timeout.
+ */
+uint16_t bip_receive(
+    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t max_npdu, unsigned timeout)
+{
+    fd_set read_fds;
+    int max = 0;
+    struct timeval select_timeout;
+    struct sockaddr_in sin = { 0 };
+    socklen_t sin_len = sizeof(sin);
+    int received_bytes = 0;
+    int socket;
+
+    /* Make sure the socket is open */
+    if (BIP_Socket < 0) {
+        return 0;
+    }
+    /* we could just use a non-blocking socket, but that consumes all
+       the CPU time.  We can use a timeout; it is only supported as
+       a select. */
+    if (timeout >= 1000) {
+        select_timeout.tv_sec = timeout / 1000;
+        select_timeout.tv_usec =
+            1000 * (timeout - select_timeout.tv_sec * 1000);
+    } else {
+        select_timeout.tv_sec = 0;
+        select_timeout.tv_usec = 1000 * timeout;
+    }
+    FD_ZERO(&read_fds);
+    FD_SET(BIP_Socket, &read_fds);
+    FD_SET(BIP_Broadcast_Socket, &read_fds);
+
+    max = BIP_Socket > BIP_Broadcast_Socket ? BIP_Socket : BIP_Broadcast_Socket;
+
+    /* see if there is a packet for us */
+    if (select(max + 1, &read_fds, NULL, NULL, &select_timeout) > 0) {
+        socket =
+            FD_ISSET(BIP_Socket, &read_fds) ? BIP_Socket : BIP_Broadcast_Socket;
+        received_bytes = recvfrom(
+            socket, (char *)&npdu[0], max_npdu, 0, (struct sockaddr *)&sin,
+            &sin_len);
+    } else {
+        return 0;
+    }
+
+    return bip_receive_handler(
+        src, npdu, max_npdu, received_bytes, &sin, socket);
+}
+#endif
+
 /**
  * The common send function for BACnet/IP application layer
  *
@@ -864,6 +1094,49 @@ static int createSocket(const struct sockaddr_in *sin)
     return sock_fd;
 }
 
+#if BIP_RECEIVE_EPOLL
+/**
+ * @brief Create the epoll instance that waits on the unicast and
+ *  broadcast sockets
+ * @return true if the epoll instance was created
+ */
+static bool bip_receive_epoll_init(void)
+{
+    struct epoll_event event = { 0 };
+    int sockets[2];
+    int i;
+
+    if (BIP_Epoll_Fd != -1) {
+        close(BIP_Epoll_Fd);
+    }
+    BIP_Receive_Head = 0;
+    BIP_Receive_Count = 0;
+    BIP_Epoll_Fd = epoll_create1(EPOLL_CLOEXEC);
+    if (BIP_Epoll_Fd < 0) {
+        if (BIP_Debug) {
+            perror("BIP: epoll_create1");
+        }
+        return false;
+    }
+    sockets[0] = BIP_Socket;
+    sockets[1] = BIP_Broadcast_Socket;
+    for (i = 0; i < 2; i++) {
+        event.events = EPOLLIN;
+        event.data.fd = sockets[i];
+        if (epoll_ctl(BIP_Epoll_Fd, EPOLL_CTL_ADD, sockets[i], &event) < 0) {
+            if (BIP_Debug) {
+                perror("BIP: epoll_ctl");
+            }
+            close(BIP_Epoll_Fd);
+            BIP_Epoll_Fd = -1;
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
 /** Initialize the BACnet/IP services at the given interface.
  * @ingroup DLBIP
  * -# Gets the local IP address and local broadcast address from the system,
@@ -926,6 +1199,11 @@ bool bip_init(char *ifname)
     if (sock_fd < 0) {
         return false;
     }
+#if BIP_RECEIVE_EPOLL
+    if (!bip_receive_epoll_init()) {
+        return false;
+    }
+#endif
 
     bvlc_init();
 
@@ -955,6 +1233,14 @@ void bip_cleanup(void)
         close(BIP_Broadcast_Socket);
     }
     BIP_Broadcast_Socket = -1;
+#if BIP_RECEIVE_EPOLL
+    if (BIP_Epoll_Fd != -1) {
+        close(BIP_Epoll_Fd);
+    }
+    BIP_Epoll_Fd = -1;
+    BIP_Receive_Head = 0;
+    BIP_Receive_Count = 0;
+#endif
     /* these were set non-zero during interface configuration */
     BIP_Address.s_addr = 0;
     BIP_Broadcast_Addr.s_addr = 0;
@@ -1,8 +1,19 @@
 /**
  * @file
- * @brief Provides Linux-specific DataLink functions for MS/TP.
+ * @brief Provides Linux-specific DataLink functions for MS/TP, for any
+ *  number of ports in one process.
  * @author Steve Karg <skarg@users.sourceforge.net>
  * @date 2008
+ *
+ * @section DESCRIPTION
+ *
+ * Each port has a thread of its own, with real-time scheduling when
+ * permitted, that sleeps in poll() until octets arrive or until the next
+ * timeout of the MS/TP state machines. All of the octets that arrived are
+ * read at once and run through the receive state machine, and a frame is
+ * answered as soon as its last octet is seen. Each frame is stamped with
+ * the time in microseconds that its last octet arrived.
+ *
  * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
  */
 #include <stdbool.h>
@@ -13,6 +24,8 @@
 #include <stdio.h>
 #include <time.h>
 #include <errno.h>
+#include <poll.h>
+#include <sched.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
@@ -20,7 +33,6 @@
 #include "bacnet/bacaddr.h"
 #include "bacnet/npdu.h"
 #include "bacnet/datalink/mstp.h"
-#include "bacnet/basic/sys/ringbuf.h"
 #include "bacnet/basic/sys/debug.h"
 /* port specific */
 #include "dlmstp_port.h"
@@ -38,25 +50,42 @@
         if (x < 0xFFFF)               \
             x++;                      \
     }
+
+#define MSTP_PDU_PACKET_MASK (MSTP_PDU_PACKET_COUNT - 1)
+#define MSTP_RECEIVE_PACKET_MASK (MSTP_RECEIVE_PACKET_COUNT - 1)
+/* bits of an octet on the wire: start, 8 data, stop */
+#define DLMSTP_OCTET_BITS 10UL
+/* longest that the port thread sleeps in a state that has no timeout */
+#define DLMSTP_POLL_TIMEOUT_MAX 5
+
+/**
+ * @brief Get the time of the monotonic clock
+ * @return microseconds since an arbitrary start
+ */
+static uint64_t dlmstp_microseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000ULL) +
+        ((uint64_t)now.tv_nsec / 1000ULL);
+}
+
 static uint32_t Timer_Silence(void *poPort)
 {
-    int32_t res;
-    struct timeval now, tmp_diff;
     SHARED_MSTP_DATA *poSharedData;
     struct mstp_port_struct_t *mstp_port = (struct mstp_port_struct_t *)poPort;
     if (!mstp_port) {
-        return -1;
+        return 0;
     }
     poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
     if (!poSharedData) {
-        return -1;
+        return 0;
     }
 
-    gettimeofday(&now, NULL);
-    timersub(&poSharedData->start, &now, &tmp_diff);
-    res = ((tmp_diff.tv_sec) * 1000 + (tmp_diff.tv_usec) / 1000);
-
-    return (res >= 0 ? res : -res);
+    return (uint32_t)(
+        (dlmstp_microseconds() - poSharedData->Silence_Start) / 1000ULL);
 }
 
 static void Timer_Silence_Reset(void *poPort)
@@ -71,7 +100,7 @@ static void Timer_Silence_Reset(void *poPort)
         return;
     }
 
-    gettimeofday(&poSharedData->start, NULL);
+    poSharedData->Silence_Start = dlmstp_microseconds();
 }
 
 static void get_abstime(struct timespec *abstime, unsigned long milliseconds)
@@ -79,8 +108,8 @@ static void get_abstime(struct timespec *abstime, unsigned long milliseconds)
     struct timeval now, offset, result;
 
     gettimeofday(&now, NULL);
-    offset.tv_sec = 0;
-    offset.tv_usec = milliseconds * 1000;
+    offset.tv_sec = milliseconds / 1000;
+    offset.tv_usec = (milliseconds % 1000) * 1000;
     timeradd(&now, &offset, &result);
     abstime->tv_sec = result.tv_sec;
     abstime->tv_nsec = result.tv_usec * 1000;
@@ -98,15 +127,15 @@ void dlmstp_cleanup(void *poPort)
         return;
     }
 
+    if (__atomic_exchange_n(
+            &poSharedData->Thread_Run, false, __ATOMIC_ACQ_REL)) {
+        pthread_join(poSharedData->Thread, NULL);
+    }
     /* restore the old port settings */
     tcsetattr(poSharedData->RS485_Handle, TCSANOW, &poSharedData->RS485_oldtio);
     close(poSharedData->RS485_Handle);
 
-    pthread_cond_destroy(&poSharedData->Received_Frame_Flag);
     sem_destroy(&poSharedData->Receive_Packet_Flag);
-    pthread_cond_destroy(&poSharedData->Master_Done_Flag);
-    pthread_mutex_destroy(&poSharedData->Received_Frame_Mutex);
-    pthread_mutex_destroy(&poSharedData->Master_Done_Mutex);
 }
 
 /* returns number of bytes sent on success, zero on failure */
@@ -116,9 +145,8 @@ int dlmstp_send_pdu(
     uint8_t *pdu, /* any data to be sent - may be null */
     unsigned pdu_len)
 { /* number of bytes of data */
-    int bytes_sent = 0;
     struct mstp_pdu_packet *pkt;
-    unsigned i = 0;
+    unsigned head, tail;
     SHARED_MSTP_DATA *poSharedData;
     struct mstp_port_struct_t *mstp_port = (struct mstp_port_struct_t *)poPort;
     if (!mstp_port) {
@@ -128,33 +156,51 @@ int dlmstp_send_pdu(
     if (!poSharedData) {
         return 0;
     }
+    if (pdu_len > sizeof(pkt->buffer)) {
+        return 0;
+    }
 
-    pkt = (struct mstp_pdu_packet *)Ringbuf_Data_Peek(&poSharedData->PDU_Queue);
-    if (pkt) {
-        pkt->data_expecting_reply =
-            BACNET_DATA_EXPECTING_REPLY(pdu[BACNET_PDU_CONTROL_BYTE_OFFSET]);
-        for (i = 0; i < pdu_len; i++) {
-            pkt->buffer[i] = pdu[i];
-        }
-        pkt->length = pdu_len;
-        pkt->destination_mac = dest->mac[0];
-        if (Ringbuf_Data_Put(&poSharedData->PDU_Queue, (uint8_t *)pkt)) {
-            bytes_sent = pdu_len;
-        }
+    tail = poSharedData->PDU_Tail;
+    head = __atomic_load_n(&poSharedData->PDU_Head, __ATOMIC_ACQUIRE);
+    if ((tail - head) >= MSTP_PDU_PACKET_COUNT) {
+        /* full */
+        return 0;
     }
+    pkt = &poSharedData->PDU_Buffer[tail & MSTP_PDU_PACKET_MASK];
+    pkt->data_expecting_reply =
+        BACNET_DATA_EXPECTING_REPLY(pdu[BACNET_PDU_CONTROL_BYTE_OFFSET]);
+    memcpy(pkt->buffer, pdu, pdu_len);
+    pkt->length = pdu_len;
+    pkt->destination_mac = dest->mac[0];
+    __atomic_store_n(&poSharedData->PDU_Tail, tail + 1, __ATOMIC_RELEASE);
 
-    return bytes_sent;
+    return pdu_len;
 }
 
-uint16_t dlmstp_receive(
+/**
+ * @brief Receive a packet from the port, and the time it arrived
+ * @param poPort - port specific data
+ * @param src - source address of the packet, or NULL
+ * @param pdu - buffer for the packet, or NULL
+ * @param max_pdu - number of octets available in the buffer. A packet
+ *  that does not fit in the buffer is discarded.
+ * @param timeout - milliseconds to wait for a packet
+ * @param timestamp - CLOCK_MONOTONIC microseconds that the last octet of
+ *  the frame arrived, or NULL
+ * @return the number of octets in the packet, or zero on failure
+ */
+uint16_t dlmstp_receive_timestamp(
     void *poPort,
-    BACNET_ADDRESS *src, /* source address */
-    uint8_t *pdu, /* PDU data */
-    uint16_t max_pdu, /* amount of space available in the PDU  */
-    unsigned timeout)
-{ /* milliseconds to wait for a packet */
+    BACNET_ADDRESS *src,
+    uint8_t *pdu,
+    uint16_t max_pdu,
+    unsigned timeout,
+    uint64_t *timestamp)
+{
     uint16_t pdu_len = 0;
     struct timespec abstime;
+    DLMSTP_PACKET *packet;
+    unsigned head;
     int rv = 0;
     SHARED_MSTP_DATA *poSharedData;
     struct mstp_port_struct_t *mstp_port = (struct mstp_port_struct_t *)poPort;
@@ -165,125 +211,182 @@ uint16_t dlmstp_receive(
     if (!poSharedData) {
         return 0;
     }
-    (void)max_pdu;
-    /* see if there is a packet available, and a place
-       to put the reply (if necessary) and process it */
-    get_abstime(&abstime, timeout);
-    rv = sem_timedwait(&poSharedData->Receive_Packet_Flag, &abstime);
+    /* the semaphore counts the packets in the queue */
+    rv = sem_trywait(&poSharedData->Receive_Packet_Flag);
+    if ((rv != 0) && (timeout > 0)) {
+        get_abstime(&abstime, timeout);
+        do {
+            rv = sem_timedwait(&poSharedData->Receive_Packet_Flag, &abstime);
+        } while ((rv != 0) && (errno == EINTR));
+    }
     if (rv == 0) {
-        if (poSharedData->Receive_Packet.ready) {
-            if (poSharedData->Receive_Packet.pdu_len) {
-                poSharedData->MSTP_Packets++;
-                if (src) {
-                    memmove(
-                        src, &poSharedData->Receive_Packet.address,
-                        sizeof(poSharedData->Receive_Packet.address));
-                }
-                if (pdu) {
-                    memmove(
-                        pdu, &poSharedData->Receive_Packet.pdu,
-                        sizeof(poSharedData->Receive_Packet.pdu));
-                }
-                pdu_len = poSharedData->Receive_Packet.pdu_len;
+        head = poSharedData->Receive_Head;
+        packet = &poSharedData->Receive_Queue[head & MSTP_RECEIVE_PACKET_MASK];
+        if (packet->pdu_len && (!pdu || (packet->pdu_len <= max_pdu))) {
+            poSharedData->MSTP_Packets++;
+            if (src) {
+                memcpy(src, &packet->address, sizeof(packet->address));
+            }
+            if (pdu) {
+                memcpy(pdu, packet->pdu, packet->pdu_len);
+            }
+            if (timestamp) {
+                *timestamp = packet->timestamp;
             }
-            poSharedData->Receive_Packet.ready = false;
+            pdu_len = packet->pdu_len;
         }
+        __atomic_store_n(
+            &poSharedData->Receive_Head, head + 1, __ATOMIC_RELEASE);
     }
 
     return pdu_len;
 }
 
-static void *dlmstp_receive_fsm_task(void *pArg)
+uint16_t dlmstp_receive(
+    void *poPort,
+    BACNET_ADDRESS *src, /* source address */
+    uint8_t *pdu, /* PDU data */
+    uint16_t max_pdu, /* amount of space available in the PDU  */
+    unsigned timeout)
+{ /* milliseconds to wait for a packet */
+    return dlmstp_receive_timestamp(poPort, src, pdu, max_pdu, timeout, NULL);
+}
+
+/**
+ * @brief Run the master or slave node state machine when a frame was
+ *  received, or when the silence timer reached the timeout of its state
+ * @param mstp_port - port specific data
+ */
+static void dlmstp_node_fsm(struct mstp_port_struct_t *mstp_port)
 {
-    bool received_frame;
-    SHARED_MSTP_DATA *poSharedData;
-    struct mstp_port_struct_t *mstp_port = (struct mstp_port_struct_t *)pArg;
-    if (!mstp_port) {
-        return NULL;
-    }
+    uint32_t silence = 0;
+    bool run_master = false;
 
-    poSharedData =
-        (SHARED_MSTP_DATA *)((struct mstp_port_struct_t *)pArg)->UserData;
-    if (!poSharedData) {
-        return NULL;
-    }
-
-    for (;;) {
-        /* only do receive state machine while we don't have a frame */
-        if ((mstp_port->ReceivedValidFrame == false) &&
-            (mstp_port->ReceivedInvalidFrame == false)) {
-            do {
-                RS485_Check_UART_Data(mstp_port);
-                MSTP_Receive_Frame_FSM((struct mstp_port_struct_t *)pArg);
-                received_frame = mstp_port->ReceivedValidFrame ||
-                    mstp_port->ReceivedInvalidFrame;
-                if (received_frame) {
-                    pthread_cond_signal(&poSharedData->Received_Frame_Flag);
-                    break;
+    if (mstp_port->ReceivedValidFrame || mstp_port->ReceivedInvalidFrame) {
+        run_master = true;
+    } else {
+        silence = mstp_port->SilenceTimer(mstp_port);
+        switch (mstp_port->master_state) {
+            case MSTP_MASTER_STATE_IDLE:
+                if (silence >= Tno_token) {
+                    run_master = true;
+                }
+                break;
+            case MSTP_MASTER_STATE_WAIT_FOR_REPLY:
+                if (silence >= mstp_port->Treply_timeout) {
+                    run_master = true;
+                }
+                break;
+            case MSTP_MASTER_STATE_POLL_FOR_MASTER:
+                if (silence >= mstp_port->Tusage_timeout) {
+                    run_master = true;
                 }
-            } while (mstp_port->DataAvailable);
+                break;
+            default:
+                run_master = true;
+                break;
+        }
+    }
+    if (run_master) {
+        if (mstp_port->This_Station <= DEFAULT_MAX_MASTER) {
+            while (MSTP_Master_Node_FSM(mstp_port)) {
+                /* do nothing while immediate transitioning */
+            }
+        } else if (mstp_port->This_Station < 255) {
+            MSTP_Slave_Node_FSM(mstp_port);
         }
     }
-
-    return NULL;
 }
 
-static void *dlmstp_master_fsm_task(void *pArg)
+/**
+ * @brief Get the time the port thread may sleep until the next timeout
+ *  of the MS/TP state machines, if no octets arrive
+ * @param mstp_port - port specific data
+ * @return milliseconds to wait in poll()
+ */
+static int dlmstp_poll_timeout(struct mstp_port_struct_t *mstp_port)
 {
-    uint32_t silence = 0;
-    bool run_master = false;
-    SHARED_MSTP_DATA *poSharedData;
-    struct mstp_port_struct_t *mstp_port = (struct mstp_port_struct_t *)pArg;
-    if (!mstp_port) {
-        return NULL;
-    }
+    uint32_t silence, timeout;
 
-    poSharedData =
-        (SHARED_MSTP_DATA *)((struct mstp_port_struct_t *)pArg)->UserData;
-    if (!poSharedData) {
-        return NULL;
+    if (mstp_port->receive_state != MSTP_RECEIVE_STATE_IDLE) {
+        /* Tframe_abort is only a few octet times */
+        return 1;
+    }
+    if (mstp_port->This_Station > DEFAULT_MAX_MASTER) {
+        return DLMSTP_POLL_TIMEOUT_MAX;
+    }
+    switch (mstp_port->master_state) {
+        case MSTP_MASTER_STATE_IDLE:
+            timeout = Tno_token;
+            break;
+        case MSTP_MASTER_STATE_WAIT_FOR_REPLY:
+            timeout = mstp_port->Treply_timeout;
+            break;
+        case MSTP_MASTER_STATE_POLL_FOR_MASTER:
+            timeout = mstp_port->Tusage_timeout;
+            break;
+        default:
+            /* waiting on the application, or on a short timeout */
+            return 1;
+    }
+    silence = mstp_port->SilenceTimer(mstp_port);
+    if (silence >= timeout) {
+        return 0;
     }
 
-    for (;;) {
-        if (mstp_port->ReceivedValidFrame == false &&
-            mstp_port->ReceivedInvalidFrame == false) {
-            RS485_Check_UART_Data(mstp_port);
-            MSTP_Receive_Frame_FSM(mstp_port);
-        }
-        if (mstp_port->ReceivedValidFrame || mstp_port->ReceivedInvalidFrame) {
-            run_master = true;
-        } else {
-            silence = mstp_port->SilenceTimer(NULL);
-            switch (mstp_port->master_state) {
-                case MSTP_MASTER_STATE_IDLE:
-                    if (silence >= Tno_token) {
-                        run_master = true;
-                    }
-                    break;
-                case MSTP_MASTER_STATE_WAIT_FOR_REPLY:
-                    if (silence >= mstp_port->Treply_timeout) {
-                        run_master = true;
-                    }
-                    break;
-                case MSTP_MASTER_STATE_POLL_FOR_MASTER:
-                    if (silence >= mstp_port->Tusage_timeout) {
-                        run_master = true;
-                    }
-                    break;
-                default:
-                    run_master = true;
-                    break;
+    return (int)(timeout - silence);
+}
+
+/**
+ * @brief Thread of one port, which runs its state machines until
+ *  dlmstp_cleanup() is called
+ * @param pArg - port specific data
+ */
+static void *dlmstp_port_task(void *pArg)
+{
+    struct mstp_port_struct_t *mstp_port = (struct mstp_port_struct_t *)pArg;
+    SHARED_MSTP_DATA *poSharedData;
+    uint8_t buffer[DLMSTP_READ_MAX];
+    struct pollfd fds;
+    uint64_t octet_usec, now;
+    ssize_t count, i;
+
+    poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
+    octet_usec =
+        (DLMSTP_OCTET_BITS * 1000000UL) / RS485_Get_Port_Baud_Rate(mstp_port);
+    fds.fd = poSharedData->RS485_Handle;
+    fds.events = POLLIN;
+    while (__atomic_load_n(&poSharedData->Thread_Run, __ATOMIC_ACQUIRE)) {
+        fds.revents = 0;
+        count = 0;
+        if (poll(&fds, 1, dlmstp_poll_timeout(mstp_port)) > 0) {
+            if (fds.revents & POLLIN) {
+                count = read(fds.fd, buffer, sizeof(buffer));
+            } else {
+                /* the port is gone - keep the timers running */
+                usleep(DLMSTP_POLL_TIMEOUT_MAX * 1000);
             }
         }
-        if (run_master) {
-            if (mstp_port->This_Station <= DEFAULT_MAX_MASTER) {
-                while (MSTP_Master_Node_FSM(mstp_port)) {
-                    /* do nothing while immediate transitioning */
-                }
-            } else if (mstp_port->This_Station < 255) {
-                MSTP_Slave_Node_FSM(mstp_port);
+        now = dlmstp_microseconds();
+        for (i = 0; i < count; i++) {
+            mstp_port->DataRegister = buffer[i];
+            mstp_port->DataAvailable = true;
+            MSTP_Receive_Frame_FSM(mstp_port);
+            if (mstp_port->ReceivedValidFrame ||
+                mstp_port->ReceivedInvalidFrame) {
+                /* the octets after this one came in later */
+                poSharedData->Frame_Timestamp =
+                    now - ((uint64_t)(count - 1 - i) * octet_usec);
+                poSharedData->Frame_Answered = !mstp_port->ReceivedValidFrame ||
+                    (mstp_port->DestinationAddress != mstp_port->This_Station);
+                dlmstp_node_fsm(mstp_port);
             }
         }
+        if (count <= 0) {
+            /* no octets - check the timeouts of the receive state machine */
+            MSTP_Receive_Frame_FSM(mstp_port);
+        }
+        dlmstp_node_fsm(mstp_port);
     }
 
     return NULL;
@@ -316,27 +419,35 @@ void dlmstp_fill_bacnet_address(BACNET_ADDRESS *src, uint8_t mstp_address)
 uint16_t MSTP_Put_Receive(struct mstp_port_struct_t *mstp_port)
 {
     uint16_t pdu_len = 0;
+    DLMSTP_PACKET *packet;
+    unsigned head, tail;
     SHARED_MSTP_DATA *poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
 
     if (!poSharedData) {
         return 0;
     }
 
-    if (!poSharedData->Receive_Packet.ready) {
-        /* bounds check - maybe this should send an abort? */
-        pdu_len = mstp_port->DataLength;
-        if (pdu_len > sizeof(poSharedData->Receive_Packet.pdu)) {
-            pdu_len = sizeof(poSharedData->Receive_Packet.pdu);
-        }
-        memmove(
-            (void *)&poSharedData->Receive_Packet.pdu[0],
-            (void *)&mstp_port->InputBuffer[0], pdu_len);
-        dlmstp_fill_bacnet_address(
-            &poSharedData->Receive_Packet.address, mstp_port->SourceAddress);
-        poSharedData->Receive_Packet.pdu_len = mstp_port->DataLength;
-        poSharedData->Receive_Packet.ready = true;
-        sem_post(&poSharedData->Receive_Packet_Flag);
+    tail = poSharedData->Receive_Tail;
+    head = __atomic_load_n(&poSharedData->Receive_Head, __ATOMIC_ACQUIRE);
+    if ((tail - head) >= MSTP_RECEIVE_PACKET_COUNT) {
+        debug_printf("MS/TP: Dropped! Receive queue is full.\n");
+        __atomic_fetch_add(&poSharedData->Receive_Dropped, 1, __ATOMIC_RELAXED);
+        return 0;
     }
+    packet = &poSharedData->Receive_Queue[tail & MSTP_RECEIVE_PACKET_MASK];
+    /* bounds check - maybe this should send an abort? */
+    pdu_len = mstp_port->DataLength;
+    if (pdu_len > sizeof(packet->pdu)) {
+        pdu_len = sizeof(packet->pdu);
+    }
+    memcpy(packet->pdu, mstp_port->InputBuffer, pdu_len);
+    dlmstp_fill_bacnet_address(&packet->address, mstp_port->SourceAddress);
+    packet->pdu_len = pdu_len;
+    packet->frame_type = mstp_port->FrameType;
+    packet->timestamp = poSharedData->Frame_Timestamp;
+    packet->ready = true;
+    __atomic_store_n(&poSharedData->Receive_Tail, tail + 1, __ATOMIC_RELEASE);
+    sem_post(&poSharedData->Receive_Packet_Flag);
 
     return pdu_len;
 }
@@ -348,6 +459,7 @@ uint16_t MSTP_Get_Send(struct mstp_port_struct_t *mstp_port, unsigned timeout)
     uint16_t pdu_len = 0;
     uint8_t frame_type = 0;
     struct mstp_pdu_packet *pkt;
+    unsigned head, tail;
     SHARED_MSTP_DATA *poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
 
     if (!poSharedData) {
@@ -355,10 +467,12 @@ uint16_t MSTP_Get_Send(struct mstp_port_struct_t *mstp_port, unsigned timeout)
     }
 
     (void)timeout;
-    if (Ringbuf_Empty(&poSharedData->PDU_Queue)) {
+    head = poSharedData->PDU_Head;
+    tail = __atomic_load_n(&poSharedData->PDU_Tail, __ATOMIC_ACQUIRE);
+    if (head == tail) {
         return 0;
     }
-    pkt = (struct mstp_pdu_packet *)Ringbuf_Peek(&poSharedData->PDU_Queue);
+    pkt = &poSharedData->PDU_Buffer[head & MSTP_PDU_PACKET_MASK];
     if (pkt->data_expecting_reply) {
         frame_type = FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY;
     } else {
@@ -369,7 +483,7 @@ uint16_t MSTP_Get_Send(struct mstp_port_struct_t *mstp_port, unsigned timeout)
         &mstp_port->OutputBuffer[0], /* <-- loading this */
         mstp_port->OutputBufferSize, frame_type, pkt->destination_mac,
         mstp_port->This_Station, (uint8_t *)&pkt->buffer[0], pkt->length);
-    (void)Ringbuf_Pop(&poSharedData->PDU_Queue, NULL);
+    __atomic_store_n(&poSharedData->PDU_Head, head + 1, __ATOMIC_RELEASE);
 
     return pdu_len;
 }
@@ -385,6 +499,23 @@ void MSTP_Send_Frame(
     const uint8_t *buffer,
     uint16_t nbytes)
 {
+    SHARED_MSTP_DATA *poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
+    uint32_t latency;
+
+    if (poSharedData && !poSharedData->Frame_Answered) {
+        /* the first frame sent after a frame to this station */
+        poSharedData->Frame_Answered = true;
+        latency =
+            (uint32_t)(dlmstp_microseconds() - poSharedData->Frame_Timestamp);
+        __atomic_store_n(
+            &poSharedData->Reply_Latency, latency, __ATOMIC_RELAXED);
+        if (latency >
+            __atomic_load_n(
+                &poSharedData->Reply_Latency_Max, __ATOMIC_RELAXED)) {
+            __atomic_store_n(
+                &poSharedData->Reply_Latency_Max, latency, __ATOMIC_RELAXED);
+        }
+    }
     RS485_Send_Frame(mstp_port, buffer, nbytes);
 }
 
@@ -526,36 +657,30 @@ uint16_t MSTP_Get_Reply(struct mstp_port_struct_t *mstp_port, unsigned timeout)
     uint16_t pdu_len = 0; /* return value */
     bool matched = false;
     uint8_t frame_type = 0;
-    struct mstp_pdu_packet *pkt;
+    struct mstp_pdu_packet *pkt = NULL;
+    unsigned head, tail, index;
     SHARED_MSTP_DATA *poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
 
     (void)timeout;
     if (!poSharedData) {
         return 0;
     }
-    if (Ringbuf_Empty(&poSharedData->PDU_Queue)) {
-        return 0;
+    head = poSharedData->PDU_Head;
+    tail = __atomic_load_n(&poSharedData->PDU_Tail, __ATOMIC_ACQUIRE);
+    /* Walk the queue to see if we can find a match */
+    for (index = head; index != tail; index++) {
+        pkt = &poSharedData->PDU_Buffer[index & MSTP_PDU_PACKET_MASK];
+        /* is this the reply to the DER? */
+        matched = dlmstp_compare_data_expecting_reply(
+            &mstp_port->InputBuffer[0], mstp_port->DataLength,
+            mstp_port->SourceAddress, (uint8_t *)&pkt->buffer[0],
+            pkt->length, pkt->destination_mac);
+        if (matched) {
+            break;
+        }
     }
-    pkt = (struct mstp_pdu_packet *)Ringbuf_Peek(&poSharedData->PDU_Queue);
-    /* is this the reply to the DER? */
-    matched = dlmstp_compare_data_expecting_reply(
-        &mstp_port->InputBuffer[0], mstp_port->DataLength,
-        mstp_port->SourceAddress, (uint8_t *)&pkt->buffer[0], pkt->length,
-        pkt->destination_mac);
     if (!matched) {
-        /* Walk the rest of the ring buffer to see if we can find a match */
-        while (!matched &&
-               (pkt = (struct mstp_pdu_packet *)Ringbuf_Peek_Next(
-                    &poSharedData->PDU_Queue, (uint8_t *)pkt)) != NULL) {
-            matched = dlmstp_compare_data_expecting_reply(
-                &mstp_port->InputBuffer[0], mstp_port->DataLength,
-                mstp_port->SourceAddress, (uint8_t *)&pkt->buffer[0],
-                pkt->length, pkt->destination_mac);
-        }
-        if (!matched) {
-            /* Still didn't find a match so just bail out */
-            return 0;
-        }
+        return 0;
     }
     if (pkt->data_expecting_reply) {
         frame_type = FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY;
@@ -567,12 +692,67 @@ uint16_t MSTP_Get_Reply(struct mstp_port_struct_t *mstp_port, unsigned timeout)
         &mstp_port->OutputBuffer[0], /* <-- loading this */
         mstp_port->OutputBufferSize, frame_type, pkt->destination_mac,
         mstp_port->This_Station, (uint8_t *)&pkt->buffer[0], pkt->length);
-    /* This will pop the element no matter where we found it */
-    (void)Ringbuf_Pop_Element(&poSharedData->PDU_Queue, (uint8_t *)pkt, NULL);
+    /* the packets between head and tail belong to this thread, so
+       remove the reply by moving the packets ahead of it up by one */
+    for (; index != head; index--) {
+        memcpy(
+            &poSharedData->PDU_Buffer[index & MSTP_PDU_PACKET_MASK],
+            &poSharedData->PDU_Buffer[(index - 1) & MSTP_PDU_PACKET_MASK],
+            sizeof(struct mstp_pdu_packet));
+    }
+    __atomic_store_n(&poSharedData->PDU_Head, head + 1, __ATOMIC_RELEASE);
 
     return pdu_len;
 }
 
+/**
+ * @brief Get the counters that the port thread keeps
+ * @param poPort - port specific data
+ * @param statistics - filled with the counters of the port
+ * @return true if the counters were filled
+ */
+bool dlmstp_port_fill_statistics(
+    void *poPort, struct dlmstp_port_statistics *statistics)
+{
+    SHARED_MSTP_DATA *poSharedData;
+    struct mstp_port_struct_t *mstp_port = (struct mstp_port_struct_t *)poPort;
+    if (!mstp_port || !statistics) {
+        return false;
+    }
+    poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
+    if (!poSharedData) {
+        return false;
+    }
+    statistics->receive_dropped =
+        __atomic_load_n(&poSharedData->Receive_Dropped, __ATOMIC_RELAXED);
+    statistics->reply_latency =
+        __atomic_load_n(&poSharedData->Reply_Latency, __ATOMIC_RELAXED);
+    statistics->reply_latency_max =
+        __atomic_load_n(&poSharedData->Reply_Latency_Max, __ATOMIC_RELAXED);
+
+    return true;
+}
+
+/**
+ * @brief Clear the counters that the port thread keeps
+ * @param poPort - port specific data
+ */
+void dlmstp_port_reset_statistics(void *poPort)
+{
+    SHARED_MSTP_DATA *poSharedData;
+    struct mstp_port_struct_t *mstp_port = (struct mstp_port_struct_t *)poPort;
+    if (!mstp_port) {
+        return;
+    }
+    poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
+    if (!poSharedData) {
+        return;
+    }
+    __atomic_store_n(&poSharedData->Receive_Dropped, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&poSharedData->Reply_Latency, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&poSharedData->Reply_Latency_Max, 0, __ATOMIC_RELAXED);
+}
+
 void dlmstp_set_mac_address(void *poPort, uint8_t mac_address)
 {
     struct mstp_port_struct_t *mstp_port = (struct mstp_port_struct_t *)poPort;
@@ -765,7 +945,8 @@ void dlmstp_get_broadcast_address(BACNET_ADDRESS *dest)
 
 bool dlmstp_init(void *poPort, char *ifname)
 {
-    unsigned long hThread = 0;
+    pthread_attr_t attr;
+    struct sched_param param;
     int rv = 0;
     SHARED_MSTP_DATA *poSharedData;
     struct termios newtio;
@@ -782,12 +963,12 @@ bool dlmstp_init(void *poPort, char *ifname)
 
     poSharedData->RS485_Port_Name = ifname;
     /* initialize PDU queue */
-    Ringbuf_Init(
-        &poSharedData->PDU_Queue, (uint8_t *)&poSharedData->PDU_Buffer,
-        sizeof(struct mstp_pdu_packet), MSTP_PDU_PACKET_COUNT);
+    poSharedData->PDU_Head = 0;
+    poSharedData->PDU_Tail = 0;
     /* initialize packet queue */
-    poSharedData->Receive_Packet.ready = false;
-    poSharedData->Receive_Packet.pdu_len = 0;
+    poSharedData->Receive_Head = 0;
+    poSharedData->Receive_Tail = 0;
+    poSharedData->Receive_Dropped = 0;
     rv = sem_init(&poSharedData->Receive_Packet_Flag, 0, 0);
     if (rv != 0) {
         fprintf(
@@ -796,6 +977,9 @@ bool dlmstp_init(void *poPort, char *ifname)
             ifname);
         exit(1);
     }
+    poSharedData->Frame_Answered = true;
+    poSharedData->Reply_Latency = 0;
+    poSharedData->Reply_Latency_Max = 0;
 
     printf("RS485: Initializing %s", poSharedData->RS485_Port_Name);
     /*
@@ -809,13 +993,8 @@ bool dlmstp_init(void *poPort, char *ifname)
         perror(poSharedData->RS485_Port_Name);
         exit(-1);
     }
-#if 0
-    /* non blocking for the read */
-    fcntl(poSharedData->RS485_Handle, F_SETFL, FNDELAY);
-#else
-    /* efficient blocking for the read */
+    /* the port thread waits in poll(), and reads what has arrived */
     fcntl(poSharedData->RS485_Handle, F_SETFL, 0);
-#endif
     /* save current serial port settings */
     tcgetattr(poSharedData->RS485_Handle, &poSharedData->RS485_oldtio);
     /* clear struct for new port settings */
@@ -840,16 +1019,12 @@ bool dlmstp_init(void *poPort, char *ifname)
     /* flush any data waiting */
     usleep(200000);
     tcflush(poSharedData->RS485_Handle, TCIOFLUSH);
-    /* ringbuffer */
-    FIFO_Init(
-        &poSharedData->Rx_FIFO, poSharedData->Rx_Buffer,
-        sizeof(poSharedData->Rx_Buffer));
     printf("=success!\n");
     mstp_port->InputBuffer = &poSharedData->RxBuffer[0];
     mstp_port->InputBufferSize = sizeof(poSharedData->RxBuffer);
     mstp_port->OutputBuffer = &poSharedData->TxBuffer[0];
     mstp_port->OutputBufferSize = sizeof(poSharedData->TxBuffer);
-    gettimeofday(&poSharedData->start, NULL);
+    poSharedData->Silence_Start = dlmstp_microseconds();
     mstp_port->SilenceTimer = Timer_Silence;
     mstp_port->SilenceTimerReset = Timer_Silence_Reset;
     MSTP_Init(mstp_port);
@@ -857,15 +1032,33 @@ bool dlmstp_init(void *poPort, char *ifname)
     debug_fprintf(stderr, "MS/TP Max_Master: %02X\n", mstp_port->Nmax_master);
     debug_fprintf(
         stderr, "MS/TP Max_Info_Frames: %u\n", mstp_port->Nmax_info_frames);
-    rv = pthread_create(&hThread, NULL, dlmstp_master_fsm_task, mstp_port);
+    /* one thread for each port, with real-time scheduling if permitted */
+    __atomic_store_n(&poSharedData->Thread_Run, true, __ATOMIC_RELEASE);
+    rv = EPERM;
+    if (poSharedData->Thread_Priority > 0) {
+        pthread_attr_init(&attr);
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        param.sched_priority = poSharedData->Thread_Priority;
+        pthread_attr_setschedparam(&attr, &param);
+        rv = pthread_create(
+            &poSharedData->Thread, &attr, dlmstp_port_task, mstp_port);
+        pthread_attr_destroy(&attr);
+        if (rv != 0) {
+            debug_fprintf(
+                stderr, "MS/TP %s: no real-time scheduling: %s\n", ifname,
+                strerror(rv));
+        }
+    }
     if (rv != 0) {
+        rv = pthread_create(
+            &poSharedData->Thread, NULL, dlmstp_port_task, mstp_port);
+    }
+    if (rv != 0) {
+        __atomic_store_n(&poSharedData->Thread_Run, false, __ATOMIC_RELEASE);
         fprintf(stderr, "Failed to start Master Node FSM task\n");
+        return false;
     }
 
-    /* You can try also this for thread. This here so we ignore
-     * -Wunused-function compiler warning
-     */
-    dlmstp_receive_fsm_task(NULL);
-
     return true;
 }
@@ -11,6 +11,7 @@
 #include "bacnet/datalink/mstp.h"
 /*#include "bacnet/datalink/dlmstp.h" */
 #include <sys/types.h>
+#include <pthread.h>
 #include <semaphore.h>
 
 #include <stdbool.h>
@@ -22,22 +23,46 @@
 /* BACnet Stack API */
 #include "bacnet/npdu.h"
 #include "bacnet/basic/sys/fifo.h"
-#include "bacnet/basic/sys/ringbuf.h"
 /* defines specific to MS/TP */
 /* preamble+type+dest+src+len+crc8+crc16 */
 #define DLMSTP_HEADER_MAX (2 + 1 + 1 + 1 + 2 + 1 + 2)
 #define DLMSTP_MPDU_MAX (DLMSTP_HEADER_MAX + MAX_PDU)
 
-/* count must be a power of 2 for ringbuf library */
+/* count must be a power of 2 for the queue index masks */
 #ifndef MSTP_PDU_PACKET_COUNT
 #define MSTP_PDU_PACKET_COUNT 8
 #endif
+/* count must be a power of 2 for the queue index masks */
+#ifndef MSTP_RECEIVE_PACKET_COUNT
+#define MSTP_RECEIVE_PACKET_COUNT 8
+#endif
+/* SCHED_FIFO priority of the thread of each port, or 0 for the
+   default scheduling */
+#ifndef DLMSTP_THREAD_PRIORITY
+#define DLMSTP_THREAD_PRIORITY 50
+#endif
+/* number of octets read from the UART at a time */
+#ifndef DLMSTP_READ_MAX
+#define DLMSTP_READ_MAX 512
+#endif
+
+/* counters of a port, which the port thread updates */
+struct dlmstp_port_statistics {
+    /* number of packets dropped because the receive queue was full */
+    uint32_t receive_dropped;
+    /* microseconds from the end of a frame to this station until
+       the start of the answer, last and most */
+    uint32_t reply_latency;
+    uint32_t reply_latency_max;
+};
 
 typedef struct dlmstp_packet {
     bool ready; /* true if ready to be sent or received */
     BACNET_ADDRESS address; /* source address */
     uint8_t frame_type; /* type of message */
     uint16_t pdu_len; /* packet length */
+    /* CLOCK_MONOTONIC microseconds at the end of the frame */
+    uint64_t timestamp;
     uint8_t pdu[DLMSTP_MPDU_MAX]; /* packet */
 } DLMSTP_PACKET;
 
@@ -49,31 +74,46 @@ struct mstp_pdu_packet {
     uint8_t buffer[DLMSTP_MPDU_MAX];
 };
 
+/*
+ * Each port runs its state machines in a thread of its own, which waits
+ * in poll() for the UART or for the next MS/TP timeout, and reads all of
+ * the octets that arrived at once. The packets to send and the packets
+ * received are passed between the application thread and the port thread
+ * in lock-free single-producer, single-consumer queues, so only one
+ * application thread may send and receive on a port.
+ */
 typedef struct shared_mstp_data {
     /* Number of MS/TP Packets Rx/Tx */
     uint16_t MSTP_Packets;
 
-    /* packet queues */
-    DLMSTP_PACKET Receive_Packet;
-    DLMSTP_PACKET Transmit_Packet;
-    /*
-       RT_SEM Receive_Packet_Flag;
-     */
+    /* received packets, from the port thread to the application */
+    DLMSTP_PACKET Receive_Queue[MSTP_RECEIVE_PACKET_COUNT];
+    /* index of the next packet to receive, written by the application */
+    unsigned Receive_Head;
+    /* index of the next packet received, written by the port thread */
+    unsigned Receive_Tail;
+    /* number of packets waiting in the receive queue */
     sem_t Receive_Packet_Flag;
-    /* mechanism to wait for a frame in state machine */
-    /*
-       RT_COND Received_Frame_Flag;
-       RT_MUTEX Received_Frame_Mutex;
-     */
-    pthread_cond_t Received_Frame_Flag;
-    pthread_mutex_t Received_Frame_Mutex;
-    pthread_cond_t Master_Done_Flag;
-    pthread_mutex_t Master_Done_Mutex;
+    /* number of packets dropped because the receive queue was full */
+    uint32_t Receive_Dropped;
+    /* port thread, and true while it is to keep running */
+    pthread_t Thread;
+    bool Thread_Run;
+    /* SCHED_FIFO priority of the port thread, or 0 for the default */
+    int Thread_Priority;
     /* buffers needed by mstp port struct */
     uint8_t TxBuffer[DLMSTP_MPDU_MAX];
     uint8_t RxBuffer[DLMSTP_MPDU_MAX];
-    /* Timer that indicates line silence - and functions */
-    uint16_t SilenceTime;
+    /* CLOCK_MONOTONIC microseconds of the last line activity */
+    uint64_t Silence_Start;
+    /* CLOCK_MONOTONIC microseconds at the end of the last frame */
+    uint64_t Frame_Timestamp;
+    /* true once the last frame to this station was answered */
+    bool Frame_Answered;
+    /* microseconds from the end of a frame to this station until
+       the start of the answer, last and most */
+    uint32_t Reply_Latency;
+    uint32_t Reply_Latency_Max;
 
     /* handle returned from open() */
     int RS485_Handle;
@@ -91,12 +131,13 @@ typedef struct shared_mstp_data {
     FIFO_BUFFER Rx_FIFO;
     /* buffer size needs to be a power of 2 */
     uint8_t Rx_Buffer[4096];
-    struct timeval start;
-
-    RING_BUFFER PDU_Queue;
 
+    /* packets to send, from the application to the port thread */
     struct mstp_pdu_packet PDU_Buffer[MSTP_PDU_PACKET_COUNT];
-
+    /* index of the next packet to send, written by the port thread */
+    unsigned PDU_Head;
+    /* index of the next packet queued, written by the application */
+    unsigned PDU_Tail;
 } SHARED_MSTP_DATA;
 
 #ifdef __cplusplus
@@ -127,6 +168,15 @@ uint16_t dlmstp_receive(
     uint16_t max_pdu, /* amount of space available in the PDU  */
     unsigned timeout); /* milliseconds to wait for a packet */
 
+BACNET_STACK_EXPORT
+uint16_t dlmstp_receive_timestamp(
+    void *poShared,
+    BACNET_ADDRESS *src,
+    uint8_t *pdu,
+    uint16_t max_pdu,
+    unsigned timeout,
+    uint64_t *timestamp);
+
 /* This parameter represents the value of the Max_Info_Frames property of */
 /* the node's Device object. The value of Max_Info_Frames specifies the */
 /* maximum number of information frames the node may send before it must */
@@ -173,6 +223,12 @@ void dlmstp_fill_bacnet_address(BACNET_ADDRESS *src, uint8_t mstp_address);
 BACNET_STACK_EXPORT
 bool dlmstp_sole_master(void);
 
+BACNET_STACK_EXPORT
+bool dlmstp_port_fill_statistics(
+    void *poShared, struct dlmstp_port_statistics *statistics);
+BACNET_STACK_EXPORT
+void dlmstp_port_reset_statistics(void *poShared);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
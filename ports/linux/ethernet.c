@@ -13,6 +13,14 @@
 #include "bacnet/datalink/ethernet.h"
 #include "bacnet/bacint.h"
 
+/* receive from a memory-mapped TPACKET_V3 ring instead of read() */
+#ifndef ETHERNET_RECEIVE_MMAP
+#define ETHERNET_RECEIVE_MMAP 1
+#endif
+#if ETHERNET_RECEIVE_MMAP
+#include "packet-mmap.h"
+#endif
+
 /** @file linux/ethernet.c  Provides Linux-specific functions for
  * BACnet/Ethernet. */
 
@@ -28,6 +36,12 @@ uint8_t Ethernet_MAC_Address[MAX_MAC_LEN] = { 0 };
 
 static int eth802_sockfd = -1; /* 802.2 file handle */
 static struct sockaddr eth_addr = { 0 }; /* used for binding 802.2 */
+#if ETHERNET_RECEIVE_MMAP
+/* 802.2 packet socket and receive ring, used instead when it opens */
+static struct packet_mmap Ethernet_Ring = { -1, NULL, 0, 0, false, NULL, 0 };
+/* DSAP and SSAP of BACnet, after the addresses and length */
+static const uint8_t Ethernet_LSAP[2] = { 0x82, 0x82 };
+#endif
 
 bool ethernet_valid(void)
 {
@@ -36,9 +50,17 @@ bool ethernet_valid(void)
 
 void ethernet_cleanup(void)
 {
+#if ETHERNET_RECEIVE_MMAP
+    if (packet_mmap_valid(&Ethernet_Ring)) {
+        packet_mmap_close(&Ethernet_Ring);
+    } else if (ethernet_valid()) {
+        close(eth802_sockfd);
+    }
+#else
     if (ethernet_valid()) {
         close(eth802_sockfd);
     }
+#endif
     eth802_sockfd = -1;
 
     return;
@@ -171,25 +193,54 @@ static int get_local_hwaddr(const char *ifname, unsigned char *mac)
 
 bool ethernet_init(char *interface_name)
 {
+    const char *name = "eth0";
+
     if (interface_name) {
-        get_local_hwaddr(interface_name, Ethernet_MAC_Address);
-        eth802_sockfd = ethernet_bind(&eth_addr, interface_name);
-    } else {
-        get_local_hwaddr("eth0", Ethernet_MAC_Address);
-        eth802_sockfd = ethernet_bind(&eth_addr, "eth0");
+        name = interface_name;
     }
+    get_local_hwaddr(name, Ethernet_MAC_Address);
+#if ETHERNET_RECEIVE_MMAP
+    if (packet_mmap_open(
+            &Ethernet_Ring, name, ETH_P_802_2, 14, Ethernet_LSAP,
+            sizeof(Ethernet_LSAP))) {
+        fprintf(
+            stderr, "ethernet: receiving \"%s\" with a TPACKET_V3 ring\n",
+            name);
+        eth802_sockfd = Ethernet_Ring.fd;
+        atexit(ethernet_cleanup);
+        return ethernet_valid();
+    }
+#endif
+    eth802_sockfd = ethernet_bind(&eth_addr, name);
 
     return ethernet_valid();
 }
 
+/**
+ * @brief Send a whole 802.2 frame on the socket that is open
+ * @param mtu - frame, starting with the destination address
+ * @param mtu_len - number of octets in the frame
+ * @return number of octets sent, or -1 on error
+ */
+static int ethernet_send_frame(const uint8_t *mtu, int mtu_len)
+{
+#if ETHERNET_RECEIVE_MMAP
+    if (packet_mmap_valid(&Ethernet_Ring)) {
+        return packet_mmap_send(&Ethernet_Ring, mtu, (uint16_t)mtu_len);
+    }
+#endif
+
+    return sendto(
+        eth802_sockfd, mtu, mtu_len, 0, (struct sockaddr *)&eth_addr,
+        sizeof(struct sockaddr));
+}
+
 int ethernet_send(uint8_t *mtu, int mtu_len)
 {
     int bytes = 0;
 
     /* Send the packet */
-    bytes = sendto(
-        eth802_sockfd, &mtu, mtu_len, 0, (struct sockaddr *)&eth_addr,
-        sizeof(struct sockaddr));
+    bytes = ethernet_send_frame(mtu, mtu_len);
     /* did it get sent? */
     if (bytes < 0) {
         fprintf(
@@ -259,9 +310,7 @@ int ethernet_send_pdu(
     encode_unsigned16(&mtu[12], 3 + pdu_len);
 
     /* Send the packet */
-    bytes = sendto(
-        eth802_sockfd, &mtu, mtu_len, 0, (struct sockaddr *)&eth_addr,
-        sizeof(struct sockaddr));
+    bytes = ethernet_send_frame(mtu, mtu_len);
     /* did it get sent? */
     if (bytes < 0) {
         fprintf(
@@ -271,6 +320,49 @@ int ethernet_send_pdu(
     return bytes;
 }
 
+/**
+ * @brief Find the NPDU in a received 802.2 frame
+ * @param src - returns the source address
+ * @param frame - received frame, starting with the destination address
+ * @param frame_len - number of octets received
+ * @param npdu - returns the start of the NPDU in the frame
+ * @return number of octets in the NPDU, or zero if it is not for us
+ */
+static uint16_t ethernet_frame_npdu(
+    BACNET_ADDRESS *src, uint8_t *frame, int frame_len, uint8_t **npdu)
+{
+    uint16_t pdu_len = 0;
+
+    if (frame_len < ETHERNET_HEADER_MAX) {
+        return 0;
+    }
+    /* the signature of an 802.2 BACnet packet */
+    if ((frame[14] != 0x82) || (frame[15] != 0x82)) {
+        /*fprintf(stderr,"ethernet: Non-BACnet packet\n"); */
+        return 0;
+    }
+    /* copy the source address */
+    src->mac_len = 6;
+    memmove(src->mac, &frame[6], 6);
+
+    /* check destination address for when */
+    /* the Ethernet card is in promiscious mode */
+    if ((memcmp(&frame[0], Ethernet_MAC_Address, 6) != 0) &&
+        (memcmp(&frame[0], Ethernet_Broadcast, 6) != 0)) {
+        /*fprintf(stderr, "ethernet: This packet isn't for us\n"); */
+        return 0;
+    }
+
+    (void)decode_unsigned16(&frame[12], &pdu_len);
+    if ((pdu_len < 3) || ((pdu_len + 14) > frame_len)) {
+        return 0;
+    }
+    pdu_len -= 3 /* DSAP, SSAP, LLC Control */;
+    *npdu = &frame[17];
+
+    return pdu_len;
+}
+
 /* receives an 802.2 framed packet */
 /* returns the number of octets in the PDU, or zero on failure */
 uint16_t ethernet_receive(
@@ -281,10 +373,35 @@ uint16_t ethernet_receive(
 { /* number of milliseconds to wait for a packet */
     int received_bytes;
     uint8_t buf[ETHERNET_MPDU_MAX] = { 0 }; /* data */
+    uint8_t *npdu = NULL;
     uint16_t pdu_len = 0; /* return value */
     fd_set read_fds;
     int max;
     struct timeval select_timeout;
+#if ETHERNET_RECEIVE_MMAP
+    uint8_t *frame;
+    uint16_t frame_len = 0;
+
+    if (packet_mmap_valid(&Ethernet_Ring)) {
+        /* the kernel has already dropped frames without the BACnet LSAP */
+        do {
+            frame = packet_mmap_receive(&Ethernet_Ring, timeout, &frame_len);
+            if (!frame) {
+                break;
+            }
+            pdu_len = ethernet_frame_npdu(src, frame, frame_len, &npdu);
+            /* skip frames that are not for us, without waiting */
+            timeout = 0;
+        } while ((pdu_len == 0) && (packet_mmap_pending(&Ethernet_Ring) > 0));
+        if (pdu_len >= max_pdu) {
+            /* ignore packets that are too large */
+            pdu_len = 0;
+        } else if (pdu_len > 0) {
+            memcpy(&pdu[0], npdu, pdu_len);
+        }
+        return pdu_len;
+    }
+#endif
 
     /* Make sure the socket is open */
     if (eth802_sockfd <= 0) {
@@ -329,28 +446,10 @@ uint16_t ethernet_receive(
         return 0;
     }
 
-    /* the signature of an 802.2 BACnet packet */
-    if ((buf[14] != 0x82) && (buf[15] != 0x82)) {
-        /*fprintf(stderr,"ethernet: Non-BACnet packet\n"); */
-        return 0;
-    }
-    /* copy the source address */
-    src->mac_len = 6;
-    memmove(src->mac, &buf[6], 6);
-
-    /* check destination address for when */
-    /* the Ethernet card is in promiscious mode */
-    if ((memcmp(&buf[0], Ethernet_MAC_Address, 6) != 0) &&
-        (memcmp(&buf[0], Ethernet_Broadcast, 6) != 0)) {
-        /*fprintf(stderr, "ethernet: This packet isn't for us\n"); */
-        return 0;
-    }
-
-    (void)decode_unsigned16(&buf[12], &pdu_len);
-    pdu_len -= 3 /* DSAP, SSAP, LLC Control */;
+    pdu_len = ethernet_frame_npdu(src, buf, received_bytes, &npdu);
     /* copy the buffer into the PDU */
     if (pdu_len < max_pdu) {
-        memmove(&pdu[0], &buf[17], pdu_len);
+        memmove(&pdu[0], npdu, pdu_len);
     }
     /* ignore packets that are too large */
     else {
@@ -360,6 +459,58 @@ uint16_t ethernet_receive(
     return pdu_len;
 }
 
+/**
+ * @brief Receive 802.2 frames and give each NPDU to a handler, such as
+ *  npdu_handler(). With the receive ring, the NPDU is not copied, and
+ *  every frame of the block that is ready is handled in one call.
+ * @param handler - function that is given the source address and NPDU
+ * @param timeout - number of milliseconds to wait for a frame
+ * @return number of NPDUs given to the handler
+ */
+unsigned ethernet_receive_handler(
+    void (*handler)(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len),
+    unsigned timeout)
+{
+    BACNET_ADDRESS src = { 0 };
+    uint8_t pdu[MAX_PDU];
+    uint16_t pdu_len = 0;
+    unsigned count = 0;
+#if ETHERNET_RECEIVE_MMAP
+    uint8_t *frame;
+    uint8_t *npdu = NULL;
+    uint16_t frame_len = 0;
+#endif
+
+    if (!handler) {
+        return 0;
+    }
+#if ETHERNET_RECEIVE_MMAP
+    if (packet_mmap_valid(&Ethernet_Ring)) {
+        do {
+            frame = packet_mmap_receive(&Ethernet_Ring, timeout, &frame_len);
+            if (!frame) {
+                break;
+            }
+            pdu_len = ethernet_frame_npdu(&src, frame, frame_len, &npdu);
+            if ((pdu_len > 0) && (pdu_len <= MAX_PDU)) {
+                handler(&src, npdu, pdu_len);
+                count++;
+            }
+            /* only wait for the first frame */
+            timeout = 0;
+        } while (packet_mmap_pending(&Ethernet_Ring) > 0);
+        return count;
+    }
+#endif
+    pdu_len = ethernet_receive(&src, pdu, sizeof(pdu), timeout);
+    if (pdu_len > 0) {
+        handler(&src, pdu, pdu_len);
+        count++;
+    }
+
+    return count;
+}
+
 void ethernet_set_my_address(const BACNET_ADDRESS *my_address)
 {
     int i = 0;
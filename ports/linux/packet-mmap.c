@@ -0,0 +1,330 @@
+/**
+ * @file
+ * @brief Receive link layer frames from a memory-mapped TPACKET_V3 ring
+ * @date 2024
+ *
+ * @section DESCRIPTION
+ *
+ * The kernel copies each received frame into a block of a ring that is
+ * shared with the application, and hands over a whole block of frames
+ * at a time when it is full or when PACKET_MMAP_BLOCK_TIMEOUT expires.
+ * A classic BPF filter attached to the socket keeps frames that do not
+ * have the BACnet signature out of the ring, so the application only
+ * wakes up for BACnet frames, and reads them where the kernel put them.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include "packet-mmap.h"
+
+/**
+ * @brief Build a classic BPF filter that accepts frames with a signature
+ * @param filter - returns the filter, PACKET_MMAP_FILTER_MAX instructions
+ * @param offset - offset of the signature from the start of the frame
+ * @param signature - octets that a frame must have at the offset
+ * @param signature_len - number of octets in the signature
+ * @return number of instructions in the filter, or 0 on error
+ */
+unsigned packet_mmap_filter(
+    struct sock_filter *filter,
+    unsigned offset,
+    const uint8_t *signature,
+    unsigned signature_len)
+{
+    unsigned i = 0;
+    unsigned len = 0;
+
+    if (!filter || !signature || (signature_len == 0) ||
+        (signature_len > PACKET_MMAP_SIGNATURE_MAX)) {
+        return 0;
+    }
+    for (i = 0; i < signature_len; i++) {
+        filter[len].code = BPF_LD | BPF_B | BPF_ABS;
+        filter[len].jt = 0;
+        filter[len].jf = 0;
+        filter[len].k = offset + i;
+        len++;
+        /* on a mismatch, jump over the rest of the signature to drop */
+        filter[len].code = BPF_JMP | BPF_JEQ | BPF_K;
+        filter[len].jt = 0;
+        filter[len].jf = (uint8_t)(((signature_len - i - 1) * 2) + 1);
+        filter[len].k = signature[i];
+        len++;
+    }
+    /* accept the whole frame */
+    filter[len].code = BPF_RET | BPF_K;
+    filter[len].jt = 0;
+    filter[len].jf = 0;
+    filter[len].k = 0xFFFFFFFFUL;
+    len++;
+    /* drop */
+    filter[len].code = BPF_RET | BPF_K;
+    filter[len].jt = 0;
+    filter[len].jf = 0;
+    filter[len].k = 0;
+    len++;
+
+    return len;
+}
+
+/**
+ * @brief Get a block descriptor of the ring
+ * @param ring - packet socket and ring
+ * @param block - index of the block
+ * @return block descriptor
+ */
+static struct tpacket_block_desc *
+packet_mmap_block(const struct packet_mmap *ring, unsigned block)
+{
+    return (struct tpacket_block_desc *)(ring->map +
+                                         ((size_t)block *
+                                          PACKET_MMAP_BLOCK_SIZE));
+}
+
+/**
+ * @brief Open a packet socket with a receive ring on an interface
+ * @param ring - packet socket and ring to open
+ * @param ifname - name of the network interface
+ * @param protocol - link layer protocol, such as ETH_P_802_2
+ * @param offset - offset of the signature from the start of the frame
+ * @param signature - octets that a frame must have to be received
+ * @param signature_len - number of octets in the signature
+ * @return true if the socket and ring are ready
+ */
+bool packet_mmap_open(
+    struct packet_mmap *ring,
+    const char *ifname,
+    uint16_t protocol,
+    unsigned offset,
+    const uint8_t *signature,
+    unsigned signature_len)
+{
+    struct sock_filter filter[PACKET_MMAP_FILTER_MAX];
+    struct sock_fprog program = { 0 };
+    struct tpacket_req3 req = { 0 };
+    struct sockaddr_ll sll = { 0 };
+    int version = TPACKET_V3;
+    int fd = -1;
+    int option = 1;
+    void *map;
+
+    if (!ring) {
+        return false;
+    }
+    ring->fd = -1;
+    ring->map = NULL;
+    ring->map_size = 0;
+    ring->block = 0;
+    ring->block_held = false;
+    ring->frame = NULL;
+    ring->frames_left = 0;
+    program.len = (unsigned short)packet_mmap_filter(
+        filter, offset, signature, signature_len);
+    program.filter = filter;
+    if (!ifname || (program.len == 0)) {
+        return false;
+    }
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = htons(protocol);
+    sll.sll_ifindex = (int)if_nametoindex(ifname);
+    if (sll.sll_ifindex == 0) {
+        fprintf(stderr, "packet: unknown interface \"%s\"\n", ifname);
+        return false;
+    }
+    /* no protocol until bind, so that no frame skips the filter */
+    fd = socket(AF_PACKET, SOCK_RAW, 0);
+    if (fd < 0) {
+        fprintf(stderr, "packet: socket: %s\n", strerror(errno));
+        return false;
+    }
+    if (setsockopt(
+            fd, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) <
+        0) {
+        fprintf(stderr, "packet: filter: %s\n", strerror(errno));
+        close(fd);
+        return false;
+    }
+#ifdef PACKET_IGNORE_OUTGOING
+    /* frames sent by other sockets on this host are not for us */
+    (void)setsockopt(
+        fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &option, sizeof(option));
+#else
+    (void)option;
+#endif
+    if (setsockopt(
+            fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+        fprintf(stderr, "packet: TPACKET_V3: %s\n", strerror(errno));
+        close(fd);
+        return false;
+    }
+    req.tp_block_size = PACKET_MMAP_BLOCK_SIZE;
+    req.tp_block_nr = PACKET_MMAP_BLOCK_COUNT;
+    req.tp_frame_size = PACKET_MMAP_FRAME_SIZE;
+    req.tp_frame_nr = (PACKET_MMAP_BLOCK_SIZE / PACKET_MMAP_FRAME_SIZE) *
+        PACKET_MMAP_BLOCK_COUNT;
+    req.tp_retire_blk_tov = PACKET_MMAP_BLOCK_TIMEOUT;
+    if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0) {
+        fprintf(stderr, "packet: receive ring: %s\n", strerror(errno));
+        close(fd);
+        return false;
+    }
+    ring->map_size = (size_t)PACKET_MMAP_BLOCK_SIZE * PACKET_MMAP_BLOCK_COUNT;
+    map = mmap(
+        NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "packet: mmap: %s\n", strerror(errno));
+        ring->map_size = 0;
+        close(fd);
+        return false;
+    }
+    if (bind(fd, (struct sockaddr *)&sll, sizeof(sll)) != 0) {
+        fprintf(stderr, "packet: bind \"%s\": %s\n", ifname, strerror(errno));
+        munmap(map, ring->map_size);
+        ring->map_size = 0;
+        close(fd);
+        return false;
+    }
+    ring->map = map;
+    ring->fd = fd;
+
+    return true;
+}
+
+/**
+ * @brief Close the packet socket and unmap its ring
+ * @param ring - packet socket and ring
+ */
+void packet_mmap_close(struct packet_mmap *ring)
+{
+    if (!ring) {
+        return;
+    }
+    if (ring->map) {
+        munmap(ring->map, ring->map_size);
+    }
+    if (ring->fd >= 0) {
+        close(ring->fd);
+    }
+    ring->fd = -1;
+    ring->map = NULL;
+    ring->map_size = 0;
+    ring->block_held = false;
+    ring->frame = NULL;
+    ring->frames_left = 0;
+}
+
+/**
+ * @brief Determine if the packet socket and ring are open
+ * @param ring - packet socket and ring
+ * @return true if open
+ */
+bool packet_mmap_valid(const struct packet_mmap *ring)
+{
+    return ring && (ring->fd >= 0) && ring->map;
+}
+
+/**
+ * @brief Get the next frame from the ring. A block is given back to the
+ *  kernel when all of its frames have been read, so the frame is only
+ *  valid until the next call.
+ * @param ring - packet socket and ring
+ * @param timeout - milliseconds to wait when no block is ready
+ * @param frame_len - returns the number of octets in the frame
+ * @return the frame, starting with the link layer header, or NULL if none
+ */
+uint8_t *packet_mmap_receive(
+    struct packet_mmap *ring, unsigned timeout, uint16_t *frame_len)
+{
+    struct tpacket_block_desc *block;
+    struct tpacket3_hdr *frame;
+    struct pollfd pfd;
+
+    if (!packet_mmap_valid(ring)) {
+        return NULL;
+    }
+    if (ring->frames_left == 0) {
+        if (ring->block_held) {
+            /* frames are read before the block is given back */
+            __sync_synchronize();
+            block = packet_mmap_block(ring, ring->block);
+            block->hdr.bh1.block_status = TP_STATUS_KERNEL;
+            ring->block_held = false;
+            ring->block = (ring->block + 1) % PACKET_MMAP_BLOCK_COUNT;
+        }
+        block = packet_mmap_block(ring, ring->block);
+        if ((block->hdr.bh1.block_status & TP_STATUS_USER) == 0) {
+            pfd.fd = ring->fd;
+            pfd.events = POLLIN | POLLERR;
+            pfd.revents = 0;
+            if (poll(&pfd, 1, (int)timeout) <= 0) {
+                return NULL;
+            }
+            if ((block->hdr.bh1.block_status & TP_STATUS_USER) == 0) {
+                return NULL;
+            }
+        }
+        /* the block status is read before its frames */
+        __sync_synchronize();
+        ring->block_held = true;
+        ring->frames_left = block->hdr.bh1.num_pkts;
+        ring->frame = (struct tpacket3_hdr *)((uint8_t *)block +
+                                              block->hdr.bh1
+                                                  .offset_to_first_pkt);
+        if (ring->frames_left == 0) {
+            return NULL;
+        }
+    }
+    frame = ring->frame;
+    ring->frames_left--;
+    if (ring->frames_left) {
+        ring->frame =
+            (struct tpacket3_hdr *)((uint8_t *)frame + frame->tp_next_offset);
+    }
+    if (frame_len) {
+        *frame_len = (uint16_t)frame->tp_snaplen;
+    }
+
+    return (uint8_t *)frame + frame->tp_mac;
+}
+
+/**
+ * @brief Get the number of frames left in the block being read, which
+ *  packet_mmap_receive() returns without a system call
+ * @param ring - packet socket and ring
+ * @return number of frames
+ */
+uint32_t packet_mmap_pending(const struct packet_mmap *ring)
+{
+    if (!packet_mmap_valid(ring)) {
+        return 0;
+    }
+
+    return ring->frames_left;
+}
+
+/**
+ * @brief Send a frame on the interface of the packet socket
+ * @param ring - packet socket and ring
+ * @param frame - frame, starting with the link layer header
+ * @param frame_len - number of octets in the frame
+ * @return number of octets sent, or -1 on error
+ */
+int packet_mmap_send(
+    const struct packet_mmap *ring, const uint8_t *frame, uint16_t frame_len)
+{
+    if (!packet_mmap_valid(ring)) {
+        return -1;
+    }
+
+    return (int)send(ring->fd, frame, frame_len, 0);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file
+ * @brief Receive link layer frames from a memory-mapped TPACKET_V3 ring
+ * @date 2024
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef PACKET_MMAP_H
+#define PACKET_MMAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/filter.h>
+#include <linux/if_packet.h>
+
+/* size of each block of the receive ring, a multiple of the page size */
+#ifndef PACKET_MMAP_BLOCK_SIZE
+#define PACKET_MMAP_BLOCK_SIZE (1U << 16)
+#endif
+/* number of blocks in the receive ring */
+#ifndef PACKET_MMAP_BLOCK_COUNT
+#define PACKET_MMAP_BLOCK_COUNT 8
+#endif
+/* largest frame expected, which the block size must be a multiple of */
+#ifndef PACKET_MMAP_FRAME_SIZE
+#define PACKET_MMAP_FRAME_SIZE 2048
+#endif
+/* milliseconds before the kernel hands over a block that is not full */
+#ifndef PACKET_MMAP_BLOCK_TIMEOUT
+#define PACKET_MMAP_BLOCK_TIMEOUT 4
+#endif
+/* most octets in the signature matched by the receive filter */
+#define PACKET_MMAP_SIGNATURE_MAX 4
+/* instructions in the largest receive filter */
+#define PACKET_MMAP_FILTER_MAX ((2 * PACKET_MMAP_SIGNATURE_MAX) + 2)
+
+/* a packet socket with a memory-mapped receive ring */
+struct packet_mmap {
+    /* packet socket, or -1 when closed */
+    int fd;
+    uint8_t *map;
+    size_t map_size;
+    /* block being read, owned by the application while held */
+    unsigned block;
+    bool block_held;
+    /* next frame in the held block, and the number of frames left */
+    struct tpacket3_hdr *frame;
+    uint32_t frames_left;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+unsigned packet_mmap_filter(
+    struct sock_filter *filter,
+    unsigned offset,
+    const uint8_t *signature,
+    unsigned signature_len);
+bool packet_mmap_open(
+    struct packet_mmap *ring,
+    const char *ifname,
+    uint16_t protocol,
+    unsigned offset,
+    const uint8_t *signature,
+    unsigned signature_len);
+void packet_mmap_close(struct packet_mmap *ring);
+bool packet_mmap_valid(const struct packet_mmap *ring);
+uint8_t *packet_mmap_receive(
+    struct packet_mmap *ring, unsigned timeout, uint16_t *frame_len);
+uint32_t packet_mmap_pending(const struct packet_mmap *ring);
+int packet_mmap_send(
+    const struct packet_mmap *ring, const uint8_t *frame, uint16_t frame_len);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -0,0 +1,151 @@
+/**
+ * @file
+ * @brief Trend Log buffers kept in memory-mapped files
+ * @date 2024
+ *
+ * @section DESCRIPTION
+ *
+ * Each Trend Log buffer is a ring of records in a file that is mapped
+ * into memory, with the state of the ring at the start of the file.
+ * Records and state are updated in place by the Trend Log object, so the
+ * log survives a restart of the application, and can hold millions of
+ * records without using RAM for the records that are not being read.
+ *
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bacnet/basic/object/trendlog.h"
+#include "bacnet/basic/sys/keylist.h"
+
+/* "BTL1" */
+#define TL_STORAGE_MAGIC 0x42544C31UL
+/* the records start after the header, aligned for any record member */
+#define TL_STORAGE_HEADER_SIZE 64
+
+/* start of the file */
+struct tl_storage_header {
+    uint32_t magic;
+    /* size of TL_DATA_REC that wrote the file */
+    uint32_t record_size;
+    TL_LOG_STATE state;
+};
+
+/* a file mapped for a Trend Log */
+struct tl_storage {
+    void *base;
+    size_t length;
+};
+
+/* list of the files that are mapped, by Trend Log instance */
+static OS_Keylist Storage_List;
+
+/**
+ * @brief Keep the log buffer of a Trend Log in a memory-mapped file.
+ *  The file is created if it does not exist. Records in a file written
+ *  with the same buffer size are kept in the log, otherwise the log
+ *  starts out empty. Call after Trend_Log_Init().
+ * @param object_instance - object-instance number of the Trend Log
+ * @param pathname - name of the file
+ * @param buffer_size - number of records the log buffer holds
+ * @return true if the log buffer is in the file
+ */
+bool Trend_Log_Storage_Open(
+    uint32_t object_instance, const char *pathname, uint32_t buffer_size)
+{
+    struct tl_storage *storage;
+    struct tl_storage_header *header;
+    struct stat file_stat;
+    size_t length;
+    void *base;
+    int fd;
+
+    if (!pathname || (buffer_size == 0) ||
+        (((uint64_t)buffer_size * sizeof(TL_DATA_REC)) >
+         (SIZE_MAX - TL_STORAGE_HEADER_SIZE))) {
+        return false;
+    }
+    if (!Storage_List) {
+        Storage_List = Keylist_Create();
+        if (!Storage_List) {
+            return false;
+        }
+    }
+    Trend_Log_Storage_Close(object_instance);
+    length =
+        TL_STORAGE_HEADER_SIZE + ((size_t)buffer_size * sizeof(TL_DATA_REC));
+    fd = open(pathname, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if ((fstat(fd, &file_stat) != 0) ||
+        (((size_t)file_stat.st_size != length) &&
+         (ftruncate(fd, (off_t)length) != 0))) {
+        close(fd);
+        return false;
+    }
+    base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    /* the mapping keeps the file open */
+    close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+    header = base;
+    if ((header->magic != TL_STORAGE_MAGIC) ||
+        (header->record_size != sizeof(TL_DATA_REC))) {
+        /* new file, or written by another build - start out empty */
+        memset(header, 0, sizeof(struct tl_storage_header));
+        header->magic = TL_STORAGE_MAGIC;
+        header->record_size = sizeof(TL_DATA_REC);
+    }
+    storage = calloc(1, sizeof(struct tl_storage));
+    if (!storage) {
+        munmap(base, length);
+        return false;
+    }
+    storage->base = base;
+    storage->length = length;
+    if (!Trend_Log_Buffer_Set(
+            object_instance,
+            (TL_DATA_REC *)((uint8_t *)base + TL_STORAGE_HEADER_SIZE),
+            buffer_size, &header->state)) {
+        munmap(base, length);
+        free(storage);
+        return false;
+    }
+    if (Keylist_Data_Add(Storage_List, object_instance, storage) < 0) {
+        Trend_Log_Buffer_Set(object_instance, NULL, 0, NULL);
+        munmap(base, length);
+        free(storage);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Write the log buffer of a Trend Log to its file, and go back to
+ *  the built in log buffer, which starts out empty.
+ * @param object_instance - object-instance number of the Trend Log
+ */
+void Trend_Log_Storage_Close(uint32_t object_instance)
+{
+    struct tl_storage *storage;
+
+    if (!Storage_List) {
+        return;
+    }
+    storage = Keylist_Data_Delete(Storage_List, object_instance);
+    if (storage) {
+        Trend_Log_Buffer_Set(object_instance, NULL, 0, NULL);
+        msync(storage->base, storage->length, MS_SYNC);
+        munmap(storage->base, storage->length);
+        free(storage);
+    }
+}
@@ -238,6 +238,35 @@ int bip_send_mpdu(
     return mtu_len;
 }
 
+/**
+ * The send function for BACnet/IP driver layer that sends the same
+ * MPDU to many destinations, such as a BBMD forwarding a broadcast.
+ *
+ * @param dest - array of #BACNET_IP_ADDRESS destination addresses
+ * @param dest_count - number of destination addresses
+ * @param mtu - the bytes of data to send
+ * @param mtu_len - the number of bytes of data to send
+ *
+ * @return the number of destinations that the MPDU was sent to
+ */
+int bip_send_mpdu_batch(
+    const BACNET_IP_ADDRESS *dest,
+    unsigned dest_count,
+    const uint8_t *mtu,
+    uint16_t mtu_len)
+{
+    unsigned i;
+    int sent_count = 0;
+
+    for (i = 0; i < dest_count; i++) {
+        if (bip_send_mpdu(&dest[i], mtu, mtu_len) > 0) {
+            sent_count++;
+        }
+    }
+
+    return sent_count;
+}
+
 /** Send the Original Broadcast or Unicast messages
  *
  * @param dest [in] Destination address (may encode an IP address and port #).
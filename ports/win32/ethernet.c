@@ -480,6 +480,33 @@ uint16_t ethernet_receive(
     return pdu_len;
 }
 
+/**
+ * @brief Receive an 802.2 frame and give its NPDU to a handler, such as
+ *  npdu_handler(). The NPDU is copied out of the capture buffer.
+ * @param handler - function that is given the source address and NPDU
+ * @param timeout - number of milliseconds to wait for a frame
+ * @return number of NPDUs given to the handler
+ */
+unsigned ethernet_receive_handler(
+    void (*handler)(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len),
+    unsigned timeout)
+{
+    BACNET_ADDRESS src = { 0 };
+    uint8_t pdu[MAX_PDU];
+    uint16_t pdu_len = 0;
+
+    if (!handler) {
+        return 0;
+    }
+    pdu_len = ethernet_receive(&src, pdu, sizeof(pdu), timeout);
+    if (pdu_len > 0) {
+        handler(&src, pdu, pdu_len);
+        return 1;
+    }
+
+    return 0;
+}
+
 void ethernet_set_my_address(const BACNET_ADDRESS *my_address)
 {
     int i = 0;
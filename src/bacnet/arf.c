@@ -132,7 +132,14 @@ int arf_encode_apdu(
 
     if (apdu) {
         apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+#if BACNET_SEGMENTATION_ENABLED
+        /* segmented-response-accepted */
+        apdu[0] |= BIT(1);
+        apdu[1] =
+            encode_max_segs_max_apdu(BACNET_MAX_SEGMENTS_ACCEPTED, MAX_APDU);
+#else
         apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+#endif
         apdu[2] = invoke_id;
         apdu[3] = SERVICE_CONFIRMED_ATOMIC_READ_FILE; /* service choice */
     }
@@ -284,7 +291,7 @@ int arf_decode_apdu(
     if (apdu_size < 4) {
         return BACNET_STATUS_ERROR;
     }
-    if (apdu[0] != PDU_TYPE_CONFIRMED_SERVICE_REQUEST) {
+    if ((apdu[0] & 0xF0) != PDU_TYPE_CONFIRMED_SERVICE_REQUEST) {
         return BACNET_STATUS_ERROR;
     }
     /*  apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU); */
@@ -5287,3 +5287,300 @@ bool bacapp_same_value(
     }
     return status;
 }
+
+/**
+ * @brief Initialize an arena that gives out memory from a buffer
+ * @param arena - arena to initialize
+ * @param buffer - memory given out by the arena
+ * @param size - number of bytes in the buffer
+ */
+void bacapp_arena_init(
+    BACNET_APPLICATION_DATA_ARENA *arena, void *buffer, size_t size)
+{
+    if (arena) {
+        arena->buffer = buffer;
+        arena->size = buffer ? size : 0;
+        arena->used = 0;
+    }
+}
+
+/**
+ * @brief Release all of the memory given out by an arena at once
+ * @param arena - arena to reset
+ */
+void bacapp_arena_reset(BACNET_APPLICATION_DATA_ARENA *arena)
+{
+    if (arena) {
+        arena->used = 0;
+    }
+}
+
+/**
+ * @brief Get memory from an arena, aligned for any value
+ * @param arena - arena to get the memory from
+ * @param size - number of bytes needed
+ * @return pointer to the memory, or NULL if the arena is used up
+ */
+void *bacapp_arena_alloc(BACNET_APPLICATION_DATA_ARENA *arena, size_t size)
+{
+    uintptr_t address;
+    size_t offset;
+
+    if (!arena || !arena->buffer) {
+        return NULL;
+    }
+    address = (uintptr_t)&arena->buffer[arena->used];
+    offset = (size_t)((BACAPP_ARENA_ALIGNMENT -
+                       (address % BACAPP_ARENA_ALIGNMENT)) %
+                      BACAPP_ARENA_ALIGNMENT);
+    if ((offset > (arena->size - arena->used)) ||
+        (size > (arena->size - arena->used - offset))) {
+        return NULL;
+    }
+    arena->used += offset;
+    address = (uintptr_t)&arena->buffer[arena->used];
+    arena->used += size;
+
+    return (void *)address;
+}
+
+/**
+ * @brief Decode one value into a compact value. Scalars are decoded, and
+ *  strings and context tagged or constructed data point into the APDU,
+ *  which has to be kept while the value is used.
+ * @param apdu - buffer of data to be decoded
+ * @param apdu_size - number of bytes in the buffer
+ * @param value - decoded value, if decoded
+ * @return the number of apdu bytes consumed, 0 on bad args, or
+ *  BACNET_STATUS_ERROR
+ */
+int bacapp_decode_application_data_compact(
+    const uint8_t *apdu,
+    uint32_t apdu_size,
+    BACNET_APPLICATION_DATA_COMPACT *value)
+{
+    BACNET_TAG tag = { 0 };
+    BACNET_OBJECT_TYPE object_type = OBJECT_NONE;
+    uint32_t length = 0;
+    int len = 0, data_len = 0;
+
+    if (!value || !apdu || (apdu_size == 0)) {
+        return 0;
+    }
+    len = bacnet_tag_decode(apdu, apdu_size, &tag);
+    if ((len <= 0) || tag.closing) {
+        return BACNET_STATUS_ERROR;
+    }
+    memset(value, 0, sizeof(BACNET_APPLICATION_DATA_COMPACT));
+    value->apdu = apdu;
+    if (tag.opening) {
+        /* constructed data is kept as it was encoded, with its tags */
+        data_len = bacnet_enclosed_data_length(apdu, apdu_size);
+        if (data_len < 0) {
+            return BACNET_STATUS_ERROR;
+        }
+        value->context_specific = true;
+        value->constructed = true;
+        value->context_tag = tag.number;
+        value->tag = MAX_BACNET_APPLICATION_TAG;
+        value->type.String.value = &apdu[len];
+        value->type.String.length = (uint32_t)data_len;
+        /* the closing tag is the same length as the opening tag */
+        value->apdu_len = (uint32_t)(len + data_len + len);
+        if (value->apdu_len > apdu_size) {
+            return BACNET_STATUS_ERROR;
+        }
+        return (int)value->apdu_len;
+    }
+    if (tag.len_value_type > (apdu_size - (uint32_t)len)) {
+        if (!tag.application ||
+            (tag.number != BACNET_APPLICATION_TAG_BOOLEAN)) {
+            return BACNET_STATUS_ERROR;
+        }
+    }
+    if (tag.context) {
+        value->context_specific = true;
+        value->context_tag = tag.number;
+        value->tag = MAX_BACNET_APPLICATION_TAG;
+        value->type.String.value = &apdu[len];
+        value->type.String.length = tag.len_value_type;
+        value->apdu_len = (uint32_t)len + tag.len_value_type;
+        return (int)value->apdu_len;
+    }
+    value->tag = tag.number;
+    /* content that is decoded must use all of its octets */
+    length = tag.len_value_type;
+    switch (tag.number) {
+        case BACNET_APPLICATION_TAG_NULL:
+            length = 0;
+            break;
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            /* the value is in the tag */
+            value->type.Boolean = tag.len_value_type ? true : false;
+            length = 0;
+            break;
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            data_len = bacnet_unsigned_decode(
+                &apdu[len], apdu_size - len, length,
+                &value->type.Unsigned_Int);
+            break;
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            data_len = bacnet_signed_decode(
+                &apdu[len], apdu_size - len, length,
+                &value->type.Signed_Int);
+            break;
+        case BACNET_APPLICATION_TAG_REAL:
+            data_len = bacnet_real_decode(
+                &apdu[len], apdu_size - len, length, &value->type.Real);
+            break;
+        case BACNET_APPLICATION_TAG_DOUBLE:
+            data_len = bacnet_double_decode(
+                &apdu[len], apdu_size - len, length, &value->type.Double);
+            break;
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            data_len = bacnet_enumerated_decode(
+                &apdu[len], apdu_size - len, length,
+                &value->type.Enumerated);
+            break;
+        case BACNET_APPLICATION_TAG_DATE:
+            data_len = bacnet_date_decode(
+                &apdu[len], apdu_size - len, length, &value->type.Date);
+            break;
+        case BACNET_APPLICATION_TAG_TIME:
+            data_len = bacnet_time_decode(
+                &apdu[len], apdu_size - len, length, &value->type.Time);
+            break;
+        case BACNET_APPLICATION_TAG_OBJECT_ID:
+            data_len = bacnet_object_id_decode(
+                &apdu[len], apdu_size - len, length, &object_type,
+                &value->type.Object_Id.instance);
+            value->type.Object_Id.type = object_type;
+            break;
+        case BACNET_APPLICATION_TAG_OCTET_STRING:
+            value->type.String.value = &apdu[len];
+            value->type.String.length = length;
+            data_len = (int)length;
+            break;
+        case BACNET_APPLICATION_TAG_CHARACTER_STRING:
+        case BACNET_APPLICATION_TAG_BIT_STRING:
+            if (length == 0) {
+                return BACNET_STATUS_ERROR;
+            }
+            /* the character set, or the unused bits */
+            value->type.String.encoding = apdu[len];
+            value->type.String.value = &apdu[len + 1];
+            value->type.String.length = length - 1;
+            data_len = (int)length;
+            break;
+        default:
+            return BACNET_STATUS_ERROR;
+    }
+    if ((data_len < 0) || ((uint32_t)data_len != length)) {
+        return BACNET_STATUS_ERROR;
+    }
+    value->apdu_len = (uint32_t)len + length;
+
+    return (int)value->apdu_len;
+}
+
+/**
+ * @brief Decode all of the values in a buffer, such as the property value
+ *  of a ReadProperty-ACK, into a list of compact values that are given
+ *  out by an arena. Strings and constructed data point into the buffer.
+ * @param apdu - buffer of data to be decoded
+ * @param apdu_size - number of bytes in the buffer
+ * @param arena - arena that gives out the values
+ * @param list - first value of the list, or NULL for no values
+ * @return the number of apdu bytes consumed, or BACNET_STATUS_ERROR if
+ *  the data is malformed, or BACNET_STATUS_ABORT if the arena is used up
+ */
+int bacapp_decode_compact_list(
+    const uint8_t *apdu,
+    uint32_t apdu_size,
+    BACNET_APPLICATION_DATA_ARENA *arena,
+    BACNET_APPLICATION_DATA_COMPACT **list)
+{
+    BACNET_APPLICATION_DATA_COMPACT *value, *last = NULL;
+    uint32_t apdu_len = 0;
+    int len;
+
+    if (!list) {
+        return BACNET_STATUS_ERROR;
+    }
+    *list = NULL;
+    while (apdu && (apdu_len < apdu_size)) {
+        value = bacapp_arena_alloc(
+            arena, sizeof(BACNET_APPLICATION_DATA_COMPACT));
+        if (!value) {
+            return BACNET_STATUS_ABORT;
+        }
+        len = bacapp_decode_application_data_compact(
+            &apdu[apdu_len], apdu_size - apdu_len, value);
+        if (len <= 0) {
+            return BACNET_STATUS_ERROR;
+        }
+        apdu_len += (uint32_t)len;
+        if (last) {
+            last->next = value;
+        } else {
+            *list = value;
+        }
+        last = value;
+    }
+
+    return (int)apdu_len;
+}
+
+/**
+ * @brief Decode a compact value of an application tag into a full value.
+ *  Context specific data is decoded from its encoding with
+ *  bacapp_decode_known_property() since its type depends on the property.
+ * @param compact - the compact value
+ * @param value - decoded value, if decoded
+ * @return true if the value was decoded
+ */
+bool bacapp_compact_to_value(
+    const BACNET_APPLICATION_DATA_COMPACT *compact,
+    BACNET_APPLICATION_DATA_VALUE *value)
+{
+    int len;
+
+    if (!compact || !value || compact->context_specific || !compact->apdu) {
+        return false;
+    }
+    len = bacapp_decode_application_data(
+        compact->apdu, compact->apdu_len, value);
+
+    return (len > 0) && ((uint32_t)len == compact->apdu_len);
+}
+
+/**
+ * @brief Copy a compact character string value into a C string,
+ *  truncated to fit in the buffer
+ * @param compact - the compact value
+ * @param buffer - buffer for the C string
+ * @param buffer_size - number of bytes in the buffer
+ * @return true if the value is a character string, which may be empty
+ */
+bool bacapp_compact_character_string(
+    const BACNET_APPLICATION_DATA_COMPACT *compact,
+    char *buffer,
+    size_t buffer_size)
+{
+    size_t length;
+
+    if (!compact || !buffer || (buffer_size == 0) ||
+        (compact->tag != BACNET_APPLICATION_TAG_CHARACTER_STRING)) {
+        return false;
+    }
+    length = compact->type.String.length;
+    if (length >= buffer_size) {
+        length = buffer_size - 1;
+    }
+    if (length > 0) {
+        memcpy(buffer, compact->type.String.value, length);
+    }
+    buffer[length] = 0;
+
+    return true;
+}
@@ -223,6 +223,55 @@ typedef struct BACnet_Object_Property_Value {
     BACNET_APPLICATION_DATA_VALUE *value;
 } BACNET_OBJECT_PROPERTY_VALUE;
 
+/* alignment of the memory given out by an arena */
+#ifndef BACAPP_ARENA_ALIGNMENT
+#define BACAPP_ARENA_ALIGNMENT 8
+#endif
+
+/* memory for decoded values that is given out from a buffer of the caller,
+   and released all at once, such as at the end of a service handler */
+typedef struct BACnet_Application_Data_Arena {
+    uint8_t *buffer;
+    size_t size;
+    size_t used;
+} BACNET_APPLICATION_DATA_ARENA;
+
+/* A decoded value of one tag that is small enough to decode a whole reply
+   into. Scalars are decoded, and strings and context tagged or constructed
+   data are left where they are encoded, in the APDU or in an arena. */
+struct BACnet_Application_Data_Compact;
+typedef struct BACnet_Application_Data_Compact {
+    bool context_specific; /* true if context specific data */
+    bool constructed; /* true if enclosed in opening and closing tags */
+    uint8_t context_tag; /* only used for context specific data */
+    /* application tag data type, or MAX_BACNET_APPLICATION_TAG for
+       context specific data, which has no type until decoded */
+    uint8_t tag;
+    /* the value as it is encoded, with its tags */
+    const uint8_t *apdu;
+    uint32_t apdu_len;
+    union {
+        bool Boolean;
+        BACNET_UNSIGNED_INTEGER Unsigned_Int;
+        int32_t Signed_Int;
+        float Real;
+        double Double;
+        uint32_t Enumerated;
+        BACNET_DATE Date;
+        BACNET_TIME Time;
+        BACNET_OBJECT_ID Object_Id;
+        /* octet, character, or bit string, or context specific data */
+        struct {
+            const uint8_t *value;
+            uint32_t length;
+            /* character set, or unused bits of a bit string */
+            uint8_t encoding;
+        } String;
+    } type;
+    /* simple linked list if needed */
+    struct BACnet_Application_Data_Compact *next;
+} BACNET_APPLICATION_DATA_COMPACT;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -396,6 +445,35 @@ bool bacapp_same_value(
     const BACNET_APPLICATION_DATA_VALUE *value,
     const BACNET_APPLICATION_DATA_VALUE *test_value);
 
+BACNET_STACK_EXPORT
+void bacapp_arena_init(
+    BACNET_APPLICATION_DATA_ARENA *arena, void *buffer, size_t size);
+BACNET_STACK_EXPORT
+void bacapp_arena_reset(BACNET_APPLICATION_DATA_ARENA *arena);
+BACNET_STACK_EXPORT
+void *bacapp_arena_alloc(BACNET_APPLICATION_DATA_ARENA *arena, size_t size);
+
+BACNET_STACK_EXPORT
+int bacapp_decode_application_data_compact(
+    const uint8_t *apdu,
+    uint32_t apdu_size,
+    BACNET_APPLICATION_DATA_COMPACT *value);
+BACNET_STACK_EXPORT
+int bacapp_decode_compact_list(
+    const uint8_t *apdu,
+    uint32_t apdu_size,
+    BACNET_APPLICATION_DATA_ARENA *arena,
+    BACNET_APPLICATION_DATA_COMPACT **list);
+BACNET_STACK_EXPORT
+bool bacapp_compact_to_value(
+    const BACNET_APPLICATION_DATA_COMPACT *compact,
+    BACNET_APPLICATION_DATA_VALUE *value);
+BACNET_STACK_EXPORT
+bool bacapp_compact_character_string(
+    const BACNET_APPLICATION_DATA_COMPACT *compact,
+    char *buffer,
+    size_t buffer_size);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
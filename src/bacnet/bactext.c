@@ -10,6 +10,7 @@
 #include "bacnet/indtext.h"
 #include "bacnet/bacenum.h"
 #include "bacnet/bactext.h"
+#include "bacnet/bactext_index.h"
 
 static const char *ASHRAE_Reserved_String = "Reserved for Use by ASHRAE";
 static const char *Vendor_Proprietary_String = "Vendor Proprietary Value";
@@ -17,12 +18,12 @@ static const char *Vendor_Proprietary_String = "Vendor Proprietary Value";
 /* Search for a text value first based on the corresponding text list, then by
  * attempting to convert to an integer value. */
 static bool bactext_strtol_index(
-    INDTEXT_DATA *istring, const char *search_name, unsigned *found_index)
+    INDTEXT_SORTED *istring, const char *search_name, unsigned *found_index)
 {
     char *endptr;
     long value;
 
-    if (indtext_by_istring(istring, search_name, found_index) == true) {
+    if (indtext_sorted_by_istring(istring, search_name, found_index)) {
         return true;
     } else {
         value = strtol(search_name, &endptr, 0);
@@ -159,8 +160,8 @@ const char *bactext_application_tag_name(unsigned index)
 bool bactext_application_tag_index(
     const char *search_name, unsigned *found_index)
 {
-    return indtext_by_istring(
-        bacnet_application_tag_names, search_name, found_index);
+    return indtext_sorted_by_istring(
+        &bacnet_application_tag_names_index, search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_object_type_names[] = {
@@ -244,14 +245,14 @@ const char *bactext_object_type_name(unsigned index)
 
 bool bactext_object_type_index(const char *search_name, unsigned *found_index)
 {
-    return indtext_by_istring(
-        bacnet_object_type_names, search_name, found_index);
+    return indtext_sorted_by_istring(
+        &bacnet_object_type_names_index, search_name, found_index);
 }
 
 bool bactext_object_type_strtol(const char *search_name, unsigned *found_index)
 {
     return bactext_strtol_index(
-        bacnet_object_type_names, search_name, found_index);
+        &bacnet_object_type_names_index, search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_property_names[] = {
@@ -826,18 +827,24 @@ bactext_property_name_default(unsigned index, const char *default_string)
 
 unsigned bactext_property_id(const char *name)
 {
-    return indtext_by_istring_default(bacnet_property_names, name, 0);
+    unsigned index = 0;
+
+    /* the index is not changed if the name is not found */
+    (void)indtext_sorted_by_istring(&bacnet_property_names_index, name, &index);
+
+    return index;
 }
 
 bool bactext_property_index(const char *search_name, unsigned *found_index)
 {
-    return indtext_by_istring(bacnet_property_names, search_name, found_index);
+    return indtext_sorted_by_istring(
+        &bacnet_property_names_index, search_name, found_index);
 }
 
 bool bactext_property_strtol(const char *search_name, unsigned *found_index)
 {
     return bactext_strtol_index(
-        bacnet_property_names, search_name, found_index);
+        &bacnet_property_names_index, search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_engineering_unit_names[] = {
@@ -1306,8 +1313,8 @@ const char *bactext_engineering_unit_name(unsigned index)
 bool bactext_engineering_unit_index(
     const char *search_name, unsigned *found_index)
 {
-    return indtext_by_istring(
-        bacnet_engineering_unit_names, search_name, found_index);
+    return indtext_sorted_by_istring(
+        &bacnet_engineering_unit_names_index, search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_reject_reason_names[] = {
@@ -1695,8 +1702,8 @@ const char *bactext_days_of_week_name(unsigned index)
 
 bool bactext_days_of_week_index(const char *search_name, unsigned *found_index)
 {
-    return indtext_by_istring(
-        bacnet_days_of_week_names, search_name, found_index);
+    return indtext_sorted_by_istring(
+        &bacnet_days_of_week_names_index, search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_notify_type_names[] = { { NOTIFY_ALARM, "alarm" },
@@ -1713,8 +1720,8 @@ const char *bactext_notify_type_name(unsigned index)
 
 bool bactext_notify_type_index(const char *search_name, unsigned *found_index)
 {
-    return indtext_by_istring(
-        bacnet_notify_type_names, search_name, found_index);
+    return indtext_sorted_by_istring(
+        &bacnet_notify_type_names_index, search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_event_transition_names[] = {
@@ -1733,8 +1740,8 @@ const char *bactext_event_transition_name(unsigned index)
 bool bactext_event_transition_index(
     const char *search_name, unsigned *found_index)
 {
-    return indtext_by_istring(
-        bacnet_event_transition_names, search_name, found_index);
+    return indtext_sorted_by_istring(
+        &bacnet_event_transition_names_index, search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_event_state_names[] = {
@@ -1754,14 +1761,14 @@ const char *bactext_event_state_name(unsigned index)
 
 bool bactext_event_state_index(const char *search_name, unsigned *found_index)
 {
-    return indtext_by_istring(
-        bacnet_event_state_names, search_name, found_index);
+    return indtext_sorted_by_istring(
+        &bacnet_event_state_names_index, search_name, found_index);
 }
 
 bool bactext_event_state_strtol(const char *search_name, unsigned *found_index)
 {
     return bactext_strtol_index(
-        bacnet_event_state_names, search_name, found_index);
+        &bacnet_event_state_names_index, search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_event_type_names[] = {
@@ -1797,8 +1804,8 @@ const char *bactext_event_type_name(unsigned index)
 
 bool bactext_event_type_index(const char *search_name, unsigned *found_index)
 {
-    return indtext_by_istring(
-        bacnet_event_type_names, search_name, found_index);
+    return indtext_sorted_by_istring(
+        &bacnet_event_type_names_index, search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_binary_present_value_names[] = {
@@ -1814,8 +1821,8 @@ const char *bactext_binary_present_value_name(unsigned index)
 bool bactext_binary_present_value_index(
     const char *search_name, unsigned *found_index)
 {
-    return indtext_by_istring(
-        bacnet_binary_present_value_names, search_name, found_index);
+    return indtext_sorted_by_istring(
+        &bacnet_binary_present_value_names_index, search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_binary_polarity_names[] = { { POLARITY_NORMAL, "normal" },
@@ -1897,8 +1904,8 @@ const char *bactext_segmentation_name(unsigned index)
 
 bool bactext_segmentation_index(const char *search_name, unsigned *found_index)
 {
-    return indtext_by_istring(
-        bacnet_segmentation_names, search_name, found_index);
+    return indtext_sorted_by_istring(
+        &bacnet_segmentation_names_index, search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_node_type_names[] = {
@@ -2060,7 +2067,7 @@ bool bactext_lighting_operation_strtol(
     const char *search_name, unsigned *found_index)
 {
     return bactext_strtol_index(
-        bacnet_lighting_operation_names, search_name, found_index);
+        &bacnet_lighting_operation_names_index, search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_binary_lighting_pv_names[] = {
@@ -2089,7 +2096,7 @@ bool bactext_binary_lighting_pv_names_strtol(
     const char *search_name, unsigned *found_index)
 {
     return bactext_strtol_index(
-        bacnet_binary_lighting_pv_names, search_name, found_index);
+        &bacnet_binary_lighting_pv_names_index, search_name, found_index);
 }
 
 INDTEXT_DATA bacnet_color_operation_names[] = {
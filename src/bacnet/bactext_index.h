@@ -0,0 +1,220 @@
+/**
+ * @file
+ * @brief Sorted indexes of the src/bacnet/bactext.c text tables
+ * @note Generated by tools/indtext-index/indtext-index.py
+ *  from these tables - regenerate when a table changes:
+ *  indtext-index.py src/bacnet/bactext.c \
+ *      bacnet_application_tag_names \
+ *      bacnet_object_type_names \
+ *      bacnet_property_names \
+ *      bacnet_engineering_unit_names \
+ *      bacnet_days_of_week_names \
+ *      bacnet_notify_type_names \
+ *      bacnet_event_transition_names \
+ *      bacnet_event_state_names \
+ *      bacnet_event_type_names \
+ *      bacnet_binary_present_value_names \
+ *      bacnet_segmentation_names \
+ *      bacnet_lighting_operation_names \
+ *      bacnet_binary_lighting_pv_names
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_BACTEXT_INDEX_H
+#define BACNET_BACTEXT_INDEX_H
+
+#include <stdint.h>
+#include "bacnet/indtext.h"
+
+extern INDTEXT_DATA bacnet_application_tag_names[];
+static const uint16_t bacnet_application_tag_names_sorted[] = {
+    37, 35, 27, 34, 26, 18, 19, 24, 22, 23, 36, 32,
+    31, 30, 25, 38, 39, 29, 20, 28, 17, 33, 8, 1,
+    7, 10, 5, 16, 9, 21, 0, 12, 6, 4, 13, 14,
+    15, 3, 11, 2
+};
+static INDTEXT_SORTED bacnet_application_tag_names_index = {
+    bacnet_application_tag_names, bacnet_application_tag_names_sorted, 40
+};
+
+extern INDTEXT_DATA bacnet_object_type_names[];
+static const uint16_t bacnet_object_type_names_sorted[] = {
+    32, 30, 33, 34, 35, 36, 23, 52, 0, 1, 2, 61,
+    62, 18, 3, 55, 4, 5, 39, 6, 53, 40, 63, 64,
+    7, 37, 41, 42, 43, 44, 8, 57, 58, 9, 25, 10,
+    26, 11, 45, 46, 21, 22, 59, 31, 54, 28, 12, 13,
+    14, 19, 56, 38, 15, 51, 47, 48, 16, 24, 17, 60,
+    29, 49, 50, 20, 27
+};
+static INDTEXT_SORTED bacnet_object_type_names_index = {
+    bacnet_object_type_names, bacnet_object_type_names_sorted, 65
+};
+
+extern INDTEXT_DATA bacnet_property_names[];
+static const uint16_t bacnet_property_names_sorted[] = {
+    18, 225, 175, 226, 227, 228, 229, 230, 231, 232, 233, 234,
+    1, 0, 2, 3, 235, 236, 453, 152, 4, 5, 206, 480,
+    176, 6, 7, 193, 8, 9, 338, 372, 10, 11, 12, 13,
+    237, 420, 124, 470, 471, 472, 469, 473, 238, 239, 240, 241,
+    337, 242, 169, 125, 311, 153, 312, 380, 381, 382, 383, 385,
+    408, 413, 411, 300, 386, 387, 388, 243, 14, 315, 316, 346,
+    126, 421, 422, 423, 424, 425, 426, 427, 428, 429, 430, 431,
+    481, 15, 16, 389, 339, 127, 513, 508, 509, 390, 403, 482,
+    154, 340, 19, 20, 21, 177, 178, 179, 22, 180, 128, 322,
+    323, 244, 245, 246, 247, 404, 487, 129, 155, 23, 24, 248,
+    25, 510, 511, 347, 464, 348, 349, 462, 366, 474, 456, 26,
+    27, 28, 29, 30, 31, 479, 156, 301, 302, 215, 216, 217,
+    218, 219, 220, 221, 207, 32, 359, 350, 33, 432, 133, 433,
+    434, 249, 34, 435, 327, 328, 326, 35, 324, 325, 83, 36,
+    130, 37, 38, 341, 250, 208, 251, 252, 253, 254, 255, 361,
+    362, 331, 436, 332, 39, 391, 392, 40, 41, 42, 43, 44,
+    478, 437, 209, 438, 319, 318, 439, 514, 45, 440, 47, 351,
+    46, 367, 181, 441, 48, 352, 360, 49, 50, 194, 373, 374,
+    375, 376, 377, 378, 379, 384, 409, 415, 412, 416, 417, 418,
+    414, 410, 419, 317, 51, 483, 303, 443, 442, 444, 256, 257,
+    405, 258, 259, 260, 261, 304, 173, 342, 195, 157, 368, 262,
+    166, 353, 354, 52, 182, 393, 395, 394, 53, 54, 55, 56,
+    333, 57, 58, 222, 263, 264, 131, 132, 134, 183, 184, 196,
+    363, 515, 59, 445, 396, 446, 158, 447, 60, 170, 223, 265,
+    355, 62, 484, 266, 63, 64, 485, 65, 167, 61, 475, 135,
+    149, 159, 320, 267, 356, 69, 66, 67, 68, 136, 150, 160,
+    70, 71, 476, 268, 269, 305, 397, 398, 399, 400, 448, 201,
+    202, 17, 137, 72, 73, 270, 74, 75, 76, 77, 78, 79,
+    271, 272, 273, 274, 275, 276, 277, 278, 279, 449, 161, 486,
+    80, 81, 82, 512, 306, 280, 281, 282, 450, 84, 336, 283,
+    357, 451, 185, 465, 85, 138, 86, 87, 88, 89, 334, 457,
+    168, 90, 91, 92, 344, 93, 94, 95, 454, 96, 139, 97,
+    98, 186, 99, 284, 100, 101, 102, 141, 140, 455, 452, 103,
+    330, 104, 463, 210, 321, 105, 106, 313, 314, 401, 488, 489,
+    490, 491, 492, 493, 494, 495, 496, 497, 503, 498, 499, 500,
+    501, 502, 506, 507, 504, 505, 187, 188, 174, 224, 307, 308,
+    107, 477, 345, 108, 109, 162, 211, 212, 213, 163, 171, 172,
+    467, 466, 142, 369, 214, 110, 111, 143, 144, 364, 365, 203,
+    204, 205, 459, 461, 460, 335, 286, 285, 309, 112, 458, 468,
+    287, 288, 113, 329, 114, 197, 115, 198, 116, 370, 371, 145,
+    289, 164, 290, 358, 199, 516, 117, 118, 310, 189, 291, 292,
+    293, 294, 295, 296, 119, 200, 146, 190, 192, 191, 406, 407,
+    151, 120, 121, 299, 402, 122, 123, 147, 148, 343, 297, 165,
+    298
+};
+static INDTEXT_SORTED bacnet_property_names_index = {
+    bacnet_property_names, bacnet_property_names_sorted, 517
+};
+
+extern INDTEXT_DATA bacnet_engineering_unit_names[];
+static const uint16_t bacnet_engineering_unit_names_sorted[] = {
+    356, 263, 238, 246, 169, 368, 3, 167, 168, 366, 55, 222,
+    375, 344, 345, 20, 296, 50, 295, 117, 24, 294, 379, 179,
+    180, 118, 60, 57, 346, 347, 79, 248, 191, 84, 141, 369,
+    80, 249, 135, 165, 85, 105, 114, 106, 107, 108, 109, 110,
+    111, 112, 113, 25, 26, 70, 199, 232, 200, 201, 65, 66,
+    90, 62, 315, 91, 92, 64, 317, 93, 94, 262, 14, 266,
+    318, 120, 121, 265, 268, 170, 33, 77, 76, 38, 378, 382,
+    371, 373, 374, 370, 195, 28, 221, 217, 280, 208, 279, 210,
+    214, 213, 155, 154, 235, 225, 133, 171, 27, 51, 71, 158,
+    81, 323, 322, 86, 321, 32, 61, 58, 264, 247, 183, 16,
+    251, 306, 127, 128, 23, 305, 304, 63, 316, 181, 182, 147,
+    299, 157, 298, 297, 223, 376, 380, 39, 186, 281, 44, 209,
+    339, 43, 42, 129, 122, 17, 310, 151, 309, 125, 149, 308,
+    307, 193, 75, 54, 240, 243, 9, 12, 6, 19, 138, 137,
+    348, 204, 48, 82, 324, 136, 88, 87, 278, 293, 292, 291,
+    290, 36, 349, 37, 148, 303, 302, 301, 300, 224, 377, 381,
+    130, 126, 314, 152, 313, 150, 312, 311, 140, 139, 241, 244,
+    10, 13, 7, 146, 205, 49, 123, 31, 164, 163, 74, 166,
+    276, 289, 288, 287, 286, 190, 275, 342, 219, 332, 334, 216,
+    337, 227, 194, 355, 230, 231, 272, 78, 2, 134, 196, 341,
+    218, 211, 212, 215, 336, 226, 197, 361, 198, 30, 59, 206,
+    162, 161, 363, 145, 320, 319, 256, 254, 360, 359, 260, 261,
+    159, 202, 357, 358, 229, 124, 132, 362, 72, 236, 252, 68,
+    274, 343, 220, 333, 335, 340, 338, 273, 233, 153, 160, 187,
+    188, 95, 237, 172, 4, 352, 97, 96, 253, 53, 331, 269,
+    131, 207, 330, 270, 100, 101, 98, 143, 144, 329, 328, 327,
+    99, 29, 234, 350, 351, 56, 353, 354, 40, 259, 46, 45,
+    119, 15, 102, 364, 103, 184, 365, 104, 73, 277, 285, 284,
+    283, 282, 173, 174, 228, 403, 412, 404, 405, 406, 407, 408,
+    409, 410, 411, 267, 116, 1, 115, 0, 185, 255, 372, 175,
+    21, 257, 258, 22, 41, 156, 52, 83, 326, 192, 89, 325,
+    239, 242, 8, 11, 245, 367, 5, 176, 177, 383, 392, 384,
+    385, 386, 387, 388, 389, 390, 391, 393, 402, 394, 395, 396,
+    397, 398, 399, 400, 401, 18, 250, 203, 47, 189, 34, 35,
+    142, 178, 69, 271, 67
+};
+static INDTEXT_SORTED bacnet_engineering_unit_names_index = {
+    bacnet_engineering_unit_names, bacnet_engineering_unit_names_sorted, 413
+};
+
+extern INDTEXT_DATA bacnet_days_of_week_names[];
+static const uint16_t bacnet_days_of_week_names_sorted[] = {
+    4, 0, 5, 6, 3, 1, 2
+};
+static INDTEXT_SORTED bacnet_days_of_week_names_index = {
+    bacnet_days_of_week_names, bacnet_days_of_week_names_sorted, 7
+};
+
+extern INDTEXT_DATA bacnet_notify_type_names[];
+static const uint16_t bacnet_notify_type_names_sorted[] = {
+    2, 0, 1
+};
+static INDTEXT_SORTED bacnet_notify_type_names_index = {
+    bacnet_notify_type_names, bacnet_notify_type_names_sorted, 3
+};
+
+extern INDTEXT_DATA bacnet_event_transition_names[];
+static const uint16_t bacnet_event_transition_names_sorted[] = {
+    2, 1, 0
+};
+static INDTEXT_SORTED bacnet_event_transition_names_index = {
+    bacnet_event_transition_names, bacnet_event_transition_names_sorted, 3
+};
+
+extern INDTEXT_DATA bacnet_event_state_names[];
+static const uint16_t bacnet_event_state_names_sorted[] = {
+    1, 3, 4, 0, 2
+};
+static INDTEXT_SORTED bacnet_event_state_names_index = {
+    bacnet_event_state_names, bacnet_event_state_names_sorted, 5
+};
+
+extern INDTEXT_DATA bacnet_event_type_names[];
+static const uint16_t bacnet_event_type_names_sorted[] = {
+    10, 8, 0, 14, 18, 6, 16, 1, 15, 19, 2, 3,
+    11, 7, 4, 17, 5, 12, 13, 9
+};
+static INDTEXT_SORTED bacnet_event_type_names_index = {
+    bacnet_event_type_names, bacnet_event_type_names_sorted, 20
+};
+
+extern INDTEXT_DATA bacnet_binary_present_value_names[];
+static const uint16_t bacnet_binary_present_value_names_sorted[] = {
+    1, 0
+};
+static INDTEXT_SORTED bacnet_binary_present_value_names_index = {
+    bacnet_binary_present_value_names,
+    bacnet_binary_present_value_names_sorted,
+    2
+};
+
+extern INDTEXT_DATA bacnet_segmentation_names[];
+static const uint16_t bacnet_segmentation_names_sorted[] = {
+    3, 0, 2, 1
+};
+static INDTEXT_SORTED bacnet_segmentation_names_index = {
+    bacnet_segmentation_names, bacnet_segmentation_names_sorted, 4
+};
+
+extern INDTEXT_DATA bacnet_lighting_operation_names[];
+static const uint16_t bacnet_lighting_operation_names_sorted[] = {
+    1, 0, 2, 4, 6, 5, 3, 10, 7, 8, 9
+};
+static INDTEXT_SORTED bacnet_lighting_operation_names_index = {
+    bacnet_lighting_operation_names, bacnet_lighting_operation_names_sorted, 11
+};
+
+extern INDTEXT_DATA bacnet_binary_lighting_pv_names[];
+static const uint16_t bacnet_binary_lighting_pv_names_sorted[] = {
+    0, 1, 5, 2, 3, 4
+};
+static INDTEXT_SORTED bacnet_binary_lighting_pv_names_index = {
+    bacnet_binary_lighting_pv_names, bacnet_binary_lighting_pv_names_sorted, 6
+};
+
+#endif
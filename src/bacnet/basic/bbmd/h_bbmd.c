@@ -66,6 +66,9 @@ static BACNET_IP_BROADCAST_DISTRIBUTION_TABLE_ENTRY
 #define MAX_FD_ENTRIES 128
 #endif
 static BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY FD_Table[MAX_FD_ENTRIES];
+/* destinations of a Forwarded-NPDU, which are sent in one batch */
+static BACNET_IP_ADDRESS Forward_Dest[MAX_BBMD_ENTRIES + MAX_FD_ENTRIES];
+static unsigned Forward_Dest_Count;
 #endif
 
 /**
@@ -333,28 +336,24 @@ static uint16_t bbmd_forward_npdu(
     return mtu_len;
 }
 
-/** Sends all Broadcast Devices a Forwarded NPDU
+/** Encodes a Forwarded NPDU for the BDT and FDT entries
  *
+ * @param mtu - buffer for the Forwarded NPDU
+ * @param mtu_size - size of the buffer
  * @param bip_src - source IP address and UDP port
- * @param npdu - returns the NPDU
- * @param max_npdu - amount of space available in the NPDU
+ * @param npdu - the NPDU
  * @param npdu_length - reported length of the NPDU
  * @param original - was the message an original (not forwarded)
  * @return number of bytes encoded in the Forwarded NPDU
  */
-static uint16_t bbmd_bdt_forward_npdu(
+static uint16_t bbmd_table_forward_npdu_encode(
+    uint8_t *mtu,
+    uint16_t mtu_size,
     const BACNET_IP_ADDRESS *bip_src,
     const uint8_t *npdu,
     uint16_t npdu_length,
     bool original)
 {
-    uint8_t mtu[BIP_MPDU_MAX] = { 0 };
-    uint16_t mtu_len = 0;
-    unsigned i = 0; /* loop counter */
-    BACNET_IP_ADDRESS bip_dest = { 0 };
-    BACNET_IP_ADDRESS my_addr = { 0 };
-
-    bip_get_addr(&my_addr);
     /* If we are forwarding an original broadcast message and the NAT
      * handling is enabled, change the source address to NAT routers
      * global IP address so the recipient can reply (local IP address
@@ -364,56 +363,68 @@ static uint16_t bbmd_bdt_forward_npdu(
      * or the NAT handling is disabled, leave the source address as is.
      */
     if (BVLC_NAT_Handling && original) {
-        mtu_len = (uint16_t)bvlc_encode_forwarded_npdu(
-            &mtu[0], (uint16_t)sizeof(mtu), &BVLC_Global_Address, npdu,
-            npdu_length);
-    } else {
-        mtu_len = (uint16_t)bvlc_encode_forwarded_npdu(
-            &mtu[0], (uint16_t)sizeof(mtu), bip_src, npdu, npdu_length);
+        bip_src = &BVLC_Global_Address;
     }
-    /* loop through the BDT and send one to each entry */
-    for (i = 0; i < MAX_BBMD_ENTRIES; i++) {
-        if (BBMD_Table[i].valid) {
-            bvlc_broadcast_distribution_table_entry_forward_address(
-                &bip_dest, &BBMD_Table[i]);
-            if (!bvlc_address_different(&bip_dest, &my_addr)) {
-                /* don't forward to our selves */
-                continue;
-            }
-            if (!bvlc_address_different(&bip_dest, bip_src)) {
-                /* don't forward back to origin */
-                continue;
-            }
-            if (BVLC_NAT_Handling) {
-                if (bvlc_address_different(&bip_dest, &BVLC_Global_Address)) {
-                    /* NAT router port forwards BACnet packets from global IP.
-                       Packets sent to that global IP by us would end up back,
-                       creating a loop. */
-                    continue;
-                }
-            }
-            bip_send_mpdu(&bip_dest, mtu, mtu_len);
-            debug_print_bip("BDT Send Forwarded-NPDU", &bip_dest);
+
+    return (uint16_t)bvlc_encode_forwarded_npdu(
+        mtu, mtu_size, bip_src, npdu, npdu_length);
+}
+
+/** Adds a destination for the Forwarded NPDU, unless it is ourselves,
+ * the origin of the message, or our NAT router.
+ *
+ * @param bip_dest - destination IP address and UDP port
+ * @param bip_src - source IP address and UDP port of the message
+ * @param my_addr - our IP address and UDP port
+ * @return true if the destination was added
+ */
+static bool bbmd_forward_dest_add(
+    const BACNET_IP_ADDRESS *bip_dest,
+    const BACNET_IP_ADDRESS *bip_src,
+    const BACNET_IP_ADDRESS *my_addr)
+{
+    if (!bvlc_address_different(bip_dest, my_addr)) {
+        /* don't forward to our selves */
+        return false;
+    }
+    if (!bvlc_address_different(bip_dest, bip_src)) {
+        /* don't forward back to origin */
+        return false;
+    }
+    if (BVLC_NAT_Handling) {
+        if (bvlc_address_different(bip_dest, &BVLC_Global_Address)) {
+            /* NAT router port forwards BACnet packets from global IP.
+               Packets sent to that global IP by us would end up back,
+               creating a loop. */
+            return false;
         }
     }
+    if (Forward_Dest_Count >= ARRAY_SIZE(Forward_Dest)) {
+        return false;
+    }
+    bvlc_address_copy(&Forward_Dest[Forward_Dest_Count], bip_dest);
+    Forward_Dest_Count++;
 
-    return mtu_len;
+    return true;
 }
 
-/** Sends all Foreign Devices a Forwarded NPDU
+/** Sends a Forwarded NPDU to all Foreign Devices, and optionally to all
+ * Broadcast Devices. The destinations are collected and then sent the
+ * one encoded Forwarded NPDU in a single batch.
  *
  * @param bip_src - source IP address and UDP port
- * @param npdu - returns the NPDU
- * @param max_npdu - amount of space available in the NPDU
+ * @param npdu - the NPDU
  * @param npdu_length - reported length of the NPDU
  * @param original - was the message an original (not forwarded)
+ * @param bdt - true to also send to each entry of the BDT
  * @return number of bytes encoded in the Forwarded NPDU
  */
-static uint16_t bbmd_fdt_forward_npdu(
+static uint16_t bbmd_table_forward_npdu(
     const BACNET_IP_ADDRESS *bip_src,
     const uint8_t *npdu,
     uint16_t npdu_length,
-    bool original)
+    bool original,
+    bool bdt)
 {
     uint8_t mtu[BIP_MPDU_MAX] = { 0 };
     uint16_t mtu_len = 0;
@@ -422,47 +433,37 @@ static uint16_t bbmd_fdt_forward_npdu(
     BACNET_IP_ADDRESS my_addr = { 0 };
 
     bip_get_addr(&my_addr);
-    /* If we are forwarding an original broadcast message and the NAT
-     * handling is enabled, change the source address to NAT routers
-     * global IP address so the recipient can reply (local IP address
-     * is not accessible from internet side.
-     *
-     * If we are forwarding a message from peer BBMD or foreign device
-     * or the NAT handling is disabled, leave the source address as is.
-     */
-    if (BVLC_NAT_Handling && original) {
-        mtu_len = (uint16_t)bvlc_encode_forwarded_npdu(
-            &mtu[0], (uint16_t)sizeof(mtu), &BVLC_Global_Address, npdu,
-            npdu_length);
-    } else {
-        mtu_len = (uint16_t)bvlc_encode_forwarded_npdu(
-            &mtu[0], (uint16_t)sizeof(mtu), bip_src, npdu, npdu_length);
+    mtu_len = bbmd_table_forward_npdu_encode(
+        &mtu[0], (uint16_t)sizeof(mtu), bip_src, npdu, npdu_length,
+        original);
+    if (mtu_len == 0) {
+        return 0;
     }
-
-    /* loop through the FDT and send one to each entry */
+    Forward_Dest_Count = 0;
+    /* loop through the FDT and add each entry */
     for (i = 0; i < MAX_FD_ENTRIES; i++) {
         if (FD_Table[i].valid && FD_Table[i].ttl_seconds_remaining) {
-            bvlc_address_copy(&bip_dest, &FD_Table[i].dest_address);
-            if (!bvlc_address_different(&bip_dest, &my_addr)) {
-                /* don't forward to our selves */
-                continue;
-            }
-            if (!bvlc_address_different(&bip_dest, bip_src)) {
-                /* don't forward back to origin */
-                continue;
+            if (bbmd_forward_dest_add(
+                    &FD_Table[i].dest_address, bip_src, &my_addr)) {
+                debug_print_bip(
+                    "FDT Send Forwarded-NPDU", &FD_Table[i].dest_address);
             }
-            if (BVLC_NAT_Handling) {
-                if (bvlc_address_different(&bip_dest, &BVLC_Global_Address)) {
-                    /* NAT router port forwards BACnet packets from global IP.
-                       Packets sent to that global IP by us would end up back,
-                       creating a loop. */
-                    continue;
-                }
+        }
+    }
+    /* loop through the BDT and add each entry */
+    for (i = 0; bdt && (i < MAX_BBMD_ENTRIES); i++) {
+        if (BBMD_Table[i].valid) {
+            bvlc_broadcast_distribution_table_entry_forward_address(
+                &bip_dest, &BBMD_Table[i]);
+            if (bbmd_forward_dest_add(&bip_dest, bip_src, &my_addr)) {
+                debug_print_bip("BDT Send Forwarded-NPDU", &bip_dest);
             }
-            bip_send_mpdu(&bip_dest, mtu, mtu_len);
-            debug_print_bip("FDT Send Forwarded-NPDU", &bip_dest);
         }
     }
+    if (Forward_Dest_Count > 0) {
+        bip_send_mpdu_batch(
+            &Forward_Dest[0], Forward_Dest_Count, &mtu[0], mtu_len);
+    }
 
     return mtu_len;
 }
@@ -611,8 +612,8 @@ int bvlc_send_pdu(
 #if BBMD_ENABLED
             if (mtu_len > 0) {
                 bip_get_addr(&bip_src);
-                (void)bbmd_fdt_forward_npdu(&bip_src, pdu, pdu_len, true);
-                (void)bbmd_bdt_forward_npdu(&bip_src, pdu, pdu_len, true);
+                (void)bbmd_table_forward_npdu(
+                    &bip_src, pdu, pdu_len, true, true);
             }
 #endif
         }
@@ -953,8 +954,8 @@ int bvlc_bbmd_enabled_handler(
                     the BBMD's FDT. */
                 offset = header_len + function_len - npdu_len;
                 npdu = &mtu[offset];
-                (void)bbmd_fdt_forward_npdu(
-                    &fwd_address, npdu, npdu_len, false);
+                (void)bbmd_table_forward_npdu(
+                    &fwd_address, npdu, npdu_len, false, false);
                 /* prepare the message for me! */
                 bvlc_ip_address_to_bacnet_local(src, &fwd_address);
                 debug_print_npdu("Forwarded-NPDU", offset, npdu_len);
@@ -1057,8 +1058,8 @@ int bvlc_bbmd_enabled_handler(
                attempt was unsuccessful */
             npdu_len = bbmd_forward_npdu(addr, pdu, pdu_len);
             if (npdu_len > 0) {
-                (void)bbmd_fdt_forward_npdu(addr, pdu, pdu_len, false);
-                (void)bbmd_bdt_forward_npdu(addr, pdu, pdu_len, false);
+                (void)bbmd_table_forward_npdu(
+                    addr, pdu, pdu_len, false, true);
             } else {
                 result_code = BVLC_RESULT_DISTRIBUTE_BROADCAST_TO_NETWORK_NAK;
                 send_result = true;
@@ -1123,8 +1124,8 @@ int bvlc_bbmd_enabled_handler(
                     debug_print_string("Dropped Original-Broadcast-NPDU: "
                                        "Confirmed Service!");
                 } else {
-                    (void)bbmd_fdt_forward_npdu(addr, npdu, npdu_len, true);
-                    (void)bbmd_bdt_forward_npdu(addr, npdu, npdu_len, true);
+                    (void)bbmd_table_forward_npdu(
+                        addr, npdu, npdu_len, true, true);
                     debug_print_npdu(
                         "Original-Broadcast-NPDU", offset, npdu_len);
                 }
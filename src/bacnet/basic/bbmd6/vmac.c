@@ -33,8 +33,187 @@ void VMAC_Debug_Enable(void)
 /* This module is used to handle the virtual MAC address binding that */
 /* occurs in BACnet for ZigBee or IPv6. */
 
+/* Each VMAC is stored in an entry that is also linked into a hash index
+   of the VMAC address and into a least recently used list, so that the
+   receive path can find the Device ID of a B/IPv6 address without
+   scanning the list. The VMAC data is first, so that the Key List data
+   can be returned as the VMAC data. */
+struct vmac_entry {
+    struct vmac_data vmac;
+    uint32_t device_id;
+    /* next entry in the same hash bucket */
+    struct vmac_entry *hash_next;
+    /* least recently used list */
+    struct vmac_entry *lru_prev;
+    struct vmac_entry *lru_next;
+};
+
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist VMAC_List;
+/* hash index of the VMAC address */
+static struct vmac_entry *VMAC_Hash[VMAC_HASH_SIZE];
+/* most recently used entry is the head, eviction starts at the tail */
+static struct vmac_entry *VMAC_LRU_Head;
+static struct vmac_entry *VMAC_LRU_Tail;
+/* maximum number of entries, or zero for no limit */
+static unsigned int VMAC_Limit = VMAC_ENTRIES_MAX;
+static struct vmac_statistics VMAC_Stats;
+
+/**
+ * @brief Compute the hash bucket for a VMAC address using FNV-1a
+ * @param vmac - VMAC address
+ * @return hash bucket index
+ */
+static unsigned vmac_hash(const struct vmac_data *vmac)
+{
+    uint32_t hash = 2166136261UL;
+    unsigned int i = 0;
+
+    hash = (hash ^ vmac->mac_len) * 16777619UL;
+    for (i = 0; (i < vmac->mac_len) && (i < VMAC_MAC_MAX); i++) {
+        hash = (hash ^ vmac->mac[i]) * 16777619UL;
+    }
+
+    return (unsigned)(hash % VMAC_HASH_SIZE);
+}
+
+/**
+ * @brief Link an entry into the hash bucket of its VMAC address
+ * @param entry - VMAC entry
+ */
+static void vmac_hash_insert(struct vmac_entry *entry)
+{
+    unsigned bucket = vmac_hash(&entry->vmac);
+
+    entry->hash_next = VMAC_Hash[bucket];
+    VMAC_Hash[bucket] = entry;
+}
+
+/**
+ * @brief Unlink an entry from the hash bucket of its VMAC address
+ * @param entry - VMAC entry
+ */
+static void vmac_hash_remove(struct vmac_entry *entry)
+{
+    struct vmac_entry **pLink = &VMAC_Hash[vmac_hash(&entry->vmac)];
+
+    while (*pLink) {
+        if (*pLink == entry) {
+            *pLink = entry->hash_next;
+            entry->hash_next = NULL;
+            break;
+        }
+        pLink = &(*pLink)->hash_next;
+    }
+}
+
+/**
+ * @brief Unlink an entry from the least recently used list
+ * @param entry - VMAC entry
+ */
+static void vmac_lru_remove(struct vmac_entry *entry)
+{
+    if (entry->lru_prev) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    } else if (VMAC_LRU_Head == entry) {
+        VMAC_LRU_Head = entry->lru_next;
+    }
+    if (entry->lru_next) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else if (VMAC_LRU_Tail == entry) {
+        VMAC_LRU_Tail = entry->lru_prev;
+    }
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+}
+
+/**
+ * @brief Make an entry the most recently used
+ * @param entry - VMAC entry
+ */
+static void vmac_lru_touch(struct vmac_entry *entry)
+{
+    if (VMAC_LRU_Head != entry) {
+        vmac_lru_remove(entry);
+        entry->lru_next = VMAC_LRU_Head;
+        if (VMAC_LRU_Head) {
+            VMAC_LRU_Head->lru_prev = entry;
+        }
+        VMAC_LRU_Head = entry;
+        if (!VMAC_LRU_Tail) {
+            VMAC_LRU_Tail = entry;
+        }
+    }
+}
+
+/**
+ * @brief Remove an entry from the list and both indexes, and free it
+ * @param entry - VMAC entry
+ */
+static void vmac_entry_free(struct vmac_entry *entry)
+{
+    vmac_hash_remove(entry);
+    vmac_lru_remove(entry);
+    free(entry);
+}
+
+/**
+ * @brief Copy a VMAC address into an entry
+ * @param entry - VMAC entry
+ * @param src - VMAC address
+ */
+static void
+vmac_entry_copy(struct vmac_entry *entry, const struct vmac_data *src)
+{
+    size_t i = 0;
+
+    for (i = 0; i < sizeof(entry->vmac.mac); i++) {
+        if (i < src->mac_len) {
+            entry->vmac.mac[i] = src->mac[i];
+        } else {
+            entry->vmac.mac[i] = 0;
+        }
+    }
+    entry->vmac.mac_len = src->mac_len;
+}
+
+/**
+ * @brief Empty the hash index and the least recently used list
+ */
+static void vmac_index_clear(void)
+{
+    unsigned i = 0;
+
+    for (i = 0; i < VMAC_HASH_SIZE; i++) {
+        VMAC_Hash[i] = NULL;
+    }
+    VMAC_LRU_Head = NULL;
+    VMAC_LRU_Tail = NULL;
+}
+
+/**
+ * @brief Remove the least recently used entries until there is room
+ *  for one more entry
+ */
+static void vmac_evict(void)
+{
+    struct vmac_entry *entry;
+
+    if (VMAC_Limit == 0) {
+        return;
+    }
+    while (VMAC_LRU_Tail &&
+           ((unsigned int)Keylist_Count(VMAC_List) >= VMAC_Limit)) {
+        entry = VMAC_LRU_Tail;
+        Keylist_Data_Delete(VMAC_List, entry->device_id);
+        if (VMAC_Debug) {
+            debug_fprintf(
+                stderr, "VMAC %u evicted.\n", (unsigned int)entry->device_id);
+        }
+        vmac_entry_free(entry);
+        VMAC_Stats.evictions++;
+    }
+}
 
 /**
  * Returns the number of VMAC in the list
@@ -45,7 +224,8 @@ unsigned int VMAC_Count(void)
 }
 
 /**
- * Adds a VMAC to the list
+ * Adds a VMAC to the list. When the list is full, the least
+ * recently used VMAC is removed to make room.
  *
  * @param device_id - BACnet device object instance number
  * @param src - BACnet/IPv6 address
@@ -55,30 +235,28 @@ unsigned int VMAC_Count(void)
 bool VMAC_Add(uint32_t device_id, const struct vmac_data *src)
 {
     bool status = false;
-    struct vmac_data *pVMAC = NULL;
+    struct vmac_entry *entry = NULL;
     int index = 0;
-    size_t i = 0;
 
-    pVMAC = Keylist_Data(VMAC_List, device_id);
-    if (!pVMAC) {
-        pVMAC = calloc(1, sizeof(struct vmac_data));
-        if (pVMAC) {
+    entry = Keylist_Data(VMAC_List, device_id);
+    if (!entry) {
+        vmac_evict();
+        entry = calloc(1, sizeof(struct vmac_entry));
+        if (entry) {
             /* copy the MAC into the data store */
-            for (i = 0; i < sizeof(pVMAC->mac); i++) {
-                if (i < src->mac_len) {
-                    pVMAC->mac[i] = src->mac[i];
-                } else {
-                    break;
-                }
-            }
-            pVMAC->mac_len = src->mac_len;
-            index = Keylist_Data_Add(VMAC_List, device_id, pVMAC);
+            vmac_entry_copy(entry, src);
+            entry->device_id = device_id;
+            index = Keylist_Data_Add(VMAC_List, device_id, entry);
             if (index >= 0) {
+                vmac_hash_insert(entry);
+                vmac_lru_touch(entry);
                 status = true;
                 if (VMAC_Debug) {
                     debug_fprintf(
                         stderr, "VMAC %u added.\n", (unsigned int)device_id);
                 }
+            } else {
+                free(entry);
             }
         }
     }
@@ -86,21 +264,46 @@ bool VMAC_Add(uint32_t device_id, const struct vmac_data *src)
     return status;
 }
 
+/**
+ * Adds a VMAC to the list, or changes the VMAC of a Device ID
+ * that is already in the list.
+ *
+ * @param device_id - BACnet device object instance number
+ * @param src - BACnet/IPv6 address
+ *
+ * @return true if the device ID and MAC are in the list
+ */
+bool VMAC_Update(uint32_t device_id, const struct vmac_data *src)
+{
+    struct vmac_entry *entry;
+
+    entry = Keylist_Data(VMAC_List, device_id);
+    if (!entry) {
+        return VMAC_Add(device_id, src);
+    }
+    vmac_hash_remove(entry);
+    vmac_entry_copy(entry, src);
+    vmac_hash_insert(entry);
+    vmac_lru_touch(entry);
+
+    return true;
+}
+
 /**
  * Finds a VMAC in the list by seeking the Device ID, and deletes it.
  *
  * @param device_id - BACnet device object instance number
  *
- * @return pointer to the VMAC data from the list - be sure to free() it!
+ * @return true if the VMAC was found and deleted
  */
 bool VMAC_Delete(uint32_t device_id)
 {
     bool status = false;
-    struct vmac_data *pVMAC;
+    struct vmac_entry *entry;
 
-    pVMAC = Keylist_Data_Delete(VMAC_List, device_id);
-    if (pVMAC) {
-        free(pVMAC);
+    entry = Keylist_Data_Delete(VMAC_List, device_id);
+    if (entry) {
+        vmac_entry_free(entry);
         status = true;
     }
 
@@ -109,6 +312,8 @@ bool VMAC_Delete(uint32_t device_id)
 
 /**
  * Finds a VMAC in the list by seeking the Device ID.
+ * Use VMAC_Update() to change the VMAC, so that the
+ * address index stays consistent.
  *
  * @param device_id - BACnet device object instance number
  *
@@ -116,7 +321,64 @@ bool VMAC_Delete(uint32_t device_id)
  */
 struct vmac_data *VMAC_Find_By_Key(uint32_t device_id)
 {
-    return Keylist_Data(VMAC_List, device_id);
+    struct vmac_entry *entry;
+
+    entry = Keylist_Data(VMAC_List, device_id);
+    if (entry) {
+        vmac_lru_touch(entry);
+        return &entry->vmac;
+    }
+
+    return NULL;
+}
+
+/**
+ * Sets the maximum number of VMAC in the list. When the list is full,
+ * the least recently used VMAC is removed to make room for a new one.
+ *
+ * @param limit - maximum number of VMAC, or zero for no limit
+ */
+void VMAC_Entries_Max_Set(unsigned int limit)
+{
+    VMAC_Limit = limit;
+    if (VMAC_Limit) {
+        /* make room for one more, then put it back */
+        VMAC_Limit++;
+        vmac_evict();
+        VMAC_Limit--;
+    }
+}
+
+/**
+ * Returns the maximum number of VMAC in the list
+ *
+ * @return maximum number of VMAC, or zero for no limit
+ */
+unsigned int VMAC_Entries_Max(void)
+{
+    return VMAC_Limit;
+}
+
+/**
+ * Gets the VMAC lookup and eviction statistics
+ *
+ * @param stats - returns a copy of the statistics
+ */
+void VMAC_Statistics(struct vmac_statistics *stats)
+{
+    if (stats) {
+        *stats = VMAC_Stats;
+    }
+}
+
+/**
+ * Clears the VMAC lookup and eviction statistics
+ */
+void VMAC_Statistics_Clear(void)
+{
+    VMAC_Stats.hits = 0;
+    VMAC_Stats.misses = 0;
+    VMAC_Stats.evictions = 0;
 }
 
 /** Compare the VMAC address
@@ -193,25 +455,25 @@ bool VMAC_Match(const struct vmac_data *vmac1, const struct vmac_data *vmac2)
  */
 bool VMAC_Find_By_Data(const struct vmac_data *vmac, uint32_t *device_id)
 {
-    bool status = false;
-    struct vmac_data *list_vmac;
-    int count = 0;
-    int index = 0;
+    struct vmac_entry *entry;
 
-    count = Keylist_Count(VMAC_List);
-    while (count) {
-        index = count - 1;
-        list_vmac = Keylist_Data_Index(VMAC_List, index);
-        if (list_vmac) {
-            if (VMAC_Match(vmac, list_vmac)) {
-                status = Keylist_Index_Key(VMAC_List, index, device_id);
-                break;
+    if (vmac && vmac->mac_len) {
+        entry = VMAC_Hash[vmac_hash(vmac)];
+        while (entry) {
+            if (VMAC_Match(vmac, &entry->vmac)) {
+                if (device_id) {
+                    *device_id = entry->device_id;
+                }
+                vmac_lru_touch(entry);
+                VMAC_Stats.hits++;
+                return true;
             }
+            entry = entry->hash_next;
         }
-        count--;
     }
+    VMAC_Stats.misses++;
 
-    return status;
+    return false;
 }
 
 /**
@@ -246,6 +508,7 @@ void VMAC_Cleanup(void)
         Keylist_Delete(VMAC_List);
         VMAC_List = NULL;
     }
+    vmac_index_clear();
 }
 
 /**
@@ -253,6 +516,7 @@ void VMAC_Cleanup(void)
  */
 void VMAC_Init(void)
 {
+    vmac_index_clear();
     VMAC_List = Keylist_Create();
     if (VMAC_List) {
         atexit(VMAC_Cleanup);
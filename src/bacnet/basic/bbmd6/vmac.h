@@ -15,6 +15,15 @@
 
 /* define the max MAC as big as IPv6 + port number */
 #define VMAC_MAC_MAX 18
+/* number of buckets in the VMAC address hash index */
+#ifndef VMAC_HASH_SIZE
+#define VMAC_HASH_SIZE 256
+#endif
+/* maximum number of VMAC entries before the least recently used
+   entry is evicted, or zero for no limit */
+#ifndef VMAC_ENTRIES_MAX
+#define VMAC_ENTRIES_MAX 0
+#endif
 /**
  * VMAC data structure
  *
@@ -26,6 +35,21 @@ struct vmac_data {
 };
 /** @} */
 
+/**
+ * VMAC cache statistics
+ *
+ * @{
+ */
+struct vmac_statistics {
+    /* VMAC_Find_By_Data() lookups that found a device ID */
+    uint32_t hits;
+    /* VMAC_Find_By_Data() lookups that did not */
+    uint32_t misses;
+    /* least recently used entries removed to make room */
+    uint32_t evictions;
+};
+/** @} */
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -39,8 +63,18 @@ bool VMAC_Find_By_Data(const struct vmac_data *vmac, uint32_t *device_id);
 BACNET_STACK_EXPORT
 bool VMAC_Add(uint32_t device_id, const struct vmac_data *pVMAC);
 BACNET_STACK_EXPORT
+bool VMAC_Update(uint32_t device_id, const struct vmac_data *vmac);
+BACNET_STACK_EXPORT
 bool VMAC_Delete(uint32_t device_id);
 BACNET_STACK_EXPORT
+void VMAC_Entries_Max_Set(unsigned int limit);
+BACNET_STACK_EXPORT
+unsigned int VMAC_Entries_Max(void);
+BACNET_STACK_EXPORT
+void VMAC_Statistics(struct vmac_statistics *stats);
+BACNET_STACK_EXPORT
+void VMAC_Statistics_Clear(void);
+BACNET_STACK_EXPORT
 bool VMAC_Different(
     const struct vmac_data *vmac1, const struct vmac_data *vmac2);
 BACNET_STACK_EXPORT
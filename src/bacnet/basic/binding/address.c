@@ -41,12 +41,40 @@ static uint32_t Own_Device_ID = 0xFFFFFFFF;
 #define MAX_ADDRESS_CACHE 255
 #endif
 
+/* Optional hashed indexes on top of the address cache. When enabled, the
+   device-id and BACnet address lookups use hash chains and eviction uses
+   a least-recently-used list, so the cache can be sized to many thousands
+   of entries while keeping constant time lookups. The cache array and its
+   index based API are unchanged. */
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+/* number of buckets in each of the device-id and address hash tables */
+#if !defined(BACNET_ADDRESS_CACHE_HASH_SIZE)
+#define BACNET_ADDRESS_CACHE_HASH_SIZE MAX_ADDRESS_CACHE
+#endif
+/* entry indexes are stored as index+1 so that zero means none,
+   which makes the zero initialized tables valid before address_init() */
+#if (MAX_ADDRESS_CACHE < 0xFFFF)
+typedef uint16_t ADDRESS_CACHE_LINK;
+#else
+typedef uint32_t ADDRESS_CACHE_LINK;
+#endif
+#endif
+
 static struct Address_Cache_Entry {
     uint8_t Flags;
     uint32_t device_id;
     unsigned max_apdu;
     BACNET_ADDRESS address;
     uint32_t TimeToLive;
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+    /* next entry in the device-id hash chain */
+    ADDRESS_CACHE_LINK device_next;
+    /* next entry in the address hash chain */
+    ADDRESS_CACHE_LINK address_next;
+    /* least recently used list, or free list when unused */
+    ADDRESS_CACHE_LINK lru_prev;
+    ADDRESS_CACHE_LINK lru_next;
+#endif
 } Address_Cache[MAX_ADDRESS_CACHE];
 
 /* State flags for cache entries */
@@ -69,6 +97,427 @@ static struct Address_Cache_Entry {
 #define BAC_ADDR_SHORT_TIME BAC_ADDR_SECS_1HOUR
 #define BAC_ADDR_FOREVER 0xFFFFFFFF /* Permanent entry */
 
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+/* hash chain heads, holding entry index+1 or zero when empty */
+static ADDRESS_CACHE_LINK Device_Hash[BACNET_ADDRESS_CACHE_HASH_SIZE];
+static ADDRESS_CACHE_LINK Address_Hash[BACNET_ADDRESS_CACHE_HASH_SIZE];
+/* most recently used entry is the head, eviction starts at the tail */
+static ADDRESS_CACHE_LINK LRU_Head;
+static ADDRESS_CACHE_LINK LRU_Tail;
+/* released entries available for reuse */
+static ADDRESS_CACHE_LINK Free_Head;
+/* entries at or above this index have never been used since init */
+static uint32_t Unused_Index;
+
+/**
+ * @brief Convert an address cache entry to a link value
+ * @param pMatch - address cache entry
+ * @return link value (index+1) of the entry
+ */
+static ADDRESS_CACHE_LINK address_cache_link_value(
+    const struct Address_Cache_Entry *pMatch)
+{
+    return (ADDRESS_CACHE_LINK)((pMatch - Address_Cache) + 1);
+}
+
+/**
+ * @brief Convert a link value to an address cache entry
+ * @param link - link value (index+1), or zero
+ * @return address cache entry, or NULL if the link is zero
+ */
+static struct Address_Cache_Entry *address_cache_link_entry(
+    ADDRESS_CACHE_LINK link)
+{
+    if (link == 0) {
+        return NULL;
+    }
+
+    return &Address_Cache[link - 1];
+}
+
+/**
+ * @brief Compute the hash bucket for a device-id
+ * @param device_id - device instance number
+ * @return hash bucket index
+ */
+static unsigned address_cache_device_hash(uint32_t device_id)
+{
+    /* Knuth multiplicative hash spreads sequential instance numbers */
+    return (unsigned)((uint32_t)(device_id * 2654435761UL) %
+        BACNET_ADDRESS_CACHE_HASH_SIZE);
+}
+
+/**
+ * @brief Compute the hash bucket for a BACnet address using FNV-1a
+ *  over the same fields that bacnet_address_same() compares
+ * @param src - BACnet address
+ * @return hash bucket index
+ */
+static unsigned address_cache_address_hash(const BACNET_ADDRESS *src)
+{
+    uint32_t hash = 2166136261UL;
+    uint8_t i = 0;
+
+    hash = (hash ^ src->mac_len) * 16777619UL;
+    for (i = 0; (i < src->mac_len) && (i < MAX_MAC_LEN); i++) {
+        hash = (hash ^ src->mac[i]) * 16777619UL;
+    }
+    hash = (hash ^ (src->net & 0xFF)) * 16777619UL;
+    hash = (hash ^ (src->net >> 8)) * 16777619UL;
+    if (src->net != 0) {
+        hash = (hash ^ src->len) * 16777619UL;
+        for (i = 0; (i < src->len) && (i < MAX_MAC_LEN); i++) {
+            hash = (hash ^ src->adr[i]) * 16777619UL;
+        }
+    }
+
+    return (unsigned)(hash % BACNET_ADDRESS_CACHE_HASH_SIZE);
+}
+
+/**
+ * @brief Remove an entry from a singly linked hash chain
+ * @param head - pointer to the chain head
+ * @param pMatch - entry to remove
+ * @param device_chain - true for the device-id chain, false for address
+ */
+static void address_cache_chain_remove(
+    ADDRESS_CACHE_LINK *head,
+    struct Address_Cache_Entry *pMatch,
+    bool device_chain)
+{
+    ADDRESS_CACHE_LINK link = address_cache_link_value(pMatch);
+    ADDRESS_CACHE_LINK *pLink = head;
+    struct Address_Cache_Entry *pEntry;
+
+    while (*pLink != 0) {
+        pEntry = address_cache_link_entry(*pLink);
+        if (*pLink == link) {
+            if (device_chain) {
+                *pLink = pEntry->device_next;
+                pEntry->device_next = 0;
+            } else {
+                *pLink = pEntry->address_next;
+                pEntry->address_next = 0;
+            }
+            break;
+        }
+        if (device_chain) {
+            pLink = &pEntry->device_next;
+        } else {
+            pLink = &pEntry->address_next;
+        }
+    }
+}
+
+/**
+ * @brief Remove an entry from the least recently used list
+ * @param pMatch - entry to remove
+ */
+static void address_cache_lru_remove(struct Address_Cache_Entry *pMatch)
+{
+    struct Address_Cache_Entry *pEntry;
+
+    pEntry = address_cache_link_entry(pMatch->lru_prev);
+    if (pEntry) {
+        pEntry->lru_next = pMatch->lru_next;
+    } else {
+        LRU_Head = pMatch->lru_next;
+    }
+    pEntry = address_cache_link_entry(pMatch->lru_next);
+    if (pEntry) {
+        pEntry->lru_prev = pMatch->lru_prev;
+    } else {
+        LRU_Tail = pMatch->lru_prev;
+    }
+    pMatch->lru_prev = 0;
+    pMatch->lru_next = 0;
+}
+
+/**
+ * @brief Insert an entry at the most recently used end of the list
+ * @param pMatch - entry to insert
+ */
+static void address_cache_lru_insert(struct Address_Cache_Entry *pMatch)
+{
+    ADDRESS_CACHE_LINK link = address_cache_link_value(pMatch);
+    struct Address_Cache_Entry *pEntry;
+
+    pMatch->lru_prev = 0;
+    pMatch->lru_next = LRU_Head;
+    pEntry = address_cache_link_entry(LRU_Head);
+    if (pEntry) {
+        pEntry->lru_prev = link;
+    } else {
+        LRU_Tail = link;
+    }
+    LRU_Head = link;
+}
+
+/**
+ * @brief Mark an entry as the most recently used
+ * @param pMatch - entry that was used
+ */
+static void address_cache_touch(struct Address_Cache_Entry *pMatch)
+{
+    if (LRU_Head != address_cache_link_value(pMatch)) {
+        address_cache_lru_remove(pMatch);
+        address_cache_lru_insert(pMatch);
+    }
+}
+
+/**
+ * @brief Add an in-use entry to the hash indexes and the LRU list
+ * @param pMatch - entry with valid device-id and address
+ */
+static void address_cache_link(struct Address_Cache_Entry *pMatch)
+{
+    ADDRESS_CACHE_LINK link = address_cache_link_value(pMatch);
+    unsigned bucket;
+
+    bucket = address_cache_device_hash(pMatch->device_id);
+    pMatch->device_next = Device_Hash[bucket];
+    Device_Hash[bucket] = link;
+    bucket = address_cache_address_hash(&pMatch->address);
+    pMatch->address_next = Address_Hash[bucket];
+    Address_Hash[bucket] = link;
+    address_cache_lru_insert(pMatch);
+}
+
+/**
+ * @brief Remove an in-use entry from the hash indexes and the LRU list
+ * @param pMatch - entry to remove
+ */
+static void address_cache_unlink(struct Address_Cache_Entry *pMatch)
+{
+    address_cache_chain_remove(
+        &Device_Hash[address_cache_device_hash(pMatch->device_id)], pMatch,
+        true);
+    address_cache_chain_remove(
+        &Address_Hash[address_cache_address_hash(&pMatch->address)], pMatch,
+        false);
+    address_cache_lru_remove(pMatch);
+}
+
+/**
+ * @brief Rebuild the hash indexes, LRU list and free list from the
+ *  entry flags, for example after a partial init of persistent memory.
+ */
+static void address_cache_index_rebuild(void)
+{
+    struct Address_Cache_Entry *pMatch;
+    unsigned index;
+
+    for (index = 0; index < BACNET_ADDRESS_CACHE_HASH_SIZE; index++) {
+        Device_Hash[index] = 0;
+        Address_Hash[index] = 0;
+    }
+    LRU_Head = 0;
+    LRU_Tail = 0;
+    Free_Head = 0;
+    Unused_Index = MAX_ADDRESS_CACHE;
+    /* walk backwards so that the lowest free index is reused first */
+    for (index = MAX_ADDRESS_CACHE; index > 0; index--) {
+        pMatch = &Address_Cache[index - 1];
+        pMatch->device_next = 0;
+        pMatch->address_next = 0;
+        pMatch->lru_prev = 0;
+        pMatch->lru_next = 0;
+        if ((pMatch->Flags & BAC_ADDR_IN_USE) != 0) {
+            address_cache_link(pMatch);
+        } else {
+            pMatch->Flags = 0;
+            pMatch->lru_next = Free_Head;
+            Free_Head = address_cache_link_value(pMatch);
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Find the in-use cache entry for a device-id
+ * @param device_id - device instance number
+ * @return cache entry, bound or with bind request, or NULL if not found
+ */
+static struct Address_Cache_Entry *address_cache_device_find(
+    uint32_t device_id)
+{
+    struct Address_Cache_Entry *pMatch;
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+    pMatch = address_cache_link_entry(
+        Device_Hash[address_cache_device_hash(device_id)]);
+    while (pMatch) {
+        if (pMatch->device_id == device_id) {
+            return pMatch;
+        }
+        pMatch = address_cache_link_entry(pMatch->device_next);
+    }
+#else
+    unsigned index;
+
+    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+        pMatch = &Address_Cache[index];
+        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
+            (pMatch->device_id == device_id)) {
+            return pMatch;
+        }
+    }
+#endif
+
+    return NULL;
+}
+
+/**
+ * @brief Find the bound cache entry for a BACnet address
+ * @param src - BACnet address
+ * @return cache entry, or NULL if not found
+ */
+static struct Address_Cache_Entry *address_cache_address_find(
+    const BACNET_ADDRESS *src)
+{
+    struct Address_Cache_Entry *pMatch;
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+    if (!src) {
+        return NULL;
+    }
+    pMatch = address_cache_link_entry(
+        Address_Hash[address_cache_address_hash(src)]);
+    while (pMatch) {
+        if (((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) &&
+            bacnet_address_same(&pMatch->address, src)) {
+            return pMatch;
+        }
+        pMatch = address_cache_link_entry(pMatch->address_next);
+    }
+#else
+    unsigned index;
+
+    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+        pMatch = &Address_Cache[index];
+        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
+            BAC_ADDR_IN_USE) {
+            /* If bound */
+            if (bacnet_address_same(&pMatch->address, src)) {
+                return pMatch;
+            }
+        }
+    }
+#endif
+
+    return NULL;
+}
+
+/**
+ * @brief Find an unused cache entry
+ * @param flags_mask - entry flags that mark an entry as not available
+ * @return cache entry with no flags set, or NULL if none are free
+ */
+static struct Address_Cache_Entry *address_cache_free_find(uint8_t flags_mask)
+{
+    struct Address_Cache_Entry *pMatch;
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+    (void)flags_mask;
+    pMatch = address_cache_link_entry(Free_Head);
+    if (pMatch) {
+        Free_Head = pMatch->lru_next;
+        pMatch->lru_next = 0;
+    } else if (Unused_Index < MAX_ADDRESS_CACHE) {
+        pMatch = &Address_Cache[Unused_Index];
+        Unused_Index++;
+    }
+    if (pMatch) {
+        pMatch->Flags = 0;
+    }
+
+    return pMatch;
+#else
+    unsigned index;
+
+    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+        pMatch = &Address_Cache[index];
+        if ((pMatch->Flags & flags_mask) == 0) {
+            return pMatch;
+        }
+    }
+
+    return NULL;
+#endif
+}
+
+/**
+ * @brief Release a cache entry so that it can be reused
+ * @param pMatch - cache entry in use or reserved
+ */
+static void address_cache_release(struct Address_Cache_Entry *pMatch)
+{
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+    if ((pMatch->Flags & BAC_ADDR_IN_USE) != 0) {
+        address_cache_unlink(pMatch);
+    }
+    if (pMatch->Flags != 0) {
+        pMatch->lru_next = Free_Head;
+        Free_Head = address_cache_link_value(pMatch);
+    }
+#endif
+    pMatch->Flags = 0;
+}
+
+/**
+ * @brief Start using a new cache entry with the given values
+ * @param pMatch - cache entry from address_cache_free_find() or
+ *  address_remove_oldest()
+ * @param flags - entry flags, including BAC_ADDR_IN_USE
+ * @param device_id - device instance number
+ */
+static void address_cache_start(
+    struct Address_Cache_Entry *pMatch, uint8_t flags, uint32_t device_id)
+{
+    pMatch->Flags = flags;
+    pMatch->device_id = device_id;
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+    address_cache_link(pMatch);
+#endif
+}
+
+/**
+ * @brief Update the BACnet address of a cache entry, keeping the
+ *  address index consistent
+ * @param pMatch - cache entry
+ * @param src - new BACnet address
+ */
+static void address_cache_address_set(
+    struct Address_Cache_Entry *pMatch, const BACNET_ADDRESS *src)
+{
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+    unsigned bucket;
+
+    if ((pMatch->Flags & BAC_ADDR_IN_USE) != 0) {
+        address_cache_chain_remove(
+            &Address_Hash[address_cache_address_hash(&pMatch->address)],
+            pMatch, false);
+        bacnet_address_copy(&pMatch->address, src);
+        bucket = address_cache_address_hash(&pMatch->address);
+        pMatch->address_next = Address_Hash[bucket];
+        Address_Hash[bucket] = address_cache_link_value(pMatch);
+        address_cache_touch(pMatch);
+        return;
+    }
+#endif
+    bacnet_address_copy(&pMatch->address, src);
+}
+
+/**
+ * @brief Note the use of a cache entry for eviction ordering
+ * @param pMatch - cache entry
+ */
+static void address_cache_used(struct Address_Cache_Entry *pMatch)
+{
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+    address_cache_touch(pMatch);
+#else
+    (void)pMatch;
+#endif
+}
+
 /**
  * @brief Set the index of the first (top) address being protected.
  *
@@ -101,15 +550,12 @@ void address_remove_device(uint32_t device_id)
     struct Address_Cache_Entry *pMatch;
     uint32_t index = 0;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            pMatch->Flags = 0;
-            if (index < Top_Protected_Entry) {
-                Top_Protected_Entry--;
-            }
-            break;
+    pMatch = address_cache_device_find(device_id);
+    if (pMatch) {
+        index = (uint32_t)(pMatch - Address_Cache);
+        address_cache_release(pMatch);
+        if (index < Top_Protected_Entry) {
+            Top_Protected_Entry--;
         }
     }
 
@@ -117,25 +563,47 @@ void address_remove_device(uint32_t device_id)
 }
 
 /**
- * @brief Search the cache for the entry nearest expiry and delete it. Mark the
- * entry as reserved with a 1 hour TTL and return a pointer to the reserved
- * entry. Will not delete a static entry and returns NULL pointer if no
- * entry available to free up. Does not check for free entries as it is
- * assumed we are calling this due to the lack of those.
+ * @brief Choose an eviction candidate from the cache.
  *
- * @return Pointer to the entry that has been removed or NULL.
+ * The first pass only considers in use and bound entries that are not
+ * protected, and the second pass considers unbound entries as a last
+ * resort.  The linear cache picks the entry nearest expiry, while the
+ * hashed cache picks the least recently used entry.
+ *
+ * @return Pointer to the candidate entry or NULL.
  */
-static struct Address_Cache_Entry *address_remove_oldest(void)
+static struct Address_Cache_Entry *address_oldest_candidate(void)
 {
     struct Address_Cache_Entry *pMatch;
     struct Address_Cache_Entry *pCandidate;
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+    pCandidate = NULL;
+    /* First pass - try only in use and bound entries */
+    pMatch = address_cache_link_entry(LRU_Tail);
+    while (pMatch) {
+        if (((pMatch->Flags &
+              (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ | BAC_ADDR_STATIC)) ==
+             BAC_ADDR_IN_USE) &&
+            ((uint32_t)(pMatch - Address_Cache) >= Top_Protected_Entry)) {
+            return pMatch;
+        }
+        pMatch = address_cache_link_entry(pMatch->lru_prev);
+    }
+    /* Second pass - try in use and un bound as last resort */
+    pMatch = address_cache_link_entry(LRU_Tail);
+    while (pMatch) {
+        if ((pMatch->Flags &
+             (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ | BAC_ADDR_STATIC)) ==
+            ((uint8_t)(BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ))) {
+            return pMatch;
+        }
+        pMatch = address_cache_link_entry(pMatch->lru_prev);
+    }
+#else
     uint32_t ulTime;
     unsigned index;
 
     pCandidate = NULL;
-    if (Top_Protected_Entry > (MAX_ADDRESS_CACHE - 1)) {
-        return pCandidate;
-    }
     /* Longest possible non static time to live */
     ulTime = BAC_ADDR_FOREVER - 1;
 
@@ -155,10 +623,6 @@ static struct Address_Cache_Entry *address_remove_oldest(void)
     }
 
     if (pCandidate != NULL) {
-        /* Found something to free up */
-        pCandidate->Flags = BAC_ADDR_RESERVED;
-        /* only reserve it for a short while */
-        pCandidate->TimeToLive = BAC_ADDR_SHORT_TIME;
         return (pCandidate);
     }
 
@@ -174,9 +638,33 @@ static struct Address_Cache_Entry *address_remove_oldest(void)
             }
         }
     }
+#endif
+
+    return (pCandidate);
+}
 
+/**
+ * @brief Search the cache for the entry to evict and delete it. Mark the
+ * entry as reserved with a 1 hour TTL and return a pointer to the reserved
+ * entry. Will not delete a static entry and returns NULL pointer if no
+ * entry available to free up. Does not check for free entries as it is
+ * assumed we are calling this due to the lack of those.
+ *
+ * @return Pointer to the entry that has been removed or NULL.
+ */
+static struct Address_Cache_Entry *address_remove_oldest(void)
+{
+    struct Address_Cache_Entry *pCandidate;
+
+    if (Top_Protected_Entry > (MAX_ADDRESS_CACHE - 1)) {
+        return NULL;
+    }
+    pCandidate = address_oldest_candidate();
     if (pCandidate != NULL) {
         /* Found something to free up */
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+        address_cache_unlink(pCandidate);
+#endif
         pCandidate->Flags = BAC_ADDR_RESERVED;
         /* only reserve it for a short while */
         pCandidate->TimeToLive = BAC_ADDR_SHORT_TIME;
@@ -262,6 +750,9 @@ void address_init(void)
         pMatch = &Address_Cache[index];
         pMatch->Flags = 0;
     }
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+    address_cache_index_rebuild();
+#endif
 #ifdef BACNET_ADDRESS_CACHE_FILE
     address_file_init(Address_Cache_Filename);
 #endif
@@ -295,6 +786,10 @@ void address_init_partial(void)
             pMatch->Flags = 0;
         }
     }
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+    /* the indexes may have survived along with the cache, or not */
+    address_cache_index_rebuild();
+#endif
 #ifdef BACNET_ADDRESS_CACHE_FILE
     address_file_init(Address_Cache_Filename);
 #endif
@@ -316,26 +811,21 @@ void address_set_device_TTL(
     uint32_t device_id, uint32_t TimeOut, bool StaticFlag)
 {
     struct Address_Cache_Entry *pMatch;
-    unsigned index;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
-                /* If bound then we have either static or normaal */
-                if (StaticFlag) {
-                    pMatch->Flags |= BAC_ADDR_STATIC;
-                    pMatch->TimeToLive = BAC_ADDR_FOREVER;
-                } else {
-                    pMatch->Flags &= ~BAC_ADDR_STATIC;
-                    pMatch->TimeToLive = TimeOut;
-                }
+    pMatch = address_cache_device_find(device_id);
+    if (pMatch) {
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
+            /* If bound then we have either static or normaal */
+            if (StaticFlag) {
+                pMatch->Flags |= BAC_ADDR_STATIC;
+                pMatch->TimeToLive = BAC_ADDR_FOREVER;
             } else {
-                /* For unbound we can only set the time to live */
+                pMatch->Flags &= ~BAC_ADDR_STATIC;
                 pMatch->TimeToLive = TimeOut;
             }
-            break; /* Exit now if found at all - bound or unbound */
+        } else {
+            /* For unbound we can only set the time to live */
+            pMatch->TimeToLive = TimeOut;
         }
     }
 }
@@ -352,24 +842,17 @@ bool address_get_by_device(
 {
     struct Address_Cache_Entry *pMatch;
     bool found = false; /* return value */
-    unsigned index;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
-                /* If bound then fetch data */
-                bacnet_address_copy(src, &pMatch->address);
-                if (max_apdu) {
-                    *max_apdu = pMatch->max_apdu;
-                }
-                /* Prove we found it */
-                found = true;
-            }
-            /* Exit now if found at all - bound or unbound */
-            break;
+    pMatch = address_cache_device_find(device_id);
+    if (pMatch && ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0)) {
+        /* If bound then fetch data */
+        bacnet_address_copy(src, &pMatch->address);
+        if (max_apdu) {
+            *max_apdu = pMatch->max_apdu;
         }
+        address_cache_used(pMatch);
+        /* Prove we found it */
+        found = true;
     }
 
     return found;
@@ -387,21 +870,14 @@ bool address_get_device_id(const BACNET_ADDRESS *src, uint32_t *device_id)
 {
     struct Address_Cache_Entry *pMatch;
     bool found = false; /* return value */
-    unsigned index;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
-            BAC_ADDR_IN_USE) {
-            /* If bound */
-            if (bacnet_address_same(&pMatch->address, src)) {
-                if (device_id) {
-                    *device_id = pMatch->device_id;
-                }
-                found = true;
-                break;
-            }
+    pMatch = address_cache_address_find(src);
+    if (pMatch) {
+        if (device_id) {
+            *device_id = pMatch->device_id;
         }
+        address_cache_used(pMatch);
+        found = true;
     }
 
     return found;
@@ -417,9 +893,7 @@ bool address_get_device_id(const BACNET_ADDRESS *src, uint32_t *device_id)
 void address_add(
     uint32_t device_id, unsigned max_apdu, const BACNET_ADDRESS *src)
 {
-    bool found = false; /* return value */
     struct Address_Cache_Entry *pMatch;
-    unsigned index;
 
     if (Own_Device_ID == device_id) {
         return;
@@ -432,61 +906,42 @@ void address_add(
        bind request if it exists */
 
     /* existing device or bind request outstanding - update address */
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
+    pMatch = address_cache_device_find(device_id);
+    if (pMatch) {
         /* Device already in the list, then update the values. */
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            bacnet_address_copy(&pMatch->address, src);
-            pMatch->max_apdu = max_apdu;
-            /* Pick the right time to live */
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0) {
-                /* Bind requested so long time */
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-            } else if ((pMatch->Flags & BAC_ADDR_STATIC) != 0) {
-                /* Static already so make sure it never expires */
-                pMatch->TimeToLive = BAC_ADDR_FOREVER;
-            } else if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {
-                /* Opportunistic entry so leave on short fuse */
-                pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
-            } else {
-                /* Renewing existing entry */
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-            }
-            /* Clear bind request flag just in case */
-            pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
-            found = true;
-            break;
+        address_cache_address_set(pMatch, src);
+        pMatch->max_apdu = max_apdu;
+        /* Pick the right time to live */
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0) {
+            /* Bind requested so long time */
+            pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
+        } else if ((pMatch->Flags & BAC_ADDR_STATIC) != 0) {
+            /* Static already so make sure it never expires */
+            pMatch->TimeToLive = BAC_ADDR_FOREVER;
+        } else if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {
+            /* Opportunistic entry so leave on short fuse */
+            pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
+        } else {
+            /* Renewing existing entry */
+            pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
         }
+        /* Clear bind request flag just in case */
+        pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
+        return;
     }
     /* New device - add to cache if there is room. */
-    if (!found) {
-        for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-            pMatch = &Address_Cache[index];
-            if ((pMatch->Flags & BAC_ADDR_IN_USE) == 0) {
-                pMatch->Flags = BAC_ADDR_IN_USE;
-                pMatch->device_id = device_id;
-                pMatch->max_apdu = max_apdu;
-                bacnet_address_copy(&pMatch->address, src);
-                /* Opportunistic entry so leave on short fuse */
-                pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
-                found = true;
-                break;
-            }
-        }
-    }
-    /* If adding has failed, see if we can squeeze it in by removed the oldest
-     * entry. */
-    if (!found) {
+    pMatch = address_cache_free_find(BAC_ADDR_IN_USE);
+    if (pMatch == NULL) {
+        /* If adding has failed, see if we can squeeze it in by removed
+           the oldest entry. */
         pMatch = address_remove_oldest();
-        if (pMatch != NULL) {
-            pMatch->Flags = BAC_ADDR_IN_USE;
-            pMatch->device_id = device_id;
-            pMatch->max_apdu = max_apdu;
-            bacnet_address_copy(&pMatch->address, src);
-            /* Opportunistic entry so leave on short fuse */
-            pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
-        }
+    }
+    if (pMatch != NULL) {
+        pMatch->max_apdu = max_apdu;
+        bacnet_address_copy(&pMatch->address, src);
+        /* Opportunistic entry so leave on short fuse */
+        pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
+        address_cache_start(pMatch, BAC_ADDR_IN_USE, device_id);
     }
     return;
 }
@@ -512,61 +967,49 @@ bool address_device_bind_request(
 {
     bool found = false; /* return value */
     struct Address_Cache_Entry *pMatch;
-    unsigned index;
 
     /* existing device - update address info if currently bound */
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
-                /* Already bound */
-                found = true;
-                if (src) {
-                    bacnet_address_copy(src, &pMatch->address);
-                }
-                if (max_apdu) {
-                    *max_apdu = pMatch->max_apdu;
-                }
-                if (device_ttl) {
-                    *device_ttl = pMatch->TimeToLive;
-                }
-                if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {
-                    /* Was picked up opportunistacilly */
-                    /* Convert to normal entry  */
-                    pMatch->Flags &= ~BAC_ADDR_SHORT_TTL;
-                    /* And give it a decent time to live */
-                    pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-                }
+    pMatch = address_cache_device_find(device_id);
+    if (pMatch) {
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
+            /* Already bound */
+            found = true;
+            if (src) {
+                bacnet_address_copy(src, &pMatch->address);
             }
-            /* True if bound, false if bind request outstanding */
-            return (found);
+            if (max_apdu) {
+                *max_apdu = pMatch->max_apdu;
+            }
+            if (device_ttl) {
+                *device_ttl = pMatch->TimeToLive;
+            }
+            if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {
+                /* Was picked up opportunistacilly */
+                /* Convert to normal entry  */
+                pMatch->Flags &= ~BAC_ADDR_SHORT_TTL;
+                /* And give it a decent time to live */
+                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
+            }
+            address_cache_used(pMatch);
         }
+        /* True if bound, false if bind request outstanding */
+        return (found);
     }
 
     /* Not there already so look for a free entry to put it in */
-    /* existing device - update address info if currently bound */
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_RESERVED)) == 0) {
-            /* In use and awaiting binding */
-            pMatch->Flags = (uint8_t)(BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ);
-            pMatch->device_id = device_id;
-            /* No point in leaving bind requests in for long haul */
-            pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
-            /* now would be a good time to do a Who-Is request */
-            return (false);
-        }
+    pMatch = address_cache_free_find(BAC_ADDR_IN_USE | BAC_ADDR_RESERVED);
+    if (pMatch == NULL) {
+        /* No free entries, See if we can squeeze it in by dropping an
+           existing one */
+        pMatch = address_remove_oldest();
     }
-
-    /* No free entries, See if we can squeeze it in by dropping an existing one
-     */
-    pMatch = address_remove_oldest();
     if (pMatch != NULL) {
-        pMatch->Flags = (uint8_t)(BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ);
-        pMatch->device_id = device_id;
         /* No point in leaving bind requests in for long haul */
         pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
+        /* In use and awaiting binding */
+        address_cache_start(
+            pMatch, (uint8_t)(BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ), device_id);
+        /* now would be a good time to do a Who-Is request */
     }
     return (false);
 }
@@ -600,23 +1043,18 @@ void address_add_binding(
     uint32_t device_id, unsigned max_apdu, const BACNET_ADDRESS *src)
 {
     struct Address_Cache_Entry *pMatch;
-    unsigned index;
 
     /* existing device or bind request - update address */
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            bacnet_address_copy(&pMatch->address, src);
-            pMatch->max_apdu = max_apdu;
-            /* Clear bind request flag in case it was set */
-            pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
-            /* Only update TTL if not static */
-            if ((pMatch->Flags & BAC_ADDR_STATIC) == 0) {
-                /* and set it on a long fuse */
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-            }
-            break;
+    pMatch = address_cache_device_find(device_id);
+    if (pMatch) {
+        address_cache_address_set(pMatch, src);
+        pMatch->max_apdu = max_apdu;
+        /* Clear bind request flag in case it was set */
+        pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
+        /* Only update TTL if not static */
+        if ((pMatch->Flags & BAC_ADDR_STATIC) == 0) {
+            /* and set it on a long fuse */
+            pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
         }
     }
     return;
@@ -996,7 +1434,7 @@ void address_cache_timer(uint16_t uSeconds)
             if (pMatch->TimeToLive >= uSeconds) {
                 pMatch->TimeToLive -= uSeconds;
             } else {
-                pMatch->Flags = 0;
+                address_cache_release(pMatch);
             }
         }
     }
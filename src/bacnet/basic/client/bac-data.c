@@ -188,18 +188,53 @@ void bacnet_data_value_save(
     }
 }
 
+/**
+ * @brief Store the reply to the poll of one object, which is found
+ *  from the context of the request rather than by searching the table
+ * @param device_instance [in] device instance number where data originated
+ * @param rp_data [in] the object and property of the reply
+ * @param value [in] the reply value, or NULL for an error
+ * @param context [in] the BACnet object structure data pointer
+ */
+static void bacnet_data_object_reply(
+    uint32_t device_instance,
+    BACNET_READ_PROPERTY_DATA *rp_data,
+    BACNET_APPLICATION_DATA_VALUE *value,
+    void *context)
+{
+    const BACNET_DATA_OBJECT *object = context;
+
+    if (!rp_data || !value || !object ||
+        (rp_data->error_code != ERROR_CODE_SUCCESS)) {
+        return;
+    }
+    /* the object may have been replaced while the request was queued */
+    if ((object->Device_ID == device_instance) &&
+        (object->Object_Type == rp_data->object_type) &&
+        (object->Object_ID == rp_data->object_instance)) {
+        bacnet_data_object_store(
+            (int)(object - &Object_Table[0]), rp_data, value);
+    }
+}
+
 /**
  * @brief Handles the BACnet Data Analog Value processing
  * @param object - BACnet object structure data pointer
+ * @return false if the poll of the object did not fit in the queue
  */
-static void bacnet_data_object_process(const BACNET_DATA_OBJECT *object)
+static bool bacnet_data_object_process(BACNET_DATA_OBJECT *object)
 {
+    bool status = true;
+
     if (object && (object->Device_ID < BACNET_MAX_INSTANCE) &&
         (object->Object_ID < BACNET_MAX_INSTANCE)) {
-        bacnet_read_property_queue(
+        status = bacnet_read_property_request_queue(
             object->Device_ID, (BACNET_OBJECT_TYPE)object->Object_Type,
-            object->Object_ID, PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+            object->Object_ID, PROP_PRESENT_VALUE, BACNET_ARRAY_ALL,
+            bacnet_data_object_reply, object);
     }
+
+    return status;
 }
 
 /**
@@ -363,7 +398,9 @@ bool bacnet_data_multistate_present_value(
 }
 
 /**
- * @brief Handles the BACnet Data repetitive task
+ * @brief Handles the BACnet Data repetitive task. The objects to refresh
+ *  are queued while there is room in the queue, where polls of the same
+ *  device are put together, and many requests are outstanding at once.
  */
 void bacnet_data_task(void)
 {
@@ -382,11 +419,16 @@ void bacnet_data_task(void)
         mstimer_reset(&Read_Write_Timer);
         bacnet_read_write_task();
     }
-    if (bacnet_read_write_idle()) {
+    for (i = 0; i < BACNET_DATA_OBJECT_MAX; i++) {
+        if (bacnet_read_write_busy()) {
+            break;
+        }
         object = &Object_Table[object_index];
         if (object->refresh) {
+            if (!bacnet_data_object_process(object)) {
+                break;
+            }
             object->refresh = false;
-            bacnet_data_object_process(object);
         }
         object_index++;
         if (object_index >= BACNET_DATA_OBJECT_MAX) {
@@ -35,6 +35,41 @@ static OS_Keylist Device_List = NULL;
 static uint16_t Target_DNET = 0;
 /* re-discovery time */
 static unsigned long Discovery_Milliseconds;
+/* number of requests outstanding at once, across all devices */
+#ifndef BACNET_DISCOVER_TRANSACTIONS
+#define BACNET_DISCOVER_TRANSACTIONS 16
+#endif
+static unsigned Discover_Transactions = BACNET_DISCOVER_TRANSACTIONS;
+/* number of requests outstanding at once to one device */
+#ifndef BACNET_DISCOVER_DEVICE_TRANSACTIONS
+#define BACNET_DISCOVER_DEVICE_TRANSACTIONS 2
+#endif
+static unsigned Discover_Device_Transactions =
+    BACNET_DISCOVER_DEVICE_TRANSACTIONS;
+/* number of requests repeated for a device in each discovery */
+#ifndef BACNET_DISCOVER_RETRY_MAX
+#define BACNET_DISCOVER_RETRY_MAX 3
+#endif
+/* estimated octets of a ReadPropertyMultiple-ACK with ALL properties
+   of one object, used to choose how many objects are read at once */
+#ifndef BACNET_DISCOVER_OBJECT_OCTETS
+#define BACNET_DISCOVER_OBJECT_OCTETS 400
+#endif
+/* smallest APDU that every BACnet device accepts */
+#define BACNET_DISCOVER_APDU_MIN 50
+/* octets of a ReadPropertyMultiple-ACK before the results */
+#define BACNET_DISCOVER_RPM_ACK_OCTETS 10
+/* octets of a ReadPropertyMultiple-ACK result of an object-list element */
+#define BACNET_DISCOVER_OBJECT_LIST_ELEMENT_OCTETS 14
+/* device to start with in the next task, so all devices get a turn */
+static unsigned Device_Task_Index;
+/* discovery statistics */
+static unsigned long Statistics_Start;
+static unsigned long Statistics_Devices;
+static unsigned long Statistics_Objects;
+/* reply octets counted before the statistics were reset */
+static unsigned long Statistics_Bytes;
+static unsigned long Statistics_Requests;
 /* states of discovery */
 typedef enum bacnet_discover_state_enum {
     BACNET_DISCOVER_STATE_INIT = 0,
@@ -42,10 +77,7 @@ typedef enum bacnet_discover_state_enum {
     BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_REQUEST,
     BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_RESPONSE,
     BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST,
-    BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE,
     BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST,
-    BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE,
-    BACNET_DISCOVER_STATE_OBJECT_NEXT,
     BACNET_DISCOVER_STATE_DONE
 } BACNET_DISCOVER_STATE;
 
@@ -59,6 +91,8 @@ typedef struct bacnet_object_data_t {
     /* used for discovering object data */
     uint32_t Property_List_Size;
     uint32_t Property_List_Index;
+    /* object was read by itself after it did not fit with others */
+    bool Read_Alone;
 } BACNET_OBJECT_DATA;
 
 typedef struct bacnet_device_data_t {
@@ -66,6 +100,14 @@ typedef struct bacnet_device_data_t {
     /* used for discovering device data */
     uint32_t Object_List_Size;
     uint32_t Object_List_Index;
+    /* largest APDU the device accepts, from its I-Am */
+    unsigned Max_APDU;
+    /* number of objects read with each ReadPropertyMultiple */
+    unsigned Objects_Per_Request;
+    /* number of requests repeated in this discovery */
+    unsigned Retry_Count;
+    /* finished discovery at least once */
+    bool Discovered;
     /* timer and stats */
     struct mstimer Discovery_Timer;
     unsigned long Discovery_Elapsed_Milliseconds;
@@ -386,6 +428,38 @@ unsigned long bacnet_discover_device_elapsed_milliseconds(uint32_t device_id)
     return milliseconds;
 }
 
+/**
+ * @brief Find a property in the device cache
+ * @param device_id - ID of the destination device
+ * @param object_type - BACnet object type
+ * @param object_instance - Instance number of the object
+ * @param object_property - BACnet property identifier
+ * @return Pointer to the property data, or NULL if not found
+ */
+static BACNET_PROPERTY_DATA *bacnet_discover_property(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID object_property)
+{
+    BACNET_DEVICE_DATA *device;
+    BACNET_OBJECT_DATA *object;
+    KEY key = device_id;
+
+    device = Keylist_Data(Device_List, key);
+    if (!device) {
+        return NULL;
+    }
+    key = KEY_ENCODE(object_type, object_instance);
+    object = Keylist_Data(device->Object_List, key);
+    if (!object) {
+        return NULL;
+    }
+    key = object_property;
+
+    return Keylist_Data(object->Property_List, key);
+}
+
 /**
  * @brief Get a property value from the device cache
  * @param device_id - ID of the destination device
@@ -403,36 +477,25 @@ bool bacnet_discover_property_value(
     BACNET_APPLICATION_DATA_VALUE *value)
 {
     bool status = false;
-    BACNET_DEVICE_DATA *device;
-    BACNET_OBJECT_DATA *object;
     BACNET_PROPERTY_DATA *property;
-    KEY key = device_id;
     int len = 0;
 
     if (!value) {
         return false;
     }
-    device = Keylist_Data(Device_List, key);
-    if (device) {
-        key = KEY_ENCODE(object_type, object_instance);
-        object = Keylist_Data(device->Object_List, key);
-        if (object) {
-            key = object_property;
-            property = Keylist_Data(object->Property_List, key);
-            if (property) {
-                if (property->application_data_len > 0) {
-                    len = bacapp_decode_known_property(
-                        property->application_data,
-                        property->application_data_len, value, object_type,
-                        object_property);
-                    if (len > 0) {
-                        status = true;
-                    }
-                } else {
-                    bacapp_value_list_init(value, 1);
-                    status = true;
-                }
+    property = bacnet_discover_property(
+        device_id, object_type, object_instance, object_property);
+    if (property) {
+        if (property->application_data_len > 0) {
+            len = bacapp_decode_known_property(
+                property->application_data, property->application_data_len,
+                value, object_type, object_property);
+            if (len > 0) {
+                status = true;
             }
+        } else {
+            bacapp_value_list_init(value, 1);
+            status = true;
         }
     }
 
@@ -440,7 +503,8 @@ bool bacnet_discover_property_value(
 }
 
 /**
- * @brief Get a name property value from the device object property cache
+ * @brief Get a name property value from the device object property cache.
+ *  A name that does not fit in the buffer is truncated.
  * @param device_id - ID of the destination device
  * @param object_type - BACnet object type
  * @param object_instance - Instance number of the object to be read.
@@ -459,19 +523,30 @@ bool bacnet_discover_property_name(
     size_t buffer_len,
     const char *default_string)
 {
-    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+    BACNET_APPLICATION_DATA_COMPACT value = { 0 };
+    BACNET_PROPERTY_DATA *property = NULL;
     bool status = false;
+    int len;
 
     if (buffer && buffer_len) {
-        status = bacnet_discover_property_value(
-            device_id, object_type, object_instance, object_property, &value);
-        if (status && value.tag == BACNET_APPLICATION_TAG_CHARACTER_STRING) {
-            if (characterstring_valid(&value.type.Character_String)) {
-                snprintf(
-                    buffer, buffer_len, "%s",
-                    characterstring_value(&value.type.Character_String));
-            } else {
-                status = false;
+        property = bacnet_discover_property(
+            device_id, object_type, object_instance, object_property);
+        if (property && (property->application_data_len > 0)) {
+            /* the name is copied from the cache without decoding it
+               into a BACNET_APPLICATION_DATA_VALUE */
+            len = bacapp_decode_application_data_compact(
+                property->application_data,
+                (uint32_t)property->application_data_len, &value);
+            if ((len > 0) &&
+                (value.tag == BACNET_APPLICATION_TAG_CHARACTER_STRING) &&
+                (value.type.String.encoding <
+                 MAX_CHARACTER_STRING_ENCODING) &&
+                ((value.type.String.encoding != CHARACTER_UTF8) ||
+                 utf8_isvalid(
+                     (const char *)value.type.String.value,
+                     value.type.String.length))) {
+                status =
+                    bacapp_compact_character_string(&value, buffer, buffer_len);
             }
         }
     }
@@ -574,10 +649,10 @@ static void bacnet_device_object_property_add(
         (rp_data->object_instance == device_id) &&
         (rp_data->object_property == PROP_OBJECT_LIST)) {
         if (value->tag == BACNET_APPLICATION_TAG_UNSIGNED_INT) {
-            device_data->Object_List_Size = value->type.Unsigned_Int;
-            device_data->Object_List_Index = 0;
             if (device_data->Discovery_State ==
                 BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_REQUEST) {
+                device_data->Object_List_Size = value->type.Unsigned_Int;
+                device_data->Object_List_Index = 0;
                 device_data->Discovery_State =
                     BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_RESPONSE;
             }
@@ -587,25 +662,14 @@ static void bacnet_device_object_property_add(
                     device_data->Object_List, value->type.Object_Id.type,
                     value->type.Object_Id.instance);
                 debug_printf(
-                    "add %u object-list[%u] %s-%lu %s.\n", device_id,
-                    device_data->Object_List_Index,
+                    "add %u object-list[%lu] %s-%lu %s.\n", device_id,
+                    (unsigned long)rp_data->array_index,
                     bactext_object_type_name(value->type.Object_Id.type),
                     (unsigned long)value->type.Object_Id.instance,
                     object_data ? "success" : "fail");
-                if (device_data->Discovery_State ==
-                    BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST) {
-                    device_data->Discovery_State =
-                        BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
-                }
             }
         }
     } else {
-        /* move to next state */
-        if (device_data->Discovery_State ==
-            BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST) {
-            device_data->Discovery_State =
-                BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
-        }
         object_data = bacnet_object_data_add(
             device_data->Object_List, rp_data->object_type,
             rp_data->object_instance);
@@ -675,7 +739,117 @@ static void bacnet_device_object_property_add(
 }
 
 /**
- * @brief Handle the error from a ReadProperty or ReadPropertyMultiple
+ * @brief Determine the largest APDU to use with a device
+ * @param device_data - Pointer to the device data structure
+ * @return the largest APDU that both the device and we accept
+ */
+static unsigned bacnet_discover_device_max_apdu(
+    const BACNET_DEVICE_DATA *device_data)
+{
+    unsigned max_apdu = device_data->Max_APDU;
+
+    if ((max_apdu == 0) || (max_apdu > MAX_APDU)) {
+        max_apdu = MAX_APDU;
+    }
+    if (max_apdu < BACNET_DISCOVER_APDU_MIN) {
+        max_apdu = BACNET_DISCOVER_APDU_MIN;
+    }
+
+    return max_apdu;
+}
+
+/**
+ * @brief Determine the number of object-list elements that fit
+ *  in the ReadPropertyMultiple-ACK of a device
+ * @param device_data - Pointer to the device data structure
+ * @return number of object-list elements to read with one request
+ */
+static unsigned bacnet_discover_object_list_batch(
+    const BACNET_DEVICE_DATA *device_data)
+{
+    unsigned count;
+
+    count = (bacnet_discover_device_max_apdu(device_data) -
+             BACNET_DISCOVER_RPM_ACK_OCTETS) /
+        BACNET_DISCOVER_OBJECT_LIST_ELEMENT_OCTETS;
+    if (count < 1) {
+        count = 1;
+    } else if (count > BACNET_READ_WRITE_REFERENCE_MAX) {
+        count = BACNET_READ_WRITE_REFERENCE_MAX;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Determine the number of objects to read ALL properties of
+ *  with one ReadPropertyMultiple, from the largest APDU of a device
+ * @param device_data - Pointer to the device data structure
+ * @return number of objects to read with one request
+ */
+static unsigned bacnet_discover_object_batch(
+    const BACNET_DEVICE_DATA *device_data)
+{
+    unsigned count;
+
+    count = bacnet_discover_device_max_apdu(device_data) /
+        BACNET_DISCOVER_OBJECT_OCTETS;
+    if (count < 1) {
+        count = 1;
+    } else if (count > BACNET_READ_WRITE_REFERENCE_MAX) {
+        count = BACNET_READ_WRITE_REFERENCE_MAX;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Determine if another request can be sent to a device
+ * @param device_id - device instance number
+ * @return true if the device and overall request limits are not reached
+ */
+static bool bacnet_discover_request_ready(uint32_t device_id)
+{
+    if (bacnet_read_write_busy()) {
+        return false;
+    }
+    if (bacnet_read_write_pending() >= Discover_Transactions) {
+        return false;
+    }
+    if (bacnet_read_write_device_pending(device_id) >=
+        Discover_Device_Transactions) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Queue a ReadPropertyMultiple request for ALL properties
+ *  of one object, after the object was not read with other objects
+ * @param device_id - device instance number
+ * @param rp_data - ReadProperty data structure of the object
+ * @return true if the request was queued
+ */
+static bool bacnet_discover_object_read_alone(
+    uint32_t device_id, const BACNET_READ_PROPERTY_DATA *rp_data)
+{
+    bool status;
+
+    status = bacnet_read_property_queue(
+        device_id, rp_data->object_type, rp_data->object_instance, PROP_ALL,
+        BACNET_ARRAY_ALL);
+    if (status) {
+        Statistics_Requests++;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Handle the error from a ReadProperty or ReadPropertyMultiple.
+ *  Requests that timed out are repeated a few times, and objects
+ *  that did not fit in a reply are read by themselves.
  * @param device_id - device instance number where data originated
  * @param rp_data - ReadProperty data structure
  * @param device_data - Pointer to the device data structure
@@ -685,33 +859,60 @@ static void Device_Error_Handler(
     BACNET_READ_PROPERTY_DATA *rp_data,
     BACNET_DEVICE_DATA *device_data)
 {
+    BACNET_OBJECT_DATA *object_data;
     bool status = false;
+    KEY key;
 
-    if (device_data) {
-        debug_printf(
-            "%u - %s\n", device_id,
-            bactext_error_code_name((int)rp_data->error_code));
-        switch (device_data->Discovery_State) {
-            case BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST:
+    if (!device_data) {
+        return;
+    }
+    debug_printf(
+        "%u - %s\n", device_id,
+        bactext_error_code_name((int)rp_data->error_code));
+    switch (device_data->Discovery_State) {
+        case BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST:
+            /* resend request */
+            if ((rp_data->object_property == PROP_OBJECT_LIST) &&
+                (device_data->Retry_Count < BACNET_DISCOVER_RETRY_MAX)) {
+                status = bacnet_read_property_queue(
+                    device_id, OBJECT_DEVICE, device_id, PROP_OBJECT_LIST,
+                    rp_data->array_index);
+                if (status) {
+                    device_data->Retry_Count++;
+                    Statistics_Requests++;
+                }
+            }
+            break;
+        case BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST:
+            key = KEY_ENCODE(rp_data->object_type, rp_data->object_instance);
+            object_data = Keylist_Data(device_data->Object_List, key);
+            if ((rp_data->error_code == ERROR_CODE_TIMEOUT) ||
+                (rp_data->error_code == ERROR_CODE_ABORT_TSM_TIMEOUT)) {
                 /* resend request */
-                if (device_data->Object_List_Index != 0) {
-                    device_data->Object_List_Index--;
+                if (device_data->Retry_Count < BACNET_DISCOVER_RETRY_MAX) {
+                    if (bacnet_discover_object_read_alone(
+                            device_id, rp_data)) {
+                        device_data->Retry_Count++;
+                    }
                 }
-                device_data->Discovery_State =
-                    BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
-                break;
-            case BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST:
-                if (rp_data->error_code == ERROR_CODE_TIMEOUT) {
-                    /* resend request */
-                    if (device_data->Object_List_Index != 0) {
-                        device_data->Object_List_Index--;
+            } else if (
+                ((rp_data->error_code ==
+                  ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED) ||
+                 (rp_data->error_code == ERROR_CODE_ABORT_BUFFER_OVERFLOW) ||
+                 (rp_data->error_code == ERROR_CODE_ABORT_APDU_TOO_LONG)) &&
+                (rp_data->object_property == PROP_ALL)) {
+                if (object_data && !object_data->Read_Alone) {
+                    /* the reply did not fit - read fewer objects at once,
+                       and read this object by itself */
+                    device_data->Objects_Per_Request /= 2;
+                    if (device_data->Objects_Per_Request < 1) {
+                        device_data->Objects_Per_Request = 1;
                     }
-                    device_data->Discovery_State =
-                        BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
-                } else if (
-                    (rp_data->error_code ==
-                     ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED) &&
-                    (rp_data->object_property == PROP_ALL)) {
+                    object_data->Read_Alone = true;
+                    status = bacnet_discover_object_read_alone(
+                        device_id, rp_data);
+                }
+                if (!status) {
                     /* fallback to ReadProperty required properties */
                     /* FIXME: fill a property-list with properties
                        and use FSM to ReadProperty of each.
@@ -721,22 +922,13 @@ static void Device_Error_Handler(
                         rp_data->object_instance, PROP_OBJECT_NAME,
                         BACNET_ARRAY_ALL);
                     if (status) {
-                        device_data->Discovery_State =
-                            BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST;
-                    } else {
-                        /* skip */
-                        device_data->Discovery_State =
-                            BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
+                        Statistics_Requests++;
                     }
-                } else {
-                    /* skip */
-                    device_data->Discovery_State =
-                        BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
                 }
-                break;
-            default:
-                break;
-        }
+            }
+            break;
+        default:
+            break;
     }
 }
 
@@ -771,16 +963,151 @@ static void bacnet_read_property_reply(
 }
 
 /**
- * @brief Non-blocking task for running BACnet discover state machine
+ * @brief Queue requests for the next elements of the object-list
+ *  of a device, as many as fit in one reply
+ * @param device_id - Device ID from discovered device
+ * @param device_data - Pointer to the device data structure
+ * @return true if a request was queued
+ */
+static bool bacnet_discover_object_list_request(
+    uint32_t device_id, BACNET_DEVICE_DATA *device_data)
+{
+    BACNET_READ_WRITE_REFERENCE reference[BACNET_READ_WRITE_REFERENCE_MAX];
+    unsigned count, i;
+    bool status = false;
+
+    count = bacnet_discover_object_list_batch(device_data);
+    if (count >
+        (device_data->Object_List_Size - device_data->Object_List_Index)) {
+        count = device_data->Object_List_Size - device_data->Object_List_Index;
+    }
+    for (i = 0; i < count; i++) {
+        reference[i].object_type = OBJECT_DEVICE;
+        reference[i].object_instance = device_id;
+        reference[i].object_property = PROP_OBJECT_LIST;
+        /* object-list elements are numbered from 1 */
+        reference[i].array_index = device_data->Object_List_Index + 1 + i;
+    }
+    debug_printf(
+        "%u object-list[%u..%u] size=%u.\n", device_id,
+        device_data->Object_List_Index + 1,
+        device_data->Object_List_Index + count, device_data->Object_List_Size);
+    if (count == 1) {
+        status = bacnet_read_property_queue(
+            device_id, OBJECT_DEVICE, device_id, PROP_OBJECT_LIST,
+            reference[0].array_index);
+    } else {
+        status =
+            bacnet_read_property_multiple_queue(device_id, reference, count);
+    }
+    if (status) {
+        device_data->Object_List_Index += count;
+        Statistics_Requests++;
+    } else {
+        debug_fprintf(
+            stderr, "%u object-list[%u] fail to queue!\n", device_id,
+            device_data->Object_List_Index + 1);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Queue a request for ALL properties of the next objects
+ *  of a device, as many objects as are expected to fit in one reply
+ * @param device_id - Device ID from discovered device
+ * @param device_data - Pointer to the device data structure
+ * @param object_count - number of objects in the device
+ * @return true if a request was queued
+ */
+static bool bacnet_discover_object_request(
+    uint32_t device_id, BACNET_DEVICE_DATA *device_data, unsigned object_count)
+{
+    BACNET_READ_WRITE_REFERENCE reference[BACNET_READ_WRITE_REFERENCE_MAX];
+    BACNET_OBJECT_DATA *object_data;
+    unsigned count = 0;
+    bool status = false;
+    KEY key = 0;
+
+    while ((count < device_data->Objects_Per_Request) &&
+           ((device_data->Object_List_Index + count) < object_count)) {
+        if (!Keylist_Index_Key(
+                device_data->Object_List,
+                device_data->Object_List_Index + count, &key)) {
+            break;
+        }
+        object_data = Keylist_Data_Index(
+            device_data->Object_List, device_data->Object_List_Index + count);
+        if (object_data) {
+            object_data->Read_Alone = false;
+        }
+        reference[count].object_type = KEY_DECODE_TYPE(key);
+        reference[count].object_instance = KEY_DECODE_ID(key);
+        reference[count].object_property = PROP_ALL;
+        reference[count].array_index = BACNET_ARRAY_ALL;
+        debug_printf(
+            "%u object-list[%u] %s-%u read ALL.\n", device_id,
+            device_data->Object_List_Index + count,
+            bactext_object_type_name(reference[count].object_type),
+            (unsigned)reference[count].object_instance);
+        count++;
+    }
+    if (count == 0) {
+        /* the object is gone - skip it */
+        device_data->Object_List_Index++;
+        return false;
+    }
+    if (count == 1) {
+        status = bacnet_read_property_queue(
+            device_id, reference[0].object_type, reference[0].object_instance,
+            PROP_ALL, BACNET_ARRAY_ALL);
+    } else {
+        status =
+            bacnet_read_property_multiple_queue(device_id, reference, count);
+    }
+    if (status) {
+        device_data->Object_List_Index += count;
+        Statistics_Requests++;
+    } else {
+        debug_fprintf(
+            stderr, "%u object-list[%u] fail to queue!\n", device_id,
+            device_data->Object_List_Index);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Finish the discovery of a device, and schedule the next one
+ * @param device_data - Pointer to the device data structure
+ */
+static void bacnet_discover_device_done(BACNET_DEVICE_DATA *device_data)
+{
+    /* track the duration */
+    device_data->Discovery_Elapsed_Milliseconds =
+        mstimer_elapsed(&device_data->Discovery_Timer);
+    if (!device_data->Discovered) {
+        device_data->Discovered = true;
+        Statistics_Devices++;
+    }
+    Statistics_Objects += Keylist_Count(device_data->Object_List);
+    /* rediscover in the future */
+    mstimer_set(&device_data->Discovery_Timer, Discovery_Milliseconds);
+    device_data->Discovery_State = BACNET_DISCOVER_STATE_DONE;
+}
+
+/**
+ * @brief Non-blocking task for running BACnet discover state machine.
+ *  Requests for the object-list and the objects of the device are queued
+ *  while the device and overall request limits allow, so that several
+ *  requests to each of several devices are outstanding at once.
  * @param device_id - Device ID from discovered device
  * @param device_data - Pointer to the device data structure
  */
 static void
 bacnet_discover_device_fsm(uint32_t device_id, BACNET_DEVICE_DATA *device_data)
 {
-    KEY key = 0;
-    BACNET_OBJECT_TYPE object_type = 0;
-    uint32_t object_instance = 0;
+    unsigned object_count = 0;
     bool status = false;
 
     if (!device_data) {
@@ -788,9 +1115,13 @@ bacnet_discover_device_fsm(uint32_t device_id, BACNET_DEVICE_DATA *device_data)
     }
     switch (device_data->Discovery_State) {
         case BACNET_DISCOVER_STATE_INIT:
+            if (!bacnet_discover_request_ready(device_id)) {
+                break;
+            }
             status = bacnet_read_property_queue(
                 device_id, OBJECT_DEVICE, device_id, PROP_OBJECT_LIST, 0);
             if (status) {
+                Statistics_Requests++;
                 device_data->Discovery_State =
                     BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_REQUEST;
             } else {
@@ -800,89 +1131,58 @@ bacnet_discover_device_fsm(uint32_t device_id, BACNET_DEVICE_DATA *device_data)
             break;
         case BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_REQUEST:
             /* waiting for response */
-            return;
+            if (bacnet_read_write_device_pending(device_id) == 0) {
+                /* no object-list size in the reply */
+                if (device_data->Retry_Count < BACNET_DISCOVER_RETRY_MAX) {
+                    device_data->Retry_Count++;
+                    device_data->Discovery_State = BACNET_DISCOVER_STATE_INIT;
+                } else {
+                    bacnet_discover_device_done(device_data);
+                }
+            }
+            break;
         case BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_RESPONSE:
             device_data->Object_List_Index = 0;
             device_data->Discovery_State =
-                BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
+                BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST;
             break;
         case BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST:
-            /* waiting for response */
-            break;
-        case BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE:
-            device_data->Object_List_Index++;
-            if (device_data->Object_List_Index <=
-                device_data->Object_List_Size) {
-                debug_printf(
-                    "%u object-list[%u] size=%u.\n", device_id,
-                    device_data->Object_List_Index,
-                    device_data->Object_List_Size);
-                status = bacnet_read_property_queue(
-                    device_id, OBJECT_DEVICE, device_id, PROP_OBJECT_LIST,
-                    device_data->Object_List_Index);
-                if (status) {
-                    device_data->Discovery_State =
-                        BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST;
-                    return;
-                } else {
-                    debug_fprintf(
-                        stderr, "%u object-list[%u] %s-%u fail to queue!\n",
-                        device_id, device_data->Object_List_Index,
-                        bactext_object_type_name(object_type),
-                        (unsigned)object_instance);
-                    device_data->Object_List_Index--;
+            while ((device_data->Object_List_Index <
+                    device_data->Object_List_Size) &&
+                   bacnet_discover_request_ready(device_id)) {
+                if (!bacnet_discover_object_list_request(
+                        device_id, device_data)) {
+                    break;
                 }
-            } else {
+            }
+            if ((device_data->Object_List_Index >=
+                 device_data->Object_List_Size) &&
+                (bacnet_read_write_device_pending(device_id) == 0)) {
+                /* all of the object-list replies are in */
                 device_data->Object_List_Index = 0;
                 device_data->Discovery_State =
-                    BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
+                    BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST;
             }
             break;
         case BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST:
-            /* waiting for response */
-            break;
-        case BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE:
-            if (device_data->Object_List_Index <
-                device_data->Object_List_Size) {
-                if (Keylist_Index_Key(
-                        device_data->Object_List,
-                        device_data->Object_List_Index, &key)) {
-                    object_type = KEY_DECODE_TYPE(key);
-                    object_instance = KEY_DECODE_ID(key);
-                    debug_printf(
-                        "%u object-list[%u] %s-%u read ALL.\n", device_id,
-                        device_data->Object_List_Index,
-                        bactext_object_type_name(object_type),
-                        (unsigned)object_instance);
-                    status = bacnet_read_property_queue(
-                        device_id, object_type, object_instance, PROP_ALL,
-                        BACNET_ARRAY_ALL);
-                }
-                if (status) {
-                    device_data->Discovery_State =
-                        BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST;
-                    device_data->Object_List_Index++;
-                } else {
-                    debug_fprintf(
-                        stderr, "%u object-list[%u] %s-%u fail to queue!\n",
-                        device_id, device_data->Object_List_Index,
-                        bactext_object_type_name(object_type),
-                        (unsigned)object_instance);
+            object_count = Keylist_Count(device_data->Object_List);
+            while ((device_data->Object_List_Index < object_count) &&
+                   bacnet_discover_request_ready(device_id)) {
+                if (!bacnet_discover_object_request(
+                        device_id, device_data, object_count)) {
+                    break;
                 }
-            } else {
-                /* track the duration */
-                device_data->Discovery_Elapsed_Milliseconds =
-                    mstimer_elapsed(&device_data->Discovery_Timer);
-                /* rediscover in the future */
-                mstimer_set(
-                    &device_data->Discovery_Timer, Discovery_Milliseconds);
-                device_data->Discovery_State = BACNET_DISCOVER_STATE_DONE;
+            }
+            if ((device_data->Object_List_Index >= object_count) &&
+                (bacnet_read_write_device_pending(device_id) == 0)) {
+                bacnet_discover_device_done(device_data);
             }
             break;
         case BACNET_DISCOVER_STATE_DONE:
             /* finished getting all the object properties */
             if (mstimer_expired(&device_data->Discovery_Timer)) {
                 mstimer_set(&device_data->Discovery_Timer, 0);
+                device_data->Retry_Count = 0;
                 device_data->Discovery_State = BACNET_DISCOVER_STATE_INIT;
             }
             break;
@@ -895,21 +1195,25 @@ bacnet_discover_device_fsm(uint32_t device_id, BACNET_DEVICE_DATA *device_data)
 }
 
 /**
- * @brief Adds a device to the device list
- * @param device_id - Device ID from discovered device
- * @param src - BACnet address from discovered device
- * @return non-zero device index for device if added or existing
+ * @brief Run the discover state machine of each device, starting with
+ *  a different device each time so that every device gets a turn at
+ *  the overall request limit
  */
 static void bacnet_discover_devices_task(void)
 {
     unsigned int device_index = 0;
     unsigned int device_count = 0;
+    unsigned int i = 0;
     uint32_t device_id = 0;
     BACNET_DEVICE_DATA *device_data;
     KEY key;
 
     device_count = Keylist_Count(Device_List);
-    for (device_index = 0; device_index < device_count; device_index++) {
+    if (device_count == 0) {
+        return;
+    }
+    for (i = 0; i < device_count; i++) {
+        device_index = (Device_Task_Index + i) % device_count;
         device_data = Keylist_Data_Index(Device_List, device_index);
         if (!device_data) {
             debug_fprintf(stderr, "device[%u] is NULL!\n", device_index);
@@ -920,6 +1224,7 @@ static void bacnet_discover_devices_task(void)
             bacnet_discover_device_fsm(device_id, device_data);
         }
     }
+    Device_Task_Index = (Device_Task_Index + 1) % device_count;
 }
 
 /**
@@ -1088,8 +1393,6 @@ void bacnet_discover_task(void)
     if (mstimer_expired(&Read_Write_Timer)) {
         mstimer_restart(&Read_Write_Timer);
         bacnet_read_write_task();
-    }
-    if (bacnet_read_write_idle()) {
         bacnet_discover_devices_task();
     }
 }
@@ -1168,6 +1471,90 @@ unsigned long bacnet_discover_read_process_milliseconds(void)
     return mstimer_interval(&Read_Write_Timer);
 }
 
+/**
+ * @brief Set the number of requests that are outstanding at once,
+ *  across all devices
+ * @param count - 1..BACNET_READ_WRITE_TRANSACTIONS_MAX
+ */
+void bacnet_discover_transactions_set(unsigned count)
+{
+    bacnet_read_write_transactions_set(count);
+    Discover_Transactions = bacnet_read_write_transactions();
+}
+
+/**
+ * @brief Get the number of requests that are outstanding at once,
+ *  across all devices
+ * @return number of requests that are outstanding at once
+ */
+unsigned bacnet_discover_transactions(void)
+{
+    return Discover_Transactions;
+}
+
+/**
+ * @brief Set the number of requests that are outstanding at once
+ *  to each device
+ * @param count - number of requests, at least 1
+ */
+void bacnet_discover_device_transactions_set(unsigned count)
+{
+    if (count < 1) {
+        count = 1;
+    }
+    Discover_Device_Transactions = count;
+}
+
+/**
+ * @brief Get the number of requests that are outstanding at once
+ *  to each device
+ * @return number of requests that are outstanding at once to each device
+ */
+unsigned bacnet_discover_device_transactions(void)
+{
+    return Discover_Device_Transactions;
+}
+
+/**
+ * @brief Get the discovery statistics since they were reset
+ * @param stats [out] the discovery statistics
+ */
+void bacnet_discover_statistics(BACNET_DISCOVER_STATISTICS *stats)
+{
+    unsigned long milliseconds;
+
+    if (!stats) {
+        return;
+    }
+    milliseconds = mstimer_now() - Statistics_Start;
+    stats->elapsed_milliseconds = milliseconds;
+    stats->devices = Statistics_Devices;
+    stats->objects = Statistics_Objects;
+    stats->requests = Statistics_Requests;
+    stats->bytes = bacnet_read_write_reply_octets() - Statistics_Bytes;
+    if (milliseconds > 0) {
+        stats->objects_per_second =
+            (unsigned long)(((uint64_t)stats->objects * 1000UL) / milliseconds);
+        stats->bytes_per_second =
+            (unsigned long)(((uint64_t)stats->bytes * 1000UL) / milliseconds);
+    } else {
+        stats->objects_per_second = 0;
+        stats->bytes_per_second = 0;
+    }
+}
+
+/**
+ * @brief Reset the discovery statistics
+ */
+void bacnet_discover_statistics_reset(void)
+{
+    Statistics_Start = mstimer_now();
+    Statistics_Devices = 0;
+    Statistics_Objects = 0;
+    Statistics_Requests = 0;
+    Statistics_Bytes = bacnet_read_write_reply_octets();
+}
+
 /**
  * Save the I-Am service data to a data store
  *
@@ -1184,9 +1571,13 @@ void bacnet_discover_device_add(
 {
     BACNET_DEVICE_DATA *device_data;
 
-    (void)max_apdu;
     (void)segmentation;
     device_data = bacnet_device_data_add(device_instance);
+    if (device_data) {
+        device_data->Max_APDU = max_apdu;
+        device_data->Objects_Per_Request =
+            bacnet_discover_object_batch(device_data);
+    }
     debug_printf(
         "device[%d] %lu - vendor=%u %s.\n",
         Keylist_Index(Device_List, device_instance), device_instance, vendor_id,
@@ -1210,6 +1601,8 @@ void bacnet_discover_init(void)
     if (!mstimer_interval(&Read_Write_Timer)) {
         mstimer_set(&Read_Write_Timer, 10);
     }
+    bacnet_read_write_transactions_set(Discover_Transactions);
     bacnet_read_write_value_callback_set(bacnet_read_property_reply);
     bacnet_read_write_device_callback_set(bacnet_discover_device_add);
+    bacnet_discover_statistics_reset();
 }
@@ -36,6 +36,24 @@ typedef bool (*bacnet_discover_device_callback)(
     BACNET_READ_PROPERTY_DATA *rp_data,
     void *context_data);
 
+/**
+ * @brief Statistics of the device discovery
+ */
+typedef struct bacnet_discover_statistics_t {
+    /* time since the statistics were reset */
+    unsigned long elapsed_milliseconds;
+    /* devices that finished discovery at least once */
+    unsigned long devices;
+    /* objects in the devices each time they finished discovery */
+    unsigned long objects;
+    /* ReadProperty and ReadPropertyMultiple requests queued */
+    unsigned long requests;
+    /* octets of the ReadProperty and ReadPropertyMultiple replies */
+    unsigned long bytes;
+    unsigned long objects_per_second;
+    unsigned long bytes_per_second;
+} BACNET_DISCOVER_STATISTICS;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -93,6 +111,12 @@ void bacnet_discover_seconds_set(unsigned int seconds);
 unsigned int bacnet_discover_seconds(void);
 void bacnet_discover_read_process_milliseconds_set(unsigned long milliseconds);
 unsigned long bacnet_discover_read_process_milliseconds(void);
+void bacnet_discover_transactions_set(unsigned count);
+unsigned bacnet_discover_transactions(void);
+void bacnet_discover_device_transactions_set(unsigned count);
+unsigned bacnet_discover_device_transactions(void);
+void bacnet_discover_statistics(BACNET_DISCOVER_STATISTICS *stats);
+void bacnet_discover_statistics_reset(void);
 void bacnet_discover_device_add(
     uint32_t device_instance,
     unsigned max_apdu,
@@ -27,8 +27,6 @@
 /* timer for address cache */
 static struct mstimer Cache_Timer;
 #define CACHE_CYCLE_SECONDS 60
-/* timeout timer for read-write task */
-static struct mstimer Read_Write_Timer;
 /* where the data from the read is stored */
 static bacnet_read_write_value_callback_t bacnet_read_write_value_callback;
 /* where the data from the I-Am is called */
@@ -62,25 +60,109 @@ typedef struct target_data_t {
         uint32_t Unsigned_Int;
         int32_t Signed_Int;
     } type;
+    /* later reads of the same device may be added to this request */
+    bool coalesce;
+    /* properties read with one ReadPropertyMultiple, or zero */
+    uint8_t reference_count;
+    BACNET_READ_WRITE_REFERENCE reference[BACNET_READ_WRITE_REFERENCE_MAX];
+    /* where the reply of each property goes, or NULL for the value
+       callback - the first is used when there is no property list */
+    bacnet_read_write_request_callback_t
+        callback[BACNET_READ_WRITE_REFERENCE_MAX];
+    void *context[BACNET_READ_WRITE_REFERENCE_MAX];
 } TARGET_DATA;
 #define TARGET_DATA_QUEUE_SIZE (sizeof(struct target_data_t))
 /* count must be a power of 2 for ringbuf library */
 #ifndef TARGET_DATA_QUEUE_COUNT
-#define TARGET_DATA_QUEUE_COUNT 8
+#define TARGET_DATA_QUEUE_COUNT 16
 #endif
 static TARGET_DATA Target_Data_Buffer[TARGET_DATA_QUEUE_COUNT];
 static RING_BUFFER Target_Data_Queue;
+/* a request taken from the queue, until it is finished */
+typedef struct read_write_transaction_t {
+    bool used;
+    TARGET_DATA target;
+    BACNET_CLIENT_STATE state;
+    /* timeout timer for binding and sending */
+    struct mstimer timer;
+    /* the invoke id and address are needed to filter incoming messages */
+    uint8_t invoke_id;
+    BACNET_ADDRESS address;
+    bool error_detected;
+    BACNET_ERROR_CLASS error_class;
+    BACNET_ERROR_CODE error_code;
+} READ_WRITE_TRANSACTION;
+static READ_WRITE_TRANSACTION Transaction[BACNET_READ_WRITE_TRANSACTIONS_MAX];
+/* number of requests that are outstanding at once */
+static unsigned Transaction_Limit = BACNET_READ_WRITE_TRANSACTIONS_MAX;
+/* the request that the reply being processed belongs to */
+static READ_WRITE_TRANSACTION *Reply_Transaction;
+/* the property of the request that the last reply value belonged to */
+static unsigned Reply_Reference_Index;
+/* octets of a ReadPropertyMultiple-ACK before the results */
+#define READ_WRITE_RPM_ACK_OCTETS 10
+/* estimated octets of each result in a ReadPropertyMultiple-ACK of
+   polled values, with the object identifier of the result */
+#define READ_WRITE_RPM_RESULT_OCTETS 24
 /* local storage - keeps it off the c-stack */
 static BACNET_APPLICATION_DATA_VALUE Target_Decoded_Property_Value;
-/* the invoke id is needed to filter incoming messages */
-static uint8_t Request_Invoke_ID;
-static BACNET_ADDRESS Target_Address;
-static uint32_t Target_Device_ID;
+static BACNET_READ_ACCESS_DATA Target_Read_Access[
+    BACNET_READ_WRITE_REFERENCE_MAX];
+static BACNET_PROPERTY_REFERENCE Target_Property_Reference[
+    BACNET_READ_WRITE_REFERENCE_MAX];
 static uint16_t Target_Vendor_ID;
-static bool Error_Detected = false;
-static BACNET_ERROR_CLASS Error_Class;
-static BACNET_ERROR_CODE Error_Code;
-static BACNET_CLIENT_STATE RW_State = BACNET_CLIENT_IDLE;
+/* memory for the decoded results of a ReadPropertyMultiple-ACK */
+static uint8_t Reply_Arena_Buffer[BACNET_READ_WRITE_ARENA_SIZE];
+/* octets of the replies to our requests */
+static unsigned long Reply_Octets;
+
+/**
+ * @brief Find the outstanding request that a reply belongs to
+ * @param src [in] BACNET_ADDRESS of the source of the reply
+ * @param invoke_id [in] the invokeID from the reply
+ * @return the request, or NULL if the reply is not for us
+ */
+static READ_WRITE_TRANSACTION *
+bacnet_read_write_transaction_find(BACNET_ADDRESS *src, uint8_t invoke_id)
+{
+    READ_WRITE_TRANSACTION *transaction;
+    unsigned i;
+
+    for (i = 0; i < BACNET_READ_WRITE_TRANSACTIONS_MAX; i++) {
+        transaction = &Transaction[i];
+        if (transaction->used &&
+            (transaction->state == BACNET_CLIENT_WAITING) &&
+            (transaction->invoke_id == invoke_id) &&
+            address_match(&transaction->address, src)) {
+            return transaction;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Record the error of an outstanding request
+ * @param src [in] BACNET_ADDRESS of the source of the reply
+ * @param invoke_id [in] the invokeID from the reply
+ * @param error_class [in] the error class
+ * @param error_code [in] the error code
+ */
+static void bacnet_read_write_transaction_error(
+    BACNET_ADDRESS *src,
+    uint8_t invoke_id,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code)
+{
+    READ_WRITE_TRANSACTION *transaction;
+
+    transaction = bacnet_read_write_transaction_find(src, invoke_id);
+    if (transaction) {
+        transaction->error_detected = true;
+        transaction->error_class = error_class;
+        transaction->error_code = error_code;
+    }
+}
 
 /**
  * @brief Handler for an Error PDU.
@@ -95,12 +177,8 @@ static void MyErrorHandler(
     BACNET_ERROR_CLASS error_class,
     BACNET_ERROR_CODE error_code)
 {
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Request_Invoke_ID)) {
-        Error_Detected = true;
-        Error_Class = error_class;
-        Error_Code = error_code;
-    }
+    bacnet_read_write_transaction_error(
+        src, invoke_id, error_class, error_code);
 }
 
 /**
@@ -114,12 +192,9 @@ static void MyAbortHandler(
     BACNET_ADDRESS *src, uint8_t invoke_id, uint8_t abort_reason, bool server)
 {
     (void)server;
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Request_Invoke_ID)) {
-        Error_Detected = true;
-        Error_Class = ERROR_CLASS_SERVICES;
-        Error_Code = abort_convert_to_error_code(abort_reason);
-    }
+    bacnet_read_write_transaction_error(
+        src, invoke_id, ERROR_CLASS_SERVICES,
+        abort_convert_to_error_code(abort_reason));
 }
 
 /**
@@ -131,12 +206,9 @@ static void MyAbortHandler(
 static void
 MyRejectHandler(BACNET_ADDRESS *src, uint8_t invoke_id, uint8_t reject_reason)
 {
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Request_Invoke_ID)) {
-        Error_Detected = true;
-        Error_Class = ERROR_CLASS_SERVICES;
-        Error_Code = reject_convert_to_error_code(reject_reason);
-    }
+    bacnet_read_write_transaction_error(
+        src, invoke_id, ERROR_CLASS_SERVICES,
+        reject_convert_to_error_code(reject_reason));
 }
 
 /**
@@ -191,9 +263,80 @@ static void My_I_Am_Bind(
 static void
 MyWritePropertySimpleAckHandler(BACNET_ADDRESS *src, uint8_t invoke_id)
 {
-    if (address_match(&Target_Address, src) &&
-        (invoke_id == Request_Invoke_ID)) {
-        /* nothing to do */
+    (void)src;
+    (void)invoke_id;
+    /* nothing to do - the TSM frees the invoke id */
+}
+
+/**
+ * @brief Find the property of a request that a reply value belongs to.
+ *  Values come back in the order of the properties of the request,
+ *  so the search starts with the property of the last value.
+ * @param target [in] The request
+ * @param rp_data [in] The object and property of the reply value
+ * @return index of the property in the request, or -1 if not found
+ */
+static int bacnet_read_write_reference_index(
+    const TARGET_DATA *target, const BACNET_READ_PROPERTY_DATA *rp_data)
+{
+    const BACNET_READ_WRITE_REFERENCE *reference;
+    unsigned i, index;
+    int found = -1;
+
+    if (target->reference_count == 0) {
+        return 0;
+    }
+    for (i = 0; i < target->reference_count; i++) {
+        index = (Reply_Reference_Index + i) % target->reference_count;
+        reference = &target->reference[index];
+        if ((reference->object_type != rp_data->object_type) ||
+            (reference->object_instance != rp_data->object_instance)) {
+            continue;
+        }
+        if (reference->object_property == rp_data->object_property) {
+            found = (int)index;
+            break;
+        }
+        if ((found < 0) &&
+            ((reference->object_property == PROP_ALL) ||
+             (reference->object_property == PROP_REQUIRED) ||
+             (reference->object_property == PROP_OPTIONAL))) {
+            found = (int)index;
+        }
+    }
+    if (found >= 0) {
+        Reply_Reference_Index = (unsigned)found;
+    }
+
+    return found;
+}
+
+/**
+ * @brief Send a reply value to the callback of the request it belongs to,
+ *  or to the value callback
+ * @param device_id [in] The device ID of the source of the message
+ * @param rp_data [in] The object and property of the reply value
+ * @param value [in] The reply value, or NULL for an error
+ */
+static void bacnet_read_write_value_dispatch(
+    uint32_t device_id,
+    BACNET_READ_PROPERTY_DATA *rp_data,
+    BACNET_APPLICATION_DATA_VALUE *value)
+{
+    const TARGET_DATA *target;
+    int index;
+
+    if (Reply_Transaction) {
+        target = &Reply_Transaction->target;
+        index = bacnet_read_write_reference_index(target, rp_data);
+        if ((index >= 0) && target->callback[index]) {
+            target->callback[index](
+                device_id, rp_data, value, target->context[index]);
+            return;
+        }
+    }
+    if (bacnet_read_write_value_callback) {
+        bacnet_read_write_value_callback(device_id, rp_data, value);
     }
 }
 
@@ -214,9 +357,7 @@ static void bacnet_read_property_ack_process(
         value = &Target_Decoded_Property_Value;
         /* check for property error */
         if (rp_data->error_code != ERROR_CODE_SUCCESS) {
-            if (bacnet_read_write_value_callback) {
-                bacnet_read_write_value_callback(device_id, rp_data, NULL);
-            }
+            bacnet_read_write_value_dispatch(device_id, rp_data, NULL);
             return;
         }
         /* check for empty list */
@@ -225,9 +366,7 @@ static void bacnet_read_property_ack_process(
             value->tag = BACNET_APPLICATION_TAG_EMPTYLIST;
             rp_data->error_class = ERROR_CLASS_SERVICES;
             rp_data->error_code = ERROR_CODE_SUCCESS;
-            if (bacnet_read_write_value_callback) {
-                bacnet_read_write_value_callback(device_id, rp_data, value);
-            }
+            bacnet_read_write_value_dispatch(device_id, rp_data, value);
             return;
         }
         apdu = rp_data->application_data;
@@ -250,9 +389,7 @@ static void bacnet_read_property_ack_process(
                 if (array_index) {
                     rp_data->array_index = array_index;
                 }
-                if (bacnet_read_write_value_callback) {
-                    bacnet_read_write_value_callback(device_id, rp_data, value);
-                }
+                bacnet_read_write_value_dispatch(device_id, rp_data, value);
                 /* see if there is any more data */
                 if (len < apdu_len) {
                     apdu += len;
@@ -270,15 +407,105 @@ static void bacnet_read_property_ack_process(
                 } else {
                     rp_data->error_code = ERROR_CODE_SUCCESS;
                 }
-                if (bacnet_read_write_value_callback) {
-                    bacnet_read_write_value_callback(device_id, rp_data, NULL);
-                }
+                bacnet_read_write_value_dispatch(device_id, rp_data, NULL);
                 break;
             }
         }
     }
 }
 
+/**
+ * @brief Determine if the compact values of a property decode to the same
+ *  values as the known property decoder gives, which is true for
+ *  application tagged values of properties without a complex type
+ * @param rp_data [in] The object and property of the values
+ * @param list [in] The compact values of the property
+ * @return true if the compact values can be used as they are
+ */
+static bool bacnet_read_write_compact_plain(
+    const BACNET_READ_PROPERTY_DATA *rp_data,
+    const BACNET_APPLICATION_DATA_COMPACT *list)
+{
+    const BACNET_APPLICATION_DATA_COMPACT *compact;
+
+    if ((rp_data->array_index == 0) ||
+        (rp_data->object_property == PROP_PRIORITY_ARRAY) ||
+        (bacapp_known_property_tag(
+             rp_data->object_type, rp_data->object_property) != -1)) {
+        return false;
+    }
+    for (compact = list; compact; compact = compact->next) {
+        if (compact->context_specific) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Process one result of a ReadPropertyMultiple-ACK that was decoded
+ *  into compact values. Plain values are converted one at a time into the
+ *  decoded value; errors, empty lists, and complex values are passed on
+ *  as the ReadProperty-ACK of the octets they were decoded from.
+ * @param device_id [in] The device ID of the source of the message
+ * @param apdu [in] The ReadPropertyMultiple-ACK that was decoded
+ * @param rp_data [in] The object of the result
+ * @param property [in] The result
+ */
+static void bacnet_read_write_compact_process(
+    uint32_t device_id,
+    uint8_t *apdu,
+    BACNET_READ_PROPERTY_DATA *rp_data,
+    const BACNET_PROPERTY_REFERENCE_COMPACT *property)
+{
+    BACNET_APPLICATION_DATA_VALUE *value = &Target_Decoded_Property_Value;
+    const BACNET_APPLICATION_DATA_COMPACT *compact, *last;
+    BACNET_ARRAY_INDEX array_index = 0;
+
+    rp_data->object_property = property->propertyIdentifier;
+    rp_data->array_index = property->propertyArrayIndex;
+    rp_data->error_class = property->error.error_class;
+    rp_data->error_code = property->error.error_code;
+    rp_data->application_data = NULL;
+    rp_data->application_data_len = 0;
+    if ((rp_data->error_code != ERROR_CODE_SUCCESS) || !property->value ||
+        !bacnet_read_write_compact_plain(rp_data, property->value)) {
+        if (property->value) {
+            last = property->value;
+            while (last->next) {
+                last = last->next;
+            }
+            rp_data->application_data = &apdu[property->value->apdu - apdu];
+            rp_data->application_data_len =
+                (int)((last->apdu + last->apdu_len) - property->value->apdu);
+        }
+        bacnet_read_property_ack_process(device_id, rp_data);
+        return;
+    }
+    for (compact = property->value; compact; compact = compact->next) {
+        bacapp_value_list_init(value, 1);
+        if (!bacapp_compact_to_value(compact, value)) {
+            rp_data->error_class = ERROR_CLASS_SERVICES;
+            rp_data->error_code = ERROR_CODE_OTHER;
+            bacnet_read_write_value_dispatch(device_id, rp_data, NULL);
+            break;
+        }
+        if (compact->next && (rp_data->array_index == BACNET_ARRAY_ALL)) {
+            /* more than one value is an array, which is split into
+               its elements as separate values */
+            array_index = 1;
+        }
+        rp_data->error_class = ERROR_CLASS_SERVICES;
+        rp_data->error_code = ERROR_CODE_SUCCESS;
+        if (array_index) {
+            rp_data->array_index = array_index;
+            array_index++;
+        }
+        bacnet_read_write_value_dispatch(device_id, rp_data, value);
+    }
+}
+
 /** Handler for a ReadProperty ACK.
  *  Saves the data from a matching read-property request
  *
@@ -297,20 +524,26 @@ static void My_Read_Property_Ack_Handler(
     int len = 0;
     BACNET_READ_PROPERTY_DATA rp_data = { 0 };
     uint32_t device_id = 0;
+    READ_WRITE_TRANSACTION *transaction;
 
-    if (address_match(&Target_Address, src) &&
-        (service_data->invoke_id == Request_Invoke_ID)) {
+    transaction =
+        bacnet_read_write_transaction_find(src, service_data->invoke_id);
+    if (transaction) {
+        Reply_Octets += service_len;
         address_get_device_id(src, &device_id);
         rp_data.error_code = ERROR_CODE_SUCCESS;
         len = rp_ack_decode_service_request(
             service_request, service_len, &rp_data);
         if (len < 0) {
             /* unable to decode value */
-            Error_Detected = true;
-            Error_Class = ERROR_CLASS_SERVICES;
-            Error_Code = ERROR_CODE_INTERNAL_ERROR;
+            transaction->error_detected = true;
+            transaction->error_class = ERROR_CLASS_SERVICES;
+            transaction->error_code = ERROR_CODE_INTERNAL_ERROR;
         } else {
+            Reply_Transaction = transaction;
+            Reply_Reference_Index = 0;
             bacnet_read_property_ack_process(device_id, &rp_data);
+            Reply_Transaction = NULL;
         }
     }
 }
@@ -331,72 +564,128 @@ static void My_Read_Property_Multiple_Ack_Handler(
     BACNET_CONFIRMED_SERVICE_ACK_DATA *service_data)
 {
     BACNET_READ_PROPERTY_DATA rp_data = { 0 };
+    BACNET_APPLICATION_DATA_ARENA arena = { 0 };
+    BACNET_READ_ACCESS_COMPACT *read_access = NULL;
+    BACNET_PROPERTY_REFERENCE_COMPACT *property;
     uint32_t device_id = 0;
+    READ_WRITE_TRANSACTION *transaction;
+    int len;
 
-    address_get_device_id(src, &device_id);
-    if (address_match(&Target_Address, src) &&
-        (service_data->invoke_id == Request_Invoke_ID)) {
+    transaction =
+        bacnet_read_write_transaction_find(src, service_data->invoke_id);
+    if (transaction) {
+        Reply_Octets += apdu_len;
+        address_get_device_id(src, &device_id);
         rp_data.error_code = ERROR_CODE_SUCCESS;
-        rpm_ack_object_property_process(
-            apdu, apdu_len, device_id, &rp_data,
-            bacnet_read_property_ack_process);
+        Reply_Transaction = transaction;
+        Reply_Reference_Index = 0;
+        bacapp_arena_init(
+            &arena, Reply_Arena_Buffer, sizeof(Reply_Arena_Buffer));
+        len = rpm_ack_decode_compact(apdu, apdu_len, &arena, &read_access);
+        if (len < 0) {
+            /* malformed, or too many results for the arena:
+               pass on the results one at a time up to the error */
+            rpm_ack_object_property_process(
+                apdu, apdu_len, device_id, &rp_data,
+                bacnet_read_property_ack_process);
+        }
+        for (; (len >= 0) && read_access; read_access = read_access->next) {
+            rp_data.object_type = read_access->object_type;
+            rp_data.object_instance = read_access->object_instance;
+            for (property = read_access->listOfProperties; property;
+                 property = property->next) {
+                bacnet_read_write_compact_process(
+                    device_id, apdu, &rp_data, property);
+            }
+        }
+        Reply_Transaction = NULL;
     }
 }
 
 /**
- * @brief Sends a ReadPropertyMultiple service request
- * @param device_id [in] The contents of the service request.
- * @param object_type [in] The contents of the service request.
- * @param object_instance [in] The contents of the service request.
+ * @brief Sends a ReadPropertyMultiple service request for the properties
+ *  of a queued request, or for ALL properties of its object
+ * @param target [in] The queued request
  * @return invoke_id of request
  */
-static uint8_t Send_RPM_All_Request(
-    uint32_t device_id,
-    BACNET_OBJECT_TYPE object_type,
-    uint32_t object_instance)
+static uint8_t Send_RPM_Request(const TARGET_DATA *target)
 {
-    BACNET_READ_ACCESS_DATA read_access_data = { 0 };
-    BACNET_PROPERTY_REFERENCE property_list = { 0 };
+    BACNET_READ_WRITE_REFERENCE single = { 0 };
+    const BACNET_READ_WRITE_REFERENCE *reference;
+    BACNET_READ_ACCESS_DATA *read_access = NULL;
+    BACNET_PROPERTY_REFERENCE *property, *property_last = NULL;
+    unsigned count, i, objects = 0;
     uint8_t pdu[MAX_PDU] = { 0 };
 
-    /* configure the property list */
-    property_list.error.error_class = ERROR_CLASS_DEVICE;
-    property_list.error.error_code = ERROR_CODE_OTHER;
-    property_list.value = NULL;
-    property_list.propertyArrayIndex = BACNET_ARRAY_ALL;
-    property_list.propertyIdentifier = PROP_ALL;
-    property_list.next = NULL;
-    /* configure the read access data */
-    read_access_data.listOfProperties = &property_list;
-    read_access_data.object_instance = object_instance;
-    read_access_data.object_type = object_type;
-    read_access_data.next = NULL;
+    if (target->reference_count > 0) {
+        reference = target->reference;
+        count = target->reference_count;
+    } else {
+        single.object_type = target->object_type;
+        single.object_instance = target->object_instance;
+        single.object_property = target->object_property;
+        single.array_index = target->array_index;
+        reference = &single;
+        count = 1;
+    }
+    for (i = 0; i < count; i++) {
+        if (!read_access ||
+            (read_access->object_type != reference[i].object_type) ||
+            (read_access->object_instance != reference[i].object_instance)) {
+            /* properties of the next object */
+            if (read_access) {
+                read_access->next = &Target_Read_Access[objects];
+            }
+            read_access = &Target_Read_Access[objects];
+            objects++;
+            read_access->object_type = reference[i].object_type;
+            read_access->object_instance = reference[i].object_instance;
+            read_access->listOfProperties = NULL;
+            read_access->next = NULL;
+            property_last = NULL;
+        }
+        property = &Target_Property_Reference[i];
+        property->propertyIdentifier = reference[i].object_property;
+        property->propertyArrayIndex = reference[i].array_index;
+        property->error.error_class = ERROR_CLASS_DEVICE;
+        property->error.error_code = ERROR_CODE_OTHER;
+        property->value = NULL;
+        property->next = NULL;
+        if (property_last) {
+            property_last->next = property;
+        } else {
+            read_access->listOfProperties = property;
+        }
+        property_last = property;
+    }
 
     return Send_Read_Property_Multiple_Request(
-        pdu, sizeof(pdu), device_id, &read_access_data);
+        pdu, sizeof(pdu), target->device_id, &Target_Read_Access[0]);
 }
 
 /**
- * @brief Handles the ReadProperty process
- * @param service_request [in] The contents of the service request.
+ * @brief Handles the ReadProperty process of one request
+ * @param transaction [in] The request taken from the queue
  * @return true if the process is finished
  */
-static bool bacnet_read_write_process(const TARGET_DATA *target)
+static bool bacnet_read_write_process(READ_WRITE_TRANSACTION *transaction)
 {
+    const TARGET_DATA *target = &transaction->target;
     bool found = false;
     unsigned max_apdu = 0;
     uint8_t application_data[16] = { 0 };
     int application_data_len = 0;
     bool valid_tag = false;
 
-    switch (RW_State) {
+    switch (transaction->state) {
         case BACNET_CLIENT_IDLE:
-            mstimer_set(&Read_Write_Timer, apdu_timeout());
+            mstimer_set(&transaction->timer, apdu_timeout());
+            transaction->invoke_id = 0;
             if (target->device_id < BACNET_MAX_INSTANCE) {
-                Error_Detected = false;
-                RW_State = BACNET_CLIENT_BIND;
+                transaction->error_detected = false;
+                transaction->state = BACNET_CLIENT_BIND;
             } else {
-                RW_State = BACNET_CLIENT_FINISHED;
+                transaction->state = BACNET_CLIENT_FINISHED;
             }
             break;
         case BACNET_CLIENT_BIND:
@@ -404,28 +693,26 @@ static bool bacnet_read_write_process(const TARGET_DATA *target)
             address_own_device_id_set(Device_Object_Instance_Number());
             /* try to bind with the device */
             found = address_bind_request(
-                target->device_id, &max_apdu, &Target_Address);
+                target->device_id, &max_apdu, &transaction->address);
             if (found) {
-                Target_Device_ID = target->device_id;
-                RW_State = BACNET_CLIENT_SEND;
+                transaction->state = BACNET_CLIENT_SEND;
             } else {
                 Send_WhoIs(target->device_id, target->device_id);
-                RW_State = BACNET_CLIENT_BINDING;
+                transaction->state = BACNET_CLIENT_BINDING;
             }
             break;
         case BACNET_CLIENT_BINDING:
             found = address_bind_request(
-                target->device_id, &max_apdu, &Target_Address);
+                target->device_id, &max_apdu, &transaction->address);
             if (found) {
-                Target_Device_ID = target->device_id;
-                mstimer_set(&Read_Write_Timer, apdu_timeout());
-                RW_State = BACNET_CLIENT_SEND;
-            } else if (mstimer_expired(&Read_Write_Timer)) {
+                mstimer_set(&transaction->timer, apdu_timeout());
+                transaction->state = BACNET_CLIENT_SEND;
+            } else if (mstimer_expired(&transaction->timer)) {
                 /* unable to bind within APDU timeout */
-                Error_Detected = true;
-                Error_Class = ERROR_CLASS_SERVICES;
-                Error_Code = ERROR_CODE_TIMEOUT;
-                RW_State = BACNET_CLIENT_FINISHED;
+                transaction->error_detected = true;
+                transaction->error_class = ERROR_CLASS_SERVICES;
+                transaction->error_code = ERROR_CODE_TIMEOUT;
+                transaction->state = BACNET_CLIENT_FINISHED;
             }
             break;
         case BACNET_CLIENT_SEND:
@@ -465,58 +752,170 @@ static bool bacnet_read_write_process(const TARGET_DATA *target)
                         break;
                 }
                 if (valid_tag) {
-                    Request_Invoke_ID = Send_Write_Property_Request_Data(
+                    transaction->invoke_id = Send_Write_Property_Request_Data(
                         target->device_id, target->object_type,
                         target->object_instance, target->object_property,
                         &application_data[0], application_data_len,
                         target->priority, target->array_index);
                 }
             } else {
-                if (target->object_property == PROP_ALL) {
-                    Request_Invoke_ID = Send_RPM_All_Request(
-                        target->device_id, target->object_type,
-                        target->object_instance);
+                if ((target->reference_count > 0) ||
+                    (target->object_property == PROP_ALL)) {
+                    transaction->invoke_id = Send_RPM_Request(target);
                 } else {
-                    Request_Invoke_ID = Send_Read_Property_Request(
+                    transaction->invoke_id = Send_Read_Property_Request(
                         target->device_id, target->object_type,
                         target->object_instance, target->object_property,
                         target->array_index);
                 }
             }
-            if (Request_Invoke_ID == 0) {
-                if (mstimer_expired(&Read_Write_Timer)) {
+            if (transaction->invoke_id == 0) {
+                if (mstimer_expired(&transaction->timer)) {
                     /* TSM Timeout - no invokeIDs available */
-                    Error_Detected = true;
-                    Error_Class = ERROR_CLASS_SERVICES;
-                    Error_Code = ERROR_CODE_TIMEOUT;
-                    RW_State = BACNET_CLIENT_FINISHED;
+                    transaction->error_detected = true;
+                    transaction->error_class = ERROR_CLASS_SERVICES;
+                    transaction->error_code = ERROR_CODE_TIMEOUT;
+                    transaction->state = BACNET_CLIENT_FINISHED;
                 }
             } else {
-                RW_State = BACNET_CLIENT_WAITING;
+                transaction->state = BACNET_CLIENT_WAITING;
             }
             break;
         case BACNET_CLIENT_WAITING:
-            if (Error_Detected) {
-                RW_State = BACNET_CLIENT_FINISHED;
-            } else if (tsm_invoke_id_free(Request_Invoke_ID)) {
-                Error_Detected = false;
-                RW_State = BACNET_CLIENT_FINISHED;
-            } else if (tsm_invoke_id_failed(Request_Invoke_ID)) {
-                Error_Detected = true;
-                Error_Class = ERROR_CLASS_SERVICES;
-                Error_Code = ERROR_CODE_ABORT_TSM_TIMEOUT;
-                RW_State = BACNET_CLIENT_FINISHED;
-                tsm_free_invoke_id(Request_Invoke_ID);
+            if (transaction->error_detected) {
+                transaction->state = BACNET_CLIENT_FINISHED;
+            } else if (tsm_peer_invoke_id_free(
+                           &transaction->address, transaction->invoke_id)) {
+                transaction->state = BACNET_CLIENT_FINISHED;
+            } else if (tsm_peer_invoke_id_failed(
+                           &transaction->address, transaction->invoke_id)) {
+                transaction->error_detected = true;
+                transaction->error_class = ERROR_CLASS_SERVICES;
+                transaction->error_code = ERROR_CODE_ABORT_TSM_TIMEOUT;
+                transaction->state = BACNET_CLIENT_FINISHED;
+                tsm_peer_free_invoke_id(
+                    &transaction->address, transaction->invoke_id);
             }
             break;
         case BACNET_CLIENT_FINISHED:
-            RW_State = BACNET_CLIENT_IDLE;
+            transaction->state = BACNET_CLIENT_IDLE;
             break;
         default:
             break;
     }
 
-    return (RW_State == BACNET_CLIENT_FINISHED);
+    return (transaction->state == BACNET_CLIENT_FINISHED);
+}
+
+/**
+ * @brief Report the error of a finished request to the callback of each
+ *  property that was requested, or to the value callback
+ * @param transaction [in] The finished request
+ */
+static void bacnet_read_write_error_report(
+    const READ_WRITE_TRANSACTION *transaction)
+{
+    const TARGET_DATA *target = &transaction->target;
+    BACNET_READ_PROPERTY_DATA rp_data = { 0 };
+    unsigned i = 0;
+
+    rp_data.error_class = transaction->error_class;
+    rp_data.error_code = transaction->error_code;
+    do {
+        if (target->reference_count > 0) {
+            rp_data.object_type = target->reference[i].object_type;
+            rp_data.object_instance = target->reference[i].object_instance;
+            rp_data.object_property = target->reference[i].object_property;
+            rp_data.array_index = target->reference[i].array_index;
+        } else {
+            rp_data.object_type = target->object_type;
+            rp_data.object_instance = target->object_instance;
+            rp_data.object_property = target->object_property;
+            rp_data.array_index = target->array_index;
+        }
+        if (target->callback[i]) {
+            target->callback[i](
+                target->device_id, &rp_data, NULL, target->context[i]);
+        } else if (bacnet_read_write_value_callback) {
+            bacnet_read_write_value_callback(
+                target->device_id, &rp_data, NULL);
+        }
+        i++;
+    } while (i < target->reference_count);
+}
+
+/**
+ * @brief Queue the properties of a finished request again, one at a time,
+ *  when they were put together in a ReadPropertyMultiple that the device
+ *  does not support, or whose reply did not fit.
+ * @param transaction [in] The finished request
+ * @return true if the properties were queued again
+ */
+static bool bacnet_read_write_split(const READ_WRITE_TRANSACTION *transaction)
+{
+    const TARGET_DATA *target = &transaction->target;
+    TARGET_DATA single = { 0 };
+    unsigned i;
+
+    if (!target->coalesce || (target->reference_count < 2)) {
+        return false;
+    }
+    switch (transaction->error_code) {
+        case ERROR_CODE_REJECT_UNRECOGNIZED_SERVICE:
+        case ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED:
+        case ERROR_CODE_ABORT_BUFFER_OVERFLOW:
+        case ERROR_CODE_ABORT_APDU_TOO_LONG:
+            break;
+        default:
+            return false;
+    }
+    if ((Ringbuf_Size(&Target_Data_Queue) -
+         Ringbuf_Count(&Target_Data_Queue)) < target->reference_count) {
+        return false;
+    }
+    /* in front of the queue, in their order */
+    i = target->reference_count;
+    while (i > 0) {
+        i--;
+        single.device_id = target->device_id;
+        single.object_type = target->reference[i].object_type;
+        single.object_instance = target->reference[i].object_instance;
+        single.object_property = target->reference[i].object_property;
+        single.array_index = target->reference[i].array_index;
+        single.callback[0] = target->callback[i];
+        single.context[0] = target->context[i];
+        Ringbuf_Put_Front(&Target_Data_Queue, (uint8_t *)&single);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Determine if a queued write has to wait for an outstanding
+ *  request to the same property, so that writes are done in order
+ * @param target [in] The queued request
+ * @return true if the request has to wait
+ */
+static bool bacnet_read_write_blocked(const TARGET_DATA *target)
+{
+    const TARGET_DATA *active;
+    unsigned i;
+
+    if (!target->write_property) {
+        return false;
+    }
+    for (i = 0; i < BACNET_READ_WRITE_TRANSACTIONS_MAX; i++) {
+        active = &Transaction[i].target;
+        if (Transaction[i].used && active->write_property &&
+            (active->device_id == target->device_id) &&
+            (active->object_type == target->object_type) &&
+            (active->object_instance == target->object_instance) &&
+            (active->object_property == target->object_property)) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 /**
@@ -542,31 +941,45 @@ void bacnet_read_write_device_callback_set(
 }
 
 /**
- * @brief Handles the ReadProperty repetitive task
+ * @brief Handles the ReadProperty repetitive task. Requests are taken
+ *  from the queue in order, and up to the transaction limit of them
+ *  are outstanding at once. A write waits while an earlier write to the
+ *  same property is outstanding.
  */
 void bacnet_read_write_task(void)
 {
-    TARGET_DATA *target;
+    READ_WRITE_TRANSACTION *transaction;
+    const TARGET_DATA *target;
+    BACNET_CLIENT_STATE state;
     bool status = false;
-    BACNET_READ_PROPERTY_DATA rp_data;
+    unsigned i;
 
-    if (!Ringbuf_Empty(&Target_Data_Queue)) {
-        target = (TARGET_DATA *)Ringbuf_Peek(&Target_Data_Queue);
-        status = bacnet_read_write_process(target);
+    for (i = 0; i < BACNET_READ_WRITE_TRANSACTIONS_MAX; i++) {
+        transaction = &Transaction[i];
+        if (!transaction->used) {
+            target = (const TARGET_DATA *)Ringbuf_Peek(&Target_Data_Queue);
+            if ((i >= Transaction_Limit) || !target ||
+                bacnet_read_write_blocked(target)) {
+                continue;
+            }
+            Ringbuf_Pop(&Target_Data_Queue, (uint8_t *)&transaction->target);
+            transaction->used = true;
+            transaction->state = BACNET_CLIENT_IDLE;
+        }
+        /* go straight through the states that do not wait */
+        do {
+            state = transaction->state;
+            status = bacnet_read_write_process(transaction);
+        } while (!status && (transaction->state != state) &&
+                 (transaction->state != BACNET_CLIENT_BINDING) &&
+                 (transaction->state != BACNET_CLIENT_WAITING));
         if (status) {
-            if (Error_Detected) {
-                if (bacnet_read_write_value_callback) {
-                    rp_data.error_class = Error_Class;
-                    rp_data.error_code = Error_Code;
-                    rp_data.object_type = target->object_type;
-                    rp_data.object_instance = target->object_instance;
-                    rp_data.object_property = target->object_property;
-                    rp_data.array_index = target->array_index;
-                    bacnet_read_write_value_callback(
-                        target->device_id, &rp_data, NULL);
-                }
+            if (transaction->error_detected &&
+                !bacnet_read_write_split(transaction)) {
+                bacnet_read_write_error_report(transaction);
             }
-            Ringbuf_Pop(&Target_Data_Queue, NULL);
+            transaction->state = BACNET_CLIENT_IDLE;
+            transaction->used = false;
         }
     }
     if (mstimer_expired(&Cache_Timer)) {
@@ -596,7 +1009,7 @@ bool bacnet_read_property_queue(
     uint32_t array_index)
 {
     bool status = false;
-    TARGET_DATA target;
+    TARGET_DATA target = { 0 };
 
     target.write_property = false;
     target.device_id = device_id;
@@ -609,6 +1022,156 @@ bool bacnet_read_property_queue(
     return status;
 }
 
+/**
+ * @brief Get the number of properties of a device that are put together
+ *  in one ReadPropertyMultiple, from the largest APDU the device accepts
+ * @param device_id - ID of the destination device
+ * @return number of properties, or zero if the device is not bound
+ */
+static unsigned bacnet_read_write_coalesce_limit(uint32_t device_id)
+{
+    BACNET_ADDRESS address = { 0 };
+    unsigned max_apdu = 0;
+    unsigned limit;
+
+    if (!address_get_by_device(device_id, &max_apdu, &address) ||
+        (max_apdu <= READ_WRITE_RPM_ACK_OCTETS)) {
+        return 0;
+    }
+    limit = (max_apdu - READ_WRITE_RPM_ACK_OCTETS) /
+        READ_WRITE_RPM_RESULT_OCTETS;
+    if (limit < 1) {
+        limit = 1;
+    } else if (limit > BACNET_READ_WRITE_REFERENCE_MAX) {
+        limit = BACNET_READ_WRITE_REFERENCE_MAX;
+    }
+
+    return limit;
+}
+
+/**
+ * @brief Adds a Read Property request for a remote data point, with a
+ *  callback for its reply. Requests to the same device that are next to
+ *  each other in the queue are sent together in one ReadPropertyMultiple
+ *  when the device is bound, and are sent one at a time again if the
+ *  device does not support ReadPropertyMultiple.
+ * @param device_id - ID of the destination device
+ * @param object_type - Type of the object whose property is to be read.
+ * @param object_instance - Instance # of the object to be read.
+ * @param object_property - Property to be read, but not ALL, REQUIRED, or
+ * OPTIONAL.
+ * @param array_index [in] Optional: if the Property is an array,
+ *   - 0 for the array size
+ *   - 1 to n for individual array members
+ *   - BACNET_ARRAY_ALL (~0) for the full array to be read.
+ * @param callback - function called with the reply value or error,
+ *  or NULL to use the value callback
+ * @param context - passed to the callback
+ * @return true if added, false if not added
+ */
+bool bacnet_read_property_request_queue(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID object_property,
+    uint32_t array_index,
+    bacnet_read_write_request_callback_t callback,
+    void *context)
+{
+    TARGET_DATA target = { 0 };
+    TARGET_DATA *last = NULL, *next;
+    BACNET_READ_WRITE_REFERENCE *reference;
+    unsigned limit;
+    bool coalesce;
+
+    coalesce = (object_property != PROP_ALL) &&
+        (object_property != PROP_REQUIRED) &&
+        (object_property != PROP_OPTIONAL);
+    if (coalesce) {
+        next = (TARGET_DATA *)Ringbuf_Peek(&Target_Data_Queue);
+        while (next) {
+            last = next;
+            next = (TARGET_DATA *)Ringbuf_Peek_Next(
+                &Target_Data_Queue, (const uint8_t *)next);
+        }
+    }
+    if (last && last->coalesce && (last->device_id == device_id)) {
+        limit = bacnet_read_write_coalesce_limit(device_id);
+        if (last->reference_count == 0) {
+            /* the first property moves into the list */
+            if (limit > 1) {
+                reference = &last->reference[0];
+                reference->object_type = last->object_type;
+                reference->object_instance = last->object_instance;
+                reference->object_property = last->object_property;
+                reference->array_index = last->array_index;
+                last->reference_count = 1;
+            }
+        }
+        if ((last->reference_count > 0) && (last->reference_count < limit)) {
+            reference = &last->reference[last->reference_count];
+            reference->object_type = object_type;
+            reference->object_instance = object_instance;
+            reference->object_property = object_property;
+            reference->array_index = array_index;
+            last->callback[last->reference_count] = callback;
+            last->context[last->reference_count] = context;
+            last->reference_count++;
+            return true;
+        }
+    }
+    target.write_property = false;
+    target.coalesce = coalesce;
+    target.device_id = device_id;
+    target.object_type = object_type;
+    target.object_instance = object_instance;
+    target.object_property = object_property;
+    target.array_index = array_index;
+    target.callback[0] = callback;
+    target.context[0] = context;
+
+    return Ringbuf_Put(&Target_Data_Queue, (uint8_t *)&target);
+}
+
+/**
+ * @brief Adds a ReadPropertyMultiple request for several properties
+ *  of one device, which are replied to the value callback one at a time.
+ *  Properties of the same object are kept together in the request
+ *  when they are next to each other in the list.
+ * @param device_id - ID of the destination device
+ * @param reference - list of the properties to be read
+ * @param reference_count - number of properties in the list,
+ *  1..BACNET_READ_WRITE_REFERENCE_MAX
+ * @return true if added, false if not added
+ */
+bool bacnet_read_property_multiple_queue(
+    uint32_t device_id,
+    const BACNET_READ_WRITE_REFERENCE *reference,
+    unsigned reference_count)
+{
+    bool status = false;
+    TARGET_DATA target = { 0 };
+    unsigned i;
+
+    if (!reference || (reference_count == 0) ||
+        (reference_count > BACNET_READ_WRITE_REFERENCE_MAX)) {
+        return false;
+    }
+    target.write_property = false;
+    target.device_id = device_id;
+    target.object_type = reference[0].object_type;
+    target.object_instance = reference[0].object_instance;
+    target.object_property = reference[0].object_property;
+    target.array_index = reference[0].array_index;
+    for (i = 0; i < reference_count; i++) {
+        target.reference[i] = reference[i];
+    }
+    target.reference_count = (uint8_t)reference_count;
+    status = Ringbuf_Put(&Target_Data_Queue, (uint8_t *)&target);
+
+    return status;
+}
+
 /**
  * @brief Adds a WriteProperty request to a remote data point - REAL
  * @param device_id - ID of the destination device
@@ -714,7 +1277,7 @@ bool bacnet_write_property_enumerated_queue(
     uint32_t array_index)
 {
     bool status = false;
-    TARGET_DATA target;
+    TARGET_DATA target = { 0 };
 
     target.write_property = true;
     target.device_id = device_id;
@@ -755,7 +1318,7 @@ bool bacnet_write_property_unsigned_queue(
     uint32_t array_index)
 {
     bool status = false;
-    TARGET_DATA target;
+    TARGET_DATA target = { 0 };
 
     target.write_property = true;
     target.device_id = device_id;
@@ -796,7 +1359,7 @@ bool bacnet_write_property_signed_queue(
     uint32_t array_index)
 {
     bool status = false;
-    TARGET_DATA target;
+    TARGET_DATA target = { 0 };
 
     target.write_property = true;
     target.device_id = device_id;
@@ -837,7 +1400,7 @@ bool bacnet_write_property_boolean_queue(
     uint32_t array_index)
 {
     bool status = false;
-    TARGET_DATA target;
+    TARGET_DATA target = { 0 };
 
     target.write_property = true;
     target.device_id = device_id;
@@ -854,11 +1417,20 @@ bool bacnet_write_property_boolean_queue(
 }
 
 /**
- * @brief Determines if the BACnet ReadProperty queue is empty
+ * @brief Determines if the BACnet ReadProperty queue is empty,
+ *  and no request is outstanding
  * @return true if the parameter queue is empty, and thus, idle
  */
 bool bacnet_read_write_idle(void)
 {
+    unsigned i;
+
+    for (i = 0; i < BACNET_READ_WRITE_TRANSACTIONS_MAX; i++) {
+        if (Transaction[i].used) {
+            return false;
+        }
+    }
+
     return Ringbuf_Empty(&Target_Data_Queue);
 }
 
@@ -871,6 +1443,98 @@ bool bacnet_read_write_busy(void)
     return Ringbuf_Full(&Target_Data_Queue);
 }
 
+/**
+ * @brief Get the number of requests to a device that are queued
+ *  or outstanding
+ * @param device_id - ID of the destination device
+ * @return number of requests to the device that are not finished
+ */
+unsigned bacnet_read_write_device_pending(uint32_t device_id)
+{
+    const TARGET_DATA *target;
+    unsigned count = 0;
+    unsigned i;
+
+    for (i = 0; i < BACNET_READ_WRITE_TRANSACTIONS_MAX; i++) {
+        if (Transaction[i].used &&
+            (Transaction[i].target.device_id == device_id)) {
+            count++;
+        }
+    }
+    target = (const TARGET_DATA *)Ringbuf_Peek(&Target_Data_Queue);
+    while (target) {
+        if (target->device_id == device_id) {
+            count++;
+        }
+        target = (const TARGET_DATA *)Ringbuf_Peek_Next(
+            &Target_Data_Queue, (const uint8_t *)target);
+    }
+
+    return count;
+}
+
+/**
+ * @brief Get the number of requests that are queued or outstanding
+ * @return number of requests that are not finished
+ */
+unsigned bacnet_read_write_pending(void)
+{
+    unsigned count;
+    unsigned i;
+
+    count = Ringbuf_Count(&Target_Data_Queue);
+    for (i = 0; i < BACNET_READ_WRITE_TRANSACTIONS_MAX; i++) {
+        if (Transaction[i].used) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Set the number of requests that are outstanding at once,
+ *  which is BACNET_READ_WRITE_TRANSACTIONS_MAX unless set.
+ *  Requests to the same device may finish out of order when this
+ *  is more than one.
+ * @param limit - 1..BACNET_READ_WRITE_TRANSACTIONS_MAX, and no more than
+ *  the number of TSM transactions
+ */
+void bacnet_read_write_transactions_set(unsigned limit)
+{
+    if (limit < 1) {
+        limit = 1;
+    } else if (limit > BACNET_READ_WRITE_TRANSACTIONS_MAX) {
+        limit = BACNET_READ_WRITE_TRANSACTIONS_MAX;
+    }
+#if (MAX_TSM_TRANSACTIONS > 0)
+    if (limit > MAX_TSM_TRANSACTIONS) {
+        /* each outstanding request uses a transaction state machine */
+        limit = MAX_TSM_TRANSACTIONS;
+    }
+#endif
+    Transaction_Limit = limit;
+}
+
+/**
+ * @brief Get the number of requests that are outstanding at once
+ * @return number of requests that are outstanding at once
+ */
+unsigned bacnet_read_write_transactions(void)
+{
+    return Transaction_Limit;
+}
+
+/**
+ * @brief Get the number of octets in the ReadProperty and
+ *  ReadPropertyMultiple replies to our requests, which wraps around
+ * @return number of octets received in replies
+ */
+unsigned long bacnet_read_write_reply_octets(void)
+{
+    return Reply_Octets;
+}
+
 /**
  * @brief Sets a Vendor ID filter on I-Am bindings to limit the address
  *  cache usage when we are only reading/writing to a specific vendor ID
@@ -896,6 +1560,13 @@ uint16_t bacnet_read_write_vendor_id_filter(void)
  */
 void bacnet_read_write_init(void)
 {
+    unsigned i;
+
+    for (i = 0; i < BACNET_READ_WRITE_TRANSACTIONS_MAX; i++) {
+        Transaction[i].used = false;
+    }
+    /* the default limit is also no more than the TSM transactions */
+    bacnet_read_write_transactions_set(Transaction_Limit);
     Ringbuf_Initialize(
         &Target_Data_Queue, (uint8_t *)&Target_Data_Buffer,
         sizeof(Target_Data_Buffer), TARGET_DATA_QUEUE_SIZE,
@@ -14,6 +14,27 @@
 #include "bacnet/bacapp.h"
 #include "bacnet/rp.h"
 
+/* number of requests that can be outstanding at once */
+#ifndef BACNET_READ_WRITE_TRANSACTIONS_MAX
+#define BACNET_READ_WRITE_TRANSACTIONS_MAX 16
+#endif
+/* number of properties in one ReadPropertyMultiple request */
+#ifndef BACNET_READ_WRITE_REFERENCE_MAX
+#define BACNET_READ_WRITE_REFERENCE_MAX 16
+#endif
+/* octets of memory for the decoded results of a ReadPropertyMultiple-ACK */
+#ifndef BACNET_READ_WRITE_ARENA_SIZE
+#define BACNET_READ_WRITE_ARENA_SIZE 4096
+#endif
+
+/* a property to read with ReadPropertyMultiple */
+typedef struct bacnet_read_write_reference_t {
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    BACNET_PROPERTY_ID object_property;
+    uint32_t array_index;
+} BACNET_READ_WRITE_REFERENCE;
+
 /**
  * Save the requested ReadProperty data to a data store
  *
@@ -28,6 +49,21 @@ typedef void (*bacnet_read_write_value_callback_t)(
     BACNET_READ_PROPERTY_DATA *rp_data,
     BACNET_APPLICATION_DATA_VALUE *value);
 
+/**
+ * Save the reply to one queued ReadProperty request
+ *
+ * @param device_instance [in] device instance number where data originated
+ * @param rp_data [in] Pointer to the BACNET_READ_PROPERTY_DATA structure,
+ *  with the error class and code when value is NULL
+ * @param value [in] pointer to the decoded value, or NULL for an error
+ * @param context [in] the context given when the request was queued
+ */
+typedef void (*bacnet_read_write_request_callback_t)(
+    uint32_t device_instance,
+    BACNET_READ_PROPERTY_DATA *rp_data,
+    BACNET_APPLICATION_DATA_VALUE *value,
+    void *context);
+
 /**
  * Save the I-Am service data to a data store
  *
@@ -56,6 +92,18 @@ bool bacnet_read_property_queue(
     uint32_t object_instance,
     BACNET_PROPERTY_ID object_property,
     uint32_t array_index);
+bool bacnet_read_property_request_queue(
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID object_property,
+    uint32_t array_index,
+    bacnet_read_write_request_callback_t callback,
+    void *context);
+bool bacnet_read_property_multiple_queue(
+    uint32_t device_id,
+    const BACNET_READ_WRITE_REFERENCE *reference,
+    unsigned reference_count);
 bool bacnet_write_property_real_queue(
     uint32_t device_id,
     BACNET_OBJECT_TYPE object_type,
@@ -109,6 +157,11 @@ void bacnet_read_write_device_callback_set(
     bacnet_read_write_device_callback_t callback);
 void bacnet_read_write_vendor_id_filter_set(uint16_t vendor_id);
 uint16_t bacnet_read_write_vendor_id_filter(void);
+unsigned bacnet_read_write_device_pending(uint32_t device_id);
+unsigned bacnet_read_write_pending(void);
+void bacnet_read_write_transactions_set(unsigned limit);
+unsigned bacnet_read_write_transactions(void);
+unsigned long bacnet_read_write_reply_octets(void);
 
 #ifdef __cplusplus
 }
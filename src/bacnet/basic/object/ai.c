@@ -178,11 +178,12 @@ float Analog_Input_Present_Value(uint32_t object_instance)
  *
  * This method will update the COV-changed attribute.
  *
+ * @param object_instance  object-instance number of the object
  * @param index  Object index
  * @param value  Given present value.
  */
-static void
-Analog_Input_COV_Detect(struct analog_input_descr *pObject, float value)
+static void Analog_Input_COV_Detect(
+    uint32_t object_instance, struct analog_input_descr *pObject, float value)
 {
     float prior_value = 0.0f;
     float cov_increment = 0.0f;
@@ -198,6 +199,7 @@ Analog_Input_COV_Detect(struct analog_input_descr *pObject, float value)
         }
         if (cov_delta >= cov_increment) {
             pObject->Changed = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
             pObject->Prior_Value = value;
         }
     }
@@ -216,7 +218,7 @@ void Analog_Input_Present_Value_Set(uint32_t object_instance, float value)
 
     pObject = Analog_Input_Object(object_instance);
     if (pObject) {
-        Analog_Input_COV_Detect(pObject, value);
+        Analog_Input_COV_Detect(object_instance, pObject, value);
         pObject->Present_Value = value;
     }
 }
@@ -459,6 +461,7 @@ bool Analog_Input_Reliability_Set(
         pObject->Reliability = value;
         if (fault != Analog_Input_Object_Fault(pObject)) {
             pObject->Changed = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
         }
         status = true;
     }
@@ -579,7 +582,8 @@ void Analog_Input_COV_Increment_Set(uint32_t object_instance, float value)
     pObject = Analog_Input_Object(object_instance);
     if (pObject) {
         pObject->COV_Increment = value;
-        Analog_Input_COV_Detect(pObject, pObject->Present_Value);
+        Analog_Input_COV_Detect(
+            object_instance, pObject, pObject->Present_Value);
     }
 }
 
@@ -659,6 +663,7 @@ void Analog_Input_Out_Of_Service_Set(uint32_t object_instance, bool value)
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
             pObject->Changed = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
         }
         pObject->Out_Of_Service = value;
     }
@@ -1067,6 +1072,22 @@ bool Analog_Input_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
     return status;
 }
 
+#if defined(INTRINSIC_REPORTING)
+/**
+ * @brief Determine if the event state of an Analog Input is active: an
+ *  Event_State that is not NORMAL, or a transition not acknowledged
+ * @param pObject - object data
+ * @return true if the event state is active
+ */
+static bool Analog_Input_Active_Event(const struct analog_input_descr *pObject)
+{
+    return (pObject->Event_State != EVENT_STATE_NORMAL) ||
+        !pObject->Acked_Transitions[TRANSITION_TO_OFFNORMAL].bIsAcked ||
+        !pObject->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ||
+        !pObject->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked;
+}
+#endif
+
 /**
  * @brief Handles the Intrinsic Reporting Service for the Analog Input Object
  * @param  object_instance - object-instance number of the object
@@ -1082,6 +1103,7 @@ void Analog_Input_Intrinsic_Reporting(uint32_t object_instance)
     float ExceededLimit = 0.0f;
     float PresentVal = 0.0f;
     bool SendNotify = false;
+    bool ActiveEvent = false;
 
     CurrentAI = Analog_Input_Object(object_instance);
     if (!CurrentAI) {
@@ -1092,6 +1114,7 @@ void Analog_Input_Intrinsic_Reporting(uint32_t object_instance)
     if (!CurrentAI->Event_Detection_Enable) {
         return; /* limits are not configured */
     }
+    ActiveEvent = Analog_Input_Active_Event(CurrentAI);
 
     if (CurrentAI->Ack_notify_data.bSendAckNotify) {
         /* clean bSendAckNotify flag */
@@ -1400,6 +1423,10 @@ void Analog_Input_Intrinsic_Reporting(uint32_t object_instance)
             }
         }
     }
+    if (Analog_Input_Active_Event(CurrentAI) != ActiveEvent) {
+        handler_get_event_information_active_set(
+            Object_Type, object_instance, !ActiveEvent);
+    }
 #else
     (void)object_instance;
 #endif /* defined(INTRINSIC_REPORTING) */
@@ -1495,6 +1522,7 @@ int Analog_Input_Alarm_Ack(
     BACNET_ALARM_ACK_DATA *alarmack_data, BACNET_ERROR_CODE *error_code)
 {
     struct analog_input_descr *CurrentAI;
+    bool ActiveEvent;
 
     if (!alarmack_data) {
         return -1;
@@ -1505,6 +1533,7 @@ int Analog_Input_Alarm_Ack(
         *error_code = ERROR_CODE_UNKNOWN_OBJECT;
         return -1;
     }
+    ActiveEvent = Analog_Input_Active_Event(CurrentAI);
     switch (alarmack_data->eventStateAcked) {
         case EVENT_STATE_OFFNORMAL:
         case EVENT_STATE_HIGH_LIMIT:
@@ -1593,6 +1622,12 @@ int Analog_Input_Alarm_Ack(
     CurrentAI->Ack_notify_data.bSendAckNotify = true;
     CurrentAI->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
 
+    if (Analog_Input_Active_Event(CurrentAI) != ActiveEvent) {
+        handler_get_event_information_active_set(
+            Object_Type, alarmack_data->eventObjectIdentifier.instance,
+            !ActiveEvent);
+    }
+
     return 1;
 }
 
@@ -1717,6 +1752,10 @@ bool Analog_Input_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
+#if defined(INTRINSIC_REPORTING)
+        handler_get_event_information_active_set(
+            Object_Type, object_instance, false);
+#endif
         free(pObject);
         status = true;
     }
@@ -1755,6 +1794,8 @@ void Analog_Input_Init(void)
     /* Set handler for GetEventInformation function */
     handler_get_event_information_set(
         Object_Type, Analog_Input_Event_Information);
+    handler_get_event_information_index_set(
+        Object_Type, Analog_Input_Instance_To_Index);
     /* Set handler for AcknowledgeAlarm function */
     handler_alarm_ack_set(Object_Type, Analog_Input_Alarm_Ack);
     /* Set handler for GetAlarmSummary Service */
@@ -286,11 +286,12 @@ bool Analog_Output_Relinquish_Default_Set(uint32_t object_instance, float value)
 /**
  * For a given object instance-number, checks the present-value for COV
  *
+ * @param  object_instance - object-instance number of the object
  * @param  pObject - specific object with valid data
  * @param  value - floating point analog value
  */
-static void
-Analog_Output_Present_Value_COV_Detect(struct object_data *pObject, float value)
+static void Analog_Output_Present_Value_COV_Detect(
+    uint32_t object_instance, struct object_data *pObject, float value)
 {
     float prior_value = 0.0;
     float cov_increment = 0.0;
@@ -306,6 +307,7 @@ Analog_Output_Present_Value_COV_Detect(struct object_data *pObject, float value)
         }
         if (cov_delta >= cov_increment) {
             pObject->Changed = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
             pObject->Prior_Value = value;
         }
     }
@@ -333,7 +335,9 @@ bool Analog_Output_Present_Value_Set(
             pObject->Relinquished[priority - 1] = false;
             pObject->Priority_Array[priority - 1] = value;
             Analog_Output_Present_Value_COV_Detect(
-                pObject, Analog_Output_Present_Value(object_instance));
+                object_instance,
+                pObject,
+                Analog_Output_Present_Value(object_instance));
             status = true;
         }
     }
@@ -359,7 +363,9 @@ bool Analog_Output_Present_Value_Relinquish(
             pObject->Relinquished[priority - 1] = true;
             pObject->Priority_Array[priority - 1] = 0.0;
             Analog_Output_Present_Value_COV_Detect(
-                pObject, Analog_Output_Present_Value(object_instance));
+                object_instance,
+                pObject,
+                Analog_Output_Present_Value(object_instance));
             status = true;
         }
     }
@@ -633,6 +639,7 @@ void Analog_Output_Out_Of_Service_Set(uint32_t object_instance, bool value)
         if (pObject->Out_Of_Service != value) {
             pObject->Out_Of_Service = value;
             pObject->Changed = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
         }
     }
 }
@@ -671,6 +678,7 @@ void Analog_Output_Overridden_Set(uint32_t object_instance, bool value)
         if (pObject->Overridden != value) {
             pObject->Overridden = value;
             pObject->Changed = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
         }
     }
 }
@@ -731,6 +739,7 @@ bool Analog_Output_Reliability_Set(
             pObject->Reliability = value;
             if (fault != Analog_Output_Object_Fault(pObject)) {
                 pObject->Changed = true;
+                COV_CHANGE_NOTIFY(Object_Type, object_instance);
             }
             status = true;
         }
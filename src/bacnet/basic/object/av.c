@@ -184,11 +184,12 @@ float Analog_Value_Present_Value(uint32_t object_instance)
  *
  * This method will update the COV-changed attribute.
  *
+ * @param object_instance  object-instance number of the object
  * @param index  Object index
  * @param value  Given present value.
  */
-static void
-Analog_Value_COV_Detect(struct analog_value_descr *pObject, float value)
+static void Analog_Value_COV_Detect(
+    uint32_t object_instance, struct analog_value_descr *pObject, float value)
 {
     float prior_value = 0.0f;
     float cov_increment = 0.0f;
@@ -204,6 +205,7 @@ Analog_Value_COV_Detect(struct analog_value_descr *pObject, float value)
         }
         if (cov_delta >= cov_increment) {
             pObject->Changed = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
             pObject->Prior_Value = value;
         }
     }
@@ -228,7 +230,7 @@ bool Analog_Value_Present_Value_Set(
     (void)priority;
     pObject = Analog_Value_Object(object_instance);
     if (pObject) {
-        Analog_Value_COV_Detect(pObject, value);
+        Analog_Value_COV_Detect(object_instance, pObject, value);
         pObject->Present_Value = value;
         status = true;
     }
@@ -474,6 +476,7 @@ bool Analog_Value_Reliability_Set(
         pObject->Reliability = value;
         if (fault != Analog_Value_Object_Fault(pObject)) {
             pObject->Changed = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
         }
         status = true;
     }
@@ -594,7 +597,8 @@ void Analog_Value_COV_Increment_Set(uint32_t object_instance, float value)
     pObject = Analog_Value_Object(object_instance);
     if (pObject) {
         pObject->COV_Increment = value;
-        Analog_Value_COV_Detect(pObject, pObject->Present_Value);
+        Analog_Value_COV_Detect(
+            object_instance, pObject, pObject->Present_Value);
     }
 }
 
@@ -674,6 +678,7 @@ void Analog_Value_Out_Of_Service_Set(uint32_t object_instance, bool value)
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
             pObject->Changed = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
         }
         pObject->Out_Of_Service = value;
     }
@@ -1125,6 +1130,22 @@ void Analog_Value_Write_Present_Value_Callback_Set(
     Analog_Value_Write_Present_Value_Callback = cb;
 }
 
+#if defined(INTRINSIC_REPORTING)
+/**
+ * @brief Determine if the event state of an Analog Value is active: an
+ *  Event_State that is not NORMAL, or a transition not acknowledged
+ * @param pObject - object data
+ * @return true if the event state is active
+ */
+static bool Analog_Value_Active_Event(const ANALOG_VALUE_DESCR *pObject)
+{
+    return (pObject->Event_State != EVENT_STATE_NORMAL) ||
+        !pObject->Acked_Transitions[TRANSITION_TO_OFFNORMAL].bIsAcked ||
+        !pObject->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ||
+        !pObject->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked;
+}
+#endif
+
 /**
  * @brief Analog Value intrinsic reporting function.
  * @param object_instance [in] BACnet object-instance number of the object
@@ -1140,6 +1161,7 @@ void Analog_Value_Intrinsic_Reporting(uint32_t object_instance)
     float ExceededLimit = 0.0f;
     float PresentVal = 0.0f;
     bool SendNotify = false;
+    bool ActiveEvent = false;
 
     CurrentAV = Analog_Value_Object(object_instance);
     if (!CurrentAV) {
@@ -1150,6 +1172,7 @@ void Analog_Value_Intrinsic_Reporting(uint32_t object_instance)
     if (!CurrentAV->Event_Detection_Enable) {
         return; /* limits are not configured */
     }
+    ActiveEvent = Analog_Value_Active_Event(CurrentAV);
 
     if (CurrentAV->Ack_notify_data.bSendAckNotify) {
         /* clean bSendAckNotify flag */
@@ -1476,6 +1499,10 @@ void Analog_Value_Intrinsic_Reporting(uint32_t object_instance)
             }
         }
     }
+    if (Analog_Value_Active_Event(CurrentAV) != ActiveEvent) {
+        handler_get_event_information_active_set(
+            Object_Type, object_instance, !ActiveEvent);
+    }
 #else
     (void)object_instance;
 #endif /* defined(INTRINSIC_REPORTING) */
@@ -1570,6 +1597,7 @@ int Analog_Value_Alarm_Ack(
     BACNET_ALARM_ACK_DATA *alarmack_data, BACNET_ERROR_CODE *error_code)
 {
     ANALOG_VALUE_DESCR *CurrentAV;
+    bool ActiveEvent;
 
     if (!alarmack_data) {
         return -1;
@@ -1580,6 +1608,7 @@ int Analog_Value_Alarm_Ack(
         *error_code = ERROR_CODE_UNKNOWN_OBJECT;
         return -1;
     }
+    ActiveEvent = Analog_Value_Active_Event(CurrentAV);
     switch (alarmack_data->eventStateAcked) {
         case EVENT_STATE_OFFNORMAL:
         case EVENT_STATE_HIGH_LIMIT:
@@ -1669,6 +1698,12 @@ int Analog_Value_Alarm_Ack(
     CurrentAV->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
 
     /* Return OK */
+    if (Analog_Value_Active_Event(CurrentAV) != ActiveEvent) {
+        handler_get_event_information_active_set(
+            Object_Type, alarmack_data->eventObjectIdentifier.instance,
+            !ActiveEvent);
+    }
+
     return 1;
 }
 
@@ -1793,6 +1828,10 @@ bool Analog_Value_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
+#if defined(INTRINSIC_REPORTING)
+        handler_get_event_information_active_set(
+            Object_Type, object_instance, false);
+#endif
         free(pObject);
         status = true;
     }
@@ -1831,6 +1870,8 @@ void Analog_Value_Init(void)
     /* Set handler for GetEventInformation function */
     handler_get_event_information_set(
         Object_Type, Analog_Value_Event_Information);
+    handler_get_event_information_index_set(
+        Object_Type, Analog_Value_Instance_To_Index);
     /* Set handler for AcknowledgeAlarm function */
     handler_alarm_ack_set(Object_Type, Analog_Value_Alarm_Ack);
     /* Set handler for GetAlarmSummary Service */
@@ -183,6 +183,7 @@ bool BitString_Value_Present_Value_Set(
     if (pObject) {
         if (!bitstring_same(&pObject->Present_Value, value)) {
             pObject->Change_Of_Value = true;
+            COV_CHANGE_NOTIFY(OBJECT_BITSTRING_VALUE, object_instance);
         }
         status = bitstring_copy(&pObject->Present_Value, value);
     }
@@ -264,15 +265,17 @@ bool BitString_Value_Out_Of_Service(uint32_t object_instance)
 
 /**
  * @brief For a given object instance-number, checks the out-of-service for COV
+ * @param  object_instance - object-instance number of the object
  * @param  pObject - specific object with valid data
  * @param  value - out-of-service value
  */
 static void BitString_Value_Out_Of_Service_COV_Detect(
-    struct object_data *pObject, bool value)
+    uint32_t object_instance, struct object_data *pObject, bool value)
 {
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
             pObject->Change_Of_Value = true;
+            COV_CHANGE_NOTIFY(OBJECT_BITSTRING_VALUE, object_instance);
         }
     }
 }
@@ -288,7 +291,8 @@ void BitString_Value_Out_Of_Service_Set(uint32_t object_instance, bool value)
 
     pObject = BitString_Value_Object(object_instance);
     if (pObject) {
-        BitString_Value_Out_Of_Service_COV_Detect(pObject, value);
+        BitString_Value_Out_Of_Service_COV_Detect(
+            object_instance, pObject, value);
         pObject->Out_Of_Service = value;
     }
 
@@ -318,7 +322,8 @@ static bool BitString_Value_Out_Of_Service_Write(
     pObject = BitString_Value_Object(object_instance);
     if (pObject) {
         if (pObject->Write_Enabled) {
-            BitString_Value_Out_Of_Service_COV_Detect(pObject, value);
+            BitString_Value_Out_Of_Service_COV_Detect(
+                object_instance, pObject, value);
             pObject->Out_Of_Service = value;
             status = true;
         } else {
@@ -388,6 +393,7 @@ bool BitString_Value_Reliablity_Set(
             pObject->Reliability = value;
             if (fault != BitString_Value_Object_Fault(pObject)) {
                 pObject->Change_Of_Value = true;
+                COV_CHANGE_NOTIFY(OBJECT_BITSTRING_VALUE, object_instance);
             }
             status = true;
         }
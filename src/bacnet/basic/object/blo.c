@@ -20,6 +20,7 @@
 #include "bacnet/lighting.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/timer_wheel.h"
 #include "bacnet/proplist.h"
 /* me! */
 #include "bacnet/basic/object/blo.h"
@@ -43,6 +44,7 @@ struct object_data {
     BACNET_BINARY_LIGHTING_PV Target_Value;
     uint8_t Target_Priority;
     uint32_t Egress_Timer;
+    struct timer_wheel_entry Timer_Entry;
     /* bit properties */
     bool Out_Of_Service : 1;
     bool Blink_Warn_Enable : 1;
@@ -56,6 +58,12 @@ static binary_lighting_output_write_value_callback
     Binary_Lighting_Output_Write_Value_Callback;
 static binary_lighting_output_blink_warn_callback
     Binary_Lighting_Output_Blink_Warn_Callback;
+/* milliseconds between updates while a target value or egress is pending */
+#ifndef BINARY_LIGHTING_OUTPUT_TIMER_INTERVAL
+#define BINARY_LIGHTING_OUTPUT_TIMER_INTERVAL 1000
+#endif
+/* timers of the objects with a target value or egress pending */
+static struct timer_wheel Timer_Wheel;
 
 /* These arrays are used by the ReadPropertyMultiple handler and
    property-list property (as of protocol-revision 14) */
@@ -627,6 +635,66 @@ void Binary_Lighting_Output_Timer(
     }
 }
 
+/**
+ * @brief Start the object timer if a target value or egress is pending
+ * @param pObject [in] object data
+ */
+static void Binary_Lighting_Output_Timer_Schedule(struct object_data *pObject)
+{
+    bool active = false;
+
+    if (pObject->Egress_Timer > 0) {
+        active = true;
+    } else {
+        switch (pObject->Target_Value) {
+            case BINARY_LIGHTING_PV_OFF:
+            case BINARY_LIGHTING_PV_ON:
+            case BINARY_LIGHTING_PV_WARN:
+                active = true;
+                break;
+            default:
+                break;
+        }
+    }
+    if (active && !timer_wheel_running(&pObject->Timer_Entry)) {
+        timer_wheel_start(
+            &Timer_Wheel, &pObject->Timer_Entry,
+            BINARY_LIGHTING_OUTPUT_TIMER_INTERVAL);
+    }
+}
+
+/**
+ * @brief Updates an object whose timer expired, and starts the timer
+ *  again while its target value or egress is pending
+ * @param entry - timer of the object
+ * @param milliseconds - number of milliseconds since the timer was started
+ */
+static void Binary_Lighting_Output_Timer_Callback(
+    struct timer_wheel_entry *entry, uint32_t milliseconds)
+{
+    struct object_data *pObject;
+
+    if (milliseconds > UINT16_MAX) {
+        milliseconds = UINT16_MAX;
+    }
+    Binary_Lighting_Output_Timer(entry->key, (uint16_t)milliseconds);
+    pObject = Keylist_Data(Object_List, entry->key);
+    if (pObject) {
+        Binary_Lighting_Output_Timer_Schedule(pObject);
+    }
+}
+
+/**
+ * @brief Updates the feedback value of only the lighting objects with a
+ *  target value or egress pending, rather than every object.
+ * @param milliseconds - number of milliseconds elapsed since previously
+ * called.  Suggest that this is called every 1000 milliseconds.
+ */
+void Binary_Lighting_Output_Timer_Task(uint16_t milliseconds)
+{
+    timer_wheel_elapsed(&Timer_Wheel, milliseconds);
+}
+
 /**
  * For a given object instance-number, writes the present-value
  *
@@ -665,6 +733,7 @@ static bool Binary_Lighting_Output_Present_Value_Write(
                     /* ON or OFF only */
                     Present_Value_On_Off_Handler(object_instance);
                 }
+                Binary_Lighting_Output_Timer_Schedule(pObject);
                 status = true;
             } else if (
                 (value >= BINARY_LIGHTING_PV_PROPRIETARY_MIN) &&
@@ -900,6 +969,7 @@ bool Binary_Lighting_Output_Lighting_Command_Set(
     if (pObject) {
         pObject->Target_Priority = priority;
         pObject->Target_Value = value;
+        Binary_Lighting_Output_Timer_Schedule(pObject);
     }
 
     return status;
@@ -1509,12 +1579,16 @@ uint32_t Binary_Lighting_Output_Create(uint32_t object_instance)
         }
         pObject->Relinquish_Default = BINARY_LIGHTING_PV_OFF;
         pObject->Power = 0.0;
+        timer_wheel_entry_init(
+            &pObject->Timer_Entry, Binary_Lighting_Output_Timer_Callback,
+            object_instance);
         /* add to list */
         index = Keylist_Data_Add(Object_List, object_instance, pObject);
         if (index < 0) {
             free(pObject);
             return BACNET_MAX_INSTANCE;
         }
+        Binary_Lighting_Output_Timer_Schedule(pObject);
     }
 
     return object_instance;
@@ -1532,6 +1606,7 @@ bool Binary_Lighting_Output_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
+        timer_wheel_stop(&Timer_Wheel, &pObject->Timer_Entry);
         free(pObject);
         status = true;
     }
@@ -1550,6 +1625,7 @@ void Binary_Lighting_Output_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
+                timer_wheel_stop(&Timer_Wheel, &pObject->Timer_Entry);
                 free(pObject);
             }
         } while (pObject);
@@ -1565,5 +1641,6 @@ void Binary_Lighting_Output_Init(void)
 {
     if (!Object_List) {
         Object_List = Keylist_Create();
+        timer_wheel_init(&Timer_Wheel, BINARY_LIGHTING_OUTPUT_TIMER_INTERVAL);
     }
 }
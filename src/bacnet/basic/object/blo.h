@@ -137,6 +137,8 @@ bool Binary_Lighting_Output_Egress_Active(uint32_t object_instance);
 BACNET_STACK_EXPORT
 void Binary_Lighting_Output_Timer(
     uint32_t object_instance, uint16_t milliseconds);
+BACNET_STACK_EXPORT
+void Binary_Lighting_Output_Timer_Task(uint16_t milliseconds);
 
 BACNET_STACK_EXPORT
 void Binary_Lighting_Output_Write_Value_Callback_Set(
@@ -310,6 +310,7 @@ bool Binary_Output_Present_Value_Set(
             new_value = Object_Present_Value(pObject);
             if (old_value != new_value) {
                 pObject->Changed = true;
+                COV_CHANGE_NOTIFY(Object_Type, object_instance);
             }
         }
     }
@@ -344,6 +345,7 @@ bool Binary_Output_Present_Value_Relinquish(
             new_value = Object_Present_Value(pObject);
             if (old_value != new_value) {
                 pObject->Changed = true;
+                COV_CHANGE_NOTIFY(Object_Type, object_instance);
             }
             status = true;
         }
@@ -503,6 +505,7 @@ void Binary_Output_Out_Of_Service_Set(uint32_t object_instance, bool value)
         if (pObject->Out_Of_Service != value) {
             pObject->Out_Of_Service = value;
             pObject->Changed = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
         }
     }
 }
@@ -748,6 +751,7 @@ bool Binary_Output_Reliability_Set(
             pObject->Reliability = value;
             if (fault != Binary_Output_Object_Fault(pObject)) {
                 pObject->Changed = true;
+                COV_CHANGE_NOTIFY(Object_Type, object_instance);
             }
             status = true;
         }
@@ -242,15 +242,19 @@ BACNET_BINARY_PV Binary_Value_Present_Value(uint32_t object_instance)
 
 /**
  * @brief For a given object instance-number, checks the present-value for COV
+ * @param  object_instance - object-instance number of the object
  * @param  pObject - specific object with valid data
  * @param  value - binary value
  */
 static void Binary_Value_Present_Value_COV_Detect(
-    struct object_data *pObject, BACNET_BINARY_PV value)
+    uint32_t object_instance,
+    struct object_data *pObject,
+    BACNET_BINARY_PV value)
 {
     if (pObject) {
         if (Binary_Present_Value(pObject->Present_Value) != value) {
             pObject->Change_Of_Value = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
         }
     }
 }
@@ -289,6 +293,7 @@ void Binary_Value_Out_Of_Service_Set(uint32_t object_instance, bool value)
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
             pObject->Change_Of_Value = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
         }
         pObject->Out_Of_Service = value;
     }
@@ -355,6 +360,7 @@ bool Binary_Value_Reliability_Set(
             pObject->Reliability = value;
             if (fault != Binary_Value_Object_Fault(pObject)) {
                 pObject->Change_Of_Value = true;
+                COV_CHANGE_NOTIFY(Object_Type, object_instance);
             }
             status = true;
         }
@@ -462,7 +468,8 @@ bool Binary_Value_Present_Value_Set(
     pObject = Binary_Value_Object(object_instance);
     if (pObject) {
         if (value <= MAX_BINARY_PV) {
-            Binary_Value_Present_Value_COV_Detect(pObject, value);
+            Binary_Value_Present_Value_COV_Detect(
+                object_instance, pObject, value);
             pObject->Present_Value = Binary_Present_Value_Boolean(value);
             status = true;
         }
@@ -496,7 +503,8 @@ static bool Binary_Value_Present_Value_Write(
         if (value <= MAX_BINARY_PV) {
             if (pObject->Write_Enabled) {
                 old_value = Binary_Present_Value(pObject->Present_Value);
-                Binary_Value_Present_Value_COV_Detect(pObject, value);
+                Binary_Value_Present_Value_COV_Detect(
+                    object_instance, pObject, value);
                 pObject->Present_Value = Binary_Present_Value_Boolean(value);
                 if (pObject->Out_Of_Service) {
                     /* The physical point that the object represents
@@ -1238,6 +1246,8 @@ uint32_t Binary_Value_Create(uint32_t object_instance)
             /* Set handler for GetEventInformation function */
             handler_get_event_information_set(
                 Object_Type, Binary_Value_Event_Information);
+            handler_get_event_information_index_set(
+                Object_Type, Binary_Value_Instance_To_Index);
             /* Set handler for AcknowledgeAlarm function */
             handler_alarm_ack_set(Object_Type, Binary_Value_Alarm_Ack);
             /* Set handler for GetAlarmSummary Service */
@@ -1287,6 +1297,10 @@ bool Binary_Value_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
+#if defined(INTRINSIC_REPORTING) && (BINARY_VALUE_INTRINSIC_REPORTING)
+        handler_get_event_information_active_set(
+            Object_Type, object_instance, false);
+#endif
         free(pObject);
         status = true;
     }
@@ -1555,10 +1569,25 @@ int Binary_Value_Event_Information(
     }
 }
 
+/**
+ * @brief Determine if the event state of a Binary Value is active: an
+ *  Event_State that is not NORMAL, or a transition not acknowledged
+ * @param pObject - object data
+ * @return true if the event state is active
+ */
+static bool Binary_Value_Active_Event(const struct object_data *pObject)
+{
+    return (pObject->Event_State != EVENT_STATE_NORMAL) ||
+        !pObject->Acked_Transitions[TRANSITION_TO_OFFNORMAL].bIsAcked ||
+        !pObject->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ||
+        !pObject->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked;
+}
+
 int Binary_Value_Alarm_Ack(
     BACNET_ALARM_ACK_DATA *alarmack_data, BACNET_ERROR_CODE *error_code)
 {
     struct object_data *pObject = NULL;
+    bool ActiveEvent;
 
     if (!alarmack_data) {
         return -1;
@@ -1570,6 +1599,7 @@ int Binary_Value_Alarm_Ack(
         *error_code = ERROR_CODE_UNKNOWN_OBJECT;
         return -1;
     }
+    ActiveEvent = Binary_Value_Active_Event(pObject);
 
     switch (alarmack_data->eventStateAcked) {
         case EVENT_STATE_OFFNORMAL:
@@ -1652,6 +1682,12 @@ int Binary_Value_Alarm_Ack(
     pObject->Ack_notify_data.bSendAckNotify = true;
     pObject->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
 
+    if (Binary_Value_Active_Event(pObject) != ActiveEvent) {
+        handler_get_event_information_active_set(
+            Object_Type, alarmack_data->eventObjectIdentifier.instance,
+            !ActiveEvent);
+    }
+
     return 1;
 }
 
@@ -1836,6 +1872,7 @@ void Binary_Value_Intrinsic_Reporting(uint32_t object_instance)
     uint8_t ToState = 0;
     BACNET_BINARY_PV PresentVal = BINARY_INACTIVE;
     bool SendNotify = false;
+    bool ActiveEvent = false;
     struct object_data *pObject = Binary_Value_Object(object_instance);
 
     if (!pObject) {
@@ -1846,6 +1883,7 @@ void Binary_Value_Intrinsic_Reporting(uint32_t object_instance)
     if (!pObject->Event_Detection_Enable) {
         return; /* limits are not configured */
     }
+    ActiveEvent = Binary_Value_Active_Event(pObject);
 
     if (pObject->Ack_notify_data.bSendAckNotify) {
         /* clean bSendAckNotify flag */
@@ -2091,6 +2129,10 @@ void Binary_Value_Intrinsic_Reporting(uint32_t object_instance)
             }
         }
     }
+    if (Binary_Value_Active_Event(pObject) != ActiveEvent) {
+        handler_get_event_information_active_set(
+            Object_Type, object_instance, !ActiveEvent);
+    }
 #endif /* defined(INTRINSIC_REPORTING) && (BINARY_VALUE_INTRINSIC_REPORTING) \
         */
 }
@@ -30,6 +30,7 @@
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
 #include "bacnet/basic/sys/linear.h"
+#include "bacnet/basic/sys/timer_wheel.h"
 /* me! */
 #include "bacnet/basic/object/color_object.h"
 
@@ -53,6 +54,7 @@ struct object_data {
     uint32_t Default_Fade_Time;
     /* The transition may be NONE or FADE. */
     BACNET_COLOR_TRANSITION Transition;
+    struct timer_wheel_entry Timer_Entry;
     const char *Object_Name;
     const char *Description;
 };
@@ -60,6 +62,12 @@ struct object_data {
 static OS_Keylist Object_List;
 /* callback for present value writes */
 static color_write_present_value_callback Color_Write_Present_Value_Callback;
+/* milliseconds between updates while a color operation is in progress */
+#ifndef COLOR_TIMER_INTERVAL
+#define COLOR_TIMER_INTERVAL 10
+#endif
+/* timers of the objects with a color operation in progress */
+static struct timer_wheel Timer_Wheel;
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Color_Properties_Required[] = {
@@ -206,6 +214,30 @@ bool Color_Present_Value_Set(
     return status;
 }
 
+/**
+ * @brief Start the object timer if a color operation is in progress
+ * @param pObject [in] object data
+ */
+static void Color_Timer_Schedule(struct object_data *pObject)
+{
+    bool active = true;
+
+    switch (pObject->Color_Command.operation) {
+        case BACNET_COLOR_OPERATION_NONE:
+        case BACNET_COLOR_OPERATION_STOP:
+            /* one more update returns the in-progress to idle */
+            active =
+                pObject->In_Progress != BACNET_COLOR_OPERATION_IN_PROGRESS_IDLE;
+            break;
+        default:
+            break;
+    }
+    if (active && !timer_wheel_running(&pObject->Timer_Entry)) {
+        timer_wheel_start(
+            &Timer_Wheel, &pObject->Timer_Entry, COLOR_TIMER_INTERVAL);
+    }
+}
+
 /**
  * For a given object instance-number, writes to the present-value
  *
@@ -240,6 +272,7 @@ static bool Color_Present_Value_Write(
         }
         pObject->Color_Command.operation = BACNET_COLOR_OPERATION_FADE_TO_COLOR;
         xy_color_copy(&pObject->Color_Command.target.color, value);
+        Color_Timer_Schedule(pObject);
         status = true;
     } else {
         *error_class = ERROR_CLASS_OBJECT;
@@ -330,6 +363,7 @@ bool Color_Command_Set(
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject && value) {
         color_command_copy(&pObject->Color_Command, value);
+        Color_Timer_Schedule(pObject);
         status = true;
     }
 
@@ -362,6 +396,7 @@ static bool Color_Command_Write(
         (void)priority;
         if (pObject->Write_Enabled) {
             color_command_copy(&pObject->Color_Command, value);
+            Color_Timer_Schedule(pObject);
             status = true;
         } else {
             *error_class = ERROR_CLASS_PROPERTY;
@@ -890,6 +925,39 @@ void Color_Timer(uint32_t object_instance, uint16_t milliseconds)
     }
 }
 
+/**
+ * Updates a color object whose timer expired, and starts the timer
+ * again while its color operation is in progress
+ *
+ * @param entry - timer of the object
+ * @param milliseconds - number of milliseconds since the timer was started
+ */
+static void
+Color_Timer_Callback(struct timer_wheel_entry *entry, uint32_t milliseconds)
+{
+    struct object_data *pObject;
+
+    if (milliseconds > UINT16_MAX) {
+        milliseconds = UINT16_MAX;
+    }
+    Color_Timer(entry->key, (uint16_t)milliseconds);
+    pObject = Keylist_Data(Object_List, entry->key);
+    if (pObject) {
+        Color_Timer_Schedule(pObject);
+    }
+}
+
+/**
+ * Updates the tracking value of only the color objects with a
+ * fade in progress, rather than every object.
+ *
+ * @param milliseconds - number of milliseconds elapsed
+ */
+void Color_Timer_Task(uint16_t milliseconds)
+{
+    timer_wheel_elapsed(&Timer_Wheel, milliseconds);
+}
+
 /**
  * ReadProperty handler for this object.  For the given ReadProperty
  * data, the application_data is loaded or the error flags are set.
@@ -1172,12 +1240,15 @@ uint32_t Color_Create(uint32_t object_instance)
             pObject->Transition = BACNET_COLOR_TRANSITION_FADE;
             pObject->Changed = false;
             pObject->Write_Enabled = false;
+            timer_wheel_entry_init(
+                &pObject->Timer_Entry, Color_Timer_Callback, object_instance);
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
                 free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
+            Color_Timer_Schedule(pObject);
         } else {
             return BACNET_MAX_INSTANCE;
         }
@@ -1198,6 +1269,7 @@ bool Color_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
+        timer_wheel_stop(&Timer_Wheel, &pObject->Timer_Entry);
         free(pObject);
         status = true;
     }
@@ -1216,6 +1288,7 @@ void Color_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
+                timer_wheel_stop(&Timer_Wheel, &pObject->Timer_Entry);
                 free(pObject);
             }
         } while (pObject);
@@ -1231,5 +1304,6 @@ void Color_Init(void)
 {
     if (!Object_List) {
         Object_List = Keylist_Create();
+        timer_wheel_init(&Timer_Wheel, COLOR_TIMER_INTERVAL);
     }
 }
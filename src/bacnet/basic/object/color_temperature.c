@@ -29,6 +29,7 @@
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/keylist.h"
 #include "bacnet/basic/sys/linear.h"
+#include "bacnet/basic/sys/timer_wheel.h"
 /* me! */
 #include "color_temperature.h"
 
@@ -46,6 +47,7 @@ struct object_data {
     BACNET_COLOR_TRANSITION Transition;
     uint32_t Present_Value_Minimum;
     uint32_t Present_Value_Maximum;
+    struct timer_wheel_entry Timer_Entry;
     const char *Object_Name;
     const char *Description;
 };
@@ -54,6 +56,12 @@ static OS_Keylist Object_List;
 /* callback for present value writes */
 static color_temperature_write_present_value_callback
     Color_Temperature_Write_Present_Value_Callback;
+/* milliseconds between updates while a color operation is in progress */
+#ifndef COLOR_TEMPERATURE_TIMER_INTERVAL
+#define COLOR_TEMPERATURE_TIMER_INTERVAL 10
+#endif
+/* timers of the objects with a color operation in progress */
+static struct timer_wheel Timer_Wheel;
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Color_Temperature_Properties_Required[] = {
@@ -207,6 +215,33 @@ bool Color_Temperature_Present_Value_Set(
     return status;
 }
 
+/**
+ * @brief Start the object timer if a color operation is in progress
+ * @param pObject [in] object data
+ */
+static void Color_Temperature_Timer_Schedule(struct object_data *pObject)
+{
+    bool active = true;
+
+    switch (pObject->Color_Command.operation) {
+        case BACNET_COLOR_OPERATION_FADE_TO_CCT:
+        case BACNET_COLOR_OPERATION_RAMP_TO_CCT:
+        case BACNET_COLOR_OPERATION_STEP_UP_CCT:
+        case BACNET_COLOR_OPERATION_STEP_DOWN_CCT:
+            break;
+        default:
+            /* one more update returns the in-progress to idle */
+            active =
+                pObject->In_Progress != BACNET_COLOR_OPERATION_IN_PROGRESS_IDLE;
+            break;
+    }
+    if (active && !timer_wheel_running(&pObject->Timer_Entry)) {
+        timer_wheel_start(
+            &Timer_Wheel, &pObject->Timer_Entry,
+            COLOR_TEMPERATURE_TIMER_INTERVAL);
+    }
+}
+
 /**
  * For a given object instance-number, sets the present-value
  *
@@ -251,6 +286,7 @@ static bool Color_Temperature_Present_Value_Write(
                     BACNET_COLOR_OPERATION_FADE_TO_CCT;
             }
             pObject->Color_Command.target.color_temperature = value;
+            Color_Temperature_Timer_Schedule(pObject);
             status = true;
         } else {
             *error_class = ERROR_CLASS_PROPERTY;
@@ -429,6 +465,7 @@ bool Color_Temperature_Command_Set(
     pObject = Keylist_Data(Object_List, object_instance);
     if (pObject && value) {
         color_command_copy(&pObject->Color_Command, value);
+        Color_Temperature_Timer_Schedule(pObject);
         status = true;
     }
 
@@ -1299,6 +1336,39 @@ void Color_Temperature_Timer(uint32_t object_instance, uint16_t milliseconds)
     }
 }
 
+/**
+ * Updates a color temperature object whose timer expired, and starts
+ * the timer again while its color operation is in progress
+ *
+ * @param entry - timer of the object
+ * @param milliseconds - number of milliseconds since the timer was started
+ */
+static void Color_Temperature_Timer_Callback(
+    struct timer_wheel_entry *entry, uint32_t milliseconds)
+{
+    struct object_data *pObject;
+
+    if (milliseconds > UINT16_MAX) {
+        milliseconds = UINT16_MAX;
+    }
+    Color_Temperature_Timer(entry->key, (uint16_t)milliseconds);
+    pObject = Keylist_Data(Object_List, entry->key);
+    if (pObject) {
+        Color_Temperature_Timer_Schedule(pObject);
+    }
+}
+
+/**
+ * Updates the tracking value of only the color temperature objects with
+ * a ramp or fade or step in progress, rather than every object.
+ *
+ * @param milliseconds - number of milliseconds elapsed
+ */
+void Color_Temperature_Timer_Task(uint16_t milliseconds)
+{
+    timer_wheel_elapsed(&Timer_Wheel, milliseconds);
+}
+
 /**
  * ReadProperty handler for this object.  For the given ReadProperty
  * data, the application_data is loaded or the error flags are set.
@@ -1619,12 +1689,16 @@ uint32_t Color_Temperature_Create(uint32_t object_instance)
                 pObject->Default_Color_Temperature;
             pObject->Changed = false;
             pObject->Write_Enabled = false;
+            timer_wheel_entry_init(
+                &pObject->Timer_Entry, Color_Temperature_Timer_Callback,
+                object_instance);
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
             if (index < 0) {
                 free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
+            Color_Temperature_Timer_Schedule(pObject);
         } else {
             return BACNET_MAX_INSTANCE;
         }
@@ -1645,6 +1719,7 @@ bool Color_Temperature_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
+        timer_wheel_stop(&Timer_Wheel, &pObject->Timer_Entry);
         free(pObject);
         status = true;
     }
@@ -1663,6 +1738,7 @@ void Color_Temperature_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
+                timer_wheel_stop(&Timer_Wheel, &pObject->Timer_Entry);
                 free(pObject);
             }
         } while (pObject);
@@ -1678,5 +1754,6 @@ void Color_Temperature_Init(void)
 {
     if (!Object_List) {
         Object_List = Keylist_Create();
+        timer_wheel_init(&Timer_Wheel, COLOR_TEMPERATURE_TIMER_INTERVAL);
     }
 }
@@ -348,6 +348,7 @@ void CharacterString_Value_Out_Of_Service_Set(
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
             pObject->Changed = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
             /* Lets backup Present_Value when going Out_Of_Service  or restore
              * when going out of Out_Of_Service */
             if ((pObject->Out_Of_Service = value)) {
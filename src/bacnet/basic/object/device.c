@@ -8,6 +8,7 @@
  */
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
@@ -72,6 +73,16 @@ extern int Routed_Device_Read_Property_Local(BACNET_READ_PROPERTY_DATA *rpdata);
 extern bool
 Routed_Device_Write_Property_Local(BACNET_WRITE_PROPERTY_DATA *wp_data);
 
+/* Define BACNET_DEVICE_OBJECT_INDEX to keep the Object_List identifiers
+   in a flat array and the object names in a hash, so that an Object_List
+   element or an Object_Name is found without walking every object type.
+   Objects created or renamed directly through an object API, rather than
+   through CreateObject or WriteProperty, are found again once the object
+   count or the Database_Revision changes. */
+#ifndef BACNET_DEVICE_OBJECT_INDEX
+#define BACNET_DEVICE_OBJECT_INDEX 0
+#endif
+
 /* may be overridden by outside table */
 static object_functions_t *Object_Table;
 
@@ -503,7 +514,11 @@ static const int Device_Properties_Required[] = {
     PROP_OBJECT_LIST, PROP_MAX_APDU_LENGTH_ACCEPTED,
     PROP_SEGMENTATION_SUPPORTED, PROP_APDU_TIMEOUT,
     PROP_NUMBER_OF_APDU_RETRIES, PROP_DEVICE_ADDRESS_BINDING,
-    PROP_DATABASE_REVISION, -1
+    PROP_DATABASE_REVISION,
+#if BACNET_SEGMENTATION_ENABLED
+    PROP_MAX_SEGMENTS_ACCEPTED, PROP_APDU_SEGMENT_TIMEOUT,
+#endif
+    -1
 };
 
 static const int Device_Properties_Optional[] = {
@@ -521,6 +536,10 @@ static const int Device_Properties_Optional[] = {
 };
 
 static const int Device_Properties_Proprietary[] = {
+#if BACNET_APDU_STATISTICS
+    PROP_DEVICE_CONFIRMED_REQUESTS, PROP_DEVICE_CONFIRMED_FAILURES,
+    PROP_DEVICE_CONFIRMED_LATENCY, PROP_DEVICE_UNCONFIRMED_REQUESTS,
+#endif
     -1
 };
 /* clang-format on */
@@ -616,6 +635,24 @@ static uint32_t Interval_Offset_Minutes;
 /* Max_Info_Frames - rely on MS/TP subsystem, if there is one */
 /* Device_Address_Binding - required, but relies on binding cache */
 static uint32_t Database_Revision = 0;
+#if BACNET_DEVICE_OBJECT_INDEX
+/* Object_List identifiers, in Object_List order */
+static BACNET_OBJECT_ID *Object_List_Index;
+static uint32_t Object_List_Index_Count;
+static uint32_t Object_List_Index_Size;
+/* open addressed hash of the object names, linear probing */
+struct object_name_slot {
+    uint32_t hash;
+    uint32_t instance;
+    BACNET_OBJECT_TYPE type; /* OBJECT_NONE when empty */
+};
+static struct object_name_slot *Object_Name_Index;
+static uint32_t Object_Name_Index_Count;
+static uint32_t Object_Name_Index_Size; /* zero or a power of two */
+/* Database_Revision at the time the index was last brought up to date */
+static uint32_t Object_Index_Revision;
+static bool Object_Index_Valid;
+#endif
 /* Configuration_Files */
 /* Last_Restore_Time */
 /* Backup_Failure_Timeout */
@@ -1044,7 +1081,11 @@ uint8_t Device_Protocol_Revision(void)
 
 BACNET_SEGMENTATION Device_Segmentation_Supported(void)
 {
+#if BACNET_SEGMENTATION_ENABLED
+    return SEGMENTATION_BOTH;
+#else
     return SEGMENTATION_NONE;
+#endif
 }
 
 uint32_t Device_Database_Revision(void)
@@ -1089,6 +1130,411 @@ unsigned Device_Object_List_Count(void)
     return count;
 }
 
+#if BACNET_DEVICE_OBJECT_INDEX
+/**
+ * @brief Hash an object name with FNV-1a
+ * @param object_name [in] The object name to hash
+ * @return hash of the character set and the name octets
+ */
+static uint32_t
+Device_Object_Name_Hash(const BACNET_CHARACTER_STRING *object_name)
+{
+    uint32_t hash = 2166136261UL;
+    const char *value;
+    size_t length, i;
+
+    hash ^= characterstring_encoding(object_name);
+    hash *= 16777619UL;
+    value = characterstring_value(object_name);
+    length = characterstring_length(object_name);
+    for (i = 0; i < length; i++) {
+        hash ^= (uint8_t)value[i];
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Add an object name to the name index
+ * @param object_type [in] The object type
+ * @param object_instance [in] The object instance number
+ * @note the caller keeps the name index at most half full
+ */
+static void Device_Object_Name_Index_Insert(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    BACNET_CHARACTER_STRING object_name;
+    struct object_name_slot *slot;
+    uint32_t hash, mask, i;
+
+    if (!Device_Object_Name_Copy(object_type, object_instance, &object_name)) {
+        return;
+    }
+    hash = Device_Object_Name_Hash(&object_name);
+    mask = Object_Name_Index_Size - 1;
+    i = hash & mask;
+    while (Object_Name_Index[i].type != OBJECT_NONE) {
+        i = (i + 1) & mask;
+    }
+    slot = &Object_Name_Index[i];
+    slot->hash = hash;
+    slot->type = object_type;
+    slot->instance = object_instance;
+    Object_Name_Index_Count++;
+}
+
+/**
+ * @brief Remove an object name from the name index
+ * @param object_type [in] The object type
+ * @param object_instance [in] The object instance number
+ * @param object_name [in] The name the object had when it was indexed
+ * @return true if the object was found under that name
+ */
+static bool Device_Object_Name_Index_Remove(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    const BACNET_CHARACTER_STRING *object_name)
+{
+    uint32_t hash, mask, home, i, j;
+
+    hash = Device_Object_Name_Hash(object_name);
+    mask = Object_Name_Index_Size - 1;
+    i = hash & mask;
+    while (Object_Name_Index[i].type != OBJECT_NONE) {
+        if ((Object_Name_Index[i].type == object_type) &&
+            (Object_Name_Index[i].instance == object_instance)) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    if (Object_Name_Index[i].type == OBJECT_NONE) {
+        return false;
+    }
+    /* shift back any later slot of the probe run that may fill the gap */
+    j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (Object_Name_Index[j].type == OBJECT_NONE) {
+            break;
+        }
+        home = Object_Name_Index[j].hash & mask;
+        if ((i <= j) ? ((i < home) && (home <= j))
+                     : ((i < home) || (home <= j))) {
+            continue;
+        }
+        Object_Name_Index[i] = Object_Name_Index[j];
+        i = j;
+    }
+    Object_Name_Index[i].type = OBJECT_NONE;
+    Object_Name_Index_Count--;
+
+    return true;
+}
+
+/**
+ * @brief Rebuild the name index from the Object_List index
+ * @return true if the name index could be allocated
+ */
+static bool Device_Object_Name_Index_Build(void)
+{
+    struct object_name_slot *slots;
+    uint32_t size = 16;
+    uint32_t i;
+
+    while (size < (Object_List_Index_Count * 2)) {
+        size *= 2;
+    }
+    if (size != Object_Name_Index_Size) {
+        slots = realloc(Object_Name_Index, size * sizeof(*slots));
+        if (!slots) {
+            return false;
+        }
+        Object_Name_Index = slots;
+        Object_Name_Index_Size = size;
+    }
+    for (i = 0; i < Object_Name_Index_Size; i++) {
+        Object_Name_Index[i].type = OBJECT_NONE;
+    }
+    Object_Name_Index_Count = 0;
+    for (i = 0; i < Object_List_Index_Count; i++) {
+        if (Object_List_Index[i].type != OBJECT_NONE) {
+            Device_Object_Name_Index_Insert(
+                Object_List_Index[i].type, Object_List_Index[i].instance);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Make room in the Object_List index
+ * @param count [in] number of object identifiers to hold
+ * @return true if the Object_List index could be allocated
+ */
+static bool Device_Object_List_Index_Reserve(uint32_t count)
+{
+    BACNET_OBJECT_ID *list;
+    uint32_t size;
+
+    if (count <= Object_List_Index_Size) {
+        return true;
+    }
+    size = Object_List_Index_Size ? Object_List_Index_Size : 16;
+    while (size < count) {
+        size *= 2;
+    }
+    list = realloc(Object_List_Index, size * sizeof(*list));
+    if (!list) {
+        return false;
+    }
+    Object_List_Index = list;
+    Object_List_Index_Size = size;
+
+    return true;
+}
+
+/**
+ * @brief Fill in the Object_List identifiers of one object type
+ * @param pObject [in] The object type functions
+ * @param list [out] The identifiers, in Object_List order
+ * @param count [in] The number of objects of this type
+ */
+static void Device_Object_List_Index_Fill(
+    const struct object_functions *pObject,
+    BACNET_OBJECT_ID *list,
+    uint32_t count)
+{
+    uint32_t object_index = 0;
+    uint32_t i;
+
+    if (pObject->Object_Iterator) {
+        object_index = pObject->Object_Iterator(~(unsigned)0);
+    }
+    for (i = 0; i < count; i++) {
+        if (pObject->Object_Index_To_Instance) {
+            list[i].type = pObject->Object_Type;
+            list[i].instance = pObject->Object_Index_To_Instance(object_index);
+        } else {
+            list[i].type = OBJECT_NONE;
+            list[i].instance = BACNET_MAX_INSTANCE;
+        }
+        if (pObject->Object_Iterator) {
+            object_index = pObject->Object_Iterator(object_index);
+        } else {
+            object_index++;
+        }
+    }
+}
+
+/**
+ * @brief Rebuild the Object_List and name indexes from the object types
+ * @return true if the indexes could be allocated
+ */
+static bool Device_Object_Index_Build(void)
+{
+    struct object_functions *pObject = NULL;
+    uint32_t count, offset = 0;
+
+    Object_Index_Valid = false;
+    Object_List_Index_Count = 0;
+    count = Device_Object_List_Count();
+    if (!Device_Object_List_Index_Reserve(count)) {
+        return false;
+    }
+    pObject = Object_Table;
+    while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
+        if (pObject->Object_Count) {
+            count = pObject->Object_Count();
+            Device_Object_List_Index_Fill(
+                pObject, &Object_List_Index[offset], count);
+            offset += count;
+        }
+        pObject++;
+    }
+    Object_List_Index_Count = offset;
+    if (!Device_Object_Name_Index_Build()) {
+        return false;
+    }
+    Object_Index_Revision = Database_Revision;
+    Object_Index_Valid = true;
+
+    return true;
+}
+
+/**
+ * @brief Bring the indexes up to date if objects were added, removed,
+ *  or renamed behind our back
+ * @return true if the indexes may be used
+ */
+static bool Device_Object_Index_Current(void)
+{
+    if (Object_Index_Valid && (Object_Index_Revision == Database_Revision) &&
+        (Object_List_Index_Count == Device_Object_List_Count())) {
+        return true;
+    }
+
+    return Device_Object_Index_Build();
+}
+
+/**
+ * @brief Update the Object_List index for the one object type
+ *  that has just gained or lost an object, and whose creation or
+ *  deletion has just incremented the Database_Revision.
+ * @param pObject [in] The object type functions
+ * @param created [in] true if an object was created, false if deleted
+ * @return true if the indexes are still valid
+ */
+static bool Device_Object_List_Index_Splice(
+    struct object_functions *pObject, bool created)
+{
+    struct object_functions *pType = NULL;
+    uint32_t start = 0, count, old_count, total;
+
+    if (!Object_Index_Valid ||
+        (Object_Index_Revision + 1 != Database_Revision)) {
+        Object_Index_Valid = false;
+        return false;
+    }
+    for (pType = Object_Table; pType != pObject; pType++) {
+        if (pType->Object_Count) {
+            start += pType->Object_Count();
+        }
+    }
+    count = pObject->Object_Count();
+    if (created) {
+        old_count = count - 1;
+    } else {
+        old_count = count + 1;
+    }
+    total = Object_List_Index_Count + count - old_count;
+    if ((start + old_count > Object_List_Index_Count) ||
+        (total != Device_Object_List_Count()) ||
+        !Device_Object_List_Index_Reserve(total)) {
+        Object_Index_Valid = false;
+        return false;
+    }
+    memmove(
+        &Object_List_Index[start + count],
+        &Object_List_Index[start + old_count],
+        (Object_List_Index_Count - start - old_count) *
+            sizeof(Object_List_Index[0]));
+    Device_Object_List_Index_Fill(pObject, &Object_List_Index[start], count);
+    Object_List_Index_Count = total;
+    Object_Index_Revision = Database_Revision;
+
+    return true;
+}
+
+/**
+ * @brief Update the indexes after an object has been created
+ * @param pObject [in] The object type functions
+ * @param object_instance [in] The new object instance number
+ */
+static void Device_Object_Index_Created(
+    struct object_functions *pObject, uint32_t object_instance)
+{
+    if (!Device_Object_List_Index_Splice(pObject, true)) {
+        return;
+    }
+    if ((Object_Name_Index_Count + 1) * 2 > Object_Name_Index_Size) {
+        /* grow, which indexes the new name too */
+        if (!Device_Object_Name_Index_Build()) {
+            Object_Index_Valid = false;
+        }
+    } else {
+        Device_Object_Name_Index_Insert(pObject->Object_Type, object_instance);
+    }
+}
+
+/**
+ * @brief Update the indexes after an object has been deleted
+ * @param pObject [in] The object type functions
+ * @param object_instance [in] The deleted object instance number
+ * @param object_name [in] The name of the deleted object
+ */
+static void Device_Object_Index_Deleted(
+    struct object_functions *pObject,
+    uint32_t object_instance,
+    const BACNET_CHARACTER_STRING *object_name)
+{
+    if (!Device_Object_List_Index_Splice(pObject, false)) {
+        return;
+    }
+    if (!Device_Object_Name_Index_Remove(
+            pObject->Object_Type, object_instance, object_name)) {
+        Object_Index_Valid = false;
+    }
+}
+
+/**
+ * @brief Update the name index after an object has been renamed
+ * @param object_type [in] The object type
+ * @param object_instance [in] The object instance number
+ * @param object_name [in] The previous name of the object
+ */
+static void Device_Object_Index_Renamed(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    const BACNET_CHARACTER_STRING *object_name)
+{
+    if (!Object_Index_Valid) {
+        return;
+    }
+    if (Device_Object_Name_Index_Remove(
+            object_type, object_instance, object_name)) {
+        Device_Object_Name_Index_Insert(object_type, object_instance);
+    } else {
+        Object_Index_Valid = false;
+    }
+}
+
+/**
+ * @brief Find an object by name in the name index
+ * @param object_name [in] The object name to look for
+ * @param object_type [out] The object type, if found
+ * @param object_instance [out] The object instance number, if found
+ * @param stale [out] set true if an indexed name no longer matches
+ * @return true if found
+ */
+static bool Device_Object_Name_Index_Find(
+    const BACNET_CHARACTER_STRING *object_name,
+    BACNET_OBJECT_TYPE *object_type,
+    uint32_t *object_instance,
+    bool *stale)
+{
+    BACNET_CHARACTER_STRING indexed_name;
+    const struct object_name_slot *slot;
+    uint32_t hash, mask, i;
+
+    hash = Device_Object_Name_Hash(object_name);
+    mask = Object_Name_Index_Size - 1;
+    i = hash & mask;
+    while (Object_Name_Index[i].type != OBJECT_NONE) {
+        slot = &Object_Name_Index[i];
+        if (slot->hash == hash) {
+            if (!Device_Object_Name_Copy(
+                    slot->type, slot->instance, &indexed_name) ||
+                (Device_Object_Name_Hash(&indexed_name) != hash)) {
+                /* renamed or removed behind our back */
+                *stale = true;
+            } else if (characterstring_same(object_name, &indexed_name)) {
+                if (object_type) {
+                    *object_type = slot->type;
+                }
+                if (object_instance) {
+                    *object_instance = slot->instance;
+                }
+                return true;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+
+    return false;
+}
+#endif
+
 /** Lookup the Object at the given array index in the Device's Object List.
  * Even though we don't keep a single linear array of objects in the Device,
  * this method acts as though we do and works through a virtual, concatenated
@@ -1112,6 +1558,17 @@ bool Device_Object_List_Identifier(
     if (array_index == 0) {
         return status;
     }
+#if BACNET_DEVICE_OBJECT_INDEX
+    if (Device_Object_Index_Current()) {
+        if ((array_index <= Object_List_Index_Count) &&
+            (Object_List_Index[array_index - 1].type != OBJECT_NONE)) {
+            *object_type = Object_List_Index[array_index - 1].type;
+            *instance = Object_List_Index[array_index - 1].instance;
+            status = true;
+        }
+        return status;
+    }
+#endif
     object_index = array_index - 1;
     /* initialize the default return values */
     pObject = Object_Table;
@@ -1181,6 +1638,144 @@ int Device_Object_List_Element_Encode(
     return apdu_len;
 }
 
+#if BACNET_APDU_STATISTICS
+/**
+ * @brief Encode an element of the requests of each confirmed service
+ * @param object_instance [in] BACnet device object instance number
+ * @param array_index [in] array index requested: 0 to N for individual
+ *  array members, where 0 is the service with a service choice of 0
+ * @param apdu [out] Buffer in which the APDU contents are built, or NULL
+ *  to return the length of buffer if it had been built
+ * @return The length of the apdu encoded or BACNET_STATUS_ERROR
+ */
+static int Device_Confirmed_Requests_Element_Encode(
+    uint32_t object_instance, BACNET_ARRAY_INDEX array_index, uint8_t *apdu)
+{
+    BACNET_APDU_SERVICE_STATISTICS stats;
+
+    (void)object_instance;
+    if (!apdu_statistics_confirmed(array_index, &stats)) {
+        return BACNET_STATUS_ERROR;
+    }
+
+    return encode_application_unsigned(apdu, stats.requests);
+}
+
+/**
+ * @brief Encode an element of the Error, Reject, and Abort replies of
+ *  each confirmed service
+ * @param object_instance [in] BACnet device object instance number
+ * @param array_index [in] array index requested: 0 to N for individual
+ *  array members, where 0 is the service with a service choice of 0
+ * @param apdu [out] Buffer in which the APDU contents are built, or NULL
+ *  to return the length of buffer if it had been built
+ * @return The length of the apdu encoded or BACNET_STATUS_ERROR
+ */
+static int Device_Confirmed_Failures_Element_Encode(
+    uint32_t object_instance, BACNET_ARRAY_INDEX array_index, uint8_t *apdu)
+{
+    BACNET_APDU_SERVICE_STATISTICS stats;
+
+    (void)object_instance;
+    if (!apdu_statistics_confirmed(array_index, &stats)) {
+        return BACNET_STATUS_ERROR;
+    }
+
+    return encode_application_unsigned(
+        apdu, stats.errors + stats.rejects + stats.aborts);
+}
+
+/**
+ * @brief Encode an element of the 99th percentile of the handler time
+ *  of each confirmed service, in microseconds
+ * @param object_instance [in] BACnet device object instance number
+ * @param array_index [in] array index requested: 0 to N for individual
+ *  array members, where 0 is the service with a service choice of 0
+ * @param apdu [out] Buffer in which the APDU contents are built, or NULL
+ *  to return the length of buffer if it had been built
+ * @return The length of the apdu encoded or BACNET_STATUS_ERROR
+ */
+static int Device_Confirmed_Latency_Element_Encode(
+    uint32_t object_instance, BACNET_ARRAY_INDEX array_index, uint8_t *apdu)
+{
+    BACNET_APDU_SERVICE_STATISTICS stats;
+
+    (void)object_instance;
+    if (!apdu_statistics_confirmed(array_index, &stats)) {
+        return BACNET_STATUS_ERROR;
+    }
+
+    return encode_application_unsigned(
+        apdu, apdu_statistics_percentile(&stats, 99));
+}
+
+/**
+ * @brief Encode an element of the requests of each unconfirmed service
+ * @param object_instance [in] BACnet device object instance number
+ * @param array_index [in] array index requested: 0 to N for individual
+ *  array members, where 0 is the service with a service choice of 0
+ * @param apdu [out] Buffer in which the APDU contents are built, or NULL
+ *  to return the length of buffer if it had been built
+ * @return The length of the apdu encoded or BACNET_STATUS_ERROR
+ */
+static int Device_Unconfirmed_Requests_Element_Encode(
+    uint32_t object_instance, BACNET_ARRAY_INDEX array_index, uint8_t *apdu)
+{
+    BACNET_APDU_SERVICE_STATISTICS stats;
+
+    (void)object_instance;
+    if (!apdu_statistics_unconfirmed(array_index, &stats)) {
+        return BACNET_STATUS_ERROR;
+    }
+
+    return encode_application_unsigned(apdu, stats.requests);
+}
+/**
+ * @brief Encode one of the proprietary properties with the APDU handler
+ *  counters, which are arrays with an element for each service
+ * @param rpdata [in,out] ReadProperty data of the request
+ * @return The length of the apdu encoded, or BACNET_STATUS_ERROR or
+ *  BACNET_STATUS_ABORT with the error class and code set
+ */
+static int Device_Statistics_Encode(BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    bacnet_array_property_element_encode_function encoder;
+    BACNET_UNSIGNED_INTEGER count = MAX_BACNET_CONFIRMED_SERVICE;
+    int apdu_len;
+
+    switch ((int)rpdata->object_property) {
+        case PROP_DEVICE_CONFIRMED_REQUESTS:
+            encoder = Device_Confirmed_Requests_Element_Encode;
+            break;
+        case PROP_DEVICE_CONFIRMED_FAILURES:
+            encoder = Device_Confirmed_Failures_Element_Encode;
+            break;
+        case PROP_DEVICE_CONFIRMED_LATENCY:
+            encoder = Device_Confirmed_Latency_Element_Encode;
+            break;
+        case PROP_DEVICE_UNCONFIRMED_REQUESTS:
+            encoder = Device_Unconfirmed_Requests_Element_Encode;
+            count = MAX_BACNET_UNCONFIRMED_SERVICE;
+            break;
+        default:
+            rpdata->error_class = ERROR_CLASS_PROPERTY;
+            rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+            return BACNET_STATUS_ERROR;
+    }
+    apdu_len = bacnet_array_encode(
+        rpdata->object_instance, rpdata->array_index, encoder, count,
+        rpdata->application_data, rpdata->application_data_len);
+    if (apdu_len == BACNET_STATUS_ABORT) {
+        rpdata->error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
+    } else if (apdu_len == BACNET_STATUS_ERROR) {
+        rpdata->error_class = ERROR_CLASS_PROPERTY;
+        rpdata->error_code = ERROR_CODE_INVALID_ARRAY_INDEX;
+    }
+
+    return apdu_len;
+}
+#endif
+
 /** Determine if we have an object with the given object_name.
  * If the object_type and object_instance pointers are not null,
  * and the lookup succeeds, they will be given the resulting values.
@@ -1202,7 +1797,21 @@ bool Device_Valid_Object_Name(
     bool check_id = false;
     BACNET_CHARACTER_STRING object_name2;
     struct object_functions *pObject = NULL;
-
+#if BACNET_DEVICE_OBJECT_INDEX
+    bool stale = false;
+
+    if (Device_Object_Index_Current()) {
+        found = Device_Object_Name_Index_Find(
+            object_name1, object_type, object_instance, &stale);
+        if (!stale) {
+            return found;
+        }
+        if (Device_Object_Index_Build()) {
+            return Device_Object_Name_Index_Find(
+                object_name1, object_type, object_instance, &stale);
+        }
+    }
+#endif
     max_objects = Device_Object_List_Count();
     for (i = 1; i <= max_objects; i++) {
         check_id = Device_Object_List_Identifier(i, &type, &instance);
@@ -1527,6 +2136,16 @@ int Device_Read_Property_Local(BACNET_READ_PROPERTY_DATA *rpdata)
         case PROP_NUMBER_OF_APDU_RETRIES:
             apdu_len = encode_application_unsigned(&apdu[0], apdu_retries());
             break;
+#if BACNET_SEGMENTATION_ENABLED
+        case PROP_MAX_SEGMENTS_ACCEPTED:
+            apdu_len = encode_application_unsigned(
+                &apdu[0], BACNET_MAX_SEGMENTS_ACCEPTED);
+            break;
+        case PROP_APDU_SEGMENT_TIMEOUT:
+            apdu_len =
+                encode_application_unsigned(&apdu[0], apdu_segment_timeout());
+            break;
+#endif
         case PROP_DEVICE_ADDRESS_BINDING:
             apdu_len = address_list_encode(&apdu[0], apdu_max);
             break;
@@ -1583,9 +2202,13 @@ int Device_Read_Property_Local(BACNET_READ_PROPERTY_DATA *rpdata)
                 bacapp_encode_timestamp(&apdu[0], &Time_Of_Device_Restart);
             break;
         default:
+#if BACNET_APDU_STATISTICS
+            apdu_len = Device_Statistics_Encode(rpdata);
+#else
             rpdata->error_class = ERROR_CLASS_PROPERTY;
             rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
             apdu_len = BACNET_STATUS_ERROR;
+#endif
             break;
     }
 
@@ -1728,6 +2351,15 @@ bool Device_Write_Property_Local(BACNET_WRITE_PROPERTY_DATA *wp_data)
                 apdu_timeout_set((uint16_t)value.type.Unsigned_Int);
             }
             break;
+#if BACNET_SEGMENTATION_ENABLED
+        case PROP_APDU_SEGMENT_TIMEOUT:
+            status = write_property_type_valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_UNSIGNED_INT);
+            if (status) {
+                apdu_segment_timeout_set((uint16_t)value.type.Unsigned_Int);
+            }
+            break;
+#endif
         case PROP_VENDOR_IDENTIFIER:
             status = write_property_type_valid(
                 wp_data, &value, BACNET_APPLICATION_TAG_UNSIGNED_INT);
@@ -1927,6 +2559,10 @@ static bool Device_Write_Property_Object_Name(
     uint32_t object_instance = 0;
     int apdu_size = 0;
     const uint8_t *apdu = NULL;
+#if BACNET_DEVICE_OBJECT_INDEX
+    BACNET_CHARACTER_STRING old_name;
+    bool old_name_valid = false;
+#endif
 
     if (!wp_data) {
         return false;
@@ -1964,7 +2600,18 @@ static bool Device_Write_Property_Object_Name(
                 status = false;
             }
         } else {
+#if BACNET_DEVICE_OBJECT_INDEX
+            old_name_valid = Device_Object_Name_Copy(
+                wp_data->object_type, wp_data->object_instance, &old_name);
+#endif
             status = Object_Write_Property(wp_data);
+#if BACNET_DEVICE_OBJECT_INDEX
+            if (status && old_name_valid) {
+                Device_Object_Index_Renamed(
+                    wp_data->object_type, wp_data->object_instance,
+                    &old_name);
+            }
+#endif
         }
     }
 
@@ -2027,6 +2674,9 @@ bool Device_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
                 }
                 if (status) {
                     Device_Write_Property_Store(wp_data);
+                    /* let the COV subscribers know right away */
+                    handler_cov_change_notify(
+                        wp_data->object_type, wp_data->object_instance);
                 }
             } else {
                 if (Device_Objects_Property_List_Member(
@@ -2242,6 +2892,9 @@ bool Device_Create_Object(BACNET_CREATE_OBJECT_DATA *data)
                     /* required by ACK */
                     data->object_instance = object_instance;
                     Device_Inc_Database_Revision();
+#if BACNET_DEVICE_OBJECT_INDEX
+                    Device_Object_Index_Created(pObject, object_instance);
+#endif
                     status = true;
                 }
             }
@@ -2265,6 +2918,10 @@ bool Device_Delete_Object(BACNET_DELETE_OBJECT_DATA *data)
 {
     bool status = false;
     struct object_functions *pObject = NULL;
+#if BACNET_DEVICE_OBJECT_INDEX
+    BACNET_CHARACTER_STRING object_name;
+    bool object_name_valid = false;
+#endif
 
     pObject = Device_Objects_Find_Functions(data->object_type);
     if (pObject != NULL) {
@@ -2278,9 +2935,21 @@ bool Device_Delete_Object(BACNET_DELETE_OBJECT_DATA *data)
             pObject->Object_Valid_Instance &&
             pObject->Object_Valid_Instance(data->object_instance)) {
             /* The object being deleted must already exist */
+#if BACNET_DEVICE_OBJECT_INDEX
+            object_name_valid = Device_Object_Name_Copy(
+                data->object_type, data->object_instance, &object_name);
+#endif
             status = pObject->Object_Delete(data->object_instance);
             if (status) {
                 Device_Inc_Database_Revision();
+#if BACNET_DEVICE_OBJECT_INDEX
+                if (object_name_valid) {
+                    Device_Object_Index_Deleted(
+                        pObject, data->object_instance, &object_name);
+                } else {
+                    Object_Index_Valid = false;
+                }
+#endif
             } else {
                 /* The object exists but cannot be deleted. */
                 data->error_class = ERROR_CLASS_OBJECT;
@@ -2366,6 +3035,9 @@ void Device_Init(object_functions_t *object_table)
     } else {
         Object_Table = &My_Object_Table[0];
     }
+#if BACNET_DEVICE_OBJECT_INDEX
+    Object_Index_Valid = false;
+#endif
     pObject = Object_Table;
     while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
         if (pObject->Object_Init) {
@@ -2430,6 +3102,46 @@ bool DeviceGetRRInfo(
     return status;
 }
 
+/* object types that keep their own timers for only the objects
+   with timed behavior in progress, rather than every object */
+typedef void (*object_timer_task_function)(uint16_t milliseconds);
+static const struct object_timer_task {
+    object_timer_function Object_Timer;
+    object_timer_task_function Object_Timer_Task;
+} Object_Timer_Tasks[] = {
+#if (BACNET_PROTOCOL_REVISION >= 14)
+    { Lighting_Output_Timer, Lighting_Output_Timer_Task },
+#endif
+#if (BACNET_PROTOCOL_REVISION >= 16)
+    { Binary_Lighting_Output_Timer, Binary_Lighting_Output_Timer_Task },
+#endif
+#if (BACNET_PROTOCOL_REVISION >= 24)
+    { Color_Timer, Color_Timer_Task },
+    { Color_Temperature_Timer, Color_Temperature_Timer_Task },
+#endif
+    { NULL, NULL }
+};
+
+/**
+ * @brief Find the timer task for an object type
+ * @param object_timer - timer function of the object type
+ * @return the timer task, or NULL if the type has none
+ */
+static object_timer_task_function
+Device_Timer_Task(object_timer_function object_timer)
+{
+    const struct object_timer_task *pTask = Object_Timer_Tasks;
+
+    while (pTask->Object_Timer) {
+        if (pTask->Object_Timer == object_timer) {
+            return pTask->Object_Timer_Task;
+        }
+        pTask++;
+    }
+
+    return NULL;
+}
+
 /**
  * @brief Updates all the object timers with elapsed milliseconds
  * @param milliseconds - number of milliseconds elapsed
@@ -2439,10 +3151,16 @@ void Device_Timer(uint16_t milliseconds)
     struct object_functions *pObject;
     unsigned count = 0;
     uint32_t instance;
+    object_timer_task_function timer_task;
 
     pObject = Object_Table;
     while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
-        if (pObject->Object_Count) {
+        count = 0;
+        timer_task = Device_Timer_Task(pObject->Object_Timer);
+        if (timer_task) {
+            /* only the objects with timed behavior in progress */
+            timer_task(milliseconds);
+        } else if (pObject->Object_Count) {
             count = pObject->Object_Count();
         }
         while (count) {
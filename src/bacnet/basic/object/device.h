@@ -149,6 +149,22 @@ typedef struct object_functions {
 #define MAX_DEV_VER_LEN 16
 #define MAX_DEV_DESC_LEN 64
 
+#if BACNET_APDU_STATISTICS
+/* Proprietary Device properties with the counters of the APDU handler.
+   Each is a BACnetARRAY of Unsigned, with an element for each service,
+   where array index 1 is the service with a service choice of 0. */
+#ifndef PROP_DEVICE_CONFIRMED_REQUESTS
+/* requests of each confirmed service */
+#define PROP_DEVICE_CONFIRMED_REQUESTS 9700
+/* Error, Reject, and Abort replies of each confirmed service */
+#define PROP_DEVICE_CONFIRMED_FAILURES 9701
+/* 99th percentile of the handler time of each confirmed service, in us */
+#define PROP_DEVICE_CONFIRMED_LATENCY 9702
+/* requests of each unconfirmed service */
+#define PROP_DEVICE_UNCONFIRMED_REQUESTS 9703
+#endif
+#endif
+
 /** Structure to define the Object Properties common to all Objects. */
 typedef struct commonBacObj_s {
     /** The BACnet type of this object (ie, what class is this object from?).
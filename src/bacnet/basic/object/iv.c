@@ -181,11 +181,12 @@ int32_t Integer_Value_Present_Value(uint32_t object_instance)
  *
  * This method will update the COV-changed attribute.
  *
+ * @param object_instance  object-instance number of the object
  * @param index  Object index
  * @param value  Given present value.
  */
-static void
-Integer_Value_COV_Detect(struct integer_object *pObject, int32_t value)
+static void Integer_Value_COV_Detect(
+    uint32_t object_instance, struct integer_object *pObject, int32_t value)
 {
     if (pObject) {
         int32_t prior_value = pObject->Prior_Value;
@@ -194,6 +195,7 @@ Integer_Value_COV_Detect(struct integer_object *pObject, int32_t value)
 
         if (cov_delta >= cov_increment) {
             pObject->Changed = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
             pObject->Prior_Value = value;
         }
     }
@@ -216,7 +218,7 @@ bool Integer_Value_Present_Value_Set(
     (void)priority;
 
     if (pObject) {
-        Integer_Value_COV_Detect(pObject, value);
+        Integer_Value_COV_Detect(object_instance, pObject, value);
         pObject->Present_Value = value;
         status = true;
     }
@@ -701,7 +703,8 @@ void Integer_Value_COV_Increment_Set(uint32_t object_instance, uint32_t value)
 
     if (pObject) {
         pObject->COV_Increment = value;
-        Integer_Value_COV_Detect(pObject, pObject->Present_Value);
+        Integer_Value_COV_Detect(
+            object_instance, pObject, pObject->Present_Value);
     }
 }
 
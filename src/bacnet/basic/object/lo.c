@@ -24,6 +24,7 @@
 #include "bacnet/basic/sys/linear.h"
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/basic/sys/lighting_command.h"
+#include "bacnet/basic/sys/timer_wheel.h"
 #include "bacnet/bactext.h"
 #include "bacnet/proplist.h"
 /* me! */
@@ -48,6 +49,7 @@ struct object_data {
     uint8_t Lighting_Command_Default_Priority;
     BACNET_OBJECT_ID Color_Reference;
     BACNET_OBJECT_ID Override_Color_Reference;
+    struct timer_wheel_entry Timer_Entry;
     const char *Object_Name;
     const char *Description;
     /* bits */
@@ -60,6 +62,12 @@ static OS_Keylist Object_List;
 /* callback for present value writes */
 static lighting_command_tracking_value_callback
     Lighting_Command_Tracking_Value_Callback;
+/* milliseconds between updates while a lighting operation is in progress */
+#ifndef LIGHTING_OUTPUT_TIMER_INTERVAL
+#define LIGHTING_OUTPUT_TIMER_INTERVAL 10
+#endif
+/* timers of the objects with a lighting operation in progress */
+static struct timer_wheel Timer_Wheel;
 
 /* These arrays are used by the ReadPropertyMultiple handler and
    property-list property (as of protocol-revision 14) */
@@ -431,6 +439,31 @@ bool Lighting_Output_Present_Value_Set(
     return status;
 }
 
+/**
+ * @brief Start the object timer if a lighting operation is in progress
+ * @param pObject [in] object data
+ */
+static void Lighting_Output_Timer_Schedule(struct object_data *pObject)
+{
+    bool active = true;
+
+    switch (pObject->Lighting_Command.Lighting_Operation) {
+        case BACNET_LIGHTS_NONE:
+        case BACNET_LIGHTS_STOP:
+            /* one more update returns the in-progress to idle */
+            active = pObject->Lighting_Command.In_Progress !=
+                BACNET_LIGHTING_IDLE;
+            break;
+        default:
+            break;
+    }
+    if (active && !timer_wheel_running(&pObject->Timer_Entry)) {
+        timer_wheel_start(
+            &Timer_Wheel, &pObject->Timer_Entry,
+            LIGHTING_OUTPUT_TIMER_INTERVAL);
+    }
+}
+
 /**
  * @brief Set the lighting command if the priority is active
  * @param object [in] BACnet object instance
@@ -457,6 +490,7 @@ Lighting_Command_Warn(struct object_data *pObject, unsigned priority)
         lighting_command_blink_warn(
             &pObject->Lighting_Command, BACNET_LIGHTS_WARN,
             &pObject->Lighting_Command.Blink);
+        Lighting_Output_Timer_Schedule(pObject);
     }
 }
 
@@ -489,6 +523,7 @@ Lighting_Command_Warn_Off(struct object_data *pObject, unsigned priority)
         lighting_command_blink_warn(
             &pObject->Lighting_Command, BACNET_LIGHTS_WARN_OFF,
             &pObject->Lighting_Command.Blink);
+        Lighting_Output_Timer_Schedule(pObject);
     } else {
         Present_Value_Set(pObject, 0.0, priority);
     }
@@ -527,6 +562,7 @@ Lighting_Command_Warn_Relinquish(struct object_data *pObject, unsigned priority)
         lighting_command_blink_warn(
             &pObject->Lighting_Command, BACNET_LIGHTS_WARN_RELINQUISH,
             &pObject->Lighting_Command.Blink);
+        Lighting_Output_Timer_Schedule(pObject);
     } else {
         Present_Value_Relinquish(pObject, priority);
     }
@@ -555,6 +591,7 @@ static void Lighting_Command_Fade_To(
     if (priority <= current_priority) {
         /* we have priority - configure the Lighting Command */
         lighting_command_fade_to(&pObject->Lighting_Command, value, fade_time);
+        Lighting_Output_Timer_Schedule(pObject);
     }
 }
 
@@ -581,6 +618,7 @@ static void Lighting_Command_Ramp_To(
     if (priority <= current_priority) {
         /* we have priority - configure the Lighting Command */
         lighting_command_ramp_to(&pObject->Lighting_Command, value, ramp_rate);
+        Lighting_Output_Timer_Schedule(pObject);
     }
 }
 
@@ -607,6 +645,7 @@ static void Lighting_Command_Step(
         /* we have priority - configure the Lighting Command */
         lighting_command_step(
             &pObject->Lighting_Command, operation, step_increment);
+        Lighting_Output_Timer_Schedule(pObject);
     }
 }
 
@@ -929,6 +968,7 @@ Lighting_Command_Stop(struct object_data *pObject, unsigned priority)
     if (priority <= current_priority) {
         /* we have priority - configure the Lighting Command */
         lighting_command_stop(&pObject->Lighting_Command);
+        Lighting_Output_Timer_Schedule(pObject);
     }
 }
 
@@ -2309,6 +2349,38 @@ void Lighting_Output_Timer(uint32_t object_instance, uint16_t milliseconds)
     }
 }
 
+/**
+ * @brief Updates an object whose timer expired, and starts the timer
+ *  again while its lighting operation is in progress
+ * @param entry - timer of the object
+ * @param milliseconds - number of milliseconds since the timer was started
+ */
+static void Lighting_Output_Timer_Callback(
+    struct timer_wheel_entry *entry, uint32_t milliseconds)
+{
+    struct object_data *pObject;
+
+    if (milliseconds > UINT16_MAX) {
+        milliseconds = UINT16_MAX;
+    }
+    Lighting_Output_Timer(entry->key, (uint16_t)milliseconds);
+    pObject = Keylist_Data(Object_List, entry->key);
+    if (pObject) {
+        Lighting_Output_Timer_Schedule(pObject);
+    }
+}
+
+/**
+ * @brief Updates the tracking value of only the lighting objects with a
+ *  ramp or fade or step or warn in progress, rather than every object.
+ * @param milliseconds - number of milliseconds elapsed since previously
+ * called.  Suggest that this is called every 10 milliseconds.
+ */
+void Lighting_Output_Timer_Task(uint16_t milliseconds)
+{
+    timer_wheel_elapsed(&Timer_Wheel, milliseconds);
+}
+
 static void Lighting_Output_Tracking_Value_Callback(
     uint32_t object_instance, float old_value, float value)
 {
@@ -2395,6 +2467,9 @@ uint32_t Lighting_Output_Create(uint32_t object_instance)
         pObject->Color_Reference.instance = BACNET_MAX_INSTANCE;
         pObject->Override_Color_Reference.type = OBJECT_COLOR;
         pObject->Override_Color_Reference.instance = BACNET_MAX_INSTANCE;
+        timer_wheel_entry_init(
+            &pObject->Timer_Entry, Lighting_Output_Timer_Callback,
+            object_instance);
         /* add to list */
         index = Keylist_Data_Add(Object_List, object_instance, pObject);
         if (index < 0) {
@@ -2418,6 +2493,7 @@ bool Lighting_Output_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
+        timer_wheel_stop(&Timer_Wheel, &pObject->Timer_Entry);
         free(pObject);
         status = true;
     }
@@ -2436,6 +2512,7 @@ void Lighting_Output_Cleanup(void)
         do {
             pObject = Keylist_Data_Pop(Object_List);
             if (pObject) {
+                timer_wheel_stop(&Timer_Wheel, &pObject->Timer_Entry);
                 free(pObject);
             }
         } while (pObject);
@@ -2451,5 +2528,6 @@ void Lighting_Output_Init(void)
 {
     if (!Object_List) {
         Object_List = Keylist_Create();
+        timer_wheel_init(&Timer_Wheel, LIGHTING_OUTPUT_TIMER_INTERVAL);
     }
 }
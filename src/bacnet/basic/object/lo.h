@@ -166,6 +166,8 @@ bool Lighting_Output_Override_Color_Reference_Set(
 
 BACNET_STACK_EXPORT
 void Lighting_Output_Timer(uint32_t object_instance, uint16_t milliseconds);
+BACNET_STACK_EXPORT
+void Lighting_Output_Timer_Task(uint16_t milliseconds);
 
 BACNET_STACK_EXPORT
 void Lighting_Output_Write_Present_Value_Callback_Set(
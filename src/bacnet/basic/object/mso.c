@@ -387,6 +387,7 @@ bool Multistate_Output_Present_Value_Set(
             new_value = Object_Present_Value(pObject);
             if (old_value != new_value) {
                 pObject->Changed = true;
+                COV_CHANGE_NOTIFY(Object_Type, object_instance);
             }
             status = true;
         }
@@ -418,6 +419,7 @@ bool Multistate_Output_Present_Value_Relinquish(
             new_value = Object_Present_Value(pObject);
             if (old_value != new_value) {
                 pObject->Changed = true;
+                COV_CHANGE_NOTIFY(Object_Type, object_instance);
             }
             status = true;
         }
@@ -574,6 +576,7 @@ void Multistate_Output_Out_Of_Service_Set(uint32_t object_instance, bool value)
         if (pObject->Out_Of_Service != value) {
             pObject->Out_Of_Service = value;
             pObject->Changed = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
         }
     }
 }
@@ -789,6 +792,7 @@ bool Multistate_Output_Reliability_Set(
             pObject->Reliability = value;
             if (fault != Multistate_Output_Object_Fault(pObject)) {
                 pObject->Changed = true;
+                COV_CHANGE_NOTIFY(Object_Type, object_instance);
             }
             status = true;
         }
@@ -316,15 +316,17 @@ uint32_t Multistate_Value_Present_Value(uint32_t object_instance)
 
 /**
  * @brief For a given object instance-number, checks the present-value for COV
+ * @param  object_instance - object-instance number of the object
  * @param  pObject - specific object with valid data
  * @param  value - multistate value
  */
 static void Multistate_Value_Present_Value_COV_Detect(
-    struct object_data *pObject, uint32_t value)
+    uint32_t object_instance, struct object_data *pObject, uint32_t value)
 {
     if (pObject) {
         if (pObject->Present_Value != value) {
             pObject->Change_Of_Value = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
         }
     }
 }
@@ -346,7 +348,8 @@ bool Multistate_Value_Present_Value_Set(
     if (pObject) {
         max_states = state_name_count(pObject->State_Text);
         if ((value >= 1) && (value <= max_states)) {
-            Multistate_Value_Present_Value_COV_Detect(pObject, value);
+            Multistate_Value_Present_Value_COV_Detect(
+                object_instance, pObject, value);
             pObject->Present_Value = value;
             status = true;
         }
@@ -382,7 +385,8 @@ static bool Multistate_Value_Present_Value_Write(
         if ((value >= 1) && (value <= max_states)) {
             if (pObject->Write_Enabled) {
                 old_value = pObject->Present_Value;
-                Multistate_Value_Present_Value_COV_Detect(pObject, value);
+                Multistate_Value_Present_Value_COV_Detect(
+                    object_instance, pObject, value);
                 pObject->Present_Value = value;
                 if (pObject->Out_Of_Service) {
                     /* The physical point that the object represents
@@ -443,6 +447,7 @@ void Multistate_Value_Out_Of_Service_Set(uint32_t object_instance, bool value)
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
             pObject->Change_Of_Value = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
         }
         pObject->Out_Of_Service = value;
     }
@@ -612,6 +617,7 @@ bool Multistate_Value_Reliability_Set(
         pObject->Reliability = value;
         if (fault != Multistate_Value_Object_Fault(pObject)) {
             pObject->Change_Of_Value = true;
+            COV_CHANGE_NOTIFY(Object_Type, object_instance);
         }
         status = true;
     }
@@ -35,7 +35,39 @@
 #if defined(INTRINSIC_REPORTING)
 static NOTIFICATION_CLASS_INFO NC_Info[MAX_NOTIFICATION_CLASSES];
 /* buffer for sending event messages */
-static uint8_t Event_Buffer[MAX_APDU];
+static uint8_t Event_Buffer[MAX_PDU];
+
+/* a notification waiting to be sent to one recipient */
+struct nc_notify_entry {
+    BACNET_ADDRESS dest;
+    uint32_t process_id;
+    uint16_t max_apdu;
+    uint8_t event; /* index of the encoded event */
+    bool confirmed;
+};
+/* an event, encoded once for all of its recipients */
+struct nc_notify_event {
+    uint8_t refs; /* number of notifications of the event waiting */
+    uint8_t offset; /* length of the process identifier that starts it */
+    uint16_t len;
+    uint8_t service_request[MAX_APDU];
+};
+/* the address of a device recipient, from the address cache */
+struct nc_recipient_binding {
+    bool valid;
+    uint16_t max_apdu;
+    uint32_t device_id;
+    BACNET_ADDRESS dest;
+};
+static struct nc_notify_entry NC_Notify_Queue[NC_NOTIFY_QUEUE_SIZE];
+static unsigned NC_Notify_Head;
+static unsigned NC_Notify_Count;
+static struct nc_notify_event NC_Notify_Event[NC_NOTIFY_EVENTS_MAX];
+static struct nc_recipient_binding
+    NC_Binding[MAX_NOTIFICATION_CLASSES][NC_MAX_RECIPIENTS];
+static NC_NOTIFY_STATISTICS NC_Notify_Stats;
+/* the service request sent to one recipient */
+static uint8_t NC_Service_Request[MAX_APDU];
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Notification_Properties_Required[] = {
@@ -85,6 +117,11 @@ void Notification_Class_Init(void)
             bacnet_destination_default_init(destination);
         }
     }
+    memset(NC_Binding, 0, sizeof(NC_Binding));
+    memset(NC_Notify_Event, 0, sizeof(NC_Notify_Event));
+    memset(&NC_Notify_Stats, 0, sizeof(NC_Notify_Stats));
+    NC_Notify_Head = 0;
+    NC_Notify_Count = 0;
 
     return;
 }
@@ -555,11 +592,11 @@ void Notification_Class_Set_Ack_Required(
     }
 }
 
-static bool
-IsRecipientActive(BACNET_DESTINATION *pBacDest, uint8_t EventToState)
+static bool IsRecipientActive(
+    BACNET_DESTINATION *pBacDest,
+    uint8_t EventToState,
+    const BACNET_DATE_TIME *DateTime)
 {
-    BACNET_DATE_TIME DateTime;
-
     /* valid Transitions */
     switch (EventToState) {
         case EVENT_STATE_OFFNORMAL:
@@ -587,26 +624,242 @@ IsRecipientActive(BACNET_DESTINATION *pBacDest, uint8_t EventToState)
             return false; /* shouldn't happen */
     }
 
-    /* get actual date and time */
-    datetime_local(&DateTime.date, &DateTime.time, NULL, NULL);
-
     /* valid Days */
-    if (!(bitstring_bit(&pBacDest->ValidDays, (DateTime.date.wday - 1)))) {
+    if (!(bitstring_bit(&pBacDest->ValidDays, (DateTime->date.wday - 1)))) {
         return false;
     }
     /* valid FromTime */
-    if (datetime_compare_time(&DateTime.time, &pBacDest->FromTime) < 0) {
+    if (datetime_compare_time(&DateTime->time, &pBacDest->FromTime) < 0) {
         return false;
     }
 
     /* valid ToTime */
-    if (datetime_compare_time(&pBacDest->ToTime, &DateTime.time) < 0) {
+    if (datetime_compare_time(&pBacDest->ToTime, &DateTime->time) < 0) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Find the address of a recipient, from the binding of the
+ *  recipient device that was found before, or from the address cache
+ * @param notify_index [in] index of the notification class
+ * @param index [in] index of the recipient in the Recipient_List
+ * @param destination [in] the recipient
+ * @param entry [out] the address and max APDU of the recipient
+ * @return true if the address of the recipient is known
+ */
+static bool notification_recipient_address(
+    unsigned notify_index,
+    unsigned index,
+    const BACNET_DESTINATION *destination,
+    struct nc_notify_entry *entry)
+{
+    struct nc_recipient_binding *binding;
+    unsigned max_apdu = 0;
+    uint32_t device_id;
+
+    if (destination->Recipient.tag == BACNET_RECIPIENT_TAG_ADDRESS) {
+        bacnet_address_copy(&entry->dest, &destination->Recipient.type.address);
+        entry->max_apdu = MAX_APDU;
+        return true;
+    }
+    if (destination->Recipient.tag != BACNET_RECIPIENT_TAG_DEVICE) {
+        return false;
+    }
+    device_id = destination->Recipient.type.device.instance;
+    binding = &NC_Binding[notify_index][index];
+    if (!binding->valid || (binding->device_id != device_id)) {
+        binding->valid =
+            address_get_by_device(device_id, &max_apdu, &binding->dest);
+        if (!binding->valid) {
+            return false;
+        }
+        binding->device_id = device_id;
+        binding->max_apdu = (uint16_t)max_apdu;
+    }
+    bacnet_address_copy(&entry->dest, &binding->dest);
+    entry->max_apdu = binding->max_apdu;
+
+    return true;
+}
+
+/**
+ * @brief Encode an event once for all of its recipients, into a free
+ *  event slot. The process identifier of each recipient replaces the
+ *  one at the start of the service request when it is sent.
+ * @param event_data [in] the event
+ * @return index of the encoded event, or -1 if there is no free slot
+ *  or the event does not fit
+ */
+static int notification_event_encode(BACNET_EVENT_NOTIFICATION_DATA *event_data)
+{
+    struct nc_notify_event *event;
+    size_t len;
+    unsigned i;
+
+    for (i = 0; i < NC_NOTIFY_EVENTS_MAX; i++) {
+        event = &NC_Notify_Event[i];
+        if (event->refs == 0) {
+            event_data->processIdentifier = 0;
+            /* leave room for the APDU header and a larger process id */
+            len = event_notification_service_request_encode(
+                event->service_request, sizeof(event->service_request) - 8,
+                event_data);
+            if (len == 0) {
+                return -1;
+            }
+            event->len = (uint16_t)len;
+            event->offset = (uint8_t)encode_context_unsigned(NULL, 0, 0);
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Queue a notification to a recipient
+ * @param entry [in] the notification
+ * @return true if there was room in the queue
+ */
+static bool notification_enqueue(const struct nc_notify_entry *entry)
+{
+    if (NC_Notify_Count >= NC_NOTIFY_QUEUE_SIZE) {
         return false;
     }
+    NC_Notify_Queue[(NC_Notify_Head + NC_Notify_Count) %
+                    NC_NOTIFY_QUEUE_SIZE] = *entry;
+    NC_Notify_Count++;
+    NC_Notify_Event[entry->event].refs++;
+    if (NC_Notify_Count > NC_Notify_Stats.queued_max) {
+        NC_Notify_Stats.queued_max = NC_Notify_Count;
+    }
 
     return true;
 }
 
+/**
+ * @brief Determine if a notification must wait for one that is waiting
+ *  before it to the same recipient
+ * @param entry [in] the notification
+ * @param waiting [in] number of notifications waiting at the head of
+ *  the queue, which are before this one
+ * @return true if one of them is to the same recipient
+ */
+static bool notification_recipient_waiting(
+    const struct nc_notify_entry *entry, unsigned waiting)
+{
+    unsigned i;
+
+    for (i = 0; i < waiting; i++) {
+        if (bacnet_address_same(
+                &entry->dest,
+                &NC_Notify_Queue[(NC_Notify_Head + i) % NC_NOTIFY_QUEUE_SIZE]
+                     .dest)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Send one notification that was waiting
+ * @param entry [in] the notification
+ */
+static void notification_send(struct nc_notify_entry *entry)
+{
+    struct nc_notify_event *event;
+    uint16_t pdu_size;
+    int len;
+    bool sent;
+
+    event = &NC_Notify_Event[entry->event];
+    len = encode_context_unsigned(NC_Service_Request, 0, entry->process_id);
+    memcpy(
+        &NC_Service_Request[len], &event->service_request[event->offset],
+        event->len - event->offset);
+    len += event->len - event->offset;
+    if (entry->confirmed) {
+        pdu_size = entry->max_apdu;
+        if (pdu_size > sizeof(Event_Buffer)) {
+            pdu_size = sizeof(Event_Buffer);
+        }
+        sent = Send_CEvent_Notify_Service_Request(
+                   Event_Buffer, pdu_size, NC_Service_Request, (uint16_t)len,
+                   &entry->dest) != 0;
+    } else {
+        sent = Send_UEvent_Notify_Service_Request(
+                   Event_Buffer, sizeof(Event_Buffer), NC_Service_Request,
+                   (uint16_t)len, &entry->dest) > 0;
+    }
+    if (sent) {
+        NC_Notify_Stats.sent++;
+    } else {
+        NC_Notify_Stats.dropped++;
+    }
+    event->refs--;
+}
+
+/**
+ * @brief Send the notifications that are waiting, in the order they
+ *  were queued to each recipient. A confirmed notification waits in the
+ *  queue until a transaction is available for it, and so do the ones
+ *  after it to the same recipient. The notifications to other recipients
+ *  are sent past it.
+ *  Call this periodically to send the notifications that were waiting.
+ */
+void Notification_Class_Notify_Task(void)
+{
+    struct nc_notify_entry entry;
+    unsigned waiting = 0;
+    unsigned count = NC_Notify_Count;
+    unsigned i;
+
+    for (i = 0; i < count; i++) {
+        entry = NC_Notify_Queue[(NC_Notify_Head + i) % NC_NOTIFY_QUEUE_SIZE];
+        if ((entry.confirmed && !tsm_transaction_available()) ||
+            notification_recipient_waiting(&entry, waiting)) {
+            /* keep it waiting, after the others that wait */
+            NC_Notify_Queue[(NC_Notify_Head + waiting) % NC_NOTIFY_QUEUE_SIZE] =
+                entry;
+            waiting++;
+        } else {
+            notification_send(&entry);
+        }
+    }
+    NC_Notify_Count = waiting;
+}
+
+/**
+ * @brief Get the counters of the notifications sent to the recipients
+ * @param stats [out] the counters, and the notifications waiting
+ */
+void Notification_Class_Notify_Statistics(NC_NOTIFY_STATISTICS *stats)
+{
+    if (stats) {
+        *stats = NC_Notify_Stats;
+        stats->queued = NC_Notify_Count;
+    }
+}
+
+/**
+ * @brief Clear the counters of the notifications sent to the recipients
+ */
+void Notification_Class_Notify_Statistics_Clear(void)
+{
+    memset(&NC_Notify_Stats, 0, sizeof(NC_Notify_Stats));
+    NC_Notify_Stats.queued_max = NC_Notify_Count;
+}
+
+/**
+ * @brief Send an event to the active recipients of its notification
+ *  class. The event is encoded once, and a notification for each
+ *  recipient is queued and sent by Notification_Class_Notify_Task().
+ * @param event_data [in] the event
+ */
 void Notification_Class_common_reporting_function(
     BACNET_EVENT_NOTIFICATION_DATA *event_data)
 {
@@ -614,8 +867,11 @@ void Notification_Class_common_reporting_function(
 
     NOTIFICATION_CLASS_INFO *CurrentNotify;
     BACNET_DESTINATION *pBacDest;
+    BACNET_DATE_TIME DateTime;
+    struct nc_notify_entry entry = { 0 };
     uint32_t notify_index;
     uint8_t index;
+    int event_index = -1;
 
     notify_index =
         Notification_Class_Instance_To_Index(event_data->notificationClass);
@@ -669,49 +925,45 @@ void Notification_Class_common_reporting_function(
     debug_printf_stderr(
         "Notification Class[%u]: send notifications\n",
         event_data->notificationClass);
+    /* get actual date and time */
+    datetime_local(&DateTime.date, &DateTime.time, NULL, NULL);
     /* pointer to first recipient */
     pBacDest = &CurrentNotify->Recipient_List[0];
     for (index = 0; index < NC_MAX_RECIPIENTS; index++, pBacDest++) {
         if (bacnet_recipient_device_wildcard(&pBacDest->Recipient)) {
             continue;
         }
-        if (IsRecipientActive(pBacDest, event_data->toState)) {
-            BACNET_ADDRESS dest;
-            uint32_t device_id;
-            unsigned max_apdu;
-
-            /* Process Identifier */
-            event_data->processIdentifier = pBacDest->ProcessIdentifier;
-
-            /* send notification */
-            if (pBacDest->Recipient.tag == BACNET_RECIPIENT_TAG_DEVICE) {
-                /* send notification to the specified device */
-                device_id = pBacDest->Recipient.type.device.instance;
-                debug_printf_stderr(
-                    "Notification Class[%u]: send notification to %u\n",
-                    event_data->notificationClass, (unsigned)device_id);
-                if (pBacDest->ConfirmedNotify == true) {
-                    Send_CEvent_Notify(device_id, event_data);
-                } else if (address_get_by_device(device_id, &max_apdu, &dest)) {
-                    Send_UEvent_Notify(Event_Buffer, event_data, &dest);
-                }
-            } else if (
-                pBacDest->Recipient.tag == BACNET_RECIPIENT_TAG_ADDRESS) {
-                debug_printf_stderr(
-                    "Notification Class[%u]: send notification to ADDR\n",
-                    event_data->notificationClass);
-                /* send notification to the address indicated */
-                if (pBacDest->ConfirmedNotify == true) {
-                    if (address_get_device_id(&dest, &device_id)) {
-                        Send_CEvent_Notify(device_id, event_data);
-                    }
-                } else {
-                    dest = pBacDest->Recipient.type.address;
-                    Send_UEvent_Notify(Event_Buffer, event_data, &dest);
-                }
+        if (!IsRecipientActive(pBacDest, event_data->toState, &DateTime)) {
+            continue;
+        }
+        if (!notification_recipient_address(
+                notify_index, index, pBacDest, &entry)) {
+            NC_Notify_Stats.unbound++;
+            continue;
+        }
+        if (event_index < 0) {
+            event_index = notification_event_encode(event_data);
+            if (event_index < 0) {
+                /* make room by sending the notifications waiting */
+                Notification_Class_Notify_Task();
+                event_index = notification_event_encode(event_data);
+            }
+            if (event_index < 0) {
+                NC_Notify_Stats.dropped++;
+                continue;
+            }
+        }
+        entry.event = (uint8_t)event_index;
+        entry.process_id = pBacDest->ProcessIdentifier;
+        entry.confirmed = pBacDest->ConfirmedNotify;
+        if (!notification_enqueue(&entry)) {
+            Notification_Class_Notify_Task();
+            if (!notification_enqueue(&entry)) {
+                NC_Notify_Stats.dropped++;
             }
         }
     }
+    Notification_Class_Notify_Task();
 }
 
 /* This function tries to find the addresses of the defined devices. */
@@ -726,6 +978,8 @@ void Notification_Class_find_recipient(void)
     uint32_t device_id;
     unsigned i, j;
 
+    /* look up the recipient addresses again in the address cache */
+    memset(NC_Binding, 0, sizeof(NC_Binding));
     for (i = 0; i < MAX_NOTIFICATION_CLASSES; i++) {
         notification = &NC_Info[i];
         for (j = 0; j < NC_MAX_RECIPIENTS; j++) {
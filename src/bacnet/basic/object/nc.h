@@ -25,6 +25,16 @@ extern "C" {
 /* max "length" of recipient_list */
 #define NC_MAX_RECIPIENTS 10
 
+/* number of notifications waiting to be sent */
+#ifndef NC_NOTIFY_QUEUE_SIZE
+#define NC_NOTIFY_QUEUE_SIZE 32
+#endif
+
+/* number of encoded events that notifications are waiting to send */
+#ifndef NC_NOTIFY_EVENTS_MAX
+#define NC_NOTIFY_EVENTS_MAX 4
+#endif
+
 #if defined(INTRINSIC_REPORTING)
 
 /* Structure containing configuration for a Notification Class */
@@ -48,6 +58,15 @@ typedef struct Ack_Notification {
     uint8_t EventState;
 } ACK_NOTIFICATION;
 
+/* Counters of the notifications sent to the recipients */
+typedef struct Notification_Class_Notify_Statistics {
+    unsigned queued; /* notifications waiting to be sent */
+    unsigned queued_max; /* most notifications waiting at once */
+    uint32_t sent; /* notifications given to the datalink */
+    uint32_t dropped; /* notifications with no room to wait, or failed */
+    uint32_t unbound; /* notifications to a device with no address */
+} NC_NOTIFY_STATISTICS;
+
 BACNET_STACK_EXPORT
 void Notification_Class_Property_Lists(
     const int **pRequired, const int **pOptional, const int **pProprietary);
@@ -109,6 +128,15 @@ void Notification_Class_common_reporting_function(
 
 BACNET_STACK_EXPORT
 void Notification_Class_find_recipient(void);
+
+BACNET_STACK_EXPORT
+void Notification_Class_Notify_Task(void);
+
+BACNET_STACK_EXPORT
+void Notification_Class_Notify_Statistics(NC_NOTIFY_STATISTICS *stats);
+
+BACNET_STACK_EXPORT
+void Notification_Class_Notify_Statistics_Clear(void);
 #endif /* defined(INTRINSIC_REPORTING) */
 
 #ifdef __cplusplus
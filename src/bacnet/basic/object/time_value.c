@@ -170,15 +170,19 @@ bool Time_Value_Present_Value(uint32_t object_instance, BACNET_TIME *value)
 
 /**
  * @brief For a given object instance-number, checks the present-value for COV
+ * @param  object_instance - object-instance number of the object
  * @param  pObject - specific object with valid data
  * @param  value - time value
  */
 static void Time_Value_Present_Value_COV_Detect(
-    struct object_data *pObject, const BACNET_TIME *value)
+    uint32_t object_instance,
+    struct object_data *pObject,
+    const BACNET_TIME *value)
 {
     if (pObject && value) {
         if (datetime_compare_time(&pObject->Present_Value, value) != 0) {
             pObject->Change_Of_Value = true;
+            COV_CHANGE_NOTIFY(OBJECT_TIME_VALUE, object_instance);
         }
     }
 }
@@ -201,7 +205,8 @@ bool Time_Value_Present_Value_Set(
     if (pObject) {
         if (!pObject->Out_Of_Service) {
             if (value) {
-                Time_Value_Present_Value_COV_Detect(pObject, value);
+                Time_Value_Present_Value_COV_Detect(
+                    object_instance, pObject, value);
                 datetime_copy_time(&pObject->Present_Value, value);
                 status = true;
             }
@@ -238,7 +243,8 @@ static bool Time_Value_Present_Value_Write(
         (void)priority;
         if (pObject->Write_Enabled) {
             datetime_copy_time(&old_value, &pObject->Present_Value);
-            Time_Value_Present_Value_COV_Detect(pObject, value);
+            Time_Value_Present_Value_COV_Detect(
+                object_instance, pObject, value);
             datetime_copy_time(&pObject->Present_Value, value);
             if (pObject->Out_Of_Service) {
                 /* The physical point that the object represents
@@ -300,6 +306,7 @@ bool Time_Value_Out_Of_Service_Set(uint32_t object_instance, bool value)
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
             pObject->Change_Of_Value = true;
+            COV_CHANGE_NOTIFY(OBJECT_TIME_VALUE, object_instance);
         }
         pObject->Out_Of_Service = value;
         status = true;
@@ -32,6 +32,7 @@
 #define MAX_TREND_LOGS 8
 #endif
 
+/* built in log buffers, used unless other storage is set for a log */
 static TL_DATA_REC Logs[MAX_TREND_LOGS][TL_MAX_ENTRIES];
 static TL_LOG_INFO LogInfo[MAX_TREND_LOGS];
 
@@ -208,6 +209,9 @@ void Trend_Log_Init(void)
             LogInfo[iLog].ulLogInterval = 900;
             LogInfo[iLog].ulRecordCount = TL_MAX_ENTRIES;
             LogInfo[iLog].ulTotalRecordCount = 10000;
+            LogInfo[iLog].Records = Logs[iLog];
+            LogInfo[iLog].ulBufferSize = TL_MAX_ENTRIES;
+            LogInfo[iLog].State = NULL;
 
             LogInfo[iLog].Source.deviceIdentifier.instance =
                 Device_Object_Instance_Number();
@@ -231,6 +235,154 @@ void Trend_Log_Init(void)
     return;
 }
 
+/**
+ * @brief Get a record from the log buffer of a Trend Log
+ * @param CurrentLog - log to look in
+ * @param ulPosition - position in the log buffer, where 0 is the oldest
+ * @return the record
+ */
+static TL_DATA_REC *
+TL_Record(const TL_LOG_INFO *CurrentLog, uint32_t ulPosition)
+{
+    /* the oldest record is at the insertion point once the buffer is full */
+    if (CurrentLog->ulRecordCount >= CurrentLog->ulBufferSize) {
+        ulPosition += (uint32_t)CurrentLog->iIndex;
+        if (ulPosition >= CurrentLog->ulBufferSize) {
+            ulPosition -= CurrentLog->ulBufferSize;
+        }
+    }
+
+    return &CurrentLog->Records[ulPosition];
+}
+
+/**
+ * @brief Copy the log buffer state to the storage kept with the records
+ * @param CurrentLog - log that changed
+ */
+static void TL_State_Update(const TL_LOG_INFO *CurrentLog)
+{
+    TL_LOG_STATE *State = CurrentLog->State;
+
+    if (State) {
+        State->ulBufferSize = CurrentLog->ulBufferSize;
+        State->ulIndex = (uint32_t)CurrentLog->iIndex;
+        State->ulRecordCount = CurrentLog->ulRecordCount;
+        State->ulTotalRecordCount = CurrentLog->ulTotalRecordCount;
+    }
+}
+
+/**
+ * @brief Add a record to a Trend Log, pushing out the oldest if full
+ * @param iLog - index of the log
+ * @param pRecord - record to add
+ */
+static void TL_Insert_Record(int iLog, const TL_DATA_REC *pRecord)
+{
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+
+    CurrentLog->Records[CurrentLog->iIndex++] = *pRecord;
+    if ((uint32_t)CurrentLog->iIndex >= CurrentLog->ulBufferSize) {
+        CurrentLog->iIndex = 0;
+    }
+
+    CurrentLog->ulTotalRecordCount++;
+
+    if (CurrentLog->ulRecordCount < CurrentLog->ulBufferSize) {
+        CurrentLog->ulRecordCount++;
+    }
+    TL_State_Update(CurrentLog);
+}
+
+/**
+ * @brief Remove all the records from a Trend Log
+ * @param CurrentLog - log to empty
+ */
+static void TL_Purge_Records(TL_LOG_INFO *CurrentLog)
+{
+    CurrentLog->ulRecordCount = 0;
+    CurrentLog->iIndex = 0;
+    TL_State_Update(CurrentLog);
+}
+
+/**
+ * @brief Set the storage for the log buffer of a Trend Log, such as
+ *  battery backed RAM or a memory-mapped file, so that the log can hold
+ *  more than TL_MAX_ENTRIES records and can survive a restart.
+ *  Call after Trend_Log_Init().
+ * @param object_instance - object-instance number of the object
+ * @param records - storage for the records, or NULL to use the built in
+ *  log buffer of TL_MAX_ENTRIES records
+ * @param buffer_size - number of records the storage holds
+ * @param state - optional state kept with the records. If it describes a
+ *  buffer of buffer_size records, the records are kept in the log,
+ *  otherwise the log starts out empty.
+ * @return true if the log buffer was set
+ */
+bool Trend_Log_Buffer_Set(
+    uint32_t object_instance,
+    TL_DATA_REC *records,
+    uint32_t buffer_size,
+    TL_LOG_STATE *state)
+{
+    TL_LOG_INFO *CurrentLog;
+    unsigned log_index;
+
+    log_index = Trend_Log_Instance_To_Index(object_instance);
+    if (log_index >= MAX_TREND_LOGS) {
+        return false;
+    }
+    if (records && ((buffer_size == 0) || (buffer_size > INT32_MAX))) {
+        return false;
+    }
+    CurrentLog = &LogInfo[log_index];
+    if (records) {
+        CurrentLog->Records = records;
+        CurrentLog->ulBufferSize = buffer_size;
+        CurrentLog->State = state;
+    } else {
+        CurrentLog->Records = Logs[log_index];
+        CurrentLog->ulBufferSize = TL_MAX_ENTRIES;
+        CurrentLog->State = NULL;
+        state = NULL;
+    }
+    if (state && (state->ulBufferSize == buffer_size) &&
+        (state->ulIndex < buffer_size) &&
+        ((state->ulRecordCount == buffer_size) ||
+         (state->ulRecordCount == state->ulIndex))) {
+        /* restore the records kept in the storage */
+        CurrentLog->iIndex = (int)state->ulIndex;
+        CurrentLog->ulRecordCount = state->ulRecordCount;
+        CurrentLog->ulTotalRecordCount = state->ulTotalRecordCount;
+        if (CurrentLog->ulRecordCount > 0) {
+            CurrentLog->tLastDataTime =
+                TL_Record(CurrentLog, CurrentLog->ulRecordCount - 1)
+                    ->tTimeStamp;
+        }
+    } else {
+        /* sequence numbers carry on from the previous log buffer */
+        TL_Purge_Records(CurrentLog);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the number of records the log buffer of a Trend Log holds
+ * @param object_instance - object-instance number of the object
+ * @return number of records, or zero if the object does not exist
+ */
+uint32_t Trend_Log_Buffer_Size(uint32_t object_instance)
+{
+    unsigned log_index;
+
+    log_index = Trend_Log_Instance_To_Index(object_instance);
+    if (log_index >= MAX_TREND_LOGS) {
+        return 0;
+    }
+
+    return LogInfo[log_index].ulBufferSize;
+}
+
 /*
  * Note: we use the instance number here and build the name based
  * on the assumption that there is a 1 to 1 correspondence. If there
@@ -298,7 +450,8 @@ int Trend_Log_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
             break;
 
         case PROP_BUFFER_SIZE:
-            apdu_len = encode_application_unsigned(&apdu[0], TL_MAX_ENTRIES);
+            apdu_len = encode_application_unsigned(
+                &apdu[0], CurrentLog->ulBufferSize);
             break;
 
         case PROP_LOG_BUFFER:
@@ -443,7 +596,7 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
                  * set */
                 if ((CurrentLog->bEnable == false) &&
                     (CurrentLog->bStopWhenFull == true) &&
-                    (CurrentLog->ulRecordCount == TL_MAX_ENTRIES) &&
+                    (CurrentLog->ulRecordCount == CurrentLog->ulBufferSize) &&
                     (value.type.Boolean == true)) {
                     status = false;
                     wp_data->error_class = ERROR_CLASS_OBJECT;
@@ -486,7 +639,8 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
                     CurrentLog->bStopWhenFull = value.type.Boolean;
 
                     if ((value.type.Boolean == true) &&
-                        (CurrentLog->ulRecordCount == TL_MAX_ENTRIES) &&
+                        (CurrentLog->ulRecordCount ==
+                         CurrentLog->ulBufferSize) &&
                         (CurrentLog->bEnable == true)) {
                         /* When full log is switched from normal to stop when
                          * full disable the log and record the fact - see
@@ -515,8 +669,7 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
             if (status) {
                 if (value.type.Unsigned_Int == 0) {
                     /* Time to clear down the log */
-                    CurrentLog->ulRecordCount = 0;
-                    CurrentLog->iIndex = 0;
+                    TL_Purge_Records(CurrentLog);
                     TL_Insert_Status_Rec(
                         log_index, LOG_STATUS_BUFFER_PURGED, true);
                 }
@@ -681,8 +834,7 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
                     &TempSource, &CurrentLog->Source,
                     sizeof(BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE)) != 0) {
                 /* Clear buffer if property being logged is changed */
-                CurrentLog->ulRecordCount = 0;
-                CurrentLog->iIndex = 0;
+                TL_Purge_Records(CurrentLog);
                 TL_Insert_Status_Rec(log_index, LOG_STATUS_BUFFER_PURGED, true);
             }
             CurrentLog->Source = TempSource;
@@ -799,11 +951,8 @@ bool TrendLogGetRRInfo(
 
 void TL_Insert_Status_Rec(int iLog, BACNET_LOG_STATUS eStatus, bool bState)
 {
-    TL_LOG_INFO *CurrentLog;
     TL_DATA_REC TempRec;
 
-    CurrentLog = &LogInfo[iLog];
-
     TempRec.tTimeStamp = Trend_Log_Epoch_Seconds_Now();
     TempRec.ucRecType = TL_TYPE_STATUS;
     TempRec.ucStatus = 0;
@@ -828,16 +977,7 @@ void TL_Insert_Status_Rec(int iLog, BACNET_LOG_STATUS eStatus, bool bState)
             break;
     }
 
-    Logs[iLog][CurrentLog->iIndex++] = TempRec;
-    if (CurrentLog->iIndex >= TL_MAX_ENTRIES) {
-        CurrentLog->iIndex = 0;
-    }
-
-    CurrentLog->ulTotalRecordCount++;
-
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES) {
-        CurrentLog->ulRecordCount++;
-    }
+    TL_Insert_Record(iLog, &TempRec);
 }
 
 /*****************************************************************************
@@ -1229,6 +1369,38 @@ int TL_encode_by_sequence(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
     return (iLen);
 }
 
+/**
+ * @brief Binary search the log buffer of a Trend Log by time. The records
+ *  are in the order they were inserted, and so are sorted by time stamp
+ *  as long as the clock does not go backwards.
+ * @param CurrentLog - log to search, with at least one record
+ * @param tRefTime - time to look for
+ * @param bInclusive - true to also count records stamped at tRefTime
+ * @return number of records stamped before tRefTime (or at tRefTime when
+ *  bInclusive), which is the position of the first record after them
+ */
+static uint32_t TL_Search_By_Time(
+    const TL_LOG_INFO *CurrentLog, bacnet_time_t tRefTime, bool bInclusive)
+{
+    uint32_t ulLow = 0;
+    uint32_t ulHigh = CurrentLog->ulRecordCount;
+    uint32_t ulMiddle = 0;
+    bacnet_time_t tTimeStamp;
+
+    while (ulLow < ulHigh) {
+        ulMiddle = ulLow + ((ulHigh - ulLow) / 2);
+        tTimeStamp = TL_Record(CurrentLog, ulMiddle)->tTimeStamp;
+        if ((tTimeStamp < tRefTime) ||
+            (bInclusive && (tTimeStamp == tRefTime))) {
+            ulLow = ulMiddle + 1;
+        } else {
+            ulHigh = ulMiddle;
+        }
+    }
+
+    return ulLow;
+}
+
 /****************************************************************************
  * Handle encoding for the By Time option.                                  *
  * The fact that the buffer always has at least a single entry is used      *
@@ -1249,6 +1421,7 @@ int TL_encode_by_time(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
     uint32_t uiLast = 0; /* Entry number we finished encoding on */
     uint32_t uiRemaining = 0; /* Amount of unused space in packet */
     uint32_t uiFirstSeq = 0; /* Sequence number for 1st record in log */
+    uint32_t uiPosition = 0; /* Position found by searching the log */
     bacnet_time_t tRefTime = 0; /* The time from the request in local format */
 
     /* See how much space we have */
@@ -1257,33 +1430,18 @@ int TL_encode_by_time(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
     CurrentLog = &LogInfo[log_index];
 
     tRefTime = TL_BAC_Time_To_Local(&pRequest->Range.RefTime);
-    /* Find correct position for oldest entry in log */
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES) {
-        uiIndex = 0;
-    } else {
-        uiIndex = CurrentLog->iIndex;
-    }
-
     if (pRequest->Count < 0) {
-        /* Start at end of log and look for record which has
-         * timestamp greater than or equal to the reference.
+        /* Look for the last record which has a timestamp less than the
+         * reference.
          */
-        iCount = CurrentLog->ulRecordCount - 1;
-        /* Start out with the sequence number for the last record */
-        uiFirstSeq = CurrentLog->ulTotalRecordCount;
-        for (;;) {
-            if (Logs[pRequest->object_instance]
-                    [(uiIndex + iCount) % TL_MAX_ENTRIES]
-                        .tTimeStamp < tRefTime) {
-                break;
-            }
-
-            uiFirstSeq--;
-            iCount--;
-            if (iCount < 0) {
-                return (0);
-            }
+        uiPosition = TL_Search_By_Time(CurrentLog, tRefTime, false);
+        if (uiPosition == 0) {
+            return (0);
         }
+        iCount = uiPosition - 1;
+        /* Sequence number for that record */
+        uiFirstSeq = CurrentLog->ulTotalRecordCount -
+            (CurrentLog->ulRecordCount - 1) + iCount;
 
         /* We have an and point for our request,
          * now work backwards to find where we should start from
@@ -1305,27 +1463,18 @@ int TL_encode_by_time(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
             iCount -= iTemp;
         }
     } else {
-        /* Start at beginning of log and look for 1st record which has
-         * timestamp greater than the reference time.
+        /* Look for the 1st record which has a timestamp greater than the
+         * reference time.
          */
-        iCount = 0;
+        uiPosition = TL_Search_By_Time(CurrentLog, tRefTime, true);
+        if (uiPosition == CurrentLog->ulRecordCount) {
+            return (0);
+        }
+        iCount = uiPosition;
         /* Figure out the sequence number for the first record, last is
          * ulTotalRecordCount */
-        uiFirstSeq =
-            CurrentLog->ulTotalRecordCount - (CurrentLog->ulRecordCount - 1);
-        for (;;) {
-            if (Logs[pRequest->object_instance]
-                    [(uiIndex + iCount) % TL_MAX_ENTRIES]
-                        .tTimeStamp > tRefTime) {
-                break;
-            }
-
-            uiFirstSeq++;
-            iCount++;
-            if ((uint32_t)iCount == CurrentLog->ulRecordCount) {
-                return (0);
-            }
-        }
+        uiFirstSeq = CurrentLog->ulTotalRecordCount -
+            (CurrentLog->ulRecordCount - 1) + iCount;
     }
 
     /* We now have a starting point for the operation and a +ve count */
@@ -1382,15 +1531,9 @@ int TL_encode_entry(uint8_t *apdu, int iLog, int iEntry)
     uint8_t ucCount = 0;
     BACNET_DATE_TIME TempTime;
 
-    /* Convert from BACnet 1 based to 0 based array index and then
-     * handle wrap around of the circular buffer */
-
-    if (LogInfo[iLog].ulRecordCount < TL_MAX_ENTRIES) {
-        pSource = &Logs[iLog][(iEntry - 1) % TL_MAX_ENTRIES];
-    } else {
-        pSource =
-            &Logs[iLog][(LogInfo[iLog].iIndex + iEntry - 1) % TL_MAX_ENTRIES];
-    }
+    /* Convert from BACnet 1 based to 0 based position in the
+     * circular buffer */
+    pSource = TL_Record(&LogInfo[iLog], (uint32_t)(iEntry - 1));
 
     iLen = 0;
     /* First stick the time stamp in with tag [0] */
@@ -1652,16 +1795,7 @@ static void TL_fetch_property(int iLog)
         TempRec.ucStatus = 128 | bitstring_octet(&TempBits, 0);
     }
 
-    Logs[iLog][CurrentLog->iIndex++] = TempRec;
-    if (CurrentLog->iIndex >= TL_MAX_ENTRIES) {
-        CurrentLog->iIndex = 0;
-    }
-
-    CurrentLog->ulTotalRecordCount++;
-
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES) {
-        CurrentLog->ulRecordCount++;
-    }
+    TL_Insert_Record(iLog, &TempRec);
 }
 
 /****************************************************************************
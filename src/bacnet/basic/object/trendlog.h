@@ -69,6 +69,16 @@ typedef struct tl_data_record {
 
 #define TL_MAX_ENTRIES 1000 /* Entries per datalog */
 
+/* State of a log buffer that is kept with the records, so that a log held
+ * in non-volatile or memory-mapped storage can be restored at startup */
+
+typedef struct tl_log_state {
+    uint32_t ulBufferSize; /* Number of records the buffer holds */
+    uint32_t ulIndex; /* Current insertion point */
+    uint32_t ulRecordCount; /* Count of items currently in the buffer */
+    uint32_t ulTotalRecordCount; /* Count of all items ever inserted */
+} TL_LOG_STATE;
+
 /* Structure containing config and status info for a Trend Log */
 
 typedef struct tl_log_info {
@@ -92,6 +102,9 @@ typedef struct tl_log_info {
     bool bTrigger; /* Set to 1 to cause a reading to be taken */
     int iIndex; /* Current insertion point */
     bacnet_time_t tLastDataTime;
+    TL_DATA_REC *Records; /* Log buffer, oldest record at iIndex when full */
+    uint32_t ulBufferSize; /* Number of records the log buffer holds */
+    TL_LOG_STATE *State; /* Optional copy of the state kept with Records */
 } TL_LOG_INFO;
 
 /*
@@ -139,6 +152,22 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data);
 BACNET_STACK_EXPORT
 void Trend_Log_Init(void);
 
+BACNET_STACK_EXPORT
+bool Trend_Log_Buffer_Set(
+    uint32_t object_instance,
+    TL_DATA_REC *records,
+    uint32_t buffer_size,
+    TL_LOG_STATE *state);
+BACNET_STACK_EXPORT
+uint32_t Trend_Log_Buffer_Size(uint32_t object_instance);
+
+/* Log buffer in a memory-mapped file - implemented in the ports module */
+BACNET_STACK_EXPORT
+bool Trend_Log_Storage_Open(
+    uint32_t object_instance, const char *pathname, uint32_t buffer_size);
+BACNET_STACK_EXPORT
+void Trend_Log_Storage_Close(uint32_t object_instance);
+
 BACNET_STACK_EXPORT
 void TL_Insert_Status_Rec(int iLog, BACNET_LOG_STATUS eStatus, bool bState);
 
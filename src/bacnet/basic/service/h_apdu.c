@@ -8,6 +8,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
@@ -16,6 +17,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/dcc.h"
 #include "bacnet/iam.h"
+#include "bacnet/npdu.h"
 /* basic objects, services, TSM */
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/tsm/tsm.h"
@@ -25,6 +27,8 @@
 static uint16_t Timeout_Milliseconds = 3000;
 /* Number of APDU Retries */
 static uint8_t Number_Of_Retries = 3;
+/* APDU Segment Timeout in Milliseconds */
+static uint16_t Segment_Timeout_Milliseconds = 2000;
 static uint8_t Local_Network_Priority; /* Fixing test 10.1.2 Network priority */
 
 /* a simple table for crossing the services supported */
@@ -492,6 +496,16 @@ void apdu_retries_set(uint8_t value)
     Number_Of_Retries = value;
 }
 
+uint16_t apdu_segment_timeout(void)
+{
+    return Segment_Timeout_Milliseconds;
+}
+
+void apdu_segment_timeout_set(uint16_t milliseconds)
+{
+    Segment_Timeout_Milliseconds = milliseconds;
+}
+
 /* When network communications are completely disabled,
    only DeviceCommunicationControl and ReinitializeDevice APDUs
    shall be processed and no messages shall be initiated.
@@ -552,6 +566,266 @@ static bool apdu_unconfirmed_dcc_disabled(uint8_t service_choice)
     return status;
 }
 
+#if BACNET_APDU_STATISTICS
+/* buckets for each power of two microseconds */
+#define APDU_STATISTICS_SUB_BUCKET_BITS 2
+#define APDU_STATISTICS_SUB_BUCKETS (1U << APDU_STATISTICS_SUB_BUCKET_BITS)
+
+static BACNET_APDU_SERVICE_STATISTICS
+    Confirmed_Statistics[MAX_BACNET_CONFIRMED_SERVICE];
+static BACNET_APDU_SERVICE_STATISTICS
+    Unconfirmed_Statistics[MAX_BACNET_UNCONFIRMED_SERVICE];
+static apdu_statistics_timer_function Statistics_Timer;
+/* time one of every so many requests */
+static unsigned Statistics_Sample_Rate = 1;
+static unsigned Statistics_Sample_Count;
+
+/**
+ * @brief Set the clock used to time the service handlers. Without a
+ *  clock, only the requests and replies are counted.
+ * @param timer - free running clock of microseconds, or NULL
+ */
+void apdu_statistics_timer_set(apdu_statistics_timer_function timer)
+{
+    Statistics_Timer = timer;
+}
+
+/**
+ * @brief Set how often the service handlers are timed, to keep the cost
+ *  of reading the clock down on a busy device. Every request is counted.
+ * @param rate - time one of every rate requests, 1 to time all of them
+ */
+void apdu_statistics_sample_rate_set(unsigned rate)
+{
+    if (rate > 0) {
+        Statistics_Sample_Rate = rate;
+    }
+}
+
+/**
+ * @brief Get how often the service handlers are timed
+ * @return one of every so many requests is timed
+ */
+unsigned apdu_statistics_sample_rate(void)
+{
+    return Statistics_Sample_Rate;
+}
+
+/**
+ * @brief Get the counters of a confirmed service since the last clear
+ * @param service_choice - confirmed service
+ * @param stats - counters are copied here
+ * @return true if the service is known
+ */
+bool apdu_statistics_confirmed(
+    BACNET_CONFIRMED_SERVICE service_choice,
+    BACNET_APDU_SERVICE_STATISTICS *stats)
+{
+    if ((service_choice >= MAX_BACNET_CONFIRMED_SERVICE) || !stats) {
+        return false;
+    }
+    *stats = Confirmed_Statistics[service_choice];
+
+    return true;
+}
+
+/**
+ * @brief Get the counters of an unconfirmed service since the last clear
+ * @param service_choice - unconfirmed service
+ * @param stats - counters are copied here
+ * @return true if the service is known
+ */
+bool apdu_statistics_unconfirmed(
+    BACNET_UNCONFIRMED_SERVICE service_choice,
+    BACNET_APDU_SERVICE_STATISTICS *stats)
+{
+    if ((service_choice >= MAX_BACNET_UNCONFIRMED_SERVICE) || !stats) {
+        return false;
+    }
+    *stats = Unconfirmed_Statistics[service_choice];
+
+    return true;
+}
+
+/**
+ * @brief Find the histogram bucket of a handler execution time
+ * @param microseconds - execution time
+ * @return index of the bucket
+ */
+static unsigned apdu_statistics_bucket(uint32_t microseconds)
+{
+    unsigned magnitude = APDU_STATISTICS_SUB_BUCKET_BITS;
+    unsigned sub_bucket;
+
+    if (microseconds < APDU_STATISTICS_SUB_BUCKETS) {
+        return microseconds;
+    }
+    if (microseconds >= (1UL << APDU_STATISTICS_MAGNITUDE_MAX)) {
+        return APDU_STATISTICS_BUCKETS - 1;
+    }
+    while ((microseconds >> (magnitude + 1)) != 0) {
+        magnitude++;
+    }
+    sub_bucket = microseconds >> (magnitude - APDU_STATISTICS_SUB_BUCKET_BITS);
+    sub_bucket &= APDU_STATISTICS_SUB_BUCKETS - 1;
+
+    return ((magnitude - APDU_STATISTICS_SUB_BUCKET_BITS + 1)
+            << APDU_STATISTICS_SUB_BUCKET_BITS) +
+        sub_bucket;
+}
+
+/**
+ * @brief Get the longest execution time counted in a histogram bucket
+ * @param index - index of the bucket
+ * @return microseconds, or UINT32_MAX for the last bucket
+ */
+uint32_t apdu_statistics_bucket_microseconds(unsigned index)
+{
+    unsigned magnitude, sub_bucket;
+
+    if (index < APDU_STATISTICS_SUB_BUCKETS) {
+        return index;
+    }
+    if (index >= (APDU_STATISTICS_BUCKETS - 1)) {
+        return UINT32_MAX;
+    }
+    magnitude = (index >> APDU_STATISTICS_SUB_BUCKET_BITS) +
+        APDU_STATISTICS_SUB_BUCKET_BITS - 1;
+    sub_bucket = index & (APDU_STATISTICS_SUB_BUCKETS - 1);
+
+    return ((uint32_t)(APDU_STATISTICS_SUB_BUCKETS + sub_bucket + 1)
+            << (magnitude - APDU_STATISTICS_SUB_BUCKET_BITS)) -
+        1;
+}
+
+/**
+ * @brief Get the execution time that a percentage of the timed requests
+ *  of a service took no longer than, such as 99 for the 99th percentile
+ * @param stats - counters of a service
+ * @param percent - 1 to 100
+ * @return the longest time of the bucket holding the percentile, no more
+ *  than the longest time, in microseconds
+ */
+uint32_t apdu_statistics_percentile(
+    const BACNET_APDU_SERVICE_STATISTICS *stats, unsigned percent)
+{
+    uint32_t target, count = 0, microseconds = 0;
+    unsigned index;
+
+    if (!stats || (stats->samples == 0)) {
+        return 0;
+    }
+    if (percent > 100) {
+        percent = 100;
+    }
+    /* the rank of the percentile, rounded up */
+    target = ((stats->samples / 100) * percent) +
+        (((stats->samples % 100) * percent) + 99) / 100;
+    if (target == 0) {
+        target = 1;
+    }
+    for (index = 0; index < APDU_STATISTICS_BUCKETS; index++) {
+        count += stats->histogram[index];
+        if (count >= target) {
+            microseconds = apdu_statistics_bucket_microseconds(index);
+            break;
+        }
+    }
+    if (microseconds > stats->max_microseconds) {
+        microseconds = stats->max_microseconds;
+    }
+
+    return microseconds;
+}
+
+/**
+ * @brief Clear the counters of all of the services
+ */
+void apdu_statistics_clear(void)
+{
+    memset(Confirmed_Statistics, 0, sizeof(Confirmed_Statistics));
+    memset(Unconfirmed_Statistics, 0, sizeof(Unconfirmed_Statistics));
+    Statistics_Sample_Count = 0;
+}
+
+/**
+ * @brief Count a request to a service, and start timing it when sampled
+ * @param stats - counters of the service
+ * @param start - start time, if timed
+ * @return true if the request is timed
+ */
+static bool apdu_statistics_request(
+    BACNET_APDU_SERVICE_STATISTICS *stats, uint32_t *start)
+{
+    stats->requests++;
+    if (!Statistics_Timer) {
+        return false;
+    }
+    Statistics_Sample_Count++;
+    if (Statistics_Sample_Count < Statistics_Sample_Rate) {
+        return false;
+    }
+    Statistics_Sample_Count = 0;
+    *start = Statistics_Timer();
+
+    return true;
+}
+
+/**
+ * @brief Count the execution time of a timed request
+ * @param stats - counters of the service
+ * @param start - start time of the request
+ */
+static void apdu_statistics_time(
+    BACNET_APDU_SERVICE_STATISTICS *stats, uint32_t start)
+{
+    uint32_t microseconds;
+
+    /* unsigned difference handles the clock wrapping around */
+    microseconds = Statistics_Timer() - start;
+    stats->samples++;
+    stats->histogram[apdu_statistics_bucket(microseconds)]++;
+    if (microseconds > stats->max_microseconds) {
+        stats->max_microseconds = microseconds;
+    }
+}
+
+/**
+ * @brief Count the reply that a confirmed service handler encoded in the
+ *  Handler_Transmit_Buffer, which was marked as empty before the handler
+ * @param stats - counters of the service
+ */
+static void apdu_statistics_reply(BACNET_APDU_SERVICE_STATISTICS *stats)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    int len;
+
+    if (Handler_Transmit_Buffer[0] != BACNET_PROTOCOL_VERSION) {
+        /* no reply, or the reply was sent from another buffer */
+        return;
+    }
+    len = bacnet_npdu_decode(
+        Handler_Transmit_Buffer, sizeof(Handler_Transmit_Buffer), NULL, NULL,
+        &npdu_data);
+    if ((len <= 0) || npdu_data.network_layer_message) {
+        return;
+    }
+    switch (Handler_Transmit_Buffer[len] & 0xF0) {
+        case PDU_TYPE_ERROR:
+            stats->errors++;
+            break;
+        case PDU_TYPE_REJECT:
+            stats->rejects++;
+            break;
+        case PDU_TYPE_ABORT:
+            stats->aborts++;
+            break;
+        default:
+            break;
+    }
+}
+#endif
+
 /** Process the APDU header and invoke the appropriate service handler
  * to manage the received request.
  * Almost all requests and ACKs invoke this function.
@@ -572,6 +846,14 @@ void apdu_handler(
     uint8_t *service_request = NULL;
     uint16_t service_request_len = 0;
     int len = 0; /* counts where we are in PDU */
+#if BACNET_SEGMENTATION_ENABLED
+    bool reassembled = false;
+#endif
+#if BACNET_APDU_STATISTICS
+    BACNET_APDU_SERVICE_STATISTICS *stats = NULL;
+    uint32_t start = 0;
+    bool timed = false;
+#endif
 #if !BACNET_SVC_SERVER
     uint8_t invoke_id = 0;
     BACNET_CONFIRMED_SERVICE_ACK_DATA service_ack_data = { 0 };
@@ -604,6 +886,25 @@ void apdu_handler(
                     initiated. */
                 break;
             }
+#if BACNET_SEGMENTATION_ENABLED
+            if (service_data.segmented_message) {
+                if (!tsm_segmented_request_received(
+                        src, &service_data, service_choice, &service_request,
+                        &service_request_len)) {
+                    /* waiting for more segments */
+                    break;
+                }
+                reassembled = true;
+            }
+#endif
+#if BACNET_APDU_STATISTICS
+            if (service_choice < MAX_BACNET_CONFIRMED_SERVICE) {
+                stats = &Confirmed_Statistics[service_choice];
+                timed = apdu_statistics_request(stats, &start);
+                /* mark the buffer empty to see the reply */
+                Handler_Transmit_Buffer[0] = 0;
+            }
+#endif
             if ((service_choice < MAX_BACNET_CONFIRMED_SERVICE) &&
                 (Confirmed_Function[service_choice])) {
                 Confirmed_Function[service_choice](
@@ -612,6 +913,19 @@ void apdu_handler(
                 Unrecognized_Service_Handler(
                     service_request, service_request_len, src, &service_data);
             }
+#if BACNET_APDU_STATISTICS
+            if (stats) {
+                if (timed) {
+                    apdu_statistics_time(stats, start);
+                }
+                apdu_statistics_reply(stats);
+            }
+#endif
+#if BACNET_SEGMENTATION_ENABLED
+            if (reassembled) {
+                tsm_segmented_request_complete(src, service_data.invoke_id);
+            }
+#endif
             break;
         case PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST:
             if (apdu_len < 2) {
@@ -631,10 +945,19 @@ void apdu_handler(
                 break;
             }
             if (service_choice < MAX_BACNET_UNCONFIRMED_SERVICE) {
+#if BACNET_APDU_STATISTICS
+                stats = &Unconfirmed_Statistics[service_choice];
+                timed = apdu_statistics_request(stats, &start);
+#endif
                 if (Unconfirmed_Function[service_choice]) {
                     Unconfirmed_Function[service_choice](
                         service_request, service_request_len, src);
                 }
+#if BACNET_APDU_STATISTICS
+                if (timed) {
+                    apdu_statistics_time(stats, start);
+                }
+#endif
             }
             break;
 #if !BACNET_SVC_SERVER
@@ -649,7 +972,7 @@ void apdu_handler(
                     Confirmed_ACK_Function[service_choice].simple(
                         src, invoke_id);
                 }
-                tsm_free_invoke_id(invoke_id);
+                tsm_peer_free_invoke_id(src, invoke_id);
             }
             break;
         case PDU_TYPE_COMPLEX_ACK:
@@ -672,6 +995,15 @@ void apdu_handler(
             /* prepare the service request buffer and length */
             service_request_len = apdu_len - (uint16_t)len;
             service_request = &apdu[len];
+#if BACNET_SEGMENTATION_ENABLED
+            if (service_ack_data.segmented_message &&
+                !tsm_segmented_complex_ack_received(
+                    src, &service_ack_data, &service_request,
+                    &service_request_len)) {
+                /* waiting for more segments */
+                break;
+            }
+#endif
             if (!apdu_confirmed_simple_ack_service(service_choice)) {
                 if (service_choice < MAX_BACNET_CONFIRMED_SERVICE) {
                     if (Confirmed_ACK_Function[service_choice].complex !=
@@ -681,14 +1013,9 @@ void apdu_handler(
                             &service_ack_data);
                     }
                 }
-                tsm_free_invoke_id(invoke_id);
+                tsm_peer_free_invoke_id(src, invoke_id);
             }
             break;
-        case PDU_TYPE_SEGMENT_ACK:
-            /* FIXME: what about a denial of service attack here?
-                we could check src to see if that matched the tsm */
-            tsm_free_invoke_id(invoke_id);
-            break;
         case PDU_TYPE_ERROR:
             if (apdu_len < 3) {
                 break;
@@ -714,7 +1041,7 @@ void apdu_handler(
                         (BACNET_ERROR_CODE)error_code);
                 }
             }
-            tsm_free_invoke_id(invoke_id);
+            tsm_peer_free_invoke_id(src, invoke_id);
             break;
         case PDU_TYPE_REJECT:
             if (apdu_len < 3) {
@@ -725,7 +1052,7 @@ void apdu_handler(
             if (Reject_Function) {
                 Reject_Function(src, invoke_id, reason);
             }
-            tsm_free_invoke_id(invoke_id);
+            tsm_peer_free_invoke_id(src, invoke_id);
             break;
         case PDU_TYPE_ABORT:
             if (apdu_len < 3) {
@@ -734,12 +1061,32 @@ void apdu_handler(
             server = apdu[0] & 0x01;
             invoke_id = apdu[1];
             reason = apdu[2];
+#if BACNET_SEGMENTATION_ENABLED
+            if (!server) {
+                tsm_segmented_abort_received(src, invoke_id);
+            }
+#endif
             if (Abort_Function) {
                 Abort_Function(src, invoke_id, reason, server);
             }
-            tsm_free_invoke_id(invoke_id);
+            tsm_peer_free_invoke_id(src, invoke_id);
             break;
 #endif
+        case PDU_TYPE_SEGMENT_ACK:
+#if BACNET_SEGMENTATION_ENABLED
+            if (apdu_len < 4) {
+                break;
+            }
+            tsm_segment_ack_received(
+                src, apdu[1], apdu[2], apdu[3],
+                (apdu[0] & BIT(1)) ? true : false,
+                (apdu[0] & BIT(0)) ? true : false);
+#elif !BACNET_SVC_SERVER
+            /* FIXME: what about a denial of service attack here?
+                we could check src to see if that matched the tsm */
+            tsm_free_invoke_id(invoke_id);
+#endif
+            break;
         default:
             break;
     }
@@ -83,6 +83,33 @@ typedef void (*abort_function)(
 typedef void (*reject_function)(
     BACNET_ADDRESS *src, uint8_t invoke_id, uint8_t reject_reason);
 
+#if BACNET_APDU_STATISTICS
+/* Handler execution times are counted in buckets, four to each power of
+   two microseconds, so each bucket is within 25% of the times it holds.
+   Times of 2^24 microseconds (about 17 seconds) or more are counted in
+   the last bucket. */
+#define APDU_STATISTICS_MAGNITUDE_MAX 24
+#define APDU_STATISTICS_BUCKETS ((APDU_STATISTICS_MAGNITUDE_MAX - 1) * 4)
+
+/* counters of one service since the last clear */
+typedef struct BACnet_APDU_Service_Statistics {
+    /* requests given to the service handler */
+    uint32_t requests;
+    /* Error, Reject, and Abort replies from the service handler */
+    uint32_t errors;
+    uint32_t rejects;
+    uint32_t aborts;
+    /* number of requests that were timed, and the longest time */
+    uint32_t samples;
+    uint32_t max_microseconds;
+    /* number of timed requests in each bucket */
+    uint32_t histogram[APDU_STATISTICS_BUCKETS];
+} BACNET_APDU_SERVICE_STATISTICS;
+
+/* free running clock of microseconds for timing the service handlers */
+typedef uint32_t (*apdu_statistics_timer_function)(void);
+#endif
+
 BACNET_STACK_EXPORT
 void apdu_set_confirmed_ack_handler(
     BACNET_CONFIRMED_SERVICE service_choice, confirmed_ack_function pFunction);
@@ -155,6 +182,10 @@ BACNET_STACK_EXPORT
 uint8_t apdu_retries(void);
 BACNET_STACK_EXPORT
 void apdu_retries_set(uint8_t value);
+BACNET_STACK_EXPORT
+uint16_t apdu_segment_timeout(void);
+BACNET_STACK_EXPORT
+void apdu_segment_timeout_set(uint16_t value);
 
 BACNET_STACK_EXPORT
 void apdu_handler(
@@ -162,6 +193,30 @@ void apdu_handler(
     uint8_t *apdu, /* APDU data */
     uint16_t pdu_len); /* for confirmed messages */
 
+#if BACNET_APDU_STATISTICS
+BACNET_STACK_EXPORT
+void apdu_statistics_timer_set(apdu_statistics_timer_function timer);
+BACNET_STACK_EXPORT
+void apdu_statistics_sample_rate_set(unsigned rate);
+BACNET_STACK_EXPORT
+unsigned apdu_statistics_sample_rate(void);
+BACNET_STACK_EXPORT
+bool apdu_statistics_confirmed(
+    BACNET_CONFIRMED_SERVICE service_choice,
+    BACNET_APDU_SERVICE_STATISTICS *stats);
+BACNET_STACK_EXPORT
+bool apdu_statistics_unconfirmed(
+    BACNET_UNCONFIRMED_SERVICE service_choice,
+    BACNET_APDU_SERVICE_STATISTICS *stats);
+BACNET_STACK_EXPORT
+uint32_t apdu_statistics_bucket_microseconds(unsigned index);
+BACNET_STACK_EXPORT
+uint32_t apdu_statistics_percentile(
+    const BACNET_APDU_SERVICE_STATISTICS *stats, unsigned percent);
+BACNET_STACK_EXPORT
+void apdu_statistics_clear(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -95,6 +95,10 @@ void handler_atomic_read_file(
     BACNET_ADDRESS my_address;
     BACNET_ERROR_CLASS error_class = ERROR_CLASS_OBJECT;
     BACNET_ERROR_CODE error_code = ERROR_CODE_UNKNOWN_OBJECT;
+    uint8_t *apdu;
+#if BACNET_SEGMENTATION_ENABLED
+    bool segmented = false;
+#endif
 
 #if PRINT_ENABLED
     fprintf(stderr, "Received Atomic-Read-File Request!\n");
@@ -104,6 +108,13 @@ void handler_atomic_read_file(
     npdu_encode_npdu_data(&npdu_data, false, service_data->priority);
     pdu_len = npdu_encode_pdu(
         &Handler_Transmit_Buffer[0], src, &my_address, &npdu_data);
+    apdu = &Handler_Transmit_Buffer[pdu_len];
+#if BACNET_SEGMENTATION_ENABLED
+    if (service_data->segmented_response_accepted) {
+        /* the TSM segments the ack if the requester needs */
+        apdu = &Handler_Segmented_Buffer[0];
+    }
+#endif
     if (service_len == 0) {
         len = reject_encode_apdu(
             &Handler_Transmit_Buffer[pdu_len], service_data->invoke_id,
@@ -137,9 +148,10 @@ void handler_atomic_read_file(
                     stderr, "ARF: Stream offset %d, %d octets.\n",
                     (int)data.type.stream.fileStartPosition,
                     (int)data.type.stream.requestedOctetCount);
-                len = arf_ack_encode_apdu(
-                    &Handler_Transmit_Buffer[pdu_len], service_data->invoke_id,
-                    &data);
+                len = arf_ack_encode_apdu(apdu, service_data->invoke_id, &data);
+#if BACNET_SEGMENTATION_ENABLED
+                segmented = apdu != &Handler_Transmit_Buffer[pdu_len];
+#endif
             } else {
                 len = abort_encode_apdu(
                     &Handler_Transmit_Buffer[pdu_len], service_data->invoke_id,
@@ -162,9 +174,10 @@ void handler_atomic_read_file(
                     stderr, "ARF: fileStartRecord %d, %u RecordCount.\n",
                     (int)data.type.record.fileStartRecord,
                     (unsigned)data.type.record.RecordCount);
-                len = arf_ack_encode_apdu(
-                    &Handler_Transmit_Buffer[pdu_len], service_data->invoke_id,
-                    &data);
+                len = arf_ack_encode_apdu(apdu, service_data->invoke_id, &data);
+#if BACNET_SEGMENTATION_ENABLED
+                segmented = apdu != &Handler_Transmit_Buffer[pdu_len];
+#endif
             } else {
                 error = true;
                 error_class = ERROR_CLASS_OBJECT;
@@ -187,9 +200,17 @@ void handler_atomic_read_file(
             SERVICE_CONFIRMED_ATOMIC_READ_FILE, error_class, error_code);
     }
 ARF_ABORT:
-    pdu_len += len;
-    bytes_sent = datalink_send_pdu(
-        src, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+#if BACNET_SEGMENTATION_ENABLED
+    if (segmented) {
+        bytes_sent = tsm_segmented_complex_ack_send(
+            src, &npdu_data, service_data, apdu, (unsigned)len);
+    } else
+#endif
+    {
+        pdu_len += len;
+        bytes_sent = datalink_send_pdu(
+            src, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+    }
     if (bytes_sent <= 0) {
         debug_perror("ARF: Failed to send PDU");
     }
@@ -46,8 +46,17 @@ typedef struct BACnet_COV_Subscription_Flags {
     bool valid : 1;
     bool issueConfirmedNotifications : 1; /* optional */
     bool send_requested : 1;
+    bool send_queued : 1;
 } BACNET_COV_SUBSCRIPTION_FLAGS;
 
+/* Event-driven COV: a possible change of value is reported with
+   handler_cov_change_notify() into a queue of dirty objects, and the
+   subscriptions are indexed by monitored object, so each task pass only
+   visits the changed objects, their subscribers, and the notifications
+   waiting to be sent, rather than walking every subscription four times.
+   Changes that are not reported are still found by checking one
+   subscription per pass. Enable with BACNET_COV_EVENT_DRIVEN in config.h. */
+
 typedef struct BACnet_COV_Subscription {
     BACNET_COV_SUBSCRIPTION_FLAGS flag;
     unsigned dest_index;
@@ -55,16 +64,191 @@ typedef struct BACnet_COV_Subscription {
     uint32_t subscriberProcessIdentifier;
     uint32_t lifetime; /* optional */
     BACNET_OBJECT_ID monitoredObjectIdentifier;
+#if BACNET_COV_EVENT_DRIVEN
+    /* next subscription in the monitored object hash chain, index+1 */
+    uint16_t object_next;
+    /* next subscription in the send queue, index+1 */
+    uint16_t send_next;
+#endif
 } BACNET_COV_SUBSCRIPTION;
 
 #ifndef MAX_COV_SUBCRIPTIONS
 #define MAX_COV_SUBCRIPTIONS 128
 #endif
+#if BACNET_COV_EVENT_DRIVEN
+#if (MAX_COV_SUBCRIPTIONS > 65534)
+#error "MAX_COV_SUBCRIPTIONS must be below 65535"
+#endif
+/* number of buckets in the monitored object hash table */
+#ifndef COV_OBJECT_HASH_SIZE
+#define COV_OBJECT_HASH_SIZE MAX_COV_SUBCRIPTIONS
+#endif
+/* number of changed objects waiting to be checked */
+#ifndef MAX_COV_DIRTY_OBJECTS
+#define MAX_COV_DIRTY_OBJECTS 32
+#endif
+#endif
 static BACNET_COV_SUBSCRIPTION COV_Subscriptions[MAX_COV_SUBCRIPTIONS];
 #ifndef MAX_COV_ADDRESSES
 #define MAX_COV_ADDRESSES 16
 #endif
 static BACNET_COV_ADDRESS COV_Addresses[MAX_COV_ADDRESSES];
+#if BACNET_COV_EVENT_DRIVEN
+/* hash chain heads of subscriptions by monitored object, index+1 */
+static uint16_t COV_Object_Hash[COV_OBJECT_HASH_SIZE];
+/* subscriptions with a notification to send or in progress, index+1 */
+static uint16_t COV_Send_Head;
+static uint16_t COV_Send_Tail;
+/* objects reported as changed, waiting to be checked */
+static BACNET_OBJECT_ID COV_Dirty_Objects[MAX_COV_DIRTY_OBJECTS];
+static unsigned COV_Dirty_Head;
+static unsigned COV_Dirty_Count;
+/* the dirty queue was full: check every subscription once */
+static bool COV_Dirty_Overflow;
+/* next subscription checked for changes that were not reported */
+static unsigned COV_Sweep_Index;
+
+/**
+ * @brief Compute the hash bucket for a monitored object
+ * @param object_type - object type
+ * @param object_instance - object instance
+ * @return hash bucket index
+ */
+static unsigned
+cov_object_hash(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    uint32_t hash;
+
+    /* Knuth multiplicative hash spreads sequential instance numbers */
+    hash = (object_instance * 2654435761UL) ^ ((uint32_t)object_type << 22);
+
+    return (unsigned)(hash % COV_OBJECT_HASH_SIZE);
+}
+
+/**
+ * @brief Add a subscription to the monitored object index
+ * @param index - subscription index
+ */
+static void cov_object_index_add(unsigned index)
+{
+    unsigned bucket;
+
+    bucket = cov_object_hash(
+        COV_Subscriptions[index].monitoredObjectIdentifier.type,
+        COV_Subscriptions[index].monitoredObjectIdentifier.instance);
+    COV_Subscriptions[index].object_next = COV_Object_Hash[bucket];
+    COV_Object_Hash[bucket] = (uint16_t)(index + 1);
+}
+
+/**
+ * @brief Remove a subscription from the monitored object index
+ * @param index - subscription index
+ */
+static void cov_object_index_remove(unsigned index)
+{
+    uint16_t *pLink;
+
+    pLink = &COV_Object_Hash[cov_object_hash(
+        COV_Subscriptions[index].monitoredObjectIdentifier.type,
+        COV_Subscriptions[index].monitoredObjectIdentifier.instance)];
+    while (*pLink != 0) {
+        if (*pLink == (index + 1)) {
+            *pLink = COV_Subscriptions[index].object_next;
+            COV_Subscriptions[index].object_next = 0;
+            break;
+        }
+        pLink = &COV_Subscriptions[*pLink - 1].object_next;
+    }
+}
+
+/**
+ * @brief Add a subscription to the end of the send queue
+ * @param index - subscription index
+ */
+static void cov_send_queue_add(unsigned index)
+{
+    if (COV_Subscriptions[index].flag.send_queued) {
+        return;
+    }
+    COV_Subscriptions[index].flag.send_queued = true;
+    COV_Subscriptions[index].send_next = 0;
+    if (COV_Send_Tail) {
+        COV_Subscriptions[COV_Send_Tail - 1].send_next = (uint16_t)(index + 1);
+    } else {
+        COV_Send_Head = (uint16_t)(index + 1);
+    }
+    COV_Send_Tail = (uint16_t)(index + 1);
+}
+
+/**
+ * @brief Remove the subscription at the front of the send queue
+ * @return subscription index, or MAX_COV_SUBCRIPTIONS if empty
+ */
+static unsigned cov_send_queue_remove(void)
+{
+    unsigned index;
+
+    if (COV_Send_Head == 0) {
+        return MAX_COV_SUBCRIPTIONS;
+    }
+    index = COV_Send_Head - 1U;
+    COV_Send_Head = COV_Subscriptions[index].send_next;
+    if (COV_Send_Head == 0) {
+        COV_Send_Tail = 0;
+    }
+    COV_Subscriptions[index].send_next = 0;
+    COV_Subscriptions[index].flag.send_queued = false;
+
+    return index;
+}
+
+/**
+ * @brief Request a notification for every subscriber of an object
+ * @param object_type - object type
+ * @param object_instance - object instance
+ * @return true if the object has subscribers
+ */
+static bool
+cov_object_subscribers_mark(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    uint16_t link;
+    BACNET_COV_SUBSCRIPTION *pSub;
+    bool found = false;
+
+    link = COV_Object_Hash[cov_object_hash(object_type, object_instance)];
+    while (link != 0) {
+        pSub = &COV_Subscriptions[link - 1];
+        if (pSub->flag.valid &&
+            (pSub->monitoredObjectIdentifier.type == object_type) &&
+            (pSub->monitoredObjectIdentifier.instance == object_instance)) {
+            pSub->flag.send_requested = true;
+            cov_send_queue_add(link - 1U);
+            found = true;
+        }
+        link = pSub->object_next;
+    }
+
+    return found;
+}
+
+/**
+ * @brief Check an object for a change of value, and request notifications
+ *  for its subscribers if it changed
+ * @param object_type - object type
+ * @param object_instance - object instance
+ */
+static void
+cov_object_check(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    if (Device_COV(object_type, object_instance)) {
+        if (cov_object_subscribers_mark(object_type, object_instance)) {
+            /* clear the COV flag after marking all subscriptions */
+            Device_COV_Clear(object_type, object_instance);
+        }
+    }
+}
+#endif
 
 /**
  * Gets the address from the list of COV addresses
@@ -333,10 +517,26 @@ void handler_cov_init(void)
         COV_Subscriptions[index].invokeID = 0;
         COV_Subscriptions[index].lifetime = 0;
         COV_Subscriptions[index].flag.send_requested = false;
+#if BACNET_COV_EVENT_DRIVEN
+        COV_Subscriptions[index].flag.send_queued = false;
+        COV_Subscriptions[index].object_next = 0;
+        COV_Subscriptions[index].send_next = 0;
+#endif
     }
     for (index = 0; index < MAX_COV_ADDRESSES; index++) {
         COV_Addresses[index].valid = false;
     }
+#if BACNET_COV_EVENT_DRIVEN
+    for (index = 0; index < COV_OBJECT_HASH_SIZE; index++) {
+        COV_Object_Hash[index] = 0;
+    }
+    COV_Send_Head = 0;
+    COV_Send_Tail = 0;
+    COV_Dirty_Head = 0;
+    COV_Dirty_Count = 0;
+    COV_Dirty_Overflow = false;
+    COV_Sweep_Index = 0;
+#endif
 }
 
 static bool cov_list_subscribe(
@@ -374,6 +574,9 @@ static bool cov_list_subscribe(
                 address_match) {
                 existing_entry = true;
                 if (cov_data->cancellationRequest) {
+#if BACNET_COV_EVENT_DRIVEN
+                    cov_object_index_remove(index);
+#endif
                     /* initialize with invalid COV address */
                     COV_Subscriptions[index].flag.valid = false;
                     COV_Subscriptions[index].dest_index = MAX_COV_ADDRESSES;
@@ -384,6 +587,9 @@ static bool cov_list_subscribe(
                         cov_data->issueConfirmedNotifications;
                     COV_Subscriptions[index].lifetime = cov_data->lifetime;
                     COV_Subscriptions[index].flag.send_requested = true;
+#if BACNET_COV_EVENT_DRIVEN
+                    cov_send_queue_add(index);
+#endif
                 }
                 if (COV_Subscriptions[index].invokeID) {
                     tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
@@ -421,6 +627,10 @@ static bool cov_list_subscribe(
             COV_Subscriptions[index].invokeID = 0;
             COV_Subscriptions[index].lifetime = cov_data->lifetime;
             COV_Subscriptions[index].flag.send_requested = true;
+#if BACNET_COV_EVENT_DRIVEN
+            cov_object_index_add(index);
+            cov_send_queue_add(index);
+#endif
         }
     } else if (!existing_entry) {
         if (first_invalid_index < 0) {
@@ -552,6 +762,9 @@ static void cov_lifetime_expiration_handler(
                 stderr, "time remaining=%u seconds ",
                 COV_Subscriptions[index].lifetime);
             fprintf(stderr, "\n");
+#endif
+#if BACNET_COV_EVENT_DRIVEN
+            cov_object_index_remove(index);
 #endif
             /* initialize with invalid COV address */
             COV_Subscriptions[index].flag.valid = false;
@@ -608,14 +821,191 @@ void handler_cov_timer_seconds(uint32_t elapsed_seconds)
     }
 }
 
-bool handler_cov_fsm(void)
+/**
+ * @brief Confirmed notification house keeping: release the invoke ID of
+ *  a confirmed notification that completed or failed
+ * @param index - subscription index
+ */
+static void cov_subscription_invoke_id_check(unsigned index)
+{
+    if ((COV_Subscriptions[index].flag.valid) &&
+        (COV_Subscriptions[index].flag.issueConfirmedNotifications) &&
+        (COV_Subscriptions[index].invokeID)) {
+        if (tsm_invoke_id_free(COV_Subscriptions[index].invokeID)) {
+            COV_Subscriptions[index].invokeID = 0;
+        } else if (tsm_invoke_id_failed(COV_Subscriptions[index].invokeID)) {
+            tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
+            COV_Subscriptions[index].invokeID = 0;
+        }
+    }
+}
+
+/**
+ * @brief Send the notification requested for a subscription, unless a
+ *  confirmed notification is in progress or no transaction is free
+ * @param index - subscription index
+ */
+static void cov_subscription_send(unsigned index)
 {
-    static int index = 0;
     BACNET_OBJECT_TYPE object_type = MAX_BACNET_OBJECT_TYPE;
     uint32_t object_instance = 0;
     bool status = false;
     bool send = false;
     BACNET_PROPERTY_VALUE value_list[MAX_COV_PROPERTIES];
+
+    /* send any COVs that are requested */
+    if ((COV_Subscriptions[index].flag.valid) &&
+        (COV_Subscriptions[index].flag.send_requested)) {
+        send = true;
+        if (COV_Subscriptions[index].flag.issueConfirmedNotifications) {
+            if (COV_Subscriptions[index].invokeID != 0) {
+                /* already sending */
+                send = false;
+            }
+            if (!tsm_transaction_available()) {
+                /* no transactions available - can't send now */
+                send = false;
+            }
+        }
+        if (send) {
+            object_type = (BACNET_OBJECT_TYPE)COV_Subscriptions[index]
+                              .monitoredObjectIdentifier.type;
+            object_instance =
+                COV_Subscriptions[index].monitoredObjectIdentifier.instance;
+#if PRINT_ENABLED
+            fprintf(stderr, "COVtask: Sending...\n");
+#endif
+            /* configure the linked list for the two properties */
+            bacapp_property_value_list_init(
+                &value_list[0], MAX_COV_PROPERTIES);
+            status = Device_Encode_Value_List(
+                object_type, object_instance, &value_list[0]);
+            if (status) {
+                status = cov_send_request(
+                    &COV_Subscriptions[index], &value_list[0]);
+            }
+            if (status) {
+                COV_Subscriptions[index].flag.send_requested = false;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Report that the value of an object may have changed, so that
+ *  its COV subscribers are notified on the next pass of the COV task.
+ *  Reports for objects without subscribers are ignored. When
+ *  BACNET_COV_EVENT_DRIVEN is not enabled, changes are found by polling
+ *  each subscription and this does nothing.
+ * @param object_type - object type
+ * @param object_instance - object instance
+ */
+void handler_cov_change_notify(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+#if BACNET_COV_EVENT_DRIVEN
+    unsigned i;
+    unsigned slot;
+
+    if (COV_Object_Hash[cov_object_hash(object_type, object_instance)] ==
+        0) {
+        return;
+    }
+    for (i = 0; i < COV_Dirty_Count; i++) {
+        slot = (COV_Dirty_Head + i) % MAX_COV_DIRTY_OBJECTS;
+        if ((COV_Dirty_Objects[slot].type == object_type) &&
+            (COV_Dirty_Objects[slot].instance == object_instance)) {
+            /* already waiting */
+            return;
+        }
+    }
+    if (COV_Dirty_Count >= MAX_COV_DIRTY_OBJECTS) {
+        COV_Dirty_Overflow = true;
+        return;
+    }
+    slot = (COV_Dirty_Head + COV_Dirty_Count) % MAX_COV_DIRTY_OBJECTS;
+    COV_Dirty_Objects[slot].type = object_type;
+    COV_Dirty_Objects[slot].instance = object_instance;
+    COV_Dirty_Count++;
+#else
+    (void)object_type;
+    (void)object_instance;
+#endif
+}
+
+#if BACNET_COV_EVENT_DRIVEN
+/**
+ * @brief One pass of the event-driven COV task: check the objects reported
+ *  as changed, plus one subscription for changes that were not reported,
+ *  then send the requested notifications.
+ * @return true, since every pass completes the cycle
+ */
+static bool cov_event_fsm(void)
+{
+    BACNET_OBJECT_ID object_id;
+    unsigned index;
+    uint16_t last;
+
+    while (COV_Dirty_Count > 0) {
+        object_id = COV_Dirty_Objects[COV_Dirty_Head];
+        COV_Dirty_Head = (COV_Dirty_Head + 1) % MAX_COV_DIRTY_OBJECTS;
+        COV_Dirty_Count--;
+        cov_object_check(
+            (BACNET_OBJECT_TYPE)object_id.type, object_id.instance);
+    }
+    if (COV_Dirty_Overflow) {
+        /* some reports were lost: check every subscription */
+        COV_Dirty_Overflow = false;
+        for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
+            if (COV_Subscriptions[index].flag.valid) {
+                cov_object_check(
+                    (BACNET_OBJECT_TYPE)COV_Subscriptions[index]
+                        .monitoredObjectIdentifier.type,
+                    COV_Subscriptions[index]
+                        .monitoredObjectIdentifier.instance);
+            }
+        }
+    } else {
+        index = COV_Sweep_Index;
+        if (COV_Subscriptions[index].flag.valid) {
+            cov_object_check(
+                (BACNET_OBJECT_TYPE)COV_Subscriptions[index]
+                    .monitoredObjectIdentifier.type,
+                COV_Subscriptions[index].monitoredObjectIdentifier.instance);
+        }
+        COV_Sweep_Index = (index + 1) % MAX_COV_SUBCRIPTIONS;
+    }
+    /* visit each queued subscription once; those still sending or
+       waiting for a transaction go back on the queue */
+    last = COV_Send_Tail;
+    while (last != 0) {
+        index = cov_send_queue_remove();
+        if (COV_Subscriptions[index].flag.valid) {
+            cov_subscription_invoke_id_check(index);
+            cov_subscription_send(index);
+            if (COV_Subscriptions[index].flag.send_requested ||
+                COV_Subscriptions[index].invokeID) {
+                cov_send_queue_add(index);
+            }
+        }
+        if ((index + 1) == last) {
+            break;
+        }
+    }
+
+    return true;
+}
+#endif
+
+bool handler_cov_fsm(void)
+{
+#if BACNET_COV_EVENT_DRIVEN
+    return cov_event_fsm();
+#else
+    static int index = 0;
+    BACNET_OBJECT_TYPE object_type = MAX_BACNET_OBJECT_TYPE;
+    uint32_t object_instance = 0;
+    bool status = false;
     /* states for transmitting */
     static enum {
         COV_STATE_IDLE = 0,
@@ -668,18 +1058,7 @@ bool handler_cov_fsm(void)
             }
             break;
         case COV_STATE_FREE:
-            /* confirmed notification house keeping */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.issueConfirmedNotifications) &&
-                (COV_Subscriptions[index].invokeID)) {
-                if (tsm_invoke_id_free(COV_Subscriptions[index].invokeID)) {
-                    COV_Subscriptions[index].invokeID = 0;
-                } else if (tsm_invoke_id_failed(
-                               COV_Subscriptions[index].invokeID)) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
-                }
-            }
+            cov_subscription_invoke_id_check(index);
             index++;
             if (index >= MAX_COV_SUBCRIPTIONS) {
                 index = 0;
@@ -687,42 +1066,7 @@ bool handler_cov_fsm(void)
             }
             break;
         case COV_STATE_SEND:
-            /* send any COVs that are requested */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.send_requested)) {
-                send = true;
-                if (COV_Subscriptions[index].flag.issueConfirmedNotifications) {
-                    if (COV_Subscriptions[index].invokeID != 0) {
-                        /* already sending */
-                        send = false;
-                    }
-                    if (!tsm_transaction_available()) {
-                        /* no transactions available - can't send now */
-                        send = false;
-                    }
-                }
-                if (send) {
-                    object_type = (BACNET_OBJECT_TYPE)COV_Subscriptions[index]
-                                      .monitoredObjectIdentifier.type;
-                    object_instance = COV_Subscriptions[index]
-                                          .monitoredObjectIdentifier.instance;
-#if PRINT_ENABLED
-                    fprintf(stderr, "COVtask: Sending...\n");
-#endif
-                    /* configure the linked list for the two properties */
-                    bacapp_property_value_list_init(
-                        &value_list[0], MAX_COV_PROPERTIES);
-                    status = Device_Encode_Value_List(
-                        object_type, object_instance, &value_list[0]);
-                    if (status) {
-                        status = cov_send_request(
-                            &COV_Subscriptions[index], &value_list[0]);
-                    }
-                    if (status) {
-                        COV_Subscriptions[index].flag.send_requested = false;
-                    }
-                }
-            }
+            cov_subscription_send(index);
             index++;
             if (index >= MAX_COV_SUBCRIPTIONS) {
                 index = 0;
@@ -735,6 +1079,7 @@ bool handler_cov_fsm(void)
             break;
     }
     return (cov_task_state == COV_STATE_IDLE);
+#endif
 }
 
 void handler_cov_task(void)
@@ -17,6 +17,16 @@
 /* BACnet Stack API */
 #include "bacnet/apdu.h"
 
+/* objects report a possible change of value with this, so that they
+   only depend on the COV handler when BACNET_COV_EVENT_DRIVEN is enabled */
+#if BACNET_COV_EVENT_DRIVEN
+#define COV_CHANGE_NOTIFY(object_type, object_instance) \
+    handler_cov_change_notify(object_type, object_instance)
+#else
+#define COV_CHANGE_NOTIFY(object_type, object_instance) \
+    ((void)(object_type), (void)(object_instance))
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -36,6 +46,9 @@ void handler_cov_timer_seconds(uint32_t elapsed_seconds);
 BACNET_STACK_EXPORT
 void handler_cov_init(void);
 BACNET_STACK_EXPORT
+void handler_cov_change_notify(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
+BACNET_STACK_EXPORT
 int handler_cov_encode_subscriptions(uint8_t *apdu, int max_apdu);
 
 #ifdef __cplusplus
@@ -34,6 +34,33 @@ void handler_get_alarm_summary_set(
     }
 }
 
+/**
+ * @brief Encode an active alarm into the GetAlarmSummary-ACK
+ *  in the Handler_Transmit_Buffer
+ * @param getalarm_data [in] the active alarm
+ * @param max_resp [in] largest APDU accepted by the client
+ * @param pdu_len [in] length of the NPDU
+ * @param apdu_len [in,out] length of the APDU so far
+ * @return length of the active alarm, or zero or negative on error
+ */
+static int get_alarm_summary_encode(
+    BACNET_GET_ALARM_SUMMARY_DATA *getalarm_data,
+    int max_resp,
+    int pdu_len,
+    int *apdu_len)
+{
+    int len;
+
+    len = get_alarm_summary_ack_encode_apdu_data(
+        &Handler_Transmit_Buffer[pdu_len + *apdu_len], max_resp - *apdu_len,
+        getalarm_data);
+    if (len > 0) {
+        *apdu_len += len;
+    }
+
+    return len;
+}
+
 void handler_get_alarm_summary(
     uint8_t *service_request,
     uint16_t service_len,
@@ -47,6 +74,7 @@ void handler_get_alarm_summary(
     int alarm_value = 0;
     unsigned i = 0;
     unsigned j = 0;
+    uint32_t instance = 0;
     bool error = false;
     BACNET_ADDRESS my_address;
     BACNET_NPDU_DATA npdu_data;
@@ -80,23 +108,40 @@ void handler_get_alarm_summary(
         &Handler_Transmit_Buffer[pdu_len], service_data->invoke_id);
 
     for (i = 0; i < MAX_BACNET_OBJECT_TYPE; i++) {
-        if (Get_Alarm_Summary[i]) {
-            for (j = 0; j < 0xffff; j++) {
+        if (!Get_Alarm_Summary[i]) {
+            continue;
+        }
+        if (handler_get_event_information_indexed((BACNET_OBJECT_TYPE)i)) {
+            /* only the objects with an active event state */
+            instance = BACNET_MAX_INSTANCE;
+            while (handler_get_event_information_active_next(
+                    (BACNET_OBJECT_TYPE)i, &instance, &j)) {
                 alarm_value = Get_Alarm_Summary[i](j, &getalarm_data);
                 if (alarm_value > 0) {
-                    len = get_alarm_summary_ack_encode_apdu_data(
-                        &Handler_Transmit_Buffer[pdu_len + apdu_len],
-                        service_data->max_resp - apdu_len, &getalarm_data);
+                    len = get_alarm_summary_encode(
+                        &getalarm_data, service_data->max_resp, pdu_len,
+                        &apdu_len);
                     if (len <= 0) {
                         error = true;
                         goto GET_ALARM_SUMMARY_ERROR;
-                    } else {
-                        apdu_len += len;
                     }
-                } else if (alarm_value < 0) {
-                    break;
                 }
             }
+            continue;
+        }
+        for (j = 0; j < 0xffff; j++) {
+            alarm_value = Get_Alarm_Summary[i](j, &getalarm_data);
+            if (alarm_value > 0) {
+                len = get_alarm_summary_encode(
+                    &getalarm_data, service_data->max_resp, pdu_len,
+                    &apdu_len);
+                if (len <= 0) {
+                    error = true;
+                    goto GET_ALARM_SUMMARY_ERROR;
+                }
+            } else if (alarm_value < 0) {
+                break;
+            }
         }
     }
     debug_print("GetAlarmSummary: Sending response!\n");
@@ -25,9 +25,16 @@
 #include "bacnet/basic/tsm/tsm.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/key.h"
+#include "bacnet/basic/sys/keylist.h"
 #include "bacnet/datalink/datalink.h"
 
 static get_event_info_function Get_Event_Info[MAX_BACNET_OBJECT_TYPE];
+/* object types whose objects report their active event states */
+static get_event_index_function Get_Event_Index[MAX_BACNET_OBJECT_TYPE];
+/* objects of those types with active event states, keyed and ordered
+   by object identifier */
+static OS_Keylist Active_Event_List;
 
 /**
  * @brief print the data for a GetEventInformation service request
@@ -65,6 +72,166 @@ void handler_get_event_information_set(
     }
 }
 
+/**
+ * @brief Set the index of the objects of a type, whose objects report
+ *  when their event state becomes active or inactive with
+ *  handler_get_event_information_active_set(). Only these objects are
+ *  looked at by GetEventInformation and GetAlarmSummary, instead of
+ *  every object of the type.
+ * @param object_type [in] The BACNET_OBJECT_TYPE to set the index for.
+ * @param pFunction [in] returns the index of an object from its instance,
+ *  or NULL to look at every object of the type.
+ */
+void handler_get_event_information_index_set(
+    BACNET_OBJECT_TYPE object_type, get_event_index_function pFunction)
+{
+    if (object_type < MAX_BACNET_OBJECT_TYPE) {
+        Get_Event_Index[object_type] = pFunction;
+    }
+}
+
+/**
+ * @brief Determine if the objects of a type report their active event
+ *  states, so only those objects need to be looked at
+ * @param object_type [in] type of the objects
+ * @return true if the type has an index
+ */
+bool handler_get_event_information_indexed(BACNET_OBJECT_TYPE object_type)
+{
+    if (object_type < MAX_BACNET_OBJECT_TYPE) {
+        return Get_Event_Index[object_type] != NULL;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Report that the event state of an object became active or
+ *  inactive. An active event state has an Event_State that is not
+ *  NORMAL, or an Acked_Transitions with any of its bits FALSE.
+ * @param object_type [in] type of the object
+ * @param object_instance [in] instance of the object
+ * @param active [in] true if the event state is active
+ */
+void handler_get_event_information_active_set(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance, bool active)
+{
+    KEY key;
+    int index;
+
+    if ((object_type >= MAX_BACNET_OBJECT_TYPE) ||
+        (object_instance >= BACNET_MAX_INSTANCE)) {
+        return;
+    }
+    key = KEY_ENCODE(object_type, object_instance);
+    index = Keylist_Index(Active_Event_List, key);
+    if (active) {
+        if (index < 0) {
+            if (!Active_Event_List) {
+                Active_Event_List = Keylist_Create();
+            }
+            Keylist_Data_Add(Active_Event_List, key, NULL);
+        }
+    } else if (index >= 0) {
+        Keylist_Data_Delete_By_Index(Active_Event_List, index);
+    }
+}
+
+/**
+ * @brief Find the next object of a type with an active event state,
+ *  for object types with an index.
+ * @param object_type [in] type of the objects
+ * @param object_instance [in,out] instance of the previous object, or
+ *  BACNET_MAX_INSTANCE to find the first; the instance that was found
+ * @param index [out] index of the object that was found, or NULL
+ * @return true if an object was found
+ */
+bool handler_get_event_information_active_next(
+    BACNET_OBJECT_TYPE object_type, uint32_t *object_instance, unsigned *index)
+{
+    KEY key;
+    int position;
+
+    if ((object_type >= MAX_BACNET_OBJECT_TYPE) ||
+        !Get_Event_Index[object_type] || !object_instance) {
+        return false;
+    }
+    if (*object_instance >= BACNET_MAX_INSTANCE) {
+        key = KEY_ENCODE(object_type, 0);
+    } else {
+        key = KEY_ENCODE(object_type, *object_instance + 1);
+    }
+    position = Keylist_Index_Nearest(Active_Event_List, key);
+    if (!Keylist_Index_Key(Active_Event_List, position, &key) ||
+        (KEY_DECODE_TYPE(key) != (int)object_type)) {
+        return false;
+    }
+    *object_instance = (uint32_t)KEY_DECODE_ID(key);
+    if (index) {
+        *index = Get_Event_Index[object_type](*object_instance);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the number of objects with an active event state
+ * @return number of objects reported as active
+ */
+unsigned handler_get_event_information_active_count(void)
+{
+    int count;
+
+    count = Keylist_Count(Active_Event_List);
+    if (count < 0) {
+        count = 0;
+    }
+
+    return (unsigned)count;
+}
+
+/**
+ * @brief Encode an active event into the GetEventInformation-ACK
+ *  in the Handler_Transmit_Buffer
+ * @param getevent_data [in] the active event
+ * @param max_resp [in] largest APDU accepted by the client
+ * @param pdu_len [in,out] length of the PDU so far
+ * @param apdu_len [in,out] length of the APDU so far
+ * @return 1 if the event was encoded, 0 if there is no room left for it,
+ *  or BACNET_STATUS_ERROR or BACNET_STATUS_ABORT
+ */
+static int get_event_encode(
+    BACNET_GET_EVENT_INFORMATION_DATA *getevent_data,
+    int max_resp,
+    int *pdu_len,
+    int *apdu_len)
+{
+    int len;
+
+    getevent_data->next = NULL;
+    len = getevent_ack_encode_apdu_data(
+        &Handler_Transmit_Buffer[*pdu_len],
+        sizeof(Handler_Transmit_Buffer) - *pdu_len, getevent_data);
+    if (len <= 0) {
+        return BACNET_STATUS_ERROR;
+    }
+    if (((*apdu_len + len) >= max_resp - 2) ||
+        ((*apdu_len + len) >= MAX_APDU - 2)) {
+        /* Device must be able to fit minimum
+           one event information.
+           Length of one event information needs
+           more than 50 octets. */
+        if ((max_resp < 128) || (MAX_APDU < 128)) {
+            return BACNET_STATUS_ABORT;
+        }
+        return 0;
+    }
+    *pdu_len += len;
+    *apdu_len += len;
+
+    return 1;
+}
+
 /**
  * @brief Handle a GetEventInformation service request.
  * @details The GetEventInformation service is used by a client BACnet-user to
@@ -96,6 +263,7 @@ void handler_get_event_information(
     BACNET_ADDRESS my_address;
     BACNET_OBJECT_ID object_id;
     unsigned i = 0, j = 0; /* counter */
+    uint32_t instance = 0;
     BACNET_GET_EVENT_INFORMATION_DATA getevent_data;
     int valid_event = 0;
 
@@ -137,58 +305,73 @@ void handler_get_event_information(
     pdu_len += len;
     apdu_len = len;
     for (i = 0; i < MAX_BACNET_OBJECT_TYPE; i++) {
-        if (Get_Event_Info[i]) {
-            for (j = 0; j < 0xffff; j++) {
+        if (!Get_Event_Info[i]) {
+            continue;
+        }
+        if (Get_Event_Index[i]) {
+            /* only the objects with an active event state */
+            instance = BACNET_MAX_INSTANCE;
+            if (object_id.type != MAX_BACNET_OBJECT_TYPE) {
+                if (i < (unsigned)object_id.type) {
+                    continue;
+                }
+                if (i == (unsigned)object_id.type) {
+                    /* after the 'Last Received Object Identifier' */
+                    instance = object_id.instance;
+                }
+                object_id.type = MAX_BACNET_OBJECT_TYPE;
+            }
+            while (handler_get_event_information_active_next(
+                    (BACNET_OBJECT_TYPE)i, &instance, &j)) {
                 valid_event = Get_Event_Info[i](j, &getevent_data);
-                if (valid_event > 0) {
-                    /* encode GetEvent_data only when type of object_id has max
-                     * value */
-                    if (object_id.type != MAX_BACNET_OBJECT_TYPE) {
-                        if ((object_id.type ==
-                             getevent_data.objectIdentifier.type) &&
-                            (object_id.instance ==
-                             getevent_data.objectIdentifier.instance)) {
-                            /* found 'Last Received Object Identifier'
-                               so should set type of object_id to max value */
-                            object_id.type = MAX_BACNET_OBJECT_TYPE;
-                        }
-                        continue;
-                    }
-
-                    getevent_data.next = NULL;
-                    len = getevent_ack_encode_apdu_data(
-                        &Handler_Transmit_Buffer[pdu_len],
-                        sizeof(Handler_Transmit_Buffer) - pdu_len,
-                        &getevent_data);
-                    if (len <= 0) {
-                        error = true;
-                        goto GET_EVENT_ERROR;
-                    }
-                    apdu_len += len;
-                    if ((apdu_len >= service_data->max_resp - 2) ||
-                        (apdu_len >= MAX_APDU - 2)) {
-                        /* Device must be able to fit minimum
-                           one event information.
-                           Length of one event information needs
-                           more than 50 octets. */
-                        if ((service_data->max_resp < 128) ||
-                            (MAX_APDU < 128)) {
-                            len = BACNET_STATUS_ABORT;
-                            error = true;
-                            goto GET_EVENT_ERROR;
-                        } else {
-                            more_events = true;
-                        }
-                        break;
-                    } else {
-                        pdu_len += len;
+                if (valid_event <= 0) {
+                    continue;
+                }
+                len = get_event_encode(
+                    &getevent_data, service_data->max_resp, &pdu_len,
+                    &apdu_len);
+                if (len < 0) {
+                    error = true;
+                    goto GET_EVENT_ERROR;
+                } else if (len == 0) {
+                    more_events = true;
+                    goto GET_EVENT_END;
+                }
+            }
+            continue;
+        }
+        for (j = 0; j < 0xffff; j++) {
+            valid_event = Get_Event_Info[i](j, &getevent_data);
+            if (valid_event > 0) {
+                /* encode GetEvent_data only when type of object_id has max
+                 * value */
+                if (object_id.type != MAX_BACNET_OBJECT_TYPE) {
+                    if ((object_id.type ==
+                         getevent_data.objectIdentifier.type) &&
+                        (object_id.instance ==
+                         getevent_data.objectIdentifier.instance)) {
+                        /* found 'Last Received Object Identifier'
+                           so should set type of object_id to max value */
+                        object_id.type = MAX_BACNET_OBJECT_TYPE;
                     }
-                } else if (valid_event < 0) {
-                    break;
+                    continue;
+                }
+                len = get_event_encode(
+                    &getevent_data, service_data->max_resp, &pdu_len,
+                    &apdu_len);
+                if (len < 0) {
+                    error = true;
+                    goto GET_EVENT_ERROR;
+                } else if (len == 0) {
+                    more_events = true;
+                    goto GET_EVENT_END;
                 }
+            } else if (valid_event < 0) {
+                break;
             }
         }
     }
+GET_EVENT_END:
     len = getevent_ack_encode_apdu_end(
         &Handler_Transmit_Buffer[pdu_len],
         sizeof(Handler_Transmit_Buffer) - pdu_len, more_events);
@@ -19,6 +19,9 @@
 #include "bacnet/event.h"
 #include "bacnet/getevent.h"
 
+/* returns the index of an object from its instance */
+typedef unsigned (*get_event_index_function)(uint32_t object_instance);
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -27,6 +30,24 @@ BACNET_STACK_EXPORT
 void handler_get_event_information_set(
     BACNET_OBJECT_TYPE object_type, get_event_info_function pFunction);
 
+BACNET_STACK_EXPORT
+void handler_get_event_information_index_set(
+    BACNET_OBJECT_TYPE object_type, get_event_index_function pFunction);
+
+BACNET_STACK_EXPORT
+bool handler_get_event_information_indexed(BACNET_OBJECT_TYPE object_type);
+
+BACNET_STACK_EXPORT
+void handler_get_event_information_active_set(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance, bool active);
+
+BACNET_STACK_EXPORT
+bool handler_get_event_information_active_next(
+    BACNET_OBJECT_TYPE object_type, uint32_t *object_instance, unsigned *index);
+
+BACNET_STACK_EXPORT
+unsigned handler_get_event_information_active_count(void);
+
 BACNET_STACK_EXPORT
 void handler_get_event_information(
     uint8_t *service_request,
@@ -62,10 +62,12 @@ void handler_read_property(
     int pdu_len = 0;
     int apdu_len = -1;
     int npdu_len = -1;
+    int end_len = 0;
     BACNET_NPDU_DATA npdu_data;
     bool error = true; /* assume that there is an error */
     int bytes_sent = 0;
     BACNET_ADDRESS my_address;
+    bool segmented = false;
 
     /* configure default error code as an abort since it is common */
     rpdata.error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
@@ -119,11 +121,13 @@ void handler_read_property(
             apdu_len = rp_ack_encode_apdu_init(
                 &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
                 &rpdata);
-            /* configure our storage */
+            /* the property value is encoded in place, with room
+               left for the closing tag */
+            end_len = rp_ack_encode_apdu_object_property_end(NULL);
             rpdata.application_data =
                 &Handler_Transmit_Buffer[npdu_len + apdu_len];
-            rpdata.application_data_len =
-                sizeof(Handler_Transmit_Buffer) - (npdu_len + apdu_len);
+            rpdata.application_data_len = sizeof(Handler_Transmit_Buffer) -
+                (npdu_len + apdu_len + end_len);
             if (!read_property_bacnet_array_valid(&rpdata)) {
                 len = BACNET_STATUS_ERROR;
             } else {
@@ -134,7 +138,11 @@ void handler_read_property(
                 len = rp_ack_encode_apdu_object_property_end(
                     &Handler_Transmit_Buffer[npdu_len + apdu_len]);
                 apdu_len += len;
-                if (apdu_len > service_data->max_resp) {
+#if BACNET_SEGMENTATION_ENABLED
+                /* the TSM segments it if the requester needs */
+                segmented = service_data->segmented_response_accepted;
+#endif
+                if (!segmented && (apdu_len > service_data->max_resp)) {
                     /* too big for the sender - send an abort!
                        Setting of error code needed here as read property
                        processing may have overridden the default set at start
@@ -180,9 +188,18 @@ void handler_read_property(
             debug_print("RP: Sending Reject!\n");
         }
     }
-    pdu_len = npdu_len + apdu_len;
-    bytes_sent = datalink_send_pdu(
-        src, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+#if BACNET_SEGMENTATION_ENABLED
+    if (segmented && !error) {
+        bytes_sent = tsm_segmented_complex_ack_send(
+            src, &npdu_data, service_data, &Handler_Transmit_Buffer[npdu_len],
+            (unsigned)apdu_len);
+    } else
+#endif
+    {
+        pdu_len = npdu_len + apdu_len;
+        bytes_sent = datalink_send_pdu(
+            src, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+    }
     if (bytes_sent <= 0) {
         debug_perror("RP: Failed to send PDU");
     }
@@ -33,8 +33,6 @@
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/datalink/datalink.h"
 
-static uint8_t Temp_Buf[MAX_APDU] = { 0 };
-
 /**
  * @brief Fetches the lists of properties (array of BACNET_PROPERTY_ID's) for
  * this object type and the special properties ALL or REQUIRED or OPTIONAL.
@@ -110,6 +108,10 @@ static unsigned RPM_Object_Property_Count(
 /**
  * @brief Encode the RPM property returning the length of the encoding,
  * or 0 if there is no room to fit the encoding.
+ * @note The property value is encoded by the object directly into the
+ * response between its opening and closing tags, so that each byte of
+ * the response is written once. The NULL buffer encoders are used to
+ * find the room needed for the tags before anything is written.
  * @param apdu [out] The buffer to encode the property into.
  * @param offset [in] The offset into the buffer to start encoding.
  * @param max_apdu [in] The maximum length of the buffer.
@@ -121,26 +123,30 @@ static int RPM_Encode_Property(
     uint8_t *apdu, uint16_t offset, uint16_t max_apdu, BACNET_RPM_DATA *rpmdata)
 {
     int len = 0;
-    size_t copy_len = 0;
     int apdu_len = 0;
+    int tag_len = 0;
     BACNET_READ_PROPERTY_DATA rpdata;
 
     len = rpm_ack_encode_apdu_object_property(
-        &Temp_Buf[0], rpmdata->object_property, rpmdata->array_index);
-    copy_len = memcopy(&apdu[0], &Temp_Buf[0], offset, len, max_apdu);
-    if (copy_len == 0) {
+        NULL, rpmdata->object_property, rpmdata->array_index);
+    /* the opening and closing tags of the property value */
+    tag_len = rpm_ack_encode_apdu_object_property_value(NULL, NULL, 0);
+    if (!memcopylen(offset, max_apdu, len + tag_len)) {
         rpmdata->error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
         return BACNET_STATUS_ABORT;
     }
-    apdu_len += len;
+    apdu_len = rpm_ack_encode_apdu_object_property(
+        &apdu[offset], rpmdata->object_property, rpmdata->array_index);
     rpdata.error_class = ERROR_CLASS_OBJECT;
     rpdata.error_code = ERROR_CODE_UNKNOWN_OBJECT;
     rpdata.object_type = rpmdata->object_type;
     rpdata.object_instance = rpmdata->object_instance;
     rpdata.object_property = rpmdata->object_property;
     rpdata.array_index = rpmdata->array_index;
-    rpdata.application_data = &Temp_Buf[0];
-    rpdata.application_data_len = sizeof(Temp_Buf);
+    /* the value follows the opening tag */
+    rpdata.application_data =
+        &apdu[offset + apdu_len + encode_opening_tag(NULL, 4)];
+    rpdata.application_data_len = max_apdu - (offset + apdu_len + tag_len);
 
     if ((rpmdata->object_property == PROP_ALL) ||
         (rpmdata->object_property == PROP_REQUIRED) ||
@@ -161,18 +167,17 @@ static int RPM_Encode_Property(
         }
         /* error was returned - encode that for the response */
         len = rpm_ack_encode_apdu_object_property_error(
-            &Temp_Buf[0], rpdata.error_class, rpdata.error_code);
-        copy_len =
-            memcopy(&apdu[0], &Temp_Buf[0], offset + apdu_len, len, max_apdu);
-
-        if (copy_len == 0) {
+            NULL, rpdata.error_class, rpdata.error_code);
+        if (!memcopylen(offset + apdu_len, max_apdu, len)) {
             rpmdata->error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
             return BACNET_STATUS_ABORT;
         }
-    } else if ((offset + apdu_len + 1 + len + 1) < max_apdu) {
-        /* enough room to fit the property value and tags */
+        len = rpm_ack_encode_apdu_object_property_error(
+            &apdu[offset + apdu_len], rpdata.error_class, rpdata.error_code);
+    } else if (len <= rpdata.application_data_len) {
+        /* the property value is already in place - add the tags */
         len = rpm_ack_encode_apdu_object_property_value(
-            &apdu[offset + apdu_len], &Temp_Buf[0], len);
+            &apdu[offset + apdu_len], rpdata.application_data, len);
     } else {
         /* not enough room - abort! */
         rpmdata->error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
@@ -210,7 +215,6 @@ void handler_read_property_multiple(
 {
     bool berror = false;
     int len = 0;
-    uint16_t copy_len = 0;
     uint16_t decode_len = 0;
     int pdu_len = 0;
     BACNET_NPDU_DATA npdu_data;
@@ -220,12 +224,24 @@ void handler_read_property_multiple(
     int apdu_len = 0;
     int npdu_len = 0;
     int error = 0;
+    uint8_t *apdu;
+    uint16_t apdu_size = MAX_APDU;
+    bool segmented = false;
 
     if (service_data) {
         datalink_get_my_address(&my_address);
         npdu_encode_npdu_data(&npdu_data, false, service_data->priority);
         npdu_len = npdu_encode_pdu(
             &Handler_Transmit_Buffer[0], src, &my_address, &npdu_data);
+        apdu = &Handler_Transmit_Buffer[npdu_len];
+#if BACNET_SEGMENTATION_ENABLED
+        if (service_data->segmented_response_accepted) {
+            /* encode the whole response, and let the TSM segment it */
+            apdu = &Handler_Segmented_Buffer[0];
+            apdu_size = (uint16_t)tsm_segmented_complex_ack_size(service_data);
+            segmented = true;
+        }
+#endif
         if (service_len == 0) {
             rpmdata.error_code = ERROR_CODE_REJECT_MISSING_REQUIRED_PARAMETER;
             error = BACNET_STATUS_REJECT;
@@ -237,8 +253,7 @@ void handler_read_property_multiple(
         } else {
             /* decode apdu request & encode apdu reply
                encode complex ack, invoke id, service choice */
-            apdu_len = rpm_ack_encode_apdu_init(
-                &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id);
+            apdu_len = rpm_ack_encode_apdu_init(apdu, service_data->invoke_id);
 
             for (;;) {
                 /* Start by looking for an object ID */
@@ -279,11 +294,8 @@ void handler_read_property_multiple(
                 }
 #endif
                 /* Stick this object id into the reply - if it will fit */
-                len = rpm_ack_encode_apdu_object_begin(&Temp_Buf[0], &rpmdata);
-                copy_len = memcopy(
-                    &Handler_Transmit_Buffer[npdu_len], &Temp_Buf[0], apdu_len,
-                    len, MAX_APDU);
-                if (copy_len == 0) {
+                len = rpm_ack_encode_apdu_object_begin(NULL, &rpmdata);
+                if (!memcopylen(apdu_len, apdu_size, len)) {
                     debug_print("RPM: Response too big!\n");
                     rpmdata.error_code =
                         ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
@@ -291,7 +303,8 @@ void handler_read_property_multiple(
                     berror = true;
                     break;
                 }
-                apdu_len += copy_len;
+                apdu_len +=
+                    rpm_ack_encode_apdu_object_begin(&apdu[apdu_len], &rpmdata);
                 /* do each property of this object of the RPM request */
                 for (;;) {
                     /* Fetch a property */
@@ -320,8 +333,7 @@ void handler_read_property_multiple(
                         if (!Device_Valid_Object_Id(
                                 rpmdata.object_type, rpmdata.object_instance)) {
                             len = RPM_Encode_Property(
-                                &Handler_Transmit_Buffer[npdu_len],
-                                (uint16_t)apdu_len, MAX_APDU, &rpmdata);
+                                apdu, (uint16_t)apdu_len, apdu_size, &rpmdata);
                             if (len > 0) {
                                 apdu_len += len;
                             } else {
@@ -336,14 +348,12 @@ void handler_read_property_multiple(
                             /* No array index options for this special property.
                                Encode error for this object property response */
                             len = rpm_ack_encode_apdu_object_property(
-                                &Temp_Buf[0], rpmdata.object_property,
+                                NULL, rpmdata.object_property,
                                 rpmdata.array_index);
-
-                            copy_len = memcopy(
-                                &Handler_Transmit_Buffer[npdu_len],
-                                &Temp_Buf[0], apdu_len, len, MAX_APDU);
-
-                            if (copy_len == 0) {
+                            len += rpm_ack_encode_apdu_object_property_error(
+                                NULL, ERROR_CLASS_PROPERTY,
+                                ERROR_CODE_PROPERTY_IS_NOT_AN_ARRAY);
+                            if (!memcopylen(apdu_len, apdu_size, len)) {
                                 debug_print(
                                     "RPM: Too full to encode property!\n");
                                 rpmdata.error_code =
@@ -354,27 +364,13 @@ void handler_read_property_multiple(
                                 berror = true;
                                 break;
                             }
-
-                            apdu_len += len;
-                            len = rpm_ack_encode_apdu_object_property_error(
-                                &Temp_Buf[0], ERROR_CLASS_PROPERTY,
-                                ERROR_CODE_PROPERTY_IS_NOT_AN_ARRAY);
-
-                            copy_len = memcopy(
-                                &Handler_Transmit_Buffer[npdu_len],
-                                &Temp_Buf[0], apdu_len, len, MAX_APDU);
-
-                            if (copy_len == 0) {
-                                debug_print("RPM: Too full to encode error!\n");
-                                rpmdata.error_code =
-                                    ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
-                                error = BACNET_STATUS_ABORT;
-                                /* The berror flag ensures that
-                                   both loops will be broken! */
-                                berror = true;
-                                break;
-                            }
-                            apdu_len += len;
+                            apdu_len += rpm_ack_encode_apdu_object_property(
+                                &apdu[apdu_len], rpmdata.object_property,
+                                rpmdata.array_index);
+                            apdu_len +=
+                                rpm_ack_encode_apdu_object_property_error(
+                                    &apdu[apdu_len], ERROR_CLASS_PROPERTY,
+                                    ERROR_CODE_PROPERTY_IS_NOT_AN_ARRAY);
                         } else {
                             special_object_property = rpmdata.object_property;
                             Device_Objects_Property_List(
@@ -395,8 +391,8 @@ void handler_read_property_multiple(
                                         rpmdata.object_type,
                                         rpmdata.object_instance)) {
                                     len = RPM_Encode_Property(
-                                        &Handler_Transmit_Buffer[npdu_len],
-                                        (uint16_t)apdu_len, MAX_APDU, &rpmdata);
+                                        apdu, (uint16_t)apdu_len, apdu_size,
+                                        &rpmdata);
                                     if (len > 0) {
                                         apdu_len += len;
                                     } else {
@@ -417,8 +413,8 @@ void handler_read_property_multiple(
                                             &property_list,
                                             special_object_property, index);
                                     len = RPM_Encode_Property(
-                                        &Handler_Transmit_Buffer[npdu_len],
-                                        (uint16_t)apdu_len, MAX_APDU, &rpmdata);
+                                        apdu, (uint16_t)apdu_len, apdu_size,
+                                        &rpmdata);
                                     if (len > 0) {
                                         apdu_len += len;
                                     } else {
@@ -436,8 +432,7 @@ void handler_read_property_multiple(
                     } else {
                         /* handle an individual property */
                         len = RPM_Encode_Property(
-                            &Handler_Transmit_Buffer[npdu_len],
-                            (uint16_t)apdu_len, MAX_APDU, &rpmdata);
+                            apdu, (uint16_t)apdu_len, apdu_size, &rpmdata);
                         if (len > 0) {
                             apdu_len += len;
                         } else {
@@ -456,11 +451,8 @@ void handler_read_property_multiple(
                         /* Reached end of property list so cap the result list
                          */
                         decode_len++;
-                        len = rpm_ack_encode_apdu_object_end(&Temp_Buf[0]);
-                        copy_len = memcopy(
-                            &Handler_Transmit_Buffer[npdu_len], &Temp_Buf[0],
-                            apdu_len, len, MAX_APDU);
-                        if (copy_len == 0) {
+                        len = rpm_ack_encode_apdu_object_end(NULL);
+                        if (!memcopylen(apdu_len, apdu_size, len)) {
                             debug_print(
                                 "RPM: Too full to encode object end!\n");
                             rpmdata.error_code =
@@ -471,7 +463,8 @@ void handler_read_property_multiple(
                             berror = true;
                             break;
                         } else {
-                            apdu_len += copy_len;
+                            apdu_len += rpm_ack_encode_apdu_object_end(
+                                &apdu[apdu_len]);
                         }
                         /* finished with this property list */
                         break;
@@ -487,7 +480,7 @@ void handler_read_property_multiple(
             }
             /* If not having an error so far, check the remaining space. */
             if (!berror) {
-                if (apdu_len > service_data->max_resp) {
+                if (!segmented && (apdu_len > service_data->max_resp)) {
                     /* too big for the sender - send an abort */
                     rpmdata.error_code =
                         ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
@@ -498,6 +491,12 @@ void handler_read_property_multiple(
         }
         /* Error fallback. */
         if (error) {
+            if (segmented &&
+                (rpmdata.error_code ==
+                 ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED)) {
+                /* too big for the segments accepted by the sender */
+                rpmdata.error_code = ERROR_CODE_ABORT_BUFFER_OVERFLOW;
+            }
             if (error == BACNET_STATUS_ABORT) {
                 apdu_len = abort_encode_apdu(
                     &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
@@ -516,9 +515,17 @@ void handler_read_property_multiple(
                 debug_print("RPM: Sending Reject!\n");
             }
         }
-        pdu_len = apdu_len + npdu_len;
-        bytes_sent = datalink_send_pdu(
-            src, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+#if BACNET_SEGMENTATION_ENABLED
+        if (segmented && !error) {
+            bytes_sent = tsm_segmented_complex_ack_send(
+                src, &npdu_data, service_data, apdu, (unsigned)apdu_len);
+        } else
+#endif
+        {
+            pdu_len = apdu_len + npdu_len;
+            bytes_sent = datalink_send_pdu(
+                src, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+        }
         if (bytes_sent <= 0) {
             debug_perror("RPM: Failed to send PDU");
         }
@@ -117,6 +117,9 @@ void handler_read_range(
     bool error = false;
     int bytes_sent = 0;
     BACNET_ADDRESS my_address;
+#if BACNET_SEGMENTATION_ENABLED
+    bool segmented = false;
+#endif
 
     data.error_class = ERROR_CLASS_OBJECT;
     data.error_code = ERROR_CODE_UNKNOWN_OBJECT;
@@ -155,6 +158,19 @@ void handler_read_range(
             if (len >= 0) {
                 /* encode the APDU portion of the packet */
                 len = rr_ack_encode_apdu(NULL, service_data->invoke_id, &data);
+#if BACNET_SEGMENTATION_ENABLED
+                if (service_data->segmented_response_accepted &&
+                    (len <=
+                     (int)tsm_segmented_complex_ack_size(service_data))) {
+                    /* the TSM segments it if the requester needs */
+                    len = rr_ack_encode_apdu(
+                        &Handler_Segmented_Buffer[0], service_data->invoke_id,
+                        &data);
+                    debug_print("RR: Sending Ack!\n");
+                    segmented = true;
+                    error = false;
+                } else
+#endif
                 if (len < sizeof(Handler_Transmit_Buffer) - pdu_len) {
                     len = rr_ack_encode_apdu(
                         &Handler_Transmit_Buffer[pdu_len],
@@ -184,9 +200,18 @@ void handler_read_range(
             }
         }
     }
-    pdu_len += len;
-    bytes_sent = datalink_send_pdu(
-        src, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+#if BACNET_SEGMENTATION_ENABLED
+    if (segmented) {
+        bytes_sent = tsm_segmented_complex_ack_send(
+            src, &npdu_data, service_data, &Handler_Segmented_Buffer[0],
+            (unsigned)len);
+    } else
+#endif
+    {
+        pdu_len += len;
+        bytes_sent = datalink_send_pdu(
+            src, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+    }
     if (bytes_sent <= 0) {
         debug_perror("RR: Failed to send PDU");
     }
@@ -8,10 +8,12 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
+#include "bacnet/bacaddr.h"
 #include "bacnet/bacdcode.h"
 #include "bacnet/whois.h"
 #include "bacnet/iam.h"
@@ -21,6 +23,265 @@
 
 /** @file h_whois.c  Handles Who-Is requests. */
 
+/* state of an I-Am in the schedule */
+enum who_is_response_state {
+    WHO_IS_RESPONSE_IDLE = 0,
+    /* waiting for its random delay to end and for its turn to be sent */
+    WHO_IS_RESPONSE_PENDING,
+    /* sent, so the same Who-Is gets no I-Am until the window ends */
+    WHO_IS_RESPONSE_HOLDOFF
+};
+
+/* an I-Am scheduled to answer a Who-Is */
+struct who_is_response {
+    enum who_is_response_state state;
+    /* milliseconds until it is sent, or until the window ends */
+    uint16_t milliseconds;
+    /* the device that answers, which may be a routed device */
+    uint32_t device_instance;
+    bool unicast;
+    /* where a unicast I-Am is sent */
+    BACNET_ADDRESS dest;
+};
+
+static struct who_is_response Who_Is_Response[WHO_IS_RESPONSE_MAX];
+static uint16_t Who_Is_Jitter = WHO_IS_JITTER_MS;
+static uint16_t Who_Is_Window = WHO_IS_WINDOW_MS;
+static uint16_t Who_Is_Pace = WHO_IS_PACE_MS;
+/* milliseconds until the next scheduled I-Am may be sent */
+static uint16_t Who_Is_Pace_Remaining;
+
+/**
+ * @brief Set the most milliseconds of random delay before an I-Am answers
+ *  a Who-Is, so that devices answering the same Who-Is are spread out
+ * @param milliseconds - most milliseconds of delay, or 0 for none
+ */
+void handler_who_is_jitter_set(uint16_t milliseconds)
+{
+    Who_Is_Jitter = milliseconds;
+}
+
+/**
+ * @brief Get the most milliseconds of random delay before an I-Am
+ * @return most milliseconds of delay
+ */
+uint16_t handler_who_is_jitter(void)
+{
+    return Who_Is_Jitter;
+}
+
+/**
+ * @brief Set the milliseconds after an I-Am is sent in which the same
+ *  Who-Is, repeated or from another requester of a broadcast I-Am, gets
+ *  no other I-Am. A Who-Is that arrives while its I-Am is scheduled never
+ *  gets another I-Am. The window only ends in handler_who_is_timer().
+ * @param milliseconds - milliseconds of the window, or 0 for none
+ */
+void handler_who_is_window_set(uint16_t milliseconds)
+{
+    Who_Is_Window = milliseconds;
+}
+
+/**
+ * @brief Get the milliseconds after an I-Am in which the same Who-Is is
+ *  not answered again
+ * @return milliseconds of the window
+ */
+uint16_t handler_who_is_window(void)
+{
+    return Who_Is_Window;
+}
+
+/**
+ * @brief Set the least milliseconds between scheduled I-Am, which limits
+ *  the rate of I-Am from a gateway answering for many routed devices
+ * @param milliseconds - least milliseconds between I-Am, or 0 for none
+ */
+void handler_who_is_pace_set(uint16_t milliseconds)
+{
+    Who_Is_Pace = milliseconds;
+}
+
+/**
+ * @brief Get the least milliseconds between scheduled I-Am
+ * @return least milliseconds between I-Am
+ */
+uint16_t handler_who_is_pace(void)
+{
+    return Who_Is_Pace;
+}
+
+/**
+ * @brief Get the number of I-Am waiting to be sent
+ * @return number of I-Am waiting to be sent
+ */
+unsigned handler_who_is_pending(void)
+{
+    unsigned count = 0;
+    unsigned i;
+
+    for (i = 0; i < WHO_IS_RESPONSE_MAX; i++) {
+        if (Who_Is_Response[i].state == WHO_IS_RESPONSE_PENDING) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Send the I-Am of a device
+ * @param device_instance - the device that answers
+ * @param unicast - true to send the I-Am to dest, false to broadcast it
+ * @param dest - where a unicast I-Am is sent
+ * @param routed - true if the device must be selected first
+ */
+static void who_is_response_send(
+    uint32_t device_instance,
+    bool unicast,
+    const BACNET_ADDRESS *dest,
+    bool routed)
+{
+#ifdef BAC_ROUTING
+    if (routed) {
+        /* the I-Am is encoded from the selected routed device */
+        (void)Routed_Device_Valid_Object_Instance_Number(device_instance);
+    }
+#else
+    (void)device_instance;
+    (void)routed;
+#endif
+    if (unicast) {
+        Send_I_Am_Unicast(&Handler_Transmit_Buffer[0], dest);
+    } else {
+        Send_I_Am_Broadcast(&Handler_Transmit_Buffer[0]);
+    }
+}
+
+/**
+ * @brief Send a scheduled I-Am, and hold off the same Who-Is for the window
+ * @param response - the scheduled I-Am
+ */
+static void who_is_response_sent(struct who_is_response *response)
+{
+    who_is_response_send(
+        response->device_instance, response->unicast, &response->dest, true);
+    Who_Is_Pace_Remaining = Who_Is_Pace;
+    if (Who_Is_Window) {
+        response->state = WHO_IS_RESPONSE_HOLDOFF;
+        response->milliseconds = Who_Is_Window;
+    } else {
+        response->state = WHO_IS_RESPONSE_IDLE;
+    }
+}
+
+/**
+ * @brief Answer a Who-Is with an I-Am from the current device, now or
+ *  later. The I-Am is sent now when no jitter, window, or pace is set.
+ *  When the schedule is full, the I-Am held off the longest gives up its
+ *  place, and the I-Am is only sent now when every place is pending.
+ * @param unicast - true to send the I-Am to src, false to broadcast it
+ * @param src - the requester of the Who-Is
+ */
+static void who_is_response_schedule(bool unicast, const BACNET_ADDRESS *src)
+{
+    struct who_is_response *response = NULL;
+    struct who_is_response *holdoff = NULL;
+    uint32_t device_instance;
+    unsigned i;
+
+    device_instance = Device_Object_Instance_Number();
+    if ((Who_Is_Jitter == 0) && (Who_Is_Window == 0) && (Who_Is_Pace == 0)) {
+        who_is_response_send(device_instance, unicast, src, false);
+        return;
+    }
+    for (i = 0; i < WHO_IS_RESPONSE_MAX; i++) {
+        if (Who_Is_Response[i].state == WHO_IS_RESPONSE_IDLE) {
+            if (!response) {
+                response = &Who_Is_Response[i];
+            }
+        } else if (
+            (Who_Is_Response[i].device_instance == device_instance) &&
+            (Who_Is_Response[i].unicast == unicast) &&
+            (!unicast || bacnet_address_same(&Who_Is_Response[i].dest, src))) {
+            /* the I-Am is scheduled or was just sent */
+            return;
+        } else if (
+            (Who_Is_Response[i].state == WHO_IS_RESPONSE_HOLDOFF) &&
+            (!holdoff ||
+             (Who_Is_Response[i].milliseconds < holdoff->milliseconds))) {
+            /* the window that ends first is of the oldest I-Am */
+            holdoff = &Who_Is_Response[i];
+        }
+    }
+    if (!response) {
+        response = holdoff;
+    }
+    if (!response) {
+        who_is_response_send(device_instance, unicast, src, false);
+        return;
+    }
+    response->device_instance = device_instance;
+    response->unicast = unicast;
+    if (unicast) {
+        bacnet_address_copy(&response->dest, src);
+    } else {
+        memset(&response->dest, 0, sizeof(BACNET_ADDRESS));
+    }
+    response->state = WHO_IS_RESPONSE_PENDING;
+    if (Who_Is_Jitter) {
+        response->milliseconds = (uint16_t)(rand() % (Who_Is_Jitter + 1));
+    } else {
+        response->milliseconds = 0;
+    }
+    if ((response->milliseconds == 0) && (Who_Is_Pace_Remaining == 0)) {
+        who_is_response_sent(response);
+    }
+}
+
+/**
+ * @brief Send the scheduled I-Am that are due, no closer together than
+ *  the pace, and end the windows that have passed. Once a jitter, window,
+ *  or pace is set, this must be called periodically, or scheduled I-Am
+ *  are never sent and held off Who-Is are never answered again.
+ * @param milliseconds - milliseconds elapsed since the last call
+ */
+void handler_who_is_timer(uint16_t milliseconds)
+{
+    struct who_is_response *response;
+    unsigned i;
+
+    if (Who_Is_Pace_Remaining > milliseconds) {
+        Who_Is_Pace_Remaining -= milliseconds;
+    } else {
+        Who_Is_Pace_Remaining = 0;
+    }
+    for (i = 0; i < WHO_IS_RESPONSE_MAX; i++) {
+        response = &Who_Is_Response[i];
+        if (response->state == WHO_IS_RESPONSE_IDLE) {
+            continue;
+        }
+        if (response->milliseconds > milliseconds) {
+            response->milliseconds -= milliseconds;
+        } else {
+            response->milliseconds = 0;
+            if (response->state == WHO_IS_RESPONSE_HOLDOFF) {
+                response->state = WHO_IS_RESPONSE_IDLE;
+            }
+        }
+    }
+    for (i = 0; i < WHO_IS_RESPONSE_MAX; i++) {
+        if (Who_Is_Pace_Remaining) {
+            break;
+        }
+        response = &Who_Is_Response[i];
+        if ((response->state == WHO_IS_RESPONSE_PENDING) &&
+            (response->milliseconds == 0)) {
+            who_is_response_sent(response);
+        }
+    }
+}
+
 /** Handler for Who-Is requests, with broadcast I-Am response.
  * @ingroup DMDDB
  * @param service_request [in] The received message to be handled.
@@ -34,16 +295,15 @@ void handler_who_is(
     int32_t low_limit = 0;
     int32_t high_limit = 0;
 
-    (void)src;
     len = whois_decode_service_request(
         service_request, service_len, &low_limit, &high_limit);
     if (len == 0) {
-        Send_I_Am_Broadcast(&Handler_Transmit_Buffer[0]);
+        who_is_response_schedule(false, src);
     } else if (len != BACNET_STATUS_ERROR) {
         /* is my device id within the limits? */
         if ((Device_Object_Instance_Number() >= (uint32_t)low_limit) &&
             (Device_Object_Instance_Number() <= (uint32_t)high_limit)) {
-            Send_I_Am_Broadcast(&Handler_Transmit_Buffer[0]);
+            who_is_response_schedule(false, src);
         }
     }
 
@@ -69,12 +329,12 @@ void handler_who_is_unicast(
         service_request, service_len, &low_limit, &high_limit);
     /* If no limits, then always respond */
     if (len == 0) {
-        Send_I_Am_Unicast(&Handler_Transmit_Buffer[0], src);
+        who_is_response_schedule(true, src);
     } else if (len != BACNET_STATUS_ERROR) {
         /* is my device id within the limits? */
         if ((Device_Object_Instance_Number() >= (uint32_t)low_limit) &&
             (Device_Object_Instance_Number() <= (uint32_t)high_limit)) {
-            Send_I_Am_Unicast(&Handler_Transmit_Buffer[0], src);
+            who_is_response_schedule(true, src);
         }
     }
 
@@ -128,11 +388,7 @@ static void check_who_is_for_routing(
         /* If len == 0, no limits and always respond */
         if ((len == 0) ||
             ((dev_instance >= low_limit) && (dev_instance <= high_limit))) {
-            if (is_unicast) {
-                Send_I_Am_Unicast(&Handler_Transmit_Buffer[0], src);
-            } else {
-                Send_I_Am_Broadcast(&Handler_Transmit_Buffer[0]);
-            }
+            who_is_response_schedule(is_unicast, src);
         }
     }
 }
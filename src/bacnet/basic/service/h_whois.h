@@ -20,6 +20,24 @@
 /* BACnet Stack API */
 #include "bacnet/apdu.h"
 
+/* most milliseconds of random delay before an I-Am answers a Who-Is */
+#ifndef WHO_IS_JITTER_MS
+#define WHO_IS_JITTER_MS 0
+#endif
+/* milliseconds after an I-Am in which the same Who-Is gets no I-Am */
+#ifndef WHO_IS_WINDOW_MS
+#define WHO_IS_WINDOW_MS 0
+#endif
+/* least milliseconds between scheduled I-Am, such as for routed devices */
+#ifndef WHO_IS_PACE_MS
+#define WHO_IS_PACE_MS 0
+#endif
+/* number of I-Am that can be scheduled or held off at once: a broadcast
+   and a few unicast I-Am for each device, including routed devices */
+#ifndef WHO_IS_RESPONSE_MAX
+#define WHO_IS_RESPONSE_MAX (MAX_NUM_DEVICES * 4)
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -40,6 +58,23 @@ BACNET_STACK_EXPORT
 void handler_who_is_unicast_for_routing(
     uint8_t *service_request, uint16_t service_len, BACNET_ADDRESS *src);
 
+BACNET_STACK_EXPORT
+void handler_who_is_jitter_set(uint16_t milliseconds);
+BACNET_STACK_EXPORT
+uint16_t handler_who_is_jitter(void);
+BACNET_STACK_EXPORT
+void handler_who_is_window_set(uint16_t milliseconds);
+BACNET_STACK_EXPORT
+uint16_t handler_who_is_window(void);
+BACNET_STACK_EXPORT
+void handler_who_is_pace_set(uint16_t milliseconds);
+BACNET_STACK_EXPORT
+uint16_t handler_who_is_pace(void);
+BACNET_STACK_EXPORT
+unsigned handler_who_is_pending(void);
+BACNET_STACK_EXPORT
+void handler_who_is_timer(uint16_t milliseconds);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
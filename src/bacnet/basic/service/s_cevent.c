@@ -83,6 +83,73 @@ uint8_t Send_CEvent_Notify_Address(
     return invoke_id;
 }
 
+/**
+ * @brief Sends a Confirmed Alarm/Event Notification that is already
+ *  encoded, such as one event sent to many recipients.
+ * @ingroup EVNOTFCN
+ * @param pdu [in] the PDU buffer used for sending the message
+ * @param pdu_size [in] Size of the PDU buffer
+ * @param service_request [in] the encoded ConfirmedEventNotification
+ *  service request
+ * @param service_request_len [in] length of the service request
+ * @param dest [in] BACNET_ADDRESS of the destination device
+ * @return invoke id of outgoing message, or 0 if communication is disabled,
+ *         or no tsm slot is available.
+ */
+uint8_t Send_CEvent_Notify_Service_Request(
+    uint8_t *pdu,
+    uint16_t pdu_size,
+    const uint8_t *service_request,
+    uint16_t service_request_len,
+    BACNET_ADDRESS *dest)
+{
+    int pdu_len = 0;
+    int bytes_sent = 0;
+    BACNET_NPDU_DATA npdu_data;
+    BACNET_ADDRESS my_address;
+    uint8_t invoke_id = 0;
+
+    if (!dcc_communication_enabled()) {
+        return 0;
+    }
+    if (!dest || !service_request) {
+        return 0;
+    }
+    /* is there a tsm available? */
+    invoke_id = tsm_next_free_invokeID();
+    if (invoke_id) {
+        /* encode the NPDU portion of the packet */
+        datalink_get_my_address(&my_address);
+        npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+        pdu_len = npdu_encode_pdu(pdu, dest, &my_address, &npdu_data);
+        if ((pdu_len + 4 + service_request_len) < pdu_size) {
+            /* encode the APDU portion of the packet */
+            pdu[pdu_len++] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+            pdu[pdu_len++] = encode_max_segs_max_apdu(0, MAX_APDU);
+            pdu[pdu_len++] = invoke_id;
+            pdu[pdu_len++] = SERVICE_CONFIRMED_EVENT_NOTIFICATION;
+            memcpy(&pdu[pdu_len], service_request, service_request_len);
+            pdu_len += service_request_len;
+            tsm_set_confirmed_unsegmented_transaction(
+                invoke_id, dest, &npdu_data, pdu, (uint16_t)pdu_len);
+            bytes_sent = datalink_send_pdu(dest, &npdu_data, pdu, pdu_len);
+            if (bytes_sent <= 0) {
+                debug_perror(
+                    "Failed to Send ConfirmedEventNotification Request");
+            }
+        } else {
+            tsm_free_invoke_id(invoke_id);
+            invoke_id = 0;
+            debug_fprintf(
+                stderr,
+                "Failed to Send ConfirmedEventNotification Request "
+                "(exceeds destination maximum APDU)!\n");
+        }
+    }
+
+    return invoke_id;
+}
+
 /** Sends an Confirmed Alarm/Event Notification.
  * @ingroup EVNOTFCN
  *
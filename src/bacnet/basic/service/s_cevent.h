@@ -35,6 +35,13 @@ uint8_t Send_CEvent_Notify_Address(
     uint16_t pdu_size,
     const BACNET_EVENT_NOTIFICATION_DATA *data,
     BACNET_ADDRESS *dest);
+BACNET_STACK_EXPORT
+uint8_t Send_CEvent_Notify_Service_Request(
+    uint8_t *pdu,
+    uint16_t pdu_size,
+    const uint8_t *service_request,
+    uint16_t service_request_len,
+    BACNET_ADDRESS *dest);
 
 #ifdef __cplusplus
 }
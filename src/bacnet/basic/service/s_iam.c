@@ -24,6 +24,12 @@
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/debug.h"
 
+#if BACNET_SEGMENTATION_ENABLED
+#define IAM_SEGMENTATION Device_Segmentation_Supported()
+#else
+#define IAM_SEGMENTATION SEGMENTATION_NONE
+#endif
+
 /** Send a I-Am request to a remote network for a specific device.
  * @param target_address [in] BACnet address of target router
  * @param device_id [in] Device Instance 0 - 4194303
@@ -85,7 +91,7 @@ int iam_encode_pdu(
     /* encode the APDU portion of the packet */
     len = iam_encode_apdu(
         &buffer[pdu_len], Device_Object_Instance_Number(), MAX_APDU,
-        SEGMENTATION_NONE, Device_Vendor_Identifier());
+        IAM_SEGMENTATION, Device_Vendor_Identifier());
     pdu_len += len;
 
     return pdu_len;
@@ -158,7 +164,7 @@ int iam_unicast_encode_pdu(
     /* encode the APDU portion of the packet */
     apdu_len = iam_encode_apdu(
         &buffer[npdu_len], Device_Object_Instance_Number(), MAX_APDU,
-        SEGMENTATION_NONE, Device_Vendor_Identifier());
+        IAM_SEGMENTATION, Device_Vendor_Identifier());
     pdu_len = npdu_len + apdu_len;
 
     return pdu_len;
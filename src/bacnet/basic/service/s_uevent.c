@@ -7,6 +7,7 @@
  */
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include "bacnet/event.h"
 #include "bacnet/datalink/datalink.h"
 #include "bacnet/basic/services.h"
@@ -47,3 +48,51 @@ int Send_UEvent_Notify(
 
     return bytes_sent;
 }
+
+/**
+ * @brief Sends an Unconfirmed Alarm/Event Notification that is already
+ *  encoded, such as one event sent to many recipients.
+ * @ingroup BIBB-AE-N-A
+ * @param buffer [in,out] The buffer to build the message in for sending.
+ * @param buffer_size [in] Size of the buffer
+ * @param service_request [in] the encoded UnconfirmedEventNotification
+ *  service request
+ * @param service_request_len [in] length of the service request
+ * @param dest [in] The destination address information (may be a broadcast).
+ * @return Size of the message sent (bytes), or a negative value on error.
+ */
+int Send_UEvent_Notify_Service_Request(
+    uint8_t *buffer,
+    uint16_t buffer_size,
+    const uint8_t *service_request,
+    uint16_t service_request_len,
+    BACNET_ADDRESS *dest)
+{
+    int pdu_len = 0;
+    int bytes_sent = 0;
+    BACNET_NPDU_DATA npdu_data;
+    BACNET_ADDRESS my_address;
+
+    if (!buffer || !service_request || !dest) {
+        return -1;
+    }
+    datalink_get_my_address(&my_address);
+    /* encode the NPDU portion of the packet */
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    pdu_len = npdu_encode_pdu(buffer, dest, &my_address, &npdu_data);
+    if ((pdu_len + 2 + service_request_len) > buffer_size) {
+        return -1;
+    }
+    /* encode the APDU portion of the packet */
+    buffer[pdu_len++] = PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST;
+    buffer[pdu_len++] = SERVICE_UNCONFIRMED_EVENT_NOTIFICATION;
+    memcpy(&buffer[pdu_len], service_request, service_request_len);
+    pdu_len += service_request_len;
+    /* send the data */
+    bytes_sent = datalink_send_pdu(dest, &npdu_data, &buffer[0], pdu_len);
+    if (bytes_sent <= 0) {
+        debug_perror("Failed to Send EventNotification Request");
+    }
+
+    return bytes_sent;
+}
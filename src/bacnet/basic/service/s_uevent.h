@@ -30,6 +30,13 @@ int Send_UEvent_Notify(
     uint8_t *buffer,
     const BACNET_EVENT_NOTIFICATION_DATA *data,
     BACNET_ADDRESS *dest);
+BACNET_STACK_EXPORT
+int Send_UEvent_Notify_Service_Request(
+    uint8_t *buffer,
+    uint16_t buffer_size,
+    const uint8_t *service_request,
+    uint16_t service_request_len,
+    BACNET_ADDRESS *dest);
 
 #ifdef __cplusplus
 }
@@ -5,41 +5,90 @@
  * The list is sorted, indexed, and keyed. The array is much faster
  * than a linked list.  It stores a pointer to data, which you must
  * malloc and free on your own, or just use static data.
+ * The key and data pointer of each node are stored inline in one
+ * contiguous array, which grows and shrinks geometrically, so adding
+ * a node does not allocate memory for the node itself.
  * @author Steve Karg <skarg@users.sourceforge.net>
  * @date 2003
  * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
  */
+#include <limits.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "bacnet/basic/sys/keylist.h"
 
+/* minimum number of nodes to allocate memory for */
+#define KEYLIST_CHUNK 8
+
 /******************************************************************** */
 /* Generic node routines */
 /******************************************************************** */
 
-/** Grab memory for a node (Keylist_Node).
+/** Grab memory for a list (Keylist).
  *
  * @return Pointer to the allocated memory or
  *         NULL under an Out Of Memory situation.
  */
-static struct Keylist_Node *NodeCreate(void)
+static struct Keylist *KeylistCreate(void)
 {
-    return calloc(1, sizeof(struct Keylist_Node));
+    return calloc(1, sizeof(struct Keylist));
 }
 
-/** Grab memory for a list (Keylist).
+/** Resize the array of nodes.
  *
- * @return Pointer to the allocated memory or
- *         NULL under an Out Of Memory situation.
+ * @param list  Pointer to the list to be resized.
+ * @param new_size  Number of nodes to allocate memory for.
+ *
+ * @return Returns true if success, false if failed
  */
-static struct Keylist *KeylistCreate(void)
+static bool ResizeArray(OS_Keylist list, int new_size)
 {
-    return calloc(1, sizeof(struct Keylist));
+    struct Keylist_Node *new_array = NULL; /* new array of nodes */
+
+    new_array =
+        realloc(list->array, (size_t)new_size * sizeof(struct Keylist_Node));
+    if (!new_array) {
+        return false;
+    }
+    list->array = new_array;
+    list->size = new_size;
+
+    return true;
+}
+
+/** Make sure that the array has room for a number of nodes.
+ *
+ * @param list  Pointer to the list to be tested.
+ * @param count  Number of nodes the array shall hold.
+ *
+ * @return Returns true if success, false if failed
+ */
+static bool ReserveArraySize(OS_Keylist list, int count)
+{
+    int new_size;
+
+    if (count <= list->size) {
+        return true;
+    }
+    new_size = list->size ? list->size : KEYLIST_CHUNK;
+    while (new_size < count) {
+        if (new_size > (INT_MAX / 2)) {
+            new_size = count;
+        } else {
+            new_size *= 2;
+        }
+    }
+
+    return ResizeArray(list, new_size);
 }
 
 /** Check to see if the array is big enough for an addition
  * or is too big when we are deleting and we can shrink.
+ * The array doubles when it is full, and halves when it is
+ * less than a quarter used, so that adding or deleting nodes
+ * one at a time is amortized constant time.
  *
  * @param list  Pointer to the list to be tested.
  *
@@ -47,43 +96,66 @@ static struct Keylist *KeylistCreate(void)
  */
 static bool CheckArraySize(OS_Keylist list)
 {
-    int new_size = 0; /* set it up so that no size change is the default */
-    const int chunk = 8; /* minimum number of nodes to allocate memory for */
-    struct Keylist_Node **new_array = NULL; /* new array of nodes, if needed */
-    int i; /* counter */
     if (!list) {
         return false;
     }
-
-    /* indicates the need for more memory allocation */
     if (list->count == list->size) {
-        new_size = list->size + chunk;
-
-        /* allow for shrinking memory */
-    } else if ((list->size > chunk) && (list->count < (list->size - chunk))) {
-        new_size = list->size - chunk;
+        /* indicates the need for more memory allocation */
+        return ReserveArraySize(list, list->count + 1);
+    } else if (
+        (list->size > KEYLIST_CHUNK) && (list->count < (list->size / 4))) {
+        /* allow for shrinking memory - keep the old array on failure */
+        (void)ResizeArray(list, list->size / 2);
     }
-    if (new_size > 0) {
-        /* Allocate more room for node pointer array */
-        new_array = calloc((size_t)new_size, sizeof(struct Keylist_Node *));
 
-        /* See if we got the memory we wanted */
-        if (!new_array) {
-            return true;
-        }
+    return true;
+}
 
-        /* copy the nodes from the old array to the new array */
-        if (list->array) {
-            for (i = 0; i < list->count; i++) {
-                new_array[i] = list->array[i];
+/** Sort an array of nodes by key, keeping nodes with the same key
+ * in the order that they were given.
+ *
+ * @param nodes  Array of nodes to be sorted.
+ * @param scratch  Array of at least count nodes used while sorting.
+ * @param count  Number of nodes in the array.
+ */
+static void SortNodes(
+    struct Keylist_Node *nodes, struct Keylist_Node *scratch, int count)
+{
+    struct Keylist_Node *src = nodes;
+    struct Keylist_Node *dst = scratch;
+    struct Keylist_Node *swap;
+    int width, left, mid, right;
+    int i, j, k;
+
+    /* a bottom-up merge sort */
+    for (width = 1; width < count; width *= 2) {
+        for (left = 0; left < count; left += 2 * width) {
+            mid = left + width;
+            if (mid > count) {
+                mid = count;
+            }
+            right = mid + width;
+            if (right > count) {
+                right = count;
+            }
+            i = left;
+            j = mid;
+            for (k = left; k < right; k++) {
+                if ((i < mid) &&
+                    ((j >= right) || (src[i].key <= src[j].key))) {
+                    dst[k] = src[i++];
+                } else {
+                    dst[k] = src[j++];
+                }
             }
-            free(list->array);
         }
-        list->array = new_array;
-        list->size = new_size;
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != nodes) {
+        memcpy(nodes, src, (size_t)count * sizeof(struct Keylist_Node));
     }
-
-    return true;
 }
 
 /** Find the index of the key that we are looking for.
@@ -102,7 +174,6 @@ static bool CheckArraySize(OS_Keylist list)
  */
 static bool FindIndex(OS_Keylist list, KEY key, int *pIndex)
 {
-    struct Keylist_Node *node; /* holds the new node */
     int left = 0; /* the left branch of tree, beginning of list */
     int right = 0; /* the right branch on the tree, end of list */
     int index = 0; /* our current search place in the array */
@@ -122,11 +193,7 @@ static bool FindIndex(OS_Keylist list, KEY key, int *pIndex)
     do {
         /* A binary search */
         index = (left + right) / 2;
-        node = list->array[index];
-        if (!node) {
-            break;
-        }
-        current_key = node->key;
+        current_key = list->array[index].key;
         if (key < current_key) {
             right = index - 1;
 
@@ -166,9 +233,7 @@ static bool FindIndex(OS_Keylist list, KEY key, int *pIndex)
  */
 int Keylist_Data_Add(OS_Keylist list, KEY key, void *data)
 {
-    struct Keylist_Node *node; /* holds the new node */
     int index = -1; /* return value */
-    int i; /* counts through the array */
 
     if (list && CheckArraySize(list)) {
         /* figure out where to put the new node */
@@ -183,23 +248,92 @@ int Keylist_Data_Add(OS_Keylist list, KEY key, void *data)
                 index = list->count;
             }
             /* Move all the items up to make room for the new one */
-            for (i = list->count; i > index; i--) {
-                list->array[i] = list->array[i - 1];
+            if (index < list->count) {
+                memmove(
+                    &list->array[index + 1], &list->array[index],
+                    (size_t)(list->count - index) *
+                        sizeof(struct Keylist_Node));
             }
         } else {
             index = 0;
         }
+        /* add the node */
+        list->array[index].key = key;
+        list->array[index].data = data;
+        list->count++;
+    }
+    return index;
+}
+
+/** Adds many nodes to the list at once, sorting them only once.
+ * This is much faster than adding the nodes one at a time when
+ * a large list is created, as when loading a database of objects.
+ * Nodes with the same key are added after any already in the list,
+ * in the order that they are given.
+ *
+ * @param list  Pointer to the list
+ * @param nodes  Array of nodes to be added, in any order
+ * @param count  Number of nodes in the array
+ *
+ * @return true if all the nodes were added, or false if none were added.
+ */
+bool Keylist_Bulk_Load(
+    OS_Keylist list, const struct Keylist_Node *nodes, int count)
+{
+    struct Keylist_Node *sorted = NULL;
+    bool in_order = true;
+    int i, j, k;
 
-        /* create and add the node */
-        node = NodeCreate();
-        if (node) {
-            list->count++;
-            node->key = key;
-            node->data = data;
-            list->array[index] = node;
+    if (!list || (count < 0) || ((count > 0) && !nodes)) {
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+    if ((count > (INT_MAX - list->count)) ||
+        !ReserveArraySize(list, list->count + count)) {
+        return false;
+    }
+    for (i = 1; i < count; i++) {
+        if (nodes[i].key < nodes[i - 1].key) {
+            in_order = false;
+            break;
         }
     }
-    return index;
+    if (in_order &&
+        ((list->count == 0) ||
+         (list->array[list->count - 1].key <= nodes[0].key))) {
+        /* the common case: append to the end of the list */
+        memcpy(
+            &list->array[list->count], nodes,
+            (size_t)count * sizeof(struct Keylist_Node));
+        list->count += count;
+        return true;
+    }
+    sorted = malloc((size_t)count * sizeof(struct Keylist_Node));
+    if (!sorted) {
+        return false;
+    }
+    memcpy(sorted, nodes, (size_t)count * sizeof(struct Keylist_Node));
+    if (!in_order) {
+        /* the unused end of the array is the scratch space */
+        SortNodes(sorted, &list->array[list->count], count);
+    }
+    /* merge from the end of the list, where there is room */
+    i = list->count - 1;
+    j = count - 1;
+    k = list->count + count - 1;
+    while (j >= 0) {
+        if ((i >= 0) && (list->array[i].key > sorted[j].key)) {
+            list->array[k--] = list->array[i--];
+        } else {
+            list->array[k--] = sorted[j--];
+        }
+    }
+    list->count += count;
+    free(sorted);
+
+    return true;
 }
 
 /** Deletes a node specified by its index
@@ -212,34 +346,21 @@ int Keylist_Data_Add(OS_Keylist list, KEY key, void *data)
  */
 void *Keylist_Data_Delete_By_Index(OS_Keylist list, int index)
 {
-    struct Keylist_Node *node;
     void *data = NULL;
 
     if (list) {
         if (list->array && list->count && (index >= 0) &&
             (index < list->count)) {
-            node = list->array[index];
-            if (node) {
-                data = node->data;
-            }
+            data = list->array[index].data;
             /* move the nodes to account for the deleted one */
-            if (list->count == 1) {
-                /* There is no node shifting to do */
-            } else if (index == (list->count - 1)) {
-                /* We are the last one */
-                /* There is no node shifting to do */
-            } else {
+            if (index < (list->count - 1)) {
                 /* Move all the nodes down one */
-                int i; /* counter */
-                int count = list->count - 1;
-                for (i = index; i < count; i++) {
-                    list->array[i] = list->array[i + 1];
-                }
+                memmove(
+                    &list->array[index], &list->array[index + 1],
+                    (size_t)(list->count - 1 - index) *
+                        sizeof(struct Keylist_Node));
             }
             list->count--;
-            if (node) {
-                free(node);
-            }
 
             /* potentially reduce the size of the array */
             (void)CheckArraySize(list);
@@ -315,17 +436,17 @@ void *Keylist_Data_Pop(OS_Keylist list)
  */
 void *Keylist_Data(OS_Keylist list, KEY key)
 {
-    struct Keylist_Node *node = NULL;
+    void *data = NULL;
     int index = 0; /* used to look up the index of node */
 
     if (list) {
         if (list->array && list->count) {
             if (FindIndex(list, key, &index)) {
-                node = list->array[index];
+                data = list->array[index].data;
             }
         }
     }
-    return node ? node->data : NULL;
+    return data;
 }
 
 /** Returns the index from the node specified by key.
@@ -349,6 +470,27 @@ int Keylist_Index(OS_Keylist list, KEY key)
     return index;
 }
 
+/** Returns the index from the node specified by key, or if there is
+ * no node with the key, from the node with the next greater key.
+ *
+ * @param list  Pointer to the list
+ * @param key  Key whose index shall be retrieved.
+ *
+ * @return Index of the key or of the next greater key, or the number of
+ *  nodes when every key is less than the key.
+ */
+int Keylist_Index_Nearest(OS_Keylist list, KEY key)
+{
+    int index = 0; /* used to look up the index of node */
+
+    if (list) {
+        if (list->array && list->count) {
+            (void)FindIndex(list, key, &index);
+        }
+    }
+    return index;
+}
+
 /** Returns the data specified by index
  *
  * @param list  Pointer to the list
@@ -358,15 +500,15 @@ int Keylist_Index(OS_Keylist list, KEY key)
  */
 void *Keylist_Data_Index(OS_Keylist list, int index)
 {
-    struct Keylist_Node *node = NULL;
+    void *data = NULL;
 
     if (list) {
         if (list->array && list->count && (index >= 0) &&
             (index < list->count)) {
-            node = list->array[index];
+            data = list->array[index].data;
         }
     }
-    return node ? node->data : NULL;
+    return data;
 }
 
 /** Return the key at the given index.
@@ -380,15 +522,11 @@ void *Keylist_Data_Index(OS_Keylist list, int index)
 KEY Keylist_Key(OS_Keylist list, int index)
 {
     KEY key = UINT32_MAX; /* return value */
-    struct Keylist_Node *node;
 
     if (list) {
         if (list->array && list->count && (index >= 0) &&
             (index < list->count)) {
-            node = list->array[index];
-            if (node) {
-                key = node->key;
-            }
+            key = list->array[index].key;
         }
     }
     return key;
@@ -405,17 +543,13 @@ KEY Keylist_Key(OS_Keylist list, int index)
 bool Keylist_Index_Key(OS_Keylist list, int index, KEY *pKey)
 {
     bool status = false; /* return value */
-    struct Keylist_Node *node;
 
     if (list) {
         if (list->array && list->count && (index >= 0) &&
             (index < list->count)) {
-            node = list->array[index];
-            if (node) {
-                status = true;
-                if (pKey) {
-                    *pKey = node->key;
-                }
+            status = true;
+            if (pKey) {
+                *pKey = list->array[index].key;
             }
         }
     }
@@ -490,10 +624,6 @@ OS_Keylist Keylist_Create(void)
 void Keylist_Delete(OS_Keylist list)
 { /* list number to be deleted */
     if (list) {
-        /* clean out the list */
-        while (list->count) {
-            (void)Keylist_Data_Delete_By_Index(list, 0);
-        }
         if (list->array) {
             free(list->array);
         }
@@ -23,7 +23,7 @@ struct Keylist_Node {
 };
 
 typedef struct Keylist {
-    struct Keylist_Node **array; /* array of nodes */
+    struct Keylist_Node *array; /* sorted array of nodes */
     int count; /* number of nodes in this list - more efficient than loop */
     int size; /* number of available nodes on this list - can grow or shrink */
 } KEYLIST_TYPE;
@@ -47,6 +47,12 @@ void Keylist_Delete(OS_Keylist list);
 BACNET_STACK_EXPORT
 int Keylist_Data_Add(OS_Keylist list, KEY key, void *data);
 
+/* inserts many nodes, sorting them once */
+/* returns true if all the nodes were added */
+BACNET_STACK_EXPORT
+bool Keylist_Bulk_Load(
+    OS_Keylist list, const struct Keylist_Node *nodes, int count);
+
 /* deletes a node specified by its key */
 BACNET_STACK_EXPORT
 /* returns the data from the node */
@@ -73,6 +79,10 @@ void *Keylist_Data(OS_Keylist list, KEY key);
 BACNET_STACK_EXPORT
 int Keylist_Index(OS_Keylist list, KEY key);
 
+/* returns the index from the node specified by key, or the next one */
+BACNET_STACK_EXPORT
+int Keylist_Index_Nearest(OS_Keylist list, KEY key);
+
 /* returns the data specified by index */
 BACNET_STACK_EXPORT
 void *Keylist_Data_Index(OS_Keylist list, int index);
@@ -0,0 +1,254 @@
+/**
+ * @file
+ * @brief Hierarchical timer wheel library
+ * @details The timer wheel keeps many timers, and fires only the timers
+ * that have expired when time advances, so the cost of timekeeping grows
+ * with the number of running timers rather than the number of things that
+ * could be timed. The application calls timer_wheel_elapsed() with the
+ * milliseconds that have elapsed, and the callback of each expired timer
+ * is called. A callback may start its timer again to be called again.
+ * @date 2024
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "bacnet/basic/sys/timer_wheel.h"
+
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1UL)
+
+/**
+ * @brief Link a timer into the slot where it waits for its expire tick
+ * @param wheel - timer wheel
+ * @param entry - timer to link
+ */
+static void timer_wheel_link(
+    struct timer_wheel *wheel, struct timer_wheel_entry *entry)
+{
+    uint32_t delta;
+    unsigned level = 0;
+    unsigned index;
+    struct timer_wheel_entry **head;
+
+    delta = entry->expire_tick - wheel->tick;
+    while ((level < (TIMER_WHEEL_LEVELS - 1)) &&
+           (delta >= (1UL << (TIMER_WHEEL_BITS * (level + 1))))) {
+        level++;
+    }
+    index = (unsigned)((entry->expire_tick >> (TIMER_WHEEL_BITS * level)) &
+                       TIMER_WHEEL_MASK);
+    head = &wheel->slot[level][index];
+    entry->next = *head;
+    if (entry->next) {
+        entry->next->pprev = &entry->next;
+    }
+    *head = entry;
+    entry->pprev = head;
+}
+
+/**
+ * @brief Unlink a timer from its slot
+ * @param entry - timer to unlink
+ */
+static void timer_wheel_unlink(struct timer_wheel_entry *entry)
+{
+    *entry->pprev = entry->next;
+    if (entry->next) {
+        entry->next->pprev = entry->pprev;
+    }
+    entry->next = NULL;
+    entry->pprev = NULL;
+}
+
+/**
+ * @brief Move the timers of a coarse slot down to the finer levels
+ * @param wheel - timer wheel
+ * @param level - level of the slot
+ * @param index - index of the slot
+ */
+static void
+timer_wheel_cascade(struct timer_wheel *wheel, unsigned level, unsigned index)
+{
+    struct timer_wheel_entry *entry;
+
+    while ((entry = wheel->slot[level][index]) != NULL) {
+        timer_wheel_unlink(entry);
+        timer_wheel_link(wheel, entry);
+    }
+}
+
+/**
+ * @brief Advance the wheel by one tick, and fire the expired timers
+ * @param wheel - timer wheel
+ */
+static void timer_wheel_tick(struct timer_wheel *wheel)
+{
+    struct timer_wheel_entry *entry;
+    unsigned level;
+    unsigned index;
+    uint32_t milliseconds;
+
+    wheel->tick++;
+    for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        if (wheel->tick & ((1UL << (TIMER_WHEEL_BITS * level)) - 1UL)) {
+            break;
+        }
+        index = (unsigned)((wheel->tick >> (TIMER_WHEEL_BITS * level)) &
+                           TIMER_WHEEL_MASK);
+        timer_wheel_cascade(wheel, level, index);
+    }
+    index = (unsigned)(wheel->tick & TIMER_WHEEL_MASK);
+    /* a callback that starts its timer again links it into a later slot */
+    while ((entry = wheel->slot[0][index]) != NULL) {
+        timer_wheel_unlink(entry);
+        wheel->count--;
+        milliseconds =
+            (wheel->tick - entry->start_tick) * (uint32_t)wheel->resolution;
+        if (entry->callback) {
+            entry->callback(entry, milliseconds);
+        }
+    }
+}
+
+/**
+ * @brief Initialize a timer wheel with no running timers
+ * @param wheel - timer wheel
+ * @param resolution - number of milliseconds per tick
+ */
+void timer_wheel_init(struct timer_wheel *wheel, uint16_t resolution)
+{
+    unsigned level, index;
+
+    if (!wheel) {
+        return;
+    }
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (index = 0; index < TIMER_WHEEL_SLOTS; index++) {
+            wheel->slot[level][index] = NULL;
+        }
+    }
+    wheel->tick = 0;
+    wheel->resolution = resolution ? resolution : 1;
+    wheel->remainder = 0;
+    wheel->count = 0;
+}
+
+/**
+ * @brief Initialize a timer that is not running
+ * @param entry - timer
+ * @param callback - function called when the timer expires
+ * @param key - value for the callback to identify the timer
+ */
+void timer_wheel_entry_init(
+    struct timer_wheel_entry *entry,
+    timer_wheel_callback_function callback,
+    uint32_t key)
+{
+    if (!entry) {
+        return;
+    }
+    entry->next = NULL;
+    entry->pprev = NULL;
+    entry->start_tick = 0;
+    entry->expire_tick = 0;
+    entry->callback = callback;
+    entry->key = key;
+}
+
+/**
+ * @brief Start a timer, or start it again if it is already running
+ * @param wheel - timer wheel
+ * @param entry - timer
+ * @param milliseconds - time until the timer expires, which is rounded
+ *  up to the next tick, so that a timer always expires on a later tick
+ */
+void timer_wheel_start(
+    struct timer_wheel *wheel,
+    struct timer_wheel_entry *entry,
+    uint32_t milliseconds)
+{
+    uint32_t ticks;
+
+    if (!wheel || !entry) {
+        return;
+    }
+    if (entry->pprev) {
+        timer_wheel_unlink(entry);
+        wheel->count--;
+    }
+    ticks = milliseconds / wheel->resolution;
+    if ((ticks == 0) || (milliseconds % wheel->resolution)) {
+        ticks++;
+    }
+    if (ticks > TIMER_WHEEL_TICKS_MAX) {
+        ticks = TIMER_WHEEL_TICKS_MAX;
+    }
+    entry->start_tick = wheel->tick;
+    entry->expire_tick = wheel->tick + ticks;
+    timer_wheel_link(wheel, entry);
+    wheel->count++;
+}
+
+/**
+ * @brief Stop a timer, if it is running
+ * @param wheel - timer wheel
+ * @param entry - timer
+ */
+void timer_wheel_stop(
+    struct timer_wheel *wheel, struct timer_wheel_entry *entry)
+{
+    if (!wheel || !entry) {
+        return;
+    }
+    if (entry->pprev) {
+        timer_wheel_unlink(entry);
+        wheel->count--;
+    }
+}
+
+/**
+ * @brief Determine if a timer is running
+ * @param entry - timer
+ * @return true if the timer has been started and has not yet expired
+ */
+bool timer_wheel_running(const struct timer_wheel_entry *entry)
+{
+    return entry && entry->pprev;
+}
+
+/**
+ * @brief Get the number of timers running
+ * @param wheel - timer wheel
+ * @return number of timers running
+ */
+unsigned timer_wheel_count(const struct timer_wheel *wheel)
+{
+    return wheel ? wheel->count : 0;
+}
+
+/**
+ * @brief Advance the timer wheel, and call the callback of each timer
+ *  that expires.
+ * @param wheel - timer wheel
+ * @param milliseconds - number of milliseconds elapsed
+ */
+void timer_wheel_elapsed(struct timer_wheel *wheel, uint32_t milliseconds)
+{
+    uint32_t ticks;
+
+    if (!wheel) {
+        return;
+    }
+    milliseconds += wheel->remainder;
+    ticks = milliseconds / wheel->resolution;
+    wheel->remainder = (uint16_t)(milliseconds % wheel->resolution);
+    while (ticks) {
+        if (wheel->count == 0) {
+            /* nothing to fire or to cascade */
+            wheel->tick += ticks;
+            break;
+        }
+        timer_wheel_tick(wheel);
+        ticks--;
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ * @file
+ * @brief API for a hierarchical timer wheel library
+ * @date 2024
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_SYS_TIMER_WHEEL_H
+#define BACNET_SYS_TIMER_WHEEL_H
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* number of slots per level, as a power of two */
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1UL << TIMER_WHEEL_BITS)
+/* number of levels, each covering TIMER_WHEEL_SLOTS times the previous */
+#define TIMER_WHEEL_LEVELS 4
+/* longest delay, in ticks, before a timer is fired */
+#define TIMER_WHEEL_TICKS_MAX \
+    ((1UL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1UL)
+
+struct timer_wheel_entry;
+/**
+ * @brief Called when a timer expires
+ * @param entry - the timer that expired, which may be started again
+ * @param milliseconds - number of milliseconds since the timer was started
+ */
+typedef void (*timer_wheel_callback_function)(
+    struct timer_wheel_entry *entry, uint32_t milliseconds);
+
+/**
+ * A timer, usually a member of the data structure that it times.
+ * The timer must be initialized with timer_wheel_entry_init()
+ * before it can be used.
+ */
+struct timer_wheel_entry {
+    struct timer_wheel_entry *next;
+    /* the link that points to this entry, or NULL if not started */
+    struct timer_wheel_entry **pprev;
+    uint32_t start_tick;
+    uint32_t expire_tick;
+    timer_wheel_callback_function callback;
+    /* key used with callback */
+    uint32_t key;
+};
+
+/**
+ * The timer wheel. Timers that expire soon are kept in the first level,
+ * and timers that expire later are kept in the coarser levels, and moved
+ * down a level as their time comes near. Starting, stopping, and firing
+ * a timer takes constant time, no matter how many timers are running.
+ */
+struct timer_wheel {
+    struct timer_wheel_entry *slot[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    /* ticks since the wheel was initialized */
+    uint32_t tick;
+    /* milliseconds per tick */
+    uint16_t resolution;
+    /* milliseconds elapsed toward the next tick */
+    uint16_t remainder;
+    /* number of timers running */
+    unsigned count;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void timer_wheel_init(struct timer_wheel *wheel, uint16_t resolution);
+BACNET_STACK_EXPORT
+void timer_wheel_entry_init(
+    struct timer_wheel_entry *entry,
+    timer_wheel_callback_function callback,
+    uint32_t key);
+BACNET_STACK_EXPORT
+void timer_wheel_start(
+    struct timer_wheel *wheel,
+    struct timer_wheel_entry *entry,
+    uint32_t milliseconds);
+BACNET_STACK_EXPORT
+void timer_wheel_stop(
+    struct timer_wheel *wheel, struct timer_wheel_entry *entry);
+BACNET_STACK_EXPORT
+bool timer_wheel_running(const struct timer_wheel_entry *entry);
+BACNET_STACK_EXPORT
+unsigned timer_wheel_count(const struct timer_wheel *wheel);
+BACNET_STACK_EXPORT
+void timer_wheel_elapsed(struct timer_wheel *wheel, uint32_t milliseconds);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
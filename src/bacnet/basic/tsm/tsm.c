@@ -9,9 +9,12 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
+#include "bacnet/abort.h"
 #include "bacnet/apdu.h"
 #include "bacnet/bacaddr.h"
 #include "bacnet/bacdcode.h"
@@ -23,6 +26,9 @@
 /** @file tsm.c  BACnet Transaction State Machine operations  */
 /* FIXME: modify basic service handlers to use TSM rather than this buffer! */
 uint8_t Handler_Transmit_Buffer[MAX_PDU];
+#if BACNET_SEGMENTATION_ENABLED
+uint8_t Handler_Segmented_Buffer[MAX_ASDU];
+#endif
 
 #if (MAX_TSM_TRANSACTIONS)
 /* Really only needed for segmented messages */
@@ -30,110 +36,394 @@ uint8_t Handler_Transmit_Buffer[MAX_PDU];
 /* If we are only a server and only initiate broadcasts, */
 /* then we don't need a TSM layer. */
 
-/* FIXME: not coded for segmentation */
+#if BACNET_SEGMENTATION_ENABLED
+#define TSM_SERVER_TRANSACTIONS BACNET_SEGMENTATION_SERVER_TRANSACTIONS
+#else
+#define TSM_SERVER_TRANSACTIONS 0
+#endif
+/* transactions are linked by 16-bit index+1 values */
+#if ((MAX_TSM_TRANSACTIONS + TSM_SERVER_TRANSACTIONS) > 65534)
+#error "MAX_TSM_TRANSACTIONS plus server transactions must be below 65535"
+#endif
+/* number of buckets in the peer address and invoke ID hash table */
+#if !defined(TSM_HASH_SIZE)
+#define TSM_HASH_SIZE MAX_TSM_TRANSACTIONS
+#endif
 
-/* declare space for the TSM transactions, and set it up in the init. */
-/* table rules: an Invoke ID = 0 is an unused spot in the table */
+/* declare space for the TSM transactions. Invoke IDs are scoped per
+   peer, so a transaction is keyed by peer address and invoke ID:
+   - tsm_next_free_invokeID() hands out an invoke ID that is not used
+     with any peer, found through TSM_Global_Index, which keeps the
+     invoke ID only functions unambiguous.
+   - tsm_peer_next_free_invokeID() hands out an invoke ID that is not
+     used with that peer, found through the TSM_Hash chains, so more
+     than 255 requests may be outstanding across many peers.
+   table rules: an Invoke ID = 0 is an unused spot in the table */
 static BACNET_TSM_DATA TSM_List[MAX_TSM_TRANSACTIONS];
+/* hash chain heads of per-peer transactions, as index+1 or zero */
+static uint16_t TSM_Hash[TSM_HASH_SIZE];
+/* transactions that own an invoke ID for all peers, as index+1 or zero */
+static uint16_t TSM_Global_Index[256];
+/* number of transactions using each invoke ID, with any peer */
+static uint16_t TSM_Invoke_ID_Count[256];
+/* released transactions available for reuse, linked by Next */
+static uint16_t TSM_Free_Head;
+/* transactions at or above this index have never been used */
+static uint16_t TSM_Unused_Index;
+static uint16_t TSM_Active_Count;
+/* binary min-heap of the transactions with a running timer */
+static BACNET_TSM_DATA
+    *TSM_Timer_Heap[MAX_TSM_TRANSACTIONS + TSM_SERVER_TRANSACTIONS];
+static uint16_t TSM_Timer_Count;
+/* TSM clock, advanced by tsm_timer_milliseconds() */
+static uint32_t TSM_Milliseconds;
 
 /* invoke ID for incrementing between subsequent calls. */
 static uint8_t Current_Invoke_ID = 1;
 
 static tsm_timeout_function Timeout_Function;
+static tsm_peer_timeout_function Peer_Timeout_Function;
 
 void tsm_set_timeout_handler(tsm_timeout_function pFunction)
 {
     Timeout_Function = pFunction;
 }
 
-/** Find the given Invoke-Id in the list and
- *  return the index.
- *
- * @param invokeID  Invoke Id
- *
- * @return Index of the id or MAX_TSM_TRANSACTIONS
- *         if not found
+/**
+ * @brief Set the handler called when any transaction fails to get a
+ *  confirmation, with the peer address and invoke ID of the transaction.
+ * @param pFunction - handler, or NULL
  */
-static uint8_t tsm_find_invokeID_index(uint8_t invokeID)
+void tsm_set_peer_timeout_handler(tsm_peer_timeout_function pFunction)
 {
-    unsigned i = 0; /* counter */
-    uint8_t index = MAX_TSM_TRANSACTIONS; /* return value */
+    Peer_Timeout_Function = pFunction;
+}
 
-    const BACNET_TSM_DATA *plist = TSM_List;
+/**
+ * @brief Convert a transaction to a link value
+ * @param plist - transaction in TSM_List
+ * @return link value (index+1) of the transaction
+ */
+static uint16_t tsm_link_value(const BACNET_TSM_DATA *plist)
+{
+    return (uint16_t)((plist - TSM_List) + 1);
+}
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if (plist->InvokeID == invokeID) {
-            index = (uint8_t)i;
-            break;
+/**
+ * @brief Convert a link value to a transaction
+ * @param link - link value (index+1), or zero
+ * @return transaction, or NULL if the link is zero
+ */
+static BACNET_TSM_DATA *tsm_link_entry(uint16_t link)
+{
+    if (link == 0) {
+        return NULL;
+    }
+
+    return &TSM_List[link - 1];
+}
+
+/**
+ * @brief Compute the hash bucket for a peer address and invoke ID using
+ *  FNV-1a over the same fields that bacnet_address_same() compares
+ * @param dest - BACnet address of the peer
+ * @param invokeID - invoke ID
+ * @return hash bucket index
+ */
+static unsigned tsm_peer_hash(const BACNET_ADDRESS *dest, uint8_t invokeID)
+{
+    uint32_t hash = 2166136261UL;
+    uint8_t i = 0;
+
+    hash = (hash ^ invokeID) * 16777619UL;
+    hash = (hash ^ dest->mac_len) * 16777619UL;
+    for (i = 0; (i < dest->mac_len) && (i < MAX_MAC_LEN); i++) {
+        hash = (hash ^ dest->mac[i]) * 16777619UL;
+    }
+    hash = (hash ^ (dest->net & 0xFF)) * 16777619UL;
+    hash = (hash ^ (dest->net >> 8)) * 16777619UL;
+    if (dest->net != 0) {
+        hash = (hash ^ dest->len) * 16777619UL;
+        for (i = 0; (i < dest->len) && (i < MAX_MAC_LEN); i++) {
+            hash = (hash ^ dest->adr[i]) * 16777619UL;
         }
     }
 
-    return index;
+    return (unsigned)(hash % TSM_HASH_SIZE);
 }
 
-/** Find the first free index in the TSM table.
- *
- * @return Index of the id or MAX_TSM_TRANSACTIONS
- *         if no entry is free.
+/**
+ * @brief Find a per-peer transaction
+ * @param dest - BACnet address of the peer
+ * @param invokeID - invoke ID used with the peer
+ * @return transaction, or NULL if not found
  */
-static uint8_t tsm_find_first_free_index(void)
+static BACNET_TSM_DATA *
+tsm_peer_find(const BACNET_ADDRESS *dest, uint8_t invokeID)
 {
-    unsigned i = 0; /* counter */
-    uint8_t index = MAX_TSM_TRANSACTIONS; /* return value */
+    BACNET_TSM_DATA *plist;
 
-    const BACNET_TSM_DATA *plist = TSM_List;
+    plist = tsm_link_entry(TSM_Hash[tsm_peer_hash(dest, invokeID)]);
+    while (plist) {
+        if ((plist->InvokeID == invokeID) &&
+            bacnet_address_same(&plist->dest, dest)) {
+            break;
+        }
+        plist = tsm_link_entry(plist->Next);
+    }
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if (plist->InvokeID == 0) {
-            index = (uint8_t)i;
+    return plist;
+}
+
+/**
+ * @brief Remove a per-peer transaction from its hash chain
+ * @param plist - transaction
+ */
+static void tsm_peer_remove(BACNET_TSM_DATA *plist)
+{
+    uint16_t link = tsm_link_value(plist);
+    uint16_t *pLink;
+
+    pLink = &TSM_Hash[tsm_peer_hash(&plist->dest, plist->InvokeID)];
+    while (*pLink != 0) {
+        if (*pLink == link) {
+            *pLink = plist->Next;
+            plist->Next = 0;
             break;
         }
+        pLink = &tsm_link_entry(*pLink)->Next;
+    }
+}
+
+/**
+ * @brief Find a transaction from the invoke ID of a message sent to,
+ *  or received from, a peer. An invoke ID that is unique for all peers
+ *  matches regardless of the peer address, as it always has.
+ * @param src - BACnet address of the peer, or NULL to only match
+ *  invoke IDs from tsm_next_free_invokeID()
+ * @param invokeID - invoke ID
+ * @return transaction, or NULL if not found
+ */
+static BACNET_TSM_DATA *
+tsm_transaction_find(const BACNET_ADDRESS *src, uint8_t invokeID)
+{
+    if (invokeID == 0) {
+        return NULL;
+    }
+    if (TSM_Global_Index[invokeID] != 0) {
+        return tsm_link_entry(TSM_Global_Index[invokeID]);
+    }
+    if (src) {
+        return tsm_peer_find(src, invokeID);
     }
 
-    return index;
+    return NULL;
 }
 
-/** Check if space for transactions is available.
- *
- * @return true/false
+/**
+ * @brief Determine if a time is before another, allowing for the
+ *  TSM clock to wrap around
+ * @param time_a - time in milliseconds
+ * @param time_b - time in milliseconds
+ * @return true if time_a is before time_b
  */
-bool tsm_transaction_available(void)
+static bool tsm_time_before(uint32_t time_a, uint32_t time_b)
 {
-    bool status = false; /* return value */
-    unsigned i = 0; /* counter */
+    return (uint32_t)(time_a - time_b) > 0x7FFFFFFFUL;
+}
 
-    const BACNET_TSM_DATA *plist = TSM_List;
+/**
+ * @brief Place a transaction at a position in the timer heap
+ * @param position - zero based heap position
+ * @param plist - transaction
+ */
+static void tsm_timer_heap_set(uint16_t position, BACNET_TSM_DATA *plist)
+{
+    TSM_Timer_Heap[position] = plist;
+    plist->HeapIndex = position + 1;
+}
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if (plist->InvokeID == 0) {
-            /* one is available! */
-            status = true;
+/**
+ * @brief Move a transaction toward the root of the timer heap
+ * @param position - zero based heap position of the transaction
+ */
+static void tsm_timer_heap_up(uint16_t position)
+{
+    BACNET_TSM_DATA *plist = TSM_Timer_Heap[position];
+    uint16_t parent;
+
+    while (position > 0) {
+        parent = (position - 1) / 2;
+        if (!tsm_time_before(
+                plist->Deadline, TSM_Timer_Heap[parent]->Deadline)) {
             break;
         }
+        tsm_timer_heap_set(position, TSM_Timer_Heap[parent]);
+        position = parent;
     }
+    tsm_timer_heap_set(position, plist);
+}
 
-    return status;
+/**
+ * @brief Move a transaction toward the leaves of the timer heap
+ * @param position - zero based heap position of the transaction
+ */
+static void tsm_timer_heap_down(uint16_t position)
+{
+    BACNET_TSM_DATA *plist = TSM_Timer_Heap[position];
+    uint32_t child;
+
+    for (;;) {
+        child = (2UL * position) + 1;
+        if (child >= TSM_Timer_Count) {
+            break;
+        }
+        if (((child + 1) < TSM_Timer_Count) &&
+            tsm_time_before(
+                TSM_Timer_Heap[child + 1]->Deadline,
+                TSM_Timer_Heap[child]->Deadline)) {
+            child++;
+        }
+        if (!tsm_time_before(
+                TSM_Timer_Heap[child]->Deadline, plist->Deadline)) {
+            break;
+        }
+        tsm_timer_heap_set(position, TSM_Timer_Heap[child]);
+        position = (uint16_t)child;
+    }
+    tsm_timer_heap_set(position, plist);
 }
 
-/** Return the count of idle transaction.
- *
- * @return Count of idle transaction.
+/**
+ * @brief Stop the timer of a transaction
+ * @param plist - transaction
+ */
+static void tsm_timer_stop(BACNET_TSM_DATA *plist)
+{
+    uint16_t position;
+
+    if (plist->HeapIndex == 0) {
+        return;
+    }
+    position = plist->HeapIndex - 1;
+    plist->HeapIndex = 0;
+    TSM_Timer_Count--;
+    if (position < TSM_Timer_Count) {
+        tsm_timer_heap_set(position, TSM_Timer_Heap[TSM_Timer_Count]);
+        tsm_timer_heap_down(position);
+        tsm_timer_heap_up(TSM_Timer_Heap[position]->HeapIndex - 1);
+    }
+}
+
+/**
+ * @brief Start, or restart, the timer of a transaction
+ * @param plist - transaction
+ * @param milliseconds - time until the timer expires
  */
-uint8_t tsm_transaction_idle_count(void)
+static void tsm_timer_start(BACNET_TSM_DATA *plist, uint32_t milliseconds)
 {
-    uint8_t count = 0; /* return value */
-    unsigned i = 0; /* counter */
+    tsm_timer_stop(plist);
+    plist->Deadline = TSM_Milliseconds + milliseconds;
+    tsm_timer_heap_set(TSM_Timer_Count, plist);
+    TSM_Timer_Count++;
+    tsm_timer_heap_up(TSM_Timer_Count - 1);
+}
 
-    const BACNET_TSM_DATA *plist = TSM_List;
+#if BACNET_SEGMENTATION_ENABLED
+/**
+ * @brief Release the segment buffer of a transaction
+ * @param plist - transaction
+ */
+static void tsm_segment_free(BACNET_TSM_DATA *plist)
+{
+    free(plist->Segment);
+    plist->Segment = NULL;
+    plist->SegmentLength = 0;
+    plist->SegmentSize = 0;
+}
+#endif
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if ((plist->InvokeID == 0) && (plist->state == TSM_STATE_IDLE)) {
-            /* one is available! */
-            count++;
-        }
+/**
+ * @brief Reserve a transaction for an invoke ID
+ * @param dest - BACnet address of the peer for a per-peer invoke ID,
+ *  or NULL for an invoke ID that is unique for all peers
+ * @param invokeID - invoke ID, which is not in use
+ * @return transaction, or NULL if none are available
+ */
+static BACNET_TSM_DATA *
+tsm_transaction_new(const BACNET_ADDRESS *dest, uint8_t invokeID)
+{
+    BACNET_TSM_DATA *plist;
+    unsigned bucket;
+
+    if (TSM_Free_Head != 0) {
+        plist = tsm_link_entry(TSM_Free_Head);
+        TSM_Free_Head = plist->Next;
+    } else if (TSM_Unused_Index < MAX_TSM_TRANSACTIONS) {
+        plist = &TSM_List[TSM_Unused_Index];
+        TSM_Unused_Index++;
+    } else {
+        return NULL;
+    }
+    plist->InvokeID = invokeID;
+    plist->state = TSM_STATE_IDLE;
+    plist->Next = 0;
+    if (dest) {
+        plist->Global = false;
+        bacnet_address_copy(&plist->dest, dest);
+        bucket = tsm_peer_hash(dest, invokeID);
+        plist->Next = TSM_Hash[bucket];
+        TSM_Hash[bucket] = tsm_link_value(plist);
+    } else {
+        plist->Global = true;
+        TSM_Global_Index[invokeID] = tsm_link_value(plist);
     }
+    TSM_Invoke_ID_Count[invokeID]++;
+    TSM_Active_Count++;
 
-    return count;
+    return plist;
+}
+
+/**
+ * @brief Release a transaction and its invoke ID
+ * @param plist - transaction
+ */
+static void tsm_transaction_free(BACNET_TSM_DATA *plist)
+{
+    tsm_timer_stop(plist);
+    if (plist->Global) {
+        TSM_Global_Index[plist->InvokeID] = 0;
+    } else {
+        tsm_peer_remove(plist);
+    }
+    TSM_Invoke_ID_Count[plist->InvokeID]--;
+    TSM_Active_Count--;
+    plist->state = TSM_STATE_IDLE;
+    plist->InvokeID = 0;
+#if BACNET_SEGMENTATION_ENABLED
+    tsm_segment_free(plist);
+#endif
+    plist->Next = TSM_Free_Head;
+    TSM_Free_Head = tsm_link_value(plist);
+}
+
+/** Check if space for transactions is available.
+ *
+ * @return true/false
+ */
+bool tsm_transaction_available(void)
+{
+    return TSM_Active_Count < MAX_TSM_TRANSACTIONS;
+}
+
+/** Return the count of idle transaction.
+ *
+ * @return Count of idle transaction. This is a uint16_t, since
+ *  MAX_TSM_TRANSACTIONS may be configured above 255.
+ */
+uint16_t tsm_transaction_idle_count(void)
+{
+    return (uint16_t)(MAX_TSM_TRANSACTIONS - TSM_Active_Count);
 }
 
 /**
@@ -149,54 +439,76 @@ void tsm_invokeID_set(uint8_t invokeID)
     Current_Invoke_ID = invokeID;
 }
 
+/**
+ * @brief Get the next invoke ID to try, skipping zero which we
+ *  treat internally as invalid or no free
+ * @return invoke ID
+ */
+static uint8_t tsm_invokeID_next(void)
+{
+    uint8_t invokeID = Current_Invoke_ID;
+
+    Current_Invoke_ID++;
+    if (Current_Invoke_ID == 0) {
+        Current_Invoke_ID = 1;
+    }
+
+    return invokeID;
+}
+
 /** Gets the next free invokeID,
  * and reserves a spot in the table
  * returns 0 if none are available.
+ * The invoke ID is not in use with any peer, so the functions
+ * that only take an invoke ID may be used with it.
  *
  * @return free invoke ID
  */
 uint8_t tsm_next_free_invokeID(void)
 {
-    uint8_t index = 0;
-    uint8_t invokeID = 0;
-    bool found = false;
-    BACNET_TSM_DATA *plist = NULL;
+    unsigned i;
+    uint8_t invokeID;
 
     /* Is there even space available? */
-    if (tsm_transaction_available()) {
-        while (!found) {
-            index = tsm_find_invokeID_index(Current_Invoke_ID);
-            if (index == MAX_TSM_TRANSACTIONS) {
-                /* Not found, so this invokeID is not used */
-                found = true;
-                /* set this id into the table */
-                index = tsm_find_first_free_index();
-                if (index != MAX_TSM_TRANSACTIONS) {
-                    plist = &TSM_List[index];
-                    plist->InvokeID = invokeID = Current_Invoke_ID;
-                    plist->state = TSM_STATE_IDLE;
-                    plist->RequestTimer = apdu_timeout();
-                    /* update for the next call or check */
-                    Current_Invoke_ID++;
-                    /* skip zero - we treat that internally as invalid or no
-                     * free */
-                    if (Current_Invoke_ID == 0) {
-                        Current_Invoke_ID = 1;
-                    }
-                }
-            } else {
-                /* found! This invokeID is already used */
-                /* try next one */
-                Current_Invoke_ID++;
-                /* skip zero - we treat that internally as invalid or no free */
-                if (Current_Invoke_ID == 0) {
-                    Current_Invoke_ID = 1;
-                }
-            }
+    if (!tsm_transaction_available()) {
+        return 0;
+    }
+    for (i = 0; i < 255; i++) {
+        invokeID = tsm_invokeID_next();
+        if (TSM_Invoke_ID_Count[invokeID] == 0) {
+            (void)tsm_transaction_new(NULL, invokeID);
+            return invokeID;
         }
     }
 
-    return invokeID;
+    return 0;
+}
+
+/**
+ * @brief Gets the next invoke ID that is free for a peer, and reserves
+ *  a spot in the table. Invoke IDs are scoped per peer, so up to 255
+ *  requests may be outstanding with each peer.
+ * @param dest - BACnet address of the peer
+ * @return free invoke ID, or 0 if none are available
+ */
+uint8_t tsm_peer_next_free_invokeID(const BACNET_ADDRESS *dest)
+{
+    unsigned i;
+    uint8_t invokeID;
+
+    if (!dest || !tsm_transaction_available()) {
+        return 0;
+    }
+    for (i = 0; i < 255; i++) {
+        invokeID = tsm_invokeID_next();
+        if ((TSM_Global_Index[invokeID] == 0) &&
+            !tsm_peer_find(dest, invokeID)) {
+            (void)tsm_transaction_new(dest, invokeID);
+            return invokeID;
+        }
+    }
+
+    return 0;
 }
 
 /** Set for an unsegmented transaction
@@ -216,25 +528,26 @@ void tsm_set_confirmed_unsegmented_transaction(
     uint16_t apdu_len)
 {
     uint16_t j = 0;
-    uint8_t index;
     BACNET_TSM_DATA *plist;
 
     if (invokeID && ndpu_data && apdu && (apdu_len > 0)) {
-        index = tsm_find_invokeID_index(invokeID);
-        if (index < MAX_TSM_TRANSACTIONS) {
-            plist = &TSM_List[index];
+        plist = tsm_transaction_find(dest, invokeID);
+        if (plist) {
             /* SendConfirmedUnsegmented */
             plist->state = TSM_STATE_AWAIT_CONFIRMATION;
             plist->RetryCount = 0;
             /* start the timer */
-            plist->RequestTimer = apdu_timeout();
+            tsm_timer_start(plist, apdu_timeout());
             /* copy the data */
             for (j = 0; j < apdu_len; j++) {
                 plist->apdu[j] = apdu[j];
             }
             plist->apdu_len = apdu_len;
             npdu_copy_data(&plist->npdu_data, ndpu_data);
-            bacnet_address_copy(&plist->dest, dest);
+            if (plist->Global) {
+                /* per-peer transactions already hold their peer */
+                bacnet_address_copy(&plist->dest, dest);
+            }
         }
     }
 
@@ -261,18 +574,16 @@ bool tsm_get_transaction_pdu(
     uint16_t *apdu_len)
 {
     uint16_t j = 0;
-    uint8_t index;
     bool found = false;
     BACNET_TSM_DATA *plist;
 
     if (invokeID && apdu && ndpu_data && apdu_len) {
-        index = tsm_find_invokeID_index(invokeID);
+        plist = tsm_transaction_find(NULL, invokeID);
         /* how much checking is needed?  state?  dest match? just invokeID? */
-        if (index < MAX_TSM_TRANSACTIONS) {
+        if (plist) {
             /* FIXME: we may want to free the transaction so it doesn't timeout
              */
             /* retrieve the transaction */
-            plist = &TSM_List[index];
             *apdu_len = (uint16_t)plist->apdu_len;
             if (*apdu_len > MAX_PDU) {
                 *apdu_len = MAX_PDU;
@@ -289,46 +600,1177 @@ bool tsm_get_transaction_pdu(
     return found;
 }
 
+#if BACNET_SEGMENTATION_ENABLED
+#if (BACNET_MAX_SEGMENTS_ACCEPTED < 2) || (BACNET_MAX_SEGMENTS_ACCEPTED > 255)
+#error "BACNET_MAX_SEGMENTS_ACCEPTED must be 2..255"
+#endif
+#if (BACNET_SEGMENTATION_WINDOW_SIZE < 1) || \
+    (BACNET_SEGMENTATION_WINDOW_SIZE > 127)
+#error "BACNET_SEGMENTATION_WINDOW_SIZE must be 1..127"
+#endif
+/* header octets of a segmented complex-ack and confirmed request */
+#define TSM_SEGMENT_ACK_HEADER_LEN 5
+#define TSM_SEGMENT_REQUEST_HEADER_LEN 6
+/* header octets of the unsegmented forms */
+#define TSM_COMPLEX_ACK_HEADER_LEN 3
+#define TSM_REQUEST_HEADER_LEN 4
+/* the sequence number is one octet, so a message has at most 256 segments */
+#define TSM_SEGMENT_COUNT_MAX 256U
+
+/* segmented transactions where we are the server. Peers choose their
+   invoke IDs independently, so these are keyed by peer address and
+   invoke ID, and a state of IDLE is an unused spot in the table. */
+static BACNET_TSM_DATA TSM_Server_List[BACNET_SEGMENTATION_SERVER_TRANSACTIONS];
+/* buffer for the segments, segment-acks, and aborts that we send */
+static uint8_t Segment_Transmit_Buffer[MAX_PDU];
+static BACNET_TSM_SEGMENT_STATISTICS Segment_Statistics;
+
+/**
+ * @brief Append service data to the segment buffer of a transaction,
+ *  growing the buffer as segments arrive, up to MAX_ASDU.
+ * @param plist - transaction
+ * @param data - service data to append
+ * @param data_len - number of octets to append
+ * @return true if the data was appended
+ */
+static bool tsm_segment_append(
+    BACNET_TSM_DATA *plist, const uint8_t *data, uint32_t data_len)
+{
+    uint32_t size;
+    uint8_t *buffer;
+
+    if ((plist->SegmentLength + data_len) > MAX_ASDU) {
+        return false;
+    }
+    if ((plist->SegmentLength + data_len) > plist->SegmentSize) {
+        size = plist->SegmentSize * 2;
+        if (size < MAX_APDU) {
+            size = MAX_APDU;
+        }
+        if (size < (plist->SegmentLength + data_len)) {
+            size = plist->SegmentLength + data_len;
+        }
+        if (size > MAX_ASDU) {
+            size = MAX_ASDU;
+        }
+        buffer = realloc(plist->Segment, size);
+        if (!buffer) {
+            return false;
+        }
+        plist->Segment = buffer;
+        plist->SegmentSize = size;
+    }
+    if (data_len > 0) {
+        memcpy(&plist->Segment[plist->SegmentLength], data, data_len);
+        plist->SegmentLength += data_len;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Send an APDU using the segment transmit buffer
+ * @param dest - destination address
+ * @param npdu_data - network layer information
+ * @param apdu - APDU header to send
+ * @param apdu_len - number of octets in the APDU header
+ * @param data - service data following the header, or NULL
+ * @param data_len - number of octets of service data
+ * @return number of bytes sent, or negative on error
+ */
+static int tsm_apdu_send(
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    const uint8_t *apdu,
+    unsigned apdu_len,
+    const uint8_t *data,
+    unsigned data_len)
+{
+    BACNET_ADDRESS dest_address;
+    BACNET_ADDRESS my_address;
+    BACNET_NPDU_DATA npdu;
+    int pdu_len;
+
+    bacnet_address_copy(&dest_address, dest);
+    npdu_copy_data(&npdu, npdu_data);
+    datalink_get_my_address(&my_address);
+    pdu_len = npdu_encode_pdu(
+        &Segment_Transmit_Buffer[0], &dest_address, &my_address, &npdu);
+    if ((pdu_len + apdu_len + data_len) > sizeof(Segment_Transmit_Buffer)) {
+        return -1;
+    }
+    memcpy(&Segment_Transmit_Buffer[pdu_len], apdu, apdu_len);
+    if (data_len > 0) {
+        memcpy(&Segment_Transmit_Buffer[pdu_len + apdu_len], data, data_len);
+    }
+
+    return datalink_send_pdu(
+        &dest_address, &npdu, &Segment_Transmit_Buffer[0],
+        pdu_len + apdu_len + data_len);
+}
+
+/**
+ * @brief Send a Segment-ACK PDU
+ * @param dest - destination address
+ * @param priority - network priority
+ * @param invoke_id - invoke ID of the transaction
+ * @param sequence_number - sequence number being acknowledged
+ * @param window_size - actual window size
+ * @param nak - true if a segment was received out of order
+ * @param server - true if sent by the server
+ */
+static void tsm_segment_ack_send(
+    const BACNET_ADDRESS *dest,
+    BACNET_MESSAGE_PRIORITY priority,
+    uint8_t invoke_id,
+    uint8_t sequence_number,
+    uint8_t window_size,
+    bool nak,
+    bool server)
+{
+    BACNET_NPDU_DATA npdu_data;
+    uint8_t apdu[4];
+
+    apdu[0] = PDU_TYPE_SEGMENT_ACK;
+    if (nak) {
+        apdu[0] |= BIT(1);
+        Segment_Statistics.segment_naks_sent++;
+    }
+    if (server) {
+        apdu[0] |= BIT(0);
+    }
+    apdu[1] = invoke_id;
+    apdu[2] = sequence_number;
+    apdu[3] = window_size;
+    npdu_encode_npdu_data(&npdu_data, false, priority);
+    (void)tsm_apdu_send(dest, &npdu_data, apdu, sizeof(apdu), NULL, 0);
+    Segment_Statistics.segment_acks_sent++;
+}
+
+/**
+ * @brief Send an Abort PDU for a segmented transaction
+ * @param dest - destination address
+ * @param priority - network priority
+ * @param invoke_id - invoke ID of the transaction
+ * @param reason - abort reason
+ * @param server - true if sent by the server
+ */
+static void tsm_segment_abort_send(
+    const BACNET_ADDRESS *dest,
+    BACNET_MESSAGE_PRIORITY priority,
+    uint8_t invoke_id,
+    BACNET_ABORT_REASON reason,
+    bool server)
+{
+    BACNET_NPDU_DATA npdu_data;
+    uint8_t apdu[3];
+    int apdu_len;
+
+    apdu_len = abort_encode_apdu(apdu, invoke_id, reason, server);
+    npdu_encode_npdu_data(&npdu_data, false, priority);
+    (void)tsm_apdu_send(
+        dest, &npdu_data, apdu, (unsigned)apdu_len, NULL, 0);
+    Segment_Statistics.transactions_aborted++;
+}
+
+/**
+ * @brief Determine the service data octets carried in each segment
+ * @param max_apdu - maximum APDU length of each segment
+ * @param server - true for complex-ack segments, false for requests
+ * @return number of service data octets per segment
+ */
+static unsigned tsm_segment_payload(unsigned max_apdu, bool server)
+{
+    unsigned header_len;
+
+    if (server) {
+        header_len = TSM_SEGMENT_ACK_HEADER_LEN;
+    } else {
+        header_len = TSM_SEGMENT_REQUEST_HEADER_LEN;
+    }
+    if (max_apdu <= header_len) {
+        return 1;
+    }
+
+    return max_apdu - header_len;
+}
+
+/**
+ * @brief Determine the number of segments needed to send service data
+ * @param data_len - number of octets of service data
+ * @param max_apdu - maximum APDU length of each segment
+ * @param server - true for complex-ack segments, false for requests
+ * @return number of segments
+ */
+static uint32_t
+tsm_segment_count(uint32_t data_len, unsigned max_apdu, bool server)
+{
+    unsigned payload;
+
+    payload = tsm_segment_payload(max_apdu, server);
+
+    return (data_len + payload - 1) / payload;
+}
+
+/**
+ * @brief Determine the number of segments a peer accepts
+ * @param max_segs - decoded max-segments-accepted of the peer
+ * @return number of segments that may be sent to the peer
+ */
+static unsigned tsm_segment_max_segments(int max_segs)
+{
+    /* unspecified, or greater than 64, is limited by our own capacity */
+    if ((max_segs <= 0) || (max_segs > BACNET_MAX_SEGMENTS_ACCEPTED) ||
+        (max_segs > 64)) {
+        return BACNET_MAX_SEGMENTS_ACCEPTED;
+    }
+
+    return (unsigned)max_segs;
+}
+
+/**
+ * @brief Send one segment of the service data in a transaction
+ * @param plist - transaction
+ * @param sequence_number - sequence number of the segment to send
+ * @param server - true for complex-ack segments, false for requests
+ * @return number of bytes sent, or negative on error
+ */
+static int tsm_segment_send(
+    BACNET_TSM_DATA *plist, uint8_t sequence_number, bool server)
+{
+    uint8_t apdu[TSM_SEGMENT_REQUEST_HEADER_LEN];
+    unsigned apdu_len = 0;
+    unsigned payload;
+    uint32_t offset;
+    uint32_t data_len;
+    bool more_follows;
+    int bytes_sent;
+
+    payload = tsm_segment_payload(plist->SegmentMaxApdu, server);
+    offset = (uint32_t)sequence_number * payload;
+    if (offset > plist->SegmentLength) {
+        return -1;
+    }
+    data_len = plist->SegmentLength - offset;
+    if (data_len > payload) {
+        data_len = payload;
+    }
+    more_follows = (sequence_number + 1U) < plist->SegmentCount;
+    if (server) {
+        apdu[apdu_len] = PDU_TYPE_COMPLEX_ACK | BIT(3);
+        if (more_follows) {
+            apdu[apdu_len] |= BIT(2);
+        }
+        apdu_len++;
+    } else {
+        apdu[apdu_len] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST | BIT(3);
+        if (more_follows) {
+            apdu[apdu_len] |= BIT(2);
+        }
+        if (plist->ServiceData.segmented_response_accepted) {
+            apdu[apdu_len] |= BIT(1);
+        }
+        apdu_len++;
+        apdu[apdu_len++] = encode_max_segs_max_apdu(
+            plist->ServiceData.max_segs, plist->ServiceData.max_resp);
+    }
+    apdu[apdu_len++] = plist->InvokeID;
+    apdu[apdu_len++] = sequence_number;
+    apdu[apdu_len++] = plist->ProposedWindowSize;
+    apdu[apdu_len++] = plist->ServiceChoice;
+    bytes_sent = tsm_apdu_send(
+        &plist->dest, &plist->npdu_data, apdu, apdu_len,
+        &plist->Segment[offset], data_len);
+    if (bytes_sent > 0) {
+        Segment_Statistics.segments_sent++;
+    }
+    if (!more_follows) {
+        plist->SentAllSegments = true;
+    }
+
+    return bytes_sent;
+}
+
+/**
+ * @brief Determine if a sequence number is within the current window
+ * @param plist - transaction
+ * @param sequence_number_a - sequence number to test
+ * @param sequence_number_b - first sequence number of the window
+ * @return true if the sequence number is within the window
+ */
+static bool tsm_segment_in_window(
+    const BACNET_TSM_DATA *plist,
+    uint8_t sequence_number_a,
+    uint8_t sequence_number_b)
+{
+    uint8_t delta = (uint8_t)(sequence_number_a - sequence_number_b);
+
+    return delta < plist->ActualWindowSize;
+}
+
+/**
+ * @brief Send the segments that fit in the current window
+ * @param plist - transaction
+ * @param sequence_number - sequence number of the first segment to send
+ * @param server - true for complex-ack segments, false for requests
+ */
+static void tsm_segment_fill_window(
+    BACNET_TSM_DATA *plist, uint8_t sequence_number, bool server)
+{
+    unsigned ix;
+    unsigned sequence;
+
+    for (ix = 0; ix < plist->ActualWindowSize; ix++) {
+        sequence = (unsigned)sequence_number + ix;
+        if (sequence >= plist->SegmentCount) {
+            break;
+        }
+        (void)tsm_segment_send(plist, (uint8_t)sequence, server);
+    }
+}
+
+/**
+ * @brief Start sending a segmented message with the first segment,
+ *  a window size of one, and our proposed window size.
+ * @param plist - transaction with the service data to send
+ * @param max_apdu - maximum APDU length of each segment
+ * @param server - true for complex-ack segments, false for requests
+ * @return number of bytes sent, or negative on error
+ */
+static int
+tsm_segment_send_start(BACNET_TSM_DATA *plist, unsigned max_apdu, bool server)
+{
+    uint32_t count;
+
+    count = tsm_segment_count(plist->SegmentLength, max_apdu, server);
+    if (count > TSM_SEGMENT_COUNT_MAX) {
+        /* the sequence number would wrap and resend the first segments */
+        return -1;
+    }
+    plist->SegmentMaxApdu = (uint16_t)max_apdu;
+    plist->SegmentCount = (uint16_t)count;
+    plist->SegmentRetryCount = 0;
+    plist->SentAllSegments = false;
+    plist->InitialSequenceNumber = 0;
+    plist->ActualWindowSize = 1;
+    plist->ProposedWindowSize = BACNET_SEGMENTATION_WINDOW_SIZE;
+    tsm_timer_start(plist, apdu_segment_timeout());
+
+    return tsm_segment_send(plist, 0, server);
+}
+
+/**
+ * @brief Handle a Segment-ACK as the segment sender
+ * @param plist - transaction
+ * @param sequence_number - sequence number acknowledged by the receiver
+ * @param window_size - actual window size from the receiver
+ * @param nak - true if the receiver reported a segment out of order
+ * @param server - true for complex-ack segments, false for requests
+ * @return true if the final segment was acknowledged
+ */
+static bool tsm_segment_ack_process(
+    BACNET_TSM_DATA *plist,
+    uint8_t sequence_number,
+    uint8_t window_size,
+    bool nak,
+    bool server)
+{
+    uint32_t sent;
+
+    if ((window_size < 1) || (window_size > 127)) {
+        window_size = 1;
+    }
+    if (tsm_segment_in_window(
+            plist, sequence_number, plist->InitialSequenceNumber)) {
+        if (plist->SentAllSegments &&
+            ((sequence_number + 1U) == plist->SegmentCount)) {
+            /* FinalSegmentACK */
+            return true;
+        }
+        /* NewSegmentACK */
+        plist->InitialSequenceNumber = sequence_number + 1;
+        plist->ActualWindowSize = window_size;
+        plist->SegmentRetryCount = 0;
+        tsm_segment_fill_window(plist, plist->InitialSequenceNumber, server);
+    } else if (
+        nak &&
+        (sequence_number == (uint8_t)(plist->InitialSequenceNumber - 1))) {
+        /* nothing in the window arrived in order: send it again */
+        plist->ActualWindowSize = window_size;
+        sent = Segment_Statistics.segments_sent;
+        tsm_segment_fill_window(plist, plist->InitialSequenceNumber, server);
+        Segment_Statistics.segments_retransmitted +=
+            Segment_Statistics.segments_sent - sent;
+    }
+    /* DuplicateSegmentACK only restarts the timer */
+    tsm_timer_start(plist, apdu_segment_timeout());
+
+    return false;
+}
+
+/**
+ * @brief Timer of a segment sender expired: send the window again,
+ *  or give up after the configured number of retries.
+ * @param plist - transaction
+ * @param server - true for complex-ack segments, false for requests
+ * @return true if the transaction failed
+ */
+static bool tsm_segment_send_timeout(BACNET_TSM_DATA *plist, bool server)
+{
+    uint32_t sent;
+
+    if (plist->SegmentRetryCount < apdu_retries()) {
+        plist->SegmentRetryCount++;
+        tsm_timer_start(plist, apdu_segment_timeout());
+        sent = Segment_Statistics.segments_sent;
+        tsm_segment_fill_window(plist, plist->InitialSequenceNumber, server);
+        Segment_Statistics.segments_retransmitted +=
+            Segment_Statistics.segments_sent - sent;
+        return false;
+    }
+    Segment_Statistics.transactions_timed_out++;
+
+    return true;
+}
+
+/**
+ * @brief Segment receiver timeout, which is four times the segment timeout
+ * @return timeout in milliseconds
+ */
+static uint32_t tsm_segment_wait_timeout(void)
+{
+    return 4UL * apdu_segment_timeout();
+}
+
+/**
+ * @brief Start receiving a segmented message with its first segment
+ * @param plist - transaction
+ * @param src - address of the segment sender
+ * @param priority - network priority for the Segment-ACK
+ * @param invoke_id - invoke ID of the transaction
+ * @param proposed_window_size - window size proposed by the sender
+ * @param data - service data of the first segment
+ * @param data_len - octets of service data in the first segment
+ * @param server - true if we are the server in the transaction
+ * @return abort reason, or ABORT_REASON_OTHER if no abort is needed
+ */
+static BACNET_ABORT_REASON tsm_segment_receive_start(
+    BACNET_TSM_DATA *plist,
+    const BACNET_ADDRESS *src,
+    BACNET_MESSAGE_PRIORITY priority,
+    uint8_t invoke_id,
+    uint8_t proposed_window_size,
+    const uint8_t *data,
+    uint16_t data_len,
+    bool server)
+{
+    if ((proposed_window_size < 1) || (proposed_window_size > 127)) {
+        return ABORT_REASON_WINDOW_SIZE_OUT_OF_RANGE;
+    }
+    plist->SegmentLength = 0;
+    if (!tsm_segment_append(plist, data, data_len)) {
+        return ABORT_REASON_BUFFER_OVERFLOW;
+    }
+    Segment_Statistics.segments_received++;
+    plist->ProposedWindowSize = proposed_window_size;
+    plist->ActualWindowSize = proposed_window_size;
+    if (plist->ActualWindowSize > BACNET_SEGMENTATION_WINDOW_SIZE) {
+        plist->ActualWindowSize = BACNET_SEGMENTATION_WINDOW_SIZE;
+    }
+    plist->InitialSequenceNumber = 0;
+    plist->LastSequenceNumber = 0;
+    plist->SegmentCount = 1;
+    tsm_timer_start(plist, tsm_segment_wait_timeout());
+    tsm_segment_ack_send(
+        src, priority, invoke_id, 0, plist->ActualWindowSize, false, server);
+
+    return ABORT_REASON_OTHER;
+}
+
+/**
+ * @brief Handle a subsequent segment as the segment receiver
+ * @param plist - transaction
+ * @param src - address of the segment sender
+ * @param priority - network priority for the Segment-ACK
+ * @param invoke_id - invoke ID of the transaction
+ * @param sequence_number - sequence number of the segment
+ * @param more_follows - true if more segments follow
+ * @param data - service data of the segment
+ * @param data_len - octets of service data in the segment
+ * @param server - true if we are the server in the transaction
+ * @param complete - set true when the last segment was received in order
+ * @return abort reason, or ABORT_REASON_OTHER if no abort is needed
+ */
+static BACNET_ABORT_REASON tsm_segment_receive(
+    BACNET_TSM_DATA *plist,
+    const BACNET_ADDRESS *src,
+    BACNET_MESSAGE_PRIORITY priority,
+    uint8_t invoke_id,
+    uint8_t sequence_number,
+    bool more_follows,
+    const uint8_t *data,
+    uint16_t data_len,
+    bool server,
+    bool *complete)
+{
+    *complete = false;
+    tsm_timer_start(plist, tsm_segment_wait_timeout());
+    if (sequence_number == (uint8_t)(plist->LastSequenceNumber + 1)) {
+        if ((plist->SegmentCount >= BACNET_MAX_SEGMENTS_ACCEPTED) ||
+            !tsm_segment_append(plist, data, data_len)) {
+            return ABORT_REASON_BUFFER_OVERFLOW;
+        }
+        Segment_Statistics.segments_received++;
+        plist->SegmentCount++;
+        plist->LastSequenceNumber = sequence_number;
+        if (!more_follows) {
+            /* LastSegmentOfMessageReceived */
+            tsm_segment_ack_send(
+                src, priority, invoke_id, sequence_number,
+                plist->ActualWindowSize, false, server);
+            *complete = true;
+        } else if (
+            sequence_number ==
+            (uint8_t)(plist->InitialSequenceNumber +
+                      plist->ActualWindowSize)) {
+            /* LastSegmentOfGroupReceived */
+            plist->InitialSequenceNumber = sequence_number;
+            tsm_segment_ack_send(
+                src, priority, invoke_id, sequence_number,
+                plist->ActualWindowSize, false, server);
+        }
+    } else if (
+        (uint8_t)(plist->LastSequenceNumber - sequence_number) <
+        plist->ActualWindowSize) {
+        /* duplicate of a segment already received: discard */
+    } else {
+        /* SegmentReceivedOutOfOrder */
+        plist->InitialSequenceNumber = plist->LastSequenceNumber;
+        tsm_segment_ack_send(
+            src, priority, invoke_id, plist->LastSequenceNumber,
+            plist->ActualWindowSize, true, server);
+    }
+
+    return ABORT_REASON_OTHER;
+}
+
+/**
+ * @brief Find a segmented transaction where we are the server
+ * @param src - address of the client
+ * @param invoke_id - invoke ID chosen by the client
+ * @return transaction, or NULL if not found
+ */
+static BACNET_TSM_DATA *
+tsm_server_transaction_find(const BACNET_ADDRESS *src, uint8_t invoke_id)
+{
+    unsigned i;
+    BACNET_TSM_DATA *plist = &TSM_Server_List[0];
+
+    for (i = 0; i < BACNET_SEGMENTATION_SERVER_TRANSACTIONS; i++, plist++) {
+        if ((plist->state != TSM_STATE_IDLE) &&
+            (plist->InvokeID == invoke_id) &&
+            bacnet_address_same(&plist->dest, src)) {
+            return plist;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Find or allocate a segmented transaction where we are the server
+ * @param src - address of the client
+ * @param invoke_id - invoke ID chosen by the client
+ * @return transaction, or NULL if none are available
+ */
+static BACNET_TSM_DATA *
+tsm_server_transaction_new(const BACNET_ADDRESS *src, uint8_t invoke_id)
+{
+    unsigned i;
+    BACNET_TSM_DATA *plist;
+
+    plist = tsm_server_transaction_find(src, invoke_id);
+    if (plist) {
+        plist->SegmentLength = 0;
+        return plist;
+    }
+    plist = &TSM_Server_List[0];
+    for (i = 0; i < BACNET_SEGMENTATION_SERVER_TRANSACTIONS; i++, plist++) {
+        if (plist->state == TSM_STATE_IDLE) {
+            plist->InvokeID = invoke_id;
+            bacnet_address_copy(&plist->dest, src);
+            plist->SegmentLength = 0;
+            return plist;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Release a segmented transaction where we are the server
+ * @param plist - transaction
+ */
+static void tsm_server_transaction_free(BACNET_TSM_DATA *plist)
+{
+    tsm_timer_stop(plist);
+    tsm_segment_free(plist);
+    plist->state = TSM_STATE_IDLE;
+    plist->InvokeID = 0;
+}
+
+/**
+ * @brief Send a confirmed request that may need segmentation.
+ *  The invoke ID must come from tsm_next_free_invokeID() or
+ *  tsm_peer_next_free_invokeID(), and the caller is responsible for
+ *  knowing that the peer accepts segmented requests
+ *  (Segmentation_Supported and Max_Segments_Accepted). A request that
+ *  needs more than 256 segments of the max_apdu is not sent.
+ * @param invokeID - invoke ID of the request
+ * @param dest - destination address
+ * @param npdu_data - network layer information
+ * @param apdu - unsegmented form of the confirmed request APDU
+ * @param apdu_len - number of octets in the APDU
+ * @param max_apdu - maximum APDU length accepted by the peer
+ * @return number of bytes sent for the first PDU, or negative on error
+ */
+int tsm_set_confirmed_segmented_transaction(
+    uint8_t invokeID,
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    const uint8_t *apdu,
+    unsigned apdu_len,
+    unsigned max_apdu)
+{
+    BACNET_TSM_DATA *plist;
+
+    if (!invokeID || !dest || !npdu_data || !apdu ||
+        (apdu_len <= TSM_REQUEST_HEADER_LEN)) {
+        return -1;
+    }
+    plist = tsm_transaction_find(dest, invokeID);
+    if (!plist) {
+        return -1;
+    }
+    if (max_apdu > MAX_APDU) {
+        max_apdu = MAX_APDU;
+    }
+    if (apdu_len <= max_apdu) {
+        tsm_set_confirmed_unsegmented_transaction(
+            invokeID, dest, npdu_data, apdu, (uint16_t)apdu_len);
+        return tsm_apdu_send(dest, npdu_data, apdu, apdu_len, NULL, 0);
+    }
+    if (tsm_segment_count(
+            apdu_len - TSM_REQUEST_HEADER_LEN, max_apdu, false) >
+        TSM_SEGMENT_COUNT_MAX) {
+        return -1;
+    }
+    tsm_segment_free(plist);
+    if (!tsm_segment_append(
+            plist, &apdu[TSM_REQUEST_HEADER_LEN],
+            apdu_len - TSM_REQUEST_HEADER_LEN)) {
+        return -1;
+    }
+    plist->ServiceData.segmented_response_accepted =
+        (apdu[0] & BIT(1)) ? true : false;
+    plist->ServiceData.max_segs = decode_max_segs(apdu[1]);
+    plist->ServiceData.max_resp = decode_max_apdu(apdu[1]);
+    plist->ServiceChoice = apdu[3];
+    plist->RetryCount = 0;
+    /* the request is held in the segment buffer, not for retrieval */
+    plist->apdu_len = 0;
+    npdu_copy_data(&plist->npdu_data, npdu_data);
+    if (plist->Global) {
+        bacnet_address_copy(&plist->dest, dest);
+    }
+    plist->state = TSM_STATE_SEGMENTED_REQUEST;
+
+    return tsm_segment_send_start(plist, max_apdu, false);
+}
+
+/**
+ * @brief Largest unsegmented form of a complex-ack that the requester
+ *  of a confirmed service accepts, segmented or not.
+ * @param service_data - header of the confirmed request
+ * @return maximum complex-ack APDU length in octets
+ */
+unsigned tsm_segmented_complex_ack_size(
+    const BACNET_CONFIRMED_SERVICE_DATA *service_data)
+{
+    unsigned max_apdu = MAX_APDU;
+    unsigned size;
+
+    if (!service_data || !service_data->segmented_response_accepted) {
+        return MAX_APDU;
+    }
+    if ((service_data->max_resp > 0) &&
+        ((unsigned)service_data->max_resp < max_apdu)) {
+        max_apdu = (unsigned)service_data->max_resp;
+    }
+    size = TSM_COMPLEX_ACK_HEADER_LEN +
+        (tsm_segment_max_segments(service_data->max_segs) *
+         tsm_segment_payload(max_apdu, true));
+    if (size > MAX_ASDU) {
+        size = MAX_ASDU;
+    }
+
+    return size;
+}
+
+/**
+ * @brief Send a complex-ack, segmenting it when it does not fit in the
+ *  maximum APDU accepted by the requester. When the requester cannot
+ *  accept it, an Abort is sent instead.
+ * @param dest - address of the requester
+ * @param npdu_data - network layer information
+ * @param service_data - header of the confirmed request
+ * @param apdu - unsegmented form of the complex-ack APDU
+ * @param apdu_len - number of octets in the APDU
+ * @return number of bytes sent for the first PDU, or negative on error
+ */
+int tsm_segmented_complex_ack_send(
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    const BACNET_CONFIRMED_SERVICE_DATA *service_data,
+    const uint8_t *apdu,
+    unsigned apdu_len)
+{
+    BACNET_TSM_DATA *plist;
+    unsigned max_apdu = MAX_APDU;
+    uint32_t count;
+    BACNET_ABORT_REASON reason = ABORT_REASON_OTHER;
+
+    if (!dest || !npdu_data || !service_data || !apdu ||
+        (apdu_len < TSM_COMPLEX_ACK_HEADER_LEN)) {
+        return -1;
+    }
+    if ((service_data->max_resp > 0) &&
+        ((unsigned)service_data->max_resp < max_apdu)) {
+        max_apdu = (unsigned)service_data->max_resp;
+    }
+    if (apdu_len <= max_apdu) {
+        return tsm_apdu_send(dest, npdu_data, apdu, apdu_len, NULL, 0);
+    }
+    count = tsm_segment_count(
+        apdu_len - TSM_COMPLEX_ACK_HEADER_LEN, max_apdu, true);
+    plist = NULL;
+    if (!service_data->segmented_response_accepted) {
+        reason = ABORT_REASON_SEGMENTATION_NOT_SUPPORTED;
+    } else if (count > tsm_segment_max_segments(service_data->max_segs)) {
+        reason = ABORT_REASON_BUFFER_OVERFLOW;
+    } else {
+        plist = tsm_server_transaction_new(dest, service_data->invoke_id);
+        if (!plist) {
+            reason = ABORT_REASON_OUT_OF_RESOURCES;
+        } else if (!tsm_segment_append(
+                       plist, &apdu[TSM_COMPLEX_ACK_HEADER_LEN],
+                       apdu_len - TSM_COMPLEX_ACK_HEADER_LEN)) {
+            tsm_server_transaction_free(plist);
+            reason = ABORT_REASON_OUT_OF_RESOURCES;
+        }
+    }
+    if (reason != ABORT_REASON_OTHER) {
+        tsm_segment_abort_send(
+            dest, npdu_data->priority, service_data->invoke_id, reason, true);
+        return -1;
+    }
+    plist->ServiceChoice = apdu[2];
+    npdu_copy_data(&plist->npdu_data, npdu_data);
+    plist->state = TSM_STATE_SEGMENTED_RESPONSE;
+
+    return tsm_segment_send_start(plist, max_apdu, true);
+}
+
+/**
+ * @brief Handle a segment of a confirmed request where we are the server
+ * @param src - address of the client
+ * @param service_data - header of the segment; on completion, the header
+ *  of the reassembled request which is no longer segmented
+ * @param service_choice - service choice of the request
+ * @param service_request - service data of the segment; on completion,
+ *  the reassembled service data
+ * @param service_request_len - octets of service data of the segment;
+ *  on completion, the length of the reassembled service data
+ * @return true when the request is complete and ready for its handler,
+ *  which is followed by tsm_segmented_request_complete()
+ */
+bool tsm_segmented_request_received(
+    const BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_DATA *service_data,
+    uint8_t service_choice,
+    uint8_t **service_request,
+    uint16_t *service_request_len)
+{
+    BACNET_TSM_DATA *plist;
+    BACNET_ABORT_REASON reason = ABORT_REASON_OTHER;
+    bool complete = false;
+
+    if (!src || !service_data || !service_request || !service_request_len) {
+        return false;
+    }
+    if (service_data->sequence_number == 0) {
+        plist = tsm_server_transaction_new(src, service_data->invoke_id);
+        if (!plist) {
+            reason = ABORT_REASON_OUT_OF_RESOURCES;
+        } else {
+            memcpy(&plist->ServiceData, service_data, sizeof(*service_data));
+            plist->ServiceChoice = service_choice;
+            plist->state = TSM_STATE_SEGMENTED_REQUEST;
+            reason = tsm_segment_receive_start(
+                plist, src, service_data->priority, service_data->invoke_id,
+                service_data->proposed_window_number, *service_request,
+                *service_request_len, true);
+        }
+    } else {
+        plist = tsm_server_transaction_find(src, service_data->invoke_id);
+        if (!plist || (plist->state != TSM_STATE_SEGMENTED_REQUEST)) {
+            reason = ABORT_REASON_INVALID_APDU_IN_THIS_STATE;
+        } else {
+            reason = tsm_segment_receive(
+                plist, src, service_data->priority, service_data->invoke_id,
+                service_data->sequence_number, service_data->more_follows,
+                *service_request, *service_request_len, true, &complete);
+        }
+    }
+    if (reason != ABORT_REASON_OTHER) {
+        tsm_segment_abort_send(
+            src, service_data->priority, service_data->invoke_id, reason,
+            true);
+        if (plist) {
+            tsm_server_transaction_free(plist);
+        }
+        return false;
+    }
+    if (complete) {
+        Segment_Statistics.transactions_received++;
+        plist->state = TSM_STATE_AWAIT_RESPONSE;
+        memcpy(service_data, &plist->ServiceData, sizeof(*service_data));
+        service_data->segmented_message = false;
+        service_data->more_follows = false;
+        service_data->sequence_number = 0;
+        service_data->proposed_window_number = 0;
+        *service_request = plist->Segment;
+        *service_request_len = (uint16_t)plist->SegmentLength;
+    }
+
+    return complete;
+}
+
+/**
+ * @brief Release a reassembled request after its handler returns,
+ *  unless the handler started a segmented response for it.
+ * @param src - address of the client
+ * @param invokeID - invoke ID chosen by the client
+ */
+void tsm_segmented_request_complete(const BACNET_ADDRESS *src, uint8_t invokeID)
+{
+    BACNET_TSM_DATA *plist;
+
+    plist = tsm_server_transaction_find(src, invokeID);
+    if (plist && (plist->state == TSM_STATE_AWAIT_RESPONSE)) {
+        tsm_server_transaction_free(plist);
+    }
+}
+
+/**
+ * @brief Handle a segment of a complex-ack where we are the client
+ * @param src - address of the server
+ * @param service_ack_data - header of the segment; on completion, the
+ *  header of the reassembled complex-ack which is no longer segmented
+ * @param service_request - service data of the segment; on completion,
+ *  the reassembled service data
+ * @param service_request_len - octets of service data of the segment;
+ *  on completion, the length of the reassembled service data
+ * @return true when the complex-ack is complete and ready for its
+ *  handler, which is followed by tsm_free_invoke_id()
+ */
+bool tsm_segmented_complex_ack_received(
+    const BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_ACK_DATA *service_ack_data,
+    uint8_t **service_request,
+    uint16_t *service_request_len)
+{
+    BACNET_TSM_DATA *plist;
+    BACNET_ABORT_REASON reason = ABORT_REASON_OTHER;
+    bool complete = false;
+
+    if (!src || !service_ack_data || !service_request ||
+        !service_request_len) {
+        return false;
+    }
+    plist = tsm_transaction_find(src, service_ack_data->invoke_id);
+    if (!plist) {
+        return false;
+    }
+    if ((service_ack_data->sequence_number == 0) &&
+        (plist->state == TSM_STATE_AWAIT_CONFIRMATION)) {
+        plist->state = TSM_STATE_SEGMENTED_CONFIRMATION;
+        reason = tsm_segment_receive_start(
+            plist, src, plist->npdu_data.priority,
+            service_ack_data->invoke_id,
+            service_ack_data->proposed_window_number, *service_request,
+            *service_request_len, false);
+    } else if (plist->state == TSM_STATE_SEGMENTED_CONFIRMATION) {
+        reason = tsm_segment_receive(
+            plist, src, plist->npdu_data.priority,
+            service_ack_data->invoke_id, service_ack_data->sequence_number,
+            service_ack_data->more_follows, *service_request,
+            *service_request_len, false, &complete);
+    } else {
+        reason = ABORT_REASON_INVALID_APDU_IN_THIS_STATE;
+    }
+    if (reason != ABORT_REASON_OTHER) {
+        tsm_segment_abort_send(
+            src, plist->npdu_data.priority, service_ack_data->invoke_id,
+            reason, false);
+        /* IDLE with a valid invoke ID indicates a failed message */
+        tsm_timer_stop(plist);
+        tsm_segment_free(plist);
+        plist->state = TSM_STATE_IDLE;
+        return false;
+    }
+    if (complete) {
+        Segment_Statistics.transactions_received++;
+        service_ack_data->segmented_message = false;
+        service_ack_data->more_follows = false;
+        service_ack_data->sequence_number = 0;
+        service_ack_data->proposed_window_number = 0;
+        *service_request = plist->Segment;
+        *service_request_len = (uint16_t)plist->SegmentLength;
+    }
+
+    return complete;
+}
+
+/**
+ * @brief Handle a Segment-ACK for a segmented request or complex-ack
+ * @param src - address of the peer
+ * @param invokeID - invoke ID of the transaction
+ * @param sequence_number - sequence number acknowledged by the peer
+ * @param actual_window_size - window size chosen by the peer
+ * @param nak - true if the peer received a segment out of order
+ * @param server - true if sent by a server, acknowledging our request
+ */
+void tsm_segment_ack_received(
+    const BACNET_ADDRESS *src,
+    uint8_t invokeID,
+    uint8_t sequence_number,
+    uint8_t actual_window_size,
+    bool nak,
+    bool server)
+{
+    BACNET_TSM_DATA *plist;
+
+    Segment_Statistics.segment_acks_received++;
+    if (server) {
+        plist = tsm_transaction_find(src, invokeID);
+        if (!plist) {
+            return;
+        }
+        if ((plist->state == TSM_STATE_SEGMENTED_REQUEST) &&
+            tsm_segment_ack_process(
+                plist, sequence_number, actual_window_size, nak, false)) {
+            Segment_Statistics.transactions_sent++;
+            plist->state = TSM_STATE_AWAIT_CONFIRMATION;
+            tsm_timer_start(plist, apdu_timeout());
+        }
+    } else {
+        plist = tsm_server_transaction_find(src, invokeID);
+        if (plist && (plist->state == TSM_STATE_SEGMENTED_RESPONSE) &&
+            tsm_segment_ack_process(
+                plist, sequence_number, actual_window_size, nak, true)) {
+            Segment_Statistics.transactions_sent++;
+            tsm_server_transaction_free(plist);
+        }
+    }
+}
+
+/**
+ * @brief Handle an Abort sent by a client for a segmented transaction
+ *  where we are the server
+ * @param src - address of the client
+ * @param invokeID - invoke ID chosen by the client
+ */
+void tsm_segmented_abort_received(const BACNET_ADDRESS *src, uint8_t invokeID)
+{
+    BACNET_TSM_DATA *plist;
+
+    plist = tsm_server_transaction_find(src, invokeID);
+    if (plist) {
+        tsm_server_transaction_free(plist);
+    }
+}
+
+/**
+ * @brief Handle an expired segment timer of a client transaction
+ * @param plist - transaction
+ * @return true if the transaction failed
+ */
+static bool tsm_segment_client_timeout(BACNET_TSM_DATA *plist)
+{
+    bool failed = false;
+
+    if (plist->state == TSM_STATE_SEGMENTED_REQUEST) {
+        failed = tsm_segment_send_timeout(plist, false);
+    } else if (plist->state == TSM_STATE_SEGMENTED_CONFIRMATION) {
+        Segment_Statistics.transactions_timed_out++;
+        failed = true;
+    }
+    if (failed) {
+        tsm_segment_free(plist);
+    }
+
+    return failed;
+}
+
+/**
+ * @brief Handle an expired timer of a transaction where we are the server
+ * @param plist - transaction
+ * @return true if the transaction is one where we are the server
+ */
+static bool tsm_segment_server_timeout(BACNET_TSM_DATA *plist)
+{
+    bool failed = false;
+
+    if ((plist < &TSM_Server_List[0]) ||
+        (plist >= &TSM_Server_List[BACNET_SEGMENTATION_SERVER_TRANSACTIONS])) {
+        return false;
+    }
+    if (plist->state == TSM_STATE_SEGMENTED_RESPONSE) {
+        failed = tsm_segment_send_timeout(plist, true);
+    } else if (plist->state == TSM_STATE_SEGMENTED_REQUEST) {
+        Segment_Statistics.transactions_timed_out++;
+        failed = true;
+    }
+    if (failed) {
+        tsm_server_transaction_free(plist);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Copy the segmentation counters
+ * @param stats - where to copy the counters
+ */
+void tsm_segment_statistics(BACNET_TSM_SEGMENT_STATISTICS *stats)
+{
+    if (stats) {
+        memcpy(stats, &Segment_Statistics, sizeof(*stats));
+    }
+}
+
+/**
+ * @brief Segments sent and received per second since the last clear
+ * @return segments per second
+ */
+uint32_t tsm_segments_per_second(void)
+{
+    uint64_t segments;
+
+    if (Segment_Statistics.elapsed_milliseconds == 0) {
+        return 0;
+    }
+    segments = (uint64_t)Segment_Statistics.segments_sent +
+        Segment_Statistics.segments_received;
+
+    return (uint32_t)(
+        (segments * 1000U) / Segment_Statistics.elapsed_milliseconds);
+}
+
+/**
+ * @brief Clear the segmentation counters
+ */
+void tsm_segment_statistics_clear(void)
+{
+    memset(&Segment_Statistics, 0, sizeof(Segment_Statistics));
+}
+#endif
+
+/**
+ * @brief A transaction failed to get a confirmation. The invoke ID has
+ *  not been cleared yet and this indicates a failed message: IDLE and a
+ *  valid invoke ID.
+ * @param plist - transaction
+ */
+static void tsm_transaction_failed(BACNET_TSM_DATA *plist)
+{
+    BACNET_ADDRESS dest;
+    uint8_t invokeID = plist->InvokeID;
+
+    plist->state = TSM_STATE_IDLE;
+    bacnet_address_copy(&dest, &plist->dest);
+    if (plist->Global && Timeout_Function) {
+        Timeout_Function(invokeID);
+    }
+    if (Peer_Timeout_Function) {
+        Peer_Timeout_Function(&dest, invokeID);
+    }
+}
+
+/**
+ * @brief Handle the expired timer of a transaction
+ * @param plist - transaction
+ */
+static void tsm_transaction_timeout(BACNET_TSM_DATA *plist)
+{
+#if BACNET_SEGMENTATION_ENABLED
+    if (tsm_segment_server_timeout(plist)) {
+        return;
+    }
+    if (tsm_segment_client_timeout(plist)) {
+        tsm_transaction_failed(plist);
+        return;
+    }
+#endif
+    if (plist->state == TSM_STATE_AWAIT_CONFIRMATION) {
+        if (plist->RetryCount < apdu_retries()) {
+            tsm_timer_start(plist, apdu_timeout());
+            plist->RetryCount++;
+#if BACNET_SEGMENTATION_ENABLED
+            if (plist->Segment) {
+                /* a segmented request starts over */
+                plist->state = TSM_STATE_SEGMENTED_REQUEST;
+                (void)tsm_segment_send_start(
+                    plist, plist->SegmentMaxApdu, false);
+                return;
+            }
+#endif
+            datalink_send_pdu(
+                &plist->dest, &plist->npdu_data, &plist->apdu[0],
+                plist->apdu_len);
+        } else {
+#if BACNET_SEGMENTATION_ENABLED
+            tsm_segment_free(plist);
+#endif
+            tsm_transaction_failed(plist);
+        }
+    }
+}
+
 /** Called once a millisecond or slower.
  *  This function calls the handler for a
  *  timeout 'Timeout_Function', if necessary.
+ *  Running timers are kept in a heap ordered by deadline,
+ *  so only the transactions with an expired timer are visited.
  *
  * @param milliseconds - Count of milliseconds passed, since the last call.
  */
 void tsm_timer_milliseconds(uint16_t milliseconds)
 {
-    unsigned i = 0; /* counter */
-
-    BACNET_TSM_DATA *plist = &TSM_List[0];
+    BACNET_TSM_DATA *plist;
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if (plist->state == TSM_STATE_AWAIT_CONFIRMATION) {
-            if (plist->RequestTimer > milliseconds) {
-                plist->RequestTimer -= milliseconds;
-            } else {
-                plist->RequestTimer = 0;
-            }
-            /* AWAIT_CONFIRMATION */
-            if (plist->RequestTimer == 0) {
-                if (plist->RetryCount < apdu_retries()) {
-                    plist->RequestTimer = apdu_timeout();
-                    plist->RetryCount++;
-                    datalink_send_pdu(
-                        &plist->dest, &plist->npdu_data, &plist->apdu[0],
-                        plist->apdu_len);
-                } else {
-                    /* note: the invoke id has not been cleared yet
-                       and this indicates a failed message:
-                       IDLE and a valid invoke id */
-                    plist->state = TSM_STATE_IDLE;
-                    if (plist->InvokeID != 0) {
-                        if (Timeout_Function) {
-                            Timeout_Function(plist->InvokeID);
-                        }
-                    }
-                }
-            }
+    TSM_Milliseconds += milliseconds;
+#if BACNET_SEGMENTATION_ENABLED
+    Segment_Statistics.elapsed_milliseconds += milliseconds;
+#endif
+    while (TSM_Timer_Count > 0) {
+        plist = TSM_Timer_Heap[0];
+        if (tsm_time_before(TSM_Milliseconds, plist->Deadline)) {
+            break;
         }
+        tsm_timer_stop(plist);
+        tsm_transaction_timeout(plist);
     }
 }
 
@@ -338,14 +1780,22 @@ void tsm_timer_milliseconds(uint16_t milliseconds)
  */
 void tsm_free_invoke_id(uint8_t invokeID)
 {
-    uint8_t index;
+    tsm_peer_free_invoke_id(NULL, invokeID);
+}
+
+/**
+ * @brief Frees the invoke ID of a transaction with a peer, when the
+ *  reply comes back, and sets its state to IDLE
+ * @param src - BACnet address of the peer
+ * @param invokeID - invoke ID
+ */
+void tsm_peer_free_invoke_id(const BACNET_ADDRESS *src, uint8_t invokeID)
+{
     BACNET_TSM_DATA *plist;
 
-    index = tsm_find_invokeID_index(invokeID);
-    if (index < MAX_TSM_TRANSACTIONS) {
-        plist = &TSM_List[index];
-        plist->state = TSM_STATE_IDLE;
-        plist->InvokeID = 0;
+    plist = tsm_transaction_find(src, invokeID);
+    if (plist) {
+        tsm_transaction_free(plist);
     }
 }
 
@@ -356,15 +1806,19 @@ void tsm_free_invoke_id(uint8_t invokeID)
  */
 bool tsm_invoke_id_free(uint8_t invokeID)
 {
-    bool status = true;
-    uint8_t index;
-
-    index = tsm_find_invokeID_index(invokeID);
-    if (index < MAX_TSM_TRANSACTIONS) {
-        status = false;
-    }
+    return tsm_peer_invoke_id_free(NULL, invokeID);
+}
 
-    return status;
+/**
+ * @brief Check if the invoke ID of a transaction with a peer has been
+ *  made free by the Transaction State Machine.
+ * @param dest - BACnet address of the peer
+ * @param invokeID - invoke ID, normally of the last message sent
+ * @return True if it is free (done with), False if still pending in the TSM.
+ */
+bool tsm_peer_invoke_id_free(const BACNET_ADDRESS *dest, uint8_t invokeID)
+{
+    return tsm_transaction_find(dest, invokeID) == NULL;
 }
 
 /** See if we failed get a confirmation for the message associated
@@ -375,15 +1829,28 @@ bool tsm_invoke_id_free(uint8_t invokeID)
  *         for a confirmation.
  */
 bool tsm_invoke_id_failed(uint8_t invokeID)
+{
+    return tsm_peer_invoke_id_failed(NULL, invokeID);
+}
+
+/**
+ * @brief See if we failed to get a confirmation for the message sent
+ *  to a peer with this invoke ID.
+ * @param dest - BACnet address of the peer
+ * @param invokeID - invoke ID, normally of the last message sent
+ * @return True if already failed, False if done or segmented or still
+ *  waiting for a confirmation.
+ */
+bool tsm_peer_invoke_id_failed(const BACNET_ADDRESS *dest, uint8_t invokeID)
 {
     bool status = false;
-    uint8_t index;
+    const BACNET_TSM_DATA *plist;
 
-    index = tsm_find_invokeID_index(invokeID);
-    if (index < MAX_TSM_TRANSACTIONS) {
+    plist = tsm_transaction_find(dest, invokeID);
+    if (plist) {
         /* a valid invoke ID and the state is IDLE is a
            message that failed to confirm */
-        if (TSM_List[index].state == TSM_STATE_IDLE) {
+        if (plist->state == TSM_STATE_IDLE) {
             status = true;
         }
     }
@@ -14,6 +14,7 @@
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
+#include "bacnet/apdu.h"
 #include "bacnet/npdu.h"
 
 /* note: TSM functionality is optional - only needed if we are
@@ -25,20 +26,29 @@ extern "C" {
 
 /* FIXME: modify basic service handlers to use TSM rather than this buffer! */
 BACNET_STACK_EXPORT extern uint8_t Handler_Transmit_Buffer[MAX_PDU];
+#if BACNET_SEGMENTATION_ENABLED
+/* unsegmented form of a complex-ack that may be sent segmented */
+BACNET_STACK_EXPORT extern uint8_t Handler_Segmented_Buffer[MAX_ASDU];
+#endif
 
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
 
 #if (!MAX_TSM_TRANSACTIONS)
+#if BACNET_SEGMENTATION_ENABLED
+#error "BACNET_SEGMENTATION_ENABLED requires MAX_TSM_TRANSACTIONS"
+#endif
 #define tsm_free_invoke_id(x) (void)x;
+#define tsm_peer_free_invoke_id(s, x) (void)s, (void)x;
 #else
 typedef enum {
     TSM_STATE_IDLE,
     TSM_STATE_AWAIT_CONFIRMATION,
     TSM_STATE_AWAIT_RESPONSE,
     TSM_STATE_SEGMENTED_REQUEST,
-    TSM_STATE_SEGMENTED_CONFIRMATION
+    TSM_STATE_SEGMENTED_CONFIRMATION,
+    TSM_STATE_SEGMENTED_RESPONSE
 } BACNET_TSM_STATE;
 
 /* 5.4.1 Variables And Parameters */
@@ -47,26 +57,44 @@ typedef enum {
 typedef struct BACnet_TSM_Data {
     /* used to count APDU retries */
     uint8_t RetryCount;
+#if BACNET_SEGMENTATION_ENABLED
     /* used to count segment retries */
-    /*uint8_t SegmentRetryCount;  */
+    uint8_t SegmentRetryCount;
     /* used to control APDU retries and the acceptance of server replies */
-    /*bool SentAllSegments;  */
+    bool SentAllSegments;
     /* stores the sequence number of the last segment received in order */
-    /*uint8_t LastSequenceNumber; */
+    uint8_t LastSequenceNumber;
     /* stores the sequence number of the first segment of */
     /* a sequence of segments that fill a window */
-    /*uint8_t InitialSequenceNumber; */
+    uint8_t InitialSequenceNumber;
     /* stores the current window size */
-    /*uint8_t ActualWindowSize; */
+    uint8_t ActualWindowSize;
     /* stores the window size proposed by the segment sender */
-    /*uint8_t ProposedWindowSize;  */
-    /*  used to perform timeout on PDU segments */
-    /*uint8_t SegmentTimer; */
-    /* used to perform timeout on Confirmed Requests */
-    /* in milliseconds */
-    uint16_t RequestTimer;
-    /* unique id */
+    uint8_t ProposedWindowSize;
+    /* service choice of the segmented message */
+    uint8_t ServiceChoice;
+    /* number of segments in the segmented message being sent */
+    uint16_t SegmentCount;
+    /* maximum APDU length of each segment being sent */
+    uint16_t SegmentMaxApdu;
+    /* confirmed request header of a segmented request */
+    BACNET_CONFIRMED_SERVICE_DATA ServiceData;
+    /* service data being segmented or reassembled, sized per message */
+    uint8_t *Segment;
+    uint32_t SegmentLength;
+    uint32_t SegmentSize;
+#endif
+    /* used to perform timeout on Confirmed Requests and PDU segments: */
+    /* the TSM time in milliseconds when the running timer expires */
+    uint32_t Deadline;
+    /* position in the timer heap plus one, or zero if no timer runs */
+    uint16_t HeapIndex;
+    /* next transaction in the hash chain or free list, as index+1 */
+    uint16_t Next;
+    /* unique id, per peer unless Global */
     uint8_t InvokeID;
+    /* true if the invoke ID is not used with any other peer */
+    bool Global;
     /* state that the TSM is in */
     BACNET_TSM_STATE state;
     /* the address we sent it to */
@@ -79,6 +107,26 @@ typedef struct BACnet_TSM_Data {
 } BACNET_TSM_DATA;
 
 typedef void (*tsm_timeout_function)(uint8_t invoke_id);
+typedef void (*tsm_peer_timeout_function)(
+    const BACNET_ADDRESS *dest, uint8_t invoke_id);
+
+#if BACNET_SEGMENTATION_ENABLED
+/* segmentation counters since the last clear */
+typedef struct BACnet_TSM_Segment_Statistics {
+    uint32_t segments_sent;
+    uint32_t segments_received;
+    uint32_t segments_retransmitted;
+    uint32_t segment_acks_sent;
+    uint32_t segment_acks_received;
+    uint32_t segment_naks_sent;
+    uint32_t transactions_sent;
+    uint32_t transactions_received;
+    uint32_t transactions_aborted;
+    uint32_t transactions_timed_out;
+    /* milliseconds elapsed since the last clear */
+    uint32_t elapsed_milliseconds;
+} BACNET_TSM_SEGMENT_STATISTICS;
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -86,11 +134,13 @@ extern "C" {
 
 BACNET_STACK_EXPORT
 void tsm_set_timeout_handler(tsm_timeout_function pFunction);
+BACNET_STACK_EXPORT
+void tsm_set_peer_timeout_handler(tsm_peer_timeout_function pFunction);
 
 BACNET_STACK_EXPORT
 bool tsm_transaction_available(void);
 BACNET_STACK_EXPORT
-uint8_t tsm_transaction_idle_count(void);
+uint16_t tsm_transaction_idle_count(void);
 BACNET_STACK_EXPORT
 void tsm_timer_milliseconds(uint16_t milliseconds);
 /* free the invoke ID when the reply comes back */
@@ -101,6 +151,15 @@ BACNET_STACK_EXPORT
 uint8_t tsm_next_free_invokeID(void);
 BACNET_STACK_EXPORT
 void tsm_invokeID_set(uint8_t invokeID);
+/* invoke IDs scoped per peer, for many outstanding requests */
+BACNET_STACK_EXPORT
+uint8_t tsm_peer_next_free_invokeID(const BACNET_ADDRESS *dest);
+BACNET_STACK_EXPORT
+void tsm_peer_free_invoke_id(const BACNET_ADDRESS *src, uint8_t invokeID);
+BACNET_STACK_EXPORT
+bool tsm_peer_invoke_id_free(const BACNET_ADDRESS *dest, uint8_t invokeID);
+BACNET_STACK_EXPORT
+bool tsm_peer_invoke_id_failed(const BACNET_ADDRESS *dest, uint8_t invokeID);
 /* returns the same invoke ID that was given */
 BACNET_STACK_EXPORT
 void tsm_set_confirmed_unsegmented_transaction(
@@ -123,6 +182,59 @@ bool tsm_invoke_id_free(uint8_t invokeID);
 BACNET_STACK_EXPORT
 bool tsm_invoke_id_failed(uint8_t invokeID);
 
+#if BACNET_SEGMENTATION_ENABLED
+BACNET_STACK_EXPORT
+int tsm_set_confirmed_segmented_transaction(
+    uint8_t invokeID,
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    const uint8_t *apdu,
+    unsigned apdu_len,
+    unsigned max_apdu);
+BACNET_STACK_EXPORT
+unsigned tsm_segmented_complex_ack_size(
+    const BACNET_CONFIRMED_SERVICE_DATA *service_data);
+BACNET_STACK_EXPORT
+int tsm_segmented_complex_ack_send(
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    const BACNET_CONFIRMED_SERVICE_DATA *service_data,
+    const uint8_t *apdu,
+    unsigned apdu_len);
+BACNET_STACK_EXPORT
+bool tsm_segmented_request_received(
+    const BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_DATA *service_data,
+    uint8_t service_choice,
+    uint8_t **service_request,
+    uint16_t *service_request_len);
+BACNET_STACK_EXPORT
+void tsm_segmented_request_complete(
+    const BACNET_ADDRESS *src, uint8_t invokeID);
+BACNET_STACK_EXPORT
+bool tsm_segmented_complex_ack_received(
+    const BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_ACK_DATA *service_ack_data,
+    uint8_t **service_request,
+    uint16_t *service_request_len);
+BACNET_STACK_EXPORT
+void tsm_segment_ack_received(
+    const BACNET_ADDRESS *src,
+    uint8_t invokeID,
+    uint8_t sequence_number,
+    uint8_t actual_window_size,
+    bool nak,
+    bool server);
+BACNET_STACK_EXPORT
+void tsm_segmented_abort_received(const BACNET_ADDRESS *src, uint8_t invokeID);
+BACNET_STACK_EXPORT
+void tsm_segment_statistics(BACNET_TSM_SEGMENT_STATISTICS *stats);
+BACNET_STACK_EXPORT
+uint32_t tsm_segments_per_second(void);
+BACNET_STACK_EXPORT
+void tsm_segment_statistics_clear(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -176,11 +176,52 @@
 /* for confirmed messages, this is the number of transactions */
 /* that we hold in a queue waiting for timeout. */
 /* Configure to zero if you don't want any confirmed messages */
-/* Configure from 1..255 for number of outstanding confirmed */
-/* requests available. */
+/* Configure from 1..65000 for number of outstanding confirmed */
+/* requests available. Invoke IDs are scoped per peer, so more */
+/* than 255 are useful when polling many devices concurrently. */
 #if !defined(MAX_TSM_TRANSACTIONS)
 #define MAX_TSM_TRANSACTIONS 255
 #endif
+/* Segmentation of confirmed requests and complex acknowledgements
+   (clause 5.2 and 5.4) is handled by the TSM when enabled. */
+#if !defined(BACNET_SEGMENTATION_ENABLED)
+#define BACNET_SEGMENTATION_ENABLED 0
+#endif
+#if BACNET_SEGMENTATION_ENABLED
+/* number of segments we accept or send for one message: 2..255 */
+#if !defined(BACNET_MAX_SEGMENTS_ACCEPTED)
+#define BACNET_MAX_SEGMENTS_ACCEPTED 32
+#endif
+/* window size we propose as segment sender or accept as receiver: 1..127 */
+#if !defined(BACNET_SEGMENTATION_WINDOW_SIZE)
+#define BACNET_SEGMENTATION_WINDOW_SIZE 16
+#endif
+/* number of segmented transactions served concurrently for peers */
+#if !defined(BACNET_SEGMENTATION_SERVER_TRANSACTIONS)
+#define BACNET_SEGMENTATION_SERVER_TRANSACTIONS 4
+#endif
+/* largest application service data unit reassembled or segmented.
+   Service handlers take a 16-bit length, so keep it below 64K. */
+#if !defined(MAX_ASDU)
+#if ((MAX_APDU * BACNET_MAX_SEGMENTS_ACCEPTED) > 65535)
+#define MAX_ASDU 65535
+#else
+#define MAX_ASDU (MAX_APDU * BACNET_MAX_SEGMENTS_ACCEPTED)
+#endif
+#endif
+#endif
+/* Per-service request and reply counters, and histograms of the
+   service handler execution times, are kept by the APDU handler when
+   enabled (see apdu_statistics_confirmed() in h_apdu.h). */
+#if !defined(BACNET_APDU_STATISTICS)
+#define BACNET_APDU_STATISTICS 0
+#endif
+/* COV subscriptions are checked only for the objects that report a
+   change with handler_cov_change_notify() when enabled, rather than by
+   polling every subscription on each pass of the COV task. */
+#if !defined(BACNET_COV_EVENT_DRIVEN)
+#define BACNET_COV_EVENT_DRIVEN 0
+#endif
 /* The address cache is used for binding to BACnet devices */
 /* The number of entries corresponds to the number of */
 /* devices that might respond to an I-Am on the network. */
@@ -189,6 +230,9 @@
 #if !defined(MAX_ADDRESS_CACHE)
 #define MAX_ADDRESS_CACHE 255
 #endif
+/* Define BACNET_ADDRESS_CACHE_HASH to index the address cache by
+   device instance and by BACnet address, with least-recently-used
+   eviction, when MAX_ADDRESS_CACHE is large (thousands of devices). */
 
 /* some modules have debugging enabled using PRINT_ENABLED */
 #if !defined(PRINT_ENABLED)
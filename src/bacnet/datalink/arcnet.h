@@ -51,6 +51,12 @@ uint16_t arcnet_receive(
     uint16_t max_pdu, /* amount of space available in the PDU  */
     unsigned timeout); /* milliseconds to wait for a packet */
 
+/* from the Linux driver */
+BACNET_STACK_EXPORT
+unsigned arcnet_receive_handler(
+    void (*handler)(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len),
+    unsigned timeout);
+
 BACNET_STACK_EXPORT
 void arcnet_get_my_address(BACNET_ADDRESS *my_address);
 BACNET_STACK_EXPORT
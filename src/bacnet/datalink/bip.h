@@ -59,6 +59,12 @@ int bip_send_pdu(
 BACNET_STACK_EXPORT
 int bip_send_mpdu(
     const BACNET_IP_ADDRESS *dest, const uint8_t *mtu, uint16_t mtu_len);
+BACNET_STACK_EXPORT
+int bip_send_mpdu_batch(
+    const BACNET_IP_ADDRESS *dest,
+    unsigned dest_count,
+    const uint8_t *mtu,
+    uint16_t mtu_len);
 
 BACNET_STACK_EXPORT
 uint16_t bip_receive(
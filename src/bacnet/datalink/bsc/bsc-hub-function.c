@@ -56,11 +56,29 @@ typedef enum {
     BSC_HUB_FUNCTION_STATE_STOPPING = 3
 } BSC_HUB_FUNCTION_STATE;
 
+/* The connections are indexed by VMAC and by device UUID in open
+   addressing hash tables that are at most half full, so relaying a
+   unicast does not scan every connection. */
+#define BSC_HUB_FUNCTION_INDEX_SIZE \
+    (2 * BSC_CONF_HUB_FUNCTION_CONNECTIONS_NUM + 1)
+
+typedef struct BSC_Hub_Index_Entry {
+    BSC_SOCKET *sock;
+    uint8_t key[BVLC_SC_UUID_SIZE];
+} BSC_HUB_INDEX_ENTRY;
+
+typedef struct BSC_Hub_Index {
+    size_t key_len;
+    BSC_HUB_INDEX_ENTRY entry[BSC_HUB_FUNCTION_INDEX_SIZE];
+} BSC_HUB_INDEX;
+
 typedef struct BSC_Hub_Connector {
     bool used;
     BSC_SOCKET_CTX ctx;
     BSC_CONTEXT_CFG cfg;
     BSC_SOCKET sock[BSC_CONF_HUB_FUNCTION_CONNECTIONS_NUM];
+    BSC_HUB_INDEX vmac_index;
+    BSC_HUB_INDEX uuid_index;
     BSC_HUB_FUNCTION_STATE state;
     BSC_HUB_EVENT_FUNC event_func;
     void *user_arg;
@@ -103,6 +121,106 @@ static void hub_function_free(BSC_HUB_FUNCTION *p)
     p->used = false;
 }
 
+/**
+ * @brief Get the home slot of a key in a hub function index
+ * @param x - pointer to the index
+ * @param key - pointer to the VMAC or UUID
+ * @return slot of the index
+ */
+static size_t hub_index_slot(const BSC_HUB_INDEX *x, const uint8_t *key)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261UL;
+    size_t i;
+
+    for (i = 0; i < x->key_len; i++) {
+        hash ^= key[i];
+        hash *= 16777619UL;
+    }
+
+    return hash % BSC_HUB_FUNCTION_INDEX_SIZE;
+}
+
+/**
+ * @brief Remove all the connections from a hub function index
+ * @param x - pointer to the index
+ * @param key_len - size of the VMAC or UUID
+ */
+static void hub_index_clear(BSC_HUB_INDEX *x, size_t key_len)
+{
+    memset(x, 0, sizeof(BSC_HUB_INDEX));
+    x->key_len = key_len;
+}
+
+/**
+ * @brief Find the slot of a key in a hub function index
+ * @param x - pointer to the index
+ * @param key - pointer to the VMAC or UUID
+ * @return slot holding the key, or the empty slot where it would go
+ */
+static size_t hub_index_find(const BSC_HUB_INDEX *x, const uint8_t *key)
+{
+    size_t i = hub_index_slot(x, key);
+
+    while (x->entry[i].sock &&
+           memcmp(x->entry[i].key, key, x->key_len) != 0) {
+        i = (i + 1) % BSC_HUB_FUNCTION_INDEX_SIZE;
+    }
+
+    return i;
+}
+
+/**
+ * @brief Add a connection to a hub function index, or replace the
+ *  connection that had the same key
+ * @param x - pointer to the index
+ * @param key - pointer to the VMAC or UUID of the connection
+ * @param c - pointer to the socket
+ */
+static void hub_index_add(BSC_HUB_INDEX *x, const uint8_t *key, BSC_SOCKET *c)
+{
+    size_t i = hub_index_find(x, key);
+
+    /* there is always an empty slot, since each socket has one key */
+    x->entry[i].sock = c;
+    memcpy(x->entry[i].key, key, x->key_len);
+}
+
+/**
+ * @brief Remove a connection from a hub function index, unless another
+ *  connection has taken over its key
+ * @param x - pointer to the index
+ * @param key - pointer to the VMAC or UUID of the connection
+ * @param c - pointer to the socket
+ */
+static void
+hub_index_remove(BSC_HUB_INDEX *x, const uint8_t *key, const BSC_SOCKET *c)
+{
+    size_t i, j, k;
+
+    i = hub_index_find(x, key);
+    if (x->entry[i].sock != c) {
+        return;
+    }
+    /* shift back the following entries of the probe sequence so that
+       no tombstone is needed */
+    j = i;
+    for (;;) {
+        j = (j + 1) % BSC_HUB_FUNCTION_INDEX_SIZE;
+        if (!x->entry[j].sock) {
+            break;
+        }
+        k = hub_index_slot(x, x->entry[j].key);
+        if ((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j))) {
+            /* home slot is between the hole and the entry */
+            continue;
+        }
+        x->entry[i] = x->entry[j];
+        i = j;
+    }
+    x->entry[i].sock = NULL;
+}
+
 /**
  * @brief find a hub function connection for a specific VMAC address
  * @param vmac - pointer to the VMAC address
@@ -112,28 +230,18 @@ static void hub_function_free(BSC_HUB_FUNCTION *p)
 static BSC_SOCKET *hub_function_find_connection_for_vmac(
     BACNET_SC_VMAC_ADDRESS *vmac, void *user_arg)
 {
-    int i;
+    BSC_SOCKET *c;
     BSC_HUB_FUNCTION *f;
 
     bws_dispatch_lock();
     f = (BSC_HUB_FUNCTION *)user_arg;
-    DEBUG_PRINTF(
-        "hubf = %p local_vmac = %s\n", f,
-        bsc_vmac_to_string(&f->cfg.local_vmac));
-    for (i = 0; i < sizeof(f->sock) / sizeof(BSC_SOCKET); i++) {
-        DEBUG_PRINTF(
-            "hubf = %p, sock %p, state = %d, vmac = %s\n", f, &f->sock[i],
-            f->sock[i].state, bsc_vmac_to_string(&f->sock[i].vmac));
-        if (f->sock[i].state != BSC_SOCK_STATE_IDLE &&
-            !memcmp(
-                &vmac->address[0], &f->sock[i].vmac.address[0],
-                sizeof(vmac->address))) {
-            bws_dispatch_unlock();
-            return &f->sock[i];
-        }
+    c = f->vmac_index.entry[hub_index_find(&f->vmac_index, vmac->address)]
+            .sock;
+    if (c && (c->state == BSC_SOCK_STATE_IDLE)) {
+        c = NULL;
     }
     bws_dispatch_unlock();
-    return NULL;
+    return c;
 }
 
 /**
@@ -145,25 +253,17 @@ static BSC_SOCKET *hub_function_find_connection_for_vmac(
 static BSC_SOCKET *
 hub_function_find_connection_for_uuid(BACNET_SC_UUID *uuid, void *user_arg)
 {
-    int i;
+    BSC_SOCKET *c;
     BSC_HUB_FUNCTION *f;
 
     bws_dispatch_lock();
     f = (BSC_HUB_FUNCTION *)user_arg;
-    for (i = 0; i < sizeof(f->sock) / sizeof(BSC_SOCKET); i++) {
-        DEBUG_PRINTF(
-            "hubf = %p, sock %p, state = %d, uuid = %s\n", f, &f->sock[i],
-            f->sock[i].state, bsc_uuid_to_string(&f->sock[i].uuid));
-        if (f->sock[i].state != BSC_SOCK_STATE_IDLE &&
-            !memcmp(
-                &uuid->uuid[0], &f->sock[i].uuid.uuid[0], sizeof(uuid->uuid))) {
-            bws_dispatch_unlock();
-            DEBUG_PRINTF("found socket\n");
-            return &f->sock[i];
-        }
+    c = f->uuid_index.entry[hub_index_find(&f->uuid_index, uuid->uuid)].sock;
+    if (c && (c->state == BSC_SOCK_STATE_IDLE)) {
+        c = NULL;
     }
     bws_dispatch_unlock();
-    return NULL;
+    return c;
 }
 
 /**
@@ -348,6 +448,8 @@ static void hub_function_socket_event(
             }
         }
     } else if (ev == BSC_SOCKET_EVENT_DISCONNECTED) {
+        hub_index_remove(&f->vmac_index, c->vmac.address, c);
+        hub_index_remove(&f->uuid_index, c->uuid.uuid, c);
         hub_function_update_status(f, c, ev, reason, reason_desc);
         if (reason == ERROR_CODE_NODE_DUPLICATE_VMAC) {
             f->event_func(
@@ -355,6 +457,10 @@ static void hub_function_socket_event(
                 (BSC_HUB_FUNCTION_HANDLE)f, f->user_arg);
         }
     } else if (ev == BSC_SOCKET_EVENT_CONNECTED) {
+        /* a connection from a known UUID takes over from the existing
+           connection, which is disconnected */
+        hub_index_add(&f->vmac_index, c->vmac.address, c);
+        hub_index_add(&f->uuid_index, c->uuid.uuid, c);
         hub_function_update_status(f, c, ev, reason, reason_desc);
     }
     bws_dispatch_unlock();
@@ -376,6 +482,9 @@ static void hub_function_context_event(BSC_SOCKET_CTX *ctx, BSC_CTX_EVENT ev)
         f->event_func(
             BSC_HUBF_EVENT_STARTED, (BSC_HUB_FUNCTION_HANDLE)f, f->user_arg);
     } else if (ev == BSC_CTX_DEINITIALIZED) {
+        /* the sockets were set to idle without disconnect events */
+        hub_index_clear(&f->vmac_index, BVLC_SC_VMAC_SIZE);
+        hub_index_clear(&f->uuid_index, BVLC_SC_UUID_SIZE);
         f->state = BSC_HUB_FUNCTION_STATE_IDLE;
         hub_function_free(f);
         f->event_func(
@@ -453,6 +562,8 @@ BSC_SC_RET bsc_hub_function_start(
 
     f->user_arg = user_arg;
     f->event_func = event_func;
+    hub_index_clear(&f->vmac_index, BVLC_SC_VMAC_SIZE);
+    hub_index_clear(&f->uuid_index, BVLC_SC_UUID_SIZE);
 
     bsc_init_ctx_cfg(
         BSC_SOCKET_CTX_ACCEPTOR, &f->cfg, BSC_WEBSOCKET_HUB_PROTOCOL, port,
@@ -82,6 +82,10 @@ size_t cobs_frame_decode(
 BACNET_STACK_EXPORT
 uint32_t cobs_crc32k(uint8_t dataValue, uint32_t crc);
 
+BACNET_STACK_EXPORT
+uint32_t
+cobs_crc32k_buffer(const uint8_t *buffer, size_t length, uint32_t crc);
+
 BACNET_STACK_EXPORT
 size_t cobs_crc32k_encode(uint8_t *buffer, size_t buffer_size, uint32_t crc);
 
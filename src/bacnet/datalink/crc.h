@@ -15,6 +15,13 @@
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 
+/* number of octets that the buffer CRC functions process at a time,
+   using one lookup table for each octet: 1, 4, or 8. The CRC-16 tables
+   use 512 bytes each, and the CRC-32K tables use 1K each. */
+#ifndef CRC_SLICE_BY
+#define CRC_SLICE_BY 8
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -23,6 +30,12 @@ BACNET_STACK_EXPORT
 uint8_t CRC_Calc_Header(uint8_t dataValue, uint8_t crcValue);
 BACNET_STACK_EXPORT
 uint16_t CRC_Calc_Data(uint8_t dataValue, uint16_t crcValue);
+BACNET_STACK_EXPORT
+uint8_t CRC_Calc_Header_Buffer(
+    const uint8_t *buffer, size_t length, uint8_t crcValue);
+BACNET_STACK_EXPORT
+uint16_t CRC_Calc_Data_Buffer(
+    const uint8_t *buffer, size_t length, uint16_t crcValue);
 
 #ifdef __cplusplus
 }
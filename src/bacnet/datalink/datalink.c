@@ -7,6 +7,7 @@
  * @defgroup DataLink DataLink Network Layer
  * @ingroup DataLink
  */
+#include <string.h>
 #include "bacnet/datalink/datalink.h"
 #include "bacnet/bacstr.h"
 #if defined(BACDL_MULTIPLE) || defined FOR_DOXYGEN
@@ -33,51 +34,74 @@
 #include "bacnet/datalink/bsc/bsc-datalink.h"
 #endif
 
-static enum {
+typedef enum {
     DATALINK_NONE = 0,
     DATALINK_ARCNET,
     DATALINK_ETHERNET,
     DATALINK_BIP,
     DATALINK_BIP6,
     DATALINK_MSTP,
-    DATALINK_BSC
-} Datalink_Transport;
+    DATALINK_BSC,
+    DATALINK_MAX
+} DATALINK_TRANSPORT;
 
-void datalink_set(char *datalink_string)
+static DATALINK_TRANSPORT Datalink_Transport;
+#if BACNET_APDU_STATISTICS
+static BACNET_DATALINK_STATISTICS Datalink_Statistics[DATALINK_MAX];
+#endif
+
+/**
+ * @brief Find the datalink transport by its name
+ * @param datalink_string - name of the datalink, such as "bip"
+ * @param transport - the transport that was found
+ * @return true if the datalink is known in this build
+ */
+static bool
+datalink_transport(const char *datalink_string, DATALINK_TRANSPORT *transport)
 {
     if (bacnet_stricmp("none", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_NONE;
+        *transport = DATALINK_NONE;
     }
 #if defined(BACDL_BIP)
     else if (bacnet_stricmp("bip", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_BIP;
+        *transport = DATALINK_BIP;
     }
 #endif
 #if defined(BACDL_BIP6)
     else if (bacnet_stricmp("bip6", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_BIP6;
+        *transport = DATALINK_BIP6;
     }
 #endif
 #if defined(BACDL_ETHERNET)
     else if (bacnet_stricmp("ethernet", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_ETHERNET;
+        *transport = DATALINK_ETHERNET;
     }
 #endif
 #if defined(BACDL_ARCNET)
     else if (bacnet_stricmp("arcnet", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_ARCNET;
+        *transport = DATALINK_ARCNET;
     }
 #endif
 #if defined(BACDL_MSTP)
     else if (bacnet_stricmp("mstp", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_MSTP;
+        *transport = DATALINK_MSTP;
     }
 #endif
 #if defined(BACDL_BSC)
     else if (bacnet_stricmp("bsc", datalink_string) == 0) {
-        Datalink_Transport = DATALINK_BSC;
+        *transport = DATALINK_BSC;
     }
 #endif
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+void datalink_set(char *datalink_string)
+{
+    datalink_transport(datalink_string, &Datalink_Transport);
 }
 
 bool datalink_init(char *ifname)
@@ -170,6 +194,15 @@ int datalink_send_pdu(
         default:
             break;
     }
+#if BACNET_APDU_STATISTICS
+    if (bytes > 0) {
+        Datalink_Statistics[Datalink_Transport].transmit_pdu_counter++;
+        Datalink_Statistics[Datalink_Transport].transmit_octet_counter +=
+            (uint32_t)bytes;
+    } else {
+        Datalink_Statistics[Datalink_Transport].transmit_error_counter++;
+    }
+#endif
 
     return bytes;
 }
@@ -215,10 +248,87 @@ uint16_t datalink_receive(
         default:
             break;
     }
+#if BACNET_APDU_STATISTICS
+    if (bytes > 0) {
+        Datalink_Statistics[Datalink_Transport].receive_pdu_counter++;
+        Datalink_Statistics[Datalink_Transport].receive_octet_counter += bytes;
+    }
+#endif
 
     return bytes;
 }
 
+#if BACNET_APDU_STATISTICS
+/* the handler given to datalink_receive_handler() */
+static void (*Datalink_Receive_Handler)(
+    BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len);
+
+/**
+ * @brief Count an NPDU that a datalink gives to the handler without
+ *  datalink_receive(), and pass it on
+ * @param src - source address of the NPDU
+ * @param pdu - the NPDU
+ * @param pdu_len - number of octets in the NPDU
+ */
+static void
+datalink_receive_counter(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len)
+{
+    Datalink_Statistics[Datalink_Transport].receive_pdu_counter++;
+    Datalink_Statistics[Datalink_Transport].receive_octet_counter += pdu_len;
+    Datalink_Receive_Handler(src, pdu, pdu_len);
+}
+#endif
+
+/**
+ * @brief Receive NPDUs and give each one to a handler, such as
+ *  npdu_handler(). Ethernet and ARCNET give the handler the NPDU where
+ *  the frame was received; the other datalinks receive one NPDU into
+ *  a buffer with datalink_receive().
+ * @param handler - function that is given the source address and NPDU
+ * @param timeout - number of milliseconds to wait for an NPDU
+ * @return number of NPDUs given to the handler
+ */
+unsigned datalink_receive_handler(
+    void (*handler)(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len),
+    unsigned timeout)
+{
+    static uint8_t pdu[MAX_MPDU];
+    BACNET_ADDRESS src = { 0 };
+    uint16_t pdu_len = 0;
+#if defined(BACDL_ARCNET) || defined(BACDL_ETHERNET)
+    void (*counted)(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len) =
+        handler;
+#endif
+
+    if (!handler) {
+        return 0;
+    }
+#if (defined(BACDL_ARCNET) || defined(BACDL_ETHERNET)) && \
+    BACNET_APDU_STATISTICS
+    Datalink_Receive_Handler = handler;
+    counted = datalink_receive_counter;
+#endif
+    switch (Datalink_Transport) {
+#if defined(BACDL_ARCNET)
+        case DATALINK_ARCNET:
+            return arcnet_receive_handler(counted, timeout);
+#endif
+#if defined(BACDL_ETHERNET)
+        case DATALINK_ETHERNET:
+            return ethernet_receive_handler(counted, timeout);
+#endif
+        default:
+            break;
+    }
+    pdu_len = datalink_receive(&src, pdu, sizeof(pdu), timeout);
+    if (pdu_len > 0) {
+        handler(&src, pdu, pdu_len);
+        return 1;
+    }
+
+    return 0;
+}
+
 void datalink_cleanup(void)
 {
     switch (Datalink_Transport) {
@@ -416,6 +526,35 @@ void datalink_maintenance_timer(uint16_t seconds)
             break;
     }
 }
+
+#if BACNET_APDU_STATISTICS
+/**
+ * @brief Get the counters of a datalink since the last clear
+ * @param datalink_string - name of the datalink, such as "bip"
+ * @param stats - counters are copied here
+ * @return true if the datalink is known in this build
+ */
+bool datalink_statistics(
+    const char *datalink_string, BACNET_DATALINK_STATISTICS *stats)
+{
+    DATALINK_TRANSPORT transport;
+
+    if (!stats || !datalink_transport(datalink_string, &transport)) {
+        return false;
+    }
+    *stats = Datalink_Statistics[transport];
+
+    return true;
+}
+
+/**
+ * @brief Clear the counters of all of the datalinks
+ */
+void datalink_statistics_clear(void)
+{
+    memset(Datalink_Statistics, 0, sizeof(Datalink_Statistics));
+}
+#endif
 #endif
 
 #if defined(BACDL_NONE)
@@ -451,6 +590,16 @@ uint16_t datalink_receive(
     return 0;
 }
 
+unsigned datalink_receive_handler(
+    void (*handler)(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len),
+    unsigned timeout)
+{
+    (void)handler;
+    (void)timeout;
+
+    return 0;
+}
+
 void datalink_cleanup(void)
 {
 }
@@ -479,4 +628,19 @@ void datalink_maintenance_timer(uint16_t seconds)
 {
     (void)seconds;
 }
+
+#if BACNET_APDU_STATISTICS
+bool datalink_statistics(
+    const char *datalink_string, BACNET_DATALINK_STATISTICS *stats)
+{
+    (void)datalink_string;
+    (void)stats;
+
+    return false;
+}
+
+void datalink_statistics_clear(void)
+{
+}
+#endif
 #endif
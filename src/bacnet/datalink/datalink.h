@@ -43,6 +43,7 @@
 #define datalink_init ethernet_init
 #define datalink_send_pdu ethernet_send_pdu
 #define datalink_receive ethernet_receive
+#define datalink_receive_handler ethernet_receive_handler
 #define datalink_cleanup ethernet_cleanup
 #define datalink_get_broadcast_address ethernet_get_broadcast_address
 #define datalink_get_my_address ethernet_get_my_address
@@ -54,6 +55,7 @@
 #define datalink_init arcnet_init
 #define datalink_send_pdu arcnet_send_pdu
 #define datalink_receive arcnet_receive
+#define datalink_receive_handler arcnet_receive_handler
 #define datalink_cleanup arcnet_cleanup
 #define datalink_get_broadcast_address arcnet_get_broadcast_address
 #define datalink_get_my_address arcnet_get_my_address
@@ -121,6 +123,18 @@ void routed_get_my_address(BACNET_ADDRESS *my_address);
 #define MAX_HEADER (8)
 #define MAX_MPDU (MAX_HEADER + MAX_PDU)
 
+#if BACNET_APDU_STATISTICS
+/* counters of one datalink since the last clear */
+typedef struct BACnet_Datalink_Statistics {
+    uint32_t receive_pdu_counter;
+    uint32_t receive_octet_counter;
+    uint32_t transmit_pdu_counter;
+    uint32_t transmit_octet_counter;
+    /* PDUs that the datalink failed to send */
+    uint32_t transmit_error_counter;
+} BACNET_DATALINK_STATISTICS;
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -139,6 +153,11 @@ BACNET_STACK_EXPORT
 uint16_t datalink_receive(
     BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu, unsigned timeout);
 
+BACNET_STACK_EXPORT
+unsigned datalink_receive_handler(
+    void (*handler)(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len),
+    unsigned timeout);
+
 BACNET_STACK_EXPORT
 void datalink_cleanup(void);
 
@@ -157,6 +176,15 @@ void datalink_set(char *datalink_string);
 BACNET_STACK_EXPORT
 void datalink_maintenance_timer(uint16_t seconds);
 
+#if BACNET_APDU_STATISTICS
+BACNET_STACK_EXPORT
+bool datalink_statistics(
+    const char *datalink_string, BACNET_DATALINK_STATISTICS *stats);
+
+BACNET_STACK_EXPORT
+void datalink_statistics_clear(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
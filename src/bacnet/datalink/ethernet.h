@@ -64,6 +64,10 @@ BACNET_STACK_EXPORT
 void ethernet_debug_address(const char *info, const BACNET_ADDRESS *dest);
 BACNET_STACK_EXPORT
 int ethernet_send(uint8_t *mtu, int mtu_len);
+BACNET_STACK_EXPORT
+unsigned ethernet_receive_handler(
+    void (*handler)(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len),
+    unsigned timeout);
 
 #ifdef __cplusplus
 }
@@ -218,10 +218,10 @@ uint16_t MSTP_Create_Frame(
         if ((8 + data_len + 2) > buffer_size) {
             return 0;
         }
-        for (index = 8; index < (data_len + 8); index++, data++) {
-            buffer[index] = *data;
-            crc16 = CRC_Calc_Data(buffer[index], crc16);
-        }
+        /* the data may already be in place in the buffer */
+        memmove(&buffer[8], data, data_len);
+        crc16 = CRC_Calc_Data_Buffer(&buffer[8], data_len, crc16);
+        index = 8 + data_len;
         crc16 = ~crc16;
         buffer[index] = crc16 & 0xFF; /* LSB first */
         buffer[index + 1] = crc16 >> 8;
@@ -229,15 +229,11 @@ uint16_t MSTP_Create_Frame(
     buffer[0] = 0x55;
     buffer[1] = 0xFF;
     buffer[2] = frame_type;
-    crc8 = CRC_Calc_Header(buffer[2], crc8);
     buffer[3] = destination;
-    crc8 = CRC_Calc_Header(buffer[3], crc8);
     buffer[4] = source;
-    crc8 = CRC_Calc_Header(buffer[4], crc8);
     buffer[5] = data_len >> 8; /* MSB first */
-    crc8 = CRC_Calc_Header(buffer[5], crc8);
     buffer[6] = data_len & 0xFF;
-    crc8 = CRC_Calc_Header(buffer[6], crc8);
+    crc8 = CRC_Calc_Header_Buffer(&buffer[2], 5, crc8);
     buffer[7] = ~crc8;
     index = 8;
     if (data_len > 0) {
@@ -525,8 +521,13 @@ void MSTP_Receive_Frame_FSM(struct mstp_port_struct_t *mstp_port)
                 printf_receive_data("%02X ", mstp_port->DataRegister);
                 if (mstp_port->Index < mstp_port->DataLength) {
                     /* DataOctet */
-                    mstp_port->DataCRC = CRC_Calc_Data(
-                        mstp_port->DataRegister, mstp_port->DataCRC);
+                    if (mstp_port->receive_state ==
+                        MSTP_RECEIVE_STATE_SKIP_DATA) {
+                        /* the DATA state CRC is calculated from the
+                           input buffer after the last octet */
+                        mstp_port->DataCRC = CRC_Calc_Data(
+                            mstp_port->DataRegister, mstp_port->DataCRC);
+                    }
                     if (mstp_port->Index < mstp_port->InputBufferSize) {
                         mstp_port->InputBuffer[mstp_port->Index] =
                             mstp_port->DataRegister;
@@ -535,8 +536,11 @@ void MSTP_Receive_Frame_FSM(struct mstp_port_struct_t *mstp_port)
                     /* SKIP_DATA or DATA - no change in state */
                 } else if (mstp_port->Index == mstp_port->DataLength) {
                     /* CRC1 */
-                    mstp_port->DataCRC = CRC_Calc_Data(
-                        mstp_port->DataRegister, mstp_port->DataCRC);
+                    if (mstp_port->receive_state ==
+                        MSTP_RECEIVE_STATE_SKIP_DATA) {
+                        mstp_port->DataCRC = CRC_Calc_Data(
+                            mstp_port->DataRegister, mstp_port->DataCRC);
+                    }
                     mstp_port->DataCRCActualMSB = mstp_port->DataRegister;
                     if (mstp_port->Index < mstp_port->InputBufferSize) {
                         mstp_port->InputBuffer[mstp_port->Index] =
@@ -550,9 +554,12 @@ void MSTP_Receive_Frame_FSM(struct mstp_port_struct_t *mstp_port)
                         mstp_port->InputBuffer[mstp_port->Index] =
                             mstp_port->DataRegister;
                     }
-                    mstp_port->DataCRC = CRC_Calc_Data(
-                        mstp_port->DataRegister, mstp_port->DataCRC);
                     mstp_port->DataCRCActualLSB = mstp_port->DataRegister;
+                    if (mstp_port->receive_state ==
+                        MSTP_RECEIVE_STATE_SKIP_DATA) {
+                        mstp_port->DataCRC = CRC_Calc_Data(
+                            mstp_port->DataRegister, mstp_port->DataCRC);
+                    }
                     printf_receive_data(
                         "%s",
                         mstptext_frame_type((unsigned)mstp_port->FrameType));
@@ -573,6 +580,19 @@ void MSTP_Receive_Frame_FSM(struct mstp_port_struct_t *mstp_port)
                             mstp_port->ReceivedInvalidFrame = true;
                         }
                     } else {
+                        if (mstp_port->receive_state ==
+                            MSTP_RECEIVE_STATE_DATA) {
+                            /* all of the data octets are in the buffer */
+                            mstp_port->DataCRC = CRC_Calc_Data_Buffer(
+                                mstp_port->InputBuffer, mstp_port->DataLength,
+                                mstp_port->DataCRC);
+                            mstp_port->DataCRC = CRC_Calc_Data(
+                                mstp_port->DataCRCActualMSB,
+                                mstp_port->DataCRC);
+                            mstp_port->DataCRC = CRC_Calc_Data(
+                                mstp_port->DataCRCActualLSB,
+                                mstp_port->DataCRC);
+                        }
                         /* STATE DATA CRC - no need for new state */
                         if (mstp_port->DataCRC == 0xF0B8) {
                             if (mstp_port->receive_state ==
@@ -74,6 +74,104 @@ bool indtext_by_istring(
     return found;
 }
 
+/**
+ * @brief Find the first of the sorted positions whose string is equal to
+ *  the search string, case insensitive
+ * @param sorted_list - list of strings and indices, and sorted positions
+ * @param search_name - string to search for
+ * @return first sorted position that is equal, or the count if none
+ */
+static unsigned indtext_sorted_lower_bound(
+    INDTEXT_SORTED *sorted_list, const char *search_name)
+{
+    unsigned low = 0, high = sorted_list->count, middle;
+    const char *pString;
+
+    while (low < high) {
+        middle = low + ((high - low) / 2);
+        pString = sorted_list->data_list[sorted_list->sorted[middle]].pString;
+        if (bacnet_stricmp(pString, search_name) < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if ((low < sorted_list->count) &&
+        (bacnet_stricmp(
+             sorted_list->data_list[sorted_list->sorted[low]].pString,
+             search_name) != 0)) {
+        low = sorted_list->count;
+    }
+
+    return low;
+}
+
+/**
+ * @brief Search a sorted list of strings to find a matching string.
+ *  Finds the same string as indtext_by_string() of the list.
+ * @param sorted_list - list of strings and indices, and sorted positions
+ * @param search_name - string to search for
+ * @param found_index - index of the string found
+ * @return true if the string is found
+ */
+bool indtext_sorted_by_string(
+    INDTEXT_SORTED *sorted_list,
+    const char *search_name,
+    unsigned *found_index)
+{
+    INDTEXT_DATA *data;
+    unsigned i;
+
+    if (!sorted_list || !search_name) {
+        return false;
+    }
+    /* strings equal but for case are sorted by position in the list */
+    for (i = indtext_sorted_lower_bound(sorted_list, search_name);
+         i < sorted_list->count; i++) {
+        data = &sorted_list->data_list[sorted_list->sorted[i]];
+        if (bacnet_stricmp(data->pString, search_name) != 0) {
+            break;
+        }
+        if (strcmp(data->pString, search_name) == 0) {
+            if (found_index) {
+                *found_index = data->index;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Search a sorted list of strings to find a matching string, case
+ *  insensitive. Finds the same string as indtext_by_istring() of the list.
+ * @param sorted_list - list of strings and indices, and sorted positions
+ * @param search_name - string to search for
+ * @param found_index - index of the string found
+ * @return true if the string is found
+ */
+bool indtext_sorted_by_istring(
+    INDTEXT_SORTED *sorted_list,
+    const char *search_name,
+    unsigned *found_index)
+{
+    unsigned i;
+
+    if (!sorted_list || !search_name) {
+        return false;
+    }
+    i = indtext_sorted_lower_bound(sorted_list, search_name);
+    if (i == sorted_list->count) {
+        return false;
+    }
+    if (found_index) {
+        *found_index = sorted_list->data_list[sorted_list->sorted[i]].index;
+    }
+
+    return true;
+}
+
 /**
  * @brief Search a list of strings to find a matching string,
  * or return a default index
@@ -20,6 +20,15 @@ typedef const struct {
     const char *pString; /* text pair - use NULL to end the list */
 } INDTEXT_DATA;
 
+/* index and text pairs, with the positions of the pairs sorted by text,
+   case insensitive, to search by text. Generated by
+   tools/indtext-index/indtext-index.py from the pairs. */
+typedef const struct {
+    INDTEXT_DATA *data_list;
+    const uint16_t *sorted;
+    const unsigned count;
+} INDTEXT_SORTED;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -66,6 +75,18 @@ const char *indtext_by_index_split_default(
     const char *before_split_default_name,
     const char *default_name);
 
+/* binary search versions, using the sorted positions of the pairs */
+BACNET_STACK_EXPORT
+bool indtext_sorted_by_string(
+    INDTEXT_SORTED *sorted_list,
+    const char *search_name,
+    unsigned *found_index);
+BACNET_STACK_EXPORT
+bool indtext_sorted_by_istring(
+    INDTEXT_SORTED *sorted_list,
+    const char *search_name,
+    unsigned *found_index);
+
 /* returns the number of elements in the list */
 BACNET_STACK_EXPORT
 unsigned indtext_count(INDTEXT_DATA *data_list);
@@ -187,7 +187,14 @@ int rr_encode_apdu(
 
     if (apdu) {
         apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+#if BACNET_SEGMENTATION_ENABLED
+        /* segmented-response-accepted */
+        apdu[0] |= BIT(1);
+        apdu[1] =
+            encode_max_segs_max_apdu(BACNET_MAX_SEGMENTS_ACCEPTED, MAX_APDU);
+#else
         apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+#endif
         apdu[2] = invoke_id;
         apdu[3] = SERVICE_CONFIRMED_READ_RANGE; /* service choice */
     }
@@ -103,7 +103,14 @@ int rp_encode_apdu(
 
     if (apdu) {
         apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+#if BACNET_SEGMENTATION_ENABLED
+        /* segmented-response-accepted */
+        apdu[0] |= BIT(1);
+        apdu[1] =
+            encode_max_segs_max_apdu(BACNET_MAX_SEGMENTS_ACCEPTED, MAX_APDU);
+#else
         apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+#endif
         apdu[2] = invoke_id;
         apdu[3] = SERVICE_CONFIRMED_READ_PROPERTY; /* service choice */
     }
@@ -344,19 +351,15 @@ int rp_ack_encode_apdu_init(
 /** Encode the closing tag for the object property.
  *  Note: Encode the application tagged data yourself.
  *
- * @param apdu  Pointer to the buffer for encoding.
- * @param invoke_id  Invoke Id
- * @param rpdata  Pointer to the property data to be encoded.
+ * @param apdu  Pointer to the buffer for encoding, or NULL for length
  *
- * @return Bytes encoded or zero on error.
+ * @return Bytes encoded
  */
 int rp_ack_encode_apdu_object_property_end(uint8_t *apdu)
 {
     int apdu_len = 0; /* total length of the apdu, return value */
 
-    if (apdu) {
-        apdu_len = encode_closing_tag(&apdu[0], 3);
-    }
+    apdu_len = encode_closing_tag(apdu, 3);
 
     return apdu_len;
 }
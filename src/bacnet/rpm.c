@@ -8,6 +8,7 @@
  * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
  */
 #include <stdint.h>
+#include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
@@ -31,7 +32,14 @@ int rpm_encode_apdu_init(uint8_t *apdu, uint8_t invoke_id)
 {
     if (apdu) {
         apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+#if BACNET_SEGMENTATION_ENABLED
+        /* segmented-response-accepted */
+        apdu[0] |= BIT(1);
+        apdu[1] =
+            encode_max_segs_max_apdu(BACNET_MAX_SEGMENTS_ACCEPTED, MAX_APDU);
+#else
         apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+#endif
         apdu[2] = invoke_id;
         apdu[3] = SERVICE_CONFIRMED_READ_PROP_MULTIPLE; /* service choice */
     }
@@ -690,17 +698,10 @@ void rpm_ack_object_property_process(
         apdu += len;
         while (apdu_len) {
             if (bacnet_is_closing_tag_number(apdu, apdu_len, 1, &len)) {
-                /*  end of list-of-results [1] SEQUENCE OF SEQUENCE */
+                /*  end of list-of-results [1] SEQUENCE OF SEQUENCE,
+                    which may be followed by the next object */
                 apdu_len -= len;
-                if (apdu_len > 0) {
-                    /* malformed */
-                    rp_data->error_class = ERROR_CLASS_SERVICES;
-                    rp_data->error_code = ERROR_CODE_INVALID_TAG;
-                    if (callback) {
-                        callback(device_id, rp_data);
-                    }
-                    return;
-                }
+                apdu += len;
                 break;
             }
             len = rpm_ack_decode_object_property(
@@ -808,3 +809,141 @@ void rpm_ack_object_property_process(
     }
 }
 #endif
+
+/**
+ * @brief Decode a ReadPropertyMultiple-ACK into lists of objects, results,
+ *  and compact values that are all given out by an arena, so that no
+ *  memory is allocated and the whole reply is released with the arena.
+ *  Strings and constructed data point into the APDU, which has to be
+ *  kept while the values are used.
+ * @param apdu [in] Buffer of bytes received.
+ * @param apdu_len [in] Count of valid bytes in the buffer.
+ * @param arena [in] The arena that gives out the lists
+ * @param read_access [out] The first object of the reply
+ * @return number of bytes decoded, or BACNET_STATUS_ERROR if malformed,
+ *  or BACNET_STATUS_ABORT if the arena is used up
+ */
+int rpm_ack_decode_compact(
+    const uint8_t *apdu,
+    unsigned apdu_len,
+    BACNET_APPLICATION_DATA_ARENA *arena,
+    BACNET_READ_ACCESS_COMPACT **read_access)
+{
+    BACNET_READ_ACCESS_COMPACT *object, *object_last = NULL;
+    BACNET_PROPERTY_REFERENCE_COMPACT *property, *property_last;
+    uint32_t error_value = 0;
+    int decoded_len = 0;
+    int data_len;
+    int len = 0;
+
+    if (!apdu || !read_access) {
+        return BACNET_STATUS_ERROR;
+    }
+    *read_access = NULL;
+    while (apdu_len) {
+        object = bacapp_arena_alloc(arena, sizeof(BACNET_READ_ACCESS_COMPACT));
+        if (!object) {
+            return BACNET_STATUS_ABORT;
+        }
+        memset(object, 0, sizeof(BACNET_READ_ACCESS_COMPACT));
+        len = rpm_ack_decode_object_id(
+            apdu, apdu_len, &object->object_type, &object->object_instance);
+        if (len <= 0) {
+            return BACNET_STATUS_ERROR;
+        }
+        decoded_len += len;
+        apdu_len -= len;
+        apdu += len;
+        if (object_last) {
+            object_last->next = object;
+        } else {
+            *read_access = object;
+        }
+        object_last = object;
+        property_last = NULL;
+        while (apdu_len) {
+            if (bacnet_is_closing_tag_number(apdu, apdu_len, 1, &len)) {
+                decoded_len += len;
+                apdu_len -= len;
+                apdu += len;
+                break;
+            }
+            property = bacapp_arena_alloc(
+                arena, sizeof(BACNET_PROPERTY_REFERENCE_COMPACT));
+            if (!property) {
+                return BACNET_STATUS_ABORT;
+            }
+            memset(property, 0, sizeof(BACNET_PROPERTY_REFERENCE_COMPACT));
+            len = rpm_ack_decode_object_property(
+                apdu, apdu_len, &property->propertyIdentifier,
+                &property->propertyArrayIndex);
+            if (len <= 0) {
+                return BACNET_STATUS_ERROR;
+            }
+            decoded_len += len;
+            apdu_len -= len;
+            apdu += len;
+            if (bacnet_is_opening_tag_number(apdu, apdu_len, 4, &len)) {
+                data_len = bacnet_enclosed_data_length(apdu, apdu_len);
+                if (data_len < 0) {
+                    return BACNET_STATUS_ERROR;
+                }
+                decoded_len += len;
+                apdu_len -= len;
+                apdu += len;
+                data_len = bacapp_decode_compact_list(
+                    apdu, (uint32_t)data_len, arena, &property->value);
+                if (data_len < 0) {
+                    return data_len;
+                }
+                decoded_len += data_len;
+                apdu_len -= data_len;
+                apdu += data_len;
+                if (!bacnet_is_closing_tag_number(apdu, apdu_len, 4, &len)) {
+                    return BACNET_STATUS_ERROR;
+                }
+                property->error.error_class = ERROR_CLASS_PROPERTY;
+                property->error.error_code = ERROR_CODE_SUCCESS;
+            } else if (bacnet_is_opening_tag_number(apdu, apdu_len, 5, &len)) {
+                decoded_len += len;
+                apdu_len -= len;
+                apdu += len;
+                len = bacnet_enumerated_application_decode(
+                    apdu, apdu_len, &error_value);
+                if (len <= 0) {
+                    return BACNET_STATUS_ERROR;
+                }
+                property->error.error_class = (BACNET_ERROR_CLASS)error_value;
+                decoded_len += len;
+                apdu_len -= len;
+                apdu += len;
+                len = bacnet_enumerated_application_decode(
+                    apdu, apdu_len, &error_value);
+                if (len <= 0) {
+                    return BACNET_STATUS_ERROR;
+                }
+                property->error.error_code = (BACNET_ERROR_CODE)error_value;
+                decoded_len += len;
+                apdu_len -= len;
+                apdu += len;
+                if (!bacnet_is_closing_tag_number(apdu, apdu_len, 5, &len)) {
+                    return BACNET_STATUS_ERROR;
+                }
+            } else {
+                return BACNET_STATUS_ERROR;
+            }
+            /* closing tag of the read-result */
+            decoded_len += len;
+            apdu_len -= len;
+            apdu += len;
+            if (property_last) {
+                property_last->next = property;
+            } else {
+                object->listOfProperties = property;
+            }
+            property_last = property;
+        }
+    }
+
+    return decoded_len;
+}
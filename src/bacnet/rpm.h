@@ -40,6 +40,30 @@ typedef struct BACnet_Read_Access_Data {
     struct BACnet_Read_Access_Data *next;
 } BACNET_READ_ACCESS_DATA;
 
+/* a result of a ReadPropertyMultiple-ACK, with a compact value list */
+struct BACnet_Property_Reference_Compact;
+typedef struct BACnet_Property_Reference_Compact {
+    BACNET_PROPERTY_ID propertyIdentifier;
+    /* optional array index */
+    BACNET_ARRAY_INDEX propertyArrayIndex;
+    /* the values, or NULL for an empty list or an error */
+    BACNET_APPLICATION_DATA_COMPACT *value;
+    /* error code is ERROR_CODE_SUCCESS when there is no error */
+    BACNET_ACCESS_ERROR error;
+    /* simple linked list */
+    struct BACnet_Property_Reference_Compact *next;
+} BACNET_PROPERTY_REFERENCE_COMPACT;
+
+/* the results of one object of a ReadPropertyMultiple-ACK */
+struct BACnet_Read_Access_Compact;
+typedef struct BACnet_Read_Access_Compact {
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    /* simple linked list of results */
+    BACNET_PROPERTY_REFERENCE_COMPACT *listOfProperties;
+    struct BACnet_Read_Access_Compact *next;
+} BACNET_READ_ACCESS_COMPACT;
+
 /** Fetches the lists of properties (array of BACNET_PROPERTY_ID's) for this
  *  object type, grouped by Required, Optional, and Proprietary.
  * A function template; @see device.c for assignment to object types.
@@ -163,6 +187,12 @@ void rpm_ack_object_property_process(
     uint32_t device_id,
     BACNET_READ_PROPERTY_DATA *rp_data,
     read_property_ack_process callback);
+BACNET_STACK_EXPORT
+int rpm_ack_decode_compact(
+    const uint8_t *apdu,
+    unsigned apdu_len,
+    BACNET_APPLICATION_DATA_ARENA *arena,
+    BACNET_READ_ACCESS_COMPACT **read_access);
 
 #ifdef __cplusplus
 }
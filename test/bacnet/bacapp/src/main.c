@@ -8,6 +8,7 @@
  * @brief test BACnet integer encode/decode APIs
  */
 
+#include <math.h>
 #include <stdint.h>
 #include <string.h>
 #include <zephyr/ztest.h>
@@ -1330,6 +1331,120 @@ static void test_bacapp_sprintf_data(void)
     }
 }
 
+/**
+ * @brief Test the compact decoding of values into an arena
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bacapp_tests, test_bacapp_compact)
+#else
+static void test_bacapp_compact(void)
+#endif
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    uint8_t arena_buffer[512] = { 0 };
+    BACNET_APPLICATION_DATA_ARENA arena = { 0 };
+    BACNET_APPLICATION_DATA_COMPACT *list = NULL, *compact = NULL;
+    BACNET_APPLICATION_DATA_COMPACT test_compact = { 0 };
+    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+    BACNET_CHARACTER_STRING char_string = { 0 };
+    BACNET_BIT_STRING bit_string = { 0 };
+    char name[16] = { 0 };
+    int apdu_len = 0, len = 0;
+    void *memory = NULL;
+
+    /* a compact value is much smaller than a full value */
+    zassert_true(
+        (sizeof(BACNET_APPLICATION_DATA_COMPACT) * 10) <
+            sizeof(BACNET_APPLICATION_DATA_VALUE),
+        NULL);
+    apdu_len += encode_application_real(&apdu[apdu_len], 3.5f);
+    characterstring_init_ansi(&char_string, "name");
+    apdu_len +=
+        encode_application_character_string(&apdu[apdu_len], &char_string);
+    apdu_len += encode_application_unsigned(&apdu[apdu_len], 1234567);
+    apdu_len += encode_application_boolean(&apdu[apdu_len], true);
+    bitstring_init(&bit_string);
+    bitstring_set_bit(&bit_string, 2, true);
+    apdu_len += encode_application_bitstring(&apdu[apdu_len], &bit_string);
+    apdu_len += encode_opening_tag(&apdu[apdu_len], 3);
+    apdu_len += encode_application_unsigned(&apdu[apdu_len], 1);
+    apdu_len += encode_closing_tag(&apdu[apdu_len], 3);
+    apdu_len += encode_context_enumerated(&apdu[apdu_len], 1, 7);
+    bacapp_arena_init(&arena, arena_buffer, sizeof(arena_buffer));
+    len = bacapp_decode_compact_list(apdu, apdu_len, &arena, &list);
+    zassert_equal(len, apdu_len, NULL);
+    compact = list;
+    zassert_not_null(compact, NULL);
+    zassert_equal(compact->tag, BACNET_APPLICATION_TAG_REAL, NULL);
+    zassert_false(islessgreater(compact->type.Real, 3.5f), NULL);
+    zassert_true(bacapp_compact_to_value(compact, &value), NULL);
+    zassert_equal(value.tag, BACNET_APPLICATION_TAG_REAL, NULL);
+    compact = compact->next;
+    zassert_not_null(compact, NULL);
+    zassert_equal(compact->tag, BACNET_APPLICATION_TAG_CHARACTER_STRING, NULL);
+    zassert_equal(compact->type.String.encoding, CHARACTER_UTF8, NULL);
+    zassert_equal(compact->type.String.length, 4, NULL);
+    /* the string is in the APDU */
+    zassert_true(
+        (compact->type.String.value > apdu) &&
+            (compact->type.String.value < &apdu[apdu_len]),
+        NULL);
+    zassert_true(bacapp_compact_to_value(compact, &value), NULL);
+    zassert_true(
+        characterstring_same(&value.type.Character_String, &char_string),
+        NULL);
+    zassert_true(bacapp_compact_character_string(compact, name, 5), NULL);
+    zassert_equal(strcmp(name, "name"), 0, NULL);
+    /* a string that does not fit is truncated */
+    zassert_true(bacapp_compact_character_string(compact, name, 4), NULL);
+    zassert_equal(strcmp(name, "nam"), 0, NULL);
+    zassert_true(bacapp_compact_character_string(compact, name, 1), NULL);
+    zassert_equal(strcmp(name, ""), 0, NULL);
+    compact = compact->next;
+    zassert_not_null(compact, NULL);
+    zassert_equal(compact->tag, BACNET_APPLICATION_TAG_UNSIGNED_INT, NULL);
+    zassert_equal(compact->type.Unsigned_Int, 1234567, NULL);
+    zassert_false(bacapp_compact_character_string(compact, name, 5), NULL);
+    compact = compact->next;
+    zassert_not_null(compact, NULL);
+    zassert_equal(compact->tag, BACNET_APPLICATION_TAG_BOOLEAN, NULL);
+    zassert_true(compact->type.Boolean, NULL);
+    compact = compact->next;
+    zassert_not_null(compact, NULL);
+    zassert_equal(compact->tag, BACNET_APPLICATION_TAG_BIT_STRING, NULL);
+    zassert_true(bacapp_compact_to_value(compact, &value), NULL);
+    zassert_true(
+        bitstring_same(&value.type.Bit_String, &bit_string), NULL);
+    compact = compact->next;
+    zassert_not_null(compact, NULL);
+    zassert_true(compact->context_specific, NULL);
+    zassert_true(compact->constructed, NULL);
+    zassert_equal(compact->context_tag, 3, NULL);
+    zassert_equal(compact->type.String.length, 2, NULL);
+    zassert_false(bacapp_compact_to_value(compact, &value), NULL);
+    compact = compact->next;
+    zassert_not_null(compact, NULL);
+    zassert_true(compact->context_specific, NULL);
+    zassert_false(compact->constructed, NULL);
+    zassert_equal(compact->context_tag, 1, NULL);
+    zassert_equal(compact->type.String.length, 1, NULL);
+    zassert_is_null(compact->next, NULL);
+    /* the arena is used up */
+    bacapp_arena_init(&arena, arena_buffer, 16);
+    len = bacapp_decode_compact_list(apdu, apdu_len, &arena, &list);
+    zassert_equal(len, BACNET_STATUS_ABORT, NULL);
+    memory = bacapp_arena_alloc(&arena, 16);
+    zassert_not_null(memory, NULL);
+    zassert_equal(((uintptr_t)memory) % BACAPP_ARENA_ALIGNMENT, 0, NULL);
+    zassert_is_null(bacapp_arena_alloc(&arena, 1), NULL);
+    bacapp_arena_reset(&arena);
+    zassert_not_null(bacapp_arena_alloc(&arena, 1), NULL);
+    /* malformed */
+    apdu[0] = 0x44;
+    len = bacapp_decode_application_data_compact(apdu, 2, &test_compact);
+    zassert_equal(len, BACNET_STATUS_ERROR, NULL);
+}
+
 /**
  * @}
  */
@@ -1350,7 +1465,8 @@ void test_main(void)
         ztest_unit_test(testBACnetApplicationDataLength),
         ztest_unit_test(testBACnetApplicationData_Safe),
         ztest_unit_test(test_bacapp_data),
-        ztest_unit_test(test_bacapp_sprintf_data));
+        ztest_unit_test(test_bacapp_sprintf_data),
+        ztest_unit_test(test_bacapp_compact));
 
     ztest_run_test_suite(bacapp_tests);
 }
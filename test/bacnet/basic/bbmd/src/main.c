@@ -36,6 +36,11 @@ static uint8_t Test_Sent_Message_Length;
 static uint8_t Test_Sent_Message_Buffer[MAX_APDU];
 static uint16_t Test_Sent_Message_Buffer_Length;
 static BACNET_IP_ADDRESS Test_Sent_Message_Dest;
+/* for the batch of Forwarded-NPDU sent from the handler */
+#define TEST_BATCH_DEST_MAX 8
+static unsigned Test_Sent_Batch_Count;
+static BACNET_IP_ADDRESS Test_Sent_Batch_Dest[TEST_BATCH_DEST_MAX];
+static unsigned Test_Sent_Batch_Dest_Count;
 
 /* network stub functions */
 /**
@@ -92,6 +97,38 @@ int bip_send_mpdu(
     return 0;
 }
 
+/**
+ * The send function for BACnet/IP driver layer that sends the same
+ * MPDU to many destinations
+ *
+ * @param dest - array of destination addresses
+ * @param dest_count - number of destination addresses
+ * @param mtu - the bytes of data to send
+ * @param mtu_len - the number of bytes of data to send
+ *
+ * @return the number of destinations that the MPDU was sent to
+ */
+int bip_send_mpdu_batch(
+    const BACNET_IP_ADDRESS *dest,
+    unsigned dest_count,
+    const uint8_t *mtu,
+    uint16_t mtu_len)
+{
+    unsigned i = 0;
+
+    Test_Sent_Batch_Count++;
+    Test_Sent_Batch_Dest_Count = dest_count;
+    for (i = 0; (i < dest_count) && (i < TEST_BATCH_DEST_MAX); i++) {
+        bvlc_address_copy(&Test_Sent_Batch_Dest[i], &dest[i]);
+    }
+    if (dest_count > 0) {
+        /* the message is the same for every destination */
+        (void)bip_send_mpdu(&dest[0], mtu, mtu_len);
+    }
+
+    return (int)dest_count;
+}
+
 /** Return the Object Instance number for our (single) Device Object.
  * This is a key function, widely invoked by the handler code, since
  * it provides "our" (ie, local) address.
@@ -227,11 +264,91 @@ static void test_BBMD_Result(void)
     }
 }
 
+/**
+ * @brief Test that a broadcast is forwarded to the FDT and BDT entries
+ *  in one batch, except to ourselves and to the origin
+ */
+static void test_BBMD_Forward_Batch(void)
+{
+    BACNET_IP_BROADCAST_DISTRIBUTION_TABLE_ENTRY *bdt_list;
+    BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY *fdt_list;
+    BACNET_IP_BROADCAST_DISTRIBUTION_MASK mask = { 0 };
+    BACNET_IP_ADDRESS addr = { 0 };
+    BACNET_IP_ADDRESS fd_addr[3] = { 0 };
+    BACNET_IP_ADDRESS bbmd_addr = { 0 };
+    BACNET_IP_ADDRESS fwd_address = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t npdu[] = { 0x01, 0x20, 0xFF, 0xFF, 0x00, 0xFF, 0x10, 0x08 };
+    uint8_t test_npdu[sizeof(npdu)] = { 0 };
+    uint16_t test_npdu_len = 0;
+    uint8_t mtu[MAX_APDU] = { 0 };
+    uint16_t mtu_len = 0;
+    int function_len = 0;
+    unsigned i = 0;
+
+    test_setup();
+    bdt_list = bvlc_bdt_list();
+    fdt_list = bvlc_fdt_list();
+    bvlc_broadcast_distribution_mask_from_host(&mask, 0xFFFFFFFFL);
+    /* our own entry, which is not forwarded to */
+    bvlc_broadcast_distribution_table_entry_set(
+        &bdt_list[0], &IUT.BIP_Addr, &mask);
+    bvlc_address_set(&bbmd_addr, 10, 0, 0, 1);
+    bbmd_addr.port = 0xBAC0;
+    bvlc_broadcast_distribution_table_entry_set(
+        &bdt_list[1], &bbmd_addr, &mask);
+    bdt_list[0].valid = true;
+    bdt_list[1].valid = true;
+    for (i = 0; i < 3; i++) {
+        bvlc_address_set(&fd_addr[i], 172, 16, 0, (uint8_t)(i + 1));
+        fd_addr[i].port = 0xBAC0;
+        assert(bvlc_foreign_device_table_entry_add(
+            &fdt_list[0], &fd_addr[i], 60));
+    }
+    /* a Distribute-Broadcast-To-Network from the first foreign device */
+    mtu_len = bvlc_encode_distribute_broadcast_to_network(
+        mtu, sizeof(mtu), npdu, sizeof(npdu));
+    Test_Sent_Batch_Count = 0;
+    (void)bvlc_bbmd_enabled_handler(&fd_addr[0], &src, mtu, mtu_len);
+    assert(Test_Sent_Batch_Count == 1);
+    assert(Test_Sent_Batch_Dest_Count == 3);
+    /* the FDT, except the origin, and then the BDT, except ourselves */
+    assert(!bvlc_address_different(&Test_Sent_Batch_Dest[0], &fd_addr[1]));
+    assert(!bvlc_address_different(&Test_Sent_Batch_Dest[1], &fd_addr[2]));
+    assert(!bvlc_address_different(&Test_Sent_Batch_Dest[2], &bbmd_addr));
+    assert(Test_Sent_Message_Type == BVLC_FORWARDED_NPDU);
+    function_len = bvlc_decode_forwarded_npdu(
+        Test_Sent_Message_Buffer, Test_Sent_Message_Buffer_Length,
+        &fwd_address, test_npdu, sizeof(test_npdu), &test_npdu_len);
+    assert(function_len > 0);
+    assert(!bvlc_address_different(&fwd_address, &fd_addr[0]));
+    assert(test_npdu_len == sizeof(npdu));
+    assert(memcmp(test_npdu, npdu, sizeof(npdu)) == 0);
+    /* a Forwarded-NPDU from the peer BBMD is sent only to the FDT */
+    bvlc_address_copy(&addr, &bbmd_addr);
+    mtu_len = bvlc_encode_forwarded_npdu(
+        mtu, sizeof(mtu), &addr, npdu, sizeof(npdu));
+    Test_Sent_Batch_Count = 0;
+    (void)bvlc_bbmd_enabled_handler(&bbmd_addr, &src, mtu, mtu_len);
+    assert(Test_Sent_Batch_Count == 1);
+    assert(Test_Sent_Batch_Dest_Count == 3);
+    for (i = 0; i < 3; i++) {
+        assert(!bvlc_address_different(
+            &Test_Sent_Batch_Dest[i], &fd_addr[i]));
+    }
+    bvlc_bdt_list_clear();
+    for (i = 0; i < 3; i++) {
+        fdt_list[i].valid = false;
+    }
+    test_cleanup();
+}
+
 int main(void)
 {
     /* individual tests */
     test_BBMD_Result();
     test_Initiate_Original_Broadcast_NPDU();
+    test_BBMD_Forward_Batch();
 
     return 0;
 }
@@ -314,11 +314,95 @@ static void test_BBMD_Result(void)
     }
 }
 
+/**
+ * @brief Test the VMAC address index and least recently used eviction
+ */
+static void test_VMAC_Index(void)
+{
+    struct vmac_data vmac = { 0 };
+    struct vmac_data old_vmac = { 0 };
+    struct vmac_statistics stats = { 0 };
+    uint32_t device_id = 0;
+    uint32_t i = 0;
+    bool status = false;
+
+    VMAC_Init();
+    VMAC_Statistics_Clear();
+    vmac.mac_len = VMAC_MAC_MAX;
+    /* more entries than hash buckets, so that buckets are shared */
+    for (i = 0; i < (VMAC_HASH_SIZE * 2); i++) {
+        encode_unsigned32(&vmac.mac[12], i);
+        status = VMAC_Add(i + 1000, &vmac);
+        assert(status);
+    }
+    assert(VMAC_Count() == (VMAC_HASH_SIZE * 2));
+    for (i = 0; i < (VMAC_HASH_SIZE * 2); i++) {
+        encode_unsigned32(&vmac.mac[12], i);
+        status = VMAC_Find_By_Data(&vmac, &device_id);
+        assert(status);
+        assert(device_id == (i + 1000));
+    }
+    encode_unsigned32(&vmac.mac[12], VMAC_HASH_SIZE * 2);
+    status = VMAC_Find_By_Data(&vmac, &device_id);
+    assert(!status);
+    VMAC_Statistics(&stats);
+    assert(stats.hits == (VMAC_HASH_SIZE * 2));
+    assert(stats.misses == 1);
+    assert(stats.evictions == 0);
+    /* changing the VMAC of a device moves it in the index */
+    encode_unsigned32(&old_vmac.mac[12], 1);
+    old_vmac.mac_len = VMAC_MAC_MAX;
+    encode_unsigned32(&vmac.mac[12], 0xFFFFFFFF);
+    status = VMAC_Update(1001, &vmac);
+    assert(status);
+    assert(!VMAC_Find_By_Data(&old_vmac, &device_id));
+    assert(VMAC_Find_By_Data(&vmac, &device_id));
+    assert(device_id == 1001);
+    assert(VMAC_Match(VMAC_Find_By_Key(1001), &vmac));
+    /* deleting a device removes it from the index */
+    status = VMAC_Delete(1001);
+    assert(status);
+    assert(!VMAC_Find_By_Data(&vmac, &device_id));
+    VMAC_Cleanup();
+    assert(VMAC_Count() == 0);
+    /* the least recently used entry is evicted when the list is full */
+    VMAC_Init();
+    VMAC_Statistics_Clear();
+    VMAC_Entries_Max_Set(3);
+    assert(VMAC_Entries_Max() == 3);
+    for (i = 0; i < 3; i++) {
+        encode_unsigned32(&vmac.mac[12], i);
+        VMAC_Add(i, &vmac);
+    }
+    /* use device 0, so that device 1 is the least recently used */
+    encode_unsigned32(&vmac.mac[12], 0);
+    assert(VMAC_Find_By_Data(&vmac, &device_id));
+    encode_unsigned32(&vmac.mac[12], 3);
+    status = VMAC_Add(3, &vmac);
+    assert(status);
+    assert(VMAC_Count() == 3);
+    assert(VMAC_Find_By_Key(1) == NULL);
+    encode_unsigned32(&old_vmac.mac[12], 1);
+    assert(!VMAC_Find_By_Data(&old_vmac, &device_id));
+    assert(VMAC_Find_By_Key(0) != NULL);
+    assert(VMAC_Find_By_Key(2) != NULL);
+    /* a smaller limit evicts down to the new size */
+    VMAC_Entries_Max_Set(1);
+    assert(VMAC_Count() == 1);
+    assert(VMAC_Find_By_Key(3) == NULL);
+    assert(VMAC_Find_By_Key(2) != NULL);
+    VMAC_Statistics(&stats);
+    assert(stats.evictions == 3);
+    VMAC_Entries_Max_Set(0);
+    VMAC_Cleanup();
+}
+
 int main(void)
 {
     test_BBMD_Result();
     test_Execute_Virtual_Address_Resolution();
     test_Initiate_Original_Broadcast_NPDU();
+    test_VMAC_Index();
 
     return 0;
 }
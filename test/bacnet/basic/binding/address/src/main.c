@@ -34,14 +34,15 @@ static void set_address(unsigned index, BACNET_ADDRESS *dest)
 {
     unsigned i;
 
+    /* unique for caches larger than 255 entries */
     for (i = 0; i < MAX_MAC_LEN; i++) {
-        dest->mac[i] = index;
+        dest->mac[i] = (uint8_t)(index >> ((i % 2) * 8));
     }
     dest->mac_len = MAX_MAC_LEN;
     dest->net = 7;
     dest->len = MAX_MAC_LEN;
     for (i = 0; i < MAX_MAC_LEN; i++) {
-        dest->adr[i] = index;
+        dest->adr[i] = (uint8_t)(index >> ((i % 2) * 8));
     }
 }
 
@@ -200,6 +201,81 @@ static void testAddress(void)
         zassert_equal(count, (MAX_ADDRESS_CACHE - i - 1), NULL);
     }
 }
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(address_tests, testAddressRebind)
+#else
+static void testAddressRebind(void)
+#endif
+{
+    BACNET_ADDRESS src, old_src;
+    BACNET_ADDRESS test_address;
+    uint32_t device_id = 1234;
+    uint32_t test_device_id = 0;
+    unsigned test_max_apdu = 0;
+
+    address_init();
+    set_address(1, &old_src);
+    set_address(2, &src);
+    zassert_false(address_bind_request(device_id, NULL, NULL), NULL);
+    zassert_false(address_get_device_id(&old_src, NULL), NULL);
+    address_add_binding(device_id, 480, &old_src);
+    zassert_true(address_get_device_id(&old_src, &test_device_id), NULL);
+    zassert_equal(test_device_id, device_id, NULL);
+    /* device moved to a new address */
+    address_add(device_id, 1476, &src);
+    zassert_false(address_get_device_id(&old_src, NULL), NULL);
+    zassert_true(address_get_device_id(&src, &test_device_id), NULL);
+    zassert_equal(test_device_id, device_id, NULL);
+    zassert_true(
+        address_bind_request(device_id, &test_max_apdu, &test_address), NULL);
+    zassert_equal(test_max_apdu, 1476, NULL);
+    zassert_true(bacnet_address_same(&test_address, &src), NULL);
+    /* expired entries are removed from the indexes */
+    address_set_device_TTL(device_id, 10, false);
+    address_cache_timer(11);
+    zassert_false(address_get_device_id(&src, NULL), NULL);
+    zassert_false(address_get_by_device(device_id, NULL, &test_address), NULL);
+    zassert_equal(address_count(), 0, NULL);
+}
+
+#if defined(BACNET_ADDRESS_CACHE_HASH)
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(address_tests, testAddressEviction)
+#else
+static void testAddressEviction(void)
+#endif
+{
+    unsigned i;
+    BACNET_ADDRESS src;
+    BACNET_ADDRESS test_address;
+    uint32_t test_device_id = 0;
+
+    address_init();
+    for (i = 0; i < MAX_ADDRESS_CACHE; i++) {
+        set_address(i, &src);
+        address_add(i + 1, 480, &src);
+    }
+    zassert_equal(address_count(), MAX_ADDRESS_CACHE, NULL);
+    /* use the oldest entry so that the next oldest is evicted */
+    zassert_true(address_get_by_device(1, NULL, &test_address), NULL);
+    set_address(MAX_ADDRESS_CACHE, &src);
+    address_add(MAX_ADDRESS_CACHE + 1, 480, &src);
+    zassert_equal(address_count(), MAX_ADDRESS_CACHE, NULL);
+    zassert_true(address_get_by_device(1, NULL, &test_address), NULL);
+    zassert_false(address_get_by_device(2, NULL, &test_address), NULL);
+    zassert_true(
+        address_get_by_device(MAX_ADDRESS_CACHE + 1, NULL, &test_address),
+        NULL);
+    zassert_true(address_get_device_id(&src, &test_device_id), NULL);
+    zassert_equal(test_device_id, MAX_ADDRESS_CACHE + 1, NULL);
+    /* the evicted entry index is reused in place */
+    zassert_true(address_get_by_index(1, &test_device_id, NULL, NULL), NULL);
+    zassert_equal(test_device_id, MAX_ADDRESS_CACHE + 1, NULL);
+    address_init();
+    zassert_equal(address_count(), 0, NULL);
+}
+#endif
 /**
  * @}
  */
@@ -212,11 +288,20 @@ void test_main(void)
 #ifdef BACNET_ADDRESS_CACHE_FILE
     ztest_test_suite(
         address_tests, ztest_unit_test(testAddressFile),
-        ztest_unit_test(testAddress));
+        ztest_unit_test(testAddress), ztest_unit_test(testAddressRebind));
+
+    ztest_run_test_suite(address_tests);
+#elif defined(BACNET_ADDRESS_CACHE_HASH)
+    ztest_test_suite(
+        address_tests, ztest_unit_test(testAddress),
+        ztest_unit_test(testAddressRebind),
+        ztest_unit_test(testAddressEviction));
 
     ztest_run_test_suite(address_tests);
 #else
-    ztest_test_suite(address_tests, ztest_unit_test(testAddress));
+    ztest_test_suite(
+        address_tests, ztest_unit_test(testAddress),
+        ztest_unit_test(testAddressRebind));
 
     ztest_run_test_suite(address_tests);
 #endif
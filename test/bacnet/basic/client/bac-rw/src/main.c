@@ -0,0 +1,372 @@
+/**
+ * @file
+ * @brief test the client that reads and writes properties of other devices
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <math.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/apdu.h>
+#include <bacnet/bacaddr.h>
+#include <bacnet/basic/binding/address.h>
+#include <bacnet/basic/client/bac-rw.h>
+#include <bacnet/basic/object/av.h>
+#include <bacnet/basic/object/device.h>
+#include <bacnet/basic/service/h_apdu.h>
+#include <bacnet/basic/service/h_noserv.h>
+#include <bacnet/basic/service/h_rp.h>
+#include <bacnet/basic/service/h_rpm.h>
+#include <bacnet/basic/service/h_wp.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* loopback datalink, from stubs.c */
+extern BACNET_ADDRESS Test_Server_Address;
+extern BACNET_ADDRESS Test_Client_Address;
+extern unsigned Test_Server_PDU_Count;
+extern unsigned long Test_Milliseconds;
+unsigned test_loopback_receive(void);
+
+/* device instance of the client, and of the server it reads from */
+#define TEST_CLIENT_DEVICE_ID 1234
+#define TEST_SERVER_DEVICE_ID 4321
+/* number of points read by the tests */
+#define TEST_POINTS_MAX 1024
+/* the values read, found by the context of each request */
+static float Test_Value[TEST_POINTS_MAX];
+static unsigned Test_Value_Count;
+static unsigned Test_Error_Count;
+
+/**
+ * @brief Prepare the server with analog value points, and the client
+ *  with the server bound in its address cache
+ * @param points [in] number of analog value points
+ */
+static void test_setup(unsigned points)
+{
+    unsigned i;
+
+    Device_Init(NULL);
+    Device_Set_Object_Instance_Number(TEST_CLIENT_DEVICE_ID);
+    for (i = 0; i < points; i++) {
+        Analog_Value_Create(i);
+        Analog_Value_Present_Value_Set(i, (float)i, BACNET_MAX_PRIORITY);
+    }
+    bacnet_read_write_init();
+    apdu_set_unrecognized_service_handler_handler(handler_unrecognized_service);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_READ_PROPERTY, handler_read_property);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_READ_PROP_MULTIPLE, handler_read_property_multiple);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_WRITE_PROPERTY, handler_write_property);
+    memset(&Test_Server_Address, 0, sizeof(BACNET_ADDRESS));
+    Test_Server_Address.mac_len = 1;
+    Test_Server_Address.mac[0] = 1;
+    memset(&Test_Client_Address, 0, sizeof(BACNET_ADDRESS));
+    Test_Client_Address.mac_len = 1;
+    Test_Client_Address.mac[0] = 2;
+    address_add(TEST_SERVER_DEVICE_ID, MAX_APDU, &Test_Server_Address);
+    Test_Server_PDU_Count = 0;
+    memset(Test_Value, 0, sizeof(Test_Value));
+    Test_Value_Count = 0;
+    Test_Error_Count = 0;
+}
+
+/**
+ * @brief Store the reply to one request
+ */
+static void test_value_callback(
+    uint32_t device_instance,
+    BACNET_READ_PROPERTY_DATA *rp_data,
+    BACNET_APPLICATION_DATA_VALUE *value,
+    void *context)
+{
+    float *stored = context;
+
+    zassert_equal(device_instance, TEST_SERVER_DEVICE_ID, NULL);
+    zassert_not_null(rp_data, NULL);
+    zassert_not_null(stored, NULL);
+    if (value && (value->tag == BACNET_APPLICATION_TAG_REAL)) {
+        /* the value is the instance of the object it came from */
+        zassert_equal(
+            stored, &Test_Value[rp_data->object_instance],
+            "instance=%u", (unsigned)rp_data->object_instance);
+        *stored = value->type.Real;
+        Test_Value_Count++;
+    } else {
+        Test_Error_Count++;
+    }
+}
+
+/**
+ * @brief Poll the present value of the points, queueing them while there
+ *  is room, until all of them are replied to
+ * @param points [in] number of points to poll
+ * @param pipelined [in] true to send polls of the same device together
+ *  with many outstanding, false to send one ReadProperty at a time
+ * @return number of times the client waited for the network
+ */
+static unsigned test_poll(unsigned points, bool pipelined)
+{
+    unsigned next = 0;
+    unsigned cycles = 0;
+    bool status;
+
+    while ((next < points) || !bacnet_read_write_idle()) {
+        while ((next < points) && !bacnet_read_write_busy()) {
+            if (pipelined) {
+                status = bacnet_read_property_request_queue(
+                    TEST_SERVER_DEVICE_ID, OBJECT_ANALOG_VALUE, next,
+                    PROP_PRESENT_VALUE, BACNET_ARRAY_ALL,
+                    test_value_callback, &Test_Value[next]);
+            } else {
+                status = bacnet_read_property_queue(
+                    TEST_SERVER_DEVICE_ID, OBJECT_ANALOG_VALUE, next,
+                    PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+            }
+            zassert_true(status, NULL);
+            next++;
+        }
+        bacnet_read_write_task();
+        test_loopback_receive();
+        Test_Milliseconds++;
+        cycles++;
+        zassert_true(cycles < (points * 4), NULL);
+    }
+
+    return cycles;
+}
+
+/**
+ * @brief Value callback of the requests that were queued without
+ *  a callback of their own
+ */
+static void test_read_write_value_callback(
+    uint32_t device_instance,
+    BACNET_READ_PROPERTY_DATA *rp_data,
+    BACNET_APPLICATION_DATA_VALUE *value)
+{
+    test_value_callback(
+        device_instance, rp_data, value,
+        &Test_Value[rp_data->object_instance]);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bac_rw_tests, testReadPropertyCoalesce)
+#else
+static void testReadPropertyCoalesce(void)
+#endif
+{
+    const unsigned points = 64;
+    unsigned i;
+
+    test_setup(points);
+    test_poll(points, true);
+    zassert_equal(Test_Value_Count, points, NULL);
+    zassert_equal(Test_Error_Count, 0, NULL);
+    for (i = 0; i < points; i++) {
+        zassert_false(islessgreater(Test_Value[i], (float)i), "i=%u", i);
+    }
+    /* polls of the same device are sent together */
+    zassert_equal(
+        Test_Server_PDU_Count, points / BACNET_READ_WRITE_REFERENCE_MAX,
+        "requests=%u", Test_Server_PDU_Count);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bac_rw_tests, testReadPropertySplit)
+#else
+static void testReadPropertySplit(void)
+#endif
+{
+    const unsigned points = 8;
+    unsigned i;
+
+    test_setup(points);
+    /* the server does not support ReadPropertyMultiple */
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_READ_PROP_MULTIPLE, NULL);
+    test_poll(points, true);
+    zassert_equal(Test_Value_Count, points, NULL);
+    zassert_equal(Test_Error_Count, 0, NULL);
+    for (i = 0; i < points; i++) {
+        zassert_false(islessgreater(Test_Value[i], (float)i), "i=%u", i);
+    }
+    /* the rejected request, then each property by itself */
+    zassert_equal(Test_Server_PDU_Count, 1 + points, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bac_rw_tests, testWritePropertyOrder)
+#else
+static void testWritePropertyOrder(void)
+#endif
+{
+    unsigned cycles = 0;
+    bool status;
+
+    test_setup(1);
+    status = bacnet_write_property_real_queue(
+        TEST_SERVER_DEVICE_ID, OBJECT_ANALOG_VALUE, 0, PROP_PRESENT_VALUE,
+        1.0f, 8, BACNET_ARRAY_ALL);
+    zassert_true(status, NULL);
+    status = bacnet_write_property_real_queue(
+        TEST_SERVER_DEVICE_ID, OBJECT_ANALOG_VALUE, 0, PROP_PRESENT_VALUE,
+        2.0f, 8, BACNET_ARRAY_ALL);
+    zassert_true(status, NULL);
+    /* the second write waits for the first */
+    bacnet_read_write_task();
+    zassert_equal(Test_Server_PDU_Count, 1, NULL);
+    while (!bacnet_read_write_idle()) {
+        test_loopback_receive();
+        bacnet_read_write_task();
+        cycles++;
+        zassert_true(cycles < 10, NULL);
+    }
+    zassert_equal(Test_Server_PDU_Count, 2, NULL);
+    zassert_false(
+        islessgreater(Analog_Value_Present_Value(0), 2.0f), NULL);
+}
+
+/**
+ * @brief Polling many points of a server in this process, one
+ *  ReadProperty at a time, and pipelined with polls of the same device
+ *  sent together. The loopback datalink has no delay, so the number of
+ *  times the client waits for the network is counted.
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bac_rw_tests, testReadPropertyPipelined)
+#else
+static void testReadPropertyPipelined(void)
+#endif
+{
+    unsigned serial_cycles, serial_requests;
+    unsigned pipelined_cycles, pipelined_requests;
+
+    test_setup(TEST_POINTS_MAX);
+    bacnet_read_write_value_callback_set(test_read_write_value_callback);
+    bacnet_read_write_transactions_set(1);
+    serial_cycles = test_poll(TEST_POINTS_MAX, false);
+    serial_requests = Test_Server_PDU_Count;
+    zassert_equal(Test_Value_Count, TEST_POINTS_MAX, NULL);
+    Test_Server_PDU_Count = 0;
+    Test_Value_Count = 0;
+    bacnet_read_write_transactions_set(BACNET_READ_WRITE_TRANSACTIONS_MAX);
+    pipelined_cycles = test_poll(TEST_POINTS_MAX, true);
+    pipelined_requests = Test_Server_PDU_Count;
+    zassert_equal(Test_Value_Count, TEST_POINTS_MAX, NULL);
+    zassert_equal(Test_Error_Count, 0, NULL);
+    zassert_true(pipelined_requests < serial_requests, NULL);
+    zassert_true(pipelined_cycles < serial_cycles, NULL);
+    bacnet_read_write_value_callback_set(NULL);
+}
+/* the replies to requests of one object, by property */
+struct test_reply {
+    unsigned count;
+    unsigned errors;
+    uint8_t tag;
+    BACNET_ARRAY_INDEX array_index;
+};
+
+/**
+ * @brief Store the last reply value of one property
+ */
+static void test_reply_callback(
+    uint32_t device_instance,
+    BACNET_READ_PROPERTY_DATA *rp_data,
+    BACNET_APPLICATION_DATA_VALUE *value,
+    void *context)
+{
+    struct test_reply *reply = context;
+
+    zassert_equal(device_instance, TEST_SERVER_DEVICE_ID, NULL);
+    zassert_not_null(rp_data, NULL);
+    zassert_not_null(reply, NULL);
+    if (value) {
+        reply->tag = value->tag;
+        reply->array_index = rp_data->array_index;
+        reply->count++;
+    } else {
+        reply->errors++;
+    }
+}
+
+/**
+ * @brief Reading properties of different types in one
+ *  ReadPropertyMultiple, whose reply has plain values, a complex value,
+ *  an empty list, and an error
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(bac_rw_tests, testReadPropertyMultipleValues)
+#else
+static void testReadPropertyMultipleValues(void)
+#endif
+{
+    static const BACNET_READ_WRITE_REFERENCE references[] = {
+        { OBJECT_ANALOG_VALUE, 0, PROP_PRESENT_VALUE, BACNET_ARRAY_ALL },
+        { OBJECT_ANALOG_VALUE, 0, PROP_OBJECT_NAME, BACNET_ARRAY_ALL },
+        { OBJECT_DEVICE, TEST_CLIENT_DEVICE_ID, PROP_TIME_OF_DEVICE_RESTART,
+          BACNET_ARRAY_ALL },
+        { OBJECT_DEVICE, TEST_CLIENT_DEVICE_ID, PROP_ACTIVE_COV_SUBSCRIPTIONS,
+          BACNET_ARRAY_ALL },
+        { OBJECT_ANALOG_VALUE, 0, PROP_LIGHTING_COMMAND, BACNET_ARRAY_ALL },
+    };
+    struct test_reply reply[5] = { 0 };
+    unsigned cycles = 0;
+    unsigned i;
+    bool status;
+
+    test_setup(1);
+    for (i = 0; i < 5; i++) {
+        status = bacnet_read_property_request_queue(
+            TEST_SERVER_DEVICE_ID, references[i].object_type,
+            references[i].object_instance, references[i].object_property,
+            references[i].array_index, test_reply_callback, &reply[i]);
+        zassert_true(status, NULL);
+    }
+    while (!bacnet_read_write_idle()) {
+        bacnet_read_write_task();
+        test_loopback_receive();
+        cycles++;
+        zassert_true(cycles < 10, NULL);
+    }
+    zassert_equal(Test_Server_PDU_Count, 1, NULL);
+    for (i = 0; i < 4; i++) {
+        zassert_equal(reply[i].errors, 0, "i=%u", i);
+    }
+    zassert_equal(reply[0].count, 1, NULL);
+    zassert_equal(reply[0].tag, BACNET_APPLICATION_TAG_REAL, NULL);
+    zassert_equal(reply[0].array_index, BACNET_ARRAY_ALL, NULL);
+    zassert_equal(reply[1].count, 1, NULL);
+    zassert_equal(reply[1].tag, BACNET_APPLICATION_TAG_CHARACTER_STRING, NULL);
+    zassert_equal(reply[2].count, 1, NULL);
+    zassert_equal(reply[2].tag, BACNET_APPLICATION_TAG_TIMESTAMP, NULL);
+    zassert_equal(reply[3].count, 1, NULL);
+    zassert_equal(reply[3].tag, BACNET_APPLICATION_TAG_EMPTYLIST, NULL);
+    zassert_equal(reply[4].count, 0, NULL);
+    zassert_equal(reply[4].errors, 1, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(bac_rw_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        bac_rw_tests, ztest_unit_test(testReadPropertyCoalesce),
+        ztest_unit_test(testReadPropertySplit),
+        ztest_unit_test(testWritePropertyOrder),
+        ztest_unit_test(testReadPropertyPipelined),
+        ztest_unit_test(testReadPropertyMultipleValues));
+
+    ztest_run_test_suite(bac_rw_tests);
+}
+#endif
@@ -10,6 +10,7 @@
 
 #include <zephyr/ztest.h>
 #include <bacnet/basic/object/device.h>
+#include <bacnet/basic/object/av.h>
 #include <bacnet/bactext.h>
 
 /**
@@ -117,6 +118,104 @@ static void test_Device_Data_Sharing(void)
     }
 }
 
+/**
+ * @brief Find an object in the Object_List
+ * @return the Object_List array index, or zero if not found
+ */
+static uint32_t Object_List_Position(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    BACNET_OBJECT_TYPE type = OBJECT_NONE;
+    uint32_t instance = 0;
+    uint32_t count, i;
+
+    count = Device_Object_List_Count();
+    for (i = 1; i <= count; i++) {
+        if (Device_Object_List_Identifier(i, &type, &instance) &&
+            (type == object_type) && (instance == object_instance)) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Test the Object_List and Object_Name indexes
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(device_tests, testDevice_Object_Index)
+#else
+static void testDevice_Object_Index(void)
+#endif
+{
+    BACNET_CREATE_OBJECT_DATA create_data = { 0 };
+    BACNET_DELETE_OBJECT_DATA delete_data = { 0 };
+    BACNET_CHARACTER_STRING name = { 0 }, new_name = { 0 };
+    BACNET_OBJECT_TYPE type = OBJECT_NONE, test_type = OBJECT_NONE;
+    uint32_t instance = 0, test_instance = 0;
+    uint32_t count, i;
+    bool status;
+
+    Device_Init(NULL);
+    count = Device_Object_List_Count();
+    zassert_true(count > 0, NULL);
+    for (i = 1; i <= count; i++) {
+        status = Device_Object_List_Identifier(i, &type, &instance);
+        zassert_true(status, NULL);
+        zassert_true(Device_Valid_Object_Id(type, instance), NULL);
+        status = Device_Object_Name_Copy(type, instance, &name);
+        zassert_true(status, NULL);
+        status = Device_Valid_Object_Name(&name, &test_type, &test_instance);
+        zassert_true(status, NULL);
+        zassert_equal(type, test_type, NULL);
+        zassert_equal(instance, test_instance, NULL);
+    }
+    zassert_false(Device_Object_List_Identifier(count + 1, &type, &instance),
+        NULL);
+    /* CreateObject */
+    create_data.object_type = OBJECT_ANALOG_VALUE;
+    create_data.object_instance = 1234;
+    status = Device_Create_Object(&create_data);
+    zassert_true(status, NULL);
+    zassert_equal(Device_Object_List_Count(), count + 1, NULL);
+    zassert_not_equal(
+        Object_List_Position(OBJECT_ANALOG_VALUE, 1234), 0, NULL);
+    status = Device_Object_Name_Copy(OBJECT_ANALOG_VALUE, 1234, &name);
+    zassert_true(status, NULL);
+    status = Device_Valid_Object_Name(&name, &test_type, &test_instance);
+    zassert_true(status, NULL);
+    zassert_equal(test_type, OBJECT_ANALOG_VALUE, NULL);
+    zassert_equal(test_instance, 1234, NULL);
+    /* renamed through the object API */
+    status = Analog_Value_Name_Set(1234, "Object Index Test");
+    zassert_true(status, NULL);
+    Device_Inc_Database_Revision();
+    characterstring_init_ansi(&new_name, "Object Index Test");
+    zassert_false(Device_Valid_Object_Name(&name, NULL, NULL), NULL);
+    status = Device_Valid_Object_Name(&new_name, &test_type, &test_instance);
+    zassert_true(status, NULL);
+    zassert_equal(test_type, OBJECT_ANALOG_VALUE, NULL);
+    zassert_equal(test_instance, 1234, NULL);
+    /* DeleteObject */
+    delete_data.object_type = OBJECT_ANALOG_VALUE;
+    delete_data.object_instance = 1234;
+    status = Device_Delete_Object(&delete_data);
+    zassert_true(status, NULL);
+    zassert_equal(Device_Object_List_Count(), count, NULL);
+    zassert_equal(Object_List_Position(OBJECT_ANALOG_VALUE, 1234), 0, NULL);
+    zassert_false(Device_Valid_Object_Name(&new_name, NULL, NULL), NULL);
+    /* objects created outside of the Device object are found too */
+    instance = Analog_Value_Create(4321);
+    zassert_equal(instance, 4321, NULL);
+    zassert_not_equal(
+        Object_List_Position(OBJECT_ANALOG_VALUE, 4321), 0, NULL);
+    status = Device_Object_Name_Copy(OBJECT_ANALOG_VALUE, 4321, &name);
+    zassert_true(status, NULL);
+    zassert_true(Device_Valid_Object_Name(&name, NULL, NULL), NULL);
+    Analog_Value_Delete(4321);
+}
+
 /**
  * @brief Test basic API
  */
@@ -231,6 +330,7 @@ void test_main(void)
 {
     ztest_test_suite(
         device_tests, ztest_unit_test(testDevice),
+        ztest_unit_test(testDevice_Object_Index),
         ztest_unit_test(test_Device_Data_Sharing));
 
     ztest_run_test_suite(device_tests);
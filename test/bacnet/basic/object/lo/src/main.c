@@ -8,6 +8,7 @@
  * @brief test BACnet integer encode/decode APIs
  */
 
+#include <math.h>
 #include <zephyr/ztest.h>
 #include <bacnet/bactext.h>
 #include <bacnet/basic/object/lo.h>
@@ -40,6 +41,7 @@ static void testLightingOutput(void)
     uint16_t milliseconds = 10;
     const char *test_name = NULL;
     char *sample_name = "sample";
+    BACNET_LIGHTING_COMMAND command = { 0 };
 
     Lighting_Output_Init();
     Lighting_Output_Create(instance);
@@ -133,6 +135,23 @@ static void testLightingOutput(void)
     zassert_false(status, NULL);
     /* check the dimming/ramping/stepping engine*/
     Lighting_Output_Timer(instance, milliseconds);
+    /* check the timer task runs the fade until it completes */
+    command.operation = BACNET_LIGHTS_FADE_TO;
+    command.use_target_level = true;
+    command.target_level = 50.0f;
+    command.use_fade_time = true;
+    command.fade_time = 100;
+    command.use_priority = true;
+    command.priority = BACNET_MAX_PRIORITY;
+    status = Lighting_Output_Lighting_Command_Set(instance, &command);
+    zassert_true(status, NULL);
+    for (index = 0; index < 20; index++) {
+        Lighting_Output_Timer_Task(milliseconds);
+    }
+    zassert_equal(
+        Lighting_Output_In_Progress(instance), BACNET_LIGHTING_IDLE, NULL);
+    zassert_false(
+        islessgreater(Lighting_Output_Tracking_Value(instance), 50.0f), NULL);
     /* test the ASCII name get/set */
     status = Lighting_Output_Name_Set(instance, sample_name);
     zassert_true(status, NULL);
@@ -8,8 +8,10 @@
  */
 #include <zephyr/ztest.h>
 #include <bacnet/bactext.h>
+#include <bacnet/event.h>
 #include <bacnet/rp.h>
 #include <bacnet/wp.h>
+#include <bacnet/basic/binding/address.h>
 #include <bacnet/basic/object/nc.h>
 
 /**
@@ -17,6 +19,13 @@
  * @{
  */
 
+/* notifications sent, from stubs.c */
+extern unsigned Test_Confirmed_Notify_Count;
+extern unsigned Test_Unconfirmed_Notify_Count;
+extern uint8_t Test_Notify_Service_Request[MAX_APDU];
+extern uint16_t Test_Notify_Service_Request_Len;
+extern unsigned Test_Transactions_Available;
+
 /**
  * @brief Test
  */
@@ -132,6 +141,136 @@ static void test_Notification_Class(void)
 
     return;
 }
+/**
+ * @brief Test the notifications sent to the recipients of an event
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(notification_class_tests, test_Notification_Class_Notify)
+#else
+static void test_Notification_Class_Notify(void)
+#endif
+{
+    BACNET_DESTINATION recipient_list[NC_MAX_RECIPIENTS] = { 0 };
+    BACNET_EVENT_NOTIFICATION_DATA event_data = { 0 };
+    BACNET_EVENT_NOTIFICATION_DATA test_data = { 0 };
+    NC_NOTIFY_STATISTICS stats = { 0 };
+    BACNET_ADDRESS address = { 0 };
+    const uint32_t instance = 1;
+    unsigned i;
+    int len;
+
+    Notification_Class_Init();
+    address_init();
+    for (i = 0; i < NC_MAX_RECIPIENTS; i++) {
+        bacnet_destination_default_init(&recipient_list[i]);
+        bitstring_set_bit(
+            &recipient_list[i].Transitions, TRANSITION_TO_OFFNORMAL, true);
+    }
+    /* a bound device, an address, a bound device that is sent confirmed
+       notifications, and a device that is not bound */
+    address.mac_len = 1;
+    address.mac[0] = 100;
+    address_add(100, MAX_APDU, &address);
+    recipient_list[0].Recipient.type.device.instance = 100;
+    recipient_list[0].ProcessIdentifier = 1;
+    recipient_list[1].Recipient.tag = BACNET_RECIPIENT_TAG_ADDRESS;
+    recipient_list[1].Recipient.type.address.mac_len = 1;
+    recipient_list[1].Recipient.type.address.mac[0] = 5;
+    recipient_list[1].ProcessIdentifier = 2;
+    address.mac[0] = 200;
+    address_add(200, MAX_APDU, &address);
+    recipient_list[2].Recipient.type.device.instance = 200;
+    recipient_list[2].ProcessIdentifier = 70000;
+    recipient_list[2].ConfirmedNotify = true;
+    recipient_list[3].Recipient.type.device.instance = 300;
+    Notification_Class_Set_Recipient_List(instance, recipient_list);
+    event_data.notificationClass = instance;
+    event_data.eventObjectIdentifier.type = OBJECT_ANALOG_INPUT;
+    event_data.eventObjectIdentifier.instance = 7;
+    event_data.timeStamp.tag = TIME_STAMP_SEQUENCE;
+    event_data.eventType = EVENT_OUT_OF_RANGE;
+    event_data.notifyType = NOTIFY_ALARM;
+    event_data.fromState = EVENT_STATE_NORMAL;
+    event_data.toState = EVENT_STATE_HIGH_LIMIT;
+    event_data.notificationParams.outOfRange.exceedingValue = 100.0f;
+    event_data.notificationParams.outOfRange.exceededLimit = 50.0f;
+    bitstring_init(&event_data.notificationParams.outOfRange.statusFlags);
+    /* each recipient, with a transaction for the confirmed one */
+    Test_Transactions_Available = 1;
+    Notification_Class_common_reporting_function(&event_data);
+    zassert_equal(Test_Unconfirmed_Notify_Count, 2, NULL);
+    zassert_equal(Test_Confirmed_Notify_Count, 1, NULL);
+    len = event_notify_decode_service_request(
+        Test_Notify_Service_Request, Test_Notify_Service_Request_Len,
+        &test_data);
+    zassert_equal(len, Test_Notify_Service_Request_Len, NULL);
+    zassert_equal(test_data.processIdentifier, 70000, NULL);
+    zassert_equal(test_data.eventObjectIdentifier.instance, 7, NULL);
+    zassert_equal(test_data.toState, EVENT_STATE_HIGH_LIMIT, NULL);
+    Notification_Class_Notify_Statistics(&stats);
+    zassert_equal(stats.sent, 3, NULL);
+    zassert_equal(stats.unbound, 1, NULL);
+    zassert_equal(stats.dropped, 0, NULL);
+    zassert_equal(stats.queued, 0, NULL);
+    /* the confirmed notification waits for a transaction */
+    Notification_Class_common_reporting_function(&event_data);
+    zassert_equal(Test_Unconfirmed_Notify_Count, 4, NULL);
+    zassert_equal(Test_Confirmed_Notify_Count, 1, NULL);
+    Notification_Class_Notify_Statistics(&stats);
+    zassert_equal(stats.queued, 1, NULL);
+    Notification_Class_Notify_Task();
+    zassert_equal(Test_Confirmed_Notify_Count, 1, NULL);
+    Test_Transactions_Available = 1;
+    Notification_Class_Notify_Task();
+    zassert_equal(Test_Confirmed_Notify_Count, 2, NULL);
+    Notification_Class_Notify_Statistics(&stats);
+    zassert_equal(stats.queued, 0, NULL);
+    zassert_equal(stats.sent, 6, NULL);
+    /* in a flood of events, the unconfirmed notifications are sent past
+       the confirmed ones that wait, until the waiting ones hold every
+       encoded event */
+    Notification_Class_Notify_Statistics_Clear();
+    for (i = 0; i < (NC_NOTIFY_EVENTS_MAX + 2); i++) {
+        Notification_Class_common_reporting_function(&event_data);
+    }
+    Notification_Class_Notify_Statistics(&stats);
+    zassert_equal(stats.sent, NC_NOTIFY_EVENTS_MAX * 2, NULL);
+    zassert_equal(stats.queued, NC_NOTIFY_EVENTS_MAX, NULL);
+    zassert_equal(stats.queued_max, NC_NOTIFY_EVENTS_MAX + 2, NULL);
+    zassert_equal(stats.dropped, 2 * 3, NULL);
+    zassert_equal(stats.unbound, NC_NOTIFY_EVENTS_MAX + 2, NULL);
+    Test_Transactions_Available = NC_NOTIFY_QUEUE_SIZE;
+    Notification_Class_Notify_Task();
+    Notification_Class_Notify_Statistics(&stats);
+    zassert_equal(stats.queued, 0, NULL);
+    zassert_equal(stats.sent, NC_NOTIFY_EVENTS_MAX * 3, NULL);
+    /* an unconfirmed notification to a recipient waits behind the
+       confirmed one to the same recipient */
+    recipient_list[4].Recipient.type.device.instance = 200;
+    recipient_list[4].ProcessIdentifier = 3;
+    Notification_Class_Set_Recipient_List(instance, recipient_list);
+    Notification_Class_Notify_Statistics_Clear();
+    Test_Unconfirmed_Notify_Count = 0;
+    Test_Confirmed_Notify_Count = 0;
+    Test_Transactions_Available = 0;
+    Notification_Class_common_reporting_function(&event_data);
+    zassert_equal(Test_Unconfirmed_Notify_Count, 2, NULL);
+    zassert_equal(Test_Confirmed_Notify_Count, 0, NULL);
+    Notification_Class_Notify_Statistics(&stats);
+    zassert_equal(stats.queued, 2, NULL);
+    Test_Transactions_Available = 1;
+    Notification_Class_Notify_Task();
+    zassert_equal(Test_Confirmed_Notify_Count, 1, NULL);
+    zassert_equal(Test_Unconfirmed_Notify_Count, 3, NULL);
+    len = event_notify_decode_service_request(
+        Test_Notify_Service_Request, Test_Notify_Service_Request_Len,
+        &test_data);
+    zassert_equal(len, Test_Notify_Service_Request_Len, NULL);
+    zassert_equal(test_data.processIdentifier, 3, NULL);
+    Notification_Class_Notify_Statistics(&stats);
+    zassert_equal(stats.queued, 0, NULL);
+    zassert_equal(stats.sent, 4, NULL);
+}
 /**
  * @}
  */
@@ -142,7 +281,8 @@ ZTEST_SUITE(notification_class_tests, NULL, NULL, NULL, NULL, NULL);
 void test_main(void)
 {
     ztest_test_suite(
-        notification_class_tests, ztest_unit_test(test_Notification_Class));
+        notification_class_tests, ztest_unit_test(test_Notification_Class),
+        ztest_unit_test(test_Notification_Class_Notify));
 
     ztest_run_test_suite(notification_class_tests);
 }
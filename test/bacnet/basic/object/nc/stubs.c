@@ -8,6 +8,7 @@
  */
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include "bacnet/datetime.h"
 #include "bacnet/bacdef.h"
 #include "bacnet/npdu.h"
@@ -18,23 +19,55 @@ uint32_t Device_Object_Instance_Number(void)
     return 0;
 }
 
-int Send_UEvent_Notify(
+/* notifications sent, and the service request of the last one */
+unsigned Test_Confirmed_Notify_Count;
+unsigned Test_Unconfirmed_Notify_Count;
+uint8_t Test_Notify_Service_Request[MAX_APDU];
+uint16_t Test_Notify_Service_Request_Len;
+/* number of free transactions */
+unsigned Test_Transactions_Available = 1;
+
+int Send_UEvent_Notify_Service_Request(
     uint8_t *buffer,
-    const BACNET_EVENT_NOTIFICATION_DATA *data,
+    uint16_t buffer_size,
+    const uint8_t *service_request,
+    uint16_t service_request_len,
     BACNET_ADDRESS *dest)
 {
     (void)buffer;
-    (void)data;
+    (void)buffer_size;
     (void)dest;
-    return 0;
+    memcpy(Test_Notify_Service_Request, service_request, service_request_len);
+    Test_Notify_Service_Request_Len = service_request_len;
+    Test_Unconfirmed_Notify_Count++;
+
+    return service_request_len;
 }
 
-uint8_t
-Send_CEvent_Notify(uint32_t device_id, BACNET_EVENT_NOTIFICATION_DATA *data)
+uint8_t Send_CEvent_Notify_Service_Request(
+    uint8_t *pdu,
+    uint16_t pdu_size,
+    const uint8_t *service_request,
+    uint16_t service_request_len,
+    BACNET_ADDRESS *dest)
 {
-    (void)device_id;
-    (void)data;
-    return 0;
+    (void)pdu;
+    (void)pdu_size;
+    (void)dest;
+    if (Test_Transactions_Available == 0) {
+        return 0;
+    }
+    Test_Transactions_Available--;
+    memcpy(Test_Notify_Service_Request, service_request, service_request_len);
+    Test_Notify_Service_Request_Len = service_request_len;
+    Test_Confirmed_Notify_Count++;
+
+    return 1;
+}
+
+bool tsm_transaction_available(void)
+{
+    return Test_Transactions_Available > 0;
 }
 
 void Send_WhoIs(int32_t low_limit, int32_t high_limit)
@@ -49,9 +82,9 @@ bool datetime_local(
     int16_t *utc_offset_minutes,
     bool *dst_active)
 {
-    (void)bdate;
-    (void)btime;
     (void)utc_offset_minutes;
     (void)dst_active;
+    datetime_set_date(bdate, 2024, 1, 1);
+    datetime_set_time(btime, 12, 0, 0, 0);
     return true;
 }
@@ -37,6 +37,136 @@ static void test_Trend_Log_ReadProperty(void)
         Trend_Log_Read_Property, Trend_Log_Write_Property,
         known_fail_property_list);
 }
+
+#define TEST_BUFFER_SIZE 100000
+static TL_DATA_REC Test_Records[TEST_BUFFER_SIZE];
+
+/**
+ * @brief Read a range of a Trend Log by time
+ */
+static int test_Trend_Log_Read_By_Time(
+    uint32_t object_instance,
+    bacnet_time_t tRefTime,
+    int32_t count,
+    BACNET_READ_RANGE_DATA *request)
+{
+    static uint8_t apdu[MAX_APDU];
+
+    memset(request, 0, sizeof(BACNET_READ_RANGE_DATA));
+    request->object_type = OBJECT_TRENDLOG;
+    request->object_instance = object_instance;
+    request->object_property = PROP_LOG_BUFFER;
+    request->array_index = BACNET_ARRAY_ALL;
+    request->RequestType = RR_BY_TIME;
+    request->Count = count;
+    request->Overhead = 20;
+    TL_Local_Time_To_BAC(&request->Range.RefTime, tRefTime);
+
+    return rr_trend_log_encode(apdu, request);
+}
+
+/**
+ * @brief Test a log buffer set by the application, searched by time
+ */
+static void test_Trend_Log_Buffer(void)
+{
+    TL_LOG_STATE state = { 0 };
+    BACNET_READ_RANGE_DATA request;
+    BACNET_DATE_TIME bdatetime;
+    bacnet_time_t tStart;
+    uint32_t object_instance;
+    uint32_t i, oldest;
+    int len;
+    bool status;
+
+    Trend_Log_Init();
+    object_instance = Trend_Log_Index_To_Instance(0);
+    zassert_equal(
+        Trend_Log_Buffer_Size(object_instance), TL_MAX_ENTRIES, NULL);
+    /* a full log that has wrapped, one record a minute, with the oldest
+       record at the insertion point */
+    datetime_set_values(&bdatetime, 2024, 1, 1, 0, 0, 0, 0);
+    tStart = datetime_seconds_since_epoch(&bdatetime);
+    oldest = 12345;
+    for (i = 0; i < TEST_BUFFER_SIZE; i++) {
+        Test_Records[(oldest + i) % TEST_BUFFER_SIZE].tTimeStamp =
+            tStart + (i * 60);
+        Test_Records[(oldest + i) % TEST_BUFFER_SIZE].ucRecType =
+            TL_TYPE_UNSIGN;
+        Test_Records[(oldest + i) % TEST_BUFFER_SIZE].Datum.ulUValue = i;
+    }
+    state.ulBufferSize = TEST_BUFFER_SIZE;
+    state.ulIndex = oldest;
+    state.ulRecordCount = TEST_BUFFER_SIZE;
+    state.ulTotalRecordCount = 250000;
+    status = Trend_Log_Buffer_Set(
+        object_instance, Test_Records, TEST_BUFFER_SIZE, &state);
+    zassert_true(status, NULL);
+    zassert_equal(
+        Trend_Log_Buffer_Size(object_instance), TEST_BUFFER_SIZE, NULL);
+    /* records after a time, which is between two records */
+    len = test_Trend_Log_Read_By_Time(
+        object_instance, tStart + (5000 * 60) + 30, 10, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 10, NULL);
+    /* sequence number of the oldest record is 150001 */
+    zassert_equal(request.FirstSequence, 150001 + 5001, NULL);
+    /* records after a time which matches a record */
+    len = test_Trend_Log_Read_By_Time(
+        object_instance, tStart + (5000 * 60), 10, &request);
+    zassert_equal(request.FirstSequence, 150001 + 5001, NULL);
+    /* records before a time which matches a record */
+    len = test_Trend_Log_Read_By_Time(
+        object_instance, tStart + (5000 * 60), -10, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 10, NULL);
+    zassert_equal(request.FirstSequence, 150001 + 4990, NULL);
+    /* records before a time near the start are pinned to the start */
+    len = test_Trend_Log_Read_By_Time(
+        object_instance, tStart + (3 * 60), -10, &request);
+    zassert_equal(request.ItemCount, 3, NULL);
+    zassert_equal(request.FirstSequence, 150001, NULL);
+    zassert_true(
+        bitstring_bit(&request.ResultFlags, RESULT_FLAG_FIRST_ITEM), NULL);
+    /* records after the last record, and before the first record */
+    len = test_Trend_Log_Read_By_Time(
+        object_instance, tStart + (TEST_BUFFER_SIZE * 60), 10, &request);
+    zassert_equal(len, 0, NULL);
+    zassert_equal(request.ItemCount, 0, NULL);
+    len = test_Trend_Log_Read_By_Time(object_instance, tStart, -10, &request);
+    zassert_equal(len, 0, NULL);
+    /* the last records */
+    len = test_Trend_Log_Read_By_Time(
+        object_instance, tStart + ((TEST_BUFFER_SIZE - 3) * 60), 10,
+        &request);
+    zassert_equal(request.ItemCount, 2, NULL);
+    zassert_equal(request.FirstSequence, 249999, NULL);
+    zassert_true(
+        bitstring_bit(&request.ResultFlags, RESULT_FLAG_LAST_ITEM), NULL);
+    /* new records update the state kept with the records */
+    TL_Insert_Status_Rec(0, LOG_STATUS_BUFFER_PURGED, true);
+    zassert_equal(state.ulIndex, oldest + 1, NULL);
+    zassert_equal(state.ulRecordCount, TEST_BUFFER_SIZE, NULL);
+    zassert_equal(state.ulTotalRecordCount, 250001, NULL);
+    /* a state for another buffer size starts out empty */
+    state.ulBufferSize = TEST_BUFFER_SIZE / 2;
+    status = Trend_Log_Buffer_Set(
+        object_instance, Test_Records, TEST_BUFFER_SIZE, &state);
+    zassert_true(status, NULL);
+    zassert_equal(state.ulBufferSize, TEST_BUFFER_SIZE, NULL);
+    zassert_equal(state.ulRecordCount, 0, NULL);
+    zassert_equal(state.ulTotalRecordCount, 250001, NULL);
+    /* back to the built in buffer */
+    status = Trend_Log_Buffer_Set(object_instance, NULL, 0, NULL);
+    zassert_true(status, NULL);
+    zassert_equal(
+        Trend_Log_Buffer_Size(object_instance), TL_MAX_ENTRIES, NULL);
+    status = Trend_Log_Buffer_Set(object_instance, Test_Records, 0, NULL);
+    zassert_false(status, NULL);
+    status = Trend_Log_Buffer_Set(
+        Trend_Log_Count(), Test_Records, TEST_BUFFER_SIZE, NULL);
+    zassert_false(status, NULL);
+}
 /**
  * @}
  */
@@ -44,7 +174,8 @@ static void test_Trend_Log_ReadProperty(void)
 void test_main(void)
 {
     ztest_test_suite(
-        trendlog_tests, ztest_unit_test(test_Trend_Log_ReadProperty));
+        trendlog_tests, ztest_unit_test(test_Trend_Log_ReadProperty),
+        ztest_unit_test(test_Trend_Log_Buffer));
 
     ztest_run_test_suite(trendlog_tests);
 }
@@ -0,0 +1,271 @@
+/**
+ * @file
+ * @brief test the request counters and handler times of the APDU handler
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/apdu.h>
+#include <bacnet/bacapp.h>
+#include <bacnet/basic/object/device.h>
+#include <bacnet/basic/service/h_apdu.h>
+#include <bacnet/basic/service/h_noserv.h>
+#include <bacnet/basic/service/h_rp.h>
+#include <bacnet/rp.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* number of PDUs sent, from stubs.c */
+extern unsigned Test_Sent_PDU_Count;
+
+/* fake clock, which moves on by the step each time it is read */
+static uint32_t Test_Microseconds;
+static uint32_t Test_Microseconds_Step;
+
+static uint32_t test_microseconds(void)
+{
+    Test_Microseconds += Test_Microseconds_Step;
+
+    return Test_Microseconds;
+}
+
+/**
+ * @brief Prepare the device, the service handlers, and the counters
+ */
+static void test_setup(void)
+{
+    Device_Init(NULL);
+    apdu_set_unrecognized_service_handler_handler(handler_unrecognized_service);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_READ_PROPERTY, handler_read_property);
+    apdu_statistics_timer_set(test_microseconds);
+    apdu_statistics_sample_rate_set(1);
+    apdu_statistics_clear();
+    Test_Microseconds = 0;
+    Test_Microseconds_Step = 10;
+    Test_Sent_PDU_Count = 0;
+}
+
+/**
+ * @brief Give a ReadProperty request to the APDU handler
+ * @param object_type [in] object type
+ * @param object_instance [in] object instance
+ */
+static void test_read_property(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t apdu[MAX_APDU] = { 0 };
+    int apdu_len;
+
+    rpdata.object_type = object_type;
+    rpdata.object_instance = object_instance;
+    rpdata.object_property = PROP_OBJECT_NAME;
+    rpdata.array_index = BACNET_ARRAY_ALL;
+    apdu_len = rp_encode_apdu(apdu, 1, &rpdata);
+    zassert_true(apdu_len > 0, NULL);
+    apdu_handler(&src, apdu, (uint16_t)apdu_len);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_apdu_tests, testAPDUStatisticsCounters)
+#else
+static void testAPDUStatisticsCounters(void)
+#endif
+{
+    BACNET_APDU_SERVICE_STATISTICS stats = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t apdu[MAX_APDU] = { 0 };
+    bool status;
+
+    test_setup();
+    /* a value, then an error for an object that does not exist */
+    test_read_property(OBJECT_DEVICE, Device_Object_Instance_Number());
+    test_read_property(OBJECT_ANALOG_VALUE, 4194302);
+    zassert_equal(Test_Sent_PDU_Count, 2, NULL);
+    status = apdu_statistics_confirmed(SERVICE_CONFIRMED_READ_PROPERTY, &stats);
+    zassert_true(status, NULL);
+    zassert_equal(stats.requests, 2, NULL);
+    zassert_equal(stats.errors, 1, NULL);
+    zassert_equal(stats.rejects, 0, NULL);
+    zassert_equal(stats.aborts, 0, NULL);
+    zassert_equal(stats.samples, 2, NULL);
+    zassert_equal(stats.max_microseconds, 10, NULL);
+    /* a service without a handler is rejected */
+    apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+    apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+    apdu[2] = 2;
+    apdu[3] = SERVICE_CONFIRMED_VT_OPEN;
+    apdu_handler(&src, apdu, 4);
+    status = apdu_statistics_confirmed(SERVICE_CONFIRMED_VT_OPEN, &stats);
+    zassert_true(status, NULL);
+    zassert_equal(stats.requests, 1, NULL);
+    zassert_equal(stats.rejects, 1, NULL);
+    zassert_equal(stats.errors, 0, NULL);
+    /* unconfirmed services are counted with or without a handler */
+    apdu[0] = PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST;
+    apdu[1] = SERVICE_UNCONFIRMED_WHO_IS;
+    apdu_handler(&src, apdu, 2);
+    apdu_handler(&src, apdu, 2);
+    status = apdu_statistics_unconfirmed(SERVICE_UNCONFIRMED_WHO_IS, &stats);
+    zassert_true(status, NULL);
+    zassert_equal(stats.requests, 2, NULL);
+    zassert_equal(stats.samples, 2, NULL);
+    /* unknown services */
+    status = apdu_statistics_confirmed(MAX_BACNET_CONFIRMED_SERVICE, &stats);
+    zassert_false(status, NULL);
+    status =
+        apdu_statistics_unconfirmed(MAX_BACNET_UNCONFIRMED_SERVICE, &stats);
+    zassert_false(status, NULL);
+    /* cleared */
+    apdu_statistics_clear();
+    status = apdu_statistics_confirmed(SERVICE_CONFIRMED_READ_PROPERTY, &stats);
+    zassert_true(status, NULL);
+    zassert_equal(stats.requests, 0, NULL);
+    zassert_equal(stats.errors, 0, NULL);
+    zassert_equal(stats.samples, 0, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_apdu_tests, testAPDUStatisticsSampling)
+#else
+static void testAPDUStatisticsSampling(void)
+#endif
+{
+    BACNET_APDU_SERVICE_STATISTICS stats = { 0 };
+    unsigned i;
+
+    test_setup();
+    apdu_statistics_sample_rate_set(4);
+    zassert_equal(apdu_statistics_sample_rate(), 4, NULL);
+    apdu_statistics_sample_rate_set(0);
+    zassert_equal(apdu_statistics_sample_rate(), 4, NULL);
+    for (i = 0; i < 8; i++) {
+        test_read_property(OBJECT_DEVICE, Device_Object_Instance_Number());
+    }
+    apdu_statistics_confirmed(SERVICE_CONFIRMED_READ_PROPERTY, &stats);
+    zassert_equal(stats.requests, 8, NULL);
+    zassert_equal(stats.samples, 2, NULL);
+    /* without a clock, requests are only counted */
+    apdu_statistics_timer_set(NULL);
+    test_read_property(OBJECT_DEVICE, Device_Object_Instance_Number());
+    apdu_statistics_confirmed(SERVICE_CONFIRMED_READ_PROPERTY, &stats);
+    zassert_equal(stats.requests, 9, NULL);
+    zassert_equal(stats.samples, 2, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_apdu_tests, testAPDUStatisticsHistogram)
+#else
+static void testAPDUStatisticsHistogram(void)
+#endif
+{
+    BACNET_APDU_SERVICE_STATISTICS stats = { 0 };
+    uint32_t microseconds, previous = 0;
+    unsigned i;
+
+    /* each bucket is longer than the one before, and within 25% */
+    for (i = 0; i < APDU_STATISTICS_BUCKETS - 1; i++) {
+        microseconds = apdu_statistics_bucket_microseconds(i);
+        if (i > 0) {
+            zassert_true(microseconds > previous, "i=%u", i);
+            zassert_true(
+                (microseconds - previous) <= ((previous / 4) + 1), "i=%u", i);
+        }
+        previous = microseconds;
+    }
+    zassert_equal(
+        apdu_statistics_bucket_microseconds(APDU_STATISTICS_BUCKETS - 1),
+        UINT32_MAX, NULL);
+    test_setup();
+    for (i = 0; i < 99; i++) {
+        test_read_property(OBJECT_DEVICE, Device_Object_Instance_Number());
+    }
+    Test_Microseconds_Step = 1000;
+    test_read_property(OBJECT_DEVICE, Device_Object_Instance_Number());
+    apdu_statistics_confirmed(SERVICE_CONFIRMED_READ_PROPERTY, &stats);
+    zassert_equal(stats.samples, 100, NULL);
+    zassert_equal(stats.max_microseconds, 1000, NULL);
+    /* 10 microseconds is in the bucket of 10 and 11 microseconds */
+    zassert_equal(apdu_statistics_percentile(&stats, 50), 11, NULL);
+    zassert_equal(apdu_statistics_percentile(&stats, 99), 11, NULL);
+    zassert_equal(apdu_statistics_percentile(&stats, 100), 1000, NULL);
+    zassert_equal(apdu_statistics_percentile(NULL, 99), 0, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_apdu_tests, testAPDUStatisticsDeviceProperties)
+#else
+static void testAPDUStatisticsDeviceProperties(void)
+#endif
+{
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+    uint8_t apdu[MAX_APDU] = { 0 };
+    int len;
+
+    test_setup();
+    test_read_property(OBJECT_DEVICE, Device_Object_Instance_Number());
+    test_read_property(OBJECT_ANALOG_VALUE, 4194302);
+    rpdata.object_type = OBJECT_DEVICE;
+    rpdata.object_instance = Device_Object_Instance_Number();
+    rpdata.application_data = apdu;
+    rpdata.application_data_len = sizeof(apdu);
+    /* array size */
+    rpdata.object_property = PROP_DEVICE_CONFIRMED_REQUESTS;
+    rpdata.array_index = 0;
+    len = Device_Read_Property(&rpdata);
+    zassert_true(len > 0, NULL);
+    bacapp_decode_application_data(apdu, (unsigned)len, &value);
+    zassert_equal(value.type.Unsigned_Int, MAX_BACNET_CONFIRMED_SERVICE, NULL);
+    /* array index 1 is the service choice of 0 */
+    rpdata.array_index = SERVICE_CONFIRMED_READ_PROPERTY + 1;
+    len = Device_Read_Property(&rpdata);
+    zassert_true(len > 0, NULL);
+    bacapp_decode_application_data(apdu, (unsigned)len, &value);
+    zassert_equal(value.type.Unsigned_Int, 2, NULL);
+    rpdata.object_property = PROP_DEVICE_CONFIRMED_FAILURES;
+    len = Device_Read_Property(&rpdata);
+    zassert_true(len > 0, NULL);
+    bacapp_decode_application_data(apdu, (unsigned)len, &value);
+    zassert_equal(value.type.Unsigned_Int, 1, NULL);
+    rpdata.object_property = PROP_DEVICE_CONFIRMED_LATENCY;
+    len = Device_Read_Property(&rpdata);
+    zassert_true(len > 0, NULL);
+    bacapp_decode_application_data(apdu, (unsigned)len, &value);
+    zassert_equal(value.type.Unsigned_Int, 10, NULL);
+    /* the whole array */
+    rpdata.object_property = PROP_DEVICE_UNCONFIRMED_REQUESTS;
+    rpdata.array_index = BACNET_ARRAY_ALL;
+    len = Device_Read_Property(&rpdata);
+    zassert_true(len >= MAX_BACNET_UNCONFIRMED_SERVICE * 2, NULL);
+    /* past the end of the array */
+    rpdata.array_index = MAX_BACNET_UNCONFIRMED_SERVICE + 1;
+    len = Device_Read_Property(&rpdata);
+    zassert_equal(len, BACNET_STATUS_ERROR, NULL);
+    zassert_equal(rpdata.error_code, ERROR_CODE_INVALID_ARRAY_INDEX, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(h_apdu_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        h_apdu_tests, ztest_unit_test(testAPDUStatisticsCounters),
+        ztest_unit_test(testAPDUStatisticsSampling),
+        ztest_unit_test(testAPDUStatisticsHistogram),
+        ztest_unit_test(testAPDUStatisticsDeviceProperties));
+
+    ztest_run_test_suite(h_apdu_tests);
+}
+#endif
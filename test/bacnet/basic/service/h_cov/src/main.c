@@ -0,0 +1,149 @@
+/**
+ * @file
+ * @brief test the event-driven COV handler, which checks only the
+ *  objects that report a change with handler_cov_change_notify()
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/bacaddr.h>
+#include <bacnet/cov.h>
+#include <bacnet/basic/object/av.h>
+#include <bacnet/basic/service/h_cov.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* the PDUs that were sent, and their destinations, from stubs.c */
+#define TEST_SENT_MAX 16
+extern unsigned Test_Sent_Count;
+extern BACNET_ADDRESS Test_Sent_Dest[TEST_SENT_MAX];
+
+/**
+ * @brief Make an address of a subscriber
+ * @param src - the address
+ * @param mac - the last octet of its MAC address
+ */
+static void test_cov_src(BACNET_ADDRESS *src, uint8_t mac)
+{
+    memset(src, 0, sizeof(BACNET_ADDRESS));
+    src->mac_len = 1;
+    src->mac[0] = mac;
+}
+
+/**
+ * @brief Subscribe for unconfirmed notifications of an Analog Value
+ * @param mac - the last octet of the MAC address of the subscriber
+ * @param object_instance - the Analog Value that is monitored
+ */
+static void test_cov_subscribe(uint8_t mac, uint32_t object_instance)
+{
+    BACNET_SUBSCRIBE_COV_DATA data = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t apdu[MAX_APDU] = { 0 };
+    size_t apdu_len;
+
+    test_cov_src(&src, mac);
+    data.subscriberProcessIdentifier = 1;
+    data.monitoredObjectIdentifier.type = OBJECT_ANALOG_VALUE;
+    data.monitoredObjectIdentifier.instance = object_instance;
+    data.cancellationRequest = false;
+    data.issueConfirmedNotifications = false;
+    data.lifetime = 300;
+    apdu_len = cov_subscribe_service_request_encode(apdu, sizeof(apdu), &data);
+    zassert_true(apdu_len > 0, NULL);
+    service_data.invoke_id = mac;
+    handler_cov_subscribe(apdu, (uint16_t)apdu_len, &src, &service_data);
+}
+
+/**
+ * @brief Run the COV task, and count the notifications that were sent
+ * @return number of notifications
+ */
+static unsigned test_cov_notifications(void)
+{
+    Test_Sent_Count = 0;
+    handler_cov_task();
+
+    return Test_Sent_Count;
+}
+
+/**
+ * @brief Determine if a notification was sent to a subscriber
+ * @param mac - the last octet of the MAC address of the subscriber
+ * @return true if it was sent
+ */
+static bool test_cov_sent_to(uint8_t mac)
+{
+    BACNET_ADDRESS dest = { 0 };
+    unsigned i;
+
+    test_cov_src(&dest, mac);
+    for (i = 0; (i < Test_Sent_Count) && (i < TEST_SENT_MAX); i++) {
+        if (bacnet_address_same(&dest, &Test_Sent_Dest[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_cov_tests, testCOVChangeNotify)
+#else
+static void testCOVChangeNotify(void)
+#endif
+{
+    Analog_Value_Init();
+    Analog_Value_Create(1);
+    Analog_Value_Create(2);
+    Analog_Value_COV_Increment_Set(1, 1.0f);
+    Analog_Value_COV_Increment_Set(2, 1.0f);
+    handler_cov_init();
+    /* three subscribers to the first object, and one to the second */
+    test_cov_subscribe(1, 1);
+    test_cov_subscribe(2, 1);
+    test_cov_subscribe(3, 1);
+    test_cov_subscribe(4, 2);
+    /* each subscription gets an initial notification */
+    zassert_equal(test_cov_notifications(), 4, NULL);
+    zassert_equal(test_cov_notifications(), 0, NULL);
+    /* a change that the setter reports goes to every subscriber */
+    Analog_Value_Present_Value_Set(1, 10.0f, BACNET_MAX_PRIORITY);
+    zassert_equal(test_cov_notifications(), 3, NULL);
+    zassert_true(test_cov_sent_to(1), NULL);
+    zassert_true(test_cov_sent_to(2), NULL);
+    zassert_true(test_cov_sent_to(3), NULL);
+    zassert_false(test_cov_sent_to(4), NULL);
+    zassert_equal(test_cov_notifications(), 0, NULL);
+    /* a write that is within the COV increment is not a change */
+    Analog_Value_Present_Value_Set(1, 10.5f, BACNET_MAX_PRIORITY);
+    zassert_equal(test_cov_notifications(), 0, NULL);
+    /* only the subscribers of the object that changed are notified */
+    Analog_Value_Present_Value_Set(2, 10.0f, BACNET_MAX_PRIORITY);
+    zassert_equal(test_cov_notifications(), 1, NULL);
+    zassert_true(test_cov_sent_to(4), NULL);
+    /* a change of the status flags is reported too */
+    Analog_Value_Out_Of_Service_Set(1, true);
+    zassert_equal(test_cov_notifications(), 3, NULL);
+    zassert_equal(test_cov_notifications(), 0, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(h_cov_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(h_cov_tests, ztest_unit_test(testCOVChangeNotify));
+
+    ztest_run_test_suite(h_cov_tests);
+}
+#endif
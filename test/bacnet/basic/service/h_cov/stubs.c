@@ -0,0 +1,145 @@
+/**
+ * @file
+ * @brief stubs for the event-driven COV handler tests, which monitor
+ *  Analog Value objects
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "bacnet/bacdef.h"
+#include "bacnet/bacaddr.h"
+#include "bacnet/datetime.h"
+#include "bacnet/npdu.h"
+#include "bacnet/basic/object/av.h"
+
+uint8_t Handler_Transmit_Buffer[MAX_PDU];
+/* the PDUs that were sent, and the destination of each */
+#define TEST_SENT_MAX 16
+unsigned Test_Sent_Count;
+BACNET_ADDRESS Test_Sent_Dest[TEST_SENT_MAX];
+
+bool datetime_local(
+    BACNET_DATE *bdate,
+    BACNET_TIME *btime,
+    int16_t *utc_offset_minutes,
+    bool *dst_active)
+{
+    (void)bdate;
+    (void)btime;
+    (void)utc_offset_minutes;
+    (void)dst_active;
+
+    return false;
+}
+
+void bip_get_my_address(BACNET_ADDRESS *my_address)
+{
+    memset(my_address, 0, sizeof(BACNET_ADDRESS));
+}
+
+int bip_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    (void)npdu_data;
+    (void)pdu;
+    if (Test_Sent_Count < TEST_SENT_MAX) {
+        bacnet_address_copy(&Test_Sent_Dest[Test_Sent_Count], dest);
+    }
+    Test_Sent_Count++;
+
+    return (int)pdu_len;
+}
+
+uint32_t Device_Object_Instance_Number(void)
+{
+    return 1234;
+}
+
+bool Device_Valid_Object_Id(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    return (object_type == OBJECT_ANALOG_VALUE) &&
+        Analog_Value_Valid_Instance(object_instance);
+}
+
+bool Device_Value_List_Supported(BACNET_OBJECT_TYPE object_type)
+{
+    return object_type == OBJECT_ANALOG_VALUE;
+}
+
+bool Device_COV(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    if (object_type == OBJECT_ANALOG_VALUE) {
+        return Analog_Value_Change_Of_Value(object_instance);
+    }
+
+    return false;
+}
+
+void Device_COV_Clear(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    if (object_type == OBJECT_ANALOG_VALUE) {
+        Analog_Value_Change_Of_Value_Clear(object_instance);
+    }
+}
+
+bool Device_Encode_Value_List(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE *value_list)
+{
+    if (object_type == OBJECT_ANALOG_VALUE) {
+        return Analog_Value_Encode_Value_List(object_instance, value_list);
+    }
+
+    return false;
+}
+
+bool tsm_transaction_available(void)
+{
+    return true;
+}
+
+uint8_t tsm_next_free_invokeID(void)
+{
+    return 1;
+}
+
+void tsm_set_confirmed_unsegmented_transaction(
+    uint8_t invokeID,
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *ndpu_data,
+    const uint8_t *apdu,
+    uint16_t apdu_len)
+{
+    (void)invokeID;
+    (void)dest;
+    (void)ndpu_data;
+    (void)apdu;
+    (void)apdu_len;
+}
+
+void tsm_free_invoke_id(uint8_t invokeID)
+{
+    (void)invokeID;
+}
+
+bool tsm_invoke_id_free(uint8_t invokeID)
+{
+    (void)invokeID;
+
+    return true;
+}
+
+bool tsm_invoke_id_failed(uint8_t invokeID)
+{
+    (void)invokeID;
+
+    return false;
+}
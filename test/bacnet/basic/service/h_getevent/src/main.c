@@ -0,0 +1,353 @@
+/**
+ * @file
+ * @brief test the active event index of the GetEventInformation and
+ *  GetAlarmSummary service handlers
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/apdu.h>
+#include <bacnet/bacapp.h>
+#include <bacnet/get_alarm_sum.h>
+#include <bacnet/getevent.h>
+#include <bacnet/npdu.h>
+#include <bacnet/basic/object/ai.h>
+#include <bacnet/basic/service/h_get_alarm_sum.h>
+#include <bacnet/basic/service/h_getevent.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* the last PDU that was sent, from stubs.c */
+extern uint8_t Test_Sent_PDU[MAX_PDU];
+extern unsigned Test_Sent_PDU_Len;
+
+/* number of objects, and the objects that are in alarm */
+#define TEST_OBJECTS_MAX 32
+static const uint32_t Test_Alarm_Instance[] = { 3, 7, 15, 20, 31 };
+#define TEST_ALARMS_MAX \
+    (sizeof(Test_Alarm_Instance) / sizeof(Test_Alarm_Instance[0]))
+
+static unsigned test_instance_to_index(uint32_t object_instance)
+{
+    return (unsigned)object_instance;
+}
+
+/**
+ * @brief Write a property of an analog input
+ * @param instance [in] instance of the analog input
+ * @param property [in] property to write
+ * @param value [in] value to write
+ */
+static void test_write_property(
+    uint32_t instance,
+    BACNET_PROPERTY_ID property,
+    BACNET_APPLICATION_DATA_VALUE *value)
+{
+    BACNET_WRITE_PROPERTY_DATA wp_data = { 0 };
+    bool status;
+
+    wp_data.object_type = OBJECT_ANALOG_INPUT;
+    wp_data.object_instance = instance;
+    wp_data.object_property = property;
+    wp_data.array_index = BACNET_ARRAY_ALL;
+    wp_data.priority = BACNET_NO_PRIORITY;
+    wp_data.application_data_len = bacapp_encode_application_data(
+        wp_data.application_data, value);
+    status = Analog_Input_Write_Property(&wp_data);
+    zassert_true(status, NULL);
+}
+
+/**
+ * @brief Create the analog inputs, with a high limit alarm in some
+ */
+static void test_setup(void)
+{
+    BACNET_APPLICATION_DATA_VALUE high_limit = { 0 };
+    BACNET_APPLICATION_DATA_VALUE limit_enable = { 0 };
+    BACNET_APPLICATION_DATA_VALUE event_enable = { 0 };
+    uint32_t instance;
+    unsigned i;
+
+    high_limit.tag = BACNET_APPLICATION_TAG_REAL;
+    high_limit.type.Real = 50.0f;
+    limit_enable.tag = BACNET_APPLICATION_TAG_BIT_STRING;
+    bitstring_init(&limit_enable.type.Bit_String);
+    bitstring_set_bit(&limit_enable.type.Bit_String, 0, false);
+    bitstring_set_bit(&limit_enable.type.Bit_String, 1, true);
+    event_enable.tag = BACNET_APPLICATION_TAG_BIT_STRING;
+    bitstring_init(&event_enable.type.Bit_String);
+    for (i = 0; i < MAX_BACNET_EVENT_TRANSITION; i++) {
+        bitstring_set_bit(&event_enable.type.Bit_String, i, true);
+    }
+    Analog_Input_Init();
+    for (instance = 0; instance < TEST_OBJECTS_MAX; instance++) {
+        Analog_Input_Create(instance);
+        test_write_property(instance, PROP_HIGH_LIMIT, &high_limit);
+        test_write_property(instance, PROP_LIMIT_ENABLE, &limit_enable);
+        test_write_property(instance, PROP_EVENT_ENABLE, &event_enable);
+        Analog_Input_Present_Value_Set(instance, 0.0f);
+    }
+    for (i = 0; i < TEST_ALARMS_MAX; i++) {
+        Analog_Input_Present_Value_Set(Test_Alarm_Instance[i], 100.0f);
+    }
+    for (instance = 0; instance < TEST_OBJECTS_MAX; instance++) {
+        Analog_Input_Intrinsic_Reporting(instance);
+    }
+}
+
+/**
+ * @brief Find the service data of the complex ACK that was sent
+ * @param service [in] service choice of the ACK
+ * @param apdu_len [out] length of the service data
+ * @return the service data, or NULL if an ACK was not sent
+ */
+static uint8_t *test_sent_ack(uint8_t service, int *apdu_len)
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    int len;
+
+    len = bacnet_npdu_decode(
+        Test_Sent_PDU, Test_Sent_PDU_Len, &dest, NULL, &npdu_data);
+    if ((len <= 0) || ((unsigned)(len + 3) > Test_Sent_PDU_Len) ||
+        (Test_Sent_PDU[len] != PDU_TYPE_COMPLEX_ACK) ||
+        (Test_Sent_PDU[len + 2] != service)) {
+        return NULL;
+    }
+    *apdu_len = (int)Test_Sent_PDU_Len - (len + 3);
+
+    return &Test_Sent_PDU[len + 3];
+}
+
+/**
+ * @brief Request one reply of GetEventInformation
+ * @param last [in] the 'Last Received Object Identifier', or NULL
+ * @param max_resp [in] largest APDU accepted by the client
+ * @param instance [out] instances of the events in the reply
+ * @param more_events [out] true if there are more events
+ * @return number of events in the reply
+ */
+static unsigned test_get_event_information(
+    BACNET_OBJECT_ID *last,
+    int max_resp,
+    uint32_t *instance,
+    bool *more_events)
+{
+    BACNET_GET_EVENT_INFORMATION_DATA data[TEST_OBJECTS_MAX] = { 0 };
+    BACNET_GET_EVENT_INFORMATION_DATA *event_data;
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t request[MAX_APDU] = { 0 };
+    uint8_t *apdu;
+    int request_len, apdu_len = 0, len;
+    unsigned count = 0, i;
+
+    request_len = (int)getevent_service_request_encode(
+        request, sizeof(request), last);
+    service_data.max_resp = max_resp;
+    service_data.invoke_id = 1;
+    Test_Sent_PDU_Len = 0;
+    handler_get_event_information(
+        request, (uint16_t)request_len, &src, &service_data);
+    apdu = test_sent_ack(SERVICE_CONFIRMED_GET_EVENT_INFORMATION, &apdu_len);
+    zassert_not_null(apdu, NULL);
+    for (i = 0; i < (TEST_OBJECTS_MAX - 1); i++) {
+        data[i].next = &data[i + 1];
+    }
+    len = getevent_ack_decode_service_request(
+        apdu, apdu_len, &data[0], more_events);
+    zassert_true(len > 0, NULL);
+    event_data = &data[0];
+    while (event_data) {
+        zassert_equal(
+            event_data->objectIdentifier.type, OBJECT_ANALOG_INPUT, NULL);
+        instance[count] = event_data->objectIdentifier.instance;
+        count++;
+        event_data = event_data->next;
+    }
+
+    return count;
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_getevent_tests, testActiveEventList)
+#else
+static void testActiveEventList(void)
+#endif
+{
+    uint32_t instance = BACNET_MAX_INSTANCE;
+    unsigned index = 0;
+    unsigned count;
+
+    count = handler_get_event_information_active_count();
+    /* without an index, the objects of a type are not listed */
+    zassert_false(handler_get_event_information_indexed(OBJECT_LOOP), NULL);
+    handler_get_event_information_active_set(OBJECT_LOOP, 2, true);
+    zassert_false(
+        handler_get_event_information_active_next(
+            OBJECT_LOOP, &instance, &index),
+        NULL);
+    handler_get_event_information_index_set(
+        OBJECT_LOOP, test_instance_to_index);
+    zassert_true(handler_get_event_information_indexed(OBJECT_LOOP), NULL);
+    handler_get_event_information_active_set(OBJECT_LOOP, 9, true);
+    handler_get_event_information_active_set(OBJECT_LOOP, 5, true);
+    handler_get_event_information_active_set(OBJECT_LOOP, 5, true);
+    handler_get_event_information_active_set(
+        OBJECT_LOOP, BACNET_MAX_INSTANCE, true);
+    handler_get_event_information_active_set(MAX_BACNET_OBJECT_TYPE, 1, true);
+    zassert_equal(
+        handler_get_event_information_active_count(), count + 3, NULL);
+    /* in order of instance */
+    zassert_true(
+        handler_get_event_information_active_next(
+            OBJECT_LOOP, &instance, &index),
+        NULL);
+    zassert_equal(instance, 2, NULL);
+    zassert_equal(index, 2, NULL);
+    zassert_true(
+        handler_get_event_information_active_next(
+            OBJECT_LOOP, &instance, NULL),
+        NULL);
+    zassert_equal(instance, 5, NULL);
+    zassert_true(
+        handler_get_event_information_active_next(
+            OBJECT_LOOP, &instance, NULL),
+        NULL);
+    zassert_equal(instance, 9, NULL);
+    zassert_false(
+        handler_get_event_information_active_next(
+            OBJECT_LOOP, &instance, NULL),
+        NULL);
+    /* after an instance that is not listed */
+    instance = 6;
+    zassert_true(
+        handler_get_event_information_active_next(
+            OBJECT_LOOP, &instance, NULL),
+        NULL);
+    zassert_equal(instance, 9, NULL);
+    /* inactive */
+    handler_get_event_information_active_set(OBJECT_LOOP, 2, false);
+    handler_get_event_information_active_set(OBJECT_LOOP, 5, false);
+    handler_get_event_information_active_set(OBJECT_LOOP, 9, false);
+    handler_get_event_information_active_set(OBJECT_LOOP, 9, false);
+    zassert_equal(handler_get_event_information_active_count(), count, NULL);
+    instance = BACNET_MAX_INSTANCE;
+    zassert_false(
+        handler_get_event_information_active_next(
+            OBJECT_LOOP, &instance, NULL),
+        NULL);
+    handler_get_event_information_index_set(OBJECT_LOOP, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_getevent_tests, testGetEventInformation)
+#else
+static void testGetEventInformation(void)
+#endif
+{
+    uint32_t instance[TEST_OBJECTS_MAX] = { 0 };
+    BACNET_OBJECT_ID last = { 0 };
+    bool more_events = true;
+    unsigned count = 0, pages = 0;
+
+    test_setup();
+    zassert_equal(
+        handler_get_event_information_active_count(), TEST_ALARMS_MAX, NULL);
+    /* all of the events in one reply */
+    count = test_get_event_information(NULL, MAX_APDU, instance, &more_events);
+    zassert_equal(count, TEST_ALARMS_MAX, NULL);
+    zassert_false(more_events, NULL);
+    zassert_mem_equal(
+        instance, Test_Alarm_Instance, sizeof(Test_Alarm_Instance), NULL);
+    /* a few events in each reply, after the last one received */
+    count = test_get_event_information(NULL, 206, instance, &more_events);
+    pages++;
+    while (more_events) {
+        zassert_true(count > 0, NULL);
+        last.type = OBJECT_ANALOG_INPUT;
+        last.instance = instance[count - 1];
+        count += test_get_event_information(
+            &last, 206, &instance[count], &more_events);
+        pages++;
+        zassert_true(pages <= TEST_ALARMS_MAX, NULL);
+    }
+    zassert_true(pages > 1, NULL);
+    zassert_equal(count, TEST_ALARMS_MAX, NULL);
+    zassert_mem_equal(
+        instance, Test_Alarm_Instance, sizeof(Test_Alarm_Instance), NULL);
+    /* back to normal */
+    Analog_Input_Present_Value_Set(Test_Alarm_Instance[0], 0.0f);
+    Analog_Input_Intrinsic_Reporting(Test_Alarm_Instance[0]);
+    zassert_equal(
+        handler_get_event_information_active_count(), TEST_ALARMS_MAX - 1,
+        NULL);
+    count = test_get_event_information(NULL, MAX_APDU, instance, &more_events);
+    zassert_equal(count, TEST_ALARMS_MAX - 1, NULL);
+    zassert_equal(instance[0], Test_Alarm_Instance[1], NULL);
+    /* deleted */
+    Analog_Input_Delete(Test_Alarm_Instance[1]);
+    zassert_equal(
+        handler_get_event_information_active_count(), TEST_ALARMS_MAX - 2,
+        NULL);
+    Analog_Input_Cleanup();
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_getevent_tests, testGetAlarmSummary)
+#else
+static void testGetAlarmSummary(void)
+#endif
+{
+    BACNET_GET_ALARM_SUMMARY_DATA data = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t request[1] = { 0 };
+    uint8_t *apdu;
+    int apdu_len = 0, len;
+    unsigned count = 0;
+
+    test_setup();
+    service_data.max_resp = MAX_APDU;
+    service_data.invoke_id = 2;
+    Test_Sent_PDU_Len = 0;
+    /* the handler rejects a request without any service data */
+    handler_get_alarm_summary(request, sizeof(request), &src, &service_data);
+    apdu = test_sent_ack(SERVICE_CONFIRMED_GET_ALARM_SUMMARY, &apdu_len);
+    zassert_not_null(apdu, NULL);
+    while (apdu_len > 0) {
+        len = get_alarm_summary_ack_decode_apdu_data(apdu, apdu_len, &data);
+        zassert_true(len > 0, NULL);
+        zassert_true(count < TEST_ALARMS_MAX, NULL);
+        zassert_equal(
+            data.objectIdentifier.instance, Test_Alarm_Instance[count], NULL);
+        zassert_equal(data.alarmState, EVENT_STATE_HIGH_LIMIT, NULL);
+        apdu += len;
+        apdu_len -= len;
+        count++;
+    }
+    zassert_equal(count, TEST_ALARMS_MAX, NULL);
+    Analog_Input_Cleanup();
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(h_getevent_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        h_getevent_tests, ztest_unit_test(testActiveEventList),
+        ztest_unit_test(testGetEventInformation),
+        ztest_unit_test(testGetAlarmSummary));
+
+    ztest_run_test_suite(h_getevent_tests);
+}
+#endif
@@ -0,0 +1,76 @@
+/**
+ * @file
+ * @brief stubs for the GetEventInformation and GetAlarmSummary tests
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "bacnet/bacdef.h"
+#include "bacnet/alarm_ack.h"
+#include "bacnet/datetime.h"
+#include "bacnet/event.h"
+#include "bacnet/npdu.h"
+
+uint8_t Handler_Transmit_Buffer[MAX_PDU];
+/* the last PDU that was sent */
+uint8_t Test_Sent_PDU[MAX_PDU];
+unsigned Test_Sent_PDU_Len;
+
+bool datetime_local(
+    BACNET_DATE *bdate,
+    BACNET_TIME *btime,
+    int16_t *utc_offset_minutes,
+    bool *dst_active)
+{
+    (void)bdate;
+    (void)btime;
+    (void)utc_offset_minutes;
+    (void)dst_active;
+
+    return false;
+}
+
+void Notification_Class_common_reporting_function(
+    BACNET_EVENT_NOTIFICATION_DATA *event_data)
+{
+    (void)event_data;
+}
+
+void Notification_Class_Get_Priorities(
+    uint32_t Object_Instance, uint32_t *pPriorityArray)
+{
+    (void)Object_Instance;
+    (void)pPriorityArray;
+}
+
+void handler_alarm_ack_set(
+    BACNET_OBJECT_TYPE object_type, alarm_ack_function pFunction)
+{
+    (void)object_type;
+    (void)pFunction;
+}
+
+void bip_get_my_address(BACNET_ADDRESS *my_address)
+{
+    memset(my_address, 0, sizeof(BACNET_ADDRESS));
+}
+
+int bip_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    (void)dest;
+    (void)npdu_data;
+    if (pdu_len > sizeof(Test_Sent_PDU)) {
+        return -1;
+    }
+    memcpy(Test_Sent_PDU, pdu, pdu_len);
+    Test_Sent_PDU_Len = pdu_len;
+
+    return (int)pdu_len;
+}
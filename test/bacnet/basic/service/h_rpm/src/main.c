@@ -0,0 +1,252 @@
+/**
+ * @file
+ * @brief test the ReadProperty and ReadPropertyMultiple handlers
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/basic/object/device.h>
+#include <bacnet/basic/service/h_rp.h>
+#include <bacnet/basic/service/h_rpm.h>
+#include <bacnet/npdu.h>
+#include <bacnet/rp.h>
+#include <bacnet/rpm.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* the most recent PDU sent, from stubs.c */
+extern uint8_t Test_Sent_PDU[MAX_PDU];
+extern unsigned Test_Sent_PDU_Len;
+
+/**
+ * @brief Get the APDU of the most recent PDU sent
+ * @param apdu_len [out] length of the APDU
+ * @return pointer to the APDU
+ */
+static uint8_t *test_sent_apdu(int *apdu_len)
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    int npdu_len;
+
+    npdu_len = bacnet_npdu_decode(
+        Test_Sent_PDU, (uint16_t)Test_Sent_PDU_Len, &dest, &src, &npdu_data);
+    zassert_true(npdu_len > 0, NULL);
+    *apdu_len = (int)Test_Sent_PDU_Len - npdu_len;
+
+    return &Test_Sent_PDU[npdu_len];
+}
+
+/**
+ * @brief Encode a ReadPropertyMultiple request for one property
+ * @param service_request [out] buffer for the request
+ * @param object_type [in] object type
+ * @param object_instance [in] object instance
+ * @param object_property [in] property, or ALL, REQUIRED, or OPTIONAL
+ * @return length of the request
+ */
+static int test_rpm_request(
+    uint8_t *service_request,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID object_property)
+{
+    int len = 0;
+
+    len = rpm_encode_apdu_object_begin(
+        &service_request[len], object_type, object_instance);
+    len += rpm_encode_apdu_object_property(
+        &service_request[len], object_property, BACNET_ARRAY_ALL);
+    len += rpm_encode_apdu_object_end(&service_request[len]);
+
+    return len;
+}
+
+/**
+ * @brief Encode a ReadPropertyMultiple-ACK for ALL properties of an object
+ * the way the handler used to: each value is read into a scratch buffer
+ * and then copied into the response.
+ * @param apdu [out] buffer for the response
+ * @param invoke_id [in] invoke ID of the request
+ * @param rpmdata [in] object type and instance
+ * @return length of the response
+ */
+static int test_rpm_ack_all_copy(
+    uint8_t *apdu, uint8_t invoke_id, BACNET_RPM_DATA *rpmdata)
+{
+    static uint8_t value[MAX_APDU];
+    struct special_property_list_t property_list = { 0 };
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    const int *pList[3];
+    unsigned count[3];
+    unsigned i, n;
+    int apdu_len = 0;
+    int len = 0;
+
+    apdu_len = rpm_ack_encode_apdu_init(apdu, invoke_id);
+    apdu_len += rpm_ack_encode_apdu_object_begin(&apdu[apdu_len], rpmdata);
+    Device_Objects_Property_List(
+        rpmdata->object_type, rpmdata->object_instance, &property_list);
+    pList[0] = property_list.Required.pList;
+    count[0] = property_list.Required.count;
+    pList[1] = property_list.Optional.pList;
+    count[1] = property_list.Optional.count;
+    pList[2] = property_list.Proprietary.pList;
+    count[2] = property_list.Proprietary.count;
+    for (i = 0; i < 3; i++) {
+        for (n = 0; n < count[i]; n++) {
+            rpdata.object_type = rpmdata->object_type;
+            rpdata.object_instance = rpmdata->object_instance;
+            rpdata.object_property = (BACNET_PROPERTY_ID)pList[i][n];
+            rpdata.array_index = BACNET_ARRAY_ALL;
+            rpdata.application_data = &value[0];
+            rpdata.application_data_len = sizeof(value);
+            apdu_len += rpm_ack_encode_apdu_object_property(
+                &apdu[apdu_len], rpdata.object_property, rpdata.array_index);
+            len = Device_Read_Property(&rpdata);
+            if (len >= 0) {
+                apdu_len += rpm_ack_encode_apdu_object_property_value(
+                    &apdu[apdu_len], &value[0], (unsigned)len);
+            } else {
+                apdu_len += rpm_ack_encode_apdu_object_property_error(
+                    &apdu[apdu_len], rpdata.error_class, rpdata.error_code);
+            }
+        }
+    }
+    apdu_len += rpm_ack_encode_apdu_object_end(&apdu[apdu_len]);
+
+    return apdu_len;
+}
+
+/**
+ * @brief Test the ReadPropertyMultiple response for ALL properties,
+ * which is encoded in place, against the same response encoded by copying
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_rpm_tests, testReadPropertyMultipleAll)
+#else
+static void testReadPropertyMultipleAll(void)
+#endif
+{
+    static uint8_t test_apdu[MAX_APDU];
+    uint8_t service_request[MAX_APDU] = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    BACNET_RPM_DATA rpmdata = { 0 };
+    uint8_t *apdu;
+    int apdu_len = 0;
+    int test_len = 0;
+    int len = 0;
+
+    Device_Init(NULL);
+    rpmdata.object_type = OBJECT_DEVICE;
+    rpmdata.object_instance = Device_Object_Instance_Number();
+    len = test_rpm_request(
+        service_request, rpmdata.object_type, rpmdata.object_instance,
+        PROP_ALL);
+    service_data.invoke_id = 1;
+    service_data.max_resp = MAX_APDU;
+    Test_Sent_PDU_Len = 0;
+    handler_read_property_multiple(
+        service_request, (uint16_t)len, &src, &service_data);
+    apdu = test_sent_apdu(&apdu_len);
+    test_len = test_rpm_ack_all_copy(
+        test_apdu, service_data.invoke_id, &rpmdata);
+    zassert_equal(apdu_len, test_len, NULL);
+    zassert_equal(memcmp(apdu, test_apdu, (size_t)test_len), 0, NULL);
+    /* an unknown property gets an error for the property in the ACK */
+    len = test_rpm_request(
+        service_request, rpmdata.object_type, rpmdata.object_instance,
+        PROP_PRESENT_VALUE);
+    handler_read_property_multiple(
+        service_request, (uint16_t)len, &src, &service_data);
+    apdu = test_sent_apdu(&apdu_len);
+    zassert_equal(apdu[0], PDU_TYPE_COMPLEX_ACK, NULL);
+    test_len = rpm_ack_encode_apdu_init(test_apdu, service_data.invoke_id);
+    test_len +=
+        rpm_ack_encode_apdu_object_begin(&test_apdu[test_len], &rpmdata);
+    test_len += rpm_ack_encode_apdu_object_property(
+        &test_apdu[test_len], PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+    test_len += rpm_ack_encode_apdu_object_property_error(
+        &test_apdu[test_len], ERROR_CLASS_PROPERTY,
+        ERROR_CODE_UNKNOWN_PROPERTY);
+    test_len += rpm_ack_encode_apdu_object_end(&test_apdu[test_len]);
+    zassert_equal(apdu_len, test_len, NULL);
+    zassert_equal(memcmp(apdu, test_apdu, (size_t)test_len), 0, NULL);
+    /* a response larger than the requester accepts is aborted */
+    len = test_rpm_request(
+        service_request, rpmdata.object_type, rpmdata.object_instance,
+        PROP_ALL);
+    service_data.max_resp = 50;
+    handler_read_property_multiple(
+        service_request, (uint16_t)len, &src, &service_data);
+    apdu = test_sent_apdu(&apdu_len);
+    zassert_equal(apdu[0] & 0xF0, PDU_TYPE_ABORT, NULL);
+}
+
+/**
+ * @brief Test the ReadProperty response, which is encoded in place
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_rpm_tests, testReadProperty)
+#else
+static void testReadProperty(void)
+#endif
+{
+    static uint8_t value[MAX_APDU];
+    uint8_t service_request[MAX_APDU] = { 0 };
+    uint8_t test_apdu[MAX_APDU] = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t *apdu;
+    int apdu_len = 0;
+    int test_len = 0;
+    int len = 0;
+
+    Device_Init(NULL);
+    rpdata.object_type = OBJECT_DEVICE;
+    rpdata.object_instance = Device_Object_Instance_Number();
+    rpdata.object_property = PROP_OBJECT_LIST;
+    rpdata.array_index = BACNET_ARRAY_ALL;
+    len = read_property_request_encode(service_request, &rpdata);
+    service_data.invoke_id = 1;
+    service_data.max_resp = MAX_APDU;
+    handler_read_property(service_request, (uint16_t)len, &src, &service_data);
+    apdu = test_sent_apdu(&apdu_len);
+    rpdata.application_data = &value[0];
+    rpdata.application_data_len = sizeof(value);
+    len = Device_Read_Property(&rpdata);
+    zassert_true(len > 0, NULL);
+    test_len = rp_ack_encode_apdu_init(test_apdu, 1, &rpdata);
+    memcpy(&test_apdu[test_len], value, (size_t)len);
+    test_len += len;
+    test_len += rp_ack_encode_apdu_object_property_end(&test_apdu[test_len]);
+    zassert_equal(apdu_len, test_len, NULL);
+    zassert_equal(memcmp(apdu, test_apdu, (size_t)test_len), 0, NULL);
+    /* the closing tag length is known before encoding */
+    zassert_equal(rp_ack_encode_apdu_object_property_end(NULL), 1, NULL);
+}
+
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(h_rpm_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        h_rpm_tests, ztest_unit_test(testReadPropertyMultipleAll),
+        ztest_unit_test(testReadProperty));
+
+    ztest_run_test_suite(h_rpm_tests);
+}
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file
+ * @brief stubs for the ReadProperty and ReadPropertyMultiple handler tests
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "bacnet/datetime.h"
+#include "bacnet/bacdef.h"
+#include "bacnet/npdu.h"
+
+/* the most recent PDU sent */
+uint8_t Test_Sent_PDU[MAX_PDU];
+unsigned Test_Sent_PDU_Len;
+
+void datetime_init(void)
+{
+}
+
+bool datetime_local(
+    BACNET_DATE *bdate,
+    BACNET_TIME *btime,
+    int16_t *utc_offset_minutes,
+    bool *dst_active)
+{
+    (void)bdate;
+    (void)btime;
+    (void)utc_offset_minutes;
+    (void)dst_active;
+
+    return true;
+}
+
+void bip_get_my_address(BACNET_ADDRESS *my_address)
+{
+    memset(my_address, 0, sizeof(BACNET_ADDRESS));
+}
+
+int bip_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    (void)dest;
+    (void)npdu_data;
+    if (pdu_len > sizeof(Test_Sent_PDU)) {
+        return -1;
+    }
+    memcpy(Test_Sent_PDU, pdu, pdu_len);
+    Test_Sent_PDU_Len = pdu_len;
+
+    return (int)pdu_len;
+}
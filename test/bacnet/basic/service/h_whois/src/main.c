@@ -0,0 +1,214 @@
+/**
+ * @file
+ * @brief test the I-Am schedule of the Who-Is service handler
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/bacaddr.h>
+#include <bacnet/whois.h>
+#include <bacnet/basic/service/h_whois.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* the device that answers, and the I-Am that were sent, from stubs.c */
+extern uint32_t Test_Device_Instance;
+extern unsigned Test_I_Am_Broadcast_Count;
+extern unsigned Test_I_Am_Unicast_Count;
+extern BACNET_ADDRESS Test_I_Am_Dest;
+
+/**
+ * @brief Send any scheduled I-Am, end the windows, and clear the counts
+ */
+static void test_who_is_reset(void)
+{
+    handler_who_is_jitter_set(0);
+    handler_who_is_window_set(0);
+    handler_who_is_pace_set(0);
+    while (handler_who_is_pending()) {
+        handler_who_is_timer(UINT16_MAX);
+    }
+    handler_who_is_timer(UINT16_MAX);
+    Test_Device_Instance = 1234;
+    Test_I_Am_Broadcast_Count = 0;
+    Test_I_Am_Unicast_Count = 0;
+    memset(&Test_I_Am_Dest, 0, sizeof(Test_I_Am_Dest));
+}
+
+/**
+ * @brief Make an address of a requester
+ * @param src - the address
+ * @param mac - the last octet of its MAC address
+ */
+static void test_who_is_src(BACNET_ADDRESS *src, uint8_t mac)
+{
+    memset(src, 0, sizeof(BACNET_ADDRESS));
+    src->mac_len = 1;
+    src->mac[0] = mac;
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_whois_tests, testWhoIsNow)
+#else
+static void testWhoIsNow(void)
+#endif
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    int len;
+
+    test_who_is_reset();
+    test_who_is_src(&src, 1);
+    /* with no jitter, window, or pace, each Who-Is is answered now */
+    handler_who_is(apdu, 0, &src);
+    handler_who_is(apdu, 0, &src);
+    zassert_equal(Test_I_Am_Broadcast_Count, 2, NULL);
+    zassert_equal(handler_who_is_pending(), 0, NULL);
+    /* skip the PDU type and service choice */
+    len = whois_encode_apdu(apdu, 1, 1000);
+    handler_who_is(&apdu[2], len - 2, &src);
+    zassert_equal(Test_I_Am_Broadcast_Count, 2, NULL);
+    len = whois_encode_apdu(apdu, 1000, 2000);
+    handler_who_is_unicast(&apdu[2], len - 2, &src);
+    zassert_equal(Test_I_Am_Unicast_Count, 1, NULL);
+    zassert_true(bacnet_address_same(&Test_I_Am_Dest, &src), NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_whois_tests, testWhoIsWindow)
+#else
+static void testWhoIsWindow(void)
+#endif
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    BACNET_ADDRESS src2 = { 0 };
+    unsigned i;
+
+    test_who_is_reset();
+    handler_who_is_window_set(1000);
+    zassert_equal(handler_who_is_window(), 1000, NULL);
+    test_who_is_src(&src, 1);
+    test_who_is_src(&src2, 2);
+    /* the first Who-Is is answered now, and repeats are not */
+    handler_who_is(apdu, 0, &src);
+    handler_who_is(apdu, 0, &src);
+    handler_who_is(apdu, 0, &src2);
+    zassert_equal(Test_I_Am_Broadcast_Count, 1, NULL);
+    /* a unicast I-Am goes to each requester once */
+    handler_who_is_unicast(apdu, 0, &src);
+    handler_who_is_unicast(apdu, 0, &src2);
+    handler_who_is_unicast(apdu, 0, &src2);
+    zassert_equal(Test_I_Am_Unicast_Count, 2, NULL);
+    zassert_true(bacnet_address_same(&Test_I_Am_Dest, &src2), NULL);
+    handler_who_is_timer(999);
+    handler_who_is(apdu, 0, &src);
+    zassert_equal(Test_I_Am_Broadcast_Count, 1, NULL);
+    /* after the window, the Who-Is is answered again */
+    handler_who_is_timer(1);
+    handler_who_is(apdu, 0, &src);
+    zassert_equal(Test_I_Am_Broadcast_Count, 2, NULL);
+    zassert_equal(handler_who_is_pending(), 0, NULL);
+    /* when every place is held off, the oldest I-Am gives up its place */
+    test_who_is_reset();
+    handler_who_is_window_set(1000);
+    for (i = 0; i <= WHO_IS_RESPONSE_MAX; i++) {
+        test_who_is_src(&src, (uint8_t)(10 + i));
+        handler_who_is_unicast(apdu, 0, &src);
+        handler_who_is_timer(1);
+    }
+    zassert_equal(Test_I_Am_Unicast_Count, WHO_IS_RESPONSE_MAX + 1, NULL);
+    handler_who_is_unicast(apdu, 0, &src);
+    zassert_equal(Test_I_Am_Unicast_Count, WHO_IS_RESPONSE_MAX + 1, NULL);
+    test_who_is_src(&src, 10);
+    handler_who_is_unicast(apdu, 0, &src);
+    zassert_equal(Test_I_Am_Unicast_Count, WHO_IS_RESPONSE_MAX + 2, NULL);
+    test_who_is_reset();
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_whois_tests, testWhoIsJitter)
+#else
+static void testWhoIsJitter(void)
+#endif
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    unsigned i;
+
+    test_who_is_reset();
+    handler_who_is_jitter_set(100);
+    zassert_equal(handler_who_is_jitter(), 100, NULL);
+    test_who_is_src(&src, 1);
+    /* a repeat while the I-Am is scheduled is not answered again */
+    for (i = 0; i < 10; i++) {
+        handler_who_is(apdu, 0, &src);
+    }
+    zassert_equal(
+        Test_I_Am_Broadcast_Count + handler_who_is_pending(), 1, NULL);
+    /* the I-Am is sent within the jitter */
+    handler_who_is_timer(100);
+    zassert_equal(Test_I_Am_Broadcast_Count, 1, NULL);
+    zassert_equal(handler_who_is_pending(), 0, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_whois_tests, testWhoIsPace)
+#else
+static void testWhoIsPace(void)
+#endif
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    unsigned i;
+
+    test_who_is_reset();
+    handler_who_is_pace_set(50);
+    zassert_equal(handler_who_is_pace(), 50, NULL);
+    test_who_is_src(&src, 1);
+    /* a gateway answers for each of its routed devices */
+    for (i = 0; i < 5; i++) {
+        Test_Device_Instance = 1000 + i;
+        handler_who_is(apdu, 0, &src);
+    }
+    zassert_equal(Test_I_Am_Broadcast_Count, 1, NULL);
+    zassert_equal(handler_who_is_pending(), 4, NULL);
+    for (i = 0; i < 4; i++) {
+        handler_who_is_timer(49);
+        zassert_equal(Test_I_Am_Broadcast_Count, 1 + i, NULL);
+        handler_who_is_timer(1);
+        zassert_equal(Test_I_Am_Broadcast_Count, 2 + i, NULL);
+    }
+    zassert_equal(handler_who_is_pending(), 0, NULL);
+    /* when the schedule is full, the I-Am is sent now */
+    Test_I_Am_Broadcast_Count = 0;
+    for (i = 0; i < WHO_IS_RESPONSE_MAX + 1; i++) {
+        Test_Device_Instance = 2000 + i;
+        handler_who_is(apdu, 0, &src);
+    }
+    zassert_equal(Test_I_Am_Broadcast_Count, 1, NULL);
+    zassert_equal(handler_who_is_pending(), WHO_IS_RESPONSE_MAX, NULL);
+    test_who_is_reset();
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(h_whois_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        h_whois_tests, ztest_unit_test(testWhoIsNow),
+        ztest_unit_test(testWhoIsWindow), ztest_unit_test(testWhoIsJitter),
+        ztest_unit_test(testWhoIsPace));
+
+    ztest_run_test_suite(h_whois_tests);
+}
+#endif
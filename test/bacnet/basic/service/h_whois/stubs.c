@@ -0,0 +1,38 @@
+/**
+ * @file
+ * @brief stubs for the Who-Is handler tests
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "bacnet/bacdef.h"
+#include "bacnet/bacaddr.h"
+
+uint8_t Handler_Transmit_Buffer[MAX_PDU];
+/* the device that answers */
+uint32_t Test_Device_Instance = 1234;
+/* the I-Am that were sent, and where the last unicast I-Am was sent */
+unsigned Test_I_Am_Broadcast_Count;
+unsigned Test_I_Am_Unicast_Count;
+BACNET_ADDRESS Test_I_Am_Dest;
+
+uint32_t Device_Object_Instance_Number(void)
+{
+    return Test_Device_Instance;
+}
+
+void Send_I_Am_Broadcast(uint8_t *buffer)
+{
+    (void)buffer;
+    Test_I_Am_Broadcast_Count++;
+}
+
+void Send_I_Am_Unicast(uint8_t *buffer, const BACNET_ADDRESS *src)
+{
+    (void)buffer;
+    Test_I_Am_Unicast_Count++;
+    bacnet_address_copy(&Test_I_Am_Dest, src);
+}
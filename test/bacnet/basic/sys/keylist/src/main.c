@@ -275,6 +275,39 @@ static void testKeyListDataIndex(void)
     return;
 }
 
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(keylist_tests, testKeyListIndexNearest)
+#else
+static void testKeyListIndexNearest(void)
+#endif
+{
+    OS_Keylist list;
+    KEY key;
+    int index, expected;
+
+    list = Keylist_Create();
+    zassert_not_null(list, NULL);
+    zassert_equal(Keylist_Index_Nearest(list, 1), 0, NULL);
+    /* keys 10, 20, 30, ... 100 */
+    for (key = 10; key <= 100; key += 10) {
+        index = Keylist_Data_Add(list, key, NULL);
+        zassert_true(index >= 0, NULL);
+    }
+    for (key = 0; key <= 110; key++) {
+        /* the index of the first key that is not less than the key */
+        expected = 0;
+        if (key > 10) {
+            expected = (int)((key + 9) / 10) - 1;
+        }
+        index = Keylist_Index_Nearest(list, key);
+        zassert_equal(index, expected, "key=%u", (unsigned)key);
+    }
+    zassert_equal(Keylist_Index_Nearest(list, 100), 9, NULL);
+    zassert_equal(Keylist_Index_Nearest(list, 101), 10, NULL);
+    Keylist_Data_Free(list);
+    Keylist_Delete(list);
+}
+
 /* test access of a lot of entries */
 #if defined(CONFIG_ZTEST_NEW_API)
 ZTEST(keylist_tests, testKeyListLarge)
@@ -314,6 +347,90 @@ static void testKeyListLarge(void)
     return;
 }
 
+/* test loading many entries at once */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(keylist_tests, testKeyListBulkLoad)
+#else
+static void testKeyListBulkLoad(void)
+#endif
+{
+    static struct Keylist_Node nodes[1024 * 4];
+    static int data_list[1024 * 4];
+    const int num_keys = 1024 * 4;
+    char *data1 = "Joshua";
+    char *data2 = "Anna";
+    OS_Keylist list;
+    bool status = false;
+    KEY key, last_key = 0;
+    int *data;
+    int index;
+
+    list = Keylist_Create();
+    zassert_not_null(list, NULL);
+    status = Keylist_Bulk_Load(list, NULL, 0);
+    zassert_true(status, NULL);
+    zassert_false(Keylist_Bulk_Load(NULL, nodes, 1), NULL);
+    zassert_false(Keylist_Bulk_Load(list, NULL, 1), NULL);
+    /* in order, into an empty list */
+    for (index = 0; index < num_keys / 2; index++) {
+        data_list[index] = 42 + index;
+        nodes[index].key = index * 2;
+        nodes[index].data = &data_list[index];
+    }
+    status = Keylist_Bulk_Load(list, nodes, num_keys / 2);
+    zassert_true(status, NULL);
+    zassert_equal(Keylist_Count(list), num_keys / 2, NULL);
+    /* out of order, interleaved with the existing keys */
+    for (index = 0; index < num_keys / 2; index++) {
+        data_list[num_keys / 2 + index] = 42 + num_keys / 2 + index;
+        nodes[index].key = (((index * 7919) % (num_keys / 2)) * 2) + 1;
+        nodes[index].data = &data_list[num_keys / 2 + index];
+    }
+    status = Keylist_Bulk_Load(list, nodes, num_keys / 2);
+    zassert_true(status, NULL);
+    zassert_equal(Keylist_Count(list), num_keys, NULL);
+    for (index = 0; index < num_keys; index++) {
+        status = Keylist_Index_Key(list, index, &key);
+        zassert_true(status, NULL);
+        zassert_equal(key, index, NULL);
+        if (index > 0) {
+            zassert_true(key > last_key, NULL);
+        }
+        last_key = key;
+        data = Keylist_Data(list, key);
+        zassert_not_null(data, NULL);
+        zassert_equal(Keylist_Index(list, key), index, NULL);
+    }
+    for (index = 0; index < num_keys / 2; index++) {
+        data = Keylist_Data(list, index * 2);
+        zassert_equal(*data, 42 + index, NULL);
+    }
+    /* the list still works one node at a time afterwards */
+    data = Keylist_Data_Delete(list, 0);
+    zassert_equal(*data, 42, NULL);
+    zassert_equal(Keylist_Count(list), num_keys - 1, NULL);
+    index = Keylist_Data_Add(list, num_keys, &data_list[0]);
+    zassert_equal(index, num_keys - 1, NULL);
+    while (Keylist_Count(list) > 0) {
+        (void)Keylist_Data_Pop(list);
+    }
+    /* duplicate keys keep the order they were loaded in */
+    nodes[0].key = 5;
+    nodes[0].data = data1;
+    nodes[1].key = 1;
+    nodes[1].data = NULL;
+    nodes[2].key = 5;
+    nodes[2].data = data2;
+    status = Keylist_Bulk_Load(list, nodes, 3);
+    zassert_true(status, NULL);
+    zassert_equal(Keylist_Count(list), 3, NULL);
+    zassert_equal(Keylist_Data_Index(list, 1), data1, NULL);
+    zassert_equal(Keylist_Data_Index(list, 2), data2, NULL);
+    Keylist_Delete(list);
+
+    return;
+}
+
 /* test the encode and decode macros */
 #if defined(CONFIG_ZTEST_NEW_API)
 ZTEST(keylist_tests, testKeySample)
@@ -359,7 +476,9 @@ void test_main(void)
         keylist_tests, ztest_unit_test(testKeyListFIFO),
         ztest_unit_test(testKeyListFILO), ztest_unit_test(testKeyListDataKey),
         ztest_unit_test(testKeyListDataIndex),
-        ztest_unit_test(testKeyListLarge), ztest_unit_test(testKeySample));
+        ztest_unit_test(testKeyListIndexNearest),
+        ztest_unit_test(testKeyListLarge),
+        ztest_unit_test(testKeyListBulkLoad), ztest_unit_test(testKeySample));
 
     ztest_run_test_suite(keylist_tests);
 }
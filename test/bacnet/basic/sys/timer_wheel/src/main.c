@@ -0,0 +1,190 @@
+/**
+ * @file
+ * @brief test hierarchical timer wheel APIs
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <zephyr/ztest.h>
+#include <bacnet/basic/sys/timer_wheel.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+#define TEST_TIMERS 64
+
+static struct timer_wheel Test_Wheel;
+static struct timer_wheel_entry Test_Timer[TEST_TIMERS];
+/* milliseconds when each timer fired, or zero */
+static uint32_t Test_Fired[TEST_TIMERS];
+static uint32_t Test_Elapsed[TEST_TIMERS];
+static unsigned Test_Fired_Count;
+static uint32_t Test_Now;
+/* timer to restart from its own callback, with its interval */
+static uint32_t Test_Restart_Key = TEST_TIMERS;
+static uint32_t Test_Restart_Interval;
+
+static void test_timer_callback(
+    struct timer_wheel_entry *entry, uint32_t milliseconds)
+{
+    Test_Fired[entry->key] = Test_Now;
+    Test_Elapsed[entry->key] = milliseconds;
+    Test_Fired_Count++;
+    if (entry->key == Test_Restart_Key) {
+        timer_wheel_start(&Test_Wheel, entry, Test_Restart_Interval);
+    }
+}
+
+/**
+ * Advance the wheel in steps of a number of milliseconds, tracking the time
+ */
+static void test_timer_advance(uint32_t milliseconds, uint16_t step)
+{
+    while (milliseconds) {
+        if (step > milliseconds) {
+            step = (uint16_t)milliseconds;
+        }
+        Test_Now += step;
+        timer_wheel_elapsed(&Test_Wheel, step);
+        milliseconds -= step;
+    }
+}
+
+static void test_timer_setup(uint16_t resolution)
+{
+    unsigned i;
+
+    timer_wheel_init(&Test_Wheel, resolution);
+    for (i = 0; i < TEST_TIMERS; i++) {
+        timer_wheel_entry_init(&Test_Timer[i], test_timer_callback, i);
+        Test_Fired[i] = 0;
+        Test_Elapsed[i] = 0;
+    }
+    Test_Fired_Count = 0;
+    Test_Now = 0;
+    Test_Restart_Key = TEST_TIMERS;
+}
+
+/**
+ * Unit Test for timers that expire at the expected times
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(timer_wheel_tests, testTimerWheelExpire)
+#else
+static void testTimerWheelExpire(void)
+#endif
+{
+    /* delays that land in each level of the wheel */
+    const uint32_t delay[] = { 1, 5, 63, 64, 65, 100, 4095, 4096, 4097,
+                               5000, 70000, 262144, 300000 };
+    const unsigned count = sizeof(delay) / sizeof(delay[0]);
+    unsigned i;
+
+    test_timer_setup(1);
+    for (i = 0; i < count; i++) {
+        timer_wheel_start(&Test_Wheel, &Test_Timer[i], delay[i]);
+        zassert_true(timer_wheel_running(&Test_Timer[i]), NULL);
+    }
+    zassert_equal(timer_wheel_count(&Test_Wheel), count, NULL);
+    /* advance unevenly */
+    test_timer_advance(310000, 7);
+    zassert_equal(Test_Fired_Count, count, NULL);
+    zassert_equal(timer_wheel_count(&Test_Wheel), 0, NULL);
+    for (i = 0; i < count; i++) {
+        zassert_false(timer_wheel_running(&Test_Timer[i]), NULL);
+        /* fired during the step that included the expire time */
+        zassert_true(Test_Fired[i] >= delay[i], "delay=%u", delay[i]);
+        zassert_true(Test_Fired[i] < (delay[i] + 7), "delay=%u", delay[i]);
+        zassert_equal(Test_Elapsed[i], delay[i], NULL);
+    }
+}
+
+/**
+ * Unit Test for stopping, restarting, and resolution of timers
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(timer_wheel_tests, testTimerWheelStop)
+#else
+static void testTimerWheelStop(void)
+#endif
+{
+    unsigned i;
+
+    test_timer_setup(10);
+    for (i = 0; i < TEST_TIMERS; i++) {
+        timer_wheel_start(&Test_Wheel, &Test_Timer[i], 1000 + (i * 100));
+    }
+    /* stop the even timers */
+    for (i = 0; i < TEST_TIMERS; i += 2) {
+        timer_wheel_stop(&Test_Wheel, &Test_Timer[i]);
+        zassert_false(timer_wheel_running(&Test_Timer[i]), NULL);
+    }
+    zassert_equal(timer_wheel_count(&Test_Wheel), TEST_TIMERS / 2, NULL);
+    /* stopping a stopped timer is harmless */
+    timer_wheel_stop(&Test_Wheel, &Test_Timer[0]);
+    zassert_equal(timer_wheel_count(&Test_Wheel), TEST_TIMERS / 2, NULL);
+    /* starting a running timer moves it */
+    timer_wheel_start(&Test_Wheel, &Test_Timer[1], 50);
+    zassert_equal(timer_wheel_count(&Test_Wheel), TEST_TIMERS / 2, NULL);
+    test_timer_advance(60, 100);
+    zassert_equal(Test_Fired_Count, 1, NULL);
+    zassert_equal(Test_Elapsed[1], 50, NULL);
+    test_timer_advance(20000, 100);
+    zassert_equal(Test_Fired_Count, TEST_TIMERS / 2, NULL);
+    for (i = 0; i < TEST_TIMERS; i += 2) {
+        zassert_equal(Test_Fired[i], 0, NULL);
+    }
+    /* a delay shorter than the resolution waits a whole tick */
+    timer_wheel_start(&Test_Wheel, &Test_Timer[0], 1);
+    test_timer_advance(9, 1);
+    zassert_equal(Test_Fired[0], 0, NULL);
+    test_timer_advance(1, 1);
+    zassert_not_equal(Test_Fired[0], 0, NULL);
+}
+
+/**
+ * Unit Test for a periodic timer that restarts itself from its callback
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(timer_wheel_tests, testTimerWheelPeriodic)
+#else
+static void testTimerWheelPeriodic(void)
+#endif
+{
+    test_timer_setup(10);
+    Test_Restart_Key = 3;
+    Test_Restart_Interval = 10;
+    timer_wheel_start(&Test_Wheel, &Test_Timer[3], 10);
+    /* one call with a large elapsed time fires it once per tick */
+    test_timer_advance(1000, 1000);
+    zassert_equal(Test_Fired_Count, 100, NULL);
+    zassert_equal(Test_Elapsed[3], 10, NULL);
+    zassert_true(timer_wheel_running(&Test_Timer[3]), NULL);
+    /* the remainder of a partial tick is kept */
+    test_timer_advance(25, 5);
+    zassert_equal(Test_Fired_Count, 102, NULL);
+    Test_Restart_Key = TEST_TIMERS;
+    test_timer_advance(100, 10);
+    zassert_equal(Test_Fired_Count, 103, NULL);
+    zassert_false(timer_wheel_running(&Test_Timer[3]), NULL);
+    zassert_equal(timer_wheel_count(&Test_Wheel), 0, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(timer_wheel_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        timer_wheel_tests, ztest_unit_test(testTimerWheelExpire),
+        ztest_unit_test(testTimerWheelStop),
+        ztest_unit_test(testTimerWheelPeriodic));
+
+    ztest_run_test_suite(timer_wheel_tests);
+}
+#endif
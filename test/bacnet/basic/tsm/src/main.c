@@ -0,0 +1,679 @@
+/**
+ * @file
+ * @brief test BACnet TSM segmentation of confirmed requests and
+ *  complex-acks using a loopback between a client and a server,
+ *  and transactions keyed by peer address and invoke ID
+ * @date 2026
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/bacaddr.h>
+#include <bacnet/bacdcode.h>
+#include <bacnet/npdu.h>
+#include <bacnet/basic/tsm/tsm.h>
+#include <bacnet/datalink/datalink.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+#define TEST_PDU_QUEUE_SIZE 256
+#define TEST_MAX_APDU 206
+/* a request that needs more than 256 segments of 50 octets */
+#define TEST_LONG_APDU 12000
+/* more peers with outstanding requests than there are invoke IDs */
+#define TEST_PEER_COUNT 400
+
+/* PDUs sent by the TSM, waiting for delivery to the peer */
+struct test_pdu {
+    BACNET_ADDRESS dest;
+    uint8_t pdu[MAX_PDU];
+    uint16_t pdu_len;
+};
+static struct test_pdu Test_PDU_Queue[TEST_PDU_QUEUE_SIZE];
+static unsigned Test_PDU_Head;
+static unsigned Test_PDU_Tail;
+static BACNET_ADDRESS Client_Address;
+static BACNET_ADDRESS Server_Address;
+/* reassembled message, as seen by the service handler */
+static uint8_t Test_Service_Data[MAX_ASDU];
+static uint16_t Test_Service_Data_Len;
+static bool Test_Complete;
+/* segment sequence number to drop once, or -1 */
+static int Test_Drop_Sequence;
+static unsigned Test_Timeouts;
+static unsigned Test_Peer_Timeouts;
+
+int datalink_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    struct test_pdu *entry;
+
+    (void)npdu_data;
+    zassert_true(pdu_len <= MAX_PDU, NULL);
+    zassert_true(
+        (Test_PDU_Head - Test_PDU_Tail) < TEST_PDU_QUEUE_SIZE, NULL);
+    entry = &Test_PDU_Queue[Test_PDU_Head % TEST_PDU_QUEUE_SIZE];
+    bacnet_address_copy(&entry->dest, dest);
+    memcpy(entry->pdu, pdu, pdu_len);
+    entry->pdu_len = (uint16_t)pdu_len;
+    Test_PDU_Head++;
+
+    return (int)pdu_len;
+}
+
+void datalink_get_my_address(BACNET_ADDRESS *my_address)
+{
+    bacnet_address_init(my_address, NULL, 0, NULL);
+}
+
+uint16_t apdu_timeout(void)
+{
+    return 3000;
+}
+
+uint8_t apdu_retries(void)
+{
+    return 3;
+}
+
+uint16_t apdu_segment_timeout(void)
+{
+    return 2000;
+}
+
+static void test_timeout_handler(uint8_t invoke_id)
+{
+    (void)invoke_id;
+    Test_Timeouts++;
+}
+
+static void test_peer_timeout_handler(
+    const BACNET_ADDRESS *dest, uint8_t invoke_id)
+{
+    (void)dest;
+    (void)invoke_id;
+    Test_Peer_Timeouts++;
+}
+
+static void test_setup(void)
+{
+    BACNET_MAC_ADDRESS mac = { 0 };
+
+    Test_PDU_Head = 0;
+    Test_PDU_Tail = 0;
+    Test_Service_Data_Len = 0;
+    Test_Complete = false;
+    Test_Drop_Sequence = -1;
+    Test_Timeouts = 0;
+    Test_Peer_Timeouts = 0;
+    mac.len = 1;
+    mac.adr[0] = 1;
+    bacnet_address_init(&Client_Address, &mac, 0, NULL);
+    mac.adr[0] = 2;
+    bacnet_address_init(&Server_Address, &mac, 0, NULL);
+    tsm_set_timeout_handler(test_timeout_handler);
+    tsm_set_peer_timeout_handler(test_peer_timeout_handler);
+    tsm_segment_statistics_clear();
+}
+
+/**
+ * @brief Fill a buffer with a test pattern
+ */
+static void test_pattern(uint8_t *buffer, unsigned length, uint8_t seed)
+{
+    unsigned i;
+
+    for (i = 0; i < length; i++) {
+        buffer[i] = (uint8_t)(seed + (i * 7U) + (i >> 8));
+    }
+}
+
+/**
+ * @brief Deliver one queued PDU to the client or server side of the TSM
+ * @return false if there was nothing to deliver
+ */
+static bool test_deliver(void)
+{
+    struct test_pdu *entry;
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    BACNET_CONFIRMED_SERVICE_ACK_DATA ack_data = { 0 };
+    const BACNET_ADDRESS *peer;
+    uint8_t *apdu;
+    uint8_t *service_request;
+    uint16_t service_request_len;
+    uint16_t apdu_len;
+    int len;
+
+    if (Test_PDU_Head == Test_PDU_Tail) {
+        return false;
+    }
+    entry = &Test_PDU_Queue[Test_PDU_Tail % TEST_PDU_QUEUE_SIZE];
+    Test_PDU_Tail++;
+    len = bacnet_npdu_decode(
+        entry->pdu, entry->pdu_len, &dest, &src, &npdu_data);
+    zassert_true(len > 0, NULL);
+    apdu = &entry->pdu[len];
+    apdu_len = entry->pdu_len - (uint16_t)len;
+    /* the sender is the peer of the destination */
+    if (bacnet_address_same(&entry->dest, &Client_Address)) {
+        peer = &Server_Address;
+    } else {
+        peer = &Client_Address;
+    }
+    switch (apdu[0] & 0xF0) {
+        case PDU_TYPE_COMPLEX_ACK:
+            zassert_true(apdu_len <= TEST_MAX_APDU, NULL);
+            zassert_true(apdu[0] & BIT(3), NULL);
+            ack_data.segmented_message = true;
+            ack_data.more_follows = (apdu[0] & BIT(2)) ? true : false;
+            ack_data.invoke_id = apdu[1];
+            ack_data.sequence_number = apdu[2];
+            ack_data.proposed_window_number = apdu[3];
+            if ((int)ack_data.sequence_number == Test_Drop_Sequence) {
+                Test_Drop_Sequence = -1;
+                break;
+            }
+            service_request = &apdu[5];
+            service_request_len = apdu_len - 5;
+            if (tsm_segmented_complex_ack_received(
+                    peer, &ack_data, &service_request,
+                    &service_request_len)) {
+                zassert_false(ack_data.segmented_message, NULL);
+                memcpy(
+                    Test_Service_Data, service_request, service_request_len);
+                Test_Service_Data_Len = service_request_len;
+                Test_Complete = true;
+                tsm_free_invoke_id(ack_data.invoke_id);
+            }
+            break;
+        case PDU_TYPE_CONFIRMED_SERVICE_REQUEST:
+            zassert_true(apdu_len <= TEST_MAX_APDU, NULL);
+            zassert_true(apdu[0] & BIT(3), NULL);
+            service_data.segmented_message = true;
+            service_data.more_follows = (apdu[0] & BIT(2)) ? true : false;
+            service_data.segmented_response_accepted =
+                (apdu[0] & BIT(1)) ? true : false;
+            service_data.max_segs = decode_max_segs(apdu[1]);
+            service_data.max_resp = decode_max_apdu(apdu[1]);
+            service_data.invoke_id = apdu[2];
+            service_data.sequence_number = apdu[3];
+            service_data.proposed_window_number = apdu[4];
+            if ((int)service_data.sequence_number == Test_Drop_Sequence) {
+                Test_Drop_Sequence = -1;
+                break;
+            }
+            service_request = &apdu[6];
+            service_request_len = apdu_len - 6;
+            if (tsm_segmented_request_received(
+                    peer, &service_data, apdu[5], &service_request,
+                    &service_request_len)) {
+                zassert_false(service_data.segmented_message, NULL);
+                memcpy(
+                    Test_Service_Data, service_request, service_request_len);
+                Test_Service_Data_Len = service_request_len;
+                Test_Complete = true;
+                tsm_segmented_request_complete(peer, service_data.invoke_id);
+            }
+            break;
+        case PDU_TYPE_SEGMENT_ACK:
+            zassert_equal(apdu_len, 4, NULL);
+            tsm_segment_ack_received(
+                peer, apdu[1], apdu[2], apdu[3],
+                (apdu[0] & BIT(1)) ? true : false,
+                (apdu[0] & BIT(0)) ? true : false);
+            break;
+        default:
+            break;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Deliver PDUs until none are left, running the timers when idle
+ * @param timer_ticks - number of 500ms timer ticks to run at most
+ * @param until_complete - stop when a message is reassembled
+ */
+static void test_run(unsigned timer_ticks, bool until_complete)
+{
+    unsigned ticks = 0;
+
+    for (;;) {
+        while (test_deliver()) {
+        }
+        if ((until_complete && Test_Complete) || (ticks >= timer_ticks)) {
+            break;
+        }
+        tsm_timer_milliseconds(500);
+        ticks++;
+    }
+}
+
+/**
+ * @brief Start a confirmed request from the client to the server
+ * @return invoke ID of the request
+ */
+static uint8_t test_client_request(void)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    uint8_t apdu[8];
+    uint8_t invoke_id;
+
+    invoke_id = tsm_next_free_invokeID();
+    zassert_not_equal(invoke_id, 0, NULL);
+    apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST | BIT(1);
+    apdu[1] = encode_max_segs_max_apdu(16, TEST_MAX_APDU);
+    apdu[2] = invoke_id;
+    apdu[3] = SERVICE_CONFIRMED_READ_PROP_MULTIPLE;
+    npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+    tsm_set_confirmed_unsegmented_transaction(
+        invoke_id, &Server_Address, &npdu_data, apdu, 4);
+
+    return invoke_id;
+}
+
+/**
+ * @brief Send a complex-ack from the server that needs segmentation
+ */
+static int test_server_response(
+    uint8_t invoke_id, unsigned data_len, bool accepted, int max_segs)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    uint8_t *apdu = &Handler_Segmented_Buffer[0];
+
+    service_data.segmented_response_accepted = accepted;
+    service_data.max_segs = max_segs;
+    service_data.max_resp = TEST_MAX_APDU;
+    service_data.invoke_id = invoke_id;
+    service_data.priority = MESSAGE_PRIORITY_NORMAL;
+    apdu[0] = PDU_TYPE_COMPLEX_ACK;
+    apdu[1] = invoke_id;
+    apdu[2] = SERVICE_CONFIRMED_READ_PROP_MULTIPLE;
+    test_pattern(&apdu[3], data_len, invoke_id);
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+
+    return tsm_segmented_complex_ack_send(
+        &Client_Address, &npdu_data, &service_data, apdu, data_len + 3);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentedComplexAck)
+#else
+static void testSegmentedComplexAck(void)
+#endif
+{
+    BACNET_TSM_SEGMENT_STATISTICS stats = { 0 };
+    uint8_t expected[2000];
+    uint8_t invoke_id;
+    unsigned segments;
+
+    test_setup();
+    invoke_id = test_client_request();
+    zassert_true(test_server_response(invoke_id, 2000, true, 16) > 0, NULL);
+    test_run(0, true);
+    zassert_true(Test_Complete, NULL);
+    zassert_equal(Test_Service_Data_Len, 2000, NULL);
+    test_pattern(expected, sizeof(expected), invoke_id);
+    zassert_mem_equal(Test_Service_Data, expected, sizeof(expected), NULL);
+    zassert_true(tsm_invoke_id_free(invoke_id), NULL);
+    tsm_segment_statistics(&stats);
+    segments = (2000 + (TEST_MAX_APDU - 5) - 1) / (TEST_MAX_APDU - 5);
+    zassert_equal(stats.segments_sent, segments, NULL);
+    zassert_equal(stats.segments_received, segments, NULL);
+    zassert_equal(stats.segments_retransmitted, 0, NULL);
+    zassert_equal(stats.segment_naks_sent, 0, NULL);
+    zassert_equal(stats.transactions_sent, 1, NULL);
+    zassert_equal(stats.transactions_received, 1, NULL);
+    /* first segment, then one window of the remainder */
+    zassert_equal(stats.segment_acks_sent, 2, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentLost)
+#else
+static void testSegmentLost(void)
+#endif
+{
+    BACNET_TSM_SEGMENT_STATISTICS stats = { 0 };
+    uint8_t expected[3000];
+    uint8_t invoke_id;
+
+    /* a segment in the middle of a window is received out of order */
+    test_setup();
+    invoke_id = test_client_request();
+    Test_Drop_Sequence = 3;
+    zassert_true(test_server_response(invoke_id, 3000, true, 32) > 0, NULL);
+    test_run(0, true);
+    zassert_true(Test_Complete, NULL);
+    zassert_equal(Test_Service_Data_Len, 3000, NULL);
+    test_pattern(expected, sizeof(expected), invoke_id);
+    zassert_mem_equal(Test_Service_Data, expected, sizeof(expected), NULL);
+    tsm_segment_statistics(&stats);
+    zassert_true(stats.segment_naks_sent > 0, NULL);
+    zassert_true(stats.segments_retransmitted > 0, NULL);
+    /* the last segment is lost, and is recovered by the segment timer */
+    test_setup();
+    invoke_id = test_client_request();
+    Test_Drop_Sequence = (3000 + (TEST_MAX_APDU - 5) - 1) /
+        (TEST_MAX_APDU - 5) - 1;
+    zassert_true(test_server_response(invoke_id, 3000, true, 32) > 0, NULL);
+    test_run(10, true);
+    zassert_true(Test_Complete, NULL);
+    test_pattern(expected, sizeof(expected), invoke_id);
+    zassert_mem_equal(Test_Service_Data, expected, sizeof(expected), NULL);
+    tsm_segment_statistics(&stats);
+    zassert_true(stats.segments_retransmitted > 0, NULL);
+    zassert_true(tsm_segments_per_second() > 0, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentedRequest)
+#else
+static void testSegmentedRequest(void)
+#endif
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_TSM_SEGMENT_STATISTICS stats = { 0 };
+    static uint8_t apdu[1500];
+    uint8_t invoke_id;
+
+    test_setup();
+    invoke_id = tsm_next_free_invokeID();
+    zassert_not_equal(invoke_id, 0, NULL);
+    apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST | BIT(1);
+    apdu[1] = encode_max_segs_max_apdu(16, TEST_MAX_APDU);
+    apdu[2] = invoke_id;
+    apdu[3] = SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE;
+    test_pattern(&apdu[4], sizeof(apdu) - 4, 0x55);
+    npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+    zassert_true(
+        tsm_set_confirmed_segmented_transaction(
+            invoke_id, &Server_Address, &npdu_data, apdu, sizeof(apdu),
+            TEST_MAX_APDU) > 0,
+        NULL);
+    test_run(0, true);
+    zassert_true(Test_Complete, NULL);
+    zassert_equal(Test_Service_Data_Len, sizeof(apdu) - 4, NULL);
+    zassert_mem_equal(Test_Service_Data, &apdu[4], sizeof(apdu) - 4, NULL);
+    /* the client now waits for the response */
+    zassert_false(tsm_invoke_id_free(invoke_id), NULL);
+    zassert_false(tsm_invoke_id_failed(invoke_id), NULL);
+    tsm_segment_statistics(&stats);
+    zassert_equal(stats.transactions_sent, 1, NULL);
+    zassert_equal(stats.transactions_received, 1, NULL);
+    /* no response: the request is sent again, then fails */
+    test_run(100, false);
+    zassert_true(tsm_invoke_id_failed(invoke_id), NULL);
+    zassert_equal(Test_Timeouts, 1, NULL);
+    tsm_free_invoke_id(invoke_id);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentedRequestTooLong)
+#else
+static void testSegmentedRequestTooLong(void)
+#endif
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_TSM_SEGMENT_STATISTICS stats = { 0 };
+    static uint8_t apdu[TEST_LONG_APDU];
+    uint8_t invoke_id;
+
+    test_setup();
+    invoke_id = tsm_next_free_invokeID();
+    zassert_not_equal(invoke_id, 0, NULL);
+    apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST | BIT(1);
+    apdu[1] = encode_max_segs_max_apdu(16, TEST_MAX_APDU);
+    apdu[2] = invoke_id;
+    apdu[3] = SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE;
+    test_pattern(&apdu[4], sizeof(apdu) - 4, 0x55);
+    npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+    /* more than 256 segments of 50 octets: the sequence number wraps */
+    zassert_true(
+        tsm_set_confirmed_segmented_transaction(
+            invoke_id, &Server_Address, &npdu_data, apdu, sizeof(apdu),
+            50) < 0,
+        NULL);
+    zassert_equal(Test_PDU_Head, Test_PDU_Tail, NULL);
+    tsm_segment_statistics(&stats);
+    zassert_equal(stats.segments_sent, 0, NULL);
+    tsm_free_invoke_id(invoke_id);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentationAbort)
+#else
+static void testSegmentationAbort(void)
+#endif
+{
+    struct test_pdu *entry;
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t invoke_id = 42;
+    uint8_t *apdu;
+    int len;
+
+    /* requester does not accept a segmented response */
+    test_setup();
+    zassert_true(test_server_response(invoke_id, 1000, false, 16) < 0, NULL);
+    zassert_equal(Test_PDU_Head, 1, NULL);
+    entry = &Test_PDU_Queue[0];
+    len = bacnet_npdu_decode(
+        entry->pdu, entry->pdu_len, &dest, &src, &npdu_data);
+    apdu = &entry->pdu[len];
+    zassert_equal(apdu[0], PDU_TYPE_ABORT | 1, NULL);
+    zassert_equal(apdu[1], invoke_id, NULL);
+    zassert_equal(apdu[2], ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, NULL);
+    /* response needs more segments than the requester accepts */
+    test_setup();
+    zassert_true(test_server_response(invoke_id, 1000, true, 2) < 0, NULL);
+    zassert_equal(Test_PDU_Head, 1, NULL);
+    entry = &Test_PDU_Queue[0];
+    len = bacnet_npdu_decode(
+        entry->pdu, entry->pdu_len, &dest, &src, &npdu_data);
+    apdu = &entry->pdu[len];
+    zassert_equal(apdu[2], ABORT_REASON_BUFFER_OVERFLOW, NULL);
+    /* response fits without segmentation */
+    test_setup();
+    zassert_true(test_server_response(invoke_id, 100, false, 0) > 0, NULL);
+    zassert_equal(Test_PDU_Head, 1, NULL);
+    entry = &Test_PDU_Queue[0];
+    len = bacnet_npdu_decode(
+        entry->pdu, entry->pdu_len, &dest, &src, &npdu_data);
+    apdu = &entry->pdu[len];
+    zassert_equal(apdu[0], PDU_TYPE_COMPLEX_ACK, NULL);
+    zassert_equal(entry->pdu_len - len, 103, NULL);
+}
+
+/**
+ * @brief Create the address of one of many test peers
+ */
+static void test_peer_address(BACNET_ADDRESS *dest, unsigned peer)
+{
+    BACNET_MAC_ADDRESS mac = { 0 };
+
+    mac.len = 2;
+    mac.adr[0] = (uint8_t)(peer >> 8);
+    mac.adr[1] = (uint8_t)peer;
+    bacnet_address_init(dest, &mac, 0, NULL);
+}
+
+/**
+ * @brief Start a confirmed request to a peer using a per-peer invoke ID
+ * @return invoke ID of the request
+ */
+static uint8_t test_peer_request(const BACNET_ADDRESS *dest)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    uint8_t apdu[4];
+    uint8_t invoke_id;
+
+    invoke_id = tsm_peer_next_free_invokeID(dest);
+    if (invoke_id) {
+        apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+        apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+        apdu[2] = invoke_id;
+        apdu[3] = SERVICE_CONFIRMED_READ_PROPERTY;
+        npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+        tsm_set_confirmed_unsegmented_transaction(
+            invoke_id, dest, &npdu_data, apdu, sizeof(apdu));
+    }
+
+    return invoke_id;
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testPeerInvokeIDs)
+#else
+static void testPeerInvokeIDs(void)
+#endif
+{
+    static uint8_t invoke_ids[TEST_PEER_COUNT];
+    BACNET_ADDRESS dest = { 0 };
+    uint8_t one_peer[255];
+    uint8_t invoke_id;
+    unsigned i, j;
+
+    test_setup();
+    zassert_equal(tsm_transaction_idle_count(), MAX_TSM_TRANSACTIONS, NULL);
+    /* more requests are outstanding than there are invoke IDs */
+    for (i = 0; i < TEST_PEER_COUNT; i++) {
+        test_peer_address(&dest, i);
+        invoke_ids[i] = test_peer_request(&dest);
+        zassert_not_equal(invoke_ids[i], 0, NULL);
+    }
+    zassert_equal(
+        tsm_transaction_idle_count(), MAX_TSM_TRANSACTIONS - TEST_PEER_COUNT,
+        NULL);
+    /* every invoke ID is in use with some peer */
+    zassert_equal(tsm_next_free_invokeID(), 0, NULL);
+    for (i = 0; i < TEST_PEER_COUNT; i++) {
+        test_peer_address(&dest, i);
+        zassert_false(tsm_peer_invoke_id_free(&dest, invoke_ids[i]), NULL);
+        zassert_false(tsm_peer_invoke_id_failed(&dest, invoke_ids[i]), NULL);
+        /* the same invoke ID is free with the next peer */
+        test_peer_address(&dest, TEST_PEER_COUNT + i);
+        zassert_true(tsm_peer_invoke_id_free(&dest, invoke_ids[i]), NULL);
+    }
+    for (i = 0; i < TEST_PEER_COUNT; i++) {
+        test_peer_address(&dest, i);
+        tsm_peer_free_invoke_id(&dest, invoke_ids[i]);
+        zassert_true(tsm_peer_invoke_id_free(&dest, invoke_ids[i]), NULL);
+    }
+    zassert_equal(tsm_transaction_idle_count(), MAX_TSM_TRANSACTIONS, NULL);
+    /* up to 255 requests are outstanding with one peer */
+    test_peer_address(&dest, 0);
+    for (i = 0; i < 255; i++) {
+        one_peer[i] = test_peer_request(&dest);
+        zassert_not_equal(one_peer[i], 0, NULL);
+        for (j = 0; j < i; j++) {
+            zassert_not_equal(one_peer[i], one_peer[j], NULL);
+        }
+    }
+    zassert_equal(tsm_peer_next_free_invokeID(&dest), 0, NULL);
+    /* another peer is not affected */
+    test_peer_address(&dest, 1);
+    invoke_id = test_peer_request(&dest);
+    zassert_not_equal(invoke_id, 0, NULL);
+    tsm_peer_free_invoke_id(&dest, invoke_id);
+    test_peer_address(&dest, 0);
+    for (i = 0; i < 255; i++) {
+        tsm_peer_free_invoke_id(&dest, one_peer[i]);
+    }
+    /* an invoke ID for all peers is not reused per peer until freed */
+    invoke_id = tsm_next_free_invokeID();
+    zassert_not_equal(invoke_id, 0, NULL);
+    for (i = 0; i < 254; i++) {
+        one_peer[i] = test_peer_request(&dest);
+        zassert_not_equal(one_peer[i], invoke_id, NULL);
+    }
+    zassert_equal(tsm_peer_next_free_invokeID(&dest), 0, NULL);
+    tsm_free_invoke_id(invoke_id);
+    for (i = 0; i < 254; i++) {
+        tsm_peer_free_invoke_id(&dest, one_peer[i]);
+    }
+    zassert_equal(tsm_transaction_idle_count(), MAX_TSM_TRANSACTIONS, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testPeerTimers)
+#else
+static void testPeerTimers(void)
+#endif
+{
+    static uint8_t invoke_ids[TEST_PEER_COUNT];
+    BACNET_ADDRESS dest = { 0 };
+    unsigned i;
+
+    test_setup();
+    /* half of the requests start 1000ms after the other half */
+    for (i = 0; i < TEST_PEER_COUNT; i++) {
+        if (i == (TEST_PEER_COUNT / 2)) {
+            tsm_timer_milliseconds(1000);
+        }
+        test_peer_address(&dest, i);
+        invoke_ids[i] = test_peer_request(&dest);
+        zassert_not_equal(invoke_ids[i], 0, NULL);
+    }
+    /* replies to some of the first half arrive before the timeout */
+    for (i = 0; i < 10; i++) {
+        test_peer_address(&dest, i);
+        tsm_peer_free_invoke_id(&dest, invoke_ids[i]);
+    }
+    /* only the expired requests are sent again */
+    tsm_timer_milliseconds(1999);
+    zassert_equal(Test_PDU_Head - Test_PDU_Tail, 0, NULL);
+    tsm_timer_milliseconds(1);
+    zassert_equal(
+        Test_PDU_Head - Test_PDU_Tail, (TEST_PEER_COUNT / 2) - 10, NULL);
+    Test_PDU_Tail = Test_PDU_Head;
+    tsm_timer_milliseconds(999);
+    zassert_equal(Test_PDU_Head - Test_PDU_Tail, 0, NULL);
+    tsm_timer_milliseconds(1);
+    zassert_equal(Test_PDU_Head - Test_PDU_Tail, TEST_PEER_COUNT / 2, NULL);
+    /* retries are exhausted after apdu_retries() more timeouts */
+    for (i = 0; i < 12; i++) {
+        Test_PDU_Tail = Test_PDU_Head;
+        tsm_timer_milliseconds(1000);
+    }
+    zassert_equal(Test_Peer_Timeouts, TEST_PEER_COUNT - 10, NULL);
+    zassert_equal(Test_Timeouts, 0, NULL);
+    for (i = 10; i < TEST_PEER_COUNT; i++) {
+        test_peer_address(&dest, i);
+        zassert_true(tsm_peer_invoke_id_failed(&dest, invoke_ids[i]), NULL);
+        tsm_peer_free_invoke_id(&dest, invoke_ids[i]);
+    }
+    zassert_equal(tsm_transaction_idle_count(), MAX_TSM_TRANSACTIONS, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(tsm_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        tsm_tests, ztest_unit_test(testSegmentedComplexAck),
+        ztest_unit_test(testSegmentLost),
+        ztest_unit_test(testSegmentedRequest),
+        ztest_unit_test(testSegmentedRequestTooLong),
+        ztest_unit_test(testSegmentationAbort),
+        ztest_unit_test(testPeerInvokeIDs), ztest_unit_test(testPeerTimers));
+
+    ztest_run_test_suite(tsm_tests);
+}
+#endif
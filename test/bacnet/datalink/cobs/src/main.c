@@ -10,7 +10,10 @@
 
 #include <zephyr/ztest.h>
 #include <stdlib.h>
+#include <string.h>
 #include <bacnet/datalink/cobs.h>
+#include <bacnet/datalink/crc.h>
+#include <bacnet/datalink/mstpdef.h>
 #include <bacnet/basic/sys/bytes.h>
 
 /**
@@ -52,6 +55,247 @@ static void test_COBS_Encode_Decode(void)
     zassert_true(
         test_buffer_length == sizeof(buffer), "COBS encode/decode length fail");
 }
+/**
+ * @brief COBS encode of one octet at a time, from the BACnet standard,
+ *  to compare with the word at a time encode
+ */
+static size_t test_cobs_encode(
+    uint8_t *buffer,
+    size_t buffer_size,
+    const uint8_t *from,
+    size_t length,
+    uint8_t mask)
+{
+    size_t code_index = 0;
+    size_t read_index = 0;
+    size_t write_index = 1;
+    uint8_t code = 1;
+    uint8_t data = 0;
+    uint8_t last_code = 0;
+
+    if ((buffer_size < 1) || (length < 1)) {
+        /* error - buffer too small */
+        return 0;
+    }
+    while (read_index < length) {
+        data = from[read_index++];
+        /*
+         * In the case of encountering a non-zero octet in the data,
+         * simply copy input to output and increment the code octet.
+         */
+        if (data != 0) {
+            if (write_index == buffer_size) {
+                /* error - buffer too small */
+                return 0;
+            }
+            buffer[write_index++] = data ^ mask;
+            code++;
+            if (code != 255) {
+                continue;
+            }
+        }
+        /*
+         * In the case of encountering a zero in the data or having
+         * copied the maximum number (254) of non-zero octets, store
+         * the code octet and reset the encoder state variables.
+         */
+        last_code = code;
+        if (code_index == buffer_size) {
+            /* error - buffer too small */
+            return 0;
+        }
+        buffer[code_index] = code ^ mask;
+        code_index = write_index++;
+        code = 1;
+    }
+    /*
+     * If the last chunk contains exactly 254 non-zero octets, then
+     * this exception is handled above (and returned length must be
+     * adjusted). Otherwise, encode the last chunk normally, as if
+     * a "phantom zero" is appended to the data.
+     */
+    if ((last_code == 255) && (code == 1)) {
+        write_index--;
+    } else {
+        if (code_index == buffer_size) {
+            /* error - buffer too small */
+            return 0;
+        }
+        buffer[code_index] = code ^ mask;
+    }
+
+    return write_index;
+}
+
+/**
+ * @brief COBS decode of one octet at a time, from the BACnet standard,
+ *  to compare with the word at a time decode
+ */
+static size_t test_cobs_decode(
+    uint8_t *buffer,
+    size_t buffer_size,
+    const uint8_t *from,
+    size_t length,
+    uint8_t mask)
+{
+    size_t read_index = 0;
+    size_t write_index = 0;
+    uint8_t code, last_code;
+
+    while (read_index < length) {
+        code = from[read_index] ^ mask;
+        last_code = code;
+        /*
+         * Sanity check the encoding to prevent the while() loop below
+         * from overrunning the output buffer.
+         */
+        if ((code == 0) || ((read_index + code) > length)) {
+            return 0;
+        }
+        read_index++;
+        while (--code > 0) {
+            if (write_index == buffer_size) {
+                /* error - destination buffer too small */
+                return 0;
+            }
+            if (read_index == length) {
+                /* error - source buffer too small */
+                return 0;
+            }
+            buffer[write_index++] = from[read_index++] ^ mask;
+        }
+        /*
+         * Restore the implicit zero at the end of each decoded block
+         * except when it contains exactly 254 non-zero octets or the
+         * end of data has been reached.
+         */
+        if ((last_code != 255) && (read_index < length)) {
+            if (write_index == buffer_size) {
+                /* error - destination buffer too small */
+                return 0;
+            }
+            buffer[write_index++] = 0;
+        }
+    }
+
+    return write_index;
+}
+
+/**
+ * @brief Fill a buffer with random octets, with some runs of zero or
+ *  non-zero octets longer than a COBS block
+ * @param buffer - buffer to fill
+ * @param length - number of octets in the buffer
+ * @param zeros - one in this many octets is zero
+ */
+static void test_cobs_fill(uint8_t *buffer, size_t length, unsigned zeros)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        if ((rand() % zeros) == 0) {
+            buffer[i] = 0;
+        } else {
+            buffer[i] = (uint8_t)(1 + (rand() % 255));
+        }
+    }
+}
+
+/**
+ * @brief Test that the buffer CRC-32K and the word at a time COBS encode
+ *  and decode give the same results as one octet at a time
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(cobs_tests, test_COBS_Bit_Exact)
+#else
+static void test_COBS_Bit_Exact(void)
+#endif
+{
+    static const unsigned zeros[] = { 1, 2, 16, 300, 100000 };
+    uint8_t buffer[1600] = { 0 };
+    uint8_t encoded[COBS_ENCODED_SIZE(1600)] = { 0 };
+    uint8_t test_encoded[COBS_ENCODED_SIZE(1600)] = { 0 };
+    uint8_t decoded[1600] = { 0 };
+    uint8_t test_decoded[1600] = { 0 };
+    size_t length, encoded_len, test_len, size, i;
+    uint32_t crc, test_crc;
+    unsigned z;
+
+    srand(1);
+    for (z = 0; z < (sizeof(zeros) / sizeof(zeros[0])); z++) {
+        test_cobs_fill(buffer, sizeof(buffer), zeros[z]);
+        for (length = 1; length <= sizeof(buffer); length += 1 + (length / 8)) {
+            crc = CRC32K_INITIAL_VALUE;
+            for (i = 0; i < length; i++) {
+                crc = cobs_crc32k(buffer[i], crc);
+            }
+            test_crc = cobs_crc32k_buffer(buffer, length, CRC32K_INITIAL_VALUE);
+            zassert_equal(crc, test_crc, "length=%u", (unsigned)length);
+            encoded_len = test_cobs_encode(
+                encoded, sizeof(encoded), buffer, length, 0x55);
+            test_len = cobs_encode(
+                test_encoded, sizeof(test_encoded), buffer, length, 0x55);
+            zassert_equal(encoded_len, test_len, "length=%u", (unsigned)length);
+            zassert_equal(memcmp(encoded, test_encoded, encoded_len), 0, NULL);
+            test_len = test_cobs_decode(
+                decoded, sizeof(decoded), encoded, encoded_len, 0x55);
+            zassert_equal(test_len, length, NULL);
+            test_len = cobs_decode(
+                test_decoded, sizeof(test_decoded), encoded, encoded_len, 0x55);
+            zassert_equal(test_len, length, NULL);
+            zassert_equal(memcmp(buffer, test_decoded, length), 0, NULL);
+            /* buffers that are too small */
+            for (size = 1; size < encoded_len; size += 1 + (size / 4)) {
+                test_len =
+                    cobs_encode(test_encoded, size, buffer, length, 0x55);
+                zassert_equal(test_len, 0, "size=%u", (unsigned)size);
+            }
+            for (size = 0; size < length; size += 1 + (size / 4)) {
+                test_len =
+                    cobs_decode(test_decoded, size, encoded, encoded_len, 0x55);
+                zassert_equal(
+                    test_len,
+                    test_cobs_decode(decoded, size, encoded, encoded_len, 0x55),
+                    "size=%u", (unsigned)size);
+            }
+        }
+    }
+    /* malformed encoding */
+    for (i = 0; i < 64; i++) {
+        test_cobs_fill(encoded, 64, 8);
+        test_len =
+            cobs_decode(test_decoded, sizeof(test_decoded), encoded, 64, 0);
+        encoded_len =
+            test_cobs_decode(decoded, sizeof(decoded), encoded, 64, 0);
+        zassert_equal(test_len, encoded_len, NULL);
+    }
+}
+
+/**
+ * @brief Test the COBS frame encode and decode of the largest BACnet
+ *  extended frame
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(cobs_tests, test_COBS_Frame_Largest)
+#else
+static void test_COBS_Frame_Largest(void)
+#endif
+{
+    uint8_t buffer[1497] = { 0 };
+    uint8_t encoded[COBS_ENCODED_SIZE(1497) + COBS_ENCODED_CRC_SIZE] = { 0 };
+    uint8_t decoded[1497] = { 0 };
+    size_t encoded_len = 0, decoded_len = 0;
+
+    srand(1);
+    test_cobs_fill(buffer, sizeof(buffer), 16);
+    encoded_len =
+        cobs_frame_encode(encoded, sizeof(encoded), buffer, sizeof(buffer));
+    zassert_true(encoded_len > sizeof(buffer), NULL);
+    decoded_len =
+        cobs_frame_decode(decoded, sizeof(decoded), encoded, encoded_len);
+    zassert_equal(decoded_len, sizeof(buffer), NULL);
+    zassert_equal(memcmp(buffer, decoded, sizeof(buffer)), 0, NULL);
+}
 /**
  * @}
  */
@@ -61,7 +305,10 @@ ZTEST_SUITE(cobs_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(cobs_tests, ztest_unit_test(test_COBS_Encode_Decode));
+    ztest_test_suite(
+        cobs_tests, ztest_unit_test(test_COBS_Encode_Decode),
+        ztest_unit_test(test_COBS_Bit_Exact),
+        ztest_unit_test(test_COBS_Frame_Largest));
 
     ztest_run_test_suite(cobs_tests);
 }
@@ -8,6 +8,7 @@
  * @brief test BACnet integer encode/decode APIs
  */
 
+#include <stdlib.h>
 #include <zephyr/ztest.h>
 #include <bacnet/datalink/crc.h>
 #include <bacnet/basic/sys/bytes.h>
@@ -131,6 +132,59 @@ static void testCRC16CreateTable(void)
     }
     printf("};\n");
 }
+/**
+ * @brief Test that the buffer CRC functions give the same values as the
+ *  octet CRC functions, for every length and alignment
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(crc_tests, testCRCBuffer)
+#else
+static void testCRCBuffer(void)
+#endif
+{
+    uint8_t buffer[600];
+    uint16_t crc16, test_crc16;
+    uint8_t crc8, test_crc8;
+    size_t offset, length, i;
+
+    srand(1);
+    for (i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)rand();
+    }
+    for (offset = 0; offset < 8; offset++) {
+        for (length = 0; length <= (sizeof(buffer) - 8); length++) {
+            crc16 = 0xFFFF;
+            for (i = 0; i < length; i++) {
+                crc16 = CRC_Calc_Data(buffer[offset + i], crc16);
+            }
+            test_crc16 = CRC_Calc_Data_Buffer(&buffer[offset], length, 0xFFFF);
+            zassert_equal(
+                crc16, test_crc16, "offset=%u length=%u", (unsigned)offset,
+                (unsigned)length);
+            if (length <= 8) {
+                crc8 = 0xFF;
+                for (i = 0; i < length; i++) {
+                    crc8 = CRC_Calc_Header(buffer[offset + i], crc8);
+                }
+                test_crc8 =
+                    CRC_Calc_Header_Buffer(&buffer[offset], length, 0xFF);
+                zassert_equal(crc8, test_crc8, NULL);
+            }
+        }
+    }
+    /* the Annex G example */
+    buffer[0] = 0x01;
+    buffer[1] = 0x22;
+    buffer[2] = 0x30;
+    crc16 = CRC_Calc_Data_Buffer(buffer, 3, 0xFFFF);
+    zassert_equal(crc16, 0x42EF, NULL);
+    buffer[3] = 0x10;
+    buffer[4] = 0xBD;
+    crc16 = CRC_Calc_Data_Buffer(buffer, 5, 0xFFFF);
+    zassert_equal(crc16, 0xF0B8, NULL);
+    zassert_equal(CRC_Calc_Data_Buffer(NULL, 5, 0x1234), 0x1234, NULL);
+}
+
 /**
  * @}
  */
@@ -143,7 +197,8 @@ void test_main(void)
     ztest_test_suite(
         crc_tests, ztest_unit_test(testCRC8), ztest_unit_test(testCRC16),
         ztest_unit_test(testCRC8CreateTable),
-        ztest_unit_test(testCRC16CreateTable));
+        ztest_unit_test(testCRC16CreateTable),
+        ztest_unit_test(testCRCBuffer));
 
     ztest_run_test_suite(crc_tests);
 }
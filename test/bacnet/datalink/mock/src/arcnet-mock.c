@@ -44,6 +44,15 @@ uint16_t arcnet_receive(
     return ztest_get_return_value();
 }
 
+unsigned arcnet_receive_handler(
+    void (*handler)(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len),
+    unsigned timeout)
+{
+    ztest_check_expected_value(handler);
+    ztest_check_expected_value(timeout);
+    return ztest_get_return_value();
+}
+
 void arcnet_get_my_address(BACNET_ADDRESS *my_address)
 {
     ztest_copy_return_data(my_address, sizeof(BACNET_ADDRESS));
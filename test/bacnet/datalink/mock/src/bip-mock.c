@@ -64,6 +64,18 @@ int bip_send_mpdu(
     return ztest_get_return_value();
 }
 
+int bip_send_mpdu_batch(
+    const BACNET_IP_ADDRESS *dest,
+    unsigned dest_count,
+    const uint8_t *mtu,
+    uint16_t mtu_len)
+{
+    ztest_check_expected_value(dest);
+    ztest_check_expected_value(dest_count);
+    ztest_check_expected_data(mtu, mtu_len);
+    return ztest_get_return_value();
+}
+
 uint16_t bip_receive(
     BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu, unsigned timeout)
 {
@@ -45,6 +45,15 @@ uint16_t ethernet_receive(
     return ztest_get_return_value();
 }
 
+unsigned ethernet_receive_handler(
+    void (*handler)(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len),
+    unsigned timeout)
+{
+    ztest_check_expected_value(handler);
+    ztest_check_expected_value(timeout);
+    return ztest_get_return_value();
+}
+
 void ethernet_set_my_address(const BACNET_ADDRESS *my_address)
 {
     ztest_check_expected_data(my_address, sizeof(BACNET_ADDRESS));
@@ -8,7 +8,12 @@
  * @brief test BACnet integer encode/decode APIs
  */
 
+#include <ctype.h>
+#include <string.h>
 #include <zephyr/ztest.h>
+#include <bacnet/bacenum.h>
+#include <bacnet/bactext.h>
+#include <bacnet/bacstr.h>
 #include <bacnet/indtext.h>
 
 /**
@@ -61,6 +66,139 @@ static void testIndexText(void)
     zassert_equal(
         index, indtext_by_istring_default(data_list, "ANNA", index), NULL);
 }
+/* pairs with the same text but for case, and their sorted positions */
+static INDTEXT_DATA data_case_list[] = { { 1, "Joshua" },   { 2, "Mary" },
+                                         { 3, "JOSHUA" },   { 4, "anna" },
+                                         { 5, "joshua" },   { 6, "Anna" },
+                                         { 0, NULL } };
+static const uint16_t data_case_sorted[] = { 3, 5, 0, 2, 4, 1 };
+static INDTEXT_SORTED data_case_index = { data_case_list, data_case_sorted,
+                                          6 };
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(indtext_tests, testIndexTextSorted)
+#else
+static void testIndexTextSorted(void)
+#endif
+{
+    static const char *search_names[] = { "Joshua", "JOSHUA", "joshua",
+                                          "jOSHUA", "Mary",   "MARY",
+                                          "anna",   "Anna",   "ANNA",
+                                          "Ann",    "Annas",  "",
+                                          "Zed",    "A" };
+    unsigned i, index, test_index;
+    bool status, test_status;
+
+    for (i = 0; i < (sizeof(search_names) / sizeof(search_names[0])); i++) {
+        index = test_index = 0;
+        status = indtext_by_string(data_case_list, search_names[i], &index);
+        test_status = indtext_sorted_by_string(
+            &data_case_index, search_names[i], &test_index);
+        zassert_equal(status, test_status, "%s", search_names[i]);
+        zassert_equal(index, test_index, "%s", search_names[i]);
+        index = test_index = 0;
+        status = indtext_by_istring(data_case_list, search_names[i], &index);
+        test_status = indtext_sorted_by_istring(
+            &data_case_index, search_names[i], &test_index);
+        zassert_equal(status, test_status, "%s", search_names[i]);
+        zassert_equal(index, test_index, "%s", search_names[i]);
+    }
+    zassert_false(indtext_sorted_by_string(&data_case_index, NULL, NULL), NULL);
+    zassert_false(indtext_sorted_by_istring(NULL, "Mary", NULL), NULL);
+    zassert_true(
+        indtext_sorted_by_istring(&data_case_index, "mary", NULL), NULL);
+}
+
+/**
+ * @brief Look up each name of a bactext table by name, and check that
+ *  the sorted index finds the same value as the list
+ * @param data_list - the bactext table
+ * @param index_function - bactext function that looks up a name
+ */
+static void test_bactext_sorted(
+    INDTEXT_DATA *data_list,
+    bool (*index_function)(const char *search_name, unsigned *found_index))
+{
+    INDTEXT_DATA *data;
+    char name[80];
+    unsigned index, test_index, i;
+
+    for (data = data_list; data->pString; data++) {
+        zassert_true(strlen(data->pString) < (sizeof(name) - 1), NULL);
+        zassert_true(
+            index_function(data->pString, &test_index), "%s", data->pString);
+        zassert_true(
+            indtext_by_istring(data_list, data->pString, &index), NULL);
+        zassert_equal(index, test_index, "%s", data->pString);
+        /* and in upper case */
+        for (i = 0; data->pString[i]; i++) {
+            name[i] = (char)toupper((unsigned char)data->pString[i]);
+        }
+        name[i] = 0;
+        zassert_true(index_function(name, &test_index), "%s", name);
+        zassert_equal(index, test_index, "%s", name);
+        /* and a name that is not in the table */
+        name[i] = 'x';
+        name[i + 1] = 0;
+        if (!indtext_by_istring(data_list, name, NULL)) {
+            zassert_false(index_function(name, &test_index), "%s", name);
+        }
+    }
+}
+
+/* tables in bactext.c that have sorted indexes */
+extern INDTEXT_DATA bacnet_application_tag_names[];
+extern INDTEXT_DATA bacnet_object_type_names[];
+extern INDTEXT_DATA bacnet_property_names[];
+extern INDTEXT_DATA bacnet_engineering_unit_names[];
+extern INDTEXT_DATA bacnet_days_of_week_names[];
+extern INDTEXT_DATA bacnet_notify_type_names[];
+extern INDTEXT_DATA bacnet_event_transition_names[];
+extern INDTEXT_DATA bacnet_event_state_names[];
+extern INDTEXT_DATA bacnet_event_type_names[];
+extern INDTEXT_DATA bacnet_binary_present_value_names[];
+extern INDTEXT_DATA bacnet_segmentation_names[];
+extern INDTEXT_DATA bacnet_lighting_operation_names[];
+extern INDTEXT_DATA bacnet_binary_lighting_pv_names[];
+
+/**
+ * @brief Test that the sorted indexes of the bactext tables match the
+ *  tables, which fails when a table changes and its index in
+ *  bactext_index.h is not generated again
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(indtext_tests, testBACTextSorted)
+#else
+static void testBACTextSorted(void)
+#endif
+{
+    test_bactext_sorted(
+        bacnet_application_tag_names, bactext_application_tag_index);
+    test_bactext_sorted(bacnet_object_type_names, bactext_object_type_index);
+    test_bactext_sorted(bacnet_object_type_names, bactext_object_type_strtol);
+    test_bactext_sorted(bacnet_property_names, bactext_property_index);
+    test_bactext_sorted(bacnet_property_names, bactext_property_strtol);
+    test_bactext_sorted(
+        bacnet_engineering_unit_names, bactext_engineering_unit_index);
+    test_bactext_sorted(bacnet_days_of_week_names, bactext_days_of_week_index);
+    test_bactext_sorted(bacnet_notify_type_names, bactext_notify_type_index);
+    test_bactext_sorted(
+        bacnet_event_transition_names, bactext_event_transition_index);
+    test_bactext_sorted(bacnet_event_state_names, bactext_event_state_index);
+    test_bactext_sorted(bacnet_event_state_names, bactext_event_state_strtol);
+    test_bactext_sorted(bacnet_event_type_names, bactext_event_type_index);
+    test_bactext_sorted(
+        bacnet_binary_present_value_names, bactext_binary_present_value_index);
+    test_bactext_sorted(bacnet_segmentation_names, bactext_segmentation_index);
+    test_bactext_sorted(
+        bacnet_lighting_operation_names, bactext_lighting_operation_strtol);
+    test_bactext_sorted(
+        bacnet_binary_lighting_pv_names,
+        bactext_binary_lighting_pv_names_strtol);
+    zassert_equal(
+        bactext_property_id("present-value"), PROP_PRESENT_VALUE, NULL);
+    zassert_equal(bactext_property_id("no-such-property"), 0, NULL);
+}
 /**
  * @}
  */
@@ -70,7 +208,10 @@ ZTEST_SUITE(indtext_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(indtext_tests, ztest_unit_test(testIndexText));
+    ztest_test_suite(
+        indtext_tests, ztest_unit_test(testIndexText),
+        ztest_unit_test(testIndexTextSorted),
+        ztest_unit_test(testBACTextSorted));
 
     ztest_run_test_suite(indtext_tests);
 }
@@ -204,6 +204,24 @@ static void testReadPropertyMultiple(void)
     zassert_equal(len, service_request_len, NULL);
 }
 
+/* results seen by the ReadPropertyMultiple-ACK process callback */
+static unsigned Test_Process_Count;
+static unsigned Test_Process_Error_Count;
+static BACNET_OBJECT_TYPE Test_Process_Object_Type;
+static uint32_t Test_Process_Object_Instance;
+
+static void test_rpm_ack_process_callback(
+    uint32_t device_id, BACNET_READ_PROPERTY_DATA *rp_data)
+{
+    (void)device_id;
+    Test_Process_Count++;
+    if (rp_data->error_code == ERROR_CODE_INVALID_TAG) {
+        Test_Process_Error_Count++;
+    }
+    Test_Process_Object_Type = rp_data->object_type;
+    Test_Process_Object_Instance = rp_data->object_instance;
+}
+
 #if defined(CONFIG_ZTEST_NEW_API)
 ZTEST(rpm_tests, testReadPropertyMultipleAck)
 #else
@@ -229,6 +247,11 @@ static void testReadPropertyMultipleAck(void)
     BACNET_ERROR_CLASS error_class;
     BACNET_ERROR_CODE error_code;
     BACNET_RPM_DATA rpmdata;
+    BACNET_READ_PROPERTY_DATA rp_data = { 0 };
+    uint8_t arena_buffer[1024] = { 0 };
+    BACNET_APPLICATION_DATA_ARENA arena = { 0 };
+    BACNET_READ_ACCESS_COMPACT *read_access = NULL;
+    BACNET_PROPERTY_REFERENCE_COMPACT *property = NULL;
 
     /* build the RPM - try to make it easy for the
        Application Layer development */
@@ -431,6 +454,63 @@ static void testReadPropertyMultipleAck(void)
         &object_instance);
     zassert_equal(test_len, 0, NULL);
     zassert_equal(len, service_request_len, NULL);
+    /* every result of every object is processed */
+    Test_Process_Count = 0;
+    Test_Process_Error_Count = 0;
+    rpm_ack_object_property_process(
+        service_request, service_request_len, 123, &rp_data,
+        test_rpm_ack_process_callback);
+    zassert_equal(Test_Process_Count, 4, NULL);
+    zassert_equal(Test_Process_Error_Count, 0, NULL);
+    zassert_equal(Test_Process_Object_Type, OBJECT_ANALOG_INPUT, NULL);
+    zassert_equal(Test_Process_Object_Instance, 33, NULL);
+    /* the whole reply is decoded into an arena */
+    bacapp_arena_init(&arena, arena_buffer, sizeof(arena_buffer));
+    test_len = rpm_ack_decode_compact(
+        service_request, service_request_len, &arena, &read_access);
+    zassert_equal(test_len, service_request_len, NULL);
+    zassert_not_null(read_access, NULL);
+    zassert_equal(read_access->object_type, OBJECT_DEVICE, NULL);
+    zassert_equal(read_access->object_instance, 123, NULL);
+    property = read_access->listOfProperties;
+    zassert_not_null(property, NULL);
+    zassert_equal(property->propertyIdentifier, PROP_OBJECT_IDENTIFIER, NULL);
+    zassert_equal(property->error.error_code, ERROR_CODE_SUCCESS, NULL);
+    zassert_not_null(property->value, NULL);
+    zassert_equal(property->value->tag, BACNET_APPLICATION_TAG_OBJECT_ID, NULL);
+    zassert_equal(property->value->type.Object_Id.instance, 123, NULL);
+    property = property->next;
+    zassert_not_null(property, NULL);
+    zassert_equal(property->propertyIdentifier, PROP_OBJECT_TYPE, NULL);
+    zassert_equal(property->value->type.Enumerated, OBJECT_DEVICE, NULL);
+    zassert_is_null(property->next, NULL);
+    read_access = read_access->next;
+    zassert_not_null(read_access, NULL);
+    zassert_equal(read_access->object_type, OBJECT_ANALOG_INPUT, NULL);
+    zassert_equal(read_access->object_instance, 33, NULL);
+    property = read_access->listOfProperties;
+    zassert_not_null(property, NULL);
+    zassert_equal(property->value->tag, BACNET_APPLICATION_TAG_REAL, NULL);
+    zassert_is_null(property->value->next, NULL);
+    property = property->next;
+    zassert_not_null(property, NULL);
+    zassert_equal(property->propertyIdentifier, PROP_DEADBAND, NULL);
+    zassert_is_null(property->value, NULL);
+    zassert_equal(property->error.error_class, ERROR_CLASS_PROPERTY, NULL);
+    zassert_equal(
+        property->error.error_code, ERROR_CODE_UNKNOWN_PROPERTY, NULL);
+    zassert_is_null(property->next, NULL);
+    zassert_is_null(read_access->next, NULL);
+    /* the arena is too small for the reply */
+    bacapp_arena_init(&arena, arena_buffer, 64);
+    test_len = rpm_ack_decode_compact(
+        service_request, service_request_len, &arena, &read_access);
+    zassert_equal(test_len, BACNET_STATUS_ABORT, NULL);
+    /* a truncated reply is malformed */
+    bacapp_arena_init(&arena, arena_buffer, sizeof(arena_buffer));
+    test_len = rpm_ack_decode_compact(
+        service_request, service_request_len - 2, &arena, &read_access);
+    zassert_equal(test_len, BACNET_STATUS_ERROR, NULL);
 }
 /**
  * @}
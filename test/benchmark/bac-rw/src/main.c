@@ -0,0 +1,227 @@
+/**
+ * @file
+ * @brief benchmark the throughput of the client that reads properties of
+ *  other devices, polling a server in this process over a loopback
+ *  datalink: one ReadProperty at a time, pipelined, and pipelined with
+ *  the polls of the same device coalesced into ReadPropertyMultiple.
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <bacnet/apdu.h>
+#include <bacnet/bacaddr.h>
+#include <bacnet/basic/binding/address.h>
+#include <bacnet/basic/client/bac-rw.h>
+#include <bacnet/basic/object/av.h>
+#include <bacnet/basic/object/device.h>
+#include <bacnet/basic/service/h_apdu.h>
+#include <bacnet/basic/service/h_noserv.h>
+#include <bacnet/basic/service/h_rp.h>
+#include <bacnet/basic/service/h_rpm.h>
+
+/* loopback datalink, from the client test stubs.c */
+extern BACNET_ADDRESS Test_Server_Address;
+extern BACNET_ADDRESS Test_Client_Address;
+extern unsigned Test_Server_PDU_Count;
+extern unsigned long Test_Milliseconds;
+unsigned test_loopback_receive(void);
+
+/* device instance of the client, and of the server it reads from */
+#define BENCHMARK_CLIENT_DEVICE_ID 1234
+#define BENCHMARK_SERVER_DEVICE_ID 4321
+/* number of points polled */
+#define BENCHMARK_POINTS 1024
+/* default number of times every point is polled */
+#define BENCHMARK_POLLS 20
+
+/* how the points are polled */
+enum benchmark_mode {
+    BENCHMARK_ONE_AT_A_TIME,
+    BENCHMARK_PIPELINED,
+    BENCHMARK_COALESCED
+};
+
+static unsigned long Benchmark_Value_Count;
+static unsigned long Benchmark_Error_Count;
+
+/**
+ * @brief Count the reply to a ReadProperty
+ * @param value [in] the value, or NULL for an error
+ */
+static void benchmark_value(const BACNET_APPLICATION_DATA_VALUE *value)
+{
+    if (value && (value->tag == BACNET_APPLICATION_TAG_REAL)) {
+        Benchmark_Value_Count++;
+    } else {
+        Benchmark_Error_Count++;
+    }
+}
+
+/**
+ * @brief Value callback of the requests queued without a callback
+ */
+static void benchmark_read_write_value_callback(
+    uint32_t device_instance,
+    BACNET_READ_PROPERTY_DATA *rp_data,
+    BACNET_APPLICATION_DATA_VALUE *value)
+{
+    (void)device_instance;
+    (void)rp_data;
+    benchmark_value(value);
+}
+
+/**
+ * @brief Callback of the requests queued with a callback of their own
+ */
+static void benchmark_request_callback(
+    uint32_t device_instance,
+    BACNET_READ_PROPERTY_DATA *rp_data,
+    BACNET_APPLICATION_DATA_VALUE *value,
+    void *context)
+{
+    (void)device_instance;
+    (void)rp_data;
+    (void)context;
+    benchmark_value(value);
+}
+
+/**
+ * @brief Prepare the server with analog value points, and the client
+ *  with the server bound in its address cache
+ */
+static void benchmark_setup(void)
+{
+    unsigned i;
+
+    Device_Init(NULL);
+    Device_Set_Object_Instance_Number(BENCHMARK_CLIENT_DEVICE_ID);
+    for (i = 0; i < BENCHMARK_POINTS; i++) {
+        Analog_Value_Create(i);
+        Analog_Value_Present_Value_Set(i, (float)i, BACNET_MAX_PRIORITY);
+    }
+    bacnet_read_write_init();
+    bacnet_read_write_value_callback_set(benchmark_read_write_value_callback);
+    apdu_set_unrecognized_service_handler_handler(handler_unrecognized_service);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_READ_PROPERTY, handler_read_property);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_READ_PROP_MULTIPLE, handler_read_property_multiple);
+    memset(&Test_Server_Address, 0, sizeof(BACNET_ADDRESS));
+    Test_Server_Address.mac_len = 1;
+    Test_Server_Address.mac[0] = 1;
+    memset(&Test_Client_Address, 0, sizeof(BACNET_ADDRESS));
+    Test_Client_Address.mac_len = 1;
+    Test_Client_Address.mac[0] = 2;
+    address_add(BENCHMARK_SERVER_DEVICE_ID, MAX_APDU, &Test_Server_Address);
+}
+
+/**
+ * @brief Poll the present value of every point, queueing them while
+ *  there is room, until all of them are replied to
+ * @param mode [in] how the points are polled
+ * @return number of times the client waited for the network
+ */
+static unsigned long benchmark_poll(enum benchmark_mode mode)
+{
+    unsigned next = 0;
+    unsigned long cycles = 0;
+
+    while ((next < BENCHMARK_POINTS) || !bacnet_read_write_idle()) {
+        while ((next < BENCHMARK_POINTS) && !bacnet_read_write_busy()) {
+            if (mode == BENCHMARK_COALESCED) {
+                (void)bacnet_read_property_request_queue(
+                    BENCHMARK_SERVER_DEVICE_ID, OBJECT_ANALOG_VALUE, next,
+                    PROP_PRESENT_VALUE, BACNET_ARRAY_ALL,
+                    benchmark_request_callback, NULL);
+            } else {
+                (void)bacnet_read_property_queue(
+                    BENCHMARK_SERVER_DEVICE_ID, OBJECT_ANALOG_VALUE, next,
+                    PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+            }
+            next++;
+        }
+        bacnet_read_write_task();
+        test_loopback_receive();
+        Test_Milliseconds++;
+        cycles++;
+    }
+
+    return cycles;
+}
+
+/**
+ * @brief Poll every point a number of times, and print the throughput
+ * @param name [in] name of the mode
+ * @param mode [in] how the points are polled
+ * @param polls [in] number of times every point is polled
+ * @return true if every point was read each time
+ */
+static bool
+benchmark_run(const char *name, enum benchmark_mode mode, unsigned polls)
+{
+    unsigned long cycles = 0;
+    unsigned long reads;
+    unsigned i;
+    clock_t start, clocks;
+    double seconds;
+
+    if (mode == BENCHMARK_ONE_AT_A_TIME) {
+        bacnet_read_write_transactions_set(1);
+    } else {
+        bacnet_read_write_transactions_set(
+            BACNET_READ_WRITE_TRANSACTIONS_MAX);
+    }
+    Test_Server_PDU_Count = 0;
+    Benchmark_Value_Count = 0;
+    Benchmark_Error_Count = 0;
+    start = clock();
+    for (i = 0; i < polls; i++) {
+        cycles += benchmark_poll(mode);
+    }
+    clocks = clock() - start;
+    reads = (unsigned long)BENCHMARK_POINTS * polls;
+    seconds = (double)clocks / CLOCKS_PER_SEC;
+    if (seconds <= 0.0) {
+        seconds = 1.0 / CLOCKS_PER_SEC;
+    }
+    printf(
+        "%-14s %lu reads in %u requests, %lu waits, %.3f s: "
+        "%.0f requests and %.0f reads per second\n",
+        name, reads, Test_Server_PDU_Count, cycles, seconds,
+        Test_Server_PDU_Count / seconds, reads / seconds);
+
+    return (Benchmark_Value_Count == reads) && (Benchmark_Error_Count == 0);
+}
+
+/**
+ * @brief Poll the server in each mode, and print the throughput
+ * @param argc [in] number of arguments
+ * @param argv [in] optional number of times every point is polled
+ * @return 0 on success, 1 if a point was not read
+ */
+int main(int argc, char *argv[])
+{
+    unsigned polls = BENCHMARK_POLLS;
+    bool status = true;
+
+    if (argc > 1) {
+        polls = (unsigned)strtoul(argv[1], NULL, 0);
+    }
+    benchmark_setup();
+    printf(
+        "Poll %u points %u times, up to %u outstanding requests\n",
+        BENCHMARK_POINTS, polls, BACNET_READ_WRITE_TRANSACTIONS_MAX);
+    status &= benchmark_run("one at a time", BENCHMARK_ONE_AT_A_TIME, polls);
+    status &= benchmark_run("pipelined", BENCHMARK_PIPELINED, polls);
+    status &= benchmark_run("coalesced", BENCHMARK_COALESCED, polls);
+    if (!status) {
+        printf("a point was not read\n");
+        return 1;
+    }
+
+    return 0;
+}
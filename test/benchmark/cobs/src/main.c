@@ -0,0 +1,252 @@
+/**
+ * @file
+ * @brief benchmark the COBS frame encode and decode of the largest BACnet
+ *  extended frames, one octet at a time as in the BACnet standard, and
+ *  word at a time with the buffer CRC-32K.
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <bacnet/datalink/cobs.h>
+#include <bacnet/datalink/crc.h>
+#include <bacnet/datalink/mstpdef.h>
+
+/* default number of frames encoded and decoded by each path */
+#define BENCHMARK_FRAMES 2000
+/* octets in the data of the largest BACnet extended frame */
+#define BENCHMARK_FRAME_SIZE 1497
+
+/**
+ * @brief COBS encode of one octet at a time, from the BACnet standard,
+ *  to compare with the word at a time encode
+ */
+static size_t benchmark_cobs_encode(
+    uint8_t *buffer,
+    size_t buffer_size,
+    const uint8_t *from,
+    size_t length,
+    uint8_t mask)
+{
+    size_t code_index = 0;
+    size_t read_index = 0;
+    size_t write_index = 1;
+    uint8_t code = 1;
+    uint8_t data = 0;
+    uint8_t last_code = 0;
+
+    if ((buffer_size < 1) || (length < 1)) {
+        /* error - buffer too small */
+        return 0;
+    }
+    while (read_index < length) {
+        data = from[read_index++];
+        /*
+         * In the case of encountering a non-zero octet in the data,
+         * simply copy input to output and increment the code octet.
+         */
+        if (data != 0) {
+            if (write_index == buffer_size) {
+                /* error - buffer too small */
+                return 0;
+            }
+            buffer[write_index++] = data ^ mask;
+            code++;
+            if (code != 255) {
+                continue;
+            }
+        }
+        /*
+         * In the case of encountering a zero in the data or having
+         * copied the maximum number (254) of non-zero octets, store
+         * the code octet and reset the encoder state variables.
+         */
+        last_code = code;
+        if (code_index == buffer_size) {
+            /* error - buffer too small */
+            return 0;
+        }
+        buffer[code_index] = code ^ mask;
+        code_index = write_index++;
+        code = 1;
+    }
+    /*
+     * If the last chunk contains exactly 254 non-zero octets, then
+     * this exception is handled above (and returned length must be
+     * adjusted). Otherwise, encode the last chunk normally, as if
+     * a "phantom zero" is appended to the data.
+     */
+    if ((last_code == 255) && (code == 1)) {
+        write_index--;
+    } else {
+        if (code_index == buffer_size) {
+            /* error - buffer too small */
+            return 0;
+        }
+        buffer[code_index] = code ^ mask;
+    }
+
+    return write_index;
+}
+
+/**
+ * @brief COBS decode of one octet at a time, from the BACnet standard,
+ *  to compare with the word at a time decode
+ */
+static size_t benchmark_cobs_decode(
+    uint8_t *buffer,
+    size_t buffer_size,
+    const uint8_t *from,
+    size_t length,
+    uint8_t mask)
+{
+    size_t read_index = 0;
+    size_t write_index = 0;
+    uint8_t code, last_code;
+
+    while (read_index < length) {
+        code = from[read_index] ^ mask;
+        last_code = code;
+        /*
+         * Sanity check the encoding to prevent the while() loop below
+         * from overrunning the output buffer.
+         */
+        if ((code == 0) || ((read_index + code) > length)) {
+            return 0;
+        }
+        read_index++;
+        while (--code > 0) {
+            if (write_index == buffer_size) {
+                /* error - destination buffer too small */
+                return 0;
+            }
+            if (read_index == length) {
+                /* error - source buffer too small */
+                return 0;
+            }
+            buffer[write_index++] = from[read_index++] ^ mask;
+        }
+        /*
+         * Restore the implicit zero at the end of each decoded block
+         * except when it contains exactly 254 non-zero octets or the
+         * end of data has been reached.
+         */
+        if ((last_code != 255) && (read_index < length)) {
+            if (write_index == buffer_size) {
+                /* error - destination buffer too small */
+                return 0;
+            }
+            buffer[write_index++] = 0;
+        }
+    }
+
+    return write_index;
+}
+
+/**
+ * @brief Fill a buffer with random octets, with some runs of zero or
+ *  non-zero octets longer than a COBS block
+ * @param buffer - buffer to fill
+ * @param length - number of octets in the buffer
+ * @param zeros - one in this many octets is zero
+ */
+static void
+benchmark_cobs_fill(uint8_t *buffer, size_t length, unsigned zeros)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        if ((rand() % zeros) == 0) {
+            buffer[i] = 0;
+        } else {
+            buffer[i] = (uint8_t)(1 + (rand() % 255));
+        }
+    }
+}
+
+
+/**
+ * @brief Print the time taken by one path
+ * @param name [in] name of the path
+ * @param frames [in] number of frames encoded and decoded
+ * @param clocks [in] processor time taken
+ */
+static void benchmark_report(
+    const char *name, unsigned long frames, clock_t clocks)
+{
+    double seconds = (double)clocks / CLOCKS_PER_SEC;
+
+    if (seconds <= 0.0) {
+        printf("%-10s %lu frames in less than a clock tick\n", name, frames);
+        return;
+    }
+    printf(
+        "%-10s %lu frames in %.3f s: %.2f us each, %.0f per second\n", name,
+        frames, seconds, (seconds * 1000000.0) / frames, frames / seconds);
+}
+
+/**
+ * @brief Encode and decode the frames by each path, and print the time
+ * @param argc [in] number of arguments
+ * @param argv [in] optional number of frames for each path
+ * @return 0 on success, 1 if a path did not decode the frame it encoded
+ */
+int main(int argc, char *argv[])
+{
+    static uint8_t buffer[BENCHMARK_FRAME_SIZE];
+    static uint8_t encoded
+        [COBS_ENCODED_SIZE(BENCHMARK_FRAME_SIZE) + COBS_ENCODED_CRC_SIZE];
+    static uint8_t decoded[BENCHMARK_FRAME_SIZE];
+    static uint8_t test_decoded[BENCHMARK_FRAME_SIZE];
+    unsigned long frames = BENCHMARK_FRAMES;
+    unsigned long frame;
+    clock_t start, octet_clocks, frame_clocks;
+    uint32_t crc = CRC32K_INITIAL_VALUE;
+    size_t encoded_len = 0, decoded_len = 0, test_len = 0, i;
+
+    if (argc > 1) {
+        frames = strtoul(argv[1], NULL, 0);
+    }
+    srand(1);
+    benchmark_cobs_fill(buffer, sizeof(buffer), 16);
+    start = clock();
+    for (frame = 0; frame < frames; frame++) {
+        encoded_len = benchmark_cobs_encode(
+            encoded, sizeof(encoded), buffer, sizeof(buffer), 0x55);
+        for (i = 0; i < encoded_len; i++) {
+            crc = cobs_crc32k(encoded[i], crc);
+        }
+        decoded_len = benchmark_cobs_decode(
+            decoded, sizeof(decoded), encoded, encoded_len, 0x55);
+        for (i = 0; i < encoded_len; i++) {
+            crc = cobs_crc32k(encoded[i], crc);
+        }
+    }
+    octet_clocks = clock() - start;
+    start = clock();
+    for (frame = 0; frame < frames; frame++) {
+        encoded_len = cobs_frame_encode(
+            encoded, sizeof(encoded), buffer, sizeof(buffer));
+        test_len = cobs_frame_decode(
+            test_decoded, sizeof(test_decoded), encoded, encoded_len);
+    }
+    frame_clocks = clock() - start;
+    printf(
+        "COBS frames of %u octets, word at a time with slice-by-%u CRC-32K "
+        "(crc=%08lx)\n",
+        (unsigned)sizeof(buffer), CRC_SLICE_BY, (unsigned long)crc);
+    benchmark_report("octet", frames, octet_clocks);
+    benchmark_report("word", frames, frame_clocks);
+    if ((frames > 0) &&
+        ((decoded_len != sizeof(buffer)) || (test_len != sizeof(buffer)) ||
+         (memcmp(buffer, decoded, sizeof(buffer)) != 0) ||
+         (memcmp(buffer, test_decoded, sizeof(buffer)) != 0))) {
+        printf("COBS decode did not match the frame encoded\n");
+        return 1;
+    }
+
+    return 0;
+}
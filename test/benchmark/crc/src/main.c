@@ -0,0 +1,84 @@
+/**
+ * @file
+ * @brief benchmark the MS/TP data CRC of the largest data frames, one
+ *  octet at a time and with the buffer CRC function.
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <bacnet/datalink/crc.h>
+
+/* default number of frames checked by each path */
+#define BENCHMARK_FRAMES 20000
+/* octets in the data of the largest MS/TP data frame */
+#define BENCHMARK_FRAME_SIZE 501
+
+/**
+ * @brief Print the time taken by one path
+ * @param name [in] name of the path
+ * @param frames [in] number of frames checked
+ * @param clocks [in] processor time taken
+ */
+static void benchmark_report(
+    const char *name, unsigned long frames, clock_t clocks)
+{
+    double seconds = (double)clocks / CLOCKS_PER_SEC;
+
+    if (seconds <= 0.0) {
+        printf("%-10s %lu frames in less than a clock tick\n", name, frames);
+        return;
+    }
+    printf(
+        "%-10s %lu frames in %.3f s: %.2f us each, %.1f MB per second\n",
+        name, frames, seconds, (seconds * 1000000.0) / frames,
+        ((double)frames * BENCHMARK_FRAME_SIZE) / (seconds * 1000000.0));
+}
+
+/**
+ * @brief Compute the CRC of the frames by each path, and print the time
+ * @param argc [in] number of arguments
+ * @param argv [in] optional number of frames checked by each path
+ * @return 0 on success, 1 if the paths do not agree
+ */
+int main(int argc, char *argv[])
+{
+    uint8_t buffer[BENCHMARK_FRAME_SIZE];
+    uint16_t crc16 = 0xFFFF, test_crc16 = 0xFFFF;
+    unsigned long frames = BENCHMARK_FRAMES;
+    unsigned long frame;
+    clock_t start, octet_clocks, buffer_clocks;
+    size_t i;
+
+    if (argc > 1) {
+        frames = strtoul(argv[1], NULL, 0);
+    }
+    for (i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)(i * 7);
+    }
+    start = clock();
+    for (frame = 0; frame < frames; frame++) {
+        for (i = 0; i < sizeof(buffer); i++) {
+            crc16 = CRC_Calc_Data(buffer[i], crc16);
+        }
+    }
+    octet_clocks = clock() - start;
+    start = clock();
+    for (frame = 0; frame < frames; frame++) {
+        test_crc16 = CRC_Calc_Data_Buffer(buffer, sizeof(buffer), test_crc16);
+    }
+    buffer_clocks = clock() - start;
+    printf(
+        "MS/TP data CRC of %u octet frames, buffer slice-by-%u\n",
+        (unsigned)sizeof(buffer), CRC_SLICE_BY);
+    benchmark_report("octet", frames, octet_clocks);
+    benchmark_report("buffer", frames, buffer_clocks);
+    if (crc16 != test_crc16) {
+        printf("CRC mismatch: %04X and %04X\n", crc16, test_crc16);
+        return 1;
+    }
+
+    return 0;
+}
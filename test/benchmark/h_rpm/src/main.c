@@ -0,0 +1,185 @@
+/**
+ * @file
+ * @brief benchmark the ReadPropertyMultiple response for ALL properties
+ *  of the Device object, encoded the way the handler used to, by copying
+ *  each value through a scratch buffer, and encoded in place by the
+ *  handler.
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <bacnet/basic/object/device.h>
+#include <bacnet/basic/service/h_rpm.h>
+#include <bacnet/npdu.h>
+#include <bacnet/proplist.h>
+#include <bacnet/rp.h>
+#include <bacnet/rpm.h>
+
+/* the length of the most recent PDU sent, from stubs.c */
+extern unsigned Benchmark_Sent_PDU_Len;
+
+/* default number of responses encoded by each path */
+#define BENCHMARK_REQUESTS 20000
+
+/**
+ * @brief Encode a ReadPropertyMultiple request for one property
+ * @param service_request [out] buffer for the request
+ * @param object_type [in] object type
+ * @param object_instance [in] object instance
+ * @param object_property [in] property, or ALL
+ * @return length of the request
+ */
+static int benchmark_rpm_request(
+    uint8_t *service_request,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID object_property)
+{
+    int len = 0;
+
+    len = rpm_encode_apdu_object_begin(
+        &service_request[len], object_type, object_instance);
+    len += rpm_encode_apdu_object_property(
+        &service_request[len], object_property, BACNET_ARRAY_ALL);
+    len += rpm_encode_apdu_object_end(&service_request[len]);
+
+    return len;
+}
+
+/**
+ * @brief Encode a ReadPropertyMultiple-ACK for ALL properties of an object
+ *  the way the handler used to: each value is read into a scratch buffer
+ *  and then copied into the response.
+ * @param apdu [out] buffer for the response
+ * @param invoke_id [in] invoke ID of the request
+ * @param rpmdata [in] object type and instance
+ * @return length of the response
+ */
+static int benchmark_rpm_ack_all_copy(
+    uint8_t *apdu, uint8_t invoke_id, BACNET_RPM_DATA *rpmdata)
+{
+    static uint8_t value[MAX_APDU];
+    struct special_property_list_t property_list = { 0 };
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    const int *pList[3];
+    unsigned count[3];
+    unsigned i, n;
+    int apdu_len = 0;
+    int len = 0;
+
+    apdu_len = rpm_ack_encode_apdu_init(apdu, invoke_id);
+    apdu_len += rpm_ack_encode_apdu_object_begin(&apdu[apdu_len], rpmdata);
+    Device_Objects_Property_List(
+        rpmdata->object_type, rpmdata->object_instance, &property_list);
+    pList[0] = property_list.Required.pList;
+    count[0] = property_list.Required.count;
+    pList[1] = property_list.Optional.pList;
+    count[1] = property_list.Optional.count;
+    pList[2] = property_list.Proprietary.pList;
+    count[2] = property_list.Proprietary.count;
+    for (i = 0; i < 3; i++) {
+        for (n = 0; n < count[i]; n++) {
+            rpdata.object_type = rpmdata->object_type;
+            rpdata.object_instance = rpmdata->object_instance;
+            rpdata.object_property = (BACNET_PROPERTY_ID)pList[i][n];
+            rpdata.array_index = BACNET_ARRAY_ALL;
+            rpdata.application_data = &value[0];
+            rpdata.application_data_len = sizeof(value);
+            apdu_len += rpm_ack_encode_apdu_object_property(
+                &apdu[apdu_len], rpdata.object_property, rpdata.array_index);
+            len = Device_Read_Property(&rpdata);
+            if (len >= 0) {
+                apdu_len += rpm_ack_encode_apdu_object_property_value(
+                    &apdu[apdu_len], &value[0], (unsigned)len);
+            } else {
+                apdu_len += rpm_ack_encode_apdu_object_property_error(
+                    &apdu[apdu_len], rpdata.error_class, rpdata.error_code);
+            }
+        }
+    }
+    apdu_len += rpm_ack_encode_apdu_object_end(&apdu[apdu_len]);
+
+    return apdu_len;
+}
+
+/**
+ * @brief Print the time taken by one path
+ * @param name [in] name of the path
+ * @param requests [in] number of responses encoded
+ * @param clocks [in] processor time taken
+ */
+static void benchmark_report(
+    const char *name, unsigned long requests, clock_t clocks)
+{
+    double seconds = (double)clocks / CLOCKS_PER_SEC;
+
+    if (seconds <= 0.0) {
+        printf(
+            "%-10s %lu responses in less than a clock tick\n", name,
+            requests);
+        return;
+    }
+    printf(
+        "%-10s %lu responses in %.3f s: %.2f us each, %.0f per second\n",
+        name, requests, seconds, (seconds * 1000000.0) / requests,
+        requests / seconds);
+}
+
+/**
+ * @brief Encode the response by each path, and print the time taken
+ * @param argc [in] number of arguments
+ * @param argv [in] optional number of responses encoded by each path
+ * @return 0 on success, 1 if the paths do not agree
+ */
+int main(int argc, char *argv[])
+{
+    static uint8_t apdu[MAX_APDU];
+    uint8_t service_request[MAX_APDU] = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    BACNET_RPM_DATA rpmdata = { 0 };
+    unsigned long requests = BENCHMARK_REQUESTS;
+    unsigned long i;
+    clock_t start, copy_clocks, in_place_clocks;
+    int apdu_len = 0;
+    int len = 0;
+
+    if (argc > 1) {
+        requests = strtoul(argv[1], NULL, 0);
+    }
+    Device_Init(NULL);
+    rpmdata.object_type = OBJECT_DEVICE;
+    rpmdata.object_instance = Device_Object_Instance_Number();
+    len = benchmark_rpm_request(
+        service_request, rpmdata.object_type, rpmdata.object_instance,
+        PROP_ALL);
+    service_data.invoke_id = 1;
+    service_data.max_resp = MAX_APDU;
+    start = clock();
+    for (i = 0; i < requests; i++) {
+        apdu_len = benchmark_rpm_ack_all_copy(
+            apdu, service_data.invoke_id, &rpmdata);
+    }
+    copy_clocks = clock() - start;
+    start = clock();
+    for (i = 0; i < requests; i++) {
+        handler_read_property_multiple(
+            service_request, (uint16_t)len, &src, &service_data);
+    }
+    in_place_clocks = clock() - start;
+    printf(
+        "ReadPropertyMultiple ALL of the Device object, %d octet APDU\n",
+        apdu_len);
+    benchmark_report("copy", requests, copy_clocks);
+    benchmark_report("in place", requests, in_place_clocks);
+    /* the handler also decodes the request and adds the NPDU header */
+    if ((apdu_len <= 0) || (Benchmark_Sent_PDU_Len <= (unsigned)apdu_len)) {
+        printf("the in place response is not the expected length\n");
+        return 1;
+    }
+
+    return 0;
+}
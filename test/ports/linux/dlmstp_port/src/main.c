@@ -0,0 +1,338 @@
+/**
+ * @file
+ * @brief test of the queues between the application and the port thread
+ *  of the Linux multi-port MS/TP driver
+ * @date 2024
+ *
+ * The port is not opened. The tests take the part of the port thread by
+ * calling the functions that the MS/TP state machines call.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <zephyr/ztest.h>
+#include <bacnet/datalink/mstp.h>
+#include "dlmstp_port.h"
+
+/* number of packets passed through each queue by the thread tests */
+#define TEST_PACKET_COUNT 10000
+/* offset of the data in an MS/TP frame */
+#define TEST_FRAME_DATA_OFFSET 8
+
+extern unsigned Test_RS485_Frames;
+
+static struct mstp_port_struct_t Test_Port;
+static SHARED_MSTP_DATA Test_Shared;
+
+/**
+ * @brief Set up the port as dlmstp_init() does, without the UART
+ *  or the port thread
+ */
+static void test_port_init(void)
+{
+    memset(&Test_Port, 0, sizeof(Test_Port));
+    memset(&Test_Shared, 0, sizeof(Test_Shared));
+    Test_Port.UserData = &Test_Shared;
+    Test_Port.InputBuffer = Test_Shared.RxBuffer;
+    Test_Port.InputBufferSize = sizeof(Test_Shared.RxBuffer);
+    Test_Port.OutputBuffer = Test_Shared.TxBuffer;
+    Test_Port.OutputBufferSize = sizeof(Test_Shared.TxBuffer);
+    Test_Port.This_Station = 1;
+    Test_Shared.Frame_Answered = true;
+    zassert_equal(sem_init(&Test_Shared.Receive_Packet_Flag, 0, 0), 0, NULL);
+}
+
+static void test_port_cleanup(void)
+{
+    sem_destroy(&Test_Shared.Receive_Packet_Flag);
+}
+
+static uint64_t test_microseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000ULL) +
+        ((uint64_t)now.tv_nsec / 1000ULL);
+}
+
+/**
+ * @brief Send a numbered NPDU from the application
+ * @return the value of dlmstp_send_pdu()
+ */
+static int test_send(uint32_t number)
+{
+    BACNET_ADDRESS dest = { 0 };
+    uint8_t pdu[8] = { 0x01, 0x00 };
+
+    dest.mac_len = 1;
+    dest.mac[0] = 2;
+    memcpy(&pdu[2], &number, sizeof(number));
+
+    return dlmstp_send_pdu(&Test_Port, &dest, pdu, sizeof(pdu));
+}
+
+/**
+ * @brief Take the next frame to send, as the port thread does
+ * @param number - the number that was sent in the frame, or UINT32_MAX
+ *  if the frame is not the one that was sent
+ * @return true if there was a frame to send
+ */
+static bool test_get_send(uint32_t *number)
+{
+    uint16_t frame_len;
+
+    frame_len = MSTP_Get_Send(&Test_Port, 0);
+    if (frame_len == 0) {
+        return false;
+    }
+    memcpy(
+        number, &Test_Shared.TxBuffer[TEST_FRAME_DATA_OFFSET + 2],
+        sizeof(*number));
+    if ((Test_Shared.TxBuffer[2] !=
+         FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY) ||
+        (Test_Shared.TxBuffer[3] != 2)) {
+        /* no number that was sent */
+        *number = UINT32_MAX;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Put a numbered frame from station 3 in the receive queue,
+ *  as the port thread does
+ * @return the value of MSTP_Put_Receive()
+ */
+static uint16_t test_put_receive(uint32_t number)
+{
+    Test_Port.FrameType = FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY;
+    Test_Port.SourceAddress = 3;
+    Test_Port.DataLength = sizeof(number);
+    memcpy(Test_Shared.RxBuffer, &number, sizeof(number));
+    Test_Shared.Frame_Timestamp = number;
+
+    return MSTP_Put_Receive(&Test_Port);
+}
+
+/**
+ * @brief Receive a numbered NPDU in the application
+ * @param timeout - milliseconds to wait
+ * @return true if an NPDU was received
+ */
+static bool test_receive(uint32_t *number, unsigned timeout)
+{
+    BACNET_ADDRESS src = { 0 };
+    uint8_t pdu[MAX_PDU] = { 0 };
+    uint64_t timestamp = 0;
+    uint16_t pdu_len;
+
+    pdu_len = dlmstp_receive_timestamp(
+        &Test_Port, &src, pdu, sizeof(pdu), timeout, &timestamp);
+    if (pdu_len == 0) {
+        return false;
+    }
+    zassert_equal(pdu_len, sizeof(*number), NULL);
+    zassert_equal(src.mac_len, 1, NULL);
+    zassert_equal(src.mac[0], 3, NULL);
+    memcpy(number, pdu, sizeof(*number));
+    zassert_equal(timestamp, *number, NULL);
+
+    return true;
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(dlmstp_port_tests, test_dlmstp_port_send_queue)
+#else
+static void test_dlmstp_port_send_queue(void)
+#endif
+{
+    uint32_t number = 0;
+    uint32_t i;
+
+    test_port_init();
+    zassert_false(test_get_send(&number), NULL);
+    for (i = 0; i < MSTP_PDU_PACKET_COUNT; i++) {
+        zassert_equal(test_send(i), 8, NULL);
+    }
+    /* full */
+    zassert_equal(test_send(i), 0, NULL);
+    for (i = 0; i < MSTP_PDU_PACKET_COUNT; i++) {
+        zassert_true(test_get_send(&number), NULL);
+        zassert_equal(number, i, NULL);
+    }
+    zassert_false(test_get_send(&number), NULL);
+    /* the indexes wrap around the queue */
+    for (i = 0; i < (3 * MSTP_PDU_PACKET_COUNT); i++) {
+        zassert_equal(test_send(i), 8, NULL);
+        zassert_true(test_get_send(&number), NULL);
+        zassert_equal(number, i, NULL);
+    }
+    test_port_cleanup();
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(dlmstp_port_tests, test_dlmstp_port_receive_queue)
+#else
+static void test_dlmstp_port_receive_queue(void)
+#endif
+{
+    struct dlmstp_port_statistics statistics = { 0 };
+    uint32_t number = 0;
+    uint32_t i;
+
+    test_port_init();
+    zassert_false(test_receive(&number, 0), NULL);
+    for (i = 0; i < MSTP_RECEIVE_PACKET_COUNT; i++) {
+        zassert_equal(test_put_receive(i), sizeof(number), NULL);
+    }
+    /* full, so the frame is dropped and counted */
+    zassert_equal(test_put_receive(i), 0, NULL);
+    zassert_true(dlmstp_port_fill_statistics(&Test_Port, &statistics), NULL);
+    zassert_equal(statistics.receive_dropped, 1, NULL);
+    for (i = 0; i < MSTP_RECEIVE_PACKET_COUNT; i++) {
+        zassert_true(test_receive(&number, 0), NULL);
+        zassert_equal(number, i, NULL);
+    }
+    zassert_false(test_receive(&number, 10), NULL);
+    dlmstp_port_reset_statistics(&Test_Port);
+    zassert_true(dlmstp_port_fill_statistics(&Test_Port, &statistics), NULL);
+    zassert_equal(statistics.receive_dropped, 0, NULL);
+    zassert_false(dlmstp_port_fill_statistics(NULL, &statistics), NULL);
+    zassert_false(dlmstp_port_fill_statistics(&Test_Port, NULL), NULL);
+    test_port_cleanup();
+}
+
+/* frames sent by the application that the port thread saw out of order */
+static unsigned Test_Send_Errors;
+
+/**
+ * @brief Take the part of the port thread: take the frames to send, and
+ *  put numbered frames in the receive queue whenever it has room
+ */
+static void *test_port_task(void *arg)
+{
+    uint32_t sent = 0;
+    uint32_t received = 0;
+    uint32_t number = 0;
+    unsigned head;
+    bool idle;
+
+    (void)arg;
+    while ((sent < TEST_PACKET_COUNT) || (received < TEST_PACKET_COUNT)) {
+        idle = true;
+        head = __atomic_load_n(&Test_Shared.Receive_Head, __ATOMIC_ACQUIRE);
+        if ((sent < TEST_PACKET_COUNT) &&
+            ((Test_Shared.Receive_Tail - head) < MSTP_RECEIVE_PACKET_COUNT)) {
+            if (test_put_receive(sent) > 0) {
+                sent++;
+                idle = false;
+            }
+        }
+        if ((received < TEST_PACKET_COUNT) && test_get_send(&number)) {
+            if (number != received) {
+                Test_Send_Errors++;
+            }
+            received++;
+            idle = false;
+        }
+        if (idle) {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(dlmstp_port_tests, test_dlmstp_port_threads)
+#else
+static void test_dlmstp_port_threads(void)
+#endif
+{
+    struct dlmstp_port_statistics statistics = { 0 };
+    pthread_t thread;
+    uint32_t sent = 0;
+    uint32_t received = 0;
+    uint32_t number = 0;
+
+    test_port_init();
+    Test_Send_Errors = 0;
+    zassert_equal(
+        pthread_create(&thread, NULL, test_port_task, NULL), 0, NULL);
+    while ((sent < TEST_PACKET_COUNT) || (received < TEST_PACKET_COUNT)) {
+        if ((sent < TEST_PACKET_COUNT) && (test_send(sent) > 0)) {
+            sent++;
+        }
+        if ((received < TEST_PACKET_COUNT) && test_receive(&number, 1)) {
+            /* every packet, in order */
+            zassert_equal(number, received, NULL);
+            received++;
+        }
+    }
+    zassert_equal(pthread_join(thread, NULL), 0, NULL);
+    zassert_equal(Test_Send_Errors, 0, NULL);
+    zassert_true(dlmstp_port_fill_statistics(&Test_Port, &statistics), NULL);
+    zassert_equal(statistics.receive_dropped, 0, NULL);
+    test_port_cleanup();
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(dlmstp_port_tests, test_dlmstp_port_reply_latency)
+#else
+static void test_dlmstp_port_reply_latency(void)
+#endif
+{
+    struct dlmstp_port_statistics statistics = { 0 };
+    uint8_t frame[8] = { 0 };
+
+    test_port_init();
+    Test_RS485_Frames = 0;
+    /* an answer 5ms after the end of the frame to this station */
+    Test_Shared.Frame_Timestamp = test_microseconds() - 5000;
+    Test_Shared.Frame_Answered = false;
+    MSTP_Send_Frame(&Test_Port, frame, sizeof(frame));
+    zassert_equal(Test_RS485_Frames, 1, NULL);
+    zassert_true(dlmstp_port_fill_statistics(&Test_Port, &statistics), NULL);
+    zassert_true(statistics.reply_latency >= 5000, NULL);
+    zassert_equal(statistics.reply_latency, statistics.reply_latency_max, NULL);
+    /* only the first frame sent is the answer */
+    Test_Shared.Frame_Timestamp = 0;
+    MSTP_Send_Frame(&Test_Port, frame, sizeof(frame));
+    zassert_equal(Test_RS485_Frames, 2, NULL);
+    zassert_true(dlmstp_port_fill_statistics(&Test_Port, &statistics), NULL);
+    zassert_equal(statistics.reply_latency, statistics.reply_latency_max, NULL);
+    zassert_true(statistics.reply_latency < 1000000, NULL);
+    /* a faster answer keeps the most */
+    Test_Shared.Frame_Timestamp = test_microseconds();
+    Test_Shared.Frame_Answered = false;
+    MSTP_Send_Frame(&Test_Port, frame, sizeof(frame));
+    zassert_true(dlmstp_port_fill_statistics(&Test_Port, &statistics), NULL);
+    zassert_true(statistics.reply_latency < 5000, NULL);
+    zassert_true(statistics.reply_latency_max >= 5000, NULL);
+    dlmstp_port_reset_statistics(&Test_Port);
+    zassert_true(dlmstp_port_fill_statistics(&Test_Port, &statistics), NULL);
+    zassert_equal(statistics.reply_latency, 0, NULL);
+    zassert_equal(statistics.reply_latency_max, 0, NULL);
+    test_port_cleanup();
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(dlmstp_port_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        dlmstp_port_tests, ztest_unit_test(test_dlmstp_port_send_queue),
+        ztest_unit_test(test_dlmstp_port_receive_queue),
+        ztest_unit_test(test_dlmstp_port_threads),
+        ztest_unit_test(test_dlmstp_port_reply_latency));
+
+    ztest_run_test_suite(dlmstp_port_tests);
+}
+#endif
@@ -0,0 +1,31 @@
+/**
+ * @file
+ * @brief RS-485 stubs for the test of the Linux multi-port MS/TP driver
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdint.h>
+#include "bacnet/datalink/mstp.h"
+#include "rs485.h"
+
+/* number of frames given to RS485_Send_Frame() */
+unsigned Test_RS485_Frames;
+
+void RS485_Send_Frame(
+    struct mstp_port_struct_t *mstp_port,
+    const uint8_t *buffer,
+    uint16_t nbytes)
+{
+    (void)mstp_port;
+    (void)buffer;
+    (void)nbytes;
+    Test_RS485_Frames++;
+}
+
+uint32_t RS485_Get_Port_Baud_Rate(struct mstp_port_struct_t *mstp_port)
+{
+    (void)mstp_port;
+
+    return 38400;
+}
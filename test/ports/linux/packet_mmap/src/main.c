@@ -0,0 +1,225 @@
+/**
+ * @file
+ * @brief test of the TPACKET_V3 receive ring for BACnet Ethernet
+ * @date 2024
+ *
+ * The filter test runs anywhere. The ring test needs root to create
+ * a veth pair, and passes without testing the ring when it cannot.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/if_ether.h>
+#include <zephyr/ztest.h>
+#include <bacnet/bacint.h>
+#include <bacnet/datalink/ethernet.h>
+#include "packet-mmap.h"
+
+/* both ends of the veth pair */
+#define TEST_IFNAME_PEER "bacnet-veth0"
+#define TEST_IFNAME_IUT "bacnet-veth1"
+
+static const uint8_t Test_LSAP[2] = { 0x82, 0x82 };
+static const uint8_t Test_Broadcast[6] = { 0xFF, 0xFF, 0xFF,
+                                           0xFF, 0xFF, 0xFF };
+
+/* NPDUs given to the handler */
+static unsigned Test_Handler_Count;
+static uint8_t Test_Handler_PDU[MAX_PDU];
+static uint16_t Test_Handler_PDU_Len;
+
+static void test_handler(BACNET_ADDRESS *src, uint8_t *pdu, uint16_t pdu_len)
+{
+    zassert_equal(src->mac_len, 6, NULL);
+    Test_Handler_Count++;
+    memcpy(Test_Handler_PDU, pdu, pdu_len);
+    Test_Handler_PDU_Len = pdu_len;
+}
+
+/**
+ * @brief Encode an 802.2 frame
+ * @param frame - frame buffer, at least ETHERNET_MPDU_MAX octets
+ * @param dest - destination MAC address
+ * @param dsap - destination service access point
+ * @param npdu_id - first octet of the 8 octet NPDU
+ * @return number of octets in the frame
+ */
+static uint16_t test_frame_encode(
+    uint8_t *frame, const uint8_t *dest, uint8_t dsap, uint8_t npdu_id)
+{
+    unsigned i;
+
+    memcpy(&frame[0], dest, 6);
+    memset(&frame[6], 0x02, 6);
+    frame[14] = dsap;
+    frame[15] = dsap;
+    frame[16] = 0x03;
+    for (i = 0; i < 8; i++) {
+        frame[17 + i] = (uint8_t)(npdu_id + i);
+    }
+    encode_unsigned16(&frame[12], 3 + 8);
+    /* pad to the minimum frame size */
+    memset(&frame[25], 0, 60 - 25);
+
+    return 60;
+}
+
+static void test_packet_mmap_filter(void)
+{
+    struct sock_filter filter[PACKET_MMAP_FILTER_MAX];
+    struct sock_fprog program = { 0 };
+    uint8_t frame[ETHERNET_MPDU_MAX] = { 0 };
+    uint8_t buffer[ETHERNET_MPDU_MAX] = { 0 };
+    uint16_t frame_len;
+    const uint8_t signature[5] = { 1, 2, 3, 4, 5 };
+    int sv[2];
+    ssize_t len;
+
+    zassert_equal(packet_mmap_filter(filter, 0, signature, 0), 0, NULL);
+    zassert_equal(packet_mmap_filter(filter, 0, signature, 5), 0, NULL);
+    zassert_equal(packet_mmap_filter(filter, 0, NULL, 2), 0, NULL);
+    zassert_equal(
+        packet_mmap_filter(filter, 0, signature, PACKET_MMAP_SIGNATURE_MAX),
+        PACKET_MMAP_FILTER_MAX, NULL);
+    program.len = (unsigned short)packet_mmap_filter(
+        filter, 14, Test_LSAP, sizeof(Test_LSAP));
+    zassert_equal(program.len, 6, NULL);
+    program.filter = filter;
+    /* the kernel runs the same filter on datagram sockets */
+    zassert_equal(socketpair(AF_UNIX, SOCK_DGRAM, 0, sv), 0, NULL);
+    zassert_equal(
+        setsockopt(
+            sv[1], SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)),
+        0, NULL);
+    frame_len = test_frame_encode(frame, Test_Broadcast, 0x42, 0x10);
+    zassert_equal(send(sv[0], frame, frame_len, 0), frame_len, NULL);
+    frame_len = test_frame_encode(frame, Test_Broadcast, 0x82, 0x20);
+    frame[15] = 0x42;
+    zassert_equal(send(sv[0], frame, frame_len, 0), frame_len, NULL);
+    frame_len = test_frame_encode(frame, Test_Broadcast, 0x82, 0x30);
+    zassert_equal(send(sv[0], frame, frame_len, 0), frame_len, NULL);
+    len = recv(sv[1], buffer, sizeof(buffer), MSG_DONTWAIT);
+    zassert_equal(len, frame_len, NULL);
+    zassert_equal(buffer[17], 0x30, NULL);
+    len = recv(sv[1], buffer, sizeof(buffer), MSG_DONTWAIT);
+    zassert_true(len < 0, NULL);
+    close(sv[0]);
+    close(sv[1]);
+}
+
+/**
+ * @brief Create the veth pair
+ * @return true if the veth pair is up
+ */
+static bool test_veth_create(void)
+{
+    if (getuid() != 0) {
+        return false;
+    }
+    (void)system("ip link del " TEST_IFNAME_PEER " >/dev/null 2>&1");
+    if (system("ip link add " TEST_IFNAME_PEER " type veth peer name "
+               TEST_IFNAME_IUT " >/dev/null 2>&1") != 0) {
+        return false;
+    }
+    if ((system("ip link set " TEST_IFNAME_PEER " up") != 0) ||
+        (system("ip link set " TEST_IFNAME_IUT " up") != 0)) {
+        (void)system("ip link del " TEST_IFNAME_PEER);
+        return false;
+    }
+
+    return true;
+}
+
+static void test_ethernet_veth(void)
+{
+    struct packet_mmap peer = { -1, NULL, 0, 0, false, NULL, 0 };
+    uint8_t frame[ETHERNET_MPDU_MAX] = { 0 };
+    uint8_t pdu[MAX_PDU] = { 0 };
+    uint8_t other_mac[6] = { 0x02, 0, 0, 0, 0, 0x42 };
+    uint8_t ipv4_frame[60] = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS my_address = { 0 };
+    uint16_t frame_len;
+    uint16_t pdu_len;
+    uint8_t *rx_frame;
+    unsigned count = 0;
+    unsigned i;
+    bool status;
+
+    if (!test_veth_create()) {
+        printf("packet_mmap: no veth pair, so the ring is not tested\n");
+        return;
+    }
+    status = ethernet_init(TEST_IFNAME_IUT);
+    zassert_true(status, NULL);
+    status = packet_mmap_open(
+        &peer, TEST_IFNAME_PEER, ETH_P_802_2, 14, Test_LSAP,
+        sizeof(Test_LSAP));
+    zassert_true(status, NULL);
+    /* nothing yet */
+    pdu_len = ethernet_receive(&src, pdu, sizeof(pdu), 10);
+    zassert_equal(pdu_len, 0, NULL);
+    /* an IPv4 frame and a frame for another LSAP are dropped */
+    memset(ipv4_frame, 0xFF, 6);
+    ipv4_frame[12] = 0x08;
+    zassert_equal(packet_mmap_send(&peer, ipv4_frame, 60), 60, NULL);
+    ethernet_get_broadcast_address(&dest);
+    frame_len = test_frame_encode(frame, dest.mac, 0x42, 0x10);
+    zassert_equal(packet_mmap_send(&peer, frame, frame_len), 60, NULL);
+    /* a BACnet frame for another station is dropped */
+    frame_len = test_frame_encode(frame, other_mac, 0x82, 0x20);
+    zassert_equal(packet_mmap_send(&peer, frame, frame_len), 60, NULL);
+    /* a burst of broadcasts arrives in one block */
+    for (i = 0; i < 10; i++) {
+        frame_len = test_frame_encode(frame, dest.mac, 0x82, 0x30 + i);
+        zassert_equal(packet_mmap_send(&peer, frame, frame_len), 60, NULL);
+    }
+    pdu_len = ethernet_receive(&src, pdu, sizeof(pdu), 1000);
+    zassert_equal(pdu_len, 8, NULL);
+    zassert_equal(pdu[0], 0x30, NULL);
+    zassert_equal(src.mac_len, 6, NULL);
+    zassert_equal(src.mac[5], 0x02, NULL);
+    Test_Handler_Count = 0;
+    while (Test_Handler_Count < 9) {
+        count = ethernet_receive_handler(test_handler, 1000);
+        if (count == 0) {
+            break;
+        }
+    }
+    zassert_equal(Test_Handler_Count, 9, NULL);
+    zassert_equal(Test_Handler_PDU_Len, 8, NULL);
+    zassert_equal(Test_Handler_PDU[0], 0x39, NULL);
+    count = ethernet_receive_handler(test_handler, 10);
+    zassert_equal(count, 0, NULL);
+    /* frames sent by the IUT reach the peer */
+    ethernet_get_my_address(&my_address);
+    for (i = 0; i < sizeof(pdu); i++) {
+        pdu[i] = (uint8_t)i;
+    }
+    zassert_true(ethernet_send_pdu(&dest, NULL, pdu, 100) > 0, NULL);
+    rx_frame = packet_mmap_receive(&peer, 1000, &frame_len);
+    zassert_not_null(rx_frame, NULL);
+    zassert_true(frame_len >= (17 + 100), NULL);
+    zassert_equal(memcmp(&rx_frame[6], my_address.mac, 6), 0, NULL);
+    zassert_equal(rx_frame[14], 0x82, NULL);
+    zassert_equal(rx_frame[16], 0x03, NULL);
+    zassert_equal(memcmp(&rx_frame[17], pdu, 100), 0, NULL);
+    packet_mmap_close(&peer);
+    ethernet_cleanup();
+    zassert_false(ethernet_valid(), NULL);
+    (void)system("ip link del " TEST_IFNAME_PEER);
+}
+
+void test_main(void)
+{
+    ztest_test_suite(
+        packet_mmap_tests, ztest_unit_test(test_packet_mmap_filter),
+        ztest_unit_test(test_ethernet_veth));
+
+    ztest_run_test_suite(packet_mmap_tests);
+}
@@ -0,0 +1,234 @@
+/**
+ * @file
+ * @brief test of the Trend Log buffers kept in memory-mapped files
+ * @date 2024
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zephyr/ztest.h>
+#include <bacnet/bacapp.h>
+#include <bacnet/rp.h>
+#include <bacnet/basic/object/trendlog.h>
+
+/* number of records in the log buffer of the file */
+#define TEST_BUFFER_SIZE 16
+/* the records start after the header of the file */
+#define TEST_HEADER_SIZE 64
+/* "BTL1" */
+#define TEST_MAGIC 0x42544C31UL
+
+static char Test_Pathname[64];
+
+/**
+ * @brief Read an unsigned property of a Trend Log
+ */
+static uint32_t
+test_Trend_Log_Unsigned(uint32_t object_instance, BACNET_PROPERTY_ID property)
+{
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+    uint8_t apdu[MAX_APDU] = { 0 };
+    int len;
+
+    rpdata.application_data = apdu;
+    rpdata.application_data_len = sizeof(apdu);
+    rpdata.object_type = OBJECT_TRENDLOG;
+    rpdata.object_instance = object_instance;
+    rpdata.object_property = property;
+    rpdata.array_index = BACNET_ARRAY_ALL;
+    len = Trend_Log_Read_Property(&rpdata);
+    zassert_true(len > 0, NULL);
+    len = bacapp_decode_application_data(apdu, len, &value);
+    zassert_true(len > 0, NULL);
+    zassert_equal(value.tag, BACNET_APPLICATION_TAG_UNSIGNED_INT, NULL);
+
+    return (uint32_t)value.type.Unsigned_Int;
+}
+
+/**
+ * @brief Read the header at the start of the file: the magic number,
+ *  the record size, and the state of the log buffer
+ */
+static void test_Trend_Log_File_Header(uint32_t header[6])
+{
+    int fd;
+
+    fd = open(Test_Pathname, O_RDONLY);
+    zassert_true(fd >= 0, NULL);
+    zassert_equal(read(fd, header, 6 * sizeof(uint32_t)), 24, NULL);
+    close(fd);
+}
+
+/**
+ * @brief Test that the records in the file are kept from one open to the
+ *  next, and are in the file once it is closed
+ */
+static void test_Trend_Log_Storage_Reopen(void)
+{
+    uint32_t object_instance;
+    uint32_t header[6] = { 0 };
+    uint32_t total;
+    struct stat file_stat;
+    unsigned i;
+
+    Trend_Log_Init();
+    object_instance = Trend_Log_Index_To_Instance(0);
+    unlink(Test_Pathname);
+    zassert_true(
+        Trend_Log_Storage_Open(
+            object_instance, Test_Pathname, TEST_BUFFER_SIZE),
+        NULL);
+    zassert_equal(
+        Trend_Log_Buffer_Size(object_instance), TEST_BUFFER_SIZE, NULL);
+    zassert_equal(
+        test_Trend_Log_Unsigned(object_instance, PROP_RECORD_COUNT), 0, NULL);
+    for (i = 0; i < 5; i++) {
+        TL_Insert_Status_Rec(0, LOG_STATUS_BUFFER_PURGED, true);
+    }
+    zassert_equal(
+        test_Trend_Log_Unsigned(object_instance, PROP_RECORD_COUNT), 5, NULL);
+    total = test_Trend_Log_Unsigned(object_instance, PROP_TOTAL_RECORD_COUNT);
+    /* closing writes the log to the file, and goes back to the built in
+       log buffer */
+    Trend_Log_Storage_Close(object_instance);
+    zassert_equal(
+        Trend_Log_Buffer_Size(object_instance), TL_MAX_ENTRIES, NULL);
+    zassert_equal(
+        test_Trend_Log_Unsigned(object_instance, PROP_RECORD_COUNT), 0, NULL);
+    zassert_equal(stat(Test_Pathname, &file_stat), 0, NULL);
+    zassert_equal(
+        file_stat.st_size,
+        TEST_HEADER_SIZE + (TEST_BUFFER_SIZE * sizeof(TL_DATA_REC)), NULL);
+    test_Trend_Log_File_Header(header);
+    zassert_equal(header[0], TEST_MAGIC, NULL);
+    zassert_equal(header[1], sizeof(TL_DATA_REC), NULL);
+    zassert_equal(header[2], TEST_BUFFER_SIZE, NULL);
+    zassert_equal(header[3], 5, NULL);
+    zassert_equal(header[4], 5, NULL);
+    zassert_equal(header[5], total, NULL);
+    /* the log is restored from the file */
+    zassert_true(
+        Trend_Log_Storage_Open(
+            object_instance, Test_Pathname, TEST_BUFFER_SIZE),
+        NULL);
+    zassert_equal(
+        test_Trend_Log_Unsigned(object_instance, PROP_RECORD_COUNT), 5, NULL);
+    zassert_equal(
+        test_Trend_Log_Unsigned(object_instance, PROP_TOTAL_RECORD_COUNT),
+        total, NULL);
+    TL_Insert_Status_Rec(0, LOG_STATUS_BUFFER_PURGED, true);
+    Trend_Log_Storage_Close(object_instance);
+    zassert_true(
+        Trend_Log_Storage_Open(
+            object_instance, Test_Pathname, TEST_BUFFER_SIZE),
+        NULL);
+    zassert_equal(
+        test_Trend_Log_Unsigned(object_instance, PROP_RECORD_COUNT), 6, NULL);
+    Trend_Log_Storage_Close(object_instance);
+    unlink(Test_Pathname);
+}
+
+/**
+ * @brief Test that a file for another buffer size, or written by another
+ *  build, starts out with an empty log
+ */
+static void test_Trend_Log_Storage_Mismatch(void)
+{
+    uint32_t object_instance;
+    uint32_t header[6] = { 0 };
+    uint32_t record_size;
+    unsigned i;
+    int fd;
+
+    Trend_Log_Init();
+    object_instance = Trend_Log_Index_To_Instance(0);
+    unlink(Test_Pathname);
+    zassert_true(
+        Trend_Log_Storage_Open(
+            object_instance, Test_Pathname, TEST_BUFFER_SIZE),
+        NULL);
+    for (i = 0; i < 5; i++) {
+        TL_Insert_Status_Rec(0, LOG_STATUS_BUFFER_PURGED, true);
+    }
+    Trend_Log_Storage_Close(object_instance);
+    /* another buffer size */
+    zassert_true(
+        Trend_Log_Storage_Open(
+            object_instance, Test_Pathname, TEST_BUFFER_SIZE / 2),
+        NULL);
+    zassert_equal(
+        Trend_Log_Buffer_Size(object_instance), TEST_BUFFER_SIZE / 2, NULL);
+    zassert_equal(
+        test_Trend_Log_Unsigned(object_instance, PROP_RECORD_COUNT), 0, NULL);
+    for (i = 0; i < 3; i++) {
+        TL_Insert_Status_Rec(0, LOG_STATUS_BUFFER_PURGED, true);
+    }
+    Trend_Log_Storage_Close(object_instance);
+    test_Trend_Log_File_Header(header);
+    zassert_equal(header[2], TEST_BUFFER_SIZE / 2, NULL);
+    zassert_equal(header[4], 3, NULL);
+    /* written by a build with another record size */
+    record_size = sizeof(TL_DATA_REC) + 4;
+    fd = open(Test_Pathname, O_WRONLY);
+    zassert_true(fd >= 0, NULL);
+    zassert_equal(
+        pwrite(fd, &record_size, sizeof(record_size), 4), sizeof(record_size),
+        NULL);
+    close(fd);
+    zassert_true(
+        Trend_Log_Storage_Open(
+            object_instance, Test_Pathname, TEST_BUFFER_SIZE / 2),
+        NULL);
+    zassert_equal(
+        test_Trend_Log_Unsigned(object_instance, PROP_RECORD_COUNT), 0, NULL);
+    Trend_Log_Storage_Close(object_instance);
+    test_Trend_Log_File_Header(header);
+    zassert_equal(header[0], TEST_MAGIC, NULL);
+    zassert_equal(header[1], sizeof(TL_DATA_REC), NULL);
+    zassert_equal(header[4], 0, NULL);
+    /* a file that is not a log at all */
+    fd = open(Test_Pathname, O_WRONLY | O_TRUNC);
+    zassert_true(fd >= 0, NULL);
+    zassert_equal(write(fd, "not a trend log", 15), 15, NULL);
+    close(fd);
+    zassert_true(
+        Trend_Log_Storage_Open(
+            object_instance, Test_Pathname, TEST_BUFFER_SIZE),
+        NULL);
+    zassert_equal(
+        test_Trend_Log_Unsigned(object_instance, PROP_RECORD_COUNT), 0, NULL);
+    Trend_Log_Storage_Close(object_instance);
+    unlink(Test_Pathname);
+    /* arguments that cannot be kept in a file */
+    zassert_false(
+        Trend_Log_Storage_Open(object_instance, NULL, TEST_BUFFER_SIZE), NULL);
+    zassert_false(
+        Trend_Log_Storage_Open(object_instance, Test_Pathname, 0), NULL);
+    zassert_false(
+        Trend_Log_Storage_Open(
+            object_instance, "/nonexistent/trendlog.bin", TEST_BUFFER_SIZE),
+        NULL);
+    zassert_false(
+        Trend_Log_Storage_Open(
+            Trend_Log_Count(), Test_Pathname, TEST_BUFFER_SIZE),
+        NULL);
+    unlink(Test_Pathname);
+}
+
+void test_main(void)
+{
+    snprintf(
+        Test_Pathname, sizeof(Test_Pathname), "/tmp/trendlog-mmap-%ld.bin",
+        (long)getpid());
+    ztest_test_suite(
+        trendlog_mmap_tests, ztest_unit_test(test_Trend_Log_Storage_Reopen),
+        ztest_unit_test(test_Trend_Log_Storage_Mismatch));
+
+    ztest_run_test_suite(trendlog_mmap_tests);
+}
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""Generate sorted indexes of INDTEXT_DATA tables for binary search by text.
+
+Reads the INDTEXT_DATA tables in a C file, and writes a C header with,
+for each table named on the command line, the positions of its entries
+sorted by text, case insensitive, as used by indtext_sorted_by_string()
+and indtext_sorted_by_istring().
+
+Usage:
+    indtext-index.py src/bacnet/bactext.c table [table ...] \\
+        > src/bacnet/bactext_index.h
+"""
+import re
+import sys
+
+TABLE_PATTERN = re.compile(
+    r"^(?:static\s+)?INDTEXT_DATA\s+(\w+)\s*\[\s*\]\s*=\s*\{(.*?)"
+    r"\{\s*0\s*,\s*NULL\s*\}",
+    re.MULTILINE | re.DOTALL,
+)
+ENTRY_PATTERN = re.compile(r'\{\s*[^{},"]+,\s*"((?:[^"\\]|\\.)*)"\s*\}')
+VALUES_PER_LINE = 12
+
+
+def table_strings(source):
+    """Return a dictionary of the text of each table, in table order"""
+    tables = {}
+    for match in TABLE_PATTERN.finditer(source):
+        body = re.sub(r"/\*.*?\*/", "", match.group(2), flags=re.DOTALL)
+        if re.search(r"^\s*#", body, re.MULTILINE):
+            sys.exit("table %s uses the preprocessor" % match.group(1))
+        tables[match.group(1)] = [
+            bytes(text, "ascii").decode("unicode_escape")
+            for text in ENTRY_PATTERN.findall(body)
+        ]
+    return tables
+
+
+def sort_key(text):
+    """Order of bacnet_stricmp(), which compares the lower case octets"""
+    return bytes(text, "latin-1").lower()
+
+
+def table_index(name, strings):
+    """Return the C code of the sorted index of one table"""
+    positions = sorted(
+        range(len(strings)), key=lambda i: (sort_key(strings[i]), i)
+    )
+    lines = []
+    lines.append("extern INDTEXT_DATA %s[];" % name)
+    lines.append("static const uint16_t %s_sorted[] = {" % name)
+    for i in range(0, len(positions), VALUES_PER_LINE):
+        values = ", ".join(str(p) for p in positions[i : i + VALUES_PER_LINE])
+        if i + VALUES_PER_LINE < len(positions):
+            values += ","
+        lines.append("    " + values)
+    lines.append("};")
+    lines.append("static INDTEXT_SORTED %s_index = {" % name)
+    members = "    %s, %s_sorted, %u" % (name, name, len(positions))
+    if len(members) > 80:
+        members = "    %s,\n    %s_sorted,\n    %u" % (
+            name, name, len(positions))
+    lines.append(members)
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main(argv):
+    """Write the header of the sorted indexes"""
+    if len(argv) < 3:
+        sys.exit(__doc__)
+    with open(argv[1], encoding="utf-8") as source_file:
+        tables = table_strings(source_file.read())
+    basename = argv[1].split("/")[-1][:-2]
+    guard = re.sub(r"\W", "_", "BACNET_%s_INDEX_H" % basename)
+    print("/**")
+    print(" * @file")
+    print(" * @brief Sorted indexes of the %s text tables" % argv[1])
+    print(" * @note Generated by tools/indtext-index/indtext-index.py")
+    print(" *  from these tables - regenerate when a table changes:")
+    print(" *  indtext-index.py %s \\" % argv[1])
+    for name in argv[2:]:
+        print(" *      %s%s" % (name, " \\" if name != argv[-1] else ""))
+    print(" * @copyright SPDX-License-Identifier: MIT")
+    print(" */")
+    print("#ifndef %s" % guard.upper())
+    print("#define %s" % guard.upper())
+    print("")
+    print("#include <stdint.h>")
+    print('#include "bacnet/indtext.h"')
+    for name in argv[2:]:
+        if name not in tables:
+            sys.exit("table %s not found" % name)
+        print("")
+        print(table_index(name, tables[name]))
+    print("")
+    print("#endif")
+
+
+if __name__ == "__main__":
+    main(sys.argv)